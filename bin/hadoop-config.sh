@@ -215,6 +215,9 @@ if [ "x$JAVA_LIBRARY_PATH" != "x" ]; then
   HADOOP_OPTS="$HADOOP_OPTS -Djava.library.path=$JAVA_LIBRARY_PATH"
 fi  
 HADOOP_OPTS="$HADOOP_OPTS -Dhadoop.policy.file=$HADOOP_POLICYFILE"
+if [ "x$HADOOP_CONF_CACHE_DIR" != "x" ]; then
+  HADOOP_OPTS="$HADOOP_OPTS -Dhadoop.conf.cache.dir=$HADOOP_CONF_CACHE_DIR"
+fi
 
 # put hdfs in classpath if present
 if [ "$HADOOP_HDFS_HOME" = "" ]; then
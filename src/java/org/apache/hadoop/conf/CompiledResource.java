@@ -0,0 +1,730 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.conf;
+
+import java.io.BufferedOutputStream;
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataOutputStream;
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.net.MalformedURLException;
+import java.net.URISyntaxException;
+import java.net.URL;
+import java.nio.BufferUnderflowException;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Comparator;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+import javax.xml.parsers.DocumentBuilder;
+import javax.xml.parsers.DocumentBuilderFactory;
+import javax.xml.parsers.ParserConfigurationException;
+import javax.xml.stream.XMLInputFactory;
+import javax.xml.stream.XMLStreamConstants;
+import javax.xml.stream.XMLStreamException;
+import javax.xml.stream.XMLStreamReader;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.io.IOUtils;
+import org.apache.hadoop.io.MD5Hash;
+import org.w3c.dom.Document;
+import org.w3c.dom.Element;
+import org.w3c.dom.Node;
+import org.w3c.dom.NodeList;
+import org.w3c.dom.Text;
+import org.xml.sax.SAXException;
+
+/**
+ * The properties of one configuration resource in document order, with
+ * their final flags and the keys that replace deprecated names.
+ *
+ * <p>Resources are parsed with a streaming StAX reader; only documents
+ * that use XInclude are parsed into a DOM. A resource read from a file, or
+ * from a jar file, is compiled once per JVM: it is reused while the file
+ * keeps its modification time and length, and while it is one of the
+ * {@link #MAX_CACHED} resources loaded most recently. If the system property
+ * <code>hadoop.conf.cache.dir</code> names a directory, compiled resources
+ * are also written there in a binary form, which later JVMs read
+ * instead of parsing the XML. The directory keeps the
+ * {@link #MAX_CACHE_FILES} files used most recently. It must only be
+ * writable by the user, as its files are trusted.</p>
+ *
+ * <p>A file modified less than {@link #RACY_MILLIS} ago is never cached,
+ * since it could change again without changing its timestamp.</p>
+ */
+final class CompiledResource {
+  private static final Log LOG = LogFactory.getLog(CompiledResource.class);
+
+  /** The system property naming the directory of binary cache files. */
+  static final String CACHE_DIR_PROPERTY = "hadoop.conf.cache.dir";
+
+  /** How long a file must be unmodified before it is cached. */
+  static final long RACY_MILLIS = 2000;
+
+  /** The most resources kept compiled in memory. */
+  static final int MAX_CACHED = 64;
+
+  /** The most files kept in the cache directory. */
+  static final int MAX_CACHE_FILES = 256;
+
+  /* how old a temporary file must be to be taken as left by a dead JVM */
+  private static final long STALE_TMP_MILLIS = 60 * 60 * 1000;
+
+  private static final int MAGIC = 0x48434e46; // "HCNF"
+  private static final int VERSION = 1;
+  private static final byte FINAL = 1;
+  private static final byte DEPRECATED = 2;
+
+  private static final String XINCLUDE_NS =
+    "http://www.w3.org/2001/XInclude";
+
+  /* compiled resources by URL in access order; guarded by itself */
+  private static final Map<String, CompiledResource> cache =
+    new LinkedHashMap<String, CompiledResource>(16, 0.75f, true) {
+      private static final long serialVersionUID = 1L;
+
+      @Override
+      protected boolean removeEldestEntry(
+          Map.Entry<String, CompiledResource> eldest) {
+        return size() > MAX_CACHED;
+      }
+    };
+  private static XMLInputFactory inputFactory;
+
+  private final String[] names;
+  private final String[] values;
+  private final byte[] flags;
+  private final String[][] newKeys;
+  /* the deprecations the new keys were resolved against */
+  private final long deprecations;
+  /* whether the resource includes others, whose timestamps we don't track */
+  private final boolean includes;
+  private long lastModified;
+  private long length;
+
+  private CompiledResource(String[] names, String[] values, byte[] flags,
+                           String[][] newKeys, long deprecations,
+                           boolean includes) {
+    this.names = names;
+    this.values = values;
+    this.flags = flags;
+    this.newKeys = newKeys;
+    this.deprecations = deprecations;
+    this.includes = includes;
+  }
+
+  /** @return the number of properties */
+  int size() {
+    return names.length;
+  }
+
+  /** @return the name of property i, interned */
+  String getName(int i) {
+    return names[i];
+  }
+
+  /** @return the value of property i, or null if it has none */
+  String getValue(int i) {
+    return values[i];
+  }
+
+  boolean isFinal(int i) {
+    return (flags[i] & FINAL) != 0;
+  }
+
+  /**
+   * @return the keys that replace the name of property i, or null if the
+   *         name is not deprecated
+   */
+  String[] getNewKeys(int i) {
+    if (deprecations == Configuration.getDeprecationFingerprint()) {
+      return newKeys[i];
+    }
+    return Configuration.getDeprecatedNewKeys(names[i]);
+  }
+
+  /** Forget the resources compiled by this JVM. */
+  static void clearCache() {
+    synchronized (cache) {
+      cache.clear();
+    }
+  }
+
+  private static CompiledResource getCached(String key) {
+    synchronized (cache) {
+      return cache.get(key);
+    }
+  }
+
+  private static void putCached(String key, CompiledResource compiled) {
+    synchronized (cache) {
+      cache.put(key, compiled);
+    }
+  }
+
+  /**
+   * Compile the resource at a URL, or get it from the caches.
+   */
+  static CompiledResource load(URL url) throws IOException {
+    File source = getSourceFile(url);
+    if (source == null) {
+      return parse(url);
+    }
+    // stat before reading, so that a concurrent change is seen next time
+    long lastModified = source.lastModified();
+    long length = source.length();
+    String key = url.toString();
+    CompiledResource compiled = getCached(key);
+    if (compiled != null && compiled.isFrom(lastModified, length)) {
+      return compiled;
+    }
+    File cacheFile = getCacheFile(key);
+    if (cacheFile != null && cacheFile.exists()) {
+      compiled = read(cacheFile, key, lastModified, length);
+      if (compiled != null) {
+        putCached(key, compiled);
+        return compiled;
+      }
+    }
+
+    compiled = parse(url);
+    if (!compiled.includes && lastModified != 0
+        && System.currentTimeMillis() - lastModified > RACY_MILLIS) {
+      compiled.lastModified = lastModified;
+      compiled.length = length;
+      putCached(key, compiled);
+      if (cacheFile != null) {
+        write(cacheFile, key, compiled);
+      }
+    }
+    return compiled;
+  }
+
+  private boolean isFrom(long lastModified, long length) {
+    return lastModified != 0 && this.lastModified == lastModified
+      && this.length == length;
+  }
+
+  /* The file behind a file: or a jar:file: URL, or null. */
+  private static File getSourceFile(URL url) {
+    try {
+      if ("file".equals(url.getProtocol())) {
+        return new File(url.toURI());
+      }
+      if ("jar".equals(url.getProtocol())) {
+        String spec = url.getPath();
+        int sep = spec.indexOf("!/");
+        if (sep > 0) {
+          URL jar = new URL(spec.substring(0, sep));
+          if ("file".equals(jar.getProtocol())) {
+            return new File(jar.toURI());
+          }
+        }
+      }
+    } catch (URISyntaxException e) {
+      // not cacheable
+    } catch (MalformedURLException e) {
+      // not cacheable
+    } catch (IllegalArgumentException e) {
+      // a URI File cannot represent
+    }
+    return null;
+  }
+
+  static File getCacheFile(String key) {
+    String dir = System.getProperty(CACHE_DIR_PROPERTY);
+    if (dir == null || dir.length() == 0) {
+      return null;
+    }
+    return new File(dir, MD5Hash.digest(key).toString() + ".conf");
+  }
+
+  /** Parse the resource at a URL. */
+  static CompiledResource parse(URL url) throws IOException {
+    InputStream in = url.openStream();
+    CompiledResource compiled;
+    try {
+      compiled = parseStax(in, url.toString());
+    } finally {
+      in.close();
+    }
+    return compiled != null ? compiled : parseDom(url.toString(), null);
+  }
+
+  /** Parse and close a resource given as a stream. */
+  static CompiledResource parse(InputStream in) throws IOException {
+    byte[] bytes;
+    try {
+      ByteArrayOutputStream buf = new ByteArrayOutputStream();
+      IOUtils.copyBytes(in, buf, 4096, false);
+      bytes = buf.toByteArray();
+    } finally {
+      in.close();
+    }
+    CompiledResource compiled =
+      parseStax(new ByteArrayInputStream(bytes), null);
+    return compiled != null ? compiled
+      : parseDom(null, new ByteArrayInputStream(bytes));
+  }
+
+  /* Accumulates the properties of a resource. */
+  private static class Builder {
+    private final List<String> names = new ArrayList<String>();
+    private final List<String> values = new ArrayList<String>();
+    private final List<Boolean> finals = new ArrayList<Boolean>();
+
+    void add(String name, String value, boolean finalParameter) {
+      if (name != null) {
+        names.add(name.intern());
+        values.add(value);
+        finals.add(finalParameter);
+      }
+    }
+
+    CompiledResource build(boolean includes) {
+      int n = names.size();
+      long deprecations = Configuration.getDeprecationFingerprint();
+      String[][] newKeys = new String[n][];
+      byte[] flags = new byte[n];
+      for (int i = 0; i < n; i++) {
+        newKeys[i] = Configuration.getDeprecatedNewKeys(names.get(i));
+        flags[i] = (byte) ((finals.get(i) ? FINAL : 0)
+                           | (newKeys[i] != null ? DEPRECATED : 0));
+      }
+      return new CompiledResource(names.toArray(new String[n]),
+          values.toArray(new String[n]), flags, newKeys, deprecations,
+          includes);
+    }
+  }
+
+  /* Thrown to fall back to the DOM parser. */
+  private static class IncludeFound extends Exception {
+    private static final long serialVersionUID = 1L;
+  }
+
+  private static synchronized XMLStreamReader createReader(InputStream in,
+      String systemId) throws XMLStreamException {
+    if (inputFactory == null) {
+      inputFactory = XMLInputFactory.newInstance();
+      inputFactory.setProperty(XMLInputFactory.IS_COALESCING, Boolean.TRUE);
+    }
+    return systemId == null ? inputFactory.createXMLStreamReader(in)
+      : inputFactory.createXMLStreamReader(systemId, in);
+  }
+
+  /*
+   * Parse with StAX, the same way the DOM walk below does.
+   * @return null if the document includes others
+   */
+  private static CompiledResource parseStax(InputStream in, String systemId)
+      throws IOException {
+    try {
+      XMLStreamReader reader = createReader(in, systemId);
+      try {
+        Builder builder = new Builder();
+        // skip the prolog
+        do {
+          if (!reader.hasNext()) {
+            throw new XMLStreamException("no root element");
+          }
+        } while (reader.next() != XMLStreamConstants.START_ELEMENT);
+        checkInclude(reader);
+        if (!"configuration".equals(getTagName(reader))) {
+          LOG.fatal("bad conf file: top-level element not <configuration>");
+        }
+        parseConfiguration(reader, builder);
+        return builder.build(false);
+      } finally {
+        reader.close();
+      }
+    } catch (IncludeFound e) {
+      return null;
+    } catch (XMLStreamException e) {
+      throw new IOException("error parsing " + systemId + ": " + e, e);
+    }
+  }
+
+  private static String getTagName(XMLStreamReader reader) {
+    String prefix = reader.getPrefix();
+    return prefix == null || prefix.length() == 0 ? reader.getLocalName()
+      : prefix + ":" + reader.getLocalName();
+  }
+
+  private static void checkInclude(XMLStreamReader reader)
+      throws IncludeFound {
+    if (XINCLUDE_NS.equals(reader.getNamespaceURI())) {
+      throw new IncludeFound();
+    }
+  }
+
+  /* The reader is at the start of a configuration element. */
+  private static void parseConfiguration(XMLStreamReader reader,
+      Builder builder) throws XMLStreamException, IncludeFound {
+    while (true) {
+      int event = reader.next();
+      if (event == XMLStreamConstants.END_ELEMENT) {
+        return;
+      }
+      if (event != XMLStreamConstants.START_ELEMENT) {
+        continue;
+      }
+      checkInclude(reader);
+      String tag = getTagName(reader);
+      if ("configuration".equals(tag)) {
+        parseConfiguration(reader, builder);
+        continue;
+      }
+      if (!"property".equals(tag)) {
+        LOG.warn("bad conf file: element not <property>");
+      }
+      String attr = null;
+      String value = null;
+      boolean finalParameter = false;
+      while ((event = reader.next()) != XMLStreamConstants.END_ELEMENT) {
+        if (event != XMLStreamConstants.START_ELEMENT) {
+          continue;
+        }
+        checkInclude(reader);
+        String field = getTagName(reader);
+        String text = readText(reader);
+        if ("name".equals(field) && text != null)
+          attr = text.trim();
+        if ("value".equals(field) && text != null)
+          value = text;
+        if ("final".equals(field) && text != null)
+          finalParameter = "true".equals(text);
+      }
+      builder.add(attr, value, finalParameter);
+    }
+  }
+
+  /*
+   * Read the text of the element the reader is at, up to its end.
+   * @return null if the element is empty
+   */
+  private static String readText(XMLStreamReader reader)
+      throws XMLStreamException, IncludeFound {
+    StringBuilder text = null;
+    int depth = 0;
+    while (true) {
+      int event = reader.next();
+      switch (event) {
+      case XMLStreamConstants.START_ELEMENT:
+        checkInclude(reader);
+        depth++;
+        break;
+      case XMLStreamConstants.END_ELEMENT:
+        if (depth-- == 0) {
+          return text == null ? null : text.toString();
+        }
+        break;
+      case XMLStreamConstants.CHARACTERS:
+      case XMLStreamConstants.CDATA:
+      case XMLStreamConstants.SPACE:
+        if (depth == 0) {
+          if (text == null) {
+            text = new StringBuilder();
+          }
+          text.append(reader.getTextCharacters(), reader.getTextStart(),
+                      reader.getTextLength());
+        }
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  /* Parse into a DOM, resolving XIncludes. */
+  private static CompiledResource parseDom(String systemId, InputStream in)
+      throws IOException {
+    try {
+      DocumentBuilderFactory docBuilderFactory 
+        = DocumentBuilderFactory.newInstance();
+      //ignore all comments inside the xml file
+      docBuilderFactory.setIgnoringComments(true);
+
+      //allow includes in the xml file
+      docBuilderFactory.setNamespaceAware(true);
+      try {
+          docBuilderFactory.setXIncludeAware(true);
+      } catch (UnsupportedOperationException e) {
+        LOG.error("Failed to set setXIncludeAware(true) for parser "
+                + docBuilderFactory
+                + ":" + e,
+                e);
+      }
+      DocumentBuilder builder = docBuilderFactory.newDocumentBuilder();
+      Document doc = in == null ? builder.parse(systemId) : builder.parse(in);
+      Builder props = new Builder();
+      walk(doc.getDocumentElement(), props);
+      return props.build(true);
+    } catch (SAXException e) {
+      throw new IOException("error parsing " + systemId + ": " + e, e);
+    } catch (ParserConfigurationException e) {
+      throw new IOException("error parsing " + systemId + ": " + e, e);
+    }
+  }
+
+  /** Compile a parsed configuration element. */
+  static CompiledResource fromElement(Element root) {
+    Builder props = new Builder();
+    walk(root, props);
+    return props.build(true);
+  }
+
+  private static void walk(Element root, Builder props) {
+    if (!"configuration".equals(root.getTagName()))
+      LOG.fatal("bad conf file: top-level element not <configuration>");
+    NodeList nodes = root.getChildNodes();
+    for (int i = 0; i < nodes.getLength(); i++) {
+      Node propNode = nodes.item(i);
+      if (!(propNode instanceof Element))
+        continue;
+      Element prop = (Element)propNode;
+      if ("configuration".equals(prop.getTagName())) {
+        walk(prop, props);
+        continue;
+      }
+      if (!"property".equals(prop.getTagName()))
+        LOG.warn("bad conf file: element not <property>");
+      NodeList fields = prop.getChildNodes();
+      String attr = null;
+      String value = null;
+      boolean finalParameter = false;
+      for (int j = 0; j < fields.getLength(); j++) {
+        Node fieldNode = fields.item(j);
+        if (!(fieldNode instanceof Element))
+          continue;
+        Element field = (Element)fieldNode;
+        if ("name".equals(field.getTagName()) && field.hasChildNodes())
+          attr = ((Text)field.getFirstChild()).getData().trim();
+        if ("value".equals(field.getTagName()) && field.hasChildNodes())
+          value = ((Text)field.getFirstChild()).getData();
+        if ("final".equals(field.getTagName()) && field.hasChildNodes())
+          finalParameter = "true".equals(((Text)field.getFirstChild()).getData());
+      }
+      props.add(attr, value, finalParameter);
+    }
+  }
+
+  /*
+   * The binary form: the header, then the properties.
+   *   int magic, int version, string url, long lastModified, long length,
+   *   long deprecations, int count
+   *   per property: string name, string value, byte flags,
+   *     [int count, string newKey... if DEPRECATED]
+   * A string is an int length, -1 for null, and its UTF-8 bytes.
+   */
+  private static void write(File cacheFile, String key,
+                            CompiledResource compiled) {
+    File dir = cacheFile.getParentFile();
+    File tmp = null;
+    try {
+      if (!dir.isDirectory() && !dir.mkdirs()) {
+        LOG.warn("Cannot create configuration cache directory " + dir);
+        return;
+      }
+      tmp = File.createTempFile(cacheFile.getName(), ".tmp", dir);
+      DataOutputStream out = new DataOutputStream(
+          new BufferedOutputStream(new FileOutputStream(tmp)));
+      try {
+        out.writeInt(MAGIC);
+        out.writeInt(VERSION);
+        writeString(out, key);
+        out.writeLong(compiled.lastModified);
+        out.writeLong(compiled.length);
+        out.writeLong(compiled.deprecations);
+        out.writeInt(compiled.size());
+        for (int i = 0; i < compiled.size(); i++) {
+          writeString(out, compiled.names[i]);
+          writeString(out, compiled.values[i]);
+          out.writeByte(compiled.flags[i]);
+          if ((compiled.flags[i] & DEPRECATED) != 0) {
+            out.writeInt(compiled.newKeys[i].length);
+            for (String newKey : compiled.newKeys[i]) {
+              writeString(out, newKey);
+            }
+          }
+        }
+      } finally {
+        out.close();
+      }
+      if (!tmp.renameTo(cacheFile)) {
+        // another JVM may have just written it
+        cacheFile.delete();
+        if (!tmp.renameTo(cacheFile)) {
+          LOG.debug("Cannot rename " + tmp + " to " + cacheFile);
+        }
+      }
+      cleanCacheDir(dir);
+    } catch (IOException e) {
+      LOG.warn("Cannot write configuration cache " + cacheFile + ": " + e);
+    } finally {
+      if (tmp != null && tmp.exists()) {
+        tmp.delete();
+      }
+    }
+  }
+
+  /*
+   * Delete the least recently used files beyond MAX_CACHE_FILES, and the
+   * temporary files of JVMs that died while writing. Reading a cache file
+   * touches it, so modification times order the files by use.
+   */
+  static void cleanCacheDir(File dir) {
+    File[] files = dir.listFiles();
+    if (files == null) {
+      return;
+    }
+    long now = System.currentTimeMillis();
+    List<File> cached = new ArrayList<File>();
+    for (File f : files) {
+      if (f.getName().endsWith(".conf")) {
+        cached.add(f);
+      } else if (f.getName().endsWith(".tmp")
+                 && now - f.lastModified() > STALE_TMP_MILLIS) {
+        f.delete();
+      }
+    }
+    int excess = cached.size() - MAX_CACHE_FILES;
+    if (excess <= 0) {
+      return;
+    }
+    // read each time once, so the order holds while other JVMs touch files
+    final long[] times = new long[cached.size()];
+    Integer[] order = new Integer[cached.size()];
+    for (int i = 0; i < order.length; i++) {
+      times[i] = cached.get(i).lastModified();
+      order[i] = i;
+    }
+    Arrays.sort(order, new Comparator<Integer>() {
+      public int compare(Integer a, Integer b) {
+        return times[a] < times[b] ? -1 : (times[a] == times[b] ? 0 : 1);
+      }
+    });
+    for (int i = 0; i < excess; i++) {
+      cached.get(order[i]).delete();
+    }
+  }
+
+  private static void writeString(DataOutputStream out, String s)
+      throws IOException {
+    if (s == null) {
+      out.writeInt(-1);
+    } else {
+      byte[] bytes = s.getBytes("UTF-8");
+      out.writeInt(bytes.length);
+      out.write(bytes);
+    }
+  }
+
+  /*
+   * Read a cache file. It is read whole and closed at once, rather than
+   * mapped, so that it can be deleted or replaced on Windows while the
+   * configuration is in use.
+   * @return null if it is not the compiled form of the given source
+   */
+  private static CompiledResource read(File cacheFile, String key,
+                                       long lastModified, long length) {
+    try {
+      ByteBuffer buf;
+      FileInputStream in = new FileInputStream(cacheFile);
+      try {
+        long size = in.getChannel().size();
+        if (size > Integer.MAX_VALUE) {
+          return null;
+        }
+        byte[] bytes = new byte[(int) size];
+        IOUtils.readFully(in, bytes, 0, bytes.length);
+        buf = ByteBuffer.wrap(bytes);
+      } finally {
+        in.close();
+      }
+      if (buf.getInt() != MAGIC || buf.getInt() != VERSION
+          || !key.equals(readString(buf))
+          || buf.getLong() != lastModified || buf.getLong() != length) {
+        return null;
+      }
+      long deprecations = buf.getLong();
+      int n = buf.getInt();
+      // each property takes several bytes, so a larger count is corrupt
+      if (n < 0 || n > buf.remaining()) {
+        LOG.debug("Corrupt configuration cache " + cacheFile
+            + ": property count " + n);
+        return null;
+      }
+      String[] names = new String[n];
+      String[] values = new String[n];
+      byte[] flags = new byte[n];
+      String[][] newKeys = new String[n][];
+      for (int i = 0; i < n; i++) {
+        names[i] = readString(buf).intern();
+        values[i] = readString(buf);
+        flags[i] = buf.get();
+        if ((flags[i] & DEPRECATED) != 0) {
+          int keys = buf.getInt();
+          if (keys < 0 || keys > buf.remaining()) {
+            LOG.debug("Corrupt configuration cache " + cacheFile
+                + ": key count " + keys);
+            return null;
+          }
+          newKeys[i] = new String[keys];
+          for (int j = 0; j < newKeys[i].length; j++) {
+            newKeys[i][j] = readString(buf).intern();
+          }
+        }
+      }
+      CompiledResource compiled = new CompiledResource(names, values,
+          flags, newKeys, deprecations, false);
+      compiled.lastModified = lastModified;
+      compiled.length = length;
+      // mark it used, so that cleaning keeps it
+      cacheFile.setLastModified(System.currentTimeMillis());
+      return compiled;
+    } catch (IOException e) {
+      LOG.debug("Cannot read configuration cache " + cacheFile + ": " + e);
+    } catch (BufferUnderflowException e) {
+      LOG.debug("Truncated configuration cache " + cacheFile);
+    } catch (RuntimeException e) {
+      LOG.debug("Corrupt configuration cache " + cacheFile + ": " + e);
+    }
+    return null;
+  }
+
+  private static String readString(ByteBuffer buf) throws IOException {
+    int len = buf.getInt();
+    if (len < 0) {
+      return null;
+    }
+    if (len > buf.remaining()) {
+      throw new BufferUnderflowException();
+    }
+    byte[] bytes = new byte[len];
+    buf.get(bytes);
+    return new String(bytes, "UTF-8");
+  }
+}
@@ -18,11 +18,9 @@
 
 package org.apache.hadoop.conf;
 
-import java.io.BufferedInputStream;
 import java.io.DataInput;
 import java.io.DataOutput;
 import java.io.File;
-import java.io.FileInputStream;
 import java.io.IOException;
 import java.io.InputStream;
 import java.io.InputStreamReader;
@@ -34,23 +32,21 @@ import java.net.URL;
 import java.util.ArrayList;
 import java.util.Collection;
 import java.util.Collections;
-import java.util.Enumeration;
 import java.util.HashMap;
-import java.util.HashSet;
 import java.util.Iterator;
 import java.util.List;
 import java.util.ListIterator;
 import java.util.Map;
 import java.util.Properties;
-import java.util.Set;
 import java.util.StringTokenizer;
+import java.util.TreeMap;
 import java.util.WeakHashMap;
+import java.util.concurrent.ConcurrentHashMap;
 import java.util.concurrent.CopyOnWriteArrayList;
 import java.util.regex.Matcher;
 import java.util.regex.Pattern;
 import java.util.regex.PatternSyntaxException;
 
-import javax.xml.parsers.DocumentBuilder;
 import javax.xml.parsers.DocumentBuilderFactory;
 import javax.xml.parsers.ParserConfigurationException;
 import javax.xml.transform.Transformer;
@@ -76,10 +72,6 @@ import org.w3c.dom.Comment;
 import org.w3c.dom.DOMException;
 import org.w3c.dom.Document;
 import org.w3c.dom.Element;
-import org.w3c.dom.Node;
-import org.w3c.dom.NodeList;
-import org.w3c.dom.Text;
-import org.xml.sax.SAXException;
 
 /** 
  * Provides access to configuration parameters.
@@ -102,6 +94,11 @@ import org.xml.sax.SAXException;
  * </ol>
  * Applications may add additional resources, which are loaded
  * subsequent to these resources in the order they are added.
+ *
+ * <p>A resource read from a file or a jar is parsed once per JVM, and again
+ * only when the file changes. With the system property
+ * <tt>hadoop.conf.cache.dir</tt> set to a directory private to the user,
+ * parsed resources are also kept there in a binary form for later JVMs.
  * 
  * <h4 id="FinalParams">Final Parameters</h4>
  *
@@ -166,11 +163,6 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    */
   static final String UNKNOWN_RESOURCE = "Unknown";
 
-  /**
-   * List of configuration parameters marked <b>final</b>. 
-   */
-  private Set<String> finalParameters = new HashSet<String>();
-  
   private boolean loadDefaults = true;
   
   /**
@@ -189,12 +181,6 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
   private static final Map<ClassLoader, Map<String, Class<?>>>
     CACHE_CLASSES = new WeakHashMap<ClassLoader, Map<String, Class<?>>>();
 
-  /**
-   * Stores the mapping of key to the resource which modifies or loads 
-   * the key most recently
-   */
-  private HashMap<String, String> updatingResource;
- 
   /**
    * Class to keep the information about the keys which replace the deprecated
    * ones.
@@ -248,6 +234,12 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    */
   private static Map<String, DeprecatedKeyInfo> deprecatedKeyMap = 
     new HashMap<String, DeprecatedKeyInfo>();
+
+  /**
+   * A hash of the deprecation map, so that resources compiled against it
+   * can tell when it has changed. 0 when it must be recomputed.
+   */
+  private static volatile long deprecationFingerprint = 0;
   
   /**
    * Adds the deprecated key to the deprecation map.
@@ -269,9 +261,43 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
       DeprecatedKeyInfo newKeyInfo;
       newKeyInfo = new DeprecatedKeyInfo(newKeys, customMessage);
       deprecatedKeyMap.put(key, newKeyInfo);
+      deprecationFingerprint = 0;
     }
   }
 
+  /**
+   * @return a hash of the deprecated keys and the keys replacing them
+   */
+  static long getDeprecationFingerprint() {
+    long h = deprecationFingerprint;
+    return h != 0 ? h : computeDeprecationFingerprint();
+  }
+
+  private static synchronized long computeDeprecationFingerprint() {
+    if (deprecationFingerprint == 0) {
+      long h = 1;
+      for (Map.Entry<String, DeprecatedKeyInfo> e :
+           new TreeMap<String, DeprecatedKeyInfo>(deprecatedKeyMap).entrySet()) {
+        h = 31 * h + e.getKey().hashCode();
+        for (String newKey : e.getValue().newKeys) {
+          h = 31 * h + newKey.hashCode();
+        }
+        h = 31 * h + 1;
+      }
+      deprecationFingerprint = h == 0 ? 1 : h;
+    }
+    return deprecationFingerprint;
+  }
+
+  /**
+   * @return the keys replacing a deprecated key, or null if the key is not
+   *         deprecated
+   */
+  static String[] getDeprecatedNewKeys(String key) {
+    DeprecatedKeyInfo keyInfo = deprecatedKeyMap.get(key);
+    return keyInfo == null ? null : keyInfo.newKeys;
+  }
+
   /**
    * Adds the deprecated key to the deprecation map when no custom message
    * is provided.
@@ -346,8 +372,148 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
     addDeprecatedKeys();
   }
   
-  private Properties properties;
-  private Properties overlay;
+  /**
+   * Marks a key of the overlay removed through {@link #getProps()}.
+   * Compared by identity.
+   */
+  private static final String REMOVED = new String("<removed>");
+
+  /** The most expanded values kept for each state. */
+  private static final int MAX_EXPANSIONS = 1024;
+
+  /**
+   * The properties of a configuration: a table of those loaded from its
+   * resources, shared with its clones, and an overlay of those set on it.
+   * A state is published whole, so reads take no lock. The overlay is only
+   * changed in place while no clone shares it.
+   */
+  private static final class State {
+    /** The loaded properties, or null until the resources are loaded. */
+    final PropertyTable base;
+    /** The properties set on the configuration, or null if none are. */
+    final ConcurrentHashMap<String, String> overlay;
+    /** Values with their variables expanded, created on first use. */
+    private volatile ConcurrentHashMap<String, Expansion> expansions;
+
+    State(PropertyTable base, ConcurrentHashMap<String, String> overlay) {
+      this.base = base;
+      this.overlay = overlay;
+    }
+
+    /** @return the value of a key, without variable expansion */
+    String get(String name) {
+      if (overlay != null) {
+        String value = overlay.get(name);
+        if (value != null) {
+          return value == REMOVED ? null : value;
+        }
+      }
+      return base.get(name);
+    }
+
+    /** @return the resource that last set a key */
+    String getSource(String name) {
+      if (overlay != null && overlay.containsKey(name)) {
+        return UNKNOWN_RESOURCE;
+      }
+      int slot = base.find(name);
+      return slot < 0 ? null : base.sourceAt(slot);
+    }
+
+    int size() {
+      int size = base.size();
+      if (overlay != null) {
+        for (Map.Entry<String, String> item : overlay.entrySet()) {
+          boolean loaded = base.find(item.getKey()) >= 0;
+          if (item.getValue() == REMOVED) {
+            size -= loaded ? 1 : 0;
+          } else {
+            size += loaded ? 0 : 1;
+          }
+        }
+      }
+      return size;
+    }
+
+    /** @return a copy of the properties */
+    Map<String, String> toMap() {
+      Map<String, String> result = new HashMap<String, String>();
+      for (int i = 0; i < base.capacity(); i++) {
+        String key = base.keyAt(i);
+        if (key != null) {
+          result.put(key, base.valueAt(i));
+        }
+      }
+      if (overlay != null) {
+        for (Map.Entry<String, String> item : overlay.entrySet()) {
+          if (item.getValue() == REMOVED) {
+            result.remove(item.getKey());
+          } else {
+            result.put(item.getKey(), item.getValue());
+          }
+        }
+      }
+      return result;
+    }
+
+    Expansion getExpansion(String expr) {
+      ConcurrentHashMap<String, Expansion> map = expansions;
+      return map == null ? null : map.get(expr);
+    }
+
+    void putExpansion(String expr, Expansion expansion) {
+      ConcurrentHashMap<String, Expansion> map = expansions;
+      if (map == null) {
+        synchronized (this) {
+          map = expansions;
+          if (map == null) {
+            map = new ConcurrentHashMap<String, Expansion>(16, 0.75f, 4);
+            expansions = map;
+          }
+        }
+      }
+      if (map.size() < MAX_EXPANSIONS || map.containsKey(expr)) {
+        map.put(expr, expansion);
+      }
+    }
+  }
+
+  /**
+   * A value with its variables expanded, and the system properties looked
+   * up on the way, which may have changed since.
+   */
+  private static final class Expansion {
+    final String value;
+    private final String[] vars;
+    private final String[] sysValues;
+
+    Expansion(String value, List<String> vars, List<String> sysValues) {
+      this.value = value;
+      this.vars = vars.toArray(new String[vars.size()]);
+      this.sysValues = sysValues.toArray(new String[sysValues.size()]);
+    }
+
+    boolean isCurrent() {
+      try {
+        for (int i = 0; i < vars.length; i++) {
+          String sysValue = System.getProperty(vars[i]);
+          if (sysValue == null ? sysValues[i] != null
+                               : !sysValue.equals(sysValues[i])) {
+            return false;
+          }
+        }
+        return true;
+      } catch (SecurityException se) {
+        return false;
+      }
+    }
+  }
+
+  private volatile State state = new State(null, null);
+  /** Whether a clone may share the overlay of the state. */
+  private boolean overlayShared;
+  /** What {@link #getProps()} returned, if it has been called. */
+  private PropertiesView propsView;
   private ClassLoader classLoader;
   {
     classLoader = Thread.currentThread().getContextClassLoader();
@@ -370,7 +536,6 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    */
   public Configuration(boolean loadDefaults) {
     this.loadDefaults = loadDefaults;
-    updatingResource = new HashMap<String, String>();
     synchronized(Configuration.class) {
       REGISTRY.put(this, null);
     }
@@ -378,6 +543,8 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
   
   /** 
    * A new configuration with the same settings cloned from another.
+   * The two share their properties until either is changed, so a clone
+   * costs little more than an empty configuration.
    * 
    * @param other the configuration from which to clone settings.
    */
@@ -385,18 +552,11 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
   public Configuration(Configuration other) {
    this.resources = (ArrayList)other.resources.clone();
    synchronized(other) {
-     if (other.properties != null) {
-       this.properties = (Properties)other.properties.clone();
-     }
-
-     if (other.overlay!=null) {
-       this.overlay = (Properties)other.overlay.clone();
-     }
-
-     this.updatingResource = new HashMap<String, String>(other.updatingResource);
+     this.state = other.state;
+     this.overlayShared = true;
+     other.overlayShared = true;
    }
    
-    this.finalParameters = new HashSet<String>(other.finalParameters);
     synchronized(Configuration.class) {
       REGISTRY.put(this, null);
     }
@@ -484,8 +644,8 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    * via set methods will overlay values read from the resources.
    */
   public synchronized void reloadConfiguration() {
-    properties = null;                            // trigger reload
-    finalParameters.clear();                      // clear site-limits
+    state = new State(null, state.overlay);       // trigger reload
+    propsView = null;
   }
   
   private synchronized void addResourceObject(Object resource) {
@@ -496,15 +656,22 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
   private static Pattern varPat = Pattern.compile("\\$\\{[^\\}\\$\u0020]+\\}");
   private static int MAX_SUBST = 20;
 
-  private String substituteVars(String expr) {
-    if (expr == null) {
-      return null;
+  private String substituteVars(State current, String expr) {
+    if (expr == null || expr.indexOf("${") < 0) {
+      return expr;
+    }
+    Expansion expansion = current.getExpansion(expr);
+    if (expansion != null && expansion.isCurrent()) {
+      return expansion.value;
     }
+    List<String> vars = new ArrayList<String>();
+    List<String> sysValues = new ArrayList<String>();
     Matcher match = varPat.matcher("");
     String eval = expr;
     for(int s=0; s<MAX_SUBST; s++) {
       match.reset(eval);
       if (!match.find()) {
+        current.putExpansion(expr, new Expansion(eval, vars, sysValues));
         return eval;
       }
       String var = match.group();
@@ -515,11 +682,15 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
       } catch(SecurityException se) {
         LOG.warn("Unexpected SecurityException in Configuration", se);
       }
+      vars.add(var);
+      sysValues.add(val);
       if (val == null) {
-        val = getRaw(var);
+        val = current.get(handleDeprecation(var));
       }
       if (val == null) {
-        return eval; // return literal ${var}: var is unbound
+        // return literal ${var}: var is unbound
+        current.putExpansion(expr, new Expansion(eval, vars, sysValues));
+        return eval;
       }
       // substitute
       eval = eval.substring(0, match.start())+val+eval.substring(match.end());
@@ -542,7 +713,8 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    */
   public String get(String name) {
     name = handleDeprecation(name);
-    return substituteVars(getProps().getProperty(name));
+    State current = getState();
+    return substituteVars(current, current.get(name));
   }
 
   /**
@@ -557,7 +729,7 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    */
   public String getRaw(String name) {
     name = handleDeprecation(name);
-    return getProps().getProperty(name);
+    return getState().get(name);
   }
 
   /** 
@@ -569,20 +741,14 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    * @param value property value.
    */
   public void set(String name, String value) {
-    if (deprecatedKeyMap.isEmpty()) {
-      getProps();
-    }
     if (!isDeprecated(name)) {
-      getOverlay().setProperty(name, value);
-      getProps().setProperty(name, value);
-      updatingResource.put(name, UNKNOWN_RESOURCE);
+      setOverlay(name, value);
     }
     else {
       DeprecatedKeyInfo keyInfo = deprecatedKeyMap.get(name);
       LOG.warn(keyInfo.getWarningMessage(name));
       for (String newKey : keyInfo.newKeys) {
-        getOverlay().setProperty(newKey, value);
-        getProps().setProperty(newKey, value);
+        setOverlay(newKey, value);
       }
     }
   }
@@ -598,11 +764,31 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
     }
   }
   
-  private synchronized Properties getOverlay() {
-    if (overlay==null){
-      overlay=new Properties();
+  /**
+   * Set a key in the overlay, or remove it with {@link #REMOVED}. The
+   * overlay is copied first if a clone may share it.
+   */
+  private synchronized void setOverlay(String name, String value) {
+    if (name == null || value == null) {
+      throw new NullPointerException();
+    }
+    State current = state;
+    ConcurrentHashMap<String, String> overlay = current.overlay;
+    if (overlay == null || overlayShared) {
+      int size = overlay == null ? 0 : overlay.size();
+      ConcurrentHashMap<String, String> copy =
+        new ConcurrentHashMap<String, String>(Math.max(16, 2 * size), 0.75f, 1);
+      if (overlay != null) {
+        copy.putAll(overlay);
+      }
+      overlay = copy;
+      overlayShared = false;
+    }
+    overlay.put(name, value);
+    state = new State(current.base, overlay);
+    if (propsView != null) {
+      propsView.update(name, value);
     }
-    return overlay;
   }
 
   /** 
@@ -619,7 +805,9 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    */
   public String get(String name, String defaultValue) {
     name = handleDeprecation(name);
-    return substituteVars(getProps().getProperty(name, defaultValue));
+    State current = getState();
+    String value = current.get(name);
+    return substituteVars(current, value == null ? defaultValue : value);
   }
     
   /** 
@@ -1318,18 +1506,133 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
     }
   }
 
-  protected synchronized Properties getProps() {
-    if (properties == null) {
-      properties = new Properties();
+  /** @return the current state, with the resources loaded */
+  private State getState() {
+    State current = state;
+    return current.base != null ? current : loadState();
+  }
+
+  private synchronized State loadState() {
+    State current = state;
+    if (current.base == null) {
+      PropertyTable.Builder properties = new PropertyTable.Builder();
       loadResources(properties, resources, quietmode);
-      if (overlay!= null) {
-        properties.putAll(overlay);
-        for (Map.Entry<Object,Object> item: overlay.entrySet()) {
-          updatingResource.put((String) item.getKey(), UNKNOWN_RESOURCE);
+      current = new State(properties.build(), current.overlay);
+      state = current;
+    }
+    return current;
+  }
+
+  /**
+   * The properties of this configuration, as a {@link Properties} that
+   * follows later changes to the configuration and passes changes made to
+   * it back. It is kept for subclasses; the configuration itself does not
+   * read through it.
+   *
+   * @return the properties of this configuration.
+   */
+  protected synchronized Properties getProps() {
+    if (propsView == null) {
+      propsView = new PropertiesView(getState());
+    }
+    return propsView;
+  }
+
+  /**
+   * The {@link Properties} returned by {@link #getProps()}. The
+   * configuration's changes are mirrored with {@link #update} while the
+   * configuration is locked, so its own changes lock the configuration
+   * before the table too: {@link java.util.Hashtable}'s bulk mutators hold the table
+   * while calling {@link #put}, which would otherwise lock the two in the
+   * opposite order.
+   */
+  private class PropertiesView extends Properties {
+    private static final long serialVersionUID = 1L;
+
+    PropertiesView(State current) {
+      for (Map.Entry<String, String> item : current.toMap().entrySet()) {
+        super.put(item.getKey(), item.getValue());
+      }
+    }
+
+    /** Mirror a key set in the configuration. */
+    void update(String name, String value) {
+      if (value == REMOVED) {
+        super.remove(name);
+      } else {
+        super.put(name, value);
+      }
+    }
+
+    /** Mirror the configuration being cleared. */
+    void clearQuietly() {
+      super.clear();
+    }
+
+    @Override
+    public Object put(Object key, Object value) {
+      synchronized (Configuration.this) {
+        Object old = super.put(key, value);
+        if (key instanceof String && value instanceof String) {
+          setOverlay((String) key, (String) value);
         }
+        return old;
+      }
+    }
+
+    @Override
+    public Object remove(Object key) {
+      synchronized (Configuration.this) {
+        Object old = super.remove(key);
+        if (old != null && key instanceof String) {
+          setOverlay((String) key, REMOVED);
+        }
+        return old;
+      }
+    }
+
+    @Override
+    public void clear() {
+      synchronized (Configuration.this) {
+        super.clear();
+        Configuration.this.clear();
+      }
+    }
+
+    @Override
+    public void putAll(Map<?, ?> t) {
+      synchronized (Configuration.this) {
+        super.putAll(t);
+      }
+    }
+
+    @Override
+    public Object setProperty(String key, String value) {
+      synchronized (Configuration.this) {
+        return super.setProperty(key, value);
+      }
+    }
+
+    @Override
+    public void load(Reader reader) throws IOException {
+      synchronized (Configuration.this) {
+        super.load(reader);
+      }
+    }
+
+    @Override
+    public void load(InputStream inStream) throws IOException {
+      synchronized (Configuration.this) {
+        super.load(inStream);
+      }
+    }
+
+    @Override
+    public void loadFromXML(InputStream in) throws IOException {
+      synchronized (Configuration.this) {
+        super.loadFromXML(in);
       }
     }
-    return properties;
   }
 
   /**
@@ -1338,15 +1641,18 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    * @return number of keys in the configuration.
    */
   public int size() {
-    return getProps().size();
+    return getState().size();
   }
 
   /**
    * Clears all keys from the configuration.
    */
-  public void clear() {
-    getProps().clear();
-    getOverlay().clear();
+  public synchronized void clear() {
+    state = new State(PropertyTable.EMPTY, null);
+    overlayShared = false;
+    if (propsView != null) {
+      propsView.clearQuietly();
+    }
   }
 
   /**
@@ -1356,21 +1662,10 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    * @return an iterator over the entries.
    */
   public Iterator<Map.Entry<String, String>> iterator() {
-    // Get a copy of just the string to string pairs. After the old object
-    // methods that allow non-strings to be put into configurations are removed,
-    // we could replace properties with a Map<String,String> and get rid of this
-    // code.
-    Map<String,String> result = new HashMap<String,String>();
-    for(Map.Entry<Object,Object> item: getProps().entrySet()) {
-      if (item.getKey() instanceof String && 
-          item.getValue() instanceof String) {
-        result.put((String) item.getKey(), (String) item.getValue());
-      }
-    }
-    return result.entrySet().iterator();
+    return getState().toMap().entrySet().iterator();
   }
 
-  private void loadResources(Properties properties,
+  private void loadResources(PropertyTable.Builder properties,
                              ArrayList resources,
                              boolean quiet) {
     if(loadDefaults) {
@@ -1389,26 +1684,10 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
     }
   }
   
-  private void loadResource(Properties properties, Object name, boolean quiet) {
+  private void loadResource(PropertyTable.Builder properties, Object name,
+                            boolean quiet) {
     try {
-      DocumentBuilderFactory docBuilderFactory 
-        = DocumentBuilderFactory.newInstance();
-      //ignore all comments inside the xml file
-      docBuilderFactory.setIgnoringComments(true);
-
-      //allow includes in the xml file
-      docBuilderFactory.setNamespaceAware(true);
-      try {
-          docBuilderFactory.setXIncludeAware(true);
-      } catch (UnsupportedOperationException e) {
-        LOG.error("Failed to set setXIncludeAware(true) for parser "
-                + docBuilderFactory
-                + ":" + e,
-                e);
-      }
-      DocumentBuilder builder = docBuilderFactory.newDocumentBuilder();
-      Document doc = null;
-      Element root = null;
+      CompiledResource compiled = null;
 
       if (name instanceof URL) {                  // an URL resource
         URL url = (URL)name;
@@ -1416,7 +1695,7 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
           if (!quiet) {
             LOG.info("parsing " + url);
           }
-          doc = builder.parse(url.toString());
+          compiled = CompiledResource.load(url);
         }
       } else if (name instanceof String) {        // a CLASSPATH resource
         URL url = getResource((String)name);
@@ -1424,7 +1703,7 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
           if (!quiet) {
             LOG.info("parsing " + url);
           }
-          doc = builder.parse(url.toString());
+          compiled = CompiledResource.load(url);
         }
       } else if (name instanceof Path) {          // a file resource
         // Can't use FileSystem API or we get an infinite loop
@@ -1435,77 +1714,38 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
           if (!quiet) {
             LOG.info("parsing " + file);
           }
-          InputStream in = new BufferedInputStream(new FileInputStream(file));
-          try {
-            doc = builder.parse(in);
-          } finally {
-            in.close();
-          }
+          compiled = CompiledResource.load(file.toURI().toURL());
         }
       } else if (name instanceof InputStream) {
-        try {
-          doc = builder.parse((InputStream)name);
-        } finally {
-          ((InputStream)name).close();
-        }
+        compiled = CompiledResource.parse((InputStream)name);
       } else if (name instanceof Element) {
-        root = (Element)name;
+        compiled = CompiledResource.fromElement((Element)name);
       }
 
-      if (doc == null && root == null) {
+      if (compiled == null) {
         if (quiet)
           return;
         throw new RuntimeException(name + " not found");
       }
 
-      if (root == null) {
-        root = doc.getDocumentElement();
-      }
-      if (!"configuration".equals(root.getTagName()))
-        LOG.fatal("bad conf file: top-level element not <configuration>");
-      NodeList props = root.getChildNodes();
-      for (int i = 0; i < props.getLength(); i++) {
-        Node propNode = props.item(i);
-        if (!(propNode instanceof Element))
-          continue;
-        Element prop = (Element)propNode;
-        if ("configuration".equals(prop.getTagName())) {
-          loadResource(properties, prop, quiet);
-          continue;
-        }
-        if (!"property".equals(prop.getTagName()))
-          LOG.warn("bad conf file: element not <property>");
-        NodeList fields = prop.getChildNodes();
-        String attr = null;
-        String value = null;
-        boolean finalParameter = false;
-        for (int j = 0; j < fields.getLength(); j++) {
-          Node fieldNode = fields.item(j);
-          if (!(fieldNode instanceof Element))
-            continue;
-          Element field = (Element)fieldNode;
-          if ("name".equals(field.getTagName()) && field.hasChildNodes())
-            attr = ((Text)field.getFirstChild()).getData().trim();
-          if ("value".equals(field.getTagName()) && field.hasChildNodes())
-            value = ((Text)field.getFirstChild()).getData();
-          if ("final".equals(field.getTagName()) && field.hasChildNodes())
-            finalParameter = "true".equals(((Text)field.getFirstChild()).getData());
-        }
-        
-        // Ignore this parameter if it has already been marked as 'final'
-        if (attr != null) {
-          if (deprecatedKeyMap.containsKey(attr)) {
-            DeprecatedKeyInfo keyInfo = deprecatedKeyMap.get(attr);
+      for (int i = 0; i < compiled.size(); i++) {
+        String attr = compiled.getName(i);
+        String value = compiled.getValue(i);
+        boolean finalParameter = compiled.isFinal(i);
+        String[] newKeys = compiled.getNewKeys(i);
+        if (newKeys != null) {
+          DeprecatedKeyInfo keyInfo = deprecatedKeyMap.get(attr);
+          if (keyInfo != null) {
             keyInfo.accessed = false;
-            for (String key:keyInfo.newKeys) {
-              // update new keys with deprecated key's value 
-              loadProperty(properties, name, key, value, finalParameter);
-            }
           }
-          else {
-            loadProperty(properties, name, attr, value, finalParameter);
+          for (String key:newKeys) {
+            // update new keys with deprecated key's value 
+            loadProperty(properties, name, key, value, finalParameter);
           }
         }
+        else {
+          loadProperty(properties, name, attr, value, finalParameter);
+        }
       }
         
     } catch (IOException e) {
@@ -1514,28 +1754,21 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
     } catch (DOMException e) {
       LOG.fatal("error parsing conf file: " + e);
       throw new RuntimeException(e);
-    } catch (SAXException e) {
-      LOG.fatal("error parsing conf file: " + e);
-      throw new RuntimeException(e);
-    } catch (ParserConfigurationException e) {
-      LOG.fatal("error parsing conf file: " + e);
-      throw new RuntimeException(e);
     }
   }
 
-  private void loadProperty(Properties properties, Object name, String attr,
-      String value, boolean finalParameter) {
+  private void loadProperty(PropertyTable.Builder properties, Object name,
+      String attr, String value, boolean finalParameter) {
     if (value != null) {
-      if (!finalParameters.contains(attr)) {
-        properties.setProperty(attr, value);
-        updatingResource.put(attr, name.toString());
+      if (!properties.isFinal(attr)) {
+        properties.put(attr, value, name.toString());
       } else {
         LOG.warn(name+":an attempt to override final parameter: "+attr
             +";  Ignoring.");
       }
     }
     if (finalParameter) {
-      finalParameters.add(attr);
+      properties.setFinal(attr);
     }
   }
 
@@ -1555,31 +1788,23 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
    * 
    * @param out the writer to write to.
    */
-  public synchronized void writeXml(Writer out) throws IOException {
-    Properties properties = getProps();
+  public void writeXml(Writer out) throws IOException {
+    State current = getState();
     try {
       Document doc =
         DocumentBuilderFactory.newInstance().newDocumentBuilder().newDocument();
       Element conf = doc.createElement("configuration");
       doc.appendChild(conf);
       conf.appendChild(doc.createTextNode("\n"));
-      for (Enumeration e = properties.keys(); e.hasMoreElements();) {
-        String name = (String)e.nextElement();
-        Object object = properties.get(name);
-        String value = null;
-        if (object instanceof String) {
-          value = (String) object;
-        }else {
-          continue;
-        }
+      for (Map.Entry<String, String> item : current.toMap().entrySet()) {
+        String name = item.getKey();
+        String value = item.getValue();
         Element propNode = doc.createElement("property");
         conf.appendChild(propNode);
 
-        if (updatingResource != null) {
-          Comment commentNode = doc.createComment(
-            "Loaded from " + updatingResource.get(name));
-          propNode.appendChild(commentNode);
-        }
+        Comment commentNode = doc.createComment(
+          "Loaded from " + current.getSource(name));
+        propNode.appendChild(commentNode);
         Element nameNode = doc.createElement("name");
         nameNode.appendChild(doc.createTextNode(name));
         propNode.appendChild(nameNode);
@@ -1622,18 +1847,17 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
     dumpGenerator.writeFieldName("properties");
     dumpGenerator.writeStartArray();
     dumpGenerator.flush();
-    synchronized (config) {
-      for (Map.Entry<Object,Object> item: config.getProps().entrySet()) {
-        dumpGenerator.writeStartObject();
-        dumpGenerator.writeStringField("key", (String) item.getKey());
-        dumpGenerator.writeStringField("value", 
-                                       config.get((String) item.getKey()));
-        dumpGenerator.writeBooleanField("isFinal",
-                                        config.finalParameters.contains(item.getKey()));
-        dumpGenerator.writeStringField("resource",
-                                       config.updatingResource.get(item.getKey()));
-        dumpGenerator.writeEndObject();
-      }
+    State current = config.getState();
+    for (Map.Entry<String,String> item: current.toMap().entrySet()) {
+      dumpGenerator.writeStartObject();
+      dumpGenerator.writeStringField("key", item.getKey());
+      dumpGenerator.writeStringField("value", 
+                                     config.substituteVars(current, item.getValue()));
+      dumpGenerator.writeBooleanField("isFinal",
+                                      current.base.isFinal(item.getKey()));
+      dumpGenerator.writeStringField("resource",
+                                     current.getSource(item.getKey()));
+      dumpGenerator.writeEndObject();
     }
     dumpGenerator.writeEndArray();
     dumpGenerator.writeEndObject();
@@ -1715,11 +1939,11 @@ public class Configuration implements Iterable<Map.Entry<String,String>>,
 
   //@Override
   public void write(DataOutput out) throws IOException {
-    Properties props = getProps();
+    Map<String, String> props = getState().toMap();
     WritableUtils.writeVInt(out, props.size());
-    for(Map.Entry<Object, Object> item: props.entrySet()) {
-      org.apache.hadoop.io.Text.writeString(out, (String) item.getKey());
-      org.apache.hadoop.io.Text.writeString(out, (String) item.getValue());
+    for(Map.Entry<String, String> item: props.entrySet()) {
+      org.apache.hadoop.io.Text.writeString(out, item.getKey());
+      org.apache.hadoop.io.Text.writeString(out, item.getValue());
     }
   }
 
@@ -0,0 +1,151 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.conf;
+
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.Map;
+import java.util.Set;
+
+/**
+ * The properties loaded from the resources of a {@link Configuration},
+ * with the resource each came from and whether it is final.
+ *
+ * <p>A table is never modified once built, so it is shared by the clones
+ * of a configuration and read without locking. The keys are kept in one
+ * open-addressed array with linear probing, at most half full.</p>
+ */
+final class PropertyTable {
+  /** A table without properties. */
+  static final PropertyTable EMPTY =
+    new Builder().build();
+
+  private final String[] keys;
+  private final String[] values;
+  private final String[] sources;
+  private final boolean[] finals;
+  private final int mask;
+  private final int size;
+
+  private PropertyTable(Map<String, String> values,
+                        Map<String, String> sources, Set<String> finals) {
+    int capacity = 2;
+    while (capacity < 2 * values.size()) {
+      capacity <<= 1;
+    }
+    this.keys = new String[capacity];
+    this.values = new String[capacity];
+    this.sources = new String[capacity];
+    this.finals = new boolean[capacity];
+    this.mask = capacity - 1;
+    this.size = values.size();
+    for (Map.Entry<String, String> e : values.entrySet()) {
+      String key = e.getKey();
+      int i = hash(key) & mask;
+      while (keys[i] != null) {
+        i = (i + 1) & mask;
+      }
+      keys[i] = key;
+      this.values[i] = e.getValue();
+      this.sources[i] = sources.get(key);
+      this.finals[i] = finals.contains(key);
+    }
+  }
+
+  private static int hash(String key) {
+    int h = key.hashCode();
+    return h ^ (h >>> 16);
+  }
+
+  /** @return the slot of a key, or -1 if it has no value */
+  int find(String key) {
+    int i = hash(key) & mask;
+    String k;
+    while ((k = keys[i]) != null) {
+      if (k == key || k.equals(key)) {
+        return i;
+      }
+      i = (i + 1) & mask;
+    }
+    return -1;
+  }
+
+  /** @return the value of a key, or null */
+  String get(String key) {
+    int i = find(key);
+    return i < 0 ? null : values[i];
+  }
+
+  /** @return whether a key was declared final by a resource */
+  boolean isFinal(String key) {
+    int i = find(key);
+    return i >= 0 && finals[i];
+  }
+
+  /** @return the number of keys with values */
+  int size() {
+    return size;
+  }
+
+  /** @return the number of slots, some of which are empty */
+  int capacity() {
+    return keys.length;
+  }
+
+  /** @return the key in a slot, or null if it is empty */
+  String keyAt(int slot) {
+    return keys[slot];
+  }
+
+  String valueAt(int slot) {
+    return values[slot];
+  }
+
+  /** @return the resource that set the value in a slot */
+  String sourceAt(int slot) {
+    return sources[slot];
+  }
+
+  boolean isFinalAt(int slot) {
+    return finals[slot];
+  }
+
+  /** Collects the properties of resources as they are loaded. */
+  static final class Builder {
+    private final Map<String, String> values = new HashMap<String, String>();
+    private final Map<String, String> sources = new HashMap<String, String>();
+    private final Set<String> finals = new HashSet<String>();
+
+    void put(String key, String value, String source) {
+      values.put(key, value);
+      sources.put(key, source);
+    }
+
+    boolean isFinal(String key) {
+      return finals.contains(key);
+    }
+
+    void setFinal(String key) {
+      finals.add(key);
+    }
+
+    PropertyTable build() {
+      return new PropertyTable(values, sources, finals);
+    }
+  }
+}
@@ -47,6 +47,8 @@ public class CommonConfigurationKeys {
   public static final int     FS_PERMISSIONS_UMASK_DEFAULT = 0022;
   public static final String  FS_DF_INTERVAL_KEY = "fs.df.interval"; 
   public static final long    FS_DF_INTERVAL_DEFAULT = 60000;
+  public static final String  FS_GLOB_THREADS_KEY = "fs.glob.threads";
+  public static final int     FS_GLOB_THREADS_DEFAULT = 8;
 
 
   //Defaults are not specified for following keys
@@ -81,6 +83,24 @@ public class CommonConfigurationKeys {
   public static final String  IO_COMPRESSION_CODEC_LZO_BUFFERSIZE_KEY = 
                                        "io.compression.codec.lzo.buffersize";
   public static final int     IO_COMPRESSION_CODEC_LZO_BUFFERSIZE_DEFAULT = 64*1024;
+  /** Number of buffers decompressed ahead of the reader; 0 disables it. */
+  public static final String  IO_COMPRESSION_READAHEAD_BUFFERS_KEY =
+                                       "io.compression.readahead.buffers";
+  public static final int     IO_COMPRESSION_READAHEAD_BUFFERS_DEFAULT = 0;
+  public static final String  IO_COMPRESSION_READAHEAD_BUFFER_SIZE_KEY =
+                                       "io.compression.readahead.buffer.size";
+  public static final int     IO_COMPRESSION_READAHEAD_BUFFER_SIZE_DEFAULT =
+                                       64*1024;
+  /** Threads decompressing bzip2 blocks concurrently; 1 disables it. */
+  public static final String  IO_COMPRESSION_CODEC_BZIP2_DECOMPRESS_THREADS_KEY =
+                                "io.compression.codec.bzip2.decompress.threads";
+  public static final int     IO_COMPRESSION_CODEC_BZIP2_DECOMPRESS_THREADS_DEFAULT =
+                                1;
+  /** Most memory, in bytes, that the native buffer pool keeps cached. */
+  public static final String  IO_NATIVE_BUFFER_POOL_CAPACITY_KEY =
+                                "io.native.buffer.pool.capacity";
+  public static final long    IO_NATIVE_BUFFER_POOL_CAPACITY_DEFAULT =
+                                64*1024*1024;
   public static final String  IO_MAP_INDEX_INTERVAL_KEY = "io.map.index.interval";
   public static final int     IO_MAP_INDEX_INTERVAL_DEFAULT = 128;
   public static final String  IO_MAP_INDEX_SKIP_KEY = "io.map.index.skip";
@@ -139,6 +159,28 @@ public class CommonConfigurationKeys {
    * The default number of calls per handler in the queue.
    */
   public static final int IPC_SERVER_HANDLER_QUEUE_SIZE_DEFAULT = 100;
+  /** Most memory, in bytes, that the IPC server's buffer pool keeps cached. */
+  public static final String  IPC_SERVER_BUFFER_POOL_CAPACITY_KEY =
+                                       "ipc.server.buffer.pool.capacity";
+  public static final long    IPC_SERVER_BUFFER_POOL_CAPACITY_DEFAULT =
+                                       16*1024*1024;
+  /** Whether the IPC server's pooled buffers are direct buffers. */
+  public static final String  IPC_SERVER_BUFFER_POOL_DIRECT_KEY =
+                                       "ipc.server.buffer.pool.direct";
+  public static final boolean IPC_SERVER_BUFFER_POOL_DIRECT_DEFAULT = true;
+  /** The IPC server's call queue: "fifo" or "sharded". */
+  public static final String  IPC_SERVER_CALLQUEUE_KEY =
+                                       "ipc.server.callqueue";
+  public static final String  IPC_SERVER_CALLQUEUE_DEFAULT = "fifo";
+  /** Shards of a sharded call queue; 0 picks a number from the threads. */
+  public static final String  IPC_SERVER_CALLQUEUE_SHARDS_KEY =
+                                       "ipc.server.callqueue.shards";
+  public static final int     IPC_SERVER_CALLQUEUE_SHARDS_DEFAULT = 0;
+  /** Calls slower than this, in milliseconds, are logged with the time
+   * spent in each stage; negative turns the log off. */
+  public static final String  IPC_SERVER_TRACE_SLOW_CALL_MS_KEY =
+                                       "ipc.server.trace.slow.call.ms";
+  public static final long    IPC_SERVER_TRACE_SLOW_CALL_MS_DEFAULT = -1;
 
   public static final String  HADOOP_RPC_SOCKET_FACTORY_CLASS_DEFAULT_KEY = 
                                        "hadoop.rpc.socket.factory.class.default";
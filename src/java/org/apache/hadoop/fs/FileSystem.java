@@ -1163,6 +1163,8 @@ public abstract class FileSystem extends Configured implements Closeable {
    * their path names.
    * Return null if pathPattern has no glob and the path does not exist.
    * Return an empty array if pathPattern has a glob and no path matches it. 
+   * The directories matched at each level of the pattern are listed by up
+   * to <code>fs.glob.threads</code> threads at once.
    * 
    * @param pathPattern
    *          a regular expression specifying the path pattern
@@ -1175,12 +1177,14 @@ public abstract class FileSystem extends Configured implements Closeable {
       throws IOException {
     String filename = pathPattern.toUri().getPath();
     List<String> filePatterns = GlobExpander.expand(filename);
+    ParallelFileTree lister = getGlobLister();
     if (filePatterns.size() == 1) {
-      return globStatusInternal(pathPattern, filter);
+      return globStatusInternal(pathPattern, filter, lister);
     } else {
       List<FileStatus> results = new ArrayList<FileStatus>();
       for (String filePattern : filePatterns) {
-        FileStatus[] files = globStatusInternal(new Path(filePattern), filter);
+        FileStatus[] files = globStatusInternal(new Path(filePattern), filter,
+                                                lister);
         for (FileStatus file : files) {
           results.add(file);
         }
@@ -1189,8 +1193,26 @@ public abstract class FileSystem extends Configured implements Closeable {
     }
   }
 
-  private FileStatus[] globStatusInternal(Path pathPattern, PathFilter filter)
-      throws IOException {
+  /** @return the walker for the listings of globs, or null to list serially */
+  private ParallelFileTree getGlobLister() {
+    Configuration conf = getConf();
+    int threads = conf == null ? CommonConfigurationKeys.FS_GLOB_THREADS_DEFAULT
+      : conf.getInt(CommonConfigurationKeys.FS_GLOB_THREADS_KEY,
+                    CommonConfigurationKeys.FS_GLOB_THREADS_DEFAULT);
+    return threads > 1 ? ParallelFileTree.getLister(threads) : null;
+  }
+
+  /* List several directories with the walker, if there is one. */
+  private FileStatus[] globListStatus(Path[] dirs, PathFilter filter,
+      ParallelFileTree lister) throws IOException {
+    if (lister == null || dirs.length < 2) {
+      return listStatus(dirs, filter);
+    }
+    return lister.listStatus(this, dirs, filter);
+  }
+
+  private FileStatus[] globStatusInternal(Path pathPattern, PathFilter filter,
+      ParallelFileTree lister) throws IOException {
     Path[] parents = new Path[1];
     int level = 0;
     String filename = pathPattern.toUri().getPath();
@@ -1212,16 +1234,26 @@ public abstract class FileSystem extends Configured implements Closeable {
 
     // glob the paths that match the parent path, i.e., [0, components.length-1]
     boolean[] hasGlob = new boolean[]{false};
-    Path[] parentPaths = globPathsLevel(parents, components, level, hasGlob);
+    Path[] parentPaths = globPathsLevel(parents, components, level, hasGlob,
+                                        lister);
     FileStatus[] results;
     if (parentPaths == null || parentPaths.length == 0) {
       results = null;
     } else {
       // Now work on the last component of the path
-      GlobFilter fp = new GlobFilter(components[components.length - 1], filter);
+      String last = components[components.length - 1];
+      GlobFilter fp = new GlobFilter(last, filter);
       if (fp.hasPattern()) { // last component has a pattern
         // list parent directories and then glob the results
-        results = listStatus(parentPaths, fp);
+        if (lister == null) {
+          results = listStatus(parentPaths, fp);
+        } else {
+          // the user's filter need not be thread-safe, so it is applied
+          // here rather than by the threads listing
+          results = accepted(
+              globListStatus(parentPaths, new GlobFilter(last), lister),
+              filter);
+        }
         hasGlob[0] = true;
       } else { // last component does not have a pattern
         // get all the path names
@@ -1234,8 +1266,9 @@ public abstract class FileSystem extends Configured implements Closeable {
           }
         }
         // get all their statuses
-        results = getFileStatus(
-            filteredPaths.toArray(new Path[filteredPaths.size()]));
+        Path[] paths = filteredPaths.toArray(new Path[filteredPaths.size()]);
+        results = lister == null || paths.length < 2 ? getFileStatus(paths)
+          : lister.getFileStatus(this, paths);
       }
     }
 
@@ -1256,12 +1289,28 @@ public abstract class FileSystem extends Configured implements Closeable {
     return results;
   }
 
+  /* The statuses whose paths are accepted by a filter. */
+  private static FileStatus[] accepted(FileStatus[] statuses,
+                                       PathFilter filter) {
+    if (filter == DEFAULT_FILTER) {
+      return statuses;
+    }
+    ArrayList<FileStatus> results = new ArrayList<FileStatus>(statuses.length);
+    for (FileStatus status : statuses) {
+      if (filter.accept(status.getPath())) {
+        results.add(status);
+      }
+    }
+    return results.toArray(new FileStatus[results.size()]);
+  }
+
   /*
    * For a path of N components, return a list of paths that match the
    * components [<code>level</code>, <code>N-1</code>].
    */
   private Path[] globPathsLevel(Path[] parents, String[] filePattern,
-      int level, boolean[] hasGlob) throws IOException {
+      int level, boolean[] hasGlob, ParallelFileTree lister)
+      throws IOException {
     if (level == filePattern.length - 1)
       return parents;
     if (parents == null || parents.length == 0) {
@@ -1269,14 +1318,14 @@ public abstract class FileSystem extends Configured implements Closeable {
     }
     GlobFilter fp = new GlobFilter(filePattern[level]);
     if (fp.hasPattern()) {
-      parents = FileUtil.stat2Paths(listStatus(parents, fp));
+      parents = FileUtil.stat2Paths(globListStatus(parents, fp, lister));
       hasGlob[0] = true;
     } else {
       for (int i = 0; i < parents.length; i++) {
         parents[i] = new Path(parents[i], filePattern[level]);
       }
     }
-    return globPathsLevel(parents, filePattern, level + 1, hasGlob);
+    return globPathsLevel(parents, filePattern, level + 1, hasGlob, lister);
   }
 
   /* A class that could decide if a string matches the glob or not */
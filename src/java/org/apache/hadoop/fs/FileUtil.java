@@ -28,6 +28,7 @@ import org.apache.hadoop.classification.InterfaceStability;
 import org.apache.hadoop.conf.Configuration;
 import org.apache.hadoop.io.IOUtils;
 import org.apache.hadoop.util.StringUtils;
+import org.apache.hadoop.io.nativeio.NativeIO;
 import org.apache.hadoop.util.Shell;
 import org.apache.hadoop.util.Shell.ShellCommandExecutor;
 
@@ -76,11 +77,23 @@ public class FileUtil {
       return stat2Paths(stats);
   }
   
+  /**
+   * Trees are walked in parallel by {@link ParallelFileTree}, unless they
+   * are named by a subclass of File, whose listing and deletion we call.
+   */
+  private static boolean isPlainFile(File f) {
+    return f.getClass() == File.class;
+  }
+
   /**
    * Delete a directory and all its contents.  If
    * we return false, the directory may be partially-deleted.
+   * Subdirectories are deleted in parallel.
    */
   public static boolean fullyDelete(File dir) throws IOException {
+    if (isPlainFile(dir)) {
+      return ParallelFileTree.getDefault().fullyDelete(dir);
+    }
     if (!fullyDeleteContents(dir)) {
       return false;
     }
@@ -92,6 +105,9 @@ public class FileUtil {
    * we return false, the directory may be partially-deleted.
    */
   public static boolean fullyDeleteContents(File dir) throws IOException {
+    if (isPlainFile(dir)) {
+      return ParallelFileTree.getDefault().fullyDeleteContents(dir);
+    }
     boolean deletionSucceeded = true;
     File contents[] = dir.listFiles();
     if (contents != null) {
@@ -300,6 +316,10 @@ public class FileUtil {
                              FileSystem dstFS, Path dst,
                              boolean deleteSource,
                              Configuration conf) throws IOException {
+    if (isPlainFile(src)) {
+      return ParallelFileTree.getDefault().copy(src, dstFS, dst,
+                                                deleteSource, conf);
+    }
     dst = checkDest(src.getName(), dstFS, dst, false);
 
     if (src.isDirectory()) {
@@ -368,7 +388,7 @@ public class FileUtil {
     }
   }
 
-  private static Path checkDest(String srcName, FileSystem dstFS, Path dst,
+  static Path checkDest(String srcName, FileSystem dstFS, Path dst,
       boolean overwrite) throws IOException {
     if (dstFS.exists(dst)) {
       FileStatus sdst = dstFS.getFileStatus(dst);
@@ -567,7 +587,8 @@ public class FileUtil {
   /**
    * Class for creating hardlinks.
    * Supports Unix, Cygwin, WindXP.
-   *  
+   * Links are made with system calls when libhadoop is loaded, and with
+   * shell commands otherwise.
    */
   public static class HardLink { 
     enum OSType {
@@ -621,16 +642,21 @@ public class FileUtil {
      */
     public static void createHardLink(File target, 
                                       File linkName) throws IOException {
-      int len = hardLinkCommand.length;
+      if (NativeIO.isNativeLoaded()) {
+        NativeIO.link(target.getPath(), linkName.getPath());
+        return;
+      }
+      String[] cmd = hardLinkCommand.clone();
+      int len = cmd.length;
       if (osType == OSType.OS_TYPE_WINXP) {
-       hardLinkCommand[len-1] = target.getCanonicalPath();
-       hardLinkCommand[len-2] = linkName.getCanonicalPath();
+       cmd[len-1] = target.getCanonicalPath();
+       cmd[len-2] = linkName.getCanonicalPath();
       } else {
-       hardLinkCommand[len-2] = makeShellPath(target, true);
-       hardLinkCommand[len-1] = makeShellPath(linkName, true);
+       cmd[len-2] = makeShellPath(target, true);
+       cmd[len-1] = makeShellPath(linkName, true);
       }
       // execute shell command
-      Process process = Runtime.getRuntime().exec(hardLinkCommand);
+      Process process = Runtime.getRuntime().exec(cmd);
       try {
         if (process.waitFor() != 0) {
           String errMsg = new BufferedReader(new InputStreamReader(
@@ -648,6 +674,27 @@ public class FileUtil {
       }
     }
 
+    /**
+     * Creates a hardlink in linkDir for each of the given files of
+     * parentDir, under the same name. With libhadoop, the directories are
+     * opened once for all the links.
+     *
+     * @param parentDir the directory of the existing files
+     * @param fileBaseNames the names of the files in parentDir
+     * @param linkDir the directory to create the links in
+     * @throws IOException if a link fails; the files before it are linked
+     */
+    public static void createHardLinkMult(File parentDir,
+        String[] fileBaseNames, File linkDir) throws IOException {
+      if (NativeIO.isNativeLoaded()) {
+        NativeIO.linkAll(parentDir, fileBaseNames, linkDir);
+        return;
+      }
+      for (String name : fileBaseNames) {
+        createHardLink(new File(parentDir, name), new File(linkDir, name));
+      }
+    }
+
     /**
      * Retrieves the number of links to the specified file.
      */
@@ -655,6 +702,9 @@ public class FileUtil {
       if (!fileName.exists()) {
         throw new FileNotFoundException(fileName + " not found.");
       }
+      if (NativeIO.isNativeLoaded()) {
+        return NativeIO.getLinkCount(fileName.getPath());
+      }
 
       int len = getLinkCountCommand.length;
       String[] cmd = new String[len + 1];
@@ -717,6 +767,15 @@ public class FileUtil {
    * @return value returned by the command
    */
   public static int symLink(String target, String linkname) throws IOException{
+    if (NativeIO.isNativeLoaded()) {
+      try {
+        NativeIO.symlink(target, linkname);
+        return 0;
+      } catch (IOException e) {
+        LOG.warn(e.getMessage());
+        return 1; // as ln fails
+      }
+    }
     String cmd = "ln -s " + target + " " + linkname;
     Process p = Runtime.getRuntime().exec(cmd, null);
     int returnVal = -1;
@@ -20,6 +20,14 @@ package org.apache.hadoop.fs;
 
 import java.io.*;
 import java.util.*;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLong;
 
 import org.apache.commons.logging.*;
 
@@ -31,20 +39,25 @@ import org.apache.hadoop.classification.InterfaceAudience;
 import org.apache.hadoop.classification.InterfaceStability;
 import org.apache.hadoop.conf.Configuration; 
 
-/** An implementation of a round-robin scheme for disk allocation for creating
- * files. The way it works is that it is kept track what disk was last
- * allocated for a file write. For the current request, the next disk from
- * the set of disks would be allocated if the free space on the disk is 
- * sufficient enough to accommodate the file that is being considered for
- * creation. If the space requirements cannot be met, the next disk in order
- * would be tried and so on till a disk is found with sufficient capacity.
- * Once a disk with sufficient space is identified, a check is done to make
- * sure that the disk is writable. Also, there is an API provided that doesn't
- * take the space requirements into consideration but just checks whether the
- * disk under consideration is writable (this should be used for cases where
- * the file size is not known apriori). An API is provided to read a path that
- * was created earlier. That API works by doing a scan of all the disks for the
- * input pathname.
+/** An implementation of a load-aware scheme for disk allocation for creating
+ * files. For each request, the least loaded disk that has sufficient free
+ * space for the file being created is allocated. The load of a disk is the
+ * number of files allocated on it with
+ * {@link #allocateForWrite(String, long, Configuration)} that are still
+ * being written, then their expected sizes; among equally loaded disks we
+ * go round-robin, starting after the disk last allocated. The free space
+ * of each disk is cached, less the sizes allocated since, and refreshed in
+ * the background every <code>fs.df.interval</code> milliseconds, so that
+ * no request waits on it. Allocation takes no lock unless the configured
+ * disks change.
+ * Once a disk is chosen, a check is done to make sure that the disk is
+ * writable; if it is not, the next choice is tried. Also, there is an API
+ * provided that doesn't take the space requirements into consideration
+ * but picks a disk with a probability proportional to its free space per
+ * active stream, and checks that it is writable (this should be used for
+ * cases where the file size is not known apriori). An API is provided to
+ * read a path that was created earlier. That API works by doing a scan of
+ * all the disks for the input pathname.
  * This implementation also provides the functionality of having multiple 
  * allocators per JVM (one for each unique functionality or context, like 
  * mapred, dfs-client, etc.). It ensures that there is only one instance of
@@ -101,9 +114,10 @@ public class LocalDirAllocator {
   }
   
   /** Get a path from the local FS. This method should be used if the size of 
-   *  the file is not known apriori. We go round-robin over the set of disks
-   *  (via the configured dirs) and return the first complete path where
-   *  we could create the parent directory of the passed path. 
+   *  the file is not known apriori. We pick disks (via the configured dirs)
+   *  in proportion to their free space per active stream and return the
+   *  first complete path where we could create the parent directory of the
+   *  passed path. 
    *  @param pathStr the requested path (this will be created on the first 
    *  available disk)
    *  @param conf the Configuration object
@@ -117,10 +131,10 @@ public class LocalDirAllocator {
   
   /** Get a path from the local FS. Pass size as 
    *  SIZE_UNKNOWN if not known apriori. We
-   *  round-robin over the set of disks (via the configured dirs) and return
-   *  the first complete path which has enough space 
-   *  @param pathStr the requested path (this will be created on the first 
-   *  available disk)
+   *  pick the least loaded of the disks (via the configured dirs) with
+   *  enough space and return the complete path on it
+   *  @param pathStr the requested path (this will be created on the least 
+   *  loaded disk)
    *  @param size the size of the file that is going to be written
    *  @param conf the Configuration object
    *  @return the complete path to the file on a local disk
@@ -132,6 +146,24 @@ public class LocalDirAllocator {
     return context.getLocalPathForWrite(pathStr, size, conf);
   }
   
+  /** Get a path from the local FS to write a file of the given size, as
+   *  {@link #getLocalPathForWrite(String, long, Configuration)} does. Until
+   *  the returned allocation is closed, the file counts against the load of
+   *  its disk, so close it once the file has been written.
+   *  @param pathStr the requested path (this will be created on the least
+   *  loaded disk)
+   *  @param size the size of the file that is going to be written, or
+   *  SIZE_UNKNOWN
+   *  @param conf the Configuration object
+   *  @return the allocation of the complete path to the file on a local disk
+   *  @throws IOException
+   */
+  public Allocation allocateForWrite(String pathStr, long size,
+      Configuration conf) throws IOException {
+    AllocatorPerContext context = obtainContext(contextCfgItemName);
+    return context.allocate(pathStr, size, conf, true);
+  }
+
   /** Get a path from the local FS for reading. We search through all the
    *  configured dirs for the file's existence and return the complete
    *  path to the file when we find one 
@@ -147,8 +179,8 @@ public class LocalDirAllocator {
   }
 
   /** Creates a temporary file in the local FS. Pass size as -1 if not known 
-   *  apriori. We round-robin over the set of disks (via the configured dirs) 
-   *  and select the first complete path which has enough space. A file is
+   *  apriori. We pick the least loaded of the disks (via the configured
+   *  dirs) with enough space. A file is
    *  created on this directory. The file is guaranteed to go away when the
    *  JVM exits.
    *  @param pathStr prefix for the temporary file
@@ -194,67 +226,226 @@ public class LocalDirAllocator {
     return context.getCurrentDirectoryIndex();
   }
   
+  /**
+   * A path allocated by {@link #allocateForWrite(String, long, Configuration)}.
+   * Until it is closed, the file counts as an active stream on its directory,
+   * with its expected size outstanding, and later allocations prefer less
+   * loaded directories.
+   */
+  public static class Allocation implements Closeable {
+    private final Path path;
+    private final Volume volume; // null if not tracked
+    private final long size;
+    private final AtomicBoolean closed = new AtomicBoolean(false);
+
+    private Allocation(Path path, Volume volume, long size) {
+      this.path = path;
+      this.volume = volume;
+      this.size = size;
+    }
+
+    /** @return the complete path to the file on a local disk */
+    public Path getPath() {
+      return path;
+    }
+
+    /** The file has been written. Closing again has no effect. */
+    public void close() {
+      if (volume != null && closed.compareAndSet(false, true)) {
+        volume.release(size);
+      }
+    }
+  }
+
+  /* Refreshes the free space of the volumes in the background. */
+  private static final ThreadPoolExecutor refresher = new ThreadPoolExecutor(
+      1, 1, 60, TimeUnit.SECONDS, new LinkedBlockingQueue<Runnable>(),
+      new ThreadFactory() {
+        public Thread newThread(Runnable r) {
+          Thread t = new Daemon(r);
+          t.setName("LocalDirAllocator free space refresher");
+          return t;
+        }
+      });
+  static {
+    refresher.allowCoreThreadTimeOut(true);
+  }
+
+  /** The load and the free space of one local directory. */
+  private static class Volume implements Runnable {
+    private final File dir;
+    /* the usable space at the last refresh, less the sizes allocated since */
+    private final AtomicLong available = new AtomicLong();
+    private final AtomicInteger activeStreams = new AtomicInteger();
+    private final AtomicLong outstandingBytes = new AtomicLong();
+    private final AtomicBoolean refreshing = new AtomicBoolean(false);
+    private volatile long lastRefresh;
+
+    Volume(File dir) {
+      this.dir = dir;
+      run();
+    }
+
+    /* Refresh the free space. */
+    public void run() {
+      try {
+        available.set(dir.getUsableSpace());
+        lastRefresh = System.currentTimeMillis();
+      } finally {
+        refreshing.set(false);
+      }
+    }
+
+    /* Queue a refresh if the free space is older than interval millis. */
+    void maybeRefresh(long now, long interval) {
+      if (now - lastRefresh > interval && refreshing.compareAndSet(false, true)) {
+        try {
+          refresher.execute(this);
+        } catch (RejectedExecutionException e) {
+          refreshing.set(false);
+        }
+      }
+    }
+
+    long getAvailable() {
+      return available.get();
+    }
+
+    /* Count a file of the given size as being written here. */
+    void reserve(long size, boolean track) {
+      if (size > 0) {
+        available.addAndGet(-size);
+      }
+      if (track) {
+        activeStreams.incrementAndGet();
+        outstandingBytes.addAndGet(Math.max(size, 0));
+      }
+    }
+
+    /* The tracked file has been written. */
+    void release(long size) {
+      activeStreams.decrementAndGet();
+      outstandingBytes.addAndGet(-Math.max(size, 0));
+    }
+
+    /* Undo reserve() for a file that could not be created here. */
+    void unreserve(long size, boolean track) {
+      if (size > 0) {
+        available.addAndGet(size);
+      }
+      if (track) {
+        release(size);
+      }
+    }
+
+    /* Fewer active streams, then fewer outstanding bytes. */
+    boolean isLessLoadedThan(Volume other) {
+      int streams = activeStreams.get();
+      int otherStreams = other.activeStreams.get();
+      if (streams != otherStreams) {
+        return streams < otherStreams;
+      }
+      return outstandingBytes.get() < other.outstandingBytes.get();
+    }
+
+    int getActiveStreams() {
+      return activeStreams.get();
+    }
+  }
+
   private static class AllocatorPerContext {
 
     private final Log LOG =
       LogFactory.getLog(AllocatorPerContext.class);
 
-    private int dirNumLastAccessed;
-    private Random dirIndexRandomizer = new Random();
-    private FileSystem localFS;
-    private DF[] dirDF;
-    private String contextCfgItemName;
-    private String[] localDirs;
-    private String savedLocalDirs = "";
+    /* The usable directories of one value of the context's configuration. */
+    private static class Dirs {
+      final String savedLocalDirs;
+      final String[] localDirs;
+      final Volume[] volumes;
+      final FileSystem localFS;
+      final long refreshInterval;
+
+      Dirs(String savedLocalDirs, String[] localDirs, Volume[] volumes,
+           FileSystem localFS, long refreshInterval) {
+        this.savedLocalDirs = savedLocalDirs;
+        this.localDirs = localDirs;
+        this.volumes = volumes;
+        this.localFS = localFS;
+        this.refreshInterval = refreshInterval;
+      }
+    }
+
+    /* the directory to try first when loads are equal */
+    private final AtomicInteger nextDir = new AtomicInteger();
+    private final Random dirIndexRandomizer = new Random();
+    private final String contextCfgItemName;
+    private volatile Dirs dirs =
+      new Dirs("", new String[0], new Volume[0], null, 0);
 
     public AllocatorPerContext(String contextCfgItemName) {
       this.contextCfgItemName = contextCfgItemName;
     }
 
     /** This method gets called everytime before any read/write to make sure
-     * that any change to localDirs is reflected immediately.
+     * that any change to localDirs is reflected immediately. Only a change
+     * takes a lock.
      */
-    private void confChanged(Configuration conf) throws IOException {
+    private Dirs confChanged(Configuration conf) throws IOException {
+      Dirs current = dirs;
       String newLocalDirs = conf.get(contextCfgItemName);
-      if (!newLocalDirs.equals(savedLocalDirs)) {
-        localDirs = conf.getTrimmedStrings(contextCfgItemName);
-        localFS = FileSystem.getLocal(conf);
-        int numDirs = localDirs.length;
-        ArrayList<String> dirs = new ArrayList<String>(numDirs);
-        ArrayList<DF> dfList = new ArrayList<DF>(numDirs);
-        for (int i = 0; i < numDirs; i++) {
-          try {
-            // filter problematic directories
-            Path tmpDir = new Path(localDirs[i]);
-            if(localFS.mkdirs(tmpDir)|| localFS.exists(tmpDir)) {
-              try {
-                DiskChecker.checkDir(new File(localDirs[i]));
-                dirs.add(localDirs[i]);
-                dfList.add(new DF(new File(localDirs[i]), 30000));
-              } catch (DiskErrorException de) {
-                LOG.warn( localDirs[i] + "is not writable\n" +
-                    StringUtils.stringifyException(de));
-              }
-            } else {
-              LOG.warn( "Failed to create " + localDirs[i]);
-            }
-          } catch (IOException ie) { 
-            LOG.warn( "Failed to create " + localDirs[i] + ": " +
-                ie.getMessage() + "\n" + StringUtils.stringifyException(ie));
-          } //ignore
+      if (newLocalDirs.equals(current.savedLocalDirs)) {
+        return current;
+      }
+      synchronized (this) {
+        current = dirs;
+        if (!newLocalDirs.equals(current.savedLocalDirs)) {
+          current = createDirs(newLocalDirs, conf);
+          // randomize the first disk picked
+          nextDir.set(current.volumes.length == 0 ? 0
+              : dirIndexRandomizer.nextInt(current.volumes.length));
+          dirs = current;
         }
-        localDirs = dirs.toArray(new String[dirs.size()]);
-        dirDF = dfList.toArray(new DF[dirs.size()]);
-        savedLocalDirs = newLocalDirs;
-        
-        // randomize the first disk picked in the round-robin selection 
-        dirNumLastAccessed = dirIndexRandomizer.nextInt(dirs.size());
+        return current;
       }
     }
 
-    private Path createPath(String path) throws IOException {
-      Path file = new Path(new Path(localDirs[dirNumLastAccessed]),
-                                    path);
+    private Dirs createDirs(String newLocalDirs, Configuration conf)
+        throws IOException {
+      String[] localDirs = conf.getTrimmedStrings(contextCfgItemName);
+      FileSystem localFS = FileSystem.getLocal(conf);
+      int numDirs = localDirs.length;
+      ArrayList<String> dirs = new ArrayList<String>(numDirs);
+      ArrayList<Volume> volumes = new ArrayList<Volume>(numDirs);
+      for (int i = 0; i < numDirs; i++) {
+        try {
+          // filter problematic directories
+          Path tmpDir = new Path(localDirs[i]);
+          if(localFS.mkdirs(tmpDir)|| localFS.exists(tmpDir)) {
+            try {
+              DiskChecker.checkDir(new File(localDirs[i]));
+              dirs.add(localDirs[i]);
+              volumes.add(new Volume(new File(localDirs[i])));
+            } catch (DiskErrorException de) {
+              LOG.warn( localDirs[i] + "is not writable\n" +
+                  StringUtils.stringifyException(de));
+            }
+          } else {
+            LOG.warn( "Failed to create " + localDirs[i]);
+          }
+        } catch (IOException ie) { 
+          LOG.warn( "Failed to create " + localDirs[i] + ": " +
+              ie.getMessage() + "\n" + StringUtils.stringifyException(ie));
+        } //ignore
+      }
+      return new Dirs(newLocalDirs, dirs.toArray(new String[dirs.size()]),
+          volumes.toArray(new Volume[volumes.size()]), localFS,
+          conf.getLong(CommonConfigurationKeys.FS_DF_INTERVAL_KEY,
+                       CommonConfigurationKeys.FS_DF_INTERVAL_DEFAULT));
+    }
+
+    private Path createPath(String dir, String path) throws IOException {
+      Path file = new Path(new Path(dir), path);
       //check whether we are able to create a directory here. If the disk
       //happens to be RDONLY we will fail
       try {
@@ -271,7 +462,7 @@ public class LocalDirAllocator {
      * @return the current directory index.
      */
     int getCurrentDirectoryIndex() {
-      return dirNumLastAccessed;
+      return nextDir.get();
     }
     
     /** Get a path from the local FS. This method should be used if the size of 
@@ -280,71 +471,61 @@ public class LocalDirAllocator {
      *  It will use roulette selection, picking directories
      *  with probability proportional to their available space. 
      */
-    public synchronized Path getLocalPathForWrite(String path, 
+    public Path getLocalPathForWrite(String path, 
         Configuration conf) throws IOException {
       return getLocalPathForWrite(path, SIZE_UNKNOWN, conf);
     }
 
-    /** Get a path from the local FS. If size is known, we go
-     *  round-robin over the set of disks (via the configured dirs) and return
-     *  the first complete path which has enough space.
+    /** Get a path from the local FS. If size is known, we pick the least
+     *  loaded directory with enough space, going round-robin over the
+     *  configured dirs between equally loaded ones.
      *  
      *  If size is not known, use roulette selection -- pick directories
-     *  with probability proportional to their available space.
+     *  with probability proportional to their available space, divided
+     *  among their active streams.
      */
-    public synchronized Path getLocalPathForWrite(String pathStr, long size, 
+    public Path getLocalPathForWrite(String pathStr, long size, 
         Configuration conf) throws IOException {
-      confChanged(conf);
-      int numDirs = localDirs.length;
-      int numDirsSearched = 0;
+      return allocate(pathStr, size, conf, false).getPath();
+    }
+
+    /** Allocate a path as {@link #getLocalPathForWrite(String, long,
+     *  Configuration)} does. If track is true, the file counts against the
+     *  load of its directory until the allocation is closed.
+     */
+    public Allocation allocate(String pathStr, long size,
+        Configuration conf, boolean track) throws IOException {
+      Dirs current = confChanged(conf);
+      Volume[] volumes = current.volumes;
+      int numDirs = volumes.length;
       //remove the leading slash from the path (to make sure that the uri
       //resolution results in a valid path on the dir being checked)
       if (pathStr.startsWith("/")) {
         pathStr = pathStr.substring(1);
       }
-      Path returnPath = null;
-      
-      if(size == SIZE_UNKNOWN) {  //do roulette selection: pick dir with probability 
-                    //proportional to available size
-        long[] availableOnDisk = new long[dirDF.length];
-        long totalAvailable = 0;
-        
-            //build the "roulette wheel"
-        for(int i =0; i < dirDF.length; ++i) {
-          availableOnDisk[i] = dirDF[i].getAvailable();
-          totalAvailable += availableOnDisk[i];
-        }
+      long now = System.currentTimeMillis();
+      for (Volume v : volumes) {
+        v.maybeRefresh(now, current.refreshInterval);
+      }
 
-        // Keep rolling the wheel till we get a valid path
-        Random r = new java.util.Random();
-        while (numDirsSearched < numDirs && returnPath == null) {
-          long randomPosition = Math.abs(r.nextLong()) % totalAvailable;
-          int dir = 0;
-          while (randomPosition > availableOnDisk[dir]) {
-            randomPosition -= availableOnDisk[dir];
-            dir++;
-          }
-          dirNumLastAccessed = dir;
-          returnPath = createPath(pathStr);
-          if (returnPath == null) {
-            totalAvailable -= availableOnDisk[dir];
-            availableOnDisk[dir] = 0; // skip this disk
-            numDirsSearched++;
-          }
+      boolean[] excluded = new boolean[numDirs];
+      for (int numDirsSearched = 0; numDirsSearched < numDirs;
+           numDirsSearched++) {
+        int dir = size == SIZE_UNKNOWN ? pickByRoulette(volumes, excluded)
+                                       : pickLeastLoaded(volumes, size, excluded);
+        if (dir < 0) {
+          break;
         }
-      } else {
-        while (numDirsSearched < numDirs && returnPath == null) {
-          long capacity = dirDF[dirNumLastAccessed].getAvailable();
-          if (capacity > size) {
-            returnPath = createPath(pathStr);
-          }
-          dirNumLastAccessed++;
-          dirNumLastAccessed = dirNumLastAccessed % numDirs; 
-          numDirsSearched++;
-        } 
-      }
-      if (returnPath != null) {
-        return returnPath;
+        // reserve before the disk check, so concurrent callers see the load
+        Volume volume = volumes[dir];
+        volume.reserve(size, track);
+        Path returnPath = createPath(current.localDirs[dir], pathStr);
+        if (returnPath != null) {
+          nextDir.set((dir + 1) % numDirs);
+          return new Allocation(returnPath, track ? volume : null, size);
+        }
+        volume.unreserve(size, track);
+        excluded[dir] = true;
       }
       
       //no path found
@@ -352,10 +533,52 @@ public class LocalDirAllocator {
           "directory for " + pathStr);
     }
 
+    /* The least loaded dir with more than size bytes available, or -1.
+     * Ties go to the first from nextDir. */
+    private int pickLeastLoaded(Volume[] volumes, long size,
+                                boolean[] excluded) {
+      int numDirs = volumes.length;
+      int start = nextDir.get() % numDirs;
+      int best = -1;
+      for (int k = 0; k < numDirs; k++) {
+        int i = (start + k) % numDirs;
+        if (!excluded[i] && volumes[i].getAvailable() > size
+            && (best < 0 || volumes[i].isLessLoadedThan(volumes[best]))) {
+          best = i;
+        }
+      }
+      return best;
+    }
+
+    /* Pick a dir with probability proportional to its available space per
+     * active stream, or the least loaded one if no space is known. */
+    private int pickByRoulette(Volume[] volumes, boolean[] excluded) {
+      long[] weights = new long[volumes.length];
+      long totalWeight = 0;
+      for (int i = 0; i < volumes.length; i++) {
+        if (!excluded[i]) {
+          weights[i] = Math.max(volumes[i].getAvailable(), 0)
+            / (1 + volumes[i].getActiveStreams());
+          totalWeight += weights[i];
+        }
+      }
+      if (totalWeight <= 0) {
+        return pickLeastLoaded(volumes, SIZE_UNKNOWN, excluded);
+      }
+      long randomPosition =
+        (dirIndexRandomizer.nextLong() & Long.MAX_VALUE) % totalWeight;
+      int dir = 0;
+      while (randomPosition >= weights[dir]) {
+        randomPosition -= weights[dir];
+        dir++;
+      }
+      return dir;
+    }
+
     /** Creates a file on the local FS. Pass size as 
      * {@link LocalDirAllocator.SIZE_UNKNOWN} if not known apriori. We
-     *  round-robin over the set of disks (via the configured dirs) and return
-     *  a file on the first path which has enough space. The file is guaranteed
+     *  pick a directory as {@link #getLocalPathForWrite(String, long,
+     *  Configuration)} does and return a file on it. The file is guaranteed
      *  to go away when the JVM exits.
      */
     public File createTmpFileForWrite(String pathStr, long size, 
@@ -376,10 +599,10 @@ public class LocalDirAllocator {
      *  configured dirs for the file's existence and return the complete
      *  path to the file when we find one 
      */
-    public synchronized Path getLocalPathToRead(String pathStr, 
+    public Path getLocalPathToRead(String pathStr, 
         Configuration conf) throws IOException {
-      confChanged(conf);
-      int numDirs = localDirs.length;
+      Dirs current = confChanged(conf);
+      int numDirs = current.localDirs.length;
       int numDirsSearched = 0;
       //remove the leading slash from the path (to make sure that the uri
       //resolution results in a valid path on the dir being checked)
@@ -387,8 +610,8 @@ public class LocalDirAllocator {
         pathStr = pathStr.substring(1);
       }
       while (numDirsSearched < numDirs) {
-        Path file = new Path(localDirs[numDirsSearched], pathStr);
-        if (localFS.exists(file)) {
+        Path file = new Path(current.localDirs[numDirsSearched], pathStr);
+        if (current.localFS.exists(file)) {
           return file;
         }
         numDirsSearched++;
@@ -402,9 +625,10 @@ public class LocalDirAllocator {
     /** We search through all the configured dirs for the file's existence
      *  and return true when we find one 
      */
-    public synchronized boolean ifExists(String pathStr,Configuration conf) {
+    public boolean ifExists(String pathStr,Configuration conf) {
+      Dirs current = dirs;
       try {
-        int numDirs = localDirs.length;
+        int numDirs = current.localDirs.length;
         int numDirsSearched = 0;
         //remove the leading slash from the path (to make sure that the uri
         //resolution results in a valid path on the dir being checked)
@@ -412,8 +636,8 @@ public class LocalDirAllocator {
           pathStr = pathStr.substring(1);
         }
         while (numDirsSearched < numDirs) {
-          Path file = new Path(localDirs[numDirsSearched], pathStr);
-          if (localFS.exists(file)) {
+          Path file = new Path(current.localDirs[numDirsSearched], pathStr);
+          if (current.localFS.exists(file)) {
             return true;
           }
           numDirsSearched++;
@@ -19,12 +19,19 @@ package org.apache.hadoop.fs;
 
 import java.io.DataInput;
 import java.io.DataOutput;
+import java.io.File;
+import java.io.FileInputStream;
 import java.io.IOException;
+import java.io.InputStream;
+import java.security.MessageDigest;
 
 import org.apache.hadoop.classification.InterfaceAudience;
 import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.io.DataOutputBuffer;
 import org.apache.hadoop.io.MD5Hash;
 import org.apache.hadoop.io.WritableUtils;
+import org.apache.hadoop.io.nativeio.NativeChecksum;
+import org.apache.hadoop.util.PureJavaCrc32;
 import org.xml.sax.Attributes;
 import org.xml.sax.SAXException;
 import org.znerd.xmlenc.XMLOutputter;
@@ -52,6 +59,89 @@ public class MD5MD5CRC32FileChecksum extends FileChecksum {
     this.md5 = md5;
   }
   
+  /**
+   * Compute the checksum of a local file that HDFS would report for a file
+   * with the same contents, written with the same bytes per checksum and
+   * block size, so that a copy can be checked against the original without
+   * reading the two side by side. With the native library, the file is
+   * read and hashed in libhadoop.
+   *
+   * @param file the file
+   * @param bytesPerCRC the bytes covered by each CRC
+   * @param blockSize the size of the blocks the CRCs are grouped in
+   */
+  public static MD5MD5CRC32FileChecksum getLocalFileChecksum(File file,
+      int bytesPerCRC, long blockSize) throws IOException {
+    if (bytesPerCRC <= 0 || blockSize <= 0) {
+      throw new IllegalArgumentException("bytesPerCRC=" + bytesPerCRC
+          + ", blockSize=" + blockSize);
+    }
+    long length = file.length();
+    byte[] md5 = NativeChecksum.isNativeLoaded()
+      ? NativeChecksum.fileChecksum(file, bytesPerCRC, blockSize)
+      : computeFileChecksum(file, bytesPerCRC, blockSize);
+    // HDFS only reports the CRCs per block of files with several blocks
+    long crcPerBlock = length > blockSize
+      ? (blockSize + bytesPerCRC - 1) / bytesPerCRC : 0;
+    return new MD5MD5CRC32FileChecksum(bytesPerCRC, crcPerBlock,
+                                       new MD5Hash(md5));
+  }
+
+  /** Compute the MD5 of MD5 of CRC32 of a local file in Java. */
+  static byte[] computeFileChecksum(File file, int bytesPerCRC,
+      long blockSize) throws IOException {
+    PureJavaCrc32 crc = new PureJavaCrc32();
+    MessageDigest blockDigest = MD5Hash.getDigester();
+    DataOutputBuffer blockMd5s = new DataOutputBuffer();
+    byte[] crcBytes = new byte[4];
+    byte[] buf = new byte[64 * 1024];
+    int chunkLen = 0;
+    long blockLen = 0;
+    InputStream in = new FileInputStream(file);
+    try {
+      for (int n; (n = in.read(buf)) != -1; ) {
+        for (int off = 0; off < n; ) {
+          int len = (int) Math.min(Math.min(n - off, bytesPerCRC - chunkLen),
+                                   blockSize - blockLen);
+          crc.update(buf, off, len);
+          off += len;
+          chunkLen += len;
+          blockLen += len;
+          if (chunkLen == bytesPerCRC || blockLen == blockSize) {
+            updateCrc(blockDigest, crc, crcBytes);
+            chunkLen = 0;
+          }
+          if (blockLen == blockSize) {
+            blockMd5s.write(blockDigest.digest());
+            blockLen = 0;
+          }
+        }
+      }
+    } finally {
+      in.close();
+    }
+    if (chunkLen > 0) {
+      updateCrc(blockDigest, crc, crcBytes);
+    }
+    if (blockLen > 0) {
+      blockMd5s.write(blockDigest.digest());
+    }
+    return MD5Hash.digest(blockMd5s.getData(), 0,
+                          blockMd5s.getLength()).getDigest();
+  }
+
+  /** Add a chunk's CRC to the digest of its block, and reset the CRC. */
+  private static void updateCrc(MessageDigest digest, PureJavaCrc32 crc,
+                                byte[] bytes) {
+    int value = (int) crc.getValue();
+    bytes[0] = (byte) (value >>> 24);
+    bytes[1] = (byte) (value >>> 16);
+    bytes[2] = (byte) (value >>> 8);
+    bytes[3] = (byte) value;
+    digest.update(bytes);
+    crc.reset();
+  }
+
   /** {@inheritDoc} */ 
   public String getAlgorithmName() {
     return "MD5-of-" + crcPerBlock + "MD5-of-" + bytesPerCRC + "CRC32";
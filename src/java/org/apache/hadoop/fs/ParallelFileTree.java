@@ -0,0 +1,531 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.fs;
+
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileNotFoundException;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.InterruptedIOException;
+import java.io.OutputStream;
+import java.security.AccessController;
+import java.security.PrivilegedAction;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.Executor;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import javax.security.auth.Subject;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.io.IOUtils;
+import org.apache.hadoop.io.nativeio.NativeIO;
+import org.apache.hadoop.util.Daemon;
+
+/**
+ * Deletes and copies local directory trees, and lists the directories of
+ * a glob, with several threads.
+ *
+ * <p>Each directory is a task. The thread that starts a walk works on the
+ * tasks itself, and borrows up to <code>maxThreads - 1</code> helpers from
+ * an {@link Executor} while there are more tasks queued than threads
+ * working on them. A helper returns to its pool as soon as the queue is
+ * empty. The caller therefore never waits for a pool thread, so a walk
+ * also completes when it is started from a thread of the same, busy
+ * pool.</p>
+ *
+ * <p>With libhadoop, the entries of each directory are deleted with
+ * <code>unlinkat(2)</code> relative to the open directory, without
+ * following symbolic links; a symbolic link is deleted, never walked.</p>
+ */
+@InterfaceAudience.Private
+@InterfaceStability.Unstable
+public class ParallelFileTree {
+  private static final Log LOG = LogFactory.getLog(ParallelFileTree.class);
+
+  /** The threads of the shared walker used by {@link FileUtil} */
+  static final int DEFAULT_THREADS =
+    Math.max(2, Math.min(8, Runtime.getRuntime().availableProcessors()));
+
+  /* how long the starting thread waits for helpers to queue more work */
+  private static final long POLL_MILLIS = 10;
+
+  private static final String[] NO_NAMES = new String[0];
+
+  private static ParallelFileTree defaultTree;
+  private static ThreadPoolExecutor listingPool;
+
+  private final Executor executor;
+  private final int maxThreads;
+
+  /**
+   * @param executor where to run helper threads
+   * @param maxThreads the most threads, including the caller's, that work
+   *        on one walk
+   */
+  public ParallelFileTree(Executor executor, int maxThreads) {
+    if (maxThreads < 1) {
+      throw new IllegalArgumentException("maxThreads: " + maxThreads);
+    }
+    this.executor = executor;
+    this.maxThreads = maxThreads;
+  }
+
+  private static ThreadPoolExecutor newPool(final String name,
+                                            int threads) {
+    ThreadPoolExecutor pool = new ThreadPoolExecutor(
+        threads, threads, 60, TimeUnit.SECONDS,
+        new LinkedBlockingQueue<Runnable>(), new ThreadFactory() {
+          public Thread newThread(Runnable r) {
+            Thread t = new Daemon(r);
+            t.setName(name + "-" + t.getId());
+            return t;
+          }
+        });
+    pool.allowCoreThreadTimeOut(true);
+    return pool;
+  }
+
+  /** @return a walker with a shared pool of daemon threads */
+  static synchronized ParallelFileTree getDefault() {
+    if (defaultTree == null) {
+      defaultTree = new ParallelFileTree(
+          newPool("ParallelFileTree", DEFAULT_THREADS), DEFAULT_THREADS);
+    }
+    return defaultTree;
+  }
+
+  /**
+   * Get a walker for listings, which wait on the file system rather than
+   * the CPU. Its pool of daemon threads is shared, and grows to the most
+   * threads asked for.
+   *
+   * @param maxThreads the most threads, including the caller's, that work
+   *        on one walk
+   */
+  static synchronized ParallelFileTree getLister(int maxThreads) {
+    if (listingPool == null) {
+      listingPool = newPool("GlobLister", maxThreads);
+    } else if (listingPool.getMaximumPoolSize() < maxThreads) {
+      listingPool.setMaximumPoolSize(maxThreads);
+      listingPool.setCorePoolSize(maxThreads);
+    }
+    return new ParallelFileTree(listingPool, maxThreads);
+  }
+
+  /**
+   * Delete a directory and all its contents. If we return false, the
+   * directory may be partially-deleted.
+   */
+  public boolean fullyDelete(File dir) throws IOException {
+    return new DeleteWalk(dir, true).start();
+  }
+
+  /**
+   * Delete the contents of a directory, not the directory itself. If we
+   * return false, the directory may be partially-deleted.
+   */
+  public boolean fullyDeleteContents(File dir) throws IOException {
+    return new DeleteWalk(dir, false).start();
+  }
+
+  /**
+   * Copy a local file or directory tree to a FileSystem, as
+   * {@link FileUtil#copy(File, FileSystem, Path, boolean, Configuration)}
+   * does. The files are copied in parallel.
+   *
+   * @return false if a directory could not be created, or the source could
+   *         not be deleted
+   * @throws IOException if a file could not be copied; the copy stops, and
+   *         the source is not deleted
+   */
+  public boolean copy(File src, FileSystem dstFS, Path dst,
+                      boolean deleteSource, Configuration conf)
+      throws IOException {
+    CopyWalk walk = new CopyWalk(dstFS, conf);
+    walk.submit(walk.new CopyTask(src, dst, null));
+    walk.runAll();
+    if (!walk.ok) {
+      return false;
+    }
+    return deleteSource ? fullyDelete(src) : true;
+  }
+
+  /**
+   * List several paths, as {@link FileSystem#listStatus(Path[], PathFilter)}
+   * does, with the paths listed in parallel. The statuses are in the order
+   * of the paths, and each path's in the order it was listed in.
+   *
+   * @throws IOException the error of the first path that failed
+   */
+  public FileStatus[] listStatus(final FileSystem fs, Path[] paths,
+                                 final PathFilter filter) throws IOException {
+    StatusWalk walk = new StatusWalk(paths.length);
+    for (int i = 0; i < paths.length; i++) {
+      final Path path = paths[i];
+      walk.submit(walk.new StatusTask(i) {
+        FileStatus[] statuses() throws IOException {
+          return fs.listStatus(path, filter);
+        }
+      });
+    }
+    return walk.finish();
+  }
+
+  /**
+   * Get the status of several paths in parallel, in the order of the paths.
+   * Paths that do not exist are left out.
+   *
+   * @throws IOException the error of the first path that failed
+   */
+  public FileStatus[] getFileStatus(final FileSystem fs, Path[] paths)
+      throws IOException {
+    StatusWalk walk = new StatusWalk(paths.length);
+    for (int i = 0; i < paths.length; i++) {
+      final Path path = paths[i];
+      walk.submit(walk.new StatusTask(i) {
+        FileStatus[] statuses() throws IOException {
+          try {
+            return new FileStatus[] {fs.getFileStatus(path)};
+          } catch (FileNotFoundException e) {
+            return null;                  // left out
+          }
+        }
+      });
+    }
+    return walk.finish();
+  }
+
+  /* A unit of work of a walk. */
+  private interface Task {
+    void run() throws IOException;
+  }
+
+  /* The queue of tasks of one walk, and the threads working on it. */
+  private class Walk implements Runnable {
+    private final LinkedBlockingQueue<Task> tasks =
+      new LinkedBlockingQueue<Task>();
+    /* tasks queued or running */
+    private final AtomicInteger pending = new AtomicInteger();
+    /* threads working on the walk, including the caller's */
+    private final AtomicInteger workers = new AtomicInteger(1);
+    private volatile IOException error;
+
+    void submit(Task task) {
+      pending.incrementAndGet();
+      tasks.add(task);
+      if (tasks.size() > 1) {
+        addHelper();
+      }
+    }
+
+    private void addHelper() {
+      int n = workers.get();
+      if (n < maxThreads && workers.compareAndSet(n, n + 1)) {
+        try {
+          executor.execute(this);
+        } catch (RejectedExecutionException e) {
+          workers.decrementAndGet();
+        }
+      }
+    }
+
+    /* A helper: work until the queue is empty. */
+    public void run() {
+      try {
+        Task task;
+        while ((task = tasks.poll()) != null) {
+          runTask(task);
+        }
+      } finally {
+        workers.decrementAndGet();
+      }
+    }
+
+    private void runTask(Task task) {
+      try {
+        if (error == null) {
+          task.run();
+        }
+      } catch (IOException e) {
+        fail(e);
+      } catch (RuntimeException e) {
+        fail(new IOException(e.toString(), e));
+      } finally {
+        pending.decrementAndGet();
+      }
+    }
+
+    private synchronized void fail(IOException e) {
+      if (error == null) {
+        error = e;
+      }
+    }
+
+    /* The caller: work until all tasks are done. */
+    void runAll() throws IOException {
+      try {
+        while (pending.get() > 0) {
+          Task task = tasks.poll(POLL_MILLIS, TimeUnit.MILLISECONDS);
+          if (task != null) {
+            runTask(task);
+          }
+        }
+      } catch (InterruptedException e) {
+        fail(new InterruptedIOException("Interrupted while walking a tree"));
+        // let the helpers drain the queue without running the tasks
+        Thread.currentThread().interrupt();
+      }
+      if (error != null) {
+        throw error;
+      }
+    }
+  }
+
+  /*
+   * Tasks that each produce the statuses of one path. Their errors are kept
+   * by path too, so that the one reported does not depend on timing. The
+   * tasks run as the caller's subject, so that helpers list as its user.
+   */
+  private class StatusWalk extends Walk {
+    private final FileStatus[][] results;
+    private final IOException[] errors;
+    private final Subject subject =
+      Subject.getSubject(AccessController.getContext());
+
+    StatusWalk(int paths) {
+      results = new FileStatus[paths][];
+      errors = new IOException[paths];
+    }
+
+    abstract class StatusTask implements Task {
+      private final int index;
+
+      StatusTask(int index) {
+        this.index = index;
+      }
+
+      /* @return the statuses of the path, or null for none */
+      abstract FileStatus[] statuses() throws IOException;
+
+      public void run() {
+        if (subject == null) {
+          collect();
+        } else {
+          Subject.doAs(subject, new PrivilegedAction<Object>() {
+            public Object run() {
+              collect();
+              return null;
+            }
+          });
+        }
+      }
+
+      private void collect() {
+        try {
+          results[index] = statuses();
+        } catch (IOException e) {
+          errors[index] = e;
+        }
+      }
+    }
+
+    FileStatus[] finish() throws IOException {
+      runAll();
+      int total = 0;
+      for (int i = 0; i < results.length; i++) {
+        if (errors[i] != null) {
+          throw errors[i];
+        }
+        if (results[i] != null) {
+          total += results[i].length;
+        }
+      }
+      FileStatus[] all = new FileStatus[total];
+      int n = 0;
+      for (FileStatus[] result : results) {
+        if (result != null) {
+          System.arraycopy(result, 0, all, n, result.length);
+          n += result.length;
+        }
+      }
+      return all;
+    }
+  }
+
+  private class DeleteWalk extends Walk {
+    private final File root;
+    private final boolean deleteRoot;
+    private volatile boolean failed = false;
+
+    DeleteWalk(File root, boolean deleteRoot) {
+      this.root = root;
+      this.deleteRoot = deleteRoot;
+    }
+
+    boolean start() throws IOException {
+      submit(new DeleteDir(root, null));
+      runAll();
+      return !failed;
+    }
+
+    /*
+     * Delete the entries of a directory, and queue its subdirectories.
+     * The last of them to finish deletes the directory.
+     */
+    private class DeleteDir implements Task {
+      private final File dir;
+      private final DeleteDir parent;
+      /* this task and its subdirectories */
+      private final AtomicInteger remaining = new AtomicInteger(1);
+
+      DeleteDir(File dir, DeleteDir parent) {
+        this.dir = dir;
+        this.parent = parent;
+      }
+
+      public void run() throws IOException {
+        try {
+          for (String name : deleteEntries(dir, parent == null)) {
+            remaining.incrementAndGet();
+            submit(new DeleteDir(new File(dir, name), this));
+          }
+        } catch (IOException e) {
+          LOG.warn("Failed to delete the contents of " + dir + ": " + e);
+          failed = true;
+        } finally {
+          done();
+        }
+      }
+
+      private void done() {
+        if (remaining.decrementAndGet() == 0) {
+          if ((parent != null || deleteRoot) && !dir.delete()) {
+            failed = true;
+          }
+          if (parent != null) {
+            parent.done();
+          }
+        }
+      }
+    }
+
+    /*
+     * Delete the files, symbolic links and empty directories in dir.
+     * @return the names of the other subdirectories
+     */
+    private String[] deleteEntries(File dir, boolean isRoot)
+        throws IOException {
+      if (NativeIO.isNativeLoaded()) {
+        int[] failures = new int[1];
+        String[] subdirs = NativeIO.deleteEntries(dir.getPath(), failures);
+        if (failures[0] > 0) {
+          failed = true;
+        }
+        // the root may be a symbolic link to the directory to empty
+        if (subdirs != null || !isRoot) {
+          return subdirs == null ? NO_NAMES : subdirs;
+        }
+      }
+      File[] contents = dir.listFiles();
+      if (contents == null) {
+        return NO_NAMES;
+      }
+      List<String> subdirs = new ArrayList<String>();
+      for (File f : contents) {
+        if (f.isFile()) {
+          if (!f.delete()) {
+            failed = true;
+          }
+        } else if (!f.delete()) {
+          // not a symlink or an empty directory
+          subdirs.add(f.getName());
+        }
+      }
+      return subdirs.toArray(new String[subdirs.size()]);
+    }
+  }
+
+  private class CopyWalk extends Walk {
+    private final FileSystem dstFS;
+    private final Configuration conf;
+    private volatile boolean ok = true;
+
+    CopyWalk(FileSystem dstFS, Configuration conf) {
+      this.dstFS = dstFS;
+      this.conf = conf;
+    }
+
+    /* Copy a file, or create a directory and queue its entries. */
+    private class CopyTask implements Task {
+      private final File src;
+      private final Path dst;
+      private final CopyTask parent;
+
+      CopyTask(File src, Path dst, CopyTask parent) {
+        this.src = src;
+        this.dst = dst;
+        this.parent = parent;
+      }
+
+      public void run() throws IOException {
+        Path target = FileUtil.checkDest(src.getName(), dstFS, dst, false);
+        if (src.isDirectory()) {
+          if (!dstFS.mkdirs(target)) {
+            // like the serial copy, only the top directory fails the copy
+            if (parent == null) {
+              ok = false;
+            }
+            return;
+          }
+          File[] contents = src.listFiles();
+          if (contents != null) {
+            for (File f : contents) {
+              submit(new CopyTask(f, new Path(target, f.getName()), this));
+            }
+          }
+        } else if (src.isFile()) {
+          InputStream in = null;
+          OutputStream out = null;
+          try {
+            in = new FileInputStream(src);
+            out = dstFS.create(target);
+            IOUtils.copyBytes(in, out, conf);
+          } catch (IOException e) {
+            IOUtils.closeStream(out);
+            IOUtils.closeStream(in);
+            throw e;
+          }
+        } else {
+          throw new IOException(src.toString() +
+                                ": No such file or directory");
+        }
+      }
+    }
+  }
+}
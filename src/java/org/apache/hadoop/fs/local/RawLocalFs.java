@@ -32,6 +32,7 @@ import org.apache.hadoop.fs.FsConstants;
 import org.apache.hadoop.fs.FsServerDefaults;
 import org.apache.hadoop.fs.RawLocalFileSystem;
 import org.apache.hadoop.fs.permission.FsPermission;
+import org.apache.hadoop.io.nativeio.NativeIO;
 import org.apache.hadoop.util.Shell;
 
 /**
@@ -89,9 +90,13 @@ public class RawLocalFs extends DelegateToFileSystem {
     }
     // NB: Use createSymbolicLink in java.nio.file.Path once available
     try {
-      Shell.execCommand(Shell.LINK_COMMAND, "-s",
-                        new URI(target.toString()).getPath(),
-                        new URI(link.toString()).getPath());
+      String targetPath = new URI(target.toString()).getPath();
+      String linkPath = new URI(link.toString()).getPath();
+      if (NativeIO.isNativeLoaded()) {
+        NativeIO.symlink(targetPath, linkPath);
+      } else {
+        Shell.execCommand(Shell.LINK_COMMAND, "-s", targetPath, linkPath);
+      }
     } catch (URISyntaxException x) {
       throw new IOException("Invalid symlink path: "+x.getMessage());
     } catch (IOException x) {
@@ -111,6 +116,10 @@ public class RawLocalFs extends DelegateToFileSystem {
      */
     try {
       final String path = p.toUri().getPath();
+      if (NativeIO.isNativeLoaded()) {
+        String target = NativeIO.readlink(path);
+        return target == null ? "" : target;
+      }
       return Shell.execCommand(Shell.READ_LINK_COMMAND, path).trim(); 
     } catch (IOException x) {
       return "";
@@ -90,6 +90,9 @@ public class ArrayWritable implements Writable {
 
   public void readFields(DataInput in) throws IOException {
     values = new Writable[in.readInt()];          // construct values
+    if (WritableUtils.readVLongWritables(in, valueClass, values)) {
+      return;
+    }
     for (int i = 0; i < values.length; i++) {
       Writable value = WritableFactories.newInstance(valueClass);
       value.readFields(in);                       // read a value
@@ -99,6 +102,9 @@ public class ArrayWritable implements Writable {
 
   public void write(DataOutput out) throws IOException {
     out.writeInt(values.length);                 // write values
+    if (WritableUtils.writeVLongWritables(out, values)) {
+      return;
+    }
     for (int i = 0; i < values.length; i++) {
       values[i].write(out);
     }
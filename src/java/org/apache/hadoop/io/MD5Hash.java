@@ -27,6 +27,7 @@ import java.security.*;
 
 import org.apache.hadoop.classification.InterfaceAudience;
 import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.io.nativeio.NativeChecksum;
 
 /** A Writable for MD5 hash values.
  */
@@ -45,6 +46,18 @@ public class MD5Hash implements WritableComparable<MD5Hash> {
     }
   };
 
+  /**
+   * The system property that lets single arrays be hashed by libhadoop.
+   * MessageDigest hashes about as fast, so this is off by default.
+   */
+  static final String NATIVE_DIGEST_PROPERTY = "hadoop.md5.native";
+
+  private static volatile boolean useNative =
+    Boolean.getBoolean(NATIVE_DIGEST_PROPERTY);
+
+  /** Arrays shorter than this are hashed in Java, where JNI costs more. */
+  private static final int NATIVE_MIN_LEN = 4096;
+
   private byte[] digest;
 
   /** Constructs an MD5Hash. */
@@ -109,12 +122,62 @@ public class MD5Hash implements WritableComparable<MD5Hash> {
   /** Construct a hash value for a byte array. */
   public static MD5Hash digest(byte[] data, int start, int len) {
     byte[] digest;
+    if (useNative && len >= NATIVE_MIN_LEN
+        && NativeChecksum.isNativeLoaded()) {
+      digest = new byte[MD5_LEN];
+      NativeChecksum.digest(data, start, len, digest, 0);
+      return new MD5Hash(digest);
+    }
     MessageDigest digester = DIGESTER_FACTORY.get();
     digester.update(data, start, len);
     digest = digester.digest();
     return new MD5Hash(digest);
   }
 
+  static void setUseNative(boolean use) {
+    useNative = use;
+  }
+
+  static boolean getUseNative() {
+    return useNative;
+  }
+
+  /**
+   * Construct hash values for the first <code>len</code> bytes of each of
+   * several byte arrays. With the native library, the arrays are hashed
+   * several at a time.
+   */
+  public static MD5Hash[] digest(byte[][] data, int len) {
+    MD5Hash[] hashes = new MD5Hash[data.length];
+    if (NativeChecksum.isNativeLoaded()) {
+      byte[] digests = new byte[data.length * MD5_LEN];
+      NativeChecksum.digest(data, len, digests);
+      for (int i = 0; i < data.length; i++) {
+        hashes[i] = new MD5Hash(Arrays.copyOfRange(digests, i * MD5_LEN,
+                                                   (i + 1) * MD5_LEN));
+      }
+      return hashes;
+    }
+    MessageDigest digester = DIGESTER_FACTORY.get();
+    for (int i = 0; i < data.length; i++) {
+      if (data[i].length < len) {
+        throw new IndexOutOfBoundsException();
+      }
+      digester.update(data[i], 0, len);
+      hashes[i] = new MD5Hash(digester.digest());
+    }
+    return hashes;
+  }
+
+  /**
+   * Get this thread's MD5 digester, reset.
+   */
+  public static MessageDigest getDigester() {
+    MessageDigest digester = DIGESTER_FACTORY.get();
+    digester.reset();
+    return digester;
+  }
+
   /** Construct a hash value for a String. */
   public static MD5Hash digest(String string) {
     return digest(UTF8.getBytes(string));
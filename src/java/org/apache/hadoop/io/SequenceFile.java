@@ -32,6 +32,7 @@ import org.apache.hadoop.io.compress.Compressor;
 import org.apache.hadoop.io.compress.Decompressor;
 import org.apache.hadoop.io.compress.DefaultCodec;
 import org.apache.hadoop.io.compress.GzipCodec;
+import org.apache.hadoop.io.compress.ReadAheadCompressionInputStream;
 import org.apache.hadoop.io.compress.zlib.ZlibFactory;
 import org.apache.hadoop.io.serializer.Deserializer;
 import org.apache.hadoop.io.serializer.Serializer;
@@ -655,7 +656,8 @@ public class SequenceFile {
       throws IOException {
       if (decompressedStream == null) {
         rawData = new DataInputBuffer();
-        decompressedStream = codec.createInputStream(rawData);
+        decompressedStream = ReadAheadCompressionInputStream.unwrap(
+            codec.createInputStream(rawData));
       } else {
         decompressedStream.resetState();
       }
@@ -1586,7 +1588,7 @@ public class SequenceFile {
         valBuffer = new DataInputBuffer();
         if (decompress) {
           valDecompressor = CodecPool.getDecompressor(codec);
-          valInFilter = codec.createInputStream(valBuffer, valDecompressor);
+          valInFilter = createInputStream(valBuffer, valDecompressor);
           valIn = new DataInputStream(valInFilter);
         } else {
           valIn = valBuffer;
@@ -1598,17 +1600,17 @@ public class SequenceFile {
           valLenBuffer = new DataInputBuffer();
 
           keyLenDecompressor = CodecPool.getDecompressor(codec);
-          keyLenInFilter = codec.createInputStream(keyLenBuffer, 
-                                                   keyLenDecompressor);
+          keyLenInFilter = createInputStream(keyLenBuffer, 
+                                             keyLenDecompressor);
           keyLenIn = new DataInputStream(keyLenInFilter);
 
           keyDecompressor = CodecPool.getDecompressor(codec);
-          keyInFilter = codec.createInputStream(keyBuffer, keyDecompressor);
+          keyInFilter = createInputStream(keyBuffer, keyDecompressor);
           keyIn = new DataInputStream(keyInFilter);
 
           valLenDecompressor = CodecPool.getDecompressor(codec);
-          valLenInFilter = codec.createInputStream(valLenBuffer, 
-                                                   valLenDecompressor);
+          valLenInFilter = createInputStream(valLenBuffer, 
+                                             valLenDecompressor);
           valLenIn = new DataInputStream(valLenInFilter);
         }
         
@@ -1631,6 +1633,16 @@ public class SequenceFile {
     private Deserializer getDeserializer(SerializationFactory sf, Class c) {
       return sf.getDeserializer(c);
     }
+
+    /**
+     * The record buffers are reset under these streams between records, so
+     * they must not decompress ahead of the reader.
+     */
+    private CompressionInputStream createInputStream(DataInputBuffer buffer,
+        Decompressor decompressor) throws IOException {
+      return ReadAheadCompressionInputStream.unwrap(
+          codec.createInputStream(buffer, decompressor));
+    }
     
     /** Close the file. */
     public synchronized void close() throws IOException {
@@ -3025,16 +3037,21 @@ public class SequenceFile {
             Path tmpFilename = 
               new Path(tmpDir, "intermediate").suffix("." + passNo);
 
-            Path outputFile =  lDirAlloc.getLocalPathForWrite(
-                                                tmpFilename.toString(),
-                                                approxOutputSize, conf);
+            LocalDirAllocator.Allocation allocation =
+              lDirAlloc.allocateForWrite(tmpFilename.toString(),
+                                         approxOutputSize, conf);
+            Path outputFile = allocation.getPath();
             LOG.debug("writing intermediate results to " + outputFile);
-            Writer writer = cloneFileAttributes(
-                                                fs.makeQualified(segmentsToMerge.get(0).segmentPathName), 
-                                                fs.makeQualified(outputFile), null);
-            writer.sync = null; //disable sync for temp files
-            writeFile(this, writer);
-            writer.close();
+            try {
+              Writer writer = cloneFileAttributes(
+                                                  fs.makeQualified(segmentsToMerge.get(0).segmentPathName), 
+                                                  fs.makeQualified(outputFile), null);
+              writer.sync = null; //disable sync for temp files
+              writeFile(this, writer);
+              writer.close();
+            } finally {
+              allocation.close();
+            }
             
             //we finished one single level merge; now clean up the priority 
             //queue
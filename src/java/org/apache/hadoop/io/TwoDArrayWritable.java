@@ -66,6 +66,9 @@ public class TwoDArrayWritable implements Writable {
 
     // construct values
     for (int i = 0; i < values.length; i++) {
+      if (WritableUtils.readVLongWritables(in, valueClass, values[i])) {
+        continue;
+      }
       for (int j = 0; j < values[i].length; j++) {
         Writable value;                             // construct value
         try {
@@ -87,6 +90,9 @@ public class TwoDArrayWritable implements Writable {
       out.writeInt(values[i].length);
     }
     for (int i = 0; i < values.length; i++) {
+      if (WritableUtils.writeVLongWritables(out, values[i])) {
+        continue;
+      }
       for (int j = 0; j < values[i].length; j++) {
         values[i][j].write(out);
       }
@@ -19,6 +19,8 @@
 package org.apache.hadoop.io;
 
 import java.io.*;
+import java.nio.BufferOverflowException;
+import java.nio.ByteBuffer;
 
 import org.apache.hadoop.classification.InterfaceAudience;
 import org.apache.hadoop.classification.InterfaceStability;
@@ -363,6 +365,366 @@ public final class WritableUtils  {
     // find the number of data bytes + length byte
     return (dataBits + 7) / 8 + 1;
   }
+
+  /** The most bytes a vint/vlong takes. */
+  private static final int MAX_VLONG_SIZE = 9;
+
+  /** The most values the bulk writers encode before writing them out. */
+  private static final int BULK_CHUNK = 512;
+
+  /** The encoded size of a vint/vlong, indexed by its first byte & 0xFF. */
+  private static final byte[] VINT_SIZES = new byte[256];
+  static {
+    for (int b = 0; b < 256; b++) {
+      VINT_SIZES[b] = (byte) decodeVIntSize((byte) b);
+    }
+  }
+
+  /**
+   * Get the encoded length of a range of longs stored in variable-length
+   * format.
+   * @return the total encoded length
+   */
+  public static int getVLongsSize(long[] values, int off, int len) {
+    int size = 0;
+    for (int n = off; n < off + len; n++) {
+      size += getVIntSize(values[n]);
+    }
+    return size;
+  }
+
+  /**
+   * Get the encoded length of a range of integers stored in variable-length
+   * format.
+   * @return the total encoded length
+   */
+  public static int getVIntsSize(int[] values, int off, int len) {
+    int size = 0;
+    for (int n = off; n < off + len; n++) {
+      size += getVIntSize(values[n]);
+    }
+    return size;
+  }
+
+  private static int encodeVLong(byte[] buf, int pos, long i) {
+    if (i >= -112 && i <= 127) {
+      buf[pos] = (byte) i;
+      return pos + 1;
+    }
+    int len = -112;
+    if (i < 0) {
+      i ^= -1L; // take one's complement'
+      len = -120;
+    }
+    int dataBytes = (Long.SIZE - Long.numberOfLeadingZeros(i) + 7) >>> 3;
+    buf[pos++] = (byte) (len - dataBytes);
+    for (int shift = (dataBytes - 1) << 3; shift >= 0; shift -= 8) {
+      buf[pos++] = (byte) (i >>> shift);
+    }
+    return pos;
+  }
+
+  /** Decode the bytes after the first of a vint/vlong of the given size. */
+  private static long decodeVLong(byte[] buf, int pos, int size) {
+    long i = 0;
+    for (int p = pos + 1, end = pos + size; p < end; p++) {
+      i = (i << 8) | (buf[p] & 0xFF);
+    }
+    return buf[pos] < -120 ? (i ^ -1L) : i;
+  }
+
+  /**
+   * Serializes a range of longs into a byte array with zero-compressed
+   * encoding, as {@link #writeVLong(DataOutput, long)} would one by one.
+   * @param buf the array, with room for
+   *        {@link #getVLongsSize(long[], int, int)} bytes from start
+   * @param start where to write in buf
+   * @param values the longs to serialize
+   * @param off the first long to serialize
+   * @param len the number of longs to serialize
+   * @return the offset in buf after the last long
+   */
+  public static int writeVLongs(byte[] buf, int start, long[] values,
+                                int off, int len) {
+    int pos = start;
+    for (int n = off; n < off + len; n++) {
+      pos = encodeVLong(buf, pos, values[n]);
+    }
+    return pos;
+  }
+
+  /**
+   * Serializes a range of integers into a byte array with zero-compressed
+   * encoding, as {@link #writeVInt(DataOutput, int)} would one by one.
+   * @param buf the array, with room for
+   *        {@link #getVIntsSize(int[], int, int)} bytes from start
+   * @return the offset in buf after the last integer
+   * @see #writeVLongs(byte[], int, long[], int, int)
+   */
+  public static int writeVInts(byte[] buf, int start, int[] values,
+                               int off, int len) {
+    int pos = start;
+    for (int n = off; n < off + len; n++) {
+      pos = encodeVLong(buf, pos, values[n]);
+    }
+    return pos;
+  }
+
+  /**
+   * Reads a range of zero-compressed encoded longs from a byte array. The
+   * size of each is looked up from its first byte, and runs of one-byte
+   * values are copied without further tests.
+   * @param buf the array
+   * @param start where the first long starts in buf
+   * @param end the end of the valid bytes in buf
+   * @param values where to store the longs
+   * @param off the index of the first long in values
+   * @param len the number of longs to read
+   * @return the offset in buf after the last long
+   * @throws EOFException if buf ends before the last long
+   */
+  public static int readVLongs(byte[] buf, int start, int end, long[] values,
+                               int off, int len) throws IOException {
+    int pos = start;
+    for (int n = off; n < off + len; n++) {
+      if (pos >= end) {
+        throw new EOFException();
+      }
+      byte first = buf[pos];
+      int size = VINT_SIZES[first & 0xFF];
+      if (size == 1) {
+        values[n] = first;
+        pos++;
+      } else {
+        if (pos + size > end) {
+          throw new EOFException();
+        }
+        values[n] = decodeVLong(buf, pos, size);
+        pos += size;
+      }
+    }
+    return pos;
+  }
+
+  /**
+   * Reads a range of zero-compressed encoded integers from a byte array.
+   * @return the offset in buf after the last integer
+   * @throws EOFException if buf ends before the last integer
+   * @see #readVLongs(byte[], int, int, long[], int, int)
+   */
+  public static int readVInts(byte[] buf, int start, int end, int[] values,
+                              int off, int len) throws IOException {
+    int pos = start;
+    for (int n = off; n < off + len; n++) {
+      if (pos >= end) {
+        throw new EOFException();
+      }
+      byte first = buf[pos];
+      int size = VINT_SIZES[first & 0xFF];
+      if (size == 1) {
+        values[n] = first;
+        pos++;
+      } else {
+        if (pos + size > end) {
+          throw new EOFException();
+        }
+        values[n] = (int) decodeVLong(buf, pos, size);
+        pos += size;
+      }
+    }
+    return pos;
+  }
+
+  /**
+   * Serializes a range of longs to a binary stream with zero-compressed
+   * encoding. The bytes are the same as from
+   * {@link #writeVLong(DataOutput, long)} for each long, but are written
+   * to the stream in a few large writes.
+   * @param stream Binary output stream
+   * @param values the longs to serialize
+   * @param off the first long to serialize
+   * @param len the number of longs to serialize
+   * @throws java.io.IOException 
+   */
+  public static void writeVLongs(DataOutput stream, long[] values,
+                                 int off, int len) throws IOException {
+    byte[] buf = new byte[Math.min(len, BULK_CHUNK) * MAX_VLONG_SIZE];
+    for (int n = off; n < off + len; n += BULK_CHUNK) {
+      int count = Math.min(BULK_CHUNK, off + len - n);
+      stream.write(buf, 0, writeVLongs(buf, 0, values, n, count));
+    }
+  }
+
+  /**
+   * Serializes a range of integers to a binary stream with zero-compressed
+   * encoding.
+   * @see #writeVLongs(DataOutput, long[], int, int)
+   */
+  public static void writeVInts(DataOutput stream, int[] values,
+                                int off, int len) throws IOException {
+    byte[] buf = new byte[Math.min(len, BULK_CHUNK) * MAX_VLONG_SIZE];
+    for (int n = off; n < off + len; n += BULK_CHUNK) {
+      int count = Math.min(BULK_CHUNK, off + len - n);
+      stream.write(buf, 0, writeVInts(buf, 0, values, n, count));
+    }
+  }
+
+  /**
+   * Reads a range of zero-compressed encoded longs from input stream. A
+   * {@link DataInputBuffer} is decoded from its array directly.
+   * @param stream Binary input stream
+   * @param values where to store the longs
+   * @param off the index of the first long in values
+   * @param len the number of longs to read
+   * @throws java.io.IOException 
+   */
+  public static void readVLongs(DataInput stream, long[] values,
+                                int off, int len) throws IOException {
+    if (stream instanceof DataInputBuffer) {
+      DataInputBuffer in = (DataInputBuffer) stream;
+      int pos = in.getPosition();
+      int end = readVLongs(in.getData(), pos, in.getLength(), values, off, len);
+      in.skipBytes(end - pos);
+      return;
+    }
+    for (int n = off; n < off + len; n++) {
+      values[n] = readVLong(stream);
+    }
+  }
+
+  /**
+   * Reads a range of zero-compressed encoded integers from input stream.
+   * @see #readVLongs(DataInput, long[], int, int)
+   */
+  public static void readVInts(DataInput stream, int[] values,
+                               int off, int len) throws IOException {
+    if (stream instanceof DataInputBuffer) {
+      DataInputBuffer in = (DataInputBuffer) stream;
+      int pos = in.getPosition();
+      int end = readVInts(in.getData(), pos, in.getLength(), values, off, len);
+      in.skipBytes(end - pos);
+      return;
+    }
+    for (int n = off; n < off + len; n++) {
+      values[n] = readVInt(stream);
+    }
+  }
+
+  /**
+   * Serializes a range of longs into a buffer with zero-compressed encoding.
+   * @param buf the buffer, written from its position
+   * @throws BufferOverflowException if buf has too little room; then its
+   *         position is unchanged
+   * @see #writeVLongs(byte[], int, long[], int, int)
+   */
+  public static void writeVLongs(ByteBuffer buf, long[] values,
+                                 int off, int len) {
+    if (buf.remaining() < getVLongsSize(values, off, len)) {
+      throw new BufferOverflowException();
+    }
+    if (buf.hasArray()) {
+      int start = buf.arrayOffset() + buf.position();
+      int end = writeVLongs(buf.array(), start, values, off, len);
+      buf.position(buf.position() + end - start);
+      return;
+    }
+    byte[] chunk = new byte[Math.min(len, BULK_CHUNK) * MAX_VLONG_SIZE];
+    for (int n = off; n < off + len; n += BULK_CHUNK) {
+      int count = Math.min(BULK_CHUNK, off + len - n);
+      buf.put(chunk, 0, writeVLongs(chunk, 0, values, n, count));
+    }
+  }
+
+  /**
+   * Reads a range of zero-compressed encoded longs from a buffer.
+   * @param buf the buffer, read from its position
+   * @throws EOFException if buf ends before the last long; then its
+   *         position is unchanged
+   * @see #readVLongs(byte[], int, int, long[], int, int)
+   */
+  public static void readVLongs(ByteBuffer buf, long[] values,
+                                int off, int len) throws IOException {
+    if (buf.hasArray()) {
+      int start = buf.arrayOffset() + buf.position();
+      int end = readVLongs(buf.array(), start,
+                           buf.arrayOffset() + buf.limit(), values, off, len);
+      buf.position(buf.position() + end - start);
+      return;
+    }
+    int pos = buf.position();
+    int limit = buf.limit();
+    byte[] scratch = new byte[MAX_VLONG_SIZE];
+    for (int n = off; n < off + len; n++) {
+      if (pos >= limit) {
+        throw new EOFException();
+      }
+      byte first = buf.get(pos);
+      int size = VINT_SIZES[first & 0xFF];
+      if (size == 1) {
+        values[n] = first;
+      } else {
+        if (pos + size > limit) {
+          throw new EOFException();
+        }
+        for (int i = 0; i < size; i++) {
+          scratch[i] = buf.get(pos + i);
+        }
+        values[n] = decodeVLong(scratch, 0, size);
+      }
+      pos += size;
+    }
+    buf.position(pos);
+  }
+
+  /**
+   * Writes an array of {@link VIntWritable} or {@link VLongWritable} values
+   * in bulk, as their {@link Writable#write(DataOutput)} would one by one.
+   * @return false, writing nothing, unless all values are of one of those
+   *         classes
+   */
+  static boolean writeVLongWritables(DataOutput out, Writable[] values)
+    throws IOException {
+    if (values.length == 0) {
+      return false;
+    }
+    Class<?> c = values[0].getClass();
+    if (c != VIntWritable.class && c != VLongWritable.class) {
+      return false;
+    }
+    long[] longs = new long[values.length];
+    for (int i = 0; i < values.length; i++) {
+      Writable value = values[i];
+      if (value.getClass() != c) {
+        return false;
+      }
+      longs[i] = c == VIntWritable.class ? ((VIntWritable) value).get()
+                                         : ((VLongWritable) value).get();
+    }
+    writeVLongs(out, longs, 0, longs.length);
+    return true;
+  }
+
+  /**
+   * Reads an array of {@link VIntWritable} or {@link VLongWritable} values
+   * in bulk.
+   * @param valueClass the class of the values
+   * @param values where to store the values
+   * @return false, reading nothing, unless valueClass is one of those
+   *         classes
+   */
+  static boolean readVLongWritables(DataInput in, Class<?> valueClass,
+                                    Writable[] values) throws IOException {
+    if (valueClass != VIntWritable.class && valueClass != VLongWritable.class) {
+      return false;
+    }
+    long[] longs = new long[values.length];
+    readVLongs(in, longs, 0, longs.length);
+    for (int i = 0; i < values.length; i++) {
+      values[i] = valueClass == VIntWritable.class
+        ? new VIntWritable((int) longs[i]) : new VLongWritable(longs[i]);
+    }
+    return true;
+  }
   /**
    * Read an Enum value from DataInput, Enums are read and written 
    * using String values. 
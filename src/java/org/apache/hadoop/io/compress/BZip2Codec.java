@@ -26,34 +26,68 @@ import java.io.OutputStream;
 
 import org.apache.hadoop.classification.InterfaceAudience;
 import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.conf.Configurable;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
 import org.apache.hadoop.fs.Seekable;
+import org.apache.hadoop.io.compress.bzip2.BZip2Compressor;
 import org.apache.hadoop.io.compress.bzip2.BZip2Constants;
-import org.apache.hadoop.io.compress.bzip2.BZip2DummyCompressor;
-import org.apache.hadoop.io.compress.bzip2.BZip2DummyDecompressor;
+import org.apache.hadoop.io.compress.bzip2.BZip2Decompressor;
+import org.apache.hadoop.io.compress.bzip2.BZip2Factory;
 import org.apache.hadoop.io.compress.bzip2.CBZip2InputStream;
 import org.apache.hadoop.io.compress.bzip2.CBZip2OutputStream;
+import org.apache.hadoop.io.compress.bzip2.ParallelBZip2InputStream;
 
 /**
  * This class provides CompressionOutputStream and CompressionInputStream for
- * compression and decompression. Currently we dont have an implementation of
- * the Compressor and Decompressor interfaces, so those methods of
- * CompressionCodec which have a Compressor or Decompressor type argument, throw
- * UnsupportedOperationException.
+ * compression and decompression. When the native bzip2 library is loaded the
+ * streams are backed by {@link BZip2Compressor} and {@link BZip2Decompressor};
+ * otherwise the pure-Java CBZip2 streams are used, and the Compressor and
+ * Decompressor handed out are dummies that cannot be used directly.
+ *
+ * Split-aware input streams always use the Java implementation, since only it
+ * can start at and report block boundaries.
+ *
+ * If <code>io.compression.codec.bzip2.decompress.threads</code> is greater
+ * than one, input streams decompress the blocks of a stream concurrently with
+ * a {@link ParallelBZip2InputStream}, in preference to the native library.
  */
 @InterfaceAudience.Public
 @InterfaceStability.Evolving
-public class BZip2Codec implements SplittableCompressionCodec {
+public class BZip2Codec implements Configurable, SplittableCompressionCodec {
 
   private static final String HEADER = "BZ";
   private static final int HEADER_LEN = HEADER.length();
   private static final String SUB_HEADER = "h9";
   private static final int SUB_HEADER_LEN = SUB_HEADER.length();
 
+  private Configuration conf;
+
   /**
   * Creates a new instance of BZip2Codec
   */
   public BZip2Codec() { }
 
+  public void setConf(Configuration conf) {
+    this.conf = conf;
+  }
+
+  public Configuration getConf() {
+    return conf;
+  }
+
+  private int getBufferSize() {
+    return conf == null ? 4*1024 : conf.getInt("io.file.buffer.size", 4*1024);
+  }
+
+  private int getDecompressThreads() {
+    return conf == null
+      ? CommonConfigurationKeys.IO_COMPRESSION_CODEC_BZIP2_DECOMPRESS_THREADS_DEFAULT
+      : conf.getInt(
+          CommonConfigurationKeys.IO_COMPRESSION_CODEC_BZIP2_DECOMPRESS_THREADS_KEY,
+          CommonConfigurationKeys.IO_COMPRESSION_CODEC_BZIP2_DECOMPRESS_THREADS_DEFAULT);
+  }
+
   /**
   * Creates CompressionOutputStream for BZip2
   *
@@ -65,6 +99,10 @@ public class BZip2Codec implements SplittableCompressionCodec {
   */
   public CompressionOutputStream createOutputStream(OutputStream out)
       throws IOException {
+    if (BZip2Factory.isNativeBZip2Loaded(conf)) {
+      return new CompressorStream(out, createCompressor(), getBufferSize())
+        .endCompressorOnClose();
+    }
     return new BZip2CompressionOutputStream(out);
   }
 
@@ -76,25 +114,29 @@ public class BZip2Codec implements SplittableCompressionCodec {
    */
   public CompressionOutputStream createOutputStream(OutputStream out,
       Compressor compressor) throws IOException {
-    return createOutputStream(out);
+    if (compressor instanceof BZip2Compressor) {
+      return new CompressorStream(out, compressor, getBufferSize());
+    }
+    return new BZip2CompressionOutputStream(out);
   }
 
   /**
-  * This functionality is currently not supported.
+  * Get the type of Compressor needed by this CompressionCodec.
   *
-  * @return BZip2DummyCompressor.class
+  * @return BZip2Compressor.class if native bzip2 is loaded,
+  *         BZip2DummyCompressor.class otherwise
   */
   public Class<? extends org.apache.hadoop.io.compress.Compressor> getCompressorType() {
-    return BZip2DummyCompressor.class;
+    return BZip2Factory.getBZip2CompressorType(conf);
   }
 
   /**
-  * This functionality is currently not supported.
+  * Create a new Compressor for use by this CompressionCodec.
   *
   * @return Compressor
   */
   public Compressor createCompressor() {
-    return new BZip2DummyCompressor();
+    return BZip2Factory.getBZip2Compressor(conf);
   }
 
   /**
@@ -108,17 +150,38 @@ public class BZip2Codec implements SplittableCompressionCodec {
   */
   public CompressionInputStream createInputStream(InputStream in)
       throws IOException {
-    return new BZip2CompressionInputStream(in);
+    int threads = getDecompressThreads();
+    if (threads > 1) {
+      return new ParallelBZip2InputStream(in, threads);
+    }
+    if (BZip2Factory.isNativeBZip2Loaded(conf)) {
+      return ReadAheadCompressionInputStream.wrap(
+          new DecompressorStream(in, createDecompressor(), getBufferSize())
+            .endDecompressorOnClose(), conf);
+    }
+    return ReadAheadCompressionInputStream.wrap(
+        new BZip2CompressionInputStream(in), conf);
   }
 
   /**
-  * This functionality is currently not supported.
+  * Creates CompressionInputStream that will read from the given input
+  * stream using the given decompressor.
   *
   * @return CompressionInputStream
   */
   public CompressionInputStream createInputStream(InputStream in,
       Decompressor decompressor) throws IOException {
-    return createInputStream(in);
+    int threads = getDecompressThreads();
+    if (threads > 1) {
+      return new ParallelBZip2InputStream(in, threads);
+    }
+    CompressionInputStream stream;
+    if (decompressor instanceof BZip2Decompressor) {
+      stream = new DecompressorStream(in, decompressor, getBufferSize());
+    } else {
+      stream = new BZip2CompressionInputStream(in);
+    }
+    return ReadAheadCompressionInputStream.wrap(stream, conf);
   }
 
   /**
@@ -154,7 +217,7 @@ public class BZip2Codec implements SplittableCompressionCodec {
 
     ((Seekable)seekableIn).seek(adjStart);
     SplitCompressionInputStream in =
-      new BZip2CompressionInputStream(seekableIn, adjStart, end, readMode);
+      createSplitStream(seekableIn, adjStart, end, readMode);
 
 
     // The following if clause handles the following case:
@@ -170,28 +233,38 @@ public class BZip2Codec implements SplittableCompressionCodec {
 
     if (in.getPos() <= start) {
       ((Seekable)seekableIn).seek(start);
-      in = new BZip2CompressionInputStream(seekableIn, start, end, readMode);
+      in = createSplitStream(seekableIn, start, end, readMode);
     }
 
     return in;
   }
 
+  private SplitCompressionInputStream createSplitStream(InputStream in,
+      long start, long end, READ_MODE readMode) throws IOException {
+    int threads = getDecompressThreads();
+    if (threads > 1) {
+      return new ParallelBZip2InputStream(in, start, end, readMode, threads);
+    }
+    return new BZip2CompressionInputStream(in, start, end, readMode);
+  }
+
   /**
-  * This functionality is currently not supported.
+  * Get the type of Decompressor needed by this CompressionCodec.
   *
-  * @return BZip2DummyDecompressor.class
+  * @return BZip2Decompressor.class if native bzip2 is loaded,
+  *         BZip2DummyDecompressor.class otherwise
   */
   public Class<? extends org.apache.hadoop.io.compress.Decompressor> getDecompressorType() {
-    return BZip2DummyDecompressor.class;
+    return BZip2Factory.getBZip2DecompressorType(conf);
   }
 
   /**
-  * This functionality is currently not supported.
+  * Create a new Decompressor for use by this CompressionCodec.
   *
   * @return Decompressor
   */
   public Decompressor createDecompressor() {
-    return new BZip2DummyDecompressor();
+    return BZip2Factory.getBZip2Decompressor(conf);
   }
 
   /**
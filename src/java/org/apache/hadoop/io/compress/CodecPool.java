@@ -52,6 +52,12 @@ public class CodecPool {
   private static final Map<Class<Decompressor>, List<Decompressor>> decompressorPool = 
     new HashMap<Class<Decompressor>, List<Decompressor>>();
 
+  /**
+   * The most idle codecs of one class kept in a pool. Codecs returned
+   * beyond this are ended, which releases their (possibly native) buffers.
+   */
+  static final int MAX_IDLE_CODECS = 64;
+
   private static <T> T borrow(Map<Class<T>, List<T>> pool,
                              Class<? extends T> codecClass) {
     T codec = null;
@@ -74,7 +80,8 @@ public class CodecPool {
     return codec;
   }
 
-  private static <T> void payback(Map<Class<T>, List<T>> pool, T codec) {
+  /** @return whether the codec was kept in the pool */
+  private static <T> boolean payback(Map<Class<T>, List<T>> pool, T codec) {
     if (codec != null) {
       Class<T> codecClass = ReflectionUtils.getClass(codec);
       synchronized (pool) {
@@ -84,10 +91,14 @@ public class CodecPool {
 
         List<T> codecList = pool.get(codecClass);
         synchronized (codecList) {
-          codecList.add(codec);
+          if (codecList.size() < MAX_IDLE_CODECS) {
+            codecList.add(codec);
+            return true;
+          }
         }
       }
     }
+    return false;
   }
   
   /**
@@ -137,7 +148,9 @@ public class CodecPool {
   }
   
   /**
-   * Return the {@link Compressor} to the pool.
+   * Return the {@link Compressor} to the pool. If the pool already holds
+   * {@value #MAX_IDLE_CODECS} idle compressors of its class, the compressor
+   * is ended instead, and must not be used again.
    * 
    * @param compressor the <code>Compressor</code> to be returned to the pool
    */
@@ -146,11 +159,15 @@ public class CodecPool {
       return;
     }
     compressor.reset();
-    payback(compressorPool, compressor);
+    if (!payback(compressorPool, compressor)) {
+      compressor.end();
+    }
   }
   
   /**
-   * Return the {@link Decompressor} to the pool.
+   * Return the {@link Decompressor} to the pool. If the pool already holds
+   * {@value #MAX_IDLE_CODECS} idle decompressors of its class, the
+   * decompressor is ended instead, and must not be used again.
    * 
    * @param decompressor the <code>Decompressor</code> to be returned to the 
    *                     pool
@@ -160,6 +177,8 @@ public class CodecPool {
       return;
     }
     decompressor.reset();
-    payback(decompressorPool, decompressor);
+    if (!payback(decompressorPool, decompressor)) {
+      decompressor.end();
+    }
   }
 }
@@ -32,6 +32,8 @@ public class CompressorStream extends CompressionOutputStream {
   protected Compressor compressor;
   protected byte[] buffer;
   protected boolean closed = false;
+  // whether the stream created the compressor, and ends it on close
+  private boolean ownsCompressor = false;
   
   public CompressorStream(OutputStream out, Compressor compressor, int bufferSize) {
     super(out);
@@ -96,11 +98,27 @@ public class CompressorStream extends CompressionOutputStream {
     compressor.reset();
   }
   
+  /**
+   * End the compressor when the stream is closed. For streams whose
+   * compressor was created for them alone, so that its (possibly native)
+   * memory is released without waiting for the garbage collector.
+   */
+  CompressorStream endCompressorOnClose() {
+    ownsCompressor = true;
+    return this;
+  }
+
   public void close() throws IOException {
     if (!closed) {
-      finish();
-      out.close();
-      closed = true;
+      try {
+        finish();
+        out.close();
+      } finally {
+        closed = true;
+        if (ownsCompressor) {
+          compressor.end();
+        }
+      }
     }
   }
 
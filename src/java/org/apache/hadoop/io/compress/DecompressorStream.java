@@ -33,6 +33,8 @@ public class DecompressorStream extends CompressionInputStream {
   protected byte[] buffer;
   protected boolean eof = false;
   protected boolean closed = false;
+  // whether the stream created the decompressor, and ends it on close
+  private boolean ownsDecompressor = false;
   
   public DecompressorStream(InputStream in, Decompressor decompressor, int bufferSize) throws IOException {
     super(in);
@@ -143,10 +145,26 @@ public class DecompressorStream extends CompressionInputStream {
     return (eof) ? 0 : 1;
   }
 
+  /**
+   * End the decompressor when the stream is closed. For streams whose
+   * decompressor was created for them alone, so that its (possibly native)
+   * memory is released without waiting for the garbage collector.
+   */
+  DecompressorStream endDecompressorOnClose() {
+    ownsDecompressor = true;
+    return this;
+  }
+
   public void close() throws IOException {
     if (!closed) {
-      in.close();
-      closed = true;
+      try {
+        in.close();
+      } finally {
+        closed = true;
+        if (ownsDecompressor) {
+          decompressor.end();
+        }
+      }
     }
   }
 
@@ -45,7 +45,8 @@ public class DefaultCodec implements Configurable, CompressionCodec {
   public CompressionOutputStream createOutputStream(OutputStream out) 
   throws IOException {
     return new CompressorStream(out, createCompressor(), 
-                                conf.getInt("io.file.buffer.size", 4*1024));
+                                conf.getInt("io.file.buffer.size", 4*1024))
+      .endCompressorOnClose();
   }
 
   public CompressionOutputStream createOutputStream(OutputStream out, 
@@ -65,15 +66,20 @@ public class DefaultCodec implements Configurable, CompressionCodec {
 
   public CompressionInputStream createInputStream(InputStream in) 
   throws IOException {
-    return new DecompressorStream(in, createDecompressor(),
-                                  conf.getInt("io.file.buffer.size", 4*1024));
+    return ReadAheadCompressionInputStream.wrap(
+        new DecompressorStream(in, createDecompressor(),
+                               conf.getInt("io.file.buffer.size", 4*1024))
+          .endDecompressorOnClose(),
+        conf);
   }
 
   public CompressionInputStream createInputStream(InputStream in, 
                                                   Decompressor decompressor) 
   throws IOException {
-    return new DecompressorStream(in, decompressor, 
-                                  conf.getInt("io.file.buffer.size", 4*1024));
+    return ReadAheadCompressionInputStream.wrap(
+        new DecompressorStream(in, decompressor,
+                               conf.getInt("io.file.buffer.size", 4*1024)),
+        conf);
   }
 
   public Class<? extends Decompressor> getDecompressorType() {
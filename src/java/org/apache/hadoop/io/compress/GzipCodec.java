@@ -147,7 +147,8 @@ public class GzipCodec extends DefaultCodec {
     throws IOException {
     return (ZlibFactory.isNativeZlibLoaded(conf)) ?
                new CompressorStream(out, createCompressor(),
-                                    conf.getInt("io.file.buffer.size", 4*1024)) :
+                                    conf.getInt("io.file.buffer.size", 4*1024))
+                 .endCompressorOnClose() :
                new GzipOutputStream(out);
   }
   
@@ -176,20 +177,23 @@ public class GzipCodec extends DefaultCodec {
 
   public CompressionInputStream createInputStream(InputStream in) 
   throws IOException {
-  return (ZlibFactory.isNativeZlibLoaded(conf)) ?
+  return ReadAheadCompressionInputStream.wrap(
+             (ZlibFactory.isNativeZlibLoaded(conf)) ?
              new DecompressorStream(in, createDecompressor(),
                                     conf.getInt("io.file.buffer.size", 
-                                                4*1024)) :
-             new GzipInputStream(in);                                         
+                                                4*1024))
+               .endDecompressorOnClose() :
+             new GzipInputStream(in), conf);
   }
 
   public CompressionInputStream createInputStream(InputStream in, 
                                                   Decompressor decompressor) 
   throws IOException {
     return (decompressor != null) ? 
-               new DecompressorStream(in, decompressor,
-                                      conf.getInt("io.file.buffer.size", 
-                                                  4*1024)) :
+               ReadAheadCompressionInputStream.wrap(
+                 new DecompressorStream(in, decompressor,
+                                        conf.getInt("io.file.buffer.size", 
+                                                    4*1024)), conf) :
                createInputStream(in); 
   }
 
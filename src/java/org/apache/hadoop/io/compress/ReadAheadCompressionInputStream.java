@@ -0,0 +1,364 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.io.compress;
+
+import java.io.IOException;
+import java.io.InterruptedIOException;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.LinkedBlockingQueue;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
+import org.apache.hadoop.util.Daemon;
+
+/**
+ * A {@link CompressionInputStream} which reads and decompresses another
+ * <code>CompressionInputStream</code> on a background thread, ahead of the
+ * consumer.
+ *
+ * <p>Decompressed data is staged in a fixed ring of buffers, so the memory
+ * held by the read-ahead stage is bounded by
+ * <code>numBuffers * bufferSize</code> regardless of how far the consumer
+ * lags behind. The background thread is started on the first read and is
+ * stopped by {@link #close()} and {@link #resetState()}.
+ *
+ * <p>Since the wrapped stream runs ahead of the consumer, {@link #getPos()}
+ * reports the position of the read-ahead stage, not of the consumer. Hence
+ * this stream must not be used to wrap a {@link SplitCompressionInputStream}
+ * whose positions are used to detect split boundaries;
+ * {@link #wrap(CompressionInputStream, Configuration)} leaves such streams
+ * untouched.
+ *
+ * <p>The codecs wrap the streams returned by
+ * <code>createInputStream</code> when read-ahead is enabled. Callers which
+ * reposition the underlying input between reads, such as
+ * {@link org.apache.hadoop.io.SequenceFile}, must read through
+ * {@link #unwrap(CompressionInputStream)} instead, since the background
+ * thread would race with the repositioning.
+ */
+@InterfaceAudience.Public
+@InterfaceStability.Evolving
+public class ReadAheadCompressionInputStream extends CompressionInputStream {
+  private static final Log LOG =
+    LogFactory.getLog(ReadAheadCompressionInputStream.class);
+
+  /** A buffer of decompressed data handed from the reader to the consumer. */
+  private static class Chunk {
+    final byte[] data;
+    int len;
+    int pos;
+
+    Chunk(int size) {
+      data = new byte[size];
+    }
+  }
+
+  /** Marks the end of the decompressed stream. */
+  private static final Chunk EOF_MARKER = new Chunk(0);
+
+  private final CompressionInputStream source;
+  private final BlockingQueue<Chunk> free;
+  private final BlockingQueue<Chunk> filled;
+
+  private Chunk current = null;
+  private boolean eof = false;
+  private boolean closed = false;
+  private Daemon reader = null;
+  private volatile boolean stopped = false;
+  private volatile IOException readerError = null;
+
+  /**
+   * Create a read-ahead stream over the given stream.
+   *
+   * @param source the stream to decompress in the background
+   * @param numBuffers number of buffers staged ahead of the consumer
+   * @param bufferSize size of each buffer
+   * @throws IOException
+   */
+  public ReadAheadCompressionInputStream(CompressionInputStream source,
+      int numBuffers, int bufferSize) throws IOException {
+    super(source);
+    if (numBuffers <= 0) {
+      throw new IllegalArgumentException("Illegal numBuffers " + numBuffers);
+    } else if (bufferSize <= 0) {
+      throw new IllegalArgumentException("Illegal bufferSize " + bufferSize);
+    }
+    this.source = source;
+    free = new LinkedBlockingQueue<Chunk>();
+    filled = new LinkedBlockingQueue<Chunk>();
+    for (int i = 0; i < numBuffers; i++) {
+      free.add(new Chunk(bufferSize));
+    }
+  }
+
+  /**
+   * Wrap the given stream in a read-ahead stream if read-ahead is enabled
+   * through {@link CommonConfigurationKeys#IO_COMPRESSION_READAHEAD_BUFFERS_KEY}.
+   * Splittable streams are returned as is.
+   *
+   * @param in the stream to wrap
+   * @param conf configuration, may be null
+   * @return a read-ahead stream over <code>in</code>, or <code>in</code>
+   * @throws IOException
+   */
+  public static CompressionInputStream wrap(CompressionInputStream in,
+      Configuration conf) throws IOException {
+    if (conf == null) {
+      return in;
+    }
+    int numBuffers = conf.getInt(
+        CommonConfigurationKeys.IO_COMPRESSION_READAHEAD_BUFFERS_KEY,
+        CommonConfigurationKeys.IO_COMPRESSION_READAHEAD_BUFFERS_DEFAULT);
+    if (numBuffers <= 0 || in instanceof SplitCompressionInputStream
+        || in instanceof ReadAheadCompressionInputStream) {
+      return in;
+    }
+    int bufferSize = conf.getInt(
+        CommonConfigurationKeys.IO_COMPRESSION_READAHEAD_BUFFER_SIZE_KEY,
+        CommonConfigurationKeys.IO_COMPRESSION_READAHEAD_BUFFER_SIZE_DEFAULT);
+    return new ReadAheadCompressionInputStream(in, numBuffers, bufferSize);
+  }
+
+  /**
+   * Get the stream a read-ahead stream was created over. Since the
+   * background reader only starts on the first read, an unread read-ahead
+   * stream may be dropped in favour of its source.
+   *
+   * @param in a stream returned by a codec
+   * @return the source of <code>in</code> if it is an unread read-ahead
+   *         stream, <code>in</code> otherwise
+   */
+  public static CompressionInputStream unwrap(CompressionInputStream in) {
+    if (in instanceof ReadAheadCompressionInputStream) {
+      ReadAheadCompressionInputStream readAhead =
+        (ReadAheadCompressionInputStream) in;
+      if (readAhead.current == null && !readAhead.eof) {
+        return readAhead.source;
+      }
+    }
+    return in;
+  }
+
+  private class Reader implements Runnable {
+    public void run() {
+      try {
+        while (!stopped) {
+          Chunk chunk = free.take();
+          int n = fill(chunk);
+          if (chunk.len > 0) {
+            filled.put(chunk);
+          } else {
+            free.put(chunk);
+          }
+          if (n < 0) {
+            filled.put(EOF_MARKER);
+            return;
+          }
+        }
+      } catch (InterruptedException ie) {
+        readerError = new InterruptedIOException(ie.toString());
+        filled.add(EOF_MARKER);
+      } catch (IOException ioe) {
+        if (!stopped) {
+          readerError = ioe;
+        }
+        filled.add(EOF_MARKER);
+      } catch (RuntimeException re) {
+        if (!stopped) {
+          readerError = new IOException(re);
+        }
+        filled.add(EOF_MARKER);
+      }
+    }
+
+    /** Fill the chunk up; return -1 if the end of the stream was reached. */
+    private int fill(Chunk chunk) throws IOException {
+      chunk.len = 0;
+      chunk.pos = 0;
+      while (chunk.len < chunk.data.length && !stopped) {
+        int n = source.read(chunk.data, chunk.len,
+                            chunk.data.length - chunk.len);
+        if (n < 0) {
+          return -1;
+        }
+        chunk.len += n;
+      }
+      return chunk.len;
+    }
+
+    public String toString() {
+      return "ReadAhead decompressor for " + source;
+    }
+  }
+
+  private void startReader() {
+    if (reader == null) {
+      stopped = false;
+      readerError = null;
+      reader = new Daemon(new Reader());
+      reader.start();
+    }
+  }
+
+  /**
+   * Stop the background reader and return all staged buffers to the ring.
+   * The reader is not interrupted, since interrupting a thread blocked in
+   * channel I/O would close the underlying channel; instead it is handed
+   * back the staged buffers so that it never blocks on the ring, and it
+   * notices {@link #stopped} before its next read.
+   */
+  private void stopReader() throws IOException {
+    stopped = true;
+    recycleChunks();
+    if (reader != null) {
+      try {
+        reader.join();
+      } catch (InterruptedException ie) {
+        throw new InterruptedIOException(
+            "Interrupted while stopping " + reader.getName());
+      }
+      reader = null;
+      recycleChunks();
+    }
+  }
+
+  private void recycleChunks() {
+    if (current != null) {
+      free.add(current);
+      current = null;
+    }
+    Chunk chunk;
+    while ((chunk = filled.poll()) != null) {
+      if (chunk != EOF_MARKER) {
+        free.add(chunk);
+      }
+    }
+  }
+
+  /**
+   * Move on to the next staged buffer.
+   * @return <code>false</code> at the end of the stream
+   */
+  private boolean nextChunk() throws IOException {
+    if (current != null) {
+      free.add(current);
+      current = null;
+    }
+    if (eof) {
+      return false;
+    }
+    startReader();
+    Chunk chunk;
+    try {
+      chunk = filled.take();
+    } catch (InterruptedException ie) {
+      throw new InterruptedIOException("Interrupted while waiting for "
+                                       + reader.getName());
+    }
+    if (chunk == EOF_MARKER) {
+      eof = true;
+      if (readerError != null) {
+        throw readerError;
+      }
+      return false;
+    }
+    current = chunk;
+    return true;
+  }
+
+  public int read() throws IOException {
+    checkStream();
+    if (current == null || current.pos == current.len) {
+      if (!nextChunk()) {
+        return -1;
+      }
+    }
+    return current.data[current.pos++] & 0xff;
+  }
+
+  public int read(byte[] b, int off, int len) throws IOException {
+    checkStream();
+    if ((off | len | (off + len) | (b.length - (off + len))) < 0) {
+      throw new IndexOutOfBoundsException();
+    } else if (len == 0) {
+      return 0;
+    }
+
+    if (current == null || current.pos == current.len) {
+      if (!nextChunk()) {
+        return -1;
+      }
+    }
+    int n = Math.min(len, current.len - current.pos);
+    System.arraycopy(current.data, current.pos, b, off, n);
+    current.pos += n;
+    return n;
+  }
+
+  public int available() throws IOException {
+    checkStream();
+    return (current == null) ? 0 : current.len - current.pos;
+  }
+
+  /**
+   * {@inheritDoc}
+   * The background reader is stopped, staged data is discarded and the
+   * wrapped stream is reset. Reading resumes on the next call to read.
+   */
+  public void resetState() throws IOException {
+    stopReader();
+    eof = false;
+    source.resetState();
+  }
+
+  /**
+   * Returns the position of the read-ahead stage in the wrapped stream.
+   */
+  public long getPos() throws IOException {
+    return source.getPos();
+  }
+
+  public void close() throws IOException {
+    if (!closed) {
+      closed = true;
+      try {
+        stopReader();
+      } finally {
+        source.close();
+      }
+      if (LOG.isDebugEnabled()) {
+        LOG.debug("Closed read-ahead stream over " + source);
+      }
+    }
+  }
+
+  private void checkStream() throws IOException {
+    if (closed) {
+      throw new IOException("Stream closed");
+    }
+  }
+
+  public boolean markSupported() {
+    return false;
+  }
+}
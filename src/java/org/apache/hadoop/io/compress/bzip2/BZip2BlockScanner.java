@@ -0,0 +1,365 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.io.compress.bzip2;
+
+import java.io.IOException;
+import java.io.InputStream;
+
+/**
+ * Splits a compressed bzip2 stream into its blocks without decoding them.
+ *
+ * <p>Blocks are bit aligned and start with a 48-bit marker. The scanner
+ * shifts each input byte into a 64-bit window and compares the eight
+ * alignments ending in that byte against the block and end-of-stream
+ * markers. Each {@link Segment} holds the bits from one block marker up to
+ * the next marker, and can be turned into a stand-alone single-block
+ * bzip2 stream that {@link CBZip2InputStream} decodes on its own.</p>
+ *
+ * <p>A block marker may, very rarely, also occur inside compressed data; the
+ * segment before it will then fail to decode, and can be retried after
+ * being {@link Segment#join joined} with its successor.</p>
+ *
+ * <p>Instances of this class are not threadsafe.</p>
+ */
+class BZip2BlockScanner {
+
+  private static final int MARKER_BITS = 48;
+  private static final long MARKER_MASK = (1L << MARKER_BITS) - 1;
+  private static final int CRC_BITS = 32;
+
+  /**
+   * Upper bound on the compressed size of one block. A 900k block of
+   * incompressible data is only slightly larger than 900k, so anything
+   * bigger is not bzip2 data.
+   */
+  static final int MAX_SEGMENT_BYTES = 4 * 1024 * 1024;
+
+  private final InputStream in;
+  private final byte[] readBuf = new byte[64 * 1024];
+  private int readPos = 0, readLen = 0;
+
+  // Bytes read since the start of the current block; pending[0] holds the
+  // byte at offset pendingBase of the scanned stream.
+  private byte[] pending = new byte[1024 * 1024];
+  private int pendingLen = 0;
+  private long pendingBase = 0;
+
+  private long window = 0;
+  private long bytesScanned = 0;
+  // Bit offset of the marker of the block being scanned, -1 if none
+  private long blockStartBit = -1;
+  private long blockMarkerEnd = 0;
+  // Markers may not overlap the previous one
+  private long lastMarkerEndBit = 0;
+  private boolean sawMarker = false;
+  private boolean eof = false;
+
+  /**
+   * The bits of one compressed block, starting with its block marker.
+   */
+  static class Segment {
+    private final byte[] data;
+    private final int bitOffset;
+    private final long bitLength;
+    private final long markerEnd;
+
+    Segment(byte[] data, int bitOffset, long bitLength, long markerEnd) {
+      this.data = data;
+      this.bitOffset = bitOffset;
+      this.bitLength = bitLength;
+      this.markerEnd = markerEnd;
+    }
+
+    /**
+     * The offset of the first byte after this block's marker, relative to
+     * where the scan started.
+     */
+    long getMarkerEnd() {
+      return markerEnd;
+    }
+
+    /** The size of the compressed block, in bits. */
+    long getBitLength() {
+      return bitLength;
+    }
+
+    /** The size of the compressed block, in bytes, rounded up. */
+    int getCompressedLength() {
+      return (int) ((bitLength + 7) >>> 3);
+    }
+
+    /**
+     * Wrap the block into a complete bzip2 stream, minus the leading "BZ",
+     * as expected by {@link CBZip2InputStream}. The end-of-stream combined
+     * CRC of a single-block stream equals the block CRC.
+     */
+    byte[] toStream() throws IOException {
+      if (bitLength < MARKER_BITS + CRC_BITS) {
+        throw new IOException("Truncated bzip2 block");
+      }
+      BitWriter out = new BitWriter(getCompressedLength() + 16);
+      out.write('h', 8);
+      out.write('9', 8);
+      out.write(data, bitOffset, bitLength);
+      out.write(CBZip2InputStream.EOS_DELIMITER, MARKER_BITS);
+      out.write(readBits(data, bitOffset + MARKER_BITS, CRC_BITS), CRC_BITS);
+      return out.toByteArray();
+    }
+
+    /**
+     * Join two adjacent segments, dropping the marker between them that
+     * turned out to be part of the compressed data.
+     */
+    static Segment join(Segment first, Segment second) {
+      BitWriter out = new BitWriter(first.getCompressedLength()
+          + second.getCompressedLength() + 1);
+      out.write(first.data, first.bitOffset, first.bitLength);
+      out.write(second.data, second.bitOffset, second.bitLength);
+      return new Segment(out.toByteArray(), 0,
+          first.bitLength + second.bitLength, first.markerEnd);
+    }
+  }
+
+  BZip2BlockScanner(InputStream in) {
+    this.in = in;
+  }
+
+  /** The number of compressed bytes consumed so far. */
+  long getBytesScanned() {
+    return bytesScanned;
+  }
+
+  /** Whether any block or end-of-stream marker has been seen. */
+  boolean sawMarker() {
+    return sawMarker;
+  }
+
+  /**
+   * Advance to the first block marker, if not already positioned in a block.
+   *
+   * @return the offset of the first byte after the marker, or the number of
+   *         bytes scanned if the input ended before a block was found
+   */
+  long findBlock() throws IOException {
+    while (blockStartBit < 0) {
+      if (scan() == Boolean.FALSE) {
+        return bytesScanned;
+      }
+    }
+    return blockMarkerEnd;
+  }
+
+  /**
+   * Return the next block of the stream, or null at the end of the input.
+   */
+  Segment next() throws IOException {
+    while (true) {
+      long start = blockStartBit;
+      long markerEnd = blockMarkerEnd;
+      Boolean found = scan();
+      if (found == null) {
+        continue;
+      }
+      // scan() stopped at a marker or at the end of the input; either way the
+      // block being scanned, if any, ends there.
+      if (start >= 0) {
+        long endBit = found ? lastMarkerEndBit - MARKER_BITS
+                            : bytesScanned * 8;
+        Segment seg = extract(start, endBit, markerEnd);
+        compact();
+        return seg;
+      }
+      compact();
+      if (!found) {
+        return null;
+      }
+    }
+  }
+
+  /**
+   * Scan one byte.
+   *
+   * @return TRUE if a marker ends in this byte, FALSE at the end of the
+   *         input, null otherwise
+   */
+  private Boolean scan() throws IOException {
+    if (readPos == readLen) {
+      if (eof || (readLen = in.read(readBuf, 0, readBuf.length)) <= 0) {
+        eof = true;
+        readLen = readPos = 0;
+        blockStartBit = -1;
+        return Boolean.FALSE;
+      }
+      readPos = 0;
+    }
+    int b = readBuf[readPos++] & 0xff;
+    if (pendingLen == pending.length && blockStartBit < 0) {
+      compact();
+    }
+    if (pendingLen == pending.length) {
+      if (pendingLen >= MAX_SEGMENT_BYTES) {
+        throw new IOException("bzip2 block exceeds " + MAX_SEGMENT_BYTES
+            + " bytes at offset " + pendingBase);
+      }
+      byte[] grown = new byte[pending.length * 2];
+      System.arraycopy(pending, 0, grown, 0, pendingLen);
+      pending = grown;
+    }
+    pending[pendingLen++] = (byte) b;
+    window = (window << 8) | b;
+    bytesScanned++;
+    if (bytesScanned * 8 < MARKER_BITS) {
+      return null;
+    }
+
+    // Check the eight bit alignments of a marker ending in this byte,
+    // earliest first.
+    for (int shift = 7; shift >= 0; shift--) {
+      long candidate = (window >>> shift) & MARKER_MASK;
+      if (candidate != CBZip2InputStream.BLOCK_DELIMITER
+          && candidate != CBZip2InputStream.EOS_DELIMITER) {
+        continue;
+      }
+      long endBit = bytesScanned * 8 - shift;
+      long startBit = endBit - MARKER_BITS;
+      if (startBit < 0 || startBit < lastMarkerEndBit) {
+        continue;
+      }
+      lastMarkerEndBit = endBit;
+      sawMarker = true;
+      if (candidate == CBZip2InputStream.BLOCK_DELIMITER) {
+        blockStartBit = startBit;
+        blockMarkerEnd = bytesScanned;
+      } else {
+        blockStartBit = -1;
+      }
+      return Boolean.TRUE;
+    }
+    return null;
+  }
+
+  private Segment extract(long startBit, long endBit, long markerEnd) {
+    int from = (int) ((startBit >>> 3) - pendingBase);
+    int to = (int) (((endBit + 7) >>> 3) - pendingBase);
+    byte[] data = new byte[to - from];
+    System.arraycopy(pending, from, data, 0, data.length);
+    return new Segment(data, (int) (startBit & 7), endBit - startBit,
+        markerEnd);
+  }
+
+  /**
+   * Drop buffered bytes that precede the current block, keeping enough to
+   * recognise a marker that straddles the next byte.
+   */
+  private void compact() {
+    long keepFrom;
+    if (blockStartBit >= 0) {
+      keepFrom = blockStartBit >>> 3;
+    } else {
+      keepFrom = Math.max(pendingBase, bytesScanned - MARKER_BITS / 8 - 1);
+    }
+    int drop = (int) (keepFrom - pendingBase);
+    if (drop > 0) {
+      System.arraycopy(pending, drop, pending, 0, pendingLen - drop);
+      pendingLen -= drop;
+      pendingBase = keepFrom;
+    }
+  }
+
+  private static long readBits(byte[] data, long bitOffset, int n) {
+    long value = 0;
+    for (int i = 0; i < n; i++) {
+      long bit = bitOffset + i;
+      value = (value << 1) | ((data[(int) (bit >>> 3)] >>> (7 - (bit & 7))) & 1);
+    }
+    return value;
+  }
+
+  /**
+   * Accumulates a big-endian bit string.
+   */
+  static class BitWriter {
+    private byte[] buf;
+    private int len = 0;
+    private long acc = 0;
+    private int accBits = 0;
+
+    BitWriter(int capacity) {
+      buf = new byte[Math.max(capacity, 16)];
+    }
+
+    void write(long value, int n) {
+      acc = (acc << n) | (value & ((1L << n) - 1));
+      accBits += n;
+      while (accBits >= 8) {
+        accBits -= 8;
+        put((int) (acc >>> accBits));
+      }
+    }
+
+    void write(byte[] src, long bitOffset, long n) {
+      // leading bits up to a source byte boundary
+      int head = (int) Math.min(n, (8 - (bitOffset & 7)) & 7);
+      if (head > 0) {
+        write(readBits(src, bitOffset, head), head);
+        bitOffset += head;
+        n -= head;
+      }
+      int i = (int) (bitOffset >>> 3);
+      if (accBits == 0) {
+        int bytes = (int) (n >>> 3);
+        ensure(bytes);
+        System.arraycopy(src, i, buf, len, bytes);
+        len += bytes;
+        i += bytes;
+      } else {
+        for (long end = i + (n >>> 3); i < end; i++) {
+          write(src[i] & 0xff, 8);
+        }
+      }
+      int tail = (int) (n & 7);
+      if (tail > 0) {
+        write((src[i] & 0xff) >>> (8 - tail), tail);
+      }
+    }
+
+    byte[] toByteArray() {
+      if (accBits > 0) {
+        // pad the final byte with zeros
+        write(0, 8 - accBits);
+      }
+      byte[] result = new byte[len];
+      System.arraycopy(buf, 0, result, 0, len);
+      return result;
+    }
+
+    private void put(int b) {
+      ensure(1);
+      buf[len++] = (byte) b;
+    }
+
+    private void ensure(int n) {
+      if (len + n > buf.length) {
+        byte[] grown = new byte[Math.max(buf.length * 2, len + n)];
+        System.arraycopy(buf, 0, grown, 0, len);
+        buf = grown;
+      }
+    }
+  }
+}
@@ -0,0 +1,305 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.io.compress.bzip2;
+
+import java.io.IOException;
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.io.compress.Compressor;
+import org.apache.hadoop.io.nativeio.NativeBufferPool;
+import org.apache.hadoop.util.NativeCodeLoader;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+
+/**
+ * A {@link Compressor} based on the popular
+ * bzip2 compression algorithm.
+ * http://www.bzip.org/
+ *
+ */
+public class BZip2Compressor implements Compressor {
+
+  private static final Log LOG = LogFactory.getLog(BZip2Compressor.class);
+
+  static final int DEFAULT_DIRECT_BUFFER_SIZE = 64*1024;
+
+  // HACK - Use this as a global lock in the JNI layer
+  private static Class clazz = BZip2Compressor.class;
+
+  private long stream;
+  private int blockSize;
+  private int workFactor;
+  private int directBufferSize;
+  private byte[] userBuf = null;
+  private int userBufOff = 0, userBufLen = 0;
+  private Buffer uncompressedDirectBuf = null;
+  private int uncompressedDirectBufOff = 0, uncompressedDirectBufLen = 0;
+  private Buffer compressedDirectBuf = null;
+  private boolean finish, finished;
+
+  private static boolean nativeBZip2Loaded = false;
+
+  static {
+    if (NativeCodeLoader.isNativeCodeLoaded()) {
+      try {
+        // Initialize the native library
+        initIDs();
+        nativeBZip2Loaded = true;
+      } catch (Throwable t) {
+        // Ignore failure to load/initialize native-bzip2
+      }
+    }
+  }
+
+  static boolean isNativeBZip2Loaded() {
+    return nativeBZip2Loaded;
+  }
+
+  /**
+   * Creates a new compressor with the default block size and work factor.
+   */
+  public BZip2Compressor() {
+    this(BZip2Factory.DEFAULT_BLOCK_SIZE, BZip2Factory.DEFAULT_WORK_FACTOR,
+         DEFAULT_DIRECT_BUFFER_SIZE);
+  }
+
+  /**
+   * Creates a new compressor, taking settings from the configuration.
+   */
+  public BZip2Compressor(Configuration conf) {
+    this(BZip2Factory.getBlockSize(conf), BZip2Factory.getWorkFactor(conf),
+         DEFAULT_DIRECT_BUFFER_SIZE);
+  }
+
+  /**
+   * Creates a new compressor using the specified block size.
+   *
+   * @param blockSize block size in units of 100k, 1 through 9
+   * @param workFactor how the compressor behaves on repetitive input,
+   *                   0 through 250; 0 selects the library default
+   * @param directBufferSize Size of the direct buffer to be used.
+   */
+  public BZip2Compressor(int blockSize, int workFactor, int directBufferSize) {
+    this.blockSize = blockSize;
+    this.workFactor = workFactor;
+    stream = init(blockSize, workFactor);
+
+    this.directBufferSize = directBufferSize;
+    uncompressedDirectBuf = NativeBufferPool.allocate(directBufferSize);
+    compressedDirectBuf = NativeBufferPool.allocate(directBufferSize);
+    compressedDirectBuf.position(directBufferSize);
+  }
+
+  /**
+   * Prepare the compressor to be used in a new stream with settings defined in
+   * the given Configuration. It will reset the compressor's block size and
+   * work factor.
+   *
+   * @param conf Configuration storing new settings
+   */
+  public synchronized void reinit(Configuration conf) {
+    if (conf != null) {
+      blockSize = BZip2Factory.getBlockSize(conf);
+      workFactor = BZip2Factory.getWorkFactor(conf);
+    }
+    reset();
+    LOG.debug("Reinit compressor with new compression configuration");
+  }
+
+  public synchronized void setInput(byte[] b, int off, int len) {
+    checkStream();
+    if (b == null) {
+      throw new NullPointerException();
+    }
+    if (off < 0 || len < 0 || off > b.length - len) {
+      throw new ArrayIndexOutOfBoundsException();
+    }
+
+    this.userBuf = b;
+    this.userBufOff = off;
+    this.userBufLen = len;
+    setInputFromSavedData();
+
+    // Reinitialize bzip2's output direct buffer
+    compressedDirectBuf.limit(directBufferSize);
+    compressedDirectBuf.position(directBufferSize);
+  }
+
+  synchronized void setInputFromSavedData() {
+    uncompressedDirectBufOff = 0;
+    uncompressedDirectBufLen = userBufLen;
+    if (uncompressedDirectBufLen > directBufferSize) {
+      uncompressedDirectBufLen = directBufferSize;
+    }
+
+    // Reinitialize bzip2's input direct buffer
+    uncompressedDirectBuf.rewind();
+    ((ByteBuffer)uncompressedDirectBuf).put(userBuf, userBufOff,
+                                            uncompressedDirectBufLen);
+
+    // Note how much data is being fed to bzip2
+    userBufOff += uncompressedDirectBufLen;
+    userBufLen -= uncompressedDirectBufLen;
+  }
+
+  /**
+   * bzip2 does not support preset dictionaries.
+   *
+   * @throws UnsupportedOperationException
+   */
+  public synchronized void setDictionary(byte[] b, int off, int len) {
+    throw new UnsupportedOperationException();
+  }
+
+  public synchronized boolean needsInput() {
+    checkStream();
+    // Compressed data still available?
+    if (compressedDirectBuf.remaining() > 0) {
+      return false;
+    }
+
+    // Check if bzip2 has consumed all input
+    if (uncompressedDirectBufLen <= 0) {
+      // Check if we have consumed all user-input
+      if (userBufLen <= 0) {
+        return true;
+      } else {
+        setInputFromSavedData();
+      }
+    }
+
+    return false;
+  }
+
+  public synchronized void finish() {
+    finish = true;
+  }
+
+  public synchronized boolean finished() {
+    checkStream();
+    // Check if bzip2 says it has finished and
+    // all compressed data has been consumed
+    return (finished && compressedDirectBuf.remaining() == 0);
+  }
+
+  public synchronized int compress(byte[] b, int off, int len)
+    throws IOException {
+    checkStream();
+    if (b == null) {
+      throw new NullPointerException();
+    }
+    if (off < 0 || len < 0 || off > b.length - len) {
+      throw new ArrayIndexOutOfBoundsException();
+    }
+
+    int n = 0;
+
+    // Check if there is compressed data
+    n = compressedDirectBuf.remaining();
+    if (n > 0) {
+      n = Math.min(n, len);
+      ((ByteBuffer)compressedDirectBuf).get(b, off, n);
+      return n;
+    }
+
+    // Re-initialize bzip2's output direct buffer
+    compressedDirectBuf.rewind();
+    compressedDirectBuf.limit(directBufferSize);
+
+    // Compress data
+    n = compressBytesDirect();
+    compressedDirectBuf.limit(n);
+
+    // Get atmost 'len' bytes
+    n = Math.min(n, len);
+    ((ByteBuffer)compressedDirectBuf).get(b, off, n);
+
+    return n;
+  }
+
+  /**
+   * Returns the total number of compressed bytes output so far.
+   *
+   * @return the total (non-negative) number of compressed bytes output so far
+   */
+  public synchronized long getBytesWritten() {
+    checkStream();
+    return getBytesWritten(stream);
+  }
+
+  /**
+   * Returns the total number of uncompressed bytes input so far.</p>
+   *
+   * @return the total (non-negative) number of uncompressed bytes input so far
+   */
+  public synchronized long getBytesRead() {
+    checkStream();
+    return getBytesRead(stream);
+  }
+
+  /**
+   * libbz2 has no equivalent of <code>deflateReset</code>, so the stream is
+   * torn down and initialized afresh with the current settings.
+   */
+  public synchronized void reset() {
+    checkStream();
+    end(stream);
+    stream = init(blockSize, workFactor);
+    finish = false;
+    finished = false;
+    uncompressedDirectBuf.rewind();
+    uncompressedDirectBufOff = uncompressedDirectBufLen = 0;
+    compressedDirectBuf.limit(directBufferSize);
+    compressedDirectBuf.position(directBufferSize);
+    userBufOff = userBufLen = 0;
+  }
+
+  public synchronized void end() {
+    if (stream != 0) {
+      end(stream);
+      stream = 0;
+    }
+    if (uncompressedDirectBuf != null) {
+      // The buffers go back to the native pool; they must not be touched
+      // after this point.
+      NativeBufferPool.release((ByteBuffer)uncompressedDirectBuf);
+      NativeBufferPool.release((ByteBuffer)compressedDirectBuf);
+      uncompressedDirectBuf = compressedDirectBuf = null;
+    }
+  }
+
+  protected void finalize() {
+    end();
+  }
+
+  private void checkStream() {
+    if (stream == 0)
+      throw new NullPointerException("The compressor has been ended");
+  }
+
+  private native static void initIDs();
+  private native static long init(int blockSize, int workFactor);
+  private native int compressBytesDirect();
+  private native static long getBytesRead(long strm);
+  private native static long getBytesWritten(long strm);
+  private native static void end(long strm);
+}
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.io.compress.bzip2;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.io.compress.Compressor;
+import org.apache.hadoop.io.compress.Decompressor;
+import org.apache.hadoop.io.nativeio.NativeBufferPool;
+import org.apache.hadoop.util.NativeCodeLoader;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
+
+/**
+ * A collection of factories to create the right
+ * bzip2 compressor/decompressor instances.
+ *
+ */
+public class BZip2Factory {
+  private static final Log LOG =
+    LogFactory.getLog(BZip2Factory.class);
+
+  /** Block size in units of 100k, as for <code>bzip2 -9</code>. */
+  static final int DEFAULT_BLOCK_SIZE = 9;
+  /** Zero selects the library default work factor. */
+  static final int DEFAULT_WORK_FACTOR = 0;
+
+  private static boolean nativeBZip2Loaded = false;
+
+  static {
+    if (NativeCodeLoader.isNativeCodeLoaded()) {
+      nativeBZip2Loaded = BZip2Compressor.isNativeBZip2Loaded() &&
+        BZip2Decompressor.isNativeBZip2Loaded();
+
+      if (nativeBZip2Loaded) {
+        LOG.info("Successfully loaded & initialized native-bzip2 library");
+      } else {
+        LOG.warn("Failed to load/initialize native-bzip2 library");
+      }
+    }
+  }
+
+  /**
+   * Check if native-bzip2 code is loaded & initialized correctly and
+   * can be loaded for this job.
+   *
+   * @param conf configuration
+   * @return <code>true</code> if native-bzip2 is loaded & initialized
+   *         and can be loaded for this job, else <code>false</code>
+   */
+  public static boolean isNativeBZip2Loaded(Configuration conf) {
+    return nativeBZip2Loaded && conf != null && conf.getBoolean(
+                          CommonConfigurationKeys.IO_NATIVE_LIB_AVAILABLE_KEY,
+                          CommonConfigurationKeys.IO_NATIVE_LIB_AVAILABLE_DEFAULT);
+  }
+
+  /**
+   * Return the appropriate type of the bzip2 compressor.
+   *
+   * @param conf configuration
+   * @return the appropriate type of the bzip2 compressor.
+   */
+  public static Class<? extends Compressor>
+  getBZip2CompressorType(Configuration conf) {
+    return (isNativeBZip2Loaded(conf)) ?
+            BZip2Compressor.class : BZip2DummyCompressor.class;
+  }
+
+  /**
+   * Return the appropriate implementation of the bzip2 compressor.
+   *
+   * @param conf configuration
+   * @return the appropriate implementation of the bzip2 compressor.
+   */
+  public static Compressor getBZip2Compressor(Configuration conf) {
+    if (!isNativeBZip2Loaded(conf)) {
+      return new BZip2DummyCompressor();
+    }
+    NativeBufferPool.configure(conf);
+    return new BZip2Compressor(conf);
+  }
+
+  /**
+   * Return the appropriate type of the bzip2 decompressor.
+   *
+   * @param conf configuration
+   * @return the appropriate type of the bzip2 decompressor.
+   */
+  public static Class<? extends Decompressor>
+  getBZip2DecompressorType(Configuration conf) {
+    return (isNativeBZip2Loaded(conf)) ?
+            BZip2Decompressor.class : BZip2DummyDecompressor.class;
+  }
+
+  /**
+   * Return the appropriate implementation of the bzip2 decompressor.
+   *
+   * @param conf configuration
+   * @return the appropriate implementation of the bzip2 decompressor.
+   */
+  public static Decompressor getBZip2Decompressor(Configuration conf) {
+    if (!isNativeBZip2Loaded(conf)) {
+      return new BZip2DummyDecompressor();
+    }
+    NativeBufferPool.configure(conf);
+    return new BZip2Decompressor();
+  }
+
+  public static void setBlockSize(Configuration conf, int blockSize) {
+    conf.setInt("bzip2.compress.blocksize", blockSize);
+  }
+
+  public static int getBlockSize(Configuration conf) {
+    return conf.getInt("bzip2.compress.blocksize", DEFAULT_BLOCK_SIZE);
+  }
+
+  public static void setWorkFactor(Configuration conf, int workFactor) {
+    conf.setInt("bzip2.compress.workfactor", workFactor);
+  }
+
+  public static int getWorkFactor(Configuration conf) {
+    return conf.getInt("bzip2.compress.workfactor", DEFAULT_WORK_FACTOR);
+  }
+
+}
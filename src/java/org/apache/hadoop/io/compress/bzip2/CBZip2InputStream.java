@@ -129,7 +129,9 @@ public class CBZip2InputStream extends InputStream implements BZip2Constants {
   private int computedBlockCRC, computedCombinedCRC;
 
   private boolean skipResult = false;// used by skipToNextMarker
-  private static boolean skipDecompression = false;
+  // Defer decoding the first block until it is read. This is per instance,
+  // not static, so that streams may be opened and read concurrently.
+  private boolean skipDecompression = false;
 
   // Variables used by setup* methods exclusively
 
@@ -297,9 +299,7 @@ public class CBZip2InputStream extends InputStream implements BZip2Constants {
       this.currentState = STATE.NO_PROCESS_STATE;
       skipResult = this.skipToNextMarker(CBZip2InputStream.BLOCK_DELIMITER,DELIMITER_BIT_LENGTH);
       this.reportedBytesReadFromCompressedStream = this.bytesReadFromCompressedStream;
-      if(!skipDecompression){
-        changeStateToProcessABlock();
-      }
+      skipDecompression = true;
     }
   }
 
@@ -316,7 +316,6 @@ public class CBZip2InputStream extends InputStream implements BZip2Constants {
    *
    */
   public static long numberOfBytesTillNextMarker(final InputStream in) throws IOException{
-    CBZip2InputStream.skipDecompression = true;
     CBZip2InputStream anObject = null;
 
     anObject = new CBZip2InputStream(in, READ_MODE.BYBLOCK);
@@ -395,7 +394,7 @@ public class CBZip2InputStream extends InputStream implements BZip2Constants {
 
     if(skipDecompression){
       changeStateToProcessABlock();
-      CBZip2InputStream.skipDecompression = false;
+      this.skipDecompression = false;
     }
 
     final int hi = offs + len;
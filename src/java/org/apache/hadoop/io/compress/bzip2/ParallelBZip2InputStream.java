@@ -0,0 +1,371 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.io.compress.bzip2;
+
+import java.io.ByteArrayInputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.InterruptedIOException;
+import java.util.LinkedList;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.io.compress.SplitCompressionInputStream;
+import org.apache.hadoop.io.compress.SplittableCompressionCodec.READ_MODE;
+import org.apache.hadoop.io.compress.bzip2.BZip2BlockScanner.Segment;
+import org.apache.hadoop.util.Daemon;
+
+/**
+ * A bzip2 input stream that decompresses several blocks at once.
+ *
+ * <p>The compressed input is split into blocks by a {@link BZip2BlockScanner}
+ * on the reading thread. Each block is decoded independently by
+ * {@link CBZip2InputStream} on a pool of worker threads, keeping up to two
+ * blocks per thread in flight, and the output is returned in order. The
+ * daemon threads of the pool are shared by all streams in the JVM, number
+ * as many as the most asked for by a stream, and exit when idle for a
+ * minute, so streams that are never closed do not leak threads.</p>
+ *
+ * <p>Reads never return data from more than one block. In BYBLOCK mode the
+ * position reported by {@link #getPos()} follows the same rules as the
+ * serial stream of {@link org.apache.hadoop.io.compress.BZip2Codec}: it is
+ * the end of the first block marker until a byte past the next marker has
+ * been read, so that record readers can find split boundaries. Blocks are
+ * decoded ahead only up to the first one whose marker is past the end of
+ * the split, which a record reader needs for the position to pass the
+ * end; any after it are decoded one at a time, when read.</p>
+ *
+ * <p>Instances of this class are not threadsafe.</p>
+ */
+public class ParallelBZip2InputStream extends SplitCompressionInputStream {
+
+  private static final Log LOG =
+    LogFactory.getLog(ParallelBZip2InputStream.class);
+
+  /* the decoder threads of all streams; guarded by the class */
+  private static ThreadPoolExecutor decoders = null;
+
+  private final int numThreads;
+  private final int maxInFlight;
+  private final long startingPos;
+
+  private BZip2BlockScanner scanner;
+  private boolean scanDone = false;
+  // whether a block past the end of the split has been submitted
+  private boolean pastEnd = false;
+  private final LinkedList<Block> inFlight = new LinkedList<Block>();
+
+  private byte[] current = null;
+  private int currentOff = 0, currentLen = 0;
+  private boolean firstBlock = true;
+  private boolean needsReset = false;
+  private boolean closed = false;
+  private long compressedStreamPosition;
+
+  /** A scanned block and its pending decompressed contents. */
+  private static class Block {
+    final Segment segment;
+    Future<byte[]> result;
+
+    Block(Segment segment) {
+      this.segment = segment;
+    }
+  }
+
+  private static class DecodeTask implements Callable<byte[]> {
+    private final Segment segment;
+
+    DecodeTask(Segment segment) {
+      this.segment = segment;
+    }
+
+    public byte[] call() throws IOException {
+      return decode(segment);
+    }
+  }
+
+  public ParallelBZip2InputStream(InputStream in, int numThreads)
+    throws IOException {
+    this(in, 0L, Long.MAX_VALUE, READ_MODE.CONTINUOUS, numThreads);
+  }
+
+  /**
+   * Create a stream over the compressed range [start, end) of the input,
+   * which must already be positioned at start.
+   *
+   * @param numThreads number of threads decoding blocks
+   */
+  public ParallelBZip2InputStream(InputStream in, long start, long end,
+      READ_MODE readMode, int numThreads) throws IOException {
+    super(in, start, end);
+    if (numThreads < 1) {
+      throw new IllegalArgumentException("numThreads: " + numThreads);
+    }
+    this.numThreads = numThreads;
+    this.maxInFlight = 2 * numThreads;
+    this.startingPos = super.getPos();
+    this.scanner = new BZip2BlockScanner(in);
+    // Like CBZip2InputStream, find the first block before returning so that
+    // the starting position can be advertised.
+    compressedStreamPosition = startingPos + scanner.findBlock();
+    if (startingPos == 0 && readMode == READ_MODE.CONTINUOUS
+        && !scanner.sawMarker() && scanner.getBytesScanned() > 0) {
+      throw new IOException("Stream is not BZip2 formatted");
+    }
+  }
+
+  /**
+   * Decode one block. The output size is unknown ahead of time since the
+   * 900k block limit applies before run-length encoding.
+   */
+  static byte[] decode(Segment segment) throws IOException {
+    CBZip2InputStream in = new CBZip2InputStream(
+        new ByteArrayInputStream(segment.toStream()), READ_MODE.CONTINUOUS);
+    try {
+      byte[] out = new byte[Math.max(4 * segment.getCompressedLength(),
+                                     64 * 1024)];
+      int len = 0;
+      while (true) {
+        if (len == out.length) {
+          byte[] grown = new byte[out.length * 2];
+          System.arraycopy(out, 0, grown, 0, len);
+          out = grown;
+        }
+        int n = in.read(out, len, out.length - len);
+        if (n < 0) {
+          break;
+        }
+        len += n;
+      }
+      if (len == out.length) {
+        return out;
+      }
+      byte[] result = new byte[len];
+      System.arraycopy(out, 0, result, 0, len);
+      return result;
+    } catch (RuntimeException e) {
+      // the decoder does not validate all of its input
+      throw new IOException("Corrupt bzip2 block", e);
+    } finally {
+      in.close();
+    }
+  }
+
+  public int read(byte[] b, int off, int len) throws IOException {
+    if (closed) {
+      throw new IOException("Stream closed");
+    }
+    if (needsReset) {
+      internalReset();
+    }
+    if (len == 0) {
+      return 0;
+    }
+    if (currentOff == currentLen) {
+      if (!nextBlock()) {
+        return -1;
+      }
+    }
+    int n = Math.min(len, currentLen - currentOff);
+    System.arraycopy(current, currentOff, b, off, n);
+    currentOff += n;
+    return n;
+  }
+
+  public int read() throws IOException {
+    byte b[] = new byte[1];
+    int result = this.read(b, 0, 1);
+    return (result < 0) ? result : (b[0] & 0xff);
+  }
+
+  /**
+   * Move to the next non-empty block, advertising the position of its
+   * marker.
+   *
+   * @return false at the end of the stream
+   */
+  private boolean nextBlock() throws IOException {
+    do {
+      fill(true);
+      if (inFlight.isEmpty()) {
+        current = null;
+        currentOff = currentLen = 0;
+        compressedStreamPosition =
+          startingPos + scanner.getBytesScanned() + 1;
+        return false;
+      }
+      Block block = inFlight.removeFirst();
+      current = getResult(block);
+      currentOff = 0;
+      currentLen = current.length;
+      // The first block's position was advertised on construction; later
+      // ones are advertised once a byte past their marker is read.
+      if (!firstBlock) {
+        compressedStreamPosition =
+          startingPos + block.segment.getMarkerEnd() + 1;
+      }
+      firstBlock = false;
+      fill(false);
+    } while (currentLen == 0);
+    return true;
+  }
+
+  private byte[] getResult(Block block) throws IOException {
+    try {
+      return waitFor(block.result);
+    } catch (IOException e) {
+      // A block marker may occur inside compressed data by chance; if so,
+      // this block was cut short, and joined with the next one it decodes.
+      fill(true);
+      if (inFlight.isEmpty()) {
+        throw e;
+      }
+      Block next = inFlight.removeFirst();
+      next.result.cancel(false);
+      LOG.debug("Retrying bzip2 block at offset "
+          + (startingPos + block.segment.getMarkerEnd())
+          + " joined with its successor", e);
+      try {
+        return decode(Segment.join(block.segment, next.segment));
+      } catch (IOException e2) {
+        throw e;
+      }
+    }
+  }
+
+  private static byte[] waitFor(Future<byte[]> result) throws IOException {
+    try {
+      return result.get();
+    } catch (InterruptedException e) {
+      throw (IOException) new InterruptedIOException(
+          "Interrupted while decompressing bzip2 block").initCause(e);
+    } catch (ExecutionException e) {
+      Throwable cause = e.getCause();
+      if (cause instanceof IOException) {
+        throw (IOException) cause;
+      }
+      if (cause instanceof RuntimeException) {
+        throw (RuntimeException) cause;
+      }
+      if (cause instanceof Error) {
+        throw (Error) cause;
+      }
+      throw new IOException(cause);
+    }
+  }
+
+  /**
+   * Scan and submit blocks until enough are in flight, or until a block
+   * past the end of the split is.
+   *
+   * @param needed whether a block is about to be taken; past the end of
+   *               the split, blocks are only submitted then
+   */
+  private void fill(boolean needed) throws IOException {
+    while (!scanDone && !pastEnd && inFlight.size() < maxInFlight) {
+      submitNext();
+    }
+    if (needed && !scanDone && inFlight.isEmpty()) {
+      submitNext();
+    }
+  }
+
+  /** Scan the next block and submit it for decoding. */
+  private void submitNext() throws IOException {
+    Segment segment = scanner.next();
+    if (segment == null) {
+      scanDone = true;
+      return;
+    }
+    Block block = new Block(segment);
+    block.result = getDecoders(numThreads).submit(new DecodeTask(segment));
+    inFlight.addLast(block);
+    if (startingPos + segment.getMarkerEnd() > getAdjustedEnd()) {
+      pastEnd = true;
+    }
+  }
+
+  /* Get the shared pool, grown to at least the given number of threads. */
+  private static synchronized ThreadPoolExecutor getDecoders(int threads) {
+    if (decoders == null) {
+      decoders = new ThreadPoolExecutor(threads, threads, 60, TimeUnit.SECONDS,
+          new LinkedBlockingQueue<Runnable>(), new ThreadFactory() {
+            public Thread newThread(Runnable r) {
+              Thread t = new Daemon(r);
+              t.setName("bzip2 decoder " + t.getId());
+              return t;
+            }
+          });
+      decoders.allowCoreThreadTimeOut(true);
+    } else if (decoders.getMaximumPoolSize() < threads) {
+      decoders.setMaximumPoolSize(threads);
+      decoders.setCorePoolSize(threads);
+    }
+    return decoders;
+  }
+
+  private void discardInFlight() {
+    for (Block block : inFlight) {
+      block.result.cancel(false);
+    }
+    inFlight.clear();
+    current = null;
+    currentOff = currentLen = 0;
+  }
+
+  private void internalReset() throws IOException {
+    needsReset = false;
+    scanner = new BZip2BlockScanner(in);
+    scanDone = false;
+    pastEnd = false;
+    firstBlock = true;
+    compressedStreamPosition = startingPos + scanner.findBlock();
+  }
+
+  public void resetState() throws IOException {
+    // Cannot read from in at this point because it might not be ready yet,
+    // as in SequenceFile.Reader implementation.
+    discardInFlight();
+    needsReset = true;
+  }
+
+  public long getPos() {
+    return compressedStreamPosition;
+  }
+
+  /** The number of threads decoding blocks. */
+  public int getNumThreads() {
+    return numThreads;
+  }
+
+  public void close() throws IOException {
+    if (!closed) {
+      closed = true;
+      discardInFlight();
+      super.close();
+    }
+  }
+}
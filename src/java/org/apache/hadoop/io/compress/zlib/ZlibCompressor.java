@@ -24,6 +24,7 @@ import java.nio.ByteBuffer;
 
 import org.apache.hadoop.conf.Configuration;
 import org.apache.hadoop.io.compress.Compressor;
+import org.apache.hadoop.io.nativeio.NativeBufferPool;
 import org.apache.hadoop.util.NativeCodeLoader;
 
 import org.apache.commons.logging.Log;
@@ -229,8 +230,8 @@ public class ZlibCompressor implements Compressor {
                   this.windowBits.windowBits());
 
     this.directBufferSize = directBufferSize;
-    uncompressedDirectBuf = ByteBuffer.allocateDirect(directBufferSize);
-    compressedDirectBuf = ByteBuffer.allocateDirect(directBufferSize);
+    uncompressedDirectBuf = NativeBufferPool.allocate(directBufferSize);
+    compressedDirectBuf = NativeBufferPool.allocate(directBufferSize);
     compressedDirectBuf.position(directBufferSize);
   }
 
@@ -257,6 +258,7 @@ public class ZlibCompressor implements Compressor {
   }
 
   public synchronized void setInput(byte[] b, int off, int len) {
+    checkStream();
     if (b== null) {
       throw new NullPointerException();
     }
@@ -302,6 +304,7 @@ public class ZlibCompressor implements Compressor {
   }
 
   public synchronized boolean needsInput() {
+    checkStream();
     // Consume remaining compressed data?
     if (compressedDirectBuf.remaining() > 0) {
       return false;
@@ -325,6 +328,7 @@ public class ZlibCompressor implements Compressor {
   }
   
   public synchronized boolean finished() {
+    checkStream();
     // Check if 'zlib' says its 'finished' and
     // all compressed data has been consumed
     return (finished && compressedDirectBuf.remaining() == 0);
@@ -332,6 +336,7 @@ public class ZlibCompressor implements Compressor {
 
   public synchronized int compress(byte[] b, int off, int len) 
     throws IOException {
+    checkStream();
     if (b == null) {
       throw new NullPointerException();
     }
@@ -401,11 +406,22 @@ public class ZlibCompressor implements Compressor {
       end(stream);
       stream = 0;
     }
+    if (uncompressedDirectBuf != null) {
+      // The buffers go back to the native pool; they must not be touched
+      // after this point.
+      NativeBufferPool.release((ByteBuffer)uncompressedDirectBuf);
+      NativeBufferPool.release((ByteBuffer)compressedDirectBuf);
+      uncompressedDirectBuf = compressedDirectBuf = null;
+    }
+  }
+
+  protected void finalize() {
+    end();
   }
   
   private void checkStream() {
     if (stream == 0)
-      throw new NullPointerException();
+      throw new NullPointerException("The compressor has been ended");
   }
   
   private native static void initIDs();
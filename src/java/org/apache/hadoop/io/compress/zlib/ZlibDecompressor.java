@@ -23,6 +23,7 @@ import java.nio.Buffer;
 import java.nio.ByteBuffer;
 
 import org.apache.hadoop.io.compress.Decompressor;
+import org.apache.hadoop.io.nativeio.NativeBufferPool;
 import org.apache.hadoop.util.NativeCodeLoader;
 
 /**
@@ -107,8 +108,8 @@ public class ZlibDecompressor implements Decompressor {
   public ZlibDecompressor(CompressionHeader header, int directBufferSize) {
     this.header = header;
     this.directBufferSize = directBufferSize;
-    compressedDirectBuf = ByteBuffer.allocateDirect(directBufferSize);
-    uncompressedDirectBuf = ByteBuffer.allocateDirect(directBufferSize);
+    compressedDirectBuf = NativeBufferPool.allocate(directBufferSize);
+    uncompressedDirectBuf = NativeBufferPool.allocate(directBufferSize);
     uncompressedDirectBuf.position(directBufferSize);
     
     stream = init(this.header.windowBits());
@@ -119,6 +120,7 @@ public class ZlibDecompressor implements Decompressor {
   }
 
   public synchronized void setInput(byte[] b, int off, int len) {
+    checkStream();
     if (b == null) {
       throw new NullPointerException();
     }
@@ -166,6 +168,7 @@ public class ZlibDecompressor implements Decompressor {
   }
 
   public synchronized boolean needsInput() {
+    checkStream();
     // Consume remanining compressed data?
     if (uncompressedDirectBuf.remaining() > 0) {
       return false;
@@ -189,6 +192,7 @@ public class ZlibDecompressor implements Decompressor {
   }
 
   public synchronized boolean finished() {
+    checkStream();
     // Check if 'zlib' says its 'finished' and
     // all compressed data has been consumed
     return (finished && uncompressedDirectBuf.remaining() == 0);
@@ -196,6 +200,7 @@ public class ZlibDecompressor implements Decompressor {
 
   public synchronized int decompress(byte[] b, int off, int len) 
     throws IOException {
+    checkStream();
     if (b == null) {
       throw new NullPointerException();
     }
@@ -264,6 +269,13 @@ public class ZlibDecompressor implements Decompressor {
       end(stream);
       stream = 0;
     }
+    if (uncompressedDirectBuf != null) {
+      // The buffers go back to the native pool; they must not be touched
+      // after this point.
+      NativeBufferPool.release((ByteBuffer)uncompressedDirectBuf);
+      NativeBufferPool.release((ByteBuffer)compressedDirectBuf);
+      uncompressedDirectBuf = compressedDirectBuf = null;
+    }
   }
 
   protected void finalize() {
@@ -272,7 +284,7 @@ public class ZlibDecompressor implements Decompressor {
   
   private void checkStream() {
     if (stream == 0)
-      throw new NullPointerException();
+      throw new NullPointerException("The decompressor has been ended");
   }
   
   private native static void initIDs();
@@ -25,6 +25,7 @@ import org.apache.hadoop.io.compress.Compressor;
 import org.apache.hadoop.io.compress.Decompressor;
 import org.apache.hadoop.io.compress.zlib.ZlibCompressor.CompressionLevel;
 import org.apache.hadoop.io.compress.zlib.ZlibCompressor.CompressionStrategy;
+import org.apache.hadoop.io.nativeio.NativeBufferPool;
 import org.apache.hadoop.util.NativeCodeLoader;
 import org.apache.hadoop.fs.CommonConfigurationKeys;
 
@@ -85,8 +86,11 @@ public class ZlibFactory {
    * @return the appropriate implementation of the zlib compressor.
    */
   public static Compressor getZlibCompressor(Configuration conf) {
-    return (isNativeZlibLoaded(conf)) ? 
-      new ZlibCompressor() : new BuiltInZlibDeflater(); 
+    if (!isNativeZlibLoaded(conf)) {
+      return new BuiltInZlibDeflater();
+    }
+    NativeBufferPool.configure(conf);
+    return new ZlibCompressor();
   }
 
   /**
@@ -108,8 +112,11 @@ public class ZlibFactory {
    * @return the appropriate implementation of the zlib decompressor.
    */
   public static Decompressor getZlibDecompressor(Configuration conf) {
-    return (isNativeZlibLoaded(conf)) ? 
-      new ZlibDecompressor() : new BuiltInZlibInflater(); 
+    if (!isNativeZlibLoaded(conf)) {
+      return new BuiltInZlibInflater();
+    }
+    NativeBufferPool.configure(conf);
+    return new ZlibDecompressor();
   }
 
   public static void setCompressionStrategy(Configuration conf,
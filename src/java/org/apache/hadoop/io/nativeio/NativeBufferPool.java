@@ -0,0 +1,193 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.nativeio;
+
+import java.nio.ByteBuffer;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
+import org.apache.hadoop.util.NativeCodeLoader;
+
+/**
+ * A pool of direct buffers allocated in native memory.
+ *
+ * <p>Direct buffers from {@link ByteBuffer#allocateDirect(int)} are only
+ * freed when the garbage collector finds them, so codecs that are created
+ * and dropped quickly hold on to native memory well past their use. Buffers
+ * from this pool are instead {@link #release released} explicitly, and their
+ * memory is kept in size-classed free lists in libhadoop for the next
+ * allocation, up to a bounded total. The native codecs also allocate their
+ * stream state from the same pool.</p>
+ *
+ * <p>Without the native library the pool falls back to
+ * {@link ByteBuffer#allocateDirect(int)}, and releasing is a no-op.</p>
+ *
+ * <p>A released buffer must not be used again: its memory may already back
+ * another buffer, or have been returned to the system.</p>
+ */
+@InterfaceAudience.Private
+@InterfaceStability.Unstable
+public class NativeBufferPool {
+  private static final Log LOG = LogFactory.getLog(NativeBufferPool.class);
+
+  private static boolean nativeLoaded = false;
+  private static volatile long capacity =
+    CommonConfigurationKeys.IO_NATIVE_BUFFER_POOL_CAPACITY_DEFAULT;
+
+  static {
+    if (NativeCodeLoader.isNativeCodeLoaded()) {
+      try {
+        initIDs();
+        nativeLoaded = true;
+      } catch (Throwable t) {
+        LOG.warn("Failed to initialize the native buffer pool: " + t);
+      }
+    }
+  }
+
+  /** Do not allow to create a new instance */
+  private NativeBufferPool() {}
+
+  /**
+   * Check whether buffers come from the native pool.
+   *
+   * @return <code>true</code> if the native pool is loaded and initialized
+   */
+  public static boolean isNativeLoaded() {
+    return nativeLoaded;
+  }
+
+  /**
+   * Set the capacity of the pool from the configuration.
+   *
+   * @param conf configuration
+   */
+  public static void configure(Configuration conf) {
+    if (conf != null) {
+      setCapacity(conf.getLong(
+          CommonConfigurationKeys.IO_NATIVE_BUFFER_POOL_CAPACITY_KEY,
+          CommonConfigurationKeys.IO_NATIVE_BUFFER_POOL_CAPACITY_DEFAULT));
+    }
+  }
+
+  /**
+   * Set the most memory, in bytes, that released buffers may keep cached in
+   * the pool. Cached memory beyond the new capacity is freed.
+   */
+  public static void setCapacity(long bytes) {
+    if (bytes < 0) {
+      throw new IllegalArgumentException("capacity: " + bytes);
+    }
+    if (nativeLoaded && bytes != capacity) {
+      synchronized (NativeBufferPool.class) {
+        setCapacity0(bytes);
+        capacity = bytes;
+      }
+    }
+  }
+
+  /**
+   * Allocate a direct buffer of the given capacity.
+   * Its contents are undefined.
+   */
+  public static ByteBuffer allocate(int size) {
+    if (!nativeLoaded) {
+      return ByteBuffer.allocateDirect(size);
+    }
+    return allocateDirect(size);
+  }
+
+  /**
+   * Return a buffer from {@link #allocate(int)} to the pool.
+   *
+   * @param buf the buffer, or <code>null</code>
+   * @throws IllegalArgumentException if the buffer did not come from the
+   *         pool, or has already been released
+   */
+  public static void release(ByteBuffer buf) {
+    if (nativeLoaded && buf != null) {
+      release0(buf);
+    }
+  }
+
+  /** Free all memory cached in the pool. */
+  public static void trim() {
+    if (nativeLoaded) {
+      trim0();
+    }
+  }
+
+  /**
+   * A snapshot of the pool's usage. All values are zero without the native
+   * library.
+   */
+  public static class Stats {
+    private final long[] values = new long[5];
+
+    /** The most memory, in bytes, cached for reuse. */
+    public long getCapacity() {
+      return values[0];
+    }
+
+    /** The memory, in bytes, held by unreleased buffers and streams. */
+    public long getOutstandingBytes() {
+      return values[1];
+    }
+
+    /** The memory, in bytes, cached for reuse. */
+    public long getCachedBytes() {
+      return values[2];
+    }
+
+    /** The number of allocations since startup. */
+    public long getAllocations() {
+      return values[3];
+    }
+
+    /** The number of allocations served from cached memory. */
+    public long getHits() {
+      return values[4];
+    }
+
+    public String toString() {
+      return "outstanding=" + getOutstandingBytes() + " cached="
+        + getCachedBytes() + " capacity=" + getCapacity() + " allocations="
+        + getAllocations() + " hits=" + getHits();
+    }
+  }
+
+  /** Get the current usage of the pool. */
+  public static Stats getStats() {
+    Stats stats = new Stats();
+    if (nativeLoaded) {
+      getStats(stats.values);
+    }
+    return stats;
+  }
+
+  private native static void initIDs();
+  private native static ByteBuffer allocateDirect(int size);
+  private native static void release0(ByteBuffer buf);
+  private native static void setCapacity0(long bytes);
+  private native static void trim0();
+  private native static void getStats(long[] stats);
+}
@@ -0,0 +1,135 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.nativeio;
+
+import java.io.File;
+import java.io.IOException;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.util.NativeCodeLoader;
+
+/**
+ * MD5 and CRC32 computed in libhadoop.
+ *
+ * <p>Besides hashing one buffer, MD5 can hash several buffers of the same
+ * length side by side, four to a vector register, which is several times
+ * the throughput of hashing them one after the other. The MD5 of MD5 of
+ * CRC32 checksum that HDFS reports for a file can be computed for a local
+ * file in one pass over it, with the blocks' CRCs hashed in the same
+ * way.</p>
+ *
+ * <p>The methods may only be called if {@link #isNativeLoaded()}.</p>
+ */
+@InterfaceAudience.Private
+@InterfaceStability.Unstable
+public class NativeChecksum {
+  private static final Log LOG = LogFactory.getLog(NativeChecksum.class);
+
+  /** The length of an MD5 digest. */
+  public static final int MD5_LEN = 16;
+
+  private static boolean nativeLoaded = false;
+
+  static {
+    if (NativeCodeLoader.isNativeCodeLoaded()) {
+      try {
+        init0();
+        nativeLoaded = true;
+      } catch (Throwable t) {
+        LOG.warn("Failed to initialize native checksums: " + t);
+      }
+    }
+  }
+
+  /** Do not allow to create a new instance */
+  private NativeChecksum() {}
+
+  /**
+   * Check whether native checksums are available.
+   *
+   * @return <code>true</code> if libhadoop is loaded and initialized
+   */
+  public static boolean isNativeLoaded() {
+    return nativeLoaded;
+  }
+
+  /**
+   * Compute the MD5 of a range of bytes.
+   *
+   * @param digest receives the {@link #MD5_LEN} bytes of the digest from
+   *        digestOff
+   */
+  public static void digest(byte[] data, int off, int len,
+                            byte[] digest, int digestOff) {
+    if (off < 0 || len < 0 || off > data.length - len
+        || digestOff < 0 || digestOff > digest.length - MD5_LEN) {
+      throw new IndexOutOfBoundsException();
+    }
+    digest0(data, off, len, digest, digestOff);
+  }
+
+  /**
+   * Compute the MD5 of the first len bytes of each of several arrays,
+   * four at a time.
+   *
+   * @param digests receives the digest of data[i] at i * {@link #MD5_LEN}
+   */
+  public static void digest(byte[][] data, int len, byte[] digests) {
+    if (len < 0 || digests.length < data.length * MD5_LEN) {
+      throw new IndexOutOfBoundsException();
+    }
+    for (byte[] d : data) {
+      if (d.length < len) {
+        throw new IndexOutOfBoundsException();
+      }
+    }
+    digestMulti0(data, len, digests);
+  }
+
+  /**
+   * Compute the MD5 of MD5 of CRC32 of a local file, as HDFS would for a
+   * file with the same contents, block size and bytes per checksum: the
+   * MD5 of the MD5 of each block's CRCs, each CRC in big-endian order.
+   *
+   * @return the {@link #MD5_LEN} bytes of the digest
+   * @throws IllegalArgumentException if a block has more than 2^26 CRCs
+   */
+  public static byte[] fileChecksum(File file, int bytesPerCRC,
+                                    long blockSize) throws IOException {
+    if (bytesPerCRC <= 0 || blockSize <= 0) {
+      throw new IllegalArgumentException("bytesPerCRC=" + bytesPerCRC
+          + ", blockSize=" + blockSize);
+    }
+    byte[] digest = new byte[MD5_LEN];
+    fileChecksum0(NativeIO.toCString(file.getPath()), bytesPerCRC, blockSize,
+                  digest);
+    return digest;
+  }
+
+  private native static void init0();
+  private native static void digest0(byte[] data, int off, int len,
+                                     byte[] digest, int digestOff);
+  private native static void digestMulti0(byte[][] data, int len,
+                                          byte[] digests);
+  private native static void fileChecksum0(byte[] path, int bytesPerCRC,
+                                           long blockSize, byte[] digest)
+    throws IOException;
+}
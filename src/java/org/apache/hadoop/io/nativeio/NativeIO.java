@@ -0,0 +1,176 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.nativeio;
+
+import java.io.File;
+import java.io.IOException;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.util.NativeCodeLoader;
+
+/**
+ * File system calls in libhadoop that Java has no API for, and that would
+ * otherwise take a <code>ln</code>, <code>stat</code> or
+ * <code>readlink</code> process each.
+ *
+ * <p>Paths are passed in the platform's default encoding, as
+ * {@link File} does. A file that does not exist is reported with a
+ * {@link java.io.FileNotFoundException}.</p>
+ */
+@InterfaceAudience.Private
+@InterfaceStability.Unstable
+public class NativeIO {
+  private static final Log LOG = LogFactory.getLog(NativeIO.class);
+
+  private static boolean nativeLoaded = false;
+
+  static {
+    if (NativeCodeLoader.isNativeCodeLoaded()) {
+      try {
+        // an inexpensive call to check that the functions are present
+        getLinkCount0(toCString("/"));
+        nativeLoaded = true;
+      } catch (Throwable t) {
+        LOG.warn("Failed to initialize native file system calls: " + t);
+      }
+    }
+  }
+
+  /** Do not allow to create a new instance */
+  private NativeIO() {}
+
+  /**
+   * Check whether the native calls are available.
+   *
+   * @return <code>true</code> if libhadoop is loaded and initialized
+   */
+  public static boolean isNativeLoaded() {
+    return nativeLoaded;
+  }
+
+  /**
+   * Create a hard link.
+   *
+   * @param target an existing file
+   * @param linkName the new link, which must not exist
+   */
+  public static void link(String target, String linkName) throws IOException {
+    link0(toCString(target), toCString(linkName));
+  }
+
+  /**
+   * Create a symbolic link.
+   *
+   * @param target the target of the link, which need not exist
+   * @param linkName the new link, which must not exist
+   */
+  public static void symlink(String target, String linkName)
+      throws IOException {
+    symlink0(toCString(target), toCString(linkName));
+  }
+
+  /**
+   * Read the target of a symbolic link.
+   *
+   * @param linkName a path
+   * @return the target, or <code>null</code> if the path is not a symbolic
+   *         link
+   */
+  public static String readlink(String linkName) throws IOException {
+    byte[] target = readlink0(toCString(linkName));
+    return target == null ? null : new String(target);
+  }
+
+  /**
+   * Get the number of hard links to a file.
+   *
+   * @param file a path
+   * @return the link count of the file, following symbolic links
+   */
+  public static int getLinkCount(String file) throws IOException {
+    return getLinkCount0(toCString(file));
+  }
+
+  /**
+   * Link each of the given files of a directory into another directory,
+   * under the same name. Both directories are opened once, and each link is
+   * made relative to them with <code>linkat(2)</code>.
+   *
+   * @param srcDir the directory of the existing files
+   * @param names the names of the files in srcDir
+   * @param dstDir the directory to link the files into
+   * @throws IOException if a link fails; the files before it are linked
+   */
+  public static void linkAll(File srcDir, String[] names, File dstDir)
+      throws IOException {
+    byte[][] cNames = new byte[names.length][];
+    for (int i = 0; i < names.length; i++) {
+      if (names[i].indexOf('/') >= 0) {
+        throw new IllegalArgumentException("Not a file name: " + names[i]);
+      }
+      cNames[i] = toCString(names[i]);
+    }
+    linkAll0(toCString(srcDir.getPath()), cNames, toCString(dstDir.getPath()));
+  }
+
+  /**
+   * Delete the files, symbolic links and empty directories in a directory,
+   * working relative to the open directory with <code>unlinkat(2)</code>.
+   * Symbolic links are never followed, including one that replaced
+   * <code>dir</code> itself.
+   *
+   * @param dir a directory
+   * @param failures its first element is set to the number of entries that
+   *        could not be deleted
+   * @return the names of the subdirectories that were not empty, or
+   *         <code>null</code> if dir cannot be opened as a directory
+   */
+  public static String[] deleteEntries(String dir, int[] failures)
+      throws IOException {
+    byte[][] names = deleteEntries0(toCString(dir), failures);
+    if (names == null) {
+      return null;
+    }
+    String[] result = new String[names.length];
+    for (int i = 0; i < names.length; i++) {
+      result[i] = new String(names[i]);
+    }
+    return result;
+  }
+
+  static byte[] toCString(String s) {
+    byte[] bytes = s.getBytes();
+    byte[] result = new byte[bytes.length + 1];
+    System.arraycopy(bytes, 0, result, 0, bytes.length);
+    return result;
+  }
+
+  private native static void link0(byte[] target, byte[] linkName)
+    throws IOException;
+  private native static void symlink0(byte[] target, byte[] linkName)
+    throws IOException;
+  private native static byte[] readlink0(byte[] linkName) throws IOException;
+  private native static int getLinkCount0(byte[] file) throws IOException;
+  private native static byte[][] deleteEntries0(byte[] dir, int[] failures)
+    throws IOException;
+  private native static int linkAll0(byte[] srcDir, byte[][] names,
+      byte[] dstDir) throws IOException;
+}
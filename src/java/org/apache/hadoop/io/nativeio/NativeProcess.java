@@ -0,0 +1,376 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.nativeio;
+
+import java.io.Closeable;
+import java.io.File;
+import java.io.FileDescriptor;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.util.HashMap;
+import java.util.Map;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.util.Daemon;
+import org.apache.hadoop.util.NativeCodeLoader;
+
+/**
+ * A child process started by libhadoop with <code>vfork(2)</code> and
+ * <code>execve(2)</code>.
+ *
+ * <p>{@link ProcessBuilder} forks the JVM, which has to copy the page tables
+ * of the whole heap and, without overcommit, reserve as much memory again;
+ * on a daemon with a large heap every <code>df</code>, <code>du</code> or
+ * topology script then costs milliseconds and can fail with ENOMEM. The
+ * child started here borrows the parent's memory until it execs, so the
+ * cost of a launch does not depend on the heap size.</p>
+ *
+ * <p>Like {@link ProcessBuilder}, the command is looked up on the parent's
+ * <code>PATH</code>, a script without <code>#!</code> is run with
+ * <code>/bin/sh</code>, the environment is the parent's plus the given
+ * variables, and the child inherits no descriptors but its pipes.</p>
+ *
+ * <p>Children are reaped as soon as they exit, and {@link #waitFor()} waits
+ * on the process's monitor, so it can be interrupted. One daemon thread
+ * waits in <code>poll(2)</code> for the exits of all children, on a
+ * pidfd each; where the kernel has no pidfds, each child is waited for by
+ * a daemon thread of its own blocked in <code>waitid(2)</code>. Neither
+ * waits for any child but ours, so the children of {@link ProcessBuilder}
+ * are left to the JVM.</p>
+ */
+@InterfaceAudience.Private
+@InterfaceStability.Unstable
+public class NativeProcess extends Process {
+  private static final Log LOG = LogFactory.getLog(NativeProcess.class);
+
+  /* returned by reap0 for a child that is still running */
+  private static final int RUNNING = -2;
+
+  private static boolean nativeLoaded = false;
+
+  /* the children waited for by the reaper thread, by their pidfds */
+  private static final Map<Integer, NativeProcess> watched =
+    new HashMap<Integer, NativeProcess>();
+  /* the reaper thread, or null if not started; guarded by watched */
+  private static Daemon reaper = null;
+
+  static {
+    if (NativeCodeLoader.isNativeCodeLoaded()) {
+      try {
+        initIDs();
+        nativeLoaded = true;
+      } catch (Throwable t) {
+        LOG.warn("Failed to initialize the native process launcher: " + t);
+      }
+    }
+  }
+
+  private final int pid;
+  private final OutputStream stdin;
+  private final InputStream stdout;
+  private final InputStream stderr;
+  private boolean exited = false;
+  private int exitCode;
+
+  private NativeProcess(int pid, FileDescriptor[] fds) {
+    this.pid = pid;
+    stdin = new FileOutputStream(fds[0]);
+    stdout = new FileInputStream(fds[1]);
+    stderr = new FileInputStream(fds[2]);
+  }
+
+  /**
+   * Check whether processes can be started natively.
+   *
+   * @return <code>true</code> if libhadoop is loaded and initialized
+   */
+  public static boolean isNativeLoaded() {
+    return nativeLoaded;
+  }
+
+  /**
+   * Start a process.
+   *
+   * @param command the command and its arguments
+   * @param environment variables to add to the parent's environment, or
+   *        <code>null</code>
+   * @param dir the working directory, or <code>null</code> for the
+   *        parent's
+   * @return the started process
+   * @throws IOException if the command cannot be run
+   */
+  public static NativeProcess start(String[] command,
+      Map<String, String> environment, File dir) throws IOException {
+    if (!nativeLoaded) {
+      throw new IOException("The native process launcher is not loaded");
+    }
+    String path = findExecutable(command[0]);
+    if (path == null) {
+      throw new IOException("Cannot run program \"" + command[0]
+          + "\": error=2, No such file or directory");
+    }
+    byte[][] argv = new byte[command.length][];
+    for (int i = 0; i < command.length; i++) {
+      argv[i] = toCString(command[i]);
+    }
+    byte[][] envp = null;
+    if (environment != null) {
+      Map<String, String> env =
+        new HashMap<String, String>(System.getenv());
+      env.putAll(environment);
+      envp = new byte[env.size()][];
+      int i = 0;
+      for (Map.Entry<String, String> e : env.entrySet()) {
+        envp[i++] = toCString(e.getKey() + "=" + e.getValue());
+      }
+    }
+    byte[] dirBytes = dir == null ? null : toCString(dir.getPath());
+
+    FileDescriptor[] fds = new FileDescriptor[3];
+    int pid;
+    try {
+      pid = spawn(toCString(path), argv, envp, dirBytes, fds);
+    } catch (IOException e) {
+      throw new IOException("Cannot run program \"" + command[0] + "\""
+          + (dir == null ? "" : " (in directory \"" + dir + "\")") + ": "
+          + e.getMessage());
+    }
+    if (fds[2] == null) {
+      // the descriptors that could not be wrapped are already closed
+      for (int i = 0; i < fds.length; i++) {
+        if (fds[i] == null) {
+          fds[i] = new FileDescriptor();
+        }
+      }
+      NativeProcess p = new NativeProcess(pid, fds);
+      watch(p);
+      p.destroy();
+      throw new IOException("Cannot run program \"" + command[0]
+          + "\": out of memory");
+    }
+    NativeProcess p = new NativeProcess(pid, fds);
+    watch(p);
+    return p;
+  }
+
+  /* Have the child reaped as soon as it exits. */
+  private static void watch(final NativeProcess p) {
+    synchronized (watched) {
+      int fd = openExitFd0(p.pid);
+      if (fd >= 0) {
+        watched.put(fd, p);
+        if (reaper == null) {
+          reaper = new Daemon(new Runnable() {
+            public void run() {
+              reapWatched();
+            }
+          });
+          reaper.setName("NativeProcess reaper");
+          reaper.start();
+        } else {
+          wakeReaper0();
+        }
+        return;
+      }
+    }
+    waitInBackground(p);
+  }
+
+  /* Reap the child on a thread of its own once it exits. */
+  private static void waitInBackground(final NativeProcess p) {
+    Daemon waiter = new Daemon(new Runnable() {
+      public void run() {
+        waitExit0(p.pid);
+        p.exited();
+      }
+    });
+    waiter.setName("NativeProcess reaper for " + p.pid);
+    waiter.start();
+  }
+
+  /* The reaper thread: reap each watched child when its pidfd becomes
+   * readable. If poll fails, each child gets a thread of its own. */
+  private static void reapWatched() {
+    while (true) {
+      int[] fds;
+      synchronized (watched) {
+        fds = new int[watched.size()];
+        int i = 0;
+        for (Integer fd : watched.keySet()) {
+          fds[i++] = fd;
+        }
+      }
+      int[] ready;
+      try {
+        ready = waitExitFds0(fds);
+      } catch (IOException e) {
+        LOG.warn("Failed to wait for native processes", e);
+        Map<Integer, NativeProcess> orphans;
+        synchronized (watched) {
+          orphans = new HashMap<Integer, NativeProcess>(watched);
+          watched.clear();
+          reaper = null;
+        }
+        for (Map.Entry<Integer, NativeProcess> entry : orphans.entrySet()) {
+          closeExitFd0(entry.getKey());
+          waitInBackground(entry.getValue());
+        }
+        return;
+      }
+      for (int fd : ready) {
+        NativeProcess p;
+        synchronized (watched) {
+          p = watched.remove(fd);
+        }
+        closeExitFd0(fd);
+        if (p != null) {
+          p.exited();
+        }
+      }
+    }
+  }
+
+  /* Find a command on the PATH as execvp does; commands with a / are
+   * relative to the child's working directory. The PATH is searched on
+   * every launch, so commands installed or removed later are seen. */
+  private static String findExecutable(String command) {
+    if (command.indexOf('/') >= 0) {
+      return command;
+    }
+    String searchPath = System.getenv("PATH");
+    if (searchPath == null) {
+      searchPath = "/bin:/usr/bin";
+    }
+    for (String dir : searchPath.split(File.pathSeparator, -1)) {
+      File f = new File(dir.length() == 0 ? "." : dir, command);
+      if (f.isFile() && f.canExecute()) {
+        return f.getPath();
+      }
+    }
+    return null;
+  }
+
+  private static byte[] toCString(String s) {
+    byte[] bytes = s.getBytes();
+    byte[] result = new byte[bytes.length + 1];
+    System.arraycopy(bytes, 0, result, 0, bytes.length);
+    return result;
+  }
+
+  /** @return the process id */
+  public int getPid() {
+    return pid;
+  }
+
+  @Override
+  public OutputStream getOutputStream() {
+    return stdin;
+  }
+
+  @Override
+  public InputStream getInputStream() {
+    return stdout;
+  }
+
+  @Override
+  public InputStream getErrorStream() {
+    return stderr;
+  }
+
+  /* Reap the child if it has exited. The child is only reaped here, with
+   * the lock held, so destroy() never signals a reused pid. */
+  private synchronized void reap() {
+    if (!exited) {
+      int status = reap0(pid);
+      if (status != RUNNING) {
+        exitCode = status;
+        exited = true;
+      }
+    }
+  }
+
+  /* Called by a reaper thread once the child has exited. */
+  private synchronized void exited() {
+    reap();
+    notifyAll();
+  }
+
+  /**
+   * Wait for the process to exit. The child is reaped by a reaper thread,
+   * which wakes the waiters.
+   */
+  @Override
+  public synchronized int waitFor() throws InterruptedException {
+    reap();
+    while (!exited) {
+      wait();
+    }
+    return exitCode;
+  }
+
+  @Override
+  public synchronized int exitValue() {
+    reap();
+    if (!exited) {
+      throw new IllegalThreadStateException("process hasn't exited");
+    }
+    return exitCode;
+  }
+
+  /**
+   * Kill the process with SIGTERM if it is still running, and close its
+   * streams. A killed process is reaped in the background.
+   */
+  @Override
+  public void destroy() {
+    synchronized (this) {
+      reap();
+      if (!exited) {
+        kill0(pid);
+      }
+    }
+    closeQuietly(stdin);
+    closeQuietly(stdout);
+    closeQuietly(stderr);
+  }
+
+  private static void closeQuietly(Closeable c) {
+    try {
+      c.close();
+    } catch (IOException e) {
+      LOG.debug("Error closing a process stream", e);
+    }
+  }
+
+  private native static void initIDs();
+  private native static int spawn(byte[] path, byte[][] argv, byte[][] envp,
+      byte[] dir, FileDescriptor[] fds) throws IOException;
+  private native static int reap0(int pid);
+  private native static int openExitFd0(int pid);
+  private native static void closeExitFd0(int fd);
+  private native static int[] waitExitFds0(int[] fds) throws IOException;
+  private native static void wakeReaper0();
+  private native static void waitExit0(int pid);
+  private native static void kill0(int pid);
+}
@@ -0,0 +1,217 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.nativeio;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.ClosedChannelException;
+import java.nio.channels.SocketChannel;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.util.NativeCodeLoader;
+
+/**
+ * Reads and writes on non-blocking sockets that wait for readiness with
+ * <code>poll(2)</code> in libhadoop.
+ *
+ * <p>Each operation first tries the I/O directly, which is all it takes when
+ * data or buffer space is available, and only polls the socket's descriptor
+ * when the I/O would block. That is one system call per operation in the
+ * common case, where waiting on a {@link java.nio.channels.Selector} costs a
+ * registration, a select, a cancellation and a second select to clear the
+ * cancelled key.</p>
+ *
+ * <p>A wait ends after at most the given timeout, and the methods then
+ * return {@link #TIMEOUT}. Callers that need to notice interrupts or a
+ * channel closed by another thread should wait in slices and check between
+ * them.</p>
+ *
+ * <p>A socket is named by its descriptor and by the id from
+ * {@link #getSocketId(int)}. Each operation works on a duplicate of the
+ * descriptor, and only if it still refers to that socket, so a close by
+ * another thread, even through {@link java.net.Socket#close()}, can neither
+ * free the descriptor's number for another file during the operation nor
+ * make it act on a file that has since taken the number; it fails with a
+ * {@link ClosedChannelException} instead. A socket closed during an
+ * operation stays open until the operation returns.</p>
+ */
+@InterfaceAudience.Private
+@InterfaceStability.Unstable
+public class NativeSocketIO {
+  private static final Log LOG = LogFactory.getLog(NativeSocketIO.class);
+
+  /** Returned when the socket did not become ready within the timeout. */
+  public static final int TIMEOUT = -2;
+
+  /** Wait for the socket to be readable. */
+  public static final int OP_READ = 1;
+  /** Wait for the socket to be writable. */
+  public static final int OP_WRITE = 4;
+
+  private static boolean nativeLoaded = false;
+
+  static {
+    if (NativeCodeLoader.isNativeCodeLoaded()) {
+      try {
+        initIDs();
+        nativeLoaded = true;
+      } catch (Throwable t) {
+        LOG.warn("Failed to initialize native socket I/O: " + t);
+      }
+    }
+  }
+
+  /** Do not allow to create a new instance */
+  private NativeSocketIO() {}
+
+  /**
+   * Check whether native socket I/O is available.
+   *
+   * @return <code>true</code> if libhadoop is loaded and initialized
+   */
+  public static boolean isNativeLoaded() {
+    return nativeLoaded;
+  }
+
+  /**
+   * Get the file descriptor of a socket channel.
+   *
+   * @return the descriptor, or -1 if native socket I/O is not available or
+   *         the channel's implementation does not expose it
+   */
+  public static int getFD(SocketChannel channel) {
+    if (!nativeLoaded || channel == null) {
+      return -1;
+    }
+    return getFD0(channel);
+  }
+
+  /**
+   * Get the id of the socket a descriptor refers to: its inode number,
+   * which no other open file shares.
+   *
+   * @return the id, or -1 if the descriptor is not an open socket
+   */
+  public static long getSocketId(int fd) {
+    if (!nativeLoaded || fd < 0) {
+      return -1;
+    }
+    return getSocketId0(fd);
+  }
+
+  /**
+   * Read into the remaining space of <code>buf</code>, waiting up to
+   * <code>timeout</code> milliseconds for data. The buffer's position is
+   * advanced past the bytes read.
+   *
+   * @param socketId the id of the socket fd refers to
+   * @param timeout the longest wait in milliseconds; must be positive
+   * @return the number of bytes read, -1 at end of stream, or
+   *         {@link #TIMEOUT}
+   * @throws ClosedChannelException if fd no longer refers to the socket
+   */
+  public static int read(int fd, long socketId, ByteBuffer buf, int timeout)
+      throws IOException {
+    int pos = buf.position();
+    int n;
+    if (buf.isDirect()) {
+      n = readDirect(fd, socketId, buf, pos, buf.remaining(), timeout);
+    } else {
+      n = readArray(fd, socketId, buf.array(), buf.arrayOffset() + pos,
+                    buf.remaining(), timeout);
+    }
+    checkClosed(n);
+    if (n > 0) {
+      buf.position(pos + n);
+    }
+    return n;
+  }
+
+  /**
+   * Write the remaining bytes of <code>buf</code>, waiting up to
+   * <code>timeout</code> milliseconds for buffer space. The buffer's
+   * position is advanced past the bytes written.
+   *
+   * @param socketId the id of the socket fd refers to
+   * @param timeout the longest wait in milliseconds; must be positive
+   * @return the number of bytes written, or {@link #TIMEOUT}
+   * @throws ClosedChannelException if fd no longer refers to the socket
+   */
+  public static int write(int fd, long socketId, ByteBuffer buf, int timeout)
+      throws IOException {
+    int pos = buf.position();
+    int n;
+    if (buf.isDirect()) {
+      n = writeDirect(fd, socketId, buf, pos, buf.remaining(), timeout);
+    } else {
+      n = writeArray(fd, socketId, buf.array(), buf.arrayOffset() + pos,
+                     buf.remaining(), timeout);
+    }
+    checkClosed(n);
+    if (n > 0) {
+      buf.position(pos + n);
+    }
+    return n;
+  }
+
+  /**
+   * Wait up to <code>timeout</code> milliseconds for the socket to be ready.
+   *
+   * @param socketId the id of the socket fd refers to
+   * @param ops {@link #OP_READ} or {@link #OP_WRITE}
+   * @return <code>true</code> if the socket is ready, <code>false</code> if
+   *         the timeout expired
+   * @throws ClosedChannelException if fd no longer refers to the socket
+   */
+  public static boolean poll(int fd, long socketId, int ops, int timeout)
+      throws IOException {
+    int ready = poll0(fd, socketId, ops, timeout);
+    checkClosed(ready);
+    return ready > 0;
+  }
+
+  /* the result of a native operation on a closed socket */
+  private static final int CLOSED = -3;
+
+  private static void checkClosed(int result) throws ClosedChannelException {
+    if (result == CLOSED) {
+      throw new ClosedChannelException();
+    }
+  }
+
+  private native static void initIDs();
+  private native static int getFD0(SocketChannel channel);
+  private native static long getSocketId0(int fd);
+  private native static int readDirect(int fd, long id, ByteBuffer buf,
+                                       int off, int len, int timeout)
+    throws IOException;
+  private native static int readArray(int fd, long id, byte[] b, int off,
+                                      int len, int timeout)
+    throws IOException;
+  private native static int writeDirect(int fd, long id, ByteBuffer buf,
+                                        int off, int len, int timeout)
+    throws IOException;
+  private native static int writeArray(int fd, long id, byte[] b, int off,
+                                       int len, int timeout)
+    throws IOException;
+  private native static int poll0(int fd, long id, int ops, int timeout)
+    throws IOException;
+}
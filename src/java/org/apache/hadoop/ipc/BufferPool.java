@@ -0,0 +1,170 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.ipc;
+
+import java.nio.ByteBuffer;
+import java.util.ArrayDeque;
+import java.util.concurrent.atomic.AtomicLong;
+
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+
+/**
+ * A pool of byte buffers, used by {@link Server} for the buffers that
+ * requests are read into and responses serialized into.
+ *
+ * <p>Buffers are kept in free lists by size class, powers of two from
+ * {@link #MIN_BUFFER_SIZE} up to the largest pooled size. {@link #get(int)}
+ * takes a buffer of the smallest class that fits, and
+ * {@link #release(ByteBuffer)} gives it back as long as the free lists hold
+ * no more than the capacity of the pool. Larger buffers are allocated on
+ * the heap, to their exact size, and left to the garbage collector.</p>
+ *
+ * <p>A released buffer must not be used again, and only buffers from
+ * {@link #get(int)} may be released.</p>
+ */
+@InterfaceAudience.Private
+@InterfaceStability.Unstable
+public class BufferPool {
+  /** The smallest size class. */
+  public static final int MIN_BUFFER_SIZE = 64;
+  private static final int MIN_SHIFT =
+    Integer.numberOfTrailingZeros(MIN_BUFFER_SIZE);
+
+  private final boolean direct;
+  private final int maxBufferSize;
+  private final long capacity;
+  private final ArrayDeque<ByteBuffer>[] free;
+  private final AtomicLong cachedBytes = new AtomicLong();
+  private final AtomicLong hits = new AtomicLong();
+  private final AtomicLong misses = new AtomicLong();
+
+  /**
+   * @param maxBufferSize the largest buffer to pool, rounded up to a power
+   *        of two
+   * @param capacity the most memory, in bytes, to keep in the free lists
+   * @param direct whether pooled buffers are direct buffers
+   */
+  @SuppressWarnings("unchecked")
+  public BufferPool(int maxBufferSize, long capacity, boolean direct) {
+    if (maxBufferSize < MIN_BUFFER_SIZE || maxBufferSize > (1 << 30)) {
+      throw new IllegalArgumentException("maxBufferSize: " + maxBufferSize);
+    }
+    if (capacity < 0) {
+      throw new IllegalArgumentException("capacity: " + capacity);
+    }
+    this.direct = direct;
+    this.capacity = capacity;
+    int numClasses = sizeClass(maxBufferSize) + 1;
+    this.maxBufferSize = MIN_BUFFER_SIZE << (numClasses - 1);
+    free = new ArrayDeque[numClasses];
+    for (int i = 0; i < numClasses; i++) {
+      free[i] = new ArrayDeque<ByteBuffer>();
+    }
+  }
+
+  /** The index of the smallest size class that holds size bytes. */
+  private static int sizeClass(int size) {
+    if (size <= MIN_BUFFER_SIZE) {
+      return 0;
+    }
+    return 32 - Integer.numberOfLeadingZeros(size - 1) - MIN_SHIFT;
+  }
+
+  /**
+   * Get a buffer with room for size bytes. Its position is zero, its limit
+   * is size, and its contents are undefined.
+   */
+  public ByteBuffer get(int size) {
+    if (size < 0) {
+      throw new IllegalArgumentException("size: " + size);
+    }
+    if (size > maxBufferSize) {
+      misses.incrementAndGet();
+      return ByteBuffer.allocate(size);
+    }
+    int sizeClass = sizeClass(size);
+    ByteBuffer buf;
+    ArrayDeque<ByteBuffer> list = free[sizeClass];
+    synchronized (list) {
+      buf = list.pollFirst();
+    }
+    if (buf != null) {
+      cachedBytes.addAndGet(-buf.capacity());
+      hits.incrementAndGet();
+      buf.clear();
+    } else {
+      misses.incrementAndGet();
+      int bufferSize = MIN_BUFFER_SIZE << sizeClass;
+      buf = direct ? ByteBuffer.allocateDirect(bufferSize)
+                   : ByteBuffer.allocate(bufferSize);
+    }
+    buf.limit(size);
+    return buf;
+  }
+
+  /**
+   * Return a buffer from {@link #get(int)} to the pool.
+   *
+   * @param buf the buffer, or <code>null</code>
+   */
+  public void release(ByteBuffer buf) {
+    if (buf == null || buf.isDirect() != direct) {
+      return;
+    }
+    int size = buf.capacity();
+    if (size > maxBufferSize || size < MIN_BUFFER_SIZE ||
+        Integer.bitCount(size) != 1) {
+      return;                             // not pooled
+    }
+    if (cachedBytes.addAndGet(size) > capacity) {
+      cachedBytes.addAndGet(-size);
+      return;
+    }
+    ArrayDeque<ByteBuffer> list = free[sizeClass(size)];
+    synchronized (list) {
+      list.addFirst(buf);
+    }
+  }
+
+  /** Whether pooled buffers are direct buffers. */
+  public boolean isDirect() {
+    return direct;
+  }
+
+  /** The largest buffer that is pooled. */
+  public int getMaxBufferSize() {
+    return maxBufferSize;
+  }
+
+  /** The memory, in bytes, in the free lists. */
+  public long getCachedBytes() {
+    return cachedBytes.get();
+  }
+
+  /** The number of buffers taken from the free lists. */
+  public long getHits() {
+    return hits.get();
+  }
+
+  /** The number of buffers allocated because none was free. */
+  public long getMisses() {
+    return misses.get();
+  }
+}
@@ -37,6 +37,11 @@ import java.security.PrivilegedExceptionAction;
 import java.util.Hashtable;
 import java.util.Iterator;
 import java.util.Map.Entry;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
 import java.util.concurrent.atomic.AtomicBoolean;
 import java.util.concurrent.atomic.AtomicLong;
 
@@ -220,6 +225,9 @@ public class Client {
     
     // currently active calls
     private Hashtable<Integer, Call> calls = new Hashtable<Integer, Call>();
+    // serialized requests waiting for a thread to write them
+    private final ConcurrentLinkedQueue<DataOutputBuffer> pendingWrites =
+      new ConcurrentLinkedQueue<DataOutputBuffer>();
     private AtomicLong lastActivity = new AtomicLong();// last I/O activity time
     private AtomicBoolean shouldCloseConnection = new AtomicBoolean();  // indicate if the connection is closed
     private IOException closeException; // close reason
@@ -625,29 +633,45 @@ public class Client {
         return;
       }
 
-      DataOutputBuffer d=null;
+      if (LOG.isDebugEnabled())
+        LOG.debug(getName() + " sending #" + call.id);
+
+      // serialize outside the lock, leaving room for the length prefix
+      DataOutputBuffer d = new DataOutputBuffer();
+      try {
+        d.writeInt(0);
+        d.writeInt(call.id);
+        call.param.write(d);
+      } catch (IOException e) {
+        markClosed(e);
+        return;
+      }
+      byte[] data = d.getData();
+      int dataLength = d.getLength() - 4;
+      data[0] = (byte)(dataLength >>> 24);
+      data[1] = (byte)(dataLength >>> 16);
+      data[2] = (byte)(dataLength >>> 8);
+      data[3] = (byte)dataLength;
+      pendingWrites.add(d);
+
+      // Whoever holds the lock writes every request queued so far and
+      // flushes once, so concurrent callers share a single socket write.
+      // If our request was written by another thread while we waited, it
+      // has also been flushed and there is nothing left to do.
       try {
         synchronized (this.out) {
-          if (LOG.isDebugEnabled())
-            LOG.debug(getName() + " sending #" + call.id);
-          
-          //for serializing the
-          //data to be written
-          d = new DataOutputBuffer();
-          d.writeInt(call.id);
-          call.param.write(d);
-          byte[] data = d.getData();
-          int dataLength = d.getLength();
-          out.writeInt(dataLength);      //first put the data length
-          out.write(data, 0, dataLength);//write the data
-          out.flush();
+          int batch = 0;
+          DataOutputBuffer next;
+          while ((next = pendingWrites.poll()) != null) {
+            out.write(next.getData(), 0, next.getLength());
+            batch++;
+          }
+          if (batch > 0) {
+            out.flush();
+          }
         }
       } catch(IOException e) {
         markClosed(e);
-      } finally {
-        //the buffer is just an in-memory buffer, but it is still polite to
-        // close early
-        IOUtils.closeStream(d);
       }
     }  
 
@@ -787,6 +811,98 @@ public class Client {
     }
   }
 
+  /**
+   * Receives the outcome of a call made with
+   * {@link Client#call(Writable, InetSocketAddress, Class, UserGroupInformation, Callback)}.
+   * Methods are invoked by the thread that reads responses for the
+   * connection, so they must return quickly and must not make further
+   * synchronous calls to the same server.
+   */
+  public static interface Callback {
+    /** The call returned <code>value</code>. */
+    void callComplete(Writable value);
+
+    /**
+     * The call failed, either remotely with a {@link RemoteException} or
+     * locally with the network error.
+     */
+    void callFailed(IOException error);
+  }
+
+  /** Call implementation used for asynchronous calls. */
+  private class AsyncCall extends Call implements Future<Writable> {
+    private final InetSocketAddress addr;
+    private final Callback callback;
+
+    public AsyncCall(Writable param, InetSocketAddress addr,
+                     Callback callback) {
+      super(param);
+      this.addr = addr;
+      this.callback = callback;
+    }
+
+    /** Wake up waiters and deliver the outcome to the callback. */
+    protected synchronized void callComplete() {
+      if (error != null && !(error instanceof RemoteException)) {
+        error = wrapException(addr, error);
+      }
+      this.done = true;
+      notifyAll();
+      if (callback != null) {
+        try {
+          if (error != null) {
+            callback.callFailed(error);
+          } else {
+            callback.callComplete(value);
+          }
+        } catch (Throwable t) {
+          LOG.warn("Callback for call #" + id + " threw", t);
+        }
+      }
+    }
+
+    /** Calls cannot be cancelled once sent; always returns false. */
+    public boolean cancel(boolean mayInterruptIfRunning) {
+      return false;
+    }
+
+    public boolean isCancelled() {
+      return false;
+    }
+
+    public synchronized boolean isDone() {
+      return done;
+    }
+
+    public synchronized Writable get()
+        throws InterruptedException, ExecutionException {
+      while (!done) {
+        wait();
+      }
+      return result();
+    }
+
+    public synchronized Writable get(long timeout, TimeUnit unit)
+        throws InterruptedException, ExecutionException, TimeoutException {
+      long deadline = System.nanoTime() + unit.toNanos(timeout);
+      while (!done) {
+        long remaining = deadline - System.nanoTime();
+        if (remaining <= 0) {
+          throw new TimeoutException("Call #" + id + " to " + addr);
+        }
+        TimeUnit.NANOSECONDS.timedWait(this, remaining);
+      }
+      return result();
+    }
+
+    private Writable result() throws ExecutionException {
+      if (error != null) {
+        throw new ExecutionException(error);
+      }
+      return value;
+    }
+  }
+
   /** Construct an IPC client whose values are of the given {@link Writable}
    * class. */
   public Client(Class<? extends Writable> valueClass, Configuration conf, 
@@ -914,6 +1030,32 @@ public class Client {
     }
   }
 
+  /**
+   * Start a call, passing <code>param</code>, to the IPC server running at
+   * <code>address</code> which is servicing the <code>protocol</code>
+   * protocol, with the <code>ticket</code> credentials, without waiting for
+   * the value. This returns once the request is written, so a single thread
+   * may keep many calls in flight on one connection; requests sent
+   * concurrently are coalesced into a single write.
+   *
+   * <p>The returned future yields the value, or throws an
+   * {@link ExecutionException} whose cause is the {@link RemoteException} or
+   * the local network error. It cannot be cancelled.</p>
+   *
+   * @param callback notified when the call completes; may be
+   *        <code>null</code>
+   * @throws IOException if no connection to the server could be set up
+   */
+  public Future<Writable> call(Writable param, InetSocketAddress addr,
+                               Class<?> protocol, UserGroupInformation ticket,
+                               Callback callback)
+                               throws InterruptedException, IOException {
+    AsyncCall call = new AsyncCall(param, addr, callback);
+    Connection connection = getConnection(addr, protocol, ticket, call);
+    connection.sendParam(call);
+    return call;
+  }
+
   /**
    * Take an IOException and the address we were trying to connect to
    * and return an IOException with the input exception as the cause.
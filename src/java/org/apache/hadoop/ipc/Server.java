@@ -23,6 +23,8 @@ import java.io.ByteArrayOutputStream;
 import java.io.DataInputStream;
 import java.io.DataOutputStream;
 import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
 import java.net.BindException;
 import java.net.InetAddress;
 import java.net.InetSocketAddress;
@@ -32,8 +34,8 @@ import java.net.SocketException;
 import java.net.UnknownHostException;
 import java.nio.ByteBuffer;
 import java.nio.channels.CancelledKeyException;
-import java.nio.channels.Channels;
 import java.nio.channels.ClosedChannelException;
+import java.nio.channels.GatheringByteChannel;
 import java.nio.channels.ReadableByteChannel;
 import java.nio.channels.SelectionKey;
 import java.nio.channels.Selector;
@@ -110,6 +112,12 @@ public abstract class Server {
    */
   static int INITIAL_RESP_BUF_SIZE = 10240;
 
+  /**
+   * Largest array a connection keeps for SASL tokens read into direct
+   * buffers
+   */
+  private static final int MAX_SASL_TOKEN_BUFFER = 64 * 1024;
+
   public static final Log LOG = LogFactory.getLog(Server.class);
   public static final Log auditLOG = 
     LogFactory.getLog("SecurityLogger."+Server.class.getName());
@@ -185,12 +193,15 @@ public abstract class Server {
 
   private int maxQueueSize;
   private final int maxRespSize;
+  private final long traceSlowCallNanos;      // negative when not tracing
   private int socketSendBufferSize;
   private final boolean tcpNoDelay; // if T then disable Nagle's Algorithm
 
   volatile private boolean running = true;         // true while server runs
   private BlockingQueue<Call> callQueue; // queued calls
 
+  private final BufferPool bufferPool;   // request and response buffers
+
   private List<Connection> connectionList = 
     Collections.synchronizedList(new LinkedList<Connection>());
   //maintain a list
@@ -236,6 +247,11 @@ public abstract class Server {
     return rpcMetrics;
   }
 
+  /** Returns the pool of request and response buffers. */
+  public BufferPool getBufferPool() {
+    return bufferPool;
+  }
+
   /** A call queued for handling. */
   private static class Call {
     private int id;                               // the client's call id
@@ -243,7 +259,13 @@ public abstract class Server {
     private Connection connection;                // connection to client
     private long timestamp;     // the time received when response is null
                                    // the time served when response is not null
-    private ByteBuffer response;                      // the response for this call
+    private ByteBuffer[] response;    // the response for this call, gathered
+    private ByteBuffer pooledResponse; // the pooled buffer of the response
+    // System.nanoTime() as the call moves through the server
+    private long readNanos;            // the request started to arrive
+    private long queuedNanos;          // queued for a handler
+    private long startNanos;           // taken by a handler
+    private long respondNanos;         // response handed to the responder
 
     public Call(int id, Writable param, Connection connection) { 
       this.id = id;
@@ -258,8 +280,47 @@ public abstract class Server {
       return param.toString() + " from " + connection.toString();
     }
 
-    public void setResponse(ByteBuffer response) {
+    public void setResponse(ByteBuffer... response) {
       this.response = response;
+      this.pooledResponse = null;
+    }
+
+    /** Set a response in a buffer to release once it is sent. */
+    public void setPooledResponse(ByteBuffer response) {
+      this.response = new ByteBuffer[] {response};
+      this.pooledResponse = response;
+    }
+
+    private boolean responseSent() {
+      return !response[response.length - 1].hasRemaining();
+    }
+
+    /** The microseconds spent in each stage, up to <code>sentNanos</code>. */
+    private String traceString(long sentNanos) {
+      return "#" + id + " from " + connection + ": total "
+        + (sentNanos - readNanos) / 1000 + "us read "
+        + (queuedNanos - readNanos) / 1000 + "us queued "
+        + (startNanos - queuedNanos) / 1000 + "us handler "
+        + (respondNanos - startNanos) / 1000 + "us respond "
+        + (sentNanos - respondNanos) / 1000 + "us";
+    }
+  }
+
+  /**
+   * Count the time a call spent in each stage once its response has been
+   * sent, and log it if the call was slow.
+   */
+  private void traceCall(Call call) {
+    if (call.queuedNanos == 0) {
+      return;                 // a SASL or authorization reply, not a call
+    }
+    long now = System.nanoTime();
+    rpcMetrics.rpcReadTime.inc((call.queuedNanos - call.readNanos) / 1000);
+    rpcMetrics.rpcHandlerTime.inc((call.respondNanos - call.startNanos) / 1000);
+    rpcMetrics.rpcResponseTime.inc((now - call.respondNanos) / 1000);
+    rpcMetrics.rpcTotalTime.inc((now - call.readNanos) / 1000);
+    if (traceSlowCallNanos >= 0 && now - call.readNanos > traceSlowCallNanos) {
+      LOG.info("Slow call " + call.traceString(now));
     }
   }
 
@@ -725,12 +786,15 @@ public abstract class Server {
           //
           // Send as much data as we can in the non-blocking fashion
           //
-          int numBytes = channelWrite(channel, call.response);
+          long numBytes = channelWrite(channel, call.response);
           if (numBytes < 0) {
             return true;
           }
-          if (!call.response.hasRemaining()) {
+          if (call.responseSent()) {
+            traceCall(call);
             call.connection.decRpcCount();
+            bufferPool.release(call.pooledResponse);
+            call.pooledResponse = null;
             if (numElements == 1) {    // last call fully processes.
               done = true;             // no more data for this channel.
             } else {
@@ -823,6 +887,7 @@ public abstract class Server {
     private volatile int rpcCount = 0; // number of outstanding rpcs
     private long lastContact;
     private int dataLength;
+    private long dataStartNanos;      // when the current request began
     private Socket socket;
     // Cache the remote host & port info so that even if the socket is 
     // disconnected, we can say where it used to connect to.
@@ -839,6 +904,7 @@ public abstract class Server {
     private ByteBuffer rpcHeaderBuffer;
     private ByteBuffer unwrappedData;
     private ByteBuffer unwrappedDataLengthBuffer;
+    private byte[] saslTokenBuffer;       // wrapped tokens of direct buffers
     
     UserGroupInformation user = null;
     public UserGroupInformation attemptingUser = null; // user name before auth
@@ -847,7 +913,6 @@ public abstract class Server {
     private static final int AUTHROIZATION_FAILED_CALLID = -1;
     private final Call authFailedCall = 
       new Call(AUTHROIZATION_FAILED_CALLID, null, this);
-    private ByteArrayOutputStream authFailedResponse = new ByteArrayOutputStream();
     // Fake 'call' for SASL context setup
     private static final int SASL_CALLID = -33;
     private final Call saslCall = new Call(SASL_CALLID, null, this);
@@ -929,9 +994,10 @@ public abstract class Server {
       }
     }
 
-    private void saslReadAndProcess(byte[] saslToken) throws IOException,
+    private void saslReadAndProcess(ByteBuffer data) throws IOException,
         InterruptedException {
       if (!saslContextEstablished) {
+        byte[] saslToken = toBytes(data);
         byte[] replyToken = null;
         try {
           if (saslServer == null) {
@@ -1017,11 +1083,27 @@ public abstract class Server {
           saslContextEstablished = true;
         }
       } else {
+        int length = data.remaining();
         if (LOG.isDebugEnabled())
-          LOG.debug("Have read input token of size " + saslToken.length
+          LOG.debug("Have read input token of size " + length
               + " for processing by saslServer.unwrap()");
-        byte[] plaintextData = saslServer
-            .unwrap(saslToken, 0, saslToken.length);
+        byte[] plaintextData;
+        if (data.hasArray()) {
+          plaintextData = saslServer.unwrap(data.array(),
+              data.arrayOffset() + data.position(), length);
+        } else {
+          // SaslServer only unwraps arrays; copy into one kept for the
+          // connection rather than a new one per token
+          byte[] token = saslTokenBuffer;
+          if (token == null || token.length < length) {
+            token = new byte[length];
+            if (length <= MAX_SASL_TOKEN_BUFFER) {
+              saslTokenBuffer = token;
+            }
+          }
+          data.duplicate().get(token, 0, length);
+          plaintextData = saslServer.unwrap(token, 0, length);
+        }
         processUnwrappedData(plaintextData);
       }
     }
@@ -1081,8 +1163,8 @@ public abstract class Server {
           if (isSecurityEnabled && authMethod == AuthMethod.SIMPLE) {
             AccessControlException ae = new AccessControlException(
                 "Authentication is required");
-            setupResponse(authFailedResponse, authFailedCall, Status.FATAL,
-                null, ae.getClass().getName(), ae.getMessage());
+            setupResponse(new BufferOutputStream(), authFailedCall,
+                Status.FATAL, null, ae.getClass().getName(), ae.getMessage());
             responder.doRespond(authFailedCall);
             throw ae;
           }
@@ -1122,7 +1204,8 @@ public abstract class Server {
             dataLengthBuffer.clear();
             return 0;  //ping message
           }
-          data = ByteBuffer.allocate(dataLength);
+          data = bufferPool.get(dataLength);
+          dataStartNanos = System.nanoTime();
         }
         
         count = channelRead(channel, data);
@@ -1131,17 +1214,24 @@ public abstract class Server {
           dataLengthBuffer.clear();
           data.flip();
           if (skipInitialSaslHandshake) {
+            bufferPool.release(data);
             data = null;
             skipInitialSaslHandshake = false;
             continue;
           }
           boolean isHeaderRead = headerRead;
-          if (useSasl) {
-            saslReadAndProcess(data.array());
-          } else {
-            processOneRpc(data.array());
+          // The call's parameter is read from the buffer before it is
+          // queued, so the buffer can go back to the pool right away.
+          try {
+            if (useSasl) {
+              saslReadAndProcess(data);
+            } else {
+              processOneRpc(data);
+            }
+          } finally {
+            bufferPool.release(data);
+            data = null;
           }
-          data = null;
           if (!isHeaderRead) {
             continue;
           }
@@ -1151,9 +1241,8 @@ public abstract class Server {
     }
 
     /// Reads the connection header following version
-    private void processHeader(byte[] buf) throws IOException {
-      DataInputStream in =
-        new DataInputStream(new ByteArrayInputStream(buf));
+    private void processHeader(ByteBuffer buf) throws IOException {
+      DataInputStream in = new DataInputStream(new BufferInputStream(buf));
       header.readFields(in);
       try {
         String protocolClassName = header.getProtocol();
@@ -1199,14 +1288,12 @@ public abstract class Server {
     
     private void processUnwrappedData(byte[] inBuf) throws IOException,
         InterruptedException {
-      ReadableByteChannel ch = Channels.newChannel(new ByteArrayInputStream(
-          inBuf));
+      ByteBuffer in = ByteBuffer.wrap(inBuf);
       // Read all RPCs contained in the inBuf, even partial ones
       while (true) {
-        int count = -1;
         if (unwrappedDataLengthBuffer.remaining() > 0) {
-          count = channelRead(ch, unwrappedDataLengthBuffer);
-          if (count <= 0 || unwrappedDataLengthBuffer.remaining() > 0)
+          transfer(in, unwrappedDataLengthBuffer);
+          if (unwrappedDataLengthBuffer.remaining() > 0)
             return;
         }
 
@@ -1220,23 +1307,37 @@ public abstract class Server {
             unwrappedDataLengthBuffer.clear();
             continue; // ping message
           }
-          unwrappedData = ByteBuffer.allocate(unwrappedDataLength);
+          if (unwrappedDataLength >= 0
+              && unwrappedDataLength <= in.remaining()) {
+            // the whole RPC is in this token: process it where it is
+            ByteBuffer rpc = in.slice();
+            rpc.limit(unwrappedDataLength);
+            in.position(in.position() + unwrappedDataLength);
+            unwrappedDataLengthBuffer.clear();
+            processOneRpc(rpc);
+            continue;
+          }
+          unwrappedData = bufferPool.get(unwrappedDataLength);
         }
 
-        count = channelRead(ch, unwrappedData);
-        if (count <= 0 || unwrappedData.remaining() > 0)
+        transfer(in, unwrappedData);
+        if (unwrappedData.remaining() > 0)
           return;
 
         if (unwrappedData.remaining() == 0) {
           unwrappedDataLengthBuffer.clear();
           unwrappedData.flip();
-          processOneRpc(unwrappedData.array());
-          unwrappedData = null;
+          try {
+            processOneRpc(unwrappedData);
+          } finally {
+            bufferPool.release(unwrappedData);
+            unwrappedData = null;
+          }
         }
       }
     }
     
-    private void processOneRpc(byte[] buf) throws IOException,
+    private void processOneRpc(ByteBuffer buf) throws IOException,
         InterruptedException {
       if (headerRead) {
         processData(buf);
@@ -1251,9 +1352,8 @@ public abstract class Server {
       }
     }
     
-    private void processData(byte[] buf) throws  IOException, InterruptedException {
-      DataInputStream dis =
-        new DataInputStream(new ByteArrayInputStream(buf));
+    private void processData(ByteBuffer buf) throws  IOException, InterruptedException {
+      DataInputStream dis = new DataInputStream(new BufferInputStream(buf));
       int id = dis.readInt();                    // try to read an id
         
       if (LOG.isDebugEnabled())
@@ -1263,6 +1363,8 @@ public abstract class Server {
       param.readFields(dis);        
         
       Call call = new Call(id, param, this);
+      call.readNanos = dataStartNanos;
+      call.queuedNanos = System.nanoTime();
       callQueue.put(call);              // queue the call; maybe blocked here
       incRpcCount();  // Increment the rpc count
     }
@@ -1284,8 +1386,8 @@ public abstract class Server {
         rpcMetrics.authorizationSuccesses.inc();
       } catch (AuthorizationException ae) {
         rpcMetrics.authorizationFailures.inc();
-        setupResponse(authFailedResponse, authFailedCall, Status.FATAL, null,
-            ae.getClass().getName(), ae.getMessage());
+        setupResponse(new BufferOutputStream(), authFailedCall, Status.FATAL,
+            null, ae.getClass().getName(), ae.getMessage());
         responder.doRespond(authFailedCall);
         return false;
       }
@@ -1319,11 +1421,13 @@ public abstract class Server {
     public void run() {
       LOG.info(getName() + ": starting");
       SERVER.set(Server.this);
-      ByteArrayOutputStream buf = 
-        new ByteArrayOutputStream(INITIAL_RESP_BUF_SIZE);
+      BufferOutputStream buf = new BufferOutputStream();
       while (running) {
         try {
           final Call call = callQueue.take(); // pop the queue; maybe blocked here
+          call.startNanos = System.nanoTime();
+          rpcMetrics.rpcQueueWaitTime.inc(
+              (call.startNanos - call.queuedNanos) / 1000);
 
           if (LOG.isDebugEnabled())
             LOG.debug(getName() + ": has #" + call.id + " from " +
@@ -1370,16 +1474,15 @@ public abstract class Server {
             // responder.doResponse() since setupResponse may use
             // SASL to encrypt response data and SASL enforces
             // its own message ordering.
-            setupResponse(buf, call, (error == null) ? Status.SUCCESS
-                : Status.ERROR, value, errorClass, error);
+            int size = setupResponse(buf, call, (error == null) ?
+                Status.SUCCESS : Status.ERROR, value, errorClass, error);
             
-            // Discard the large buf and reset it back to smaller size 
-            // to free up heap
-            if (buf.size() > maxRespSize) {
-              LOG.warn("Large response size " + buf.size() + " for call "
+            // Responses beyond the pool's largest buffer are not pooled
+            if (size > maxRespSize) {
+              LOG.warn("Large response size " + size + " for call "
                   + call.toString());
-              buf = new ByteArrayOutputStream(INITIAL_RESP_BUF_SIZE);
             }
+            call.respondNanos = System.nanoTime();
             responder.doRespond(call);
           }
         } catch (InterruptedException e) {
@@ -1429,7 +1532,11 @@ public abstract class Server {
     this.readThreads = conf.getInt(
         CommonConfigurationKeys.IPC_SERVER_RPC_READ_THREADS_KEY,
         CommonConfigurationKeys.IPC_SERVER_RPC_READ_THREADS_DEFAULT);
-    this.callQueue  = new LinkedBlockingQueue<Call>(maxQueueSize); 
+    long slowCallMs = conf.getLong(
+        CommonConfigurationKeys.IPC_SERVER_TRACE_SLOW_CALL_MS_KEY,
+        CommonConfigurationKeys.IPC_SERVER_TRACE_SLOW_CALL_MS_DEFAULT);
+    this.traceSlowCallNanos = slowCallMs < 0 ? -1 : slowCallMs * 1000000;
+    this.callQueue = createCallQueue(conf);
     this.maxIdleTime = 2*conf.getInt("ipc.client.connection.maxidletime", 1000);
     this.maxConnectionsToNuke = conf.getInt("ipc.client.kill.max", 10);
     this.thresholdIdleConnections = conf.getInt("ipc.client.idlethreshold", 4000);
@@ -1438,6 +1545,12 @@ public abstract class Server {
       conf.getBoolean(CommonConfigurationKeys.HADOOP_SECURITY_AUTHORIZATION, 
                       false);
     this.isSecurityEnabled = UserGroupInformation.isSecurityEnabled();
+    this.bufferPool = new BufferPool(
+        Math.max(maxRespSize, BufferPool.MIN_BUFFER_SIZE),
+        conf.getLong(CommonConfigurationKeys.IPC_SERVER_BUFFER_POOL_CAPACITY_KEY,
+            CommonConfigurationKeys.IPC_SERVER_BUFFER_POOL_CAPACITY_DEFAULT),
+        conf.getBoolean(CommonConfigurationKeys.IPC_SERVER_BUFFER_POOL_DIRECT_KEY,
+            CommonConfigurationKeys.IPC_SERVER_BUFFER_POOL_DIRECT_DEFAULT));
     
     // Start the listener here and let it bind to the port
     listener = new Listener();
@@ -1453,6 +1566,31 @@ public abstract class Server {
     responder = new Responder();
   }
 
+  /**
+   * Create the call queue named by ipc.server.callqueue: a single
+   * {@link LinkedBlockingQueue}, or a {@link ShardedCallQueue} that many
+   * handlers contend less on.
+   */
+  private BlockingQueue<Call> createCallQueue(Configuration conf)
+      throws IOException {
+    String type = conf.get(CommonConfigurationKeys.IPC_SERVER_CALLQUEUE_KEY,
+        CommonConfigurationKeys.IPC_SERVER_CALLQUEUE_DEFAULT);
+    if ("fifo".equals(type)) {
+      return new LinkedBlockingQueue<Call>(maxQueueSize);
+    } else if ("sharded".equals(type)) {
+      int shards = conf.getInt(
+          CommonConfigurationKeys.IPC_SERVER_CALLQUEUE_SHARDS_KEY,
+          CommonConfigurationKeys.IPC_SERVER_CALLQUEUE_SHARDS_DEFAULT);
+      if (shards <= 0) {
+        // one per reader, or per 8 handlers if there are more of them
+        shards = Math.max(readThreads, (handlerCount + 7) / 8);
+      }
+      return new ShardedCallQueue<Call>(maxQueueSize, shards);
+    }
+    throw new IOException("Unknown " +
+        CommonConfigurationKeys.IPC_SERVER_CALLQUEUE_KEY + ": " + type);
+  }
+
   private void closeConnection(Connection connection) {
     synchronized (connectionList) {
       if (connectionList.remove(connection))
@@ -1467,19 +1605,20 @@ public abstract class Server {
   /**
    * Setup response for the IPC Call.
    * 
-   * @param response buffer to serialize the response into
+   * @param response stream to serialize the response with
    * @param call {@link Call} to which we are setting up the response
    * @param status {@link Status} of the IPC call
    * @param rv return value for the IPC Call, if the call was successful
    * @param errorClass error class, if the the call failed
    * @param error error message, if the call failed
+   * @return the size of the serialized response
    * @throws IOException
    */
-  private void setupResponse(ByteArrayOutputStream response, 
-                             Call call, Status status, 
-                             Writable rv, String errorClass, String error) 
+  private int setupResponse(BufferOutputStream response, 
+                            Call call, Status status, 
+                            Writable rv, String errorClass, String error) 
   throws IOException {
-    response.reset();
+    response.start(INITIAL_RESP_BUF_SIZE);
     DataOutputStream out = new DataOutputStream(response);
     out.writeInt(call.id);                // write call id
     out.writeInt(status.state);           // write status
@@ -1490,26 +1629,142 @@ public abstract class Server {
       WritableUtils.writeString(out, errorClass);
       WritableUtils.writeString(out, error);
     }
-    wrapWithSasl(response, call);
-    call.setResponse(ByteBuffer.wrap(response.toByteArray()));
+    ByteBuffer buf = response.finish();
+    int size = buf.remaining();
+    if (call.connection.useSasl) {
+      wrapWithSasl(buf, call);
+    } else {
+      call.setPooledResponse(buf);
+    }
+    return size;
   }
   
-  private void wrapWithSasl(ByteArrayOutputStream response, Call call)
+  private void wrapWithSasl(ByteBuffer response, Call call)
       throws IOException {
-    if (call.connection.useSasl) {
-      byte[] token = response.toByteArray();
-      // synchronization may be needed since there can be multiple Handler
-      // threads using saslServer to wrap responses.
-      synchronized (call.connection.saslServer) {
-        token = call.connection.saslServer.wrap(token, 0, token.length);
+    byte[] token;
+    // synchronization may be needed since there can be multiple Handler
+    // threads using saslServer to wrap responses.
+    synchronized (call.connection.saslServer) {
+      if (response.hasArray()) {
+        token = call.connection.saslServer.wrap(response.array(),
+            response.arrayOffset() + response.position(), response.remaining());
+      } else {
+        byte[] bytes = toBytes(response);
+        token = call.connection.saslServer.wrap(bytes, 0, bytes.length);
       }
-      if (LOG.isDebugEnabled())
-        LOG.debug("Adding saslServer wrapped token of size " + token.length
-            + " as call response.");
-      response.reset();
-      DataOutputStream saslOut = new DataOutputStream(response);
-      saslOut.writeInt(token.length);
-      saslOut.write(token, 0, token.length);
+    }
+    bufferPool.release(response);
+    if (LOG.isDebugEnabled())
+      LOG.debug("Adding saslServer wrapped token of size " + token.length
+          + " as call response.");
+    // the length and the token are sent with one gathering write
+    ByteBuffer length = ByteBuffer.allocate(4);
+    length.putInt(0, token.length);
+    call.setResponse(length, ByteBuffer.wrap(token));
+  }
+
+  /** Copy as many bytes as fit from a heap buffer to another buffer. */
+  private static void transfer(ByteBuffer src, ByteBuffer dst) {
+    int n = Math.min(src.remaining(), dst.remaining());
+    dst.put(src.array(), src.arrayOffset() + src.position(), n);
+    src.position(src.position() + n);
+  }
+
+  /** Copy the remaining bytes of a buffer to an array. */
+  private static byte[] toBytes(ByteBuffer buf) {
+    byte[] bytes = new byte[buf.remaining()];
+    buf.duplicate().get(bytes);
+    return bytes;
+  }
+
+  /** Reads the remaining bytes of a buffer. */
+  private static class BufferInputStream extends InputStream {
+    private final ByteBuffer buf;
+
+    BufferInputStream(ByteBuffer buf) {
+      this.buf = buf;
+    }
+
+    @Override
+    public int read() {
+      return buf.hasRemaining() ? (buf.get() & 0xff) : -1;
+    }
+
+    @Override
+    public int read(byte[] b, int off, int len) {
+      if (len == 0) {
+        return 0;
+      }
+      if (!buf.hasRemaining()) {
+        return -1;
+      }
+      len = Math.min(len, buf.remaining());
+      buf.get(b, off, len);
+      return len;
+    }
+
+    @Override
+    public long skip(long n) {
+      int skipped = (int) Math.min(Math.max(n, 0), buf.remaining());
+      buf.position(buf.position() + skipped);
+      return skipped;
+    }
+
+    @Override
+    public int available() {
+      return buf.remaining();
+    }
+  }
+
+  /**
+   * Writes into a buffer from the pool, moving to a larger one as needed.
+   * The buffer is handed off by {@link #finish()}.
+   */
+  private class BufferOutputStream extends OutputStream {
+    private ByteBuffer buf;
+
+    /** Start writing into a new buffer of the given size. */
+    void start(int size) {
+      bufferPool.release(buf);            // left by a failed response
+      buf = bufferPool.get(size);
+      buf.limit(buf.capacity());
+    }
+
+    /** The buffer written, ready to be read; the caller now owns it. */
+    ByteBuffer finish() {
+      ByteBuffer result = buf;
+      buf = null;
+      result.flip();
+      return result;
+    }
+
+    private void ensureRemaining(int len) {
+      if (buf.remaining() < len) {
+        int needed = buf.position() + len;
+        if (needed < 0) {
+          throw new IllegalArgumentException("Response too large");
+        }
+        ByteBuffer bigger = bufferPool.get(
+            Math.max(needed, (int) Math.min(2L * buf.capacity(),
+                                            Integer.MAX_VALUE)));
+        bigger.limit(bigger.capacity());
+        buf.flip();
+        bigger.put(buf);
+        bufferPool.release(buf);
+        buf = bigger;
+      }
+    }
+
+    @Override
+    public void write(int b) {
+      ensureRemaining(1);
+      buf.put((byte) b);
+    }
+
+    @Override
+    public void write(byte[] b, int off, int len) {
+      ensureRemaining(len);
+      buf.put(b, off, len);
     }
   }
   
@@ -1656,8 +1911,8 @@ public abstract class Server {
   private int channelWrite(WritableByteChannel channel, 
                            ByteBuffer buffer) throws IOException {
     
-    int count =  (buffer.remaining() <= NIO_BUFFER_LIMIT) ?
-                 channel.write(buffer) : channelIO(null, channel, buffer);
+    int count = (buffer.remaining() <= NIO_BUFFER_LIMIT || buffer.isDirect()) ?
+                channel.write(buffer) : channelIO(null, channel, buffer);
     if (count > 0) {
       rpcMetrics.sentBytes.inc(count);
     }
@@ -1665,6 +1920,48 @@ public abstract class Server {
   }
   
   
+  /**
+   * Write buffers with one gathering write if they are small or direct,
+   * or else one by one with {@link #channelWrite(WritableByteChannel,
+   * ByteBuffer)}.
+   *
+   * @return the number of bytes written, or -1 if none were and the
+   *         channel is closed
+   */
+  private long channelWrite(GatheringByteChannel channel,
+                            ByteBuffer[] buffers) throws IOException {
+    if (buffers.length == 1) {
+      return channelWrite(channel, buffers[0]);
+    }
+    long remaining = 0;
+    boolean direct = true;
+    for (ByteBuffer buffer : buffers) {
+      remaining += buffer.remaining();
+      direct &= buffer.isDirect();
+    }
+    if (remaining <= NIO_BUFFER_LIMIT || direct) {
+      long count = channel.write(buffers);
+      if (count > 0) {
+        rpcMetrics.sentBytes.inc(count);
+      }
+      return count;
+    }
+    long count = 0;
+    for (ByteBuffer buffer : buffers) {
+      if (buffer.hasRemaining()) {
+        int n = channelWrite(channel, buffer);
+        if (n < 0) {
+          return count > 0 ? count : n;
+        }
+        count += n;
+        if (buffer.hasRemaining()) {
+          break;
+        }
+      }
+    }
+    return count;
+  }
+
   /**
    * This is a wrapper around {@link ReadableByteChannel#read(ByteBuffer)}.
    * If the amount of data is large, it writes to channel in smaller chunks. 
@@ -1676,7 +1973,7 @@ public abstract class Server {
   private int channelRead(ReadableByteChannel channel, 
                           ByteBuffer buffer) throws IOException {
     
-    int count = (buffer.remaining() <= NIO_BUFFER_LIMIT) ?
+    int count = (buffer.remaining() <= NIO_BUFFER_LIMIT || buffer.isDirect()) ?
                 channel.read(buffer) : channelIO(channel, null, buffer);
     if (count > 0) {
       rpcMetrics.receivedBytes.inc(count);
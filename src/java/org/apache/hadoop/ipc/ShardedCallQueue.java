@@ -0,0 +1,243 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.ipc;
+
+import java.util.AbstractQueue;
+import java.util.Collection;
+import java.util.Iterator;
+import java.util.NoSuchElementException;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.Semaphore;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+
+/**
+ * A bounded blocking queue made of several lock-free shards, for the call
+ * queue of {@link Server} when many handlers would contend on the locks of
+ * a single {@link java.util.concurrent.LinkedBlockingQueue}.
+ *
+ * <p>Each thread has a home shard. Producers add to the shards in turn,
+ * starting from their own; consumers take from their own shard first and
+ * steal from the others when it is empty. Two semaphores count the free
+ * slots and the queued elements: they keep the bound of the queue, and
+ * block producers when it is full and consumers when it is empty. Neither
+ * takes a lock unless a thread has to wait.</p>
+ *
+ * <p>Elements are not kept in a single FIFO order across shards. The
+ * iterator is weakly consistent and does not support removal.</p>
+ */
+@InterfaceAudience.Private
+@InterfaceStability.Unstable
+public class ShardedCallQueue<E> extends AbstractQueue<E>
+    implements BlockingQueue<E> {
+  private final ConcurrentLinkedQueue<E>[] shards;
+  private final int capacity;
+  private final Semaphore space;       // free slots
+  private final Semaphore items;       // queued elements, claimable
+  private final AtomicInteger nextHome = new AtomicInteger();
+  private final ThreadLocal<int[]> cursor = new ThreadLocal<int[]>() {
+    @Override
+    protected int[] initialValue() {
+      // {home shard, next shard to add to}
+      int home = (nextHome.getAndIncrement() & Integer.MAX_VALUE)
+                 % shards.length;
+      return new int[] {home, home};
+    }
+  };
+
+  /**
+   * @param capacity the most elements the queue holds
+   * @param numShards the number of shards
+   */
+  @SuppressWarnings("unchecked")
+  public ShardedCallQueue(int capacity, int numShards) {
+    if (capacity <= 0) {
+      throw new IllegalArgumentException("capacity: " + capacity);
+    }
+    if (numShards <= 0) {
+      throw new IllegalArgumentException("numShards: " + numShards);
+    }
+    this.capacity = capacity;
+    shards = new ConcurrentLinkedQueue[numShards];
+    for (int i = 0; i < numShards; i++) {
+      shards[i] = new ConcurrentLinkedQueue<E>();
+    }
+    space = new Semaphore(capacity);
+    items = new Semaphore(0);
+  }
+
+  /** The number of shards. */
+  public int getNumShards() {
+    return shards.length;
+  }
+
+  /** Add an element after claiming a free slot. */
+  private void enqueue(E e) {
+    int[] c = cursor.get();
+    int shard = c[1];
+    c[1] = shard + 1 == shards.length ? 0 : shard + 1;
+    shards[shard].offer(e);
+    items.release();
+  }
+
+  /** Remove an element after claiming one. */
+  private E dequeue() {
+    int home = cursor.get()[0];
+    while (true) {
+      // A claimed element was added before its claim was released, but
+      // another consumer may take it from a shard this one scanned already.
+      for (int i = 0; i < shards.length; i++) {
+        int shard = home + i;
+        E e = shards[shard < shards.length ? shard : shard - shards.length]
+                .poll();
+        if (e != null) {
+          space.release();
+          return e;
+        }
+      }
+      Thread.yield();
+    }
+  }
+
+  private static void checkNotNull(Object e) {
+    if (e == null) {
+      throw new NullPointerException();
+    }
+  }
+
+  @Override
+  public boolean offer(E e) {
+    checkNotNull(e);
+    if (!space.tryAcquire()) {
+      return false;
+    }
+    enqueue(e);
+    return true;
+  }
+
+  @Override
+  public boolean offer(E e, long timeout, TimeUnit unit)
+      throws InterruptedException {
+    checkNotNull(e);
+    if (!space.tryAcquire(timeout, unit)) {
+      return false;
+    }
+    enqueue(e);
+    return true;
+  }
+
+  @Override
+  public void put(E e) throws InterruptedException {
+    checkNotNull(e);
+    space.acquire();
+    enqueue(e);
+  }
+
+  @Override
+  public E poll() {
+    return items.tryAcquire() ? dequeue() : null;
+  }
+
+  @Override
+  public E poll(long timeout, TimeUnit unit) throws InterruptedException {
+    return items.tryAcquire(timeout, unit) ? dequeue() : null;
+  }
+
+  @Override
+  public E take() throws InterruptedException {
+    items.acquire();
+    return dequeue();
+  }
+
+  @Override
+  public E peek() {
+    for (ConcurrentLinkedQueue<E> shard : shards) {
+      E e = shard.peek();
+      if (e != null) {
+        return e;
+      }
+    }
+    return null;
+  }
+
+  @Override
+  public int size() {
+    return items.availablePermits();
+  }
+
+  @Override
+  public int remainingCapacity() {
+    return space.availablePermits();
+  }
+
+  /** The most elements the queue holds. */
+  public int getCapacity() {
+    return capacity;
+  }
+
+  @Override
+  public int drainTo(Collection<? super E> c) {
+    return drainTo(c, Integer.MAX_VALUE);
+  }
+
+  @Override
+  public int drainTo(Collection<? super E> c, int maxElements) {
+    checkNotNull(c);
+    if (c == this) {
+      throw new IllegalArgumentException();
+    }
+    int n = 0;
+    E e;
+    while (n < maxElements && (e = poll()) != null) {
+      c.add(e);
+      n++;
+    }
+    return n;
+  }
+
+  @Override
+  public Iterator<E> iterator() {
+    return new Iterator<E>() {
+      private int shard = 0;
+      private Iterator<E> current = shards[0].iterator();
+
+      public boolean hasNext() {
+        while (!current.hasNext() && shard + 1 < shards.length) {
+          current = shards[++shard].iterator();
+        }
+        return current.hasNext();
+      }
+
+      public E next() {
+        if (!hasNext()) {
+          throw new NoSuchElementException();
+        }
+        return current.next();
+      }
+
+      public void remove() {
+        throw new UnsupportedOperationException();
+      }
+    };
+  }
+}
@@ -39,6 +39,7 @@ import org.apache.hadoop.security.authorize.ServiceAuthorizationManager;
 import org.apache.hadoop.security.token.SecretManager;
 import org.apache.hadoop.security.token.TokenIdentifier;
 import org.apache.hadoop.conf.*;
+import org.apache.hadoop.metrics.util.MetricsStripedTimeVaryingRate;
 import org.apache.hadoop.metrics.util.MetricsTimeVaryingRate;
 
 /** An RpcEngine implementation for Writable data. */
@@ -339,7 +340,9 @@ class WritableRpcEngine implements RpcEngine {
         method.setAccessible(true);
 
         long startTime = System.currentTimeMillis();
+        long startNanos = System.nanoTime();
         Object value = method.invoke(instance, call.getParameters());
+        long processingNanos = System.nanoTime() - startNanos;
         int processingTime = (int) (System.currentTimeMillis() - startTime);
         int qTime = (int) (startTime-receivedTime);
         if (LOG.isDebugEnabled()) {
@@ -354,7 +357,7 @@ class WritableRpcEngine implements RpcEngine {
          (MetricsTimeVaryingRate) rpcDetailedMetrics.registry.get(call.getMethodName());
       	if (m == null) {
       	  try {
-      	    m = new MetricsTimeVaryingRate(call.getMethodName(),
+      	    m = new MetricsStripedTimeVaryingRate(call.getMethodName(),
       	                                        rpcDetailedMetrics.registry);
       	  } catch (IllegalArgumentException iae) {
       	    // the metrics has been registered; re-fetch the handle
@@ -364,6 +367,8 @@ class WritableRpcEngine implements RpcEngine {
       	  }
       	}
         m.inc(processingTime);
+        rpcDetailedMetrics.addLatency(call.getMethodName(),
+                                      processingNanos / 1000);
 
         if (verbose) log("Return: "+value);
 
@@ -17,6 +17,8 @@
  */
 package org.apache.hadoop.ipc.metrics;
 
+import java.util.concurrent.ConcurrentHashMap;
+
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
 import org.apache.hadoop.classification.InterfaceAudience;
@@ -25,7 +27,9 @@ import org.apache.hadoop.metrics.MetricsRecord;
 import org.apache.hadoop.metrics.MetricsUtil;
 import org.apache.hadoop.metrics.Updater;
 import org.apache.hadoop.metrics.util.MetricsBase;
+import org.apache.hadoop.metrics.util.MetricsHistogram;
 import org.apache.hadoop.metrics.util.MetricsRegistry;
+import org.apache.hadoop.metrics.util.MetricsStripedTimeVaryingRate;
 import org.apache.hadoop.metrics.util.MetricsTimeVaryingRate;
 
 /**
@@ -46,7 +50,10 @@ public class RpcDetailedMetrics implements Updater {
    * which other dynamically added metrics are not exposed over JMX.
    */
   final MetricsTimeVaryingRate getProtocolVersion = 
-    new MetricsTimeVaryingRate("getProtocolVersion", registry);
+    new MetricsStripedTimeVaryingRate("getProtocolVersion", registry);
+
+  private final ConcurrentHashMap<String, MetricsHistogram> latencies =
+    new ConcurrentHashMap<String, MetricsHistogram>();
   
   public RpcDetailedMetrics(final String hostName, final String port) {
     MetricsContext context = MetricsUtil.getContext("rpc");
@@ -64,6 +71,24 @@ public class RpcDetailedMetrics implements Updater {
   }
   
   
+  /**
+   * Count the processing time of a call to <code>method</code>, in
+   * microseconds, in the method's histogram, <i>method</i>Latency.
+   */
+  public void addLatency(String method, long micros) {
+    MetricsHistogram h = latencies.get(method);
+    if (h == null) {
+      synchronized (latencies) {
+        h = latencies.get(method);
+        if (h == null) {
+          h = new MetricsHistogram(method + "Latency", registry);
+          latencies.put(method, h);
+        }
+      }
+    }
+    h.inc(micros);
+  }
+
   /**
    * Push the metrics to the monitoring subsystem on doUpdate() call.
    */
@@ -20,14 +20,19 @@ package org.apache.hadoop.ipc.metrics;
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
 import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.ipc.BufferPool;
 import org.apache.hadoop.ipc.Server;
 import org.apache.hadoop.metrics.MetricsContext;
 import org.apache.hadoop.metrics.MetricsRecord;
 import org.apache.hadoop.metrics.MetricsUtil;
 import org.apache.hadoop.metrics.Updater;
 import org.apache.hadoop.metrics.util.MetricsBase;
+import org.apache.hadoop.metrics.util.MetricsHistogram;
 import org.apache.hadoop.metrics.util.MetricsIntValue;
+import org.apache.hadoop.metrics.util.MetricsLongValue;
 import org.apache.hadoop.metrics.util.MetricsRegistry;
+import org.apache.hadoop.metrics.util.MetricsStripedTimeVaryingLong;
+import org.apache.hadoop.metrics.util.MetricsStripedTimeVaryingRate;
 import org.apache.hadoop.metrics.util.MetricsTimeVaryingInt;
 import org.apache.hadoop.metrics.util.MetricsTimeVaryingLong;
 import org.apache.hadoop.metrics.util.MetricsTimeVaryingRate;
@@ -51,6 +56,8 @@ public class RpcMetrics implements Updater {
   private final Server myServer;
   private static final Log LOG = LogFactory.getLog(RpcMetrics.class);
   RpcActivityMBean rpcMBean;
+  private long lastBufferPoolHits;
+  private long lastBufferPoolMisses;
   
   public RpcMetrics(final String hostName, final String port,
       final Server server) {
@@ -77,13 +84,29 @@ public class RpcMetrics implements Updater {
    */
 
   public final MetricsTimeVaryingLong receivedBytes = 
-         new MetricsTimeVaryingLong("ReceivedBytes", registry);
+         new MetricsStripedTimeVaryingLong("ReceivedBytes", registry);
   public final MetricsTimeVaryingLong sentBytes = 
-         new MetricsTimeVaryingLong("SentBytes", registry);
+         new MetricsStripedTimeVaryingLong("SentBytes", registry);
   public final MetricsTimeVaryingRate rpcQueueTime =
-          new MetricsTimeVaryingRate("RpcQueueTime", registry);
+          new MetricsStripedTimeVaryingRate("RpcQueueTime", registry);
+  /** Microseconds from the first byte of a request until it is queued. */
+  public final MetricsHistogram rpcReadTime =
+          new MetricsHistogram("RpcReadTime", registry);
+  /** Microseconds calls wait in the call queue. */
+  public final MetricsHistogram rpcQueueWaitTime =
+          new MetricsHistogram("RpcQueueWaitTime", registry);
+  /** Microseconds a handler spends on a call, including its response. */
+  public final MetricsHistogram rpcHandlerTime =
+          new MetricsHistogram("RpcHandlerTime", registry);
+  /** Microseconds from a response being ready until it is all sent. */
+  public final MetricsHistogram rpcResponseTime =
+          new MetricsHistogram("RpcResponseTime", registry);
+  /** Microseconds from the first byte of a request to the last byte of its
+   * response. */
+  public final MetricsHistogram rpcTotalTime =
+          new MetricsHistogram("RpcTotalTime", registry);
   public MetricsTimeVaryingRate rpcProcessingTime =
-          new MetricsTimeVaryingRate("RpcProcessingTime", registry);
+          new MetricsStripedTimeVaryingRate("RpcProcessingTime", registry);
   public final MetricsIntValue numOpenConnections = 
           new MetricsIntValue("NumOpenConnections", registry);
   public final MetricsIntValue callQueueLen = 
@@ -96,6 +119,12 @@ public class RpcMetrics implements Updater {
           new MetricsTimeVaryingInt("rpcAuthorizationFailures", registry);
   public final MetricsTimeVaryingInt authorizationSuccesses = 
          new MetricsTimeVaryingInt("rpcAuthorizationSuccesses", registry);
+  public final MetricsTimeVaryingLong bufferPoolHits =
+         new MetricsTimeVaryingLong("BufferPoolHits", registry);
+  public final MetricsTimeVaryingLong bufferPoolMisses =
+         new MetricsTimeVaryingLong("BufferPoolMisses", registry);
+  public final MetricsLongValue bufferPoolCachedBytes =
+         new MetricsLongValue("BufferPoolCachedBytes", registry);
   /**
    * Push the metrics to the monitoring subsystem on doUpdate() call.
    */
@@ -106,6 +135,14 @@ public class RpcMetrics implements Updater {
       // the metrics do not have be copied here.
       numOpenConnections.set(myServer.getNumOpenConnections());
       callQueueLen.set(myServer.getCallQueueLen());
+      BufferPool pool = myServer.getBufferPool();
+      long hits = pool.getHits();
+      long misses = pool.getMisses();
+      bufferPoolHits.inc(hits - lastBufferPoolHits);
+      bufferPoolMisses.inc(misses - lastBufferPoolMisses);
+      lastBufferPoolHits = hits;
+      lastBufferPoolMisses = misses;
+      bufferPoolCachedBytes.set(pool.getCachedBytes());
       for (MetricsBase m : registry.getMetricsList()) {
         m.pushMetric(metricsRecord);
       }
@@ -59,6 +59,8 @@ public abstract class MetricsDynamicMBeanBase implements DynamicMBean {
   private final static String MIN_TIME = "MinTime";
   private final static String MAX_TIME = "MaxTime";
   private final static String NUM_OPS = "NumOps";
+  private final static String[] PERCENTILES = {"P50", "P90", "P99", "P999"};
+  private final static double[] PERCENTILE_VALUES = {50, 90, 99, 99.9};
   private final static String RESET_ALL_MIN_MAX_OP = "resetAllMinMax";
   private MetricsRegistry metricsRegistry;
   private MBeanInfo mbeanInfo;
@@ -105,6 +107,19 @@ public abstract class MetricsDynamicMBeanBase implements DynamicMBean {
         metricsRateAttributeMod.put(o.getName() + MIN_TIME, o);
         metricsRateAttributeMod.put(o.getName() + MAX_TIME, o);
         
+      } else if (MetricsHistogram.class.isInstance(o)) {
+        // NumOps, the percentiles and the max, all derived from the histogram
+        List<String> names = new ArrayList<String>();
+        names.add(o.getName() + NUM_OPS);
+        for (String p : PERCENTILES) {
+          names.add(o.getName() + p);
+        }
+        names.add(o.getName() + MAX_TIME);
+        for (String name : names) {
+          attributesInfo.add(new MBeanAttributeInfo(name, "java.lang.Long",
+              o.getDescription(), true, false, false));
+          metricsRateAttributeMod.put(name, o);
+        }
       }  else if ( MetricsIntValue.class.isInstance(o) || MetricsTimeVaryingInt.class.isInstance(o) ) {
         attributesInfo.add(new MBeanAttributeInfo(o.getName(), "java.lang.Integer",
             o.getDescription(), true, false, false)); 
@@ -163,6 +178,18 @@ public abstract class MetricsDynamicMBeanBase implements DynamicMBean {
         MetricsUtil.LOG.error("Unexpected attrubute suffix");
         throw new AttributeNotFoundException();
       }
+    } else if (o instanceof MetricsHistogram) {
+      MetricsHistogram oh = (MetricsHistogram) o;
+      if (attributeName.endsWith(NUM_OPS))
+        return oh.getPreviousIntervalNumOps();
+      else if (attributeName.endsWith(MAX_TIME))
+        return oh.getPreviousIntervalPercentile(100);
+      for (int i = 0; i < PERCENTILES.length; i++) {
+        if (attributeName.endsWith(PERCENTILES[i]))
+          return oh.getPreviousIntervalPercentile(PERCENTILE_VALUES[i]);
+      }
+      MetricsUtil.LOG.error("Unexpected attrubute suffix");
+      throw new AttributeNotFoundException();
     } else {
         MetricsUtil.LOG.error("unknown metrics type: " + o.getClass().getName());
         throw new AttributeNotFoundException();
@@ -0,0 +1,235 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.metrics.util;
+
+import java.lang.ref.WeakReference;
+import java.util.Iterator;
+import java.util.concurrent.CopyOnWriteArrayList;
+import java.util.concurrent.atomic.AtomicLongArray;
+import java.util.concurrent.atomic.AtomicReferenceArray;
+
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.metrics.MetricsRecord;
+import org.apache.hadoop.util.StringUtils;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+
+/**
+ * The MetricsHistogram class is for the distribution of a value that
+ * varies over time (e.g. the time calls wait in a queue), where the
+ * average of {@link MetricsTimeVaryingRate} would hide the tail.
+ * The values are counted over an interval (set in the metrics config file)
+ * and published at the end of each interval as the number of values, the
+ * 50th, 90th, 99th and 99.9th percentiles and the maximum.
+ *
+ * Values are counted in log-linear buckets, as in an HDR histogram: each
+ * power of two is split into 8 buckets, so a percentile, reported as the
+ * upper bound of its bucket, is within 12.5% above the exact value. Values
+ * from 0 to 7 are exact.
+ *
+ * Each thread counts into its own buckets, with ordered writes and no
+ * locking or compare-and-swap; the threads' counts are merged when the
+ * interval ends. Buckets are allocated one power of two at a time, as
+ * values fall in them.
+ */
+@InterfaceAudience.LimitedPrivate({"HDFS", "MapReduce"})
+public class MetricsHistogram extends MetricsBase {
+
+  private static final Log LOG =
+    LogFactory.getLog("org.apache.hadoop.metrics.util");
+
+  private static final int SUB_BUCKET_BITS = 3;
+  private static final int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  /** Group 0 holds the values below SUB_BUCKETS; group g > 0, the values
+   * v with 2^(g+2) <= v < 2^(g+3). */
+  private static final int NUM_GROUPS = 64 - SUB_BUCKET_BITS;
+  private static final int NUM_BUCKETS = NUM_GROUPS * SUB_BUCKETS;
+
+  /** The counts of one thread, written only by that thread. */
+  private static final class Recorder {
+    private final WeakReference<Thread> owner =
+      new WeakReference<Thread>(Thread.currentThread());
+    private final AtomicReferenceArray<AtomicLongArray> groups =
+      new AtomicReferenceArray<AtomicLongArray>(NUM_GROUPS);
+
+    void inc(int group, int sub) {
+      AtomicLongArray counts = groups.get(group);
+      if (counts == null) {
+        counts = new AtomicLongArray(SUB_BUCKETS);
+        groups.set(group, counts);
+      }
+      counts.lazySet(sub, counts.get(sub) + 1);
+    }
+
+    boolean isRetired() {
+      Thread thread = owner.get();
+      return thread == null || !thread.isAlive();
+    }
+
+    /** Add the counts to totals, indexed by bucket. */
+    void addTo(long[] totals) {
+      for (int g = 0; g < NUM_GROUPS; g++) {
+        AtomicLongArray counts = groups.get(g);
+        if (counts != null) {
+          for (int s = 0; s < SUB_BUCKETS; s++) {
+            totals[g * SUB_BUCKETS + s] += counts.get(s);
+          }
+        }
+      }
+    }
+  }
+
+  private final ThreadLocal<Recorder> recorder = new ThreadLocal<Recorder>() {
+    @Override
+    protected Recorder initialValue() {
+      Recorder r = new Recorder();
+      recorders.add(r);
+      return r;
+    }
+  };
+  private final CopyOnWriteArrayList<Recorder> recorders =
+    new CopyOnWriteArrayList<Recorder>();
+
+  // counts of the threads that have exited
+  private final long[] retiredCounts = new long[NUM_BUCKETS];
+  // all counts at the end of the last interval
+  private final long[] lastTotals = new long[NUM_BUCKETS];
+  private final long[] previousIntervalCounts = new long[NUM_BUCKETS];
+  private long previousIntervalNumOps;
+
+  /**
+   * Constructor - create a new metric
+   * @param nam the name of the metrics to be used to publish the metric
+   * @param registry - where the metrics object will be registered
+   */
+  public MetricsHistogram(final String nam, final MetricsRegistry registry,
+                          final String description) {
+    super(nam, description);
+    registry.add(nam, this);
+  }
+
+  /**
+   * Constructor - create a new metric
+   * @param nam the name of the metrics to be used to publish the metric
+   * @param registry - where the metrics object will be registered
+   * A description of {@link #NO_DESCRIPTION} is used
+   */
+  public MetricsHistogram(final String nam, MetricsRegistry registry) {
+    this(nam, registry, NO_DESCRIPTION);
+  }
+
+  /**
+   * Count one value
+   * @param value - the value; negative values count as zero
+   */
+  public void inc(final long value) {
+    if (value < SUB_BUCKETS) {
+      recorder.get().inc(0, value <= 0 ? 0 : (int) value);
+    } else {
+      int shift = 63 - Long.numberOfLeadingZeros(value) - SUB_BUCKET_BITS;
+      recorder.get().inc(shift + 1,
+                         (int) (value >>> shift) & (SUB_BUCKETS - 1));
+    }
+  }
+
+  /** The largest value counted in a bucket. */
+  static long bucketUpperBound(int bucket) {
+    int group = bucket / SUB_BUCKETS;
+    int sub = bucket % SUB_BUCKETS;
+    if (group == 0) {
+      return sub;
+    }
+    if (bucket == NUM_BUCKETS - 1) {
+      return Long.MAX_VALUE;
+    }
+    return ((long) (SUB_BUCKETS + sub + 1) << (group - 1)) - 1;
+  }
+
+  private synchronized void intervalHeartBeat() {
+    long[] totals = retiredCounts.clone();
+    for (Iterator<Recorder> it = recorders.iterator(); it.hasNext();) {
+      Recorder r = it.next();
+      if (r.isRetired()) {
+        // the thread is gone, so its counts are final
+        r.addTo(retiredCounts);
+        recorders.remove(r);
+      }
+      r.addTo(totals);
+    }
+    long numOps = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+      previousIntervalCounts[i] = totals[i] - lastTotals[i];
+      lastTotals[i] = totals[i];
+      numOps += previousIntervalCounts[i];
+    }
+    previousIntervalNumOps = numOps;
+  }
+
+  /**
+   * Push the percentiles of the interval to the mr.
+   *
+   * Note this does NOT push to JMX
+   * (JMX gets the info via {@link #getPreviousIntervalPercentile(double)})
+   *
+   * @param mr
+   */
+  public synchronized void pushMetric(final MetricsRecord mr) {
+    intervalHeartBeat();
+    try {
+      mr.incrMetric(getName() + "_num_ops", getPreviousIntervalNumOps());
+      mr.setMetric(getName() + "_p50", getPreviousIntervalPercentile(50));
+      mr.setMetric(getName() + "_p90", getPreviousIntervalPercentile(90));
+      mr.setMetric(getName() + "_p99", getPreviousIntervalPercentile(99));
+      mr.setMetric(getName() + "_p999", getPreviousIntervalPercentile(99.9));
+      mr.setMetric(getName() + "_max", getPreviousIntervalPercentile(100));
+    } catch (Exception e) {
+      LOG.info("pushMetric failed for " + getName() + "\n" +
+          StringUtils.stringifyException(e));
+    }
+  }
+
+  /**
+   * The number of values in the previous interval
+   * @return - values in prev interval
+   */
+  public synchronized long getPreviousIntervalNumOps() {
+    return previousIntervalNumOps;
+  }
+
+  /**
+   * A percentile of the values in the previous interval
+   * @param percent - the percentile, between 0 and 100
+   * @return the upper bound of the bucket holding the percentile, or 0 if
+   *         there were no values
+   */
+  public synchronized long getPreviousIntervalPercentile(double percent) {
+    if (previousIntervalNumOps == 0) {
+      return 0;
+    }
+    long rank = (long) Math.ceil(previousIntervalNumOps * percent / 100);
+    long seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+      seen += previousIntervalCounts[i];
+      if (seen >= Math.max(rank, 1)) {
+        return bucketUpperBound(i);
+      }
+    }
+    return Long.MAX_VALUE;
+  }
+}
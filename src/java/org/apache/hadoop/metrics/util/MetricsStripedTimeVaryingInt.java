@@ -0,0 +1,124 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.metrics.util;
+
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.metrics.MetricsRecord;
+import org.apache.hadoop.util.StringUtils;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+
+/**
+ * A {@link MetricsTimeVaryingInt} for counters incremented by many threads
+ * at once. Increments go to striped cells (see {@link StripedCells})
+ * without locking, and are only added up when the interval ends; the
+ * values published are the same as those of a MetricsTimeVaryingInt.
+ */
+@InterfaceAudience.LimitedPrivate({"HDFS", "MapReduce"})
+public class MetricsStripedTimeVaryingInt extends MetricsTimeVaryingInt {
+
+  private static final Log LOG =
+    LogFactory.getLog("org.apache.hadoop.metrics.util");
+
+  private final StripedCells cells = new StripedCells();
+  private long lastTotal;      // the sum of the cells when the interval began
+  private int previousIntervalValue;
+
+  /**
+   * Constructor - create a new metric
+   * @param nam the name of the metrics to be used to publish the metric
+   * @param registry - where the metrics object will be registered
+   */
+  public MetricsStripedTimeVaryingInt(final String nam,
+      final MetricsRegistry registry, final String description) {
+    super(nam, registry, description);
+  }
+
+  /**
+   * Constructor - create a new metric
+   * @param nam the name of the metrics to be used to publish the metric
+   * @param registry - where the metrics object will be registered
+   * A description of {@link #NO_DESCRIPTION} is used
+   */
+  public MetricsStripedTimeVaryingInt(final String nam,
+      final MetricsRegistry registry) {
+    this(nam, registry, NO_DESCRIPTION);
+  }
+
+  /**
+   * Inc metrics for incr vlaue
+   * @param incr - number of operations
+   */
+  @Override
+  public void inc(final int incr) {
+    cells.add(0, incr);
+  }
+
+  /**
+   * Inc metrics by one
+   */
+  @Override
+  public void inc() {
+    cells.add(0, 1);
+  }
+
+  private synchronized void intervalHeartBeat() {
+    long total = cells.sum(0);
+    previousIntervalValue = (int) (total - lastTotal);
+    lastTotal = total;
+  }
+
+  /**
+   * Push the delta  metrics to the mr.
+   * The delta is since the last push/interval.
+   *
+   * Note this does NOT push to JMX
+   * (JMX gets the info via {@link #getPreviousIntervalValue()})
+   *
+   * @param mr
+   */
+  @Override
+  public synchronized void pushMetric(final MetricsRecord mr) {
+    intervalHeartBeat();
+    try {
+      mr.incrMetric(getName(), getPreviousIntervalValue());
+    } catch (Exception e) {
+      LOG.info("pushMetric failed for " + getName() + "\n" +
+          StringUtils.stringifyException(e));
+    }
+  }
+
+  /**
+   * The Value at the Previous interval
+   * @return prev interval value
+   */
+  @Override
+  public synchronized int getPreviousIntervalValue() {
+    return previousIntervalValue;
+  }
+
+  /**
+   * The Value at the current interval
+   * @return current interval value
+   */
+  @Override
+  public synchronized int getCurrentIntervalValue() {
+    return (int) (cells.sum(0) - lastTotal);
+  }
+}
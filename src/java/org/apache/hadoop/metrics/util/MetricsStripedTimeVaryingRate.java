@@ -0,0 +1,184 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.metrics.util;
+
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.metrics.MetricsRecord;
+import org.apache.hadoop.util.StringUtils;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+
+/**
+ * A {@link MetricsTimeVaryingRate} for operations timed by many threads at
+ * once. The operations, their total time and the min and max times are
+ * kept in striped cells (see {@link StripedCells}) without locking, and
+ * are only combined when the interval ends or the min and max are read;
+ * the values published are the same as those of a MetricsTimeVaryingRate.
+ */
+@InterfaceAudience.LimitedPrivate({"HDFS", "MapReduce"})
+public class MetricsStripedTimeVaryingRate extends MetricsTimeVaryingRate {
+
+  private static final Log LOG =
+    LogFactory.getLog("org.apache.hadoop.metrics.util");
+
+  // the counters in each cell
+  private static final int OPS = 0;
+  private static final int TIME = 1;
+  private static final int MIN = 2;
+  private static final int MAX = 3;
+
+  private final StripedCells cells = new StripedCells();
+  // the sums of the cells when the interval began
+  private long lastOps;
+  private long lastTime;
+  private int previousIntervalNumOps;
+  private long previousIntervalAverageTime;
+
+  /**
+   * Constructor - create a new metric
+   * @param nam the name of the metrics to be used to publish the metric
+   * @param registry - where the metrics object will be registered
+   */
+  public MetricsStripedTimeVaryingRate(final String nam,
+      final MetricsRegistry registry, final String description) {
+    super(nam, registry, description);
+    cells.set(MIN, Long.MAX_VALUE);
+  }
+
+  /**
+   * Constructor - create a new metric
+   * @param nam the name of the metrics to be used to publish the metric
+   * @param registry - where the metrics object will be registered
+   * A description of {@link #NO_DESCRIPTION} is used
+   */
+  public MetricsStripedTimeVaryingRate(final String nam,
+      final MetricsRegistry registry) {
+    this(nam, registry, NO_DESCRIPTION);
+  }
+
+  /**
+   * Increment the metrics for numOps operations
+   * @param numOps - number of operations
+   * @param time - time for numOps operations
+   */
+  @Override
+  public void inc(final int numOps, final long time) {
+    int cell = cells.cell();
+    cells.add(cell, OPS, numOps);
+    cells.add(cell, TIME, time);
+    long timePerOps = time/numOps;
+    cells.min(cell, MIN, timePerOps);
+    cells.max(cell, MAX, timePerOps);
+  }
+
+  /**
+   * Increment the metrics for one operation
+   * @param time for one operation
+   */
+  @Override
+  public void inc(final long time) {
+    int cell = cells.cell();
+    cells.add(cell, OPS, 1);
+    cells.add(cell, TIME, time);
+    cells.min(cell, MIN, time);
+    cells.max(cell, MAX, time);
+  }
+
+  private synchronized void intervalHeartBeat() {
+    // The two sums are not read atomically; an operation counted in one
+    // and not the other only moves to the next interval.
+    long ops = cells.sum(OPS);
+    long time = cells.sum(TIME);
+    previousIntervalNumOps = (int) (ops - lastOps);
+    previousIntervalAverageTime = (ops == lastOps) ?
+                                  0 : (time - lastTime) / (ops - lastOps);
+    lastOps = ops;
+    lastTime = time;
+  }
+
+  /**
+   * Push the delta  metrics to the mr.
+   * The delta is since the last push/interval.
+   *
+   * Note this does NOT push to JMX
+   * (JMX gets the info via {@link #getPreviousIntervalAverageTime()} and
+   * {@link #getPreviousIntervalNumOps()}
+   *
+   * @param mr
+   */
+  @Override
+  public synchronized void pushMetric(final MetricsRecord mr) {
+    intervalHeartBeat();
+    try {
+      mr.incrMetric(getName() + "_num_ops", getPreviousIntervalNumOps());
+      mr.setMetric(getName() + "_avg_time", getPreviousIntervalAverageTime());
+    } catch (Exception e) {
+      LOG.info("pushMetric failed for " + getName() + "\n" +
+          StringUtils.stringifyException(e));
+    }
+  }
+
+  /**
+   * The number of operations in the previous interval
+   * @return - ops in prev interval
+   */
+  @Override
+  public synchronized int getPreviousIntervalNumOps() {
+    return previousIntervalNumOps;
+  }
+
+  /**
+   * The average rate of an operation in the previous interval
+   * @return - the average rate.
+   */
+  @Override
+  public synchronized long getPreviousIntervalAverageTime() {
+    return previousIntervalAverageTime;
+  }
+
+  /**
+   * The min time for a single operation since the last reset
+   *  {@link #resetMinMax()}
+   * @return min time for an operation, or -1 if there was none
+   */
+  @Override
+  public long getMinTime() {
+    long min = cells.min(MIN);
+    return min == Long.MAX_VALUE ? -1 : min;
+  }
+
+  /**
+   * The max time for a single operation since the last reset
+   *  {@link #resetMinMax()}
+   * @return max time for an operation
+   */
+  @Override
+  public long getMaxTime() {
+    return Math.max(cells.max(MAX), 0);
+  }
+
+  /**
+   * Reset the min max values
+   */
+  @Override
+  public void resetMinMax() {
+    cells.set(MIN, Long.MAX_VALUE);
+    cells.set(MAX, 0);
+  }
+}
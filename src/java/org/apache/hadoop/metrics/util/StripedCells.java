@@ -0,0 +1,121 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.metrics.util;
+
+import java.util.concurrent.atomic.AtomicLongArray;
+
+/**
+ * A fixed number of cells of counters, each cell on its own cache line.
+ * A thread always updates the same cell, picked from its id, so threads
+ * on different cells never contend; a total is only computed when it is
+ * read. This is what java.util.concurrent's LongAdder does, without its
+ * dynamic growth.
+ */
+class StripedCells {
+  /** Longs per cell: 64 bytes, so that cells do not share cache lines. */
+  private static final int CELL_SIZE = 8;
+  private static final int MAX_CELLS = 64;
+
+  private final AtomicLongArray cells;
+  private final int mask;
+
+  /** Cells for up to 8 counters each, all starting at 0. */
+  StripedCells() {
+    int n = 1;
+    int wanted = 2 * Runtime.getRuntime().availableProcessors();
+    while (n < wanted && n < MAX_CELLS) {
+      n <<= 1;
+    }
+    mask = n - 1;
+    cells = new AtomicLongArray(n * CELL_SIZE);
+  }
+
+  /** The base index of the current thread's cell. */
+  int cell() {
+    long id = Thread.currentThread().getId();
+    // spread sequential thread ids over the cells
+    int h = (int) (id ^ (id >>> 32)) * 0x9E3779B9;
+    return ((h >>> 16) & mask) * CELL_SIZE;
+  }
+
+  /** Add delta to counter i of the current thread's cell. */
+  void add(int i, long delta) {
+    cells.getAndAdd(cell() + i, delta);
+  }
+
+  /** Add delta to counter i of the cell at index base. */
+  void add(int base, int i, long delta) {
+    cells.getAndAdd(base + i, delta);
+  }
+
+  /** Raise counter i of the cell at index base to at least value. */
+  void max(int base, int i, long value) {
+    int index = base + i;
+    long current;
+    while (value > (current = cells.get(index))) {
+      if (cells.compareAndSet(index, current, value)) {
+        return;
+      }
+    }
+  }
+
+  /** Lower counter i of the cell at index base to at most value. */
+  void min(int base, int i, long value) {
+    int index = base + i;
+    long current;
+    while (value < (current = cells.get(index))) {
+      if (cells.compareAndSet(index, current, value)) {
+        return;
+      }
+    }
+  }
+
+  /** The sum of counter i over all cells. */
+  long sum(int i) {
+    long sum = 0;
+    for (int c = 0; c <= mask; c++) {
+      sum += cells.get(c * CELL_SIZE + i);
+    }
+    return sum;
+  }
+
+  /** The largest value of counter i over all cells. */
+  long max(int i) {
+    long max = Long.MIN_VALUE;
+    for (int c = 0; c <= mask; c++) {
+      max = Math.max(max, cells.get(c * CELL_SIZE + i));
+    }
+    return max;
+  }
+
+  /** The smallest value of counter i over all cells. */
+  long min(int i) {
+    long min = Long.MAX_VALUE;
+    for (int c = 0; c <= mask; c++) {
+      min = Math.min(min, cells.get(c * CELL_SIZE + i));
+    }
+    return min;
+  }
+
+  /** Set counter i of every cell to value. */
+  void set(int i, long value) {
+    for (int c = 0; c <= mask; c++) {
+      cells.set(c * CELL_SIZE + i, value);
+    }
+  }
+}
@@ -18,8 +18,10 @@
 package org.apache.hadoop.net;
 
 import java.util.ArrayList;
+import java.util.LinkedHashSet;
 import java.util.List;
 import java.util.Map;
+import java.util.Set;
 import java.util.concurrent.ConcurrentHashMap;
 
 import org.apache.hadoop.classification.InterfaceAudience;
@@ -42,6 +44,12 @@ public class CachedDNSToSwitchMapping implements DNSToSwitchMapping {
     this.rawMapping = rawMapping;
   }
   
+  /**
+   * Resolve a batch of names. Names already in the cache are answered from
+   * it; the remaining distinct names are handed to the raw mapping in a
+   * single call, so a batch costs at most one script invocation or lookup
+   * round however many of its names repeat or miss.
+   */
   public List<String> resolve(List<String> names) {
     // normalize all input names to be in the form of IP addresses
     names = NetUtils.normalizeHostNames(names);
@@ -51,29 +59,42 @@ public class CachedDNSToSwitchMapping implements DNSToSwitchMapping {
       return result;
     }
 
-
-    // find out all names without cached resolved location
-    List<String> unCachedHosts = new ArrayList<String>(names.size());
-    for (String name : names) {
-      if (cache.get(name) == null) {
+    // look every name up once, remembering the distinct misses
+    String[] locations = new String[names.size()];
+    Set<String> unCachedHosts = null;
+    for (int i = 0; i < locations.length; i++) {
+      String name = names.get(i);
+      locations[i] = cache.get(name);
+      if (locations[i] == null) {
+        if (unCachedHosts == null) {
+          unCachedHosts = new LinkedHashSet<String>();
+        }
         unCachedHosts.add(name);
-      } 
+      }
     }
     
-    // Resolve those names
-    List<String> rNames = rawMapping.resolve(unCachedHosts);
-    
-    // Cache the result
-    if (rNames != null) {
-      for (int i=0; i<unCachedHosts.size(); i++) {
-        cache.put(unCachedHosts.get(i), rNames.get(i));
+    if (unCachedHosts != null) {
+      // Resolve those names
+      List<String> hosts = new ArrayList<String>(unCachedHosts);
+      List<String> rNames = rawMapping.resolve(hosts);
+      if (rNames == null || rNames.size() != hosts.size()) {
+        return null; //resolve all or nothing
+      }
+      // Cache the result
+      for (int i = 0; i < hosts.size(); i++) {
+        if (rNames.get(i) != null) {
+          cache.put(hosts.get(i), rNames.get(i));
+        }
+      }
+      for (int i = 0; i < locations.length; i++) {
+        if (locations[i] == null) {
+          locations[i] = cache.get(names.get(i));
+        }
       }
     }
     
     // Construct the result
-    for (String name : names) {
-      //now everything is in the cache
-      String networkLocation = cache.get(name);
+    for (String networkLocation : locations) {
       if (networkLocation != null) {
         result.add(networkLocation);
       } else { //resolve all or nothing
@@ -19,7 +19,9 @@ package org.apache.hadoop.net;
 
 import java.util.ArrayList;
 import java.util.Collection;
+import java.util.Map;
 import java.util.Random;
+import java.util.concurrent.ConcurrentHashMap;
 import java.util.concurrent.locks.ReadWriteLock;
 import java.util.concurrent.locks.ReentrantReadWriteLock;
 
@@ -36,6 +38,12 @@ import org.apache.hadoop.classification.InterfaceStability;
  * nodes represent switches/routers that manage traffic in/out of data centers
  * or racks.  
  * 
+ * <p>Besides the tree, the topology keeps a compact, immutable location for
+ * every leaf: the interned ids of its ancestors from the root down to its
+ * rack. The locations are replaced as nodes are added and removed, so
+ * {@link #getDistance(Node, Node)} and {@link #isOnSameRack(Node, Node)},
+ * which placement calls for every candidate replica, compare a few ints
+ * without taking the topology lock or walking parent pointers.</p>
  */
 @InterfaceAudience.LimitedPrivate({"HDFS", "MapReduce"})
 @InterfaceStability.Unstable
@@ -51,6 +59,8 @@ public class NetworkTopology {
   private class InnerNode extends NodeBase {
     private ArrayList<Node> children=new ArrayList<Node>();
     private int numOfLeaves;
+    /** Interned id, unique among the inner nodes of this topology */
+    private final int id = nextInnerId++;
         
     /** Construct an InnerNode from a path-like string */
     InnerNode(String path) {
@@ -297,7 +307,30 @@ public class NetworkTopology {
       return numOfLeaves;
     }
   } // end of InnerNode
-    
+
+  /* The location of a leaf in the tree, fixed when the leaf is added.
+   * ancestors[i] is the id of the leaf's ancestor at level i+1, so the last
+   * entry is its rack.
+   */
+  private static class Location {
+    final Node node;
+    final int[] ancestors;
+
+    Location(Node node, int[] ancestors) {
+      this.node = node;
+      this.ancestors = ancestors;
+    }
+
+    int getRackId() {
+      return ancestors.length == 0 ? -1 : ancestors[ancestors.length-1];
+    }
+  }
+
+  private int nextInnerId = 0; // guarded by the write lock
+  /* locations of the leaves in the tree; read without the lock */
+  private final Map<Node, Location> locations =
+    new ConcurrentHashMap<Node, Location>();
+
   InnerNode clusterMap = new InnerNode(InnerNode.ROOT); // the root
   private int numOfRacks = 0;  // rack counter
   private ReadWriteLock netlock;
@@ -327,13 +360,21 @@ public class NetworkTopology {
                                            + node.toString() 
                                            + " at an illegal network location");
       }
+      // a leaf with the same name is replaced by the new instance
+      Node leaf = getNode(NodeBase.getPath(node));
+      if (leaf != null && leaf != node && getLocation(leaf) != null) {
+        locations.remove(leaf);
+      }
       if (clusterMap.add(node)) {
         LOG.info("Adding a new node: "+NodeBase.getPath(node));
         if (rack == null) {
           numOfRacks++;
         }
       }
-      LOG.debug("NetworkTopology became:\n" + this.toString());
+      updateLocation(node);
+      if (LOG.isDebugEnabled()) {
+        LOG.debug("NetworkTopology became:\n" + this.toString());
+      }
     } finally {
       netlock.writeLock().unlock();
     }
@@ -353,17 +394,47 @@ public class NetworkTopology {
     LOG.info("Removing a node: "+NodeBase.getPath(node));
     netlock.writeLock().lock();
     try {
+      // the tree removes the leaf with the same name, which may be another
+      // instance than the given one
+      Node leaf = getNode(NodeBase.getPath(node));
       if (clusterMap.remove(node)) {
+        if (leaf != null && getLocation(leaf) != null) {
+          locations.remove(leaf);
+        }
         InnerNode rack = (InnerNode)getNode(node.getNetworkLocation());
         if (rack == null) {
           numOfRacks--;
         }
       }
-      LOG.debug("NetworkTopology became:\n" + this.toString());
+      if (LOG.isDebugEnabled()) {
+        LOG.debug("NetworkTopology became:\n" + this.toString());
+      }
     } finally {
       netlock.writeLock().unlock();
     }
   }
+
+  /* Record the location of a leaf that has just been added to the tree.
+   * Must be called with the write lock held.
+   */
+  private void updateLocation(Node node) {
+    int[] ancestors = new int[Math.max(node.getLevel()-1, 0)];
+    Node parent = node.getParent();
+    for (int i = ancestors.length-1; i >= 0 && parent != null; i--) {
+      ancestors[i] = ((InnerNode)parent).id;
+      parent = parent.getParent();
+    }
+    locations.put(node, new Location(node, ancestors));
+  }
+
+  /* Return the location of a leaf in the tree, or null if <i>node</i> is
+   * not a leaf of this topology.
+   */
+  private Location getLocation(Node node) {
+    Location loc = locations.get(node);
+    // the map matches nodes by equals(), but the tree holds node instances
+    return loc != null && loc.node == node ? loc : null;
+  }
        
   /** Check if the tree contains node <i>node</i>
    * 
@@ -373,6 +444,7 @@ public class NetworkTopology {
    */
   public boolean contains(Node node) {
     if (node == null) return false;
+    if (getLocation(node) != null) return true;
     netlock.readLock().lock();
     try {
       Node parent = node.getParent();
@@ -438,6 +510,18 @@ public class NetworkTopology {
     if (node1 == node2) {
       return 0;
     }
+    Location loc1 = getLocation(node1);
+    Location loc2 = getLocation(node2);
+    if (loc1 != null && loc2 != null) {
+      int[] a1 = loc1.ancestors, a2 = loc2.ancestors;
+      int common = 0;
+      int depth = Math.min(a1.length, a2.length);
+      while (common < depth && a1[common] == a2[common]) {
+        common++;
+      }
+      // both leaves are one level below their last ancestor
+      return (a1.length - common) + (a2.length - common) + 2;
+    }
     Node n1=node1, n2=node2;
     int dis = 0;
     netlock.readLock().lock();
@@ -483,6 +567,11 @@ public class NetworkTopology {
     if (node1 == null || node2 == null) {
       return false;
     }
+    Location loc1 = getLocation(node1);
+    Location loc2 = getLocation(node2);
+    if (loc1 != null && loc2 != null) {
+      return loc1.getRackId() == loc2.getRackId();
+    }
       
     netlock.readLock().lock();
     try {
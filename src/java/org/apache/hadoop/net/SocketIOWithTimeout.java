@@ -23,6 +23,7 @@ import java.io.InterruptedIOException;
 import java.net.SocketAddress;
 import java.net.SocketTimeoutException;
 import java.nio.ByteBuffer;
+import java.nio.channels.ClosedChannelException;
 import java.nio.channels.SelectableChannel;
 import java.nio.channels.SelectionKey;
 import java.nio.channels.Selector;
@@ -33,11 +34,20 @@ import java.util.LinkedList;
 
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.io.nativeio.NativeSocketIO;
 import org.apache.hadoop.util.StringUtils;
 
 /**
  * This supports input and output streams for a socket channels. 
  * These streams can have a timeout.
+ * 
+ * When libhadoop is loaded and the system property
+ * <code>hadoop.net.native.socket.io</code> is true, socket channels wait
+ * with poll(2) through {@link NativeSocketIO} instead of a cached selector.
+ * Each native call works on a duplicate of the channel's descriptor, so
+ * the channel may be closed by any means, by either stream or through its
+ * socket, while a call is in progress: the call then ends within one wait
+ * slice, and the socket is released when it does.
  */
 abstract class SocketIOWithTimeout {
   // This is intentionally package private.
@@ -46,10 +56,25 @@ abstract class SocketIOWithTimeout {
   
   private SelectableChannel channel;
   private long timeout;
-  private boolean closed = false;
+  private volatile boolean closed = false;
+  // descriptor for native I/O, or -1 to use the selector
+  private final int fd;
+  // identity of the socket fd referred to when the stream was created
+  private final long socketId;
   
   private static SelectorPool selector = new SelectorPool();
   
+  /** The system property that turns on native socket I/O. */
+  static final String NATIVE_IO_PROPERTY = "hadoop.net.native.socket.io";
+  
+  private static volatile boolean useNative =
+    Boolean.getBoolean(NATIVE_IO_PROPERTY);
+  
+  /* Longest single native wait. Between waits we notice interrupts and
+   * channels closed by other threads, as a selector would.
+   */
+  private static final int NATIVE_WAIT_SLICE = 500;
+  
   /* A timeout value of 0 implies wait for ever. 
    * We should have a value of timeout that implies zero wait.. i.e. 
    * read or write returns immediately.
@@ -64,12 +89,37 @@ abstract class SocketIOWithTimeout {
     this.timeout = timeout;
     // Set non-blocking
     channel.configureBlocking(false);
+    int fd = (channel instanceof SocketChannel) ?
+        NativeSocketIO.getFD((SocketChannel)channel) : -1;
+    this.socketId = NativeSocketIO.getSocketId(fd);
+    this.fd = socketId >= 0 ? fd : -1;
+  }
+  
+  /**
+   * Choose whether streams wait with native poll(2) when libhadoop is
+   * loaded, or always with a selector. For tests and benchmarks.
+   */
+  static void setUseNative(boolean use) {
+    useNative = use;
+  }
+  
+  static boolean getUseNative() {
+    return useNative;
   }
   
   void close() {
     closed = true;
   }
 
+  /**
+   * Close the channel. A native call in progress on another thread ends
+   * within one wait slice.
+   */
+  void closeChannel() throws IOException {
+    closed = true;
+    channel.close();
+  }
+
   boolean isOpen() {
     return !closed && channel.isOpen();
   }
@@ -133,6 +183,10 @@ abstract class SocketIOWithTimeout {
       //or should we just return 0?
     }
 
+    if (fd >= 0 && useNative && (buf.isDirect() || buf.hasArray())) {
+      return doNativeIO(buf, ops);
+    }
+
     while (buf.hasRemaining()) {
       if (closed) {
         return -1;
@@ -170,6 +224,79 @@ abstract class SocketIOWithTimeout {
     return 0; // does not reach here.
   }
   
+  /**
+   * {@link #doIO(ByteBuffer, int)} for channels with a native descriptor.
+   */
+  private int doNativeIO(ByteBuffer buf, int ops) throws IOException {
+    long deadline = (timeout > 0) ? System.currentTimeMillis() + timeout : 0;
+    while (true) {
+      if (closed) {
+        return -1;
+      }
+      checkOpen();
+      int n;
+      try {
+        n = (ops == SelectionKey.OP_READ)
+          ? NativeSocketIO.read(fd, socketId, buf, nativeWait(deadline))
+          : NativeSocketIO.write(fd, socketId, buf, nativeWait(deadline));
+      } catch (IOException e) {
+        if (!channel.isOpen()) {
+          closed = true;
+        }
+        throw e;
+      }
+      if (n != NativeSocketIO.TIMEOUT) {
+        return n;
+      }
+      checkNativeWait(deadline, ops);
+    }
+  }
+  
+  /** Throws if the channel was closed. */
+  private void checkOpen() throws IOException {
+    if (!channel.isOpen()) {
+      closed = true;
+      throw new ClosedChannelException();
+    }
+  }
+
+  /** Wait natively for the channel to be ready, for one slice. */
+  private boolean pollNative(int ops, long deadline) throws IOException {
+    if (closed) {
+      throw new ClosedChannelException();
+    }
+    checkOpen();
+    return NativeSocketIO.poll(fd, socketId, ops, nativeWait(deadline));
+  }
+
+  /** The length of the next native wait, up to the deadline. */
+  private static int nativeWait(long deadline) {
+    if (deadline == 0) {
+      return NATIVE_WAIT_SLICE;
+    }
+    long left = deadline - System.currentTimeMillis();
+    return (int) Math.max(1, Math.min(left, NATIVE_WAIT_SLICE));
+  }
+  
+  /**
+   * Called after a native wait ended without the channel becoming ready:
+   * throws if the wait should not go on.
+   */
+  private void checkNativeWait(long deadline, int ops) throws IOException {
+    if (!channel.isOpen()) {
+      closed = true;
+      throw new ClosedChannelException();
+    }
+    if (deadline > 0 && System.currentTimeMillis() >= deadline) {
+      throw new SocketTimeoutException(timeoutExceptionString(channel,
+                                                              timeout, ops));
+    }
+    if (Thread.currentThread().isInterrupted()) {
+      throw new InterruptedIOException("Interruped while waiting for " +
+                                       "IO on channel " + channel + ".");
+    }
+  }
+  
   /**
    * The contract is similar to {@link SocketChannel#connect(SocketAddress)} 
    * with a timeout.
@@ -242,6 +369,14 @@ abstract class SocketIOWithTimeout {
    */
   void waitForIO(int ops) throws IOException {
     
+    if (fd >= 0 && useNative) {
+      long deadline = (timeout > 0) ? System.currentTimeMillis() + timeout : 0;
+      while (!pollNative(ops, deadline)) {
+        checkNativeWait(deadline, ops);
+      }
+      return;
+    }
+    
     if (selector.select(channel, ops, timeout) == 0) {
       throw new SocketTimeoutException(timeoutExceptionString(channel, timeout,
                                                               ops)); 
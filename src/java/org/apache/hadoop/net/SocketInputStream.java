@@ -136,8 +136,7 @@ public class SocketInputStream extends InputStream
     /* close the channel since Socket.getInputStream().close()
      * closes the socket.
      */
-    reader.channel.close();
-    reader.close();
+    reader.closeChannel();
   }
 
   /**
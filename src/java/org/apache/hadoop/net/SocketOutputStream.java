@@ -128,8 +128,7 @@ public class SocketOutputStream extends OutputStream
     /* close the channel since Socket.getOuputStream().close() 
      * closes the socket.
      */
-    writer.channel.close();
-    writer.close();
+    writer.closeChannel();
   }
 
   /**
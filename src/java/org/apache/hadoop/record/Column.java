@@ -0,0 +1,432 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.record;
+
+import java.io.DataInput;
+import java.io.DataOutput;
+import java.io.EOFException;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.HashMap;
+
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.io.DataInputBuffer;
+import org.apache.hadoop.io.DataOutputBuffer;
+
+/**
+ * The values of one field in a batch of records written by
+ * {@link ColumnarBatchWriter} and read by {@link ColumnarBatchReader}.
+ * The columnar writers and readers that the record compiler generates hold
+ * one column per field; a column either collects values with
+ * <code>add</code> and is then written, or is loaded and returns the
+ * values with <code>next</code>.
+ *
+ * <p>Each type has its own encoding. Ints and longs are stored as the
+ * zigzag-encoded difference from the previous value, in unsigned base-128
+ * varints, so sorted or clustered values take a byte or two. Booleans are
+ * packed eight to a byte. Ustrings are dictionary encoded when at most
+ * half of the values of a batch are distinct. Floats, doubles, bytes and
+ * buffers are stored as in the binary record format, and vectors, maps and
+ * records are serialized with {@link BinaryRecordOutput} into a
+ * {@link Serialized} column.</p>
+ * 
+ * @deprecated Replaced by <a href="http://hadoop.apache.org/avro/">Avro</a>.
+ */
+@Deprecated
+@InterfaceAudience.Public
+@InterfaceStability.Evolving
+public abstract class Column {
+
+  private static final byte PLAIN = 0;
+  private static final byte DICTIONARY = 1;
+
+  /** The encoded values of a column being written. */
+  protected final DataOutputBuffer out = new DataOutputBuffer();
+
+  /** The encoded values of a loaded column, from pos up to end. */
+  protected byte[] data = new byte[0];
+  protected int pos;
+  protected int end;
+
+  private boolean loaded;
+
+  /**
+   * Whether the column was loaded from the current batch, that is, whether
+   * its field is projected.
+   */
+  public boolean isLoaded() {
+    return loaded;
+  }
+
+  /** Encode into {@link #out} what <code>add</code> left pending. */
+  protected void finish() throws IOException {
+  }
+
+  /** Prepare to return <code>count</code> values from {@link #data}. */
+  protected abstract void start(int count) throws IOException;
+
+  /** Write the values added since the last call, and clear them. */
+  final void write(DataOutput dst) throws IOException {
+    finish();
+    Utils.writeVInt(dst, out.getLength());
+    dst.write(out.getData(), 0, out.getLength());
+    out.reset();
+  }
+
+  /** Read the column of a batch of <code>count</code> records. */
+  final void load(DataInput src, int count) throws IOException {
+    int len = Utils.readVInt(src);
+    if (len < 0) {
+      throw new IOException("Negative column length " + len);
+    }
+    if (data.length < len) {
+      data = new byte[Math.max(len, data.length * 2)];
+    }
+    src.readFully(data, 0, len);
+    pos = 0;
+    end = len;
+    start(count);
+    loaded = true;
+  }
+
+  /** Skip the column of a batch. */
+  static void skip(DataInput src) throws IOException {
+    int len = Utils.readVInt(src);
+    if (len < 0) {
+      throw new IOException("Negative column length " + len);
+    }
+    while (len > 0) {
+      int skipped = src.skipBytes(len);
+      if (skipped <= 0) {
+        src.readByte();
+        skipped = 1;
+      }
+      len -= skipped;
+    }
+  }
+
+  protected void checkLength(int expected) throws IOException {
+    if (end - pos != expected) {
+      throw new IOException("Expected " + expected + " bytes of column, found "
+                            + (end - pos));
+    }
+  }
+
+  protected void writeUVLong(long u) throws IOException {
+    while ((u & ~0x7FL) != 0) {
+      out.write((int) ((u & 0x7F) | 0x80));
+      u >>>= 7;
+    }
+    out.write((int) u);
+  }
+
+  protected long readUVLong() throws IOException {
+    long u = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos >= end) {
+        throw new EOFException("Unexpected end of column");
+      }
+      byte b = data[pos++];
+      u |= (long) (b & 0x7F) << shift;
+      if (b >= 0) {
+        return u;
+      }
+    }
+    throw new IOException("Malformed varint in column");
+  }
+
+  protected static long zigzag(long i) {
+    return (i << 1) ^ (i >> 63);
+  }
+
+  protected static long unzigzag(long u) {
+    return (u >>> 1) ^ -(u & 1);
+  }
+
+  /** A column of ints, as deltas. */
+  public static class Ints extends Column {
+    private int prev;
+
+    public void add(int i) throws IOException {
+      writeUVLong(zigzag((long) i - prev));
+      prev = i;
+    }
+
+    public int next() throws IOException {
+      prev += (int) unzigzag(readUVLong());
+      return prev;
+    }
+
+    protected void finish() {
+      prev = 0;
+    }
+
+    protected void start(int count) {
+      prev = 0;
+    }
+  }
+
+  /** A column of longs, as deltas. */
+  public static class Longs extends Column {
+    private long prev;
+
+    public void add(long l) throws IOException {
+      // the difference may wrap, and so does the sum that restores it
+      writeUVLong(zigzag(l - prev));
+      prev = l;
+    }
+
+    public long next() throws IOException {
+      prev += unzigzag(readUVLong());
+      return prev;
+    }
+
+    protected void finish() {
+      prev = 0;
+    }
+
+    protected void start(int count) {
+      prev = 0;
+    }
+  }
+
+  /** A column of booleans, eight to a byte from the lowest bit. */
+  public static class Bools extends Column {
+    private int bits;
+    private int nbits;
+
+    public void add(boolean b) {
+      if (b) {
+        bits |= 1 << nbits;
+      }
+      if (++nbits == 8) {
+        out.write(bits);
+        bits = nbits = 0;
+      }
+    }
+
+    public boolean next() {
+      boolean b = (data[pos] & (1 << nbits)) != 0;
+      if (++nbits == 8) {
+        pos++;
+        nbits = 0;
+      }
+      return b;
+    }
+
+    protected void finish() {
+      if (nbits != 0) {
+        out.write(bits);
+        bits = nbits = 0;
+      }
+    }
+
+    protected void start(int count) throws IOException {
+      checkLength((count + 7) / 8);
+      nbits = 0;
+    }
+  }
+
+  /** A column of bytes. */
+  public static class Bytes extends Column {
+    public void add(byte b) {
+      out.write(b);
+    }
+
+    public byte next() {
+      return data[pos++];
+    }
+
+    protected void start(int count) throws IOException {
+      checkLength(count);
+    }
+  }
+
+  /** A column of floats. */
+  public static class Floats extends Column {
+    public void add(float f) throws IOException {
+      out.writeFloat(f);
+    }
+
+    public float next() {
+      float f = Utils.readFloat(data, pos);
+      pos += 4;
+      return f;
+    }
+
+    protected void start(int count) throws IOException {
+      checkLength(count * 4);
+    }
+  }
+
+  /** A column of doubles. */
+  public static class Doubles extends Column {
+    public void add(double d) throws IOException {
+      out.writeDouble(d);
+    }
+
+    public double next() {
+      double d = Utils.readDouble(data, pos);
+      pos += 8;
+      return d;
+    }
+
+    protected void start(int count) throws IOException {
+      checkLength(count * 8);
+    }
+  }
+
+  /**
+   * A column of ustrings. A dictionary column holds each distinct value
+   * once, and only those are decoded when it is loaded.
+   */
+  public static class Strings extends Column {
+    private final HashMap<String, Integer> codes =
+      new HashMap<String, Integer>();
+    private final ArrayList<String> entries = new ArrayList<String>();
+    private int[] values = new int[16];
+    private int numValues;
+
+    private final DataInputBuffer in = new DataInputBuffer();
+    private String[] dictionary;
+
+    public void add(String s) {
+      Integer code = codes.get(s);
+      if (code == null) {
+        code = entries.size();
+        codes.put(s, code);
+        entries.add(s);
+      }
+      if (numValues == values.length) {
+        int[] grown = new int[numValues * 2];
+        System.arraycopy(values, 0, grown, 0, numValues);
+        values = grown;
+      }
+      values[numValues++] = code;
+    }
+
+    public String next() throws IOException {
+      if (dictionary != null) {
+        long code = readUVLong();
+        if (code >= dictionary.length) {
+          throw new IOException("Dictionary code " + code + " out of range");
+        }
+        return dictionary[(int) code];
+      }
+      in.reset(data, pos, end - pos);
+      String s = Utils.fromBinaryString(in);
+      pos = in.getPosition();
+      return s;
+    }
+
+    protected void finish() throws IOException {
+      if (entries.size() * 2 <= numValues) {
+        out.writeByte(DICTIONARY);
+        writeUVLong(entries.size());
+        for (String s : entries) {
+          Utils.toBinaryString(out, s);
+        }
+        for (int i = 0; i < numValues; i++) {
+          writeUVLong(values[i]);
+        }
+      } else {
+        out.writeByte(PLAIN);
+        for (int i = 0; i < numValues; i++) {
+          Utils.toBinaryString(out, entries.get(values[i]));
+        }
+      }
+      codes.clear();
+      entries.clear();
+      numValues = 0;
+    }
+
+    protected void start(int count) throws IOException {
+      if (pos >= end) {
+        throw new EOFException("Unexpected end of column");
+      }
+      byte encoding = data[pos++];
+      if (encoding == PLAIN) {
+        dictionary = null;
+      } else if (encoding == DICTIONARY) {
+        long size = readUVLong();
+        if (size > count) {
+          throw new IOException("Dictionary of " + size + " entries for "
+                                + count + " values");
+        }
+        dictionary = new String[(int) size];
+        in.reset(data, pos, end - pos);
+        for (int i = 0; i < dictionary.length; i++) {
+          dictionary[i] = Utils.fromBinaryString(in);
+        }
+        pos = in.getPosition();
+      } else {
+        throw new IOException("Unknown ustring column encoding " + encoding);
+      }
+    }
+  }
+
+  /** A column of buffers. */
+  public static class Buffers extends Column {
+    public void add(Buffer b) throws IOException {
+      Utils.writeVInt(out, b.getCount());
+      out.write(b.get(), 0, b.getCount());
+    }
+
+    public Buffer next() throws IOException {
+      if (pos >= end) {
+        throw new EOFException("Unexpected end of column");
+      }
+      int len = Utils.readVInt(data, pos);
+      pos += Utils.decodeVIntSize(data[pos]);
+      if (len < 0 || len > end - pos) {
+        throw new IOException("Bad buffer length " + len);
+      }
+      Buffer b = new Buffer(data, pos, len);
+      pos += len;
+      return b;
+    }
+
+    protected void start(int count) {
+    }
+  }
+
+  /**
+   * A column of vectors, maps or records, each serialized in the binary
+   * record format through the {@link RecordOutput} and read back through
+   * the {@link RecordInput}.
+   */
+  public static class Serialized extends Column {
+    private final BinaryRecordOutput recordOut = new BinaryRecordOutput(out);
+    private final DataInputBuffer in = new DataInputBuffer();
+    private final BinaryRecordInput recordIn = new BinaryRecordInput(in);
+
+    public RecordOutput getRecordOutput() {
+      return recordOut;
+    }
+
+    public RecordInput getRecordInput() {
+      return recordIn;
+    }
+
+    protected void start(int count) {
+      in.reset(data, pos, end - pos);
+    }
+  }
+}
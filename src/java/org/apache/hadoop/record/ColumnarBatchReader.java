@@ -0,0 +1,122 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.record;
+
+import java.io.DataInput;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashSet;
+
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+
+/**
+ * Reads records written by {@link ColumnarBatchWriter}. Only the columns
+ * of the projected fields are decoded; the others are skipped whole, and
+ * the fields keep whatever value the record passed to {@link #next} had.
+ * The record compiler generates a <code>ColumnarReader</code> subclass for
+ * each record.
+ * 
+ * @deprecated Replaced by <a href="http://hadoop.apache.org/avro/">Avro</a>.
+ */
+@Deprecated
+@InterfaceAudience.Public
+@InterfaceStability.Evolving
+public abstract class ColumnarBatchReader<T extends Record> {
+
+  private final DataInput in;
+  private final boolean[] projected;
+  private final ArrayList<Column> columns = new ArrayList<Column>();
+  private int remaining;
+  private boolean done;
+
+  /**
+   * @param in the input
+   * @param names the names of the record's fields, in order
+   * @param fields the fields to read; all of them if none are given
+   * @throws IllegalArgumentException if a field is not one of names
+   */
+  protected ColumnarBatchReader(DataInput in, String[] names,
+                                String[] fields) {
+    this.in = in;
+    projected = new boolean[names.length];
+    if (fields == null || fields.length == 0) {
+      Arrays.fill(projected, true);
+      return;
+    }
+    HashSet<String> wanted = new HashSet<String>(Arrays.asList(fields));
+    for (int i = 0; i < names.length; i++) {
+      projected[i] = wanted.remove(names[i]);
+    }
+    if (!wanted.isEmpty()) {
+      throw new IllegalArgumentException("No such fields: " + wanted);
+    }
+  }
+
+  /** Add the column of the next field. */
+  protected void addColumn(Column column) {
+    columns.add(column);
+  }
+
+  /** Set the projected fields of a record from their columns. */
+  protected abstract void readRecord(T r) throws IOException;
+
+  /**
+   * Read the next record.
+   *
+   * @return false at the end of the stream
+   */
+  public boolean next(T r) throws IOException {
+    if (remaining == 0 && !readBatch()) {
+      return false;
+    }
+    readRecord(r);
+    remaining--;
+    return true;
+  }
+
+  private boolean readBatch() throws IOException {
+    if (done) {
+      return false;
+    }
+    int count = Utils.readVInt(in);
+    if (count == 0) {
+      done = true;
+      return false;
+    }
+    if (count < 0) {
+      throw new IOException("Negative batch size " + count);
+    }
+    int numColumns = Utils.readVInt(in);
+    if (numColumns != columns.size()) {
+      throw new IOException("Expected " + columns.size() +
+                            " columns, found " + numColumns);
+    }
+    for (int i = 0; i < numColumns; i++) {
+      if (projected[i]) {
+        columns.get(i).load(in, count);
+      } else {
+        Column.skip(in);
+      }
+    }
+    remaining = count;
+    return true;
+  }
+}
@@ -0,0 +1,99 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.record;
+
+import java.io.DataOutput;
+import java.io.IOException;
+import java.util.ArrayList;
+
+import org.apache.hadoop.classification.InterfaceAudience;
+import org.apache.hadoop.classification.InterfaceStability;
+
+/**
+ * Writes records in batches, with the values of each field stored together
+ * as a {@link Column}, so that a reader can decode only the fields it
+ * needs. The record compiler generates a <code>ColumnarWriter</code>
+ * subclass for each record.
+ *
+ * <p>A batch is its number of records and number of columns, as varints,
+ * followed by each column as a varint length and the encoded values. The
+ * stream ends with a batch of zero records, written by {@link #close()}.
+ * </p>
+ * 
+ * @deprecated Replaced by <a href="http://hadoop.apache.org/avro/">Avro</a>.
+ */
+@Deprecated
+@InterfaceAudience.Public
+@InterfaceStability.Evolving
+public abstract class ColumnarBatchWriter<T extends Record> {
+
+  /** The default number of records in a batch. */
+  public static final int DEFAULT_BATCH_SIZE = 1024;
+
+  private final DataOutput out;
+  private final int batchSize;
+  private final ArrayList<Column> columns = new ArrayList<Column>();
+  private int count;
+
+  protected ColumnarBatchWriter(DataOutput out, int batchSize) {
+    if (batchSize <= 0) {
+      throw new IllegalArgumentException("batchSize: " + batchSize);
+    }
+    this.out = out;
+    this.batchSize = batchSize;
+  }
+
+  /** Add the column of the next field. */
+  protected void addColumn(Column column) {
+    columns.add(column);
+  }
+
+  /** Add the fields of a record to their columns. */
+  protected abstract void addRecord(T r) throws IOException;
+
+  /** Append a record, and write the batch once it is full. */
+  public void append(T r) throws IOException {
+    addRecord(r);
+    if (++count == batchSize) {
+      flush();
+    }
+  }
+
+  /** Write the records appended since the last batch as a batch. */
+  public void flush() throws IOException {
+    if (count == 0) {
+      return;
+    }
+    Utils.writeVInt(out, count);
+    Utils.writeVInt(out, columns.size());
+    for (Column column : columns) {
+      column.write(out);
+    }
+    count = 0;
+  }
+
+  /**
+   * Write the remaining records and the end of the stream. The underlying
+   * output is not closed.
+   */
+  public void close() throws IOException {
+    flush();
+    Utils.writeVInt(out, 0);
+  }
+}
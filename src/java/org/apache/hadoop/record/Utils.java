@@ -452,6 +452,16 @@ public class Utils {
     return WritableUtils.readVInt(in);
   }
   
+  /**
+   * Get the encoded length of a zero-compressed integer from its first byte,
+   * without decoding it.
+   * @param value the first byte of the encoded integer
+   * @return the encoded length, 1 if the value is the byte itself
+   */
+  public static int decodeVIntSize(byte value) {
+    return WritableUtils.decodeVIntSize(value);
+  }
+  
   /**
    * Get the encoded length if an integer is stored in a variable-length format
    * @return the encoded length
@@ -490,6 +500,79 @@ public class Utils {
     WritableUtils.writeVInt(stream, i);
   }
   
+  /**
+   * Reads a range of zero-compressed encoded longs from a byte array.
+   * @param bytes byte array with the encoded longs
+   * @param start start index
+   * @param end end of the valid bytes
+   * @param values where to store the longs
+   * @param off index of the first long in values
+   * @param len number of longs to read
+   * @throws java.io.IOException if the array ends before the last long
+   * @return index in bytes after the last long
+   */
+  public static int readVLongs(byte[] bytes, int start, int end,
+                               long[] values, int off, int len)
+    throws IOException {
+    return WritableUtils.readVLongs(bytes, start, end, values, off, len);
+  }
+  
+  /**
+   * Reads a range of zero-compressed encoded integers from a byte array.
+   * @see #readVLongs(byte[], int, int, long[], int, int)
+   */
+  public static int readVInts(byte[] bytes, int start, int end,
+                              int[] values, int off, int len)
+    throws IOException {
+    return WritableUtils.readVInts(bytes, start, end, values, off, len);
+  }
+  
+  /**
+   * Reads a range of zero-compressed encoded longs from a stream.
+   * @param in input stream
+   * @param values where to store the longs
+   * @param off index of the first long in values
+   * @param len number of longs to read
+   * @throws java.io.IOException
+   */
+  public static void readVLongs(DataInput in, long[] values, int off, int len)
+    throws IOException {
+    WritableUtils.readVLongs(in, values, off, len);
+  }
+  
+  /**
+   * Reads a range of zero-compressed encoded integers from a stream.
+   * @see #readVLongs(DataInput, long[], int, int)
+   */
+  public static void readVInts(DataInput in, int[] values, int off, int len)
+    throws IOException {
+    WritableUtils.readVInts(in, values, off, len);
+  }
+  
+  /**
+   * Serializes a range of longs to a binary stream with zero-compressed
+   * encoding, in a few large writes.
+   * @param stream Binary output stream
+   * @param values longs to be serialized
+   * @param off index of the first long
+   * @param len number of longs
+   * @throws java.io.IOException
+   */
+  public static void writeVLongs(DataOutput stream, long[] values,
+                                 int off, int len) throws IOException {
+    WritableUtils.writeVLongs(stream, values, off, len);
+  }
+  
+  /**
+   * Serializes a range of ints to a binary stream with zero-compressed
+   * encoding.
+   * @see #writeVLongs(DataOutput, long[], int, int)
+   */
+  public static void writeVInts(DataOutput stream, int[] values,
+                                int off, int len) throws IOException {
+    WritableUtils.writeVInts(stream, values, off, len);
+  }
+  
   /** Lexicographic order of binary data. */
   public static int compareBytes(byte[] b1, int s1, int l1,
                                  byte[] b2, int s2, int l2) {
@@ -52,6 +52,8 @@ class CppGenerator extends CodeGenerator {
         hh.write("#define __"+fileName.toUpperCase().replace('.','_')+"__\n");
         hh.write("#include \"recordio.hh\"\n");
         hh.write("#include \"recordTypeInfo.hh\"\n");
+        hh.write("#include \"binserializer.hh\"\n");
+        hh.write("#include \"columnar.hh\"\n");
         for (Iterator<JFile> iter = ilist.iterator(); iter.hasNext();) {
           hh.write("#include \""+iter.next().getName()+".hh\"\n");
         }
@@ -73,6 +73,10 @@ public class JBoolean extends JType {
       cb.append("s1++; s2++; l1--; l2--;\n");
       cb.append("}\n");
     }
+    
+    String getColumnType() {
+      return "org.apache.hadoop.record.Column.Bools";
+    }
   }
   
   class CppBoolean extends CppType {
@@ -84,6 +88,14 @@ public class JBoolean extends JType {
     String getTypeIDObjectString() {
       return "new ::hadoop::TypeID(::hadoop::RIOTYPE_BOOL)";
     }
+    
+    int getMaxBinarySize() {
+      return 1;
+    }
+    
+    String getColumnType() {
+      return "::hadoop::BoolColumn";
+    }
   }
 
   /** Creates a new instance of JBoolean */
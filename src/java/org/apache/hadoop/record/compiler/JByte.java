@@ -63,6 +63,10 @@ public class JByte extends JType {
       cb.append("s1++; s2++; l1--; l2--;\n");
       cb.append("}\n");
     }
+    
+    String getColumnType() {
+      return "org.apache.hadoop.record.Column.Bytes";
+    }
   }
   
   class CppByte extends CppType {
@@ -74,6 +78,14 @@ public class JByte extends JType {
     String getTypeIDObjectString() {
       return "new ::hadoop::TypeID(::hadoop::RIOTYPE_BYTE)";
     }
+    
+    int getMaxBinarySize() {
+      return 1;
+    }
+    
+    String getColumnType() {
+      return "::hadoop::ByteColumn";
+    }
   }
 
   public JByte() {
@@ -69,6 +69,10 @@ public class JDouble extends JType {
       cb.append("s1+=8; s2+=8; l1-=8; l2-=8;\n");
       cb.append("}\n");
     }
+    
+    String getColumnType() {
+      return "org.apache.hadoop.record.Column.Doubles";
+    }
   }
 
   class CppDouble extends CppType {
@@ -80,6 +84,14 @@ public class JDouble extends JType {
     String getTypeIDObjectString() {
       return "new ::hadoop::TypeID(::hadoop::RIOTYPE_DOUBLE)";
     }
+    
+    int getMaxBinarySize() {
+      return 8;
+    }
+    
+    String getColumnType() {
+      return "::hadoop::DoubleColumn";
+    }
   }
 
   
@@ -67,6 +67,10 @@ public class JFloat extends JType {
       cb.append("s1+=4; s2+=4; l1-=4; l2-=4;\n");
       cb.append("}\n");
     }
+    
+    String getColumnType() {
+      return "org.apache.hadoop.record.Column.Floats";
+    }
   }
 
   class CppFloat extends CppType {
@@ -78,6 +82,14 @@ public class JFloat extends JType {
     String getTypeIDObjectString() {
       return "new ::hadoop::TypeID(::hadoop::RIOTYPE_FLOAT)";
     }
+    
+    int getMaxBinarySize() {
+      return 4;
+    }
+    
+    String getColumnType() {
+      return "::hadoop::FloatColumn";
+    }
   }
 
   /** Creates a new instance of JFloat */
@@ -48,24 +48,35 @@ public class JLong extends JType {
     
     void genSlurpBytes(CodeBuffer cb, String b, String s, String l) {
       cb.append("{\n");
-      cb.append("long i = org.apache.hadoop.record.Utils.readVLong("+b+", "+s+");\n");
-      cb.append("int z = org.apache.hadoop.record.Utils.getVIntSize(i);\n");
+      cb.append("int z = org.apache.hadoop.record.Utils.decodeVIntSize("+
+                b+"["+s+"]);\n");
       cb.append(s+"+=z; "+l+"-=z;\n");
       cb.append("}\n");
     }
     
+    // Values that fit in a single byte, the common case, compare as bytes.
     void genCompareBytes(CodeBuffer cb) {
       cb.append("{\n");
+      cb.append("int z1 = org.apache.hadoop.record.Utils.decodeVIntSize(b1[s1]);\n");
+      cb.append("int z2 = org.apache.hadoop.record.Utils.decodeVIntSize(b2[s2]);\n");
+      cb.append("if (z1 == 1 && z2 == 1) {\n");
+      cb.append("if (b1[s1] != b2[s2]) {\n");
+      cb.append("return (b1[s1] < b2[s2]) ? -1 : 0;\n");
+      cb.append("}\n");
+      cb.append("} else {\n");
       cb.append("long i1 = org.apache.hadoop.record.Utils.readVLong(b1, s1);\n");
       cb.append("long i2 = org.apache.hadoop.record.Utils.readVLong(b2, s2);\n");
       cb.append("if (i1 != i2) {\n");
-      cb.append("return ((i1-i2) < 0) ? -1 : 0;\n");
+      cb.append("return (i1 < i2) ? -1 : 0;\n");
+      cb.append("}\n");
       cb.append("}\n");
-      cb.append("int z1 = org.apache.hadoop.record.Utils.getVIntSize(i1);\n");
-      cb.append("int z2 = org.apache.hadoop.record.Utils.getVIntSize(i2);\n");
       cb.append("s1+=z1; s2+=z2; l1-=z1; l2-=z2;\n");
       cb.append("}\n");
     }
+    
+    String getColumnType() {
+      return "org.apache.hadoop.record.Column.Longs";
+    }
   }
 
   class CppLong extends CppType {
@@ -77,6 +88,14 @@ public class JLong extends JType {
     String getTypeIDObjectString() {
       return "new ::hadoop::TypeID(::hadoop::RIOTYPE_LONG)";
     }
+    
+    int getMaxBinarySize() {
+      return 9;
+    }
+    
+    String getColumnType() {
+      return "::hadoop::LongColumn";
+    }
   }
 
   /** Creates a new instance of JLong */
@@ -159,7 +159,7 @@ public class JMap extends JCompType {
       cb.append("int "+getId("mi")+
                 " = org.apache.hadoop.record.Utils.readVInt("+b+", "+s+");\n");
       cb.append("int "+getId("mz")+
-                " = org.apache.hadoop.record.Utils.getVIntSize("+getId("mi")+");\n");
+                " = org.apache.hadoop.record.Utils.decodeVIntSize("+b+"["+s+"]);\n");
       cb.append(s+"+="+getId("mz")+"; "+l+"-="+getId("mz")+";\n");
       cb.append("for (int "+getId("midx")+" = 0; "+getId("midx")+
                 " < "+getId("mi")+"; "+getId("midx")+"++) {");
@@ -178,9 +178,9 @@ public class JMap extends JCompType {
       cb.append("int "+getId("mi2")+
                 " = org.apache.hadoop.record.Utils.readVInt(b2, s2);\n");
       cb.append("int "+getId("mz1")+
-                " = org.apache.hadoop.record.Utils.getVIntSize("+getId("mi1")+");\n");
+                " = org.apache.hadoop.record.Utils.decodeVIntSize(b1[s1]);\n");
       cb.append("int "+getId("mz2")+
-                " = org.apache.hadoop.record.Utils.getVIntSize("+getId("mi2")+");\n");
+                " = org.apache.hadoop.record.Utils.decodeVIntSize(b2[s2]);\n");
       cb.append("s1+="+getId("mz1")+"; s2+="+getId("mz2")+
                 "; l1-="+getId("mz1")+"; l2-="+getId("mz2")+";\n");
       cb.append("for (int "+getId("midx")+" = 0; "+getId("midx")+
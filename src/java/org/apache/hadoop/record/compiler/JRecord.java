@@ -158,6 +158,99 @@ public class JRecord extends JCompType {
       cb.append("}\n");
     }
     
+    /**
+     * Generate the writer and reader of the columnar batch format. Fields
+     * whose type has no column of its own are serialized with the type's
+     * usual write and read code, against the column's record output and
+     * input.
+     */
+    void genColumnarClasses(CodeBuffer cb) {
+      String rec = Consts.RIO_PREFIX + "r";
+      cb.append("public static class ColumnarWriter extends " +
+          "org.apache.hadoop.record.ColumnarBatchWriter<"+name+"> {\n");
+      for (JField<JavaType> jf : fields) {
+        String columnType = jf.getType().getColumnType();
+        if (columnType == null) {
+          columnType = "org.apache.hadoop.record.Column.Serialized";
+        }
+        cb.append("private final "+columnType+" "+Consts.RIO_PREFIX+"c_"+
+            jf.getName()+" = new "+columnType+"();\n");
+      }
+      cb.append("public ColumnarWriter(final java.io.DataOutput " +
+          Consts.RIO_PREFIX + "out) {\n");
+      cb.append("this(" + Consts.RIO_PREFIX + "out, DEFAULT_BATCH_SIZE);\n");
+      cb.append("}\n");
+      cb.append("public ColumnarWriter(final java.io.DataOutput " +
+          Consts.RIO_PREFIX + "out, final int " + Consts.RIO_PREFIX +
+          "batchSize) {\n");
+      cb.append("super(" + Consts.RIO_PREFIX + "out, " + Consts.RIO_PREFIX +
+          "batchSize);\n");
+      for (JField<JavaType> jf : fields) {
+        cb.append("addColumn("+Consts.RIO_PREFIX+"c_"+jf.getName()+");\n");
+      }
+      cb.append("}\n");
+      cb.append("protected void addRecord(final "+name+" "+rec+")\n" +
+          "throws java.io.IOException {\n");
+      for (JField<JavaType> jf : fields) {
+        String fname = jf.getName();
+        String column = Consts.RIO_PREFIX + "c_" + fname;
+        JavaType type = jf.getType();
+        if (type.getColumnType() != null) {
+          cb.append(column+".add("+rec+"."+fname+");\n");
+        } else {
+          cb.append("{\n");
+          cb.append("final org.apache.hadoop.record.RecordOutput " +
+              Consts.RECORD_OUTPUT + " = "+column+".getRecordOutput();\n");
+          type.genWriteMethod(cb, rec+"."+fname, fname);
+          cb.append("}\n");
+        }
+      }
+      cb.append("}\n");
+      cb.append("}\n\n");
+
+      cb.append("public static class ColumnarReader extends " +
+          "org.apache.hadoop.record.ColumnarBatchReader<"+name+"> {\n");
+      for (JField<JavaType> jf : fields) {
+        String columnType = jf.getType().getColumnType();
+        if (columnType == null) {
+          columnType = "org.apache.hadoop.record.Column.Serialized";
+        }
+        cb.append("private final "+columnType+" "+Consts.RIO_PREFIX+"c_"+
+            jf.getName()+" = new "+columnType+"();\n");
+      }
+      cb.append("public ColumnarReader(final java.io.DataInput " +
+          Consts.RIO_PREFIX + "in, final String... " + Consts.RIO_PREFIX +
+          "fields) {\n");
+      cb.append("super(" + Consts.RIO_PREFIX + "in, new String[] {");
+      for (Iterator<JField<JavaType>> i = fields.iterator(); i.hasNext();) {
+        cb.append("\""+i.next().getName()+"\"");
+        cb.append(i.hasNext() ? ", " : "");
+      }
+      cb.append("}, " + Consts.RIO_PREFIX + "fields);\n");
+      for (JField<JavaType> jf : fields) {
+        cb.append("addColumn("+Consts.RIO_PREFIX+"c_"+jf.getName()+");\n");
+      }
+      cb.append("}\n");
+      cb.append("protected void readRecord(final "+name+" "+rec+")\n" +
+          "throws java.io.IOException {\n");
+      for (JField<JavaType> jf : fields) {
+        String fname = jf.getName();
+        String column = Consts.RIO_PREFIX + "c_" + fname;
+        JavaType type = jf.getType();
+        cb.append("if ("+column+".isLoaded()) {\n");
+        if (type.getColumnType() != null) {
+          cb.append(rec+"."+fname+" = "+column+".next();\n");
+        } else {
+          cb.append("final org.apache.hadoop.record.RecordInput " +
+              Consts.RECORD_INPUT + " = "+column+".getRecordInput();\n");
+          type.genReadMethod(cb, rec+"."+fname, fname, false);
+        }
+        cb.append("}\n");
+      }
+      cb.append("}\n");
+      cb.append("}\n\n");
+    }
+    
     void genCode(String destDir, ArrayList<String> options) throws IOException {
       String pkg = module;
       String pkgpath = pkg.replaceAll("\\.", "/");
@@ -415,6 +508,8 @@ public class JRecord extends JCompType {
       cb.append("return \""+getSignature()+"\";\n");
       cb.append("}\n");
       
+      genColumnarClasses(cb);
+
       cb.append("public static class Comparator extends"+
                 " org.apache.hadoop.record.RecordComparator {\n");
       cb.append("public Comparator() {\n");
@@ -537,6 +632,171 @@ public class JRecord extends JCompType {
       cb.append("}\n");
     }
     
+    /**
+     * Generate the binary serializers and raw comparator of the record.
+     * They are inline and call ::hadoop::BinaryType directly, so nothing
+     * is dispatched at run time; consecutive fields of bounded size are
+     * encoded after a single reserve().
+     */
+    void genBinaryMethods(CodeBuffer hb) {
+      hb.append("void serializeBinary(::hadoop::OBinArchive& " +
+          Consts.RECORD_OUTPUT + ") const {\n");
+      for (int start = 0; start < fields.size(); ) {
+        int end = start;
+        int maxSize = 0;
+        while (end < fields.size() &&
+               fields.get(end).getType().getMaxBinarySize() > 0) {
+          maxSize += fields.get(end).getType().getMaxBinarySize();
+          end++;
+        }
+        if (end - start > 1) {
+          hb.append("{\n");
+          hb.append("char* const " + Consts.RIO_PREFIX + "s = " +
+              Consts.RECORD_OUTPUT + ".reserve(" + maxSize + ");\n");
+          hb.append("char* " + Consts.RIO_PREFIX + "p = " +
+              Consts.RIO_PREFIX + "s;\n");
+          for (int i = start; i < end; i++) {
+            JField<CppType> jf = fields.get(i);
+            hb.append(Consts.RIO_PREFIX + "p = " +
+                jf.getType().getBinaryType() + "::put(" +
+                Consts.RIO_PREFIX + "p, " + jf.getName() + ");\n");
+          }
+          hb.append(Consts.RECORD_OUTPUT + ".commit(" + Consts.RIO_PREFIX +
+              "p - " + Consts.RIO_PREFIX + "s);\n");
+          hb.append("}\n");
+          start = end;
+        } else {
+          JField<CppType> jf = fields.get(start);
+          hb.append(jf.getType().getBinaryType() + "::write(" +
+              Consts.RECORD_OUTPUT + ", " + jf.getName() + ");\n");
+          start++;
+        }
+      }
+      hb.append(Consts.RECORD_OUTPUT + ".checkFlush();\n");
+      hb.append("}\n");
+
+      hb.append("void deserializeBinary(::hadoop::IBinArchive& " +
+          Consts.RECORD_INPUT + ") {\n");
+      for (JField<CppType> jf : fields) {
+        hb.append(jf.getType().getBinaryType() + "::read(" +
+            Consts.RECORD_INPUT + ", " + jf.getName() + ");\n");
+      }
+      hb.append("}\n");
+
+      hb.append("static int compareRaw(const char*& " + Consts.RIO_PREFIX +
+          "b1, const char* " + Consts.RIO_PREFIX + "e1, const char*& " +
+          Consts.RIO_PREFIX + "b2, const char* " + Consts.RIO_PREFIX +
+          "e2) {\n");
+      if (!fields.isEmpty()) {
+        hb.append("int " + Consts.RIO_PREFIX + "r;\n");
+      }
+      for (JField<CppType> jf : fields) {
+        hb.append(Consts.RIO_PREFIX + "r = " + jf.getType().getBinaryType() +
+            "::compare(" + Consts.RIO_PREFIX + "b1, " + Consts.RIO_PREFIX +
+            "e1, " + Consts.RIO_PREFIX + "b2, " + Consts.RIO_PREFIX +
+            "e2);\n");
+        hb.append("if (" + Consts.RIO_PREFIX + "r != 0) {\n");
+        hb.append("return " + Consts.RIO_PREFIX + "r;\n");
+        hb.append("}\n");
+      }
+      hb.append("return 0;\n");
+      hb.append("}\n");
+
+      hb.append("static void skipRaw(const char*& " + Consts.RIO_PREFIX +
+          "b, const char* " + Consts.RIO_PREFIX + "e) {\n");
+      for (JField<CppType> jf : fields) {
+        hb.append(jf.getType().getBinaryType() + "::skip(" +
+            Consts.RIO_PREFIX + "b, " + Consts.RIO_PREFIX + "e);\n");
+      }
+      hb.append("}\n");
+    }
+
+    /**
+     * Generate the writer and reader of the columnar batch format, as
+     * classes nested in the record.
+     */
+    void genColumnarClasses(CodeBuffer hb) {
+      String rec = Consts.RIO_PREFIX + "r";
+      String fieldsType = "::std::vector< ::std::string >";
+
+      hb.append("class ColumnarWriter : public ::hadoop::ColumnarBatchWriter {\n");
+      hb.append("public:\n");
+      hb.append("explicit ColumnarWriter(::hadoop::OutStream& " +
+          Consts.RIO_PREFIX + "stream, size_t " + Consts.RIO_PREFIX +
+          "batchSize = DEFAULT_BATCH_SIZE)\n");
+      hb.append(": ::hadoop::ColumnarBatchWriter(" + Consts.RIO_PREFIX +
+          "stream, " + Consts.RIO_PREFIX + "batchSize) {\n");
+      hb.append("init();\n");
+      hb.append("}\n");
+      hb.append("explicit ColumnarWriter(::hadoop::OutputArena& " +
+          Consts.RIO_PREFIX + "arena, size_t " + Consts.RIO_PREFIX +
+          "batchSize = DEFAULT_BATCH_SIZE)\n");
+      hb.append(": ::hadoop::ColumnarBatchWriter(" + Consts.RIO_PREFIX +
+          "arena, " + Consts.RIO_PREFIX + "batchSize) {\n");
+      hb.append("init();\n");
+      hb.append("}\n");
+      hb.append("void append(const "+name+"& "+rec+") {\n");
+      for (JField<CppType> jf : fields) {
+        hb.append(Consts.RIO_PREFIX+"c_"+jf.getName()+".add("+rec+"."+
+            jf.getName()+");\n");
+      }
+      hb.append("recordAdded();\n");
+      hb.append("}\n");
+      hb.append("private:\n");
+      for (JField<CppType> jf : fields) {
+        hb.append(jf.getType().getColumnType()+" "+Consts.RIO_PREFIX+"c_"+
+            jf.getName()+";\n");
+      }
+      hb.append("void init() {\n");
+      for (JField<CppType> jf : fields) {
+        hb.append("addColumn("+Consts.RIO_PREFIX+"c_"+jf.getName()+");\n");
+      }
+      hb.append("}\n");
+      hb.append("};\n");
+
+      hb.append("class ColumnarReader : public ::hadoop::ColumnarBatchReader {\n");
+      hb.append("public:\n");
+      hb.append("explicit ColumnarReader(::hadoop::InStream& " +
+          Consts.RIO_PREFIX + "stream, const " + fieldsType + "& " +
+          Consts.RIO_PREFIX + "fields = " + fieldsType + "())\n");
+      hb.append(": ::hadoop::ColumnarBatchReader(" + Consts.RIO_PREFIX +
+          "stream, " + Consts.RIO_PREFIX + "fields) {\n");
+      hb.append("init();\n");
+      hb.append("}\n");
+      hb.append("ColumnarReader(const void* " + Consts.RIO_PREFIX +
+          "data, size_t " + Consts.RIO_PREFIX + "len, const " + fieldsType +
+          "& " + Consts.RIO_PREFIX + "fields = " + fieldsType + "())\n");
+      hb.append(": ::hadoop::ColumnarBatchReader(" + Consts.RIO_PREFIX +
+          "data, " + Consts.RIO_PREFIX + "len, " + Consts.RIO_PREFIX +
+          "fields) {\n");
+      hb.append("init();\n");
+      hb.append("}\n");
+      hb.append("bool next("+name+"& "+rec+") {\n");
+      hb.append("if (!nextRecord()) {\n");
+      hb.append("return false;\n");
+      hb.append("}\n");
+      for (JField<CppType> jf : fields) {
+        String column = Consts.RIO_PREFIX+"c_"+jf.getName();
+        hb.append("if ("+column+".loaded()) {\n");
+        hb.append(column+".next("+rec+"."+jf.getName()+");\n");
+        hb.append("}\n");
+      }
+      hb.append("return true;\n");
+      hb.append("}\n");
+      hb.append("private:\n");
+      for (JField<CppType> jf : fields) {
+        hb.append(jf.getType().getColumnType()+" "+Consts.RIO_PREFIX+"c_"+
+            jf.getName()+";\n");
+      }
+      hb.append("void init() {\n");
+      for (JField<CppType> jf : fields) {
+        hb.append("addColumn(\""+jf.getName()+"\", "+Consts.RIO_PREFIX+"c_"+
+            jf.getName()+");\n");
+      }
+      hb.append("}\n");
+      hb.append("};\n");
+    }
+
     void genCode(FileWriter hh, FileWriter cc, ArrayList<String> options)
       throws IOException {
       CodeBuffer hb = new CodeBuffer();
@@ -584,6 +844,8 @@ public class JRecord extends JCompType {
         CppType type = jf.getType();
         type.genGetSet(hb, name);
       }
+      genBinaryMethods(hb);
+      genColumnarClasses(hb);
       hb.append("}; // end record "+name+"\n");
       for (int i=ns.length-1; i>=0; i--) {
         hb.append("} // end namespace "+ns[i]+"\n");
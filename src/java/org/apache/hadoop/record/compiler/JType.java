@@ -159,6 +159,14 @@ abstract public class JType {
     void genClone(CodeBuffer cb, String fname) {
       cb.append(Consts.RIO_PREFIX + "other."+fname+" = this."+fname+";\n");
     }
+
+    /**
+     * The column that holds this type in a columnar batch, or null if
+     * values are serialized into an org.apache.hadoop.record.Column.Serialized.
+     */
+    String getColumnType() {
+      return null;
+    }
   }
   
   abstract class CppType {
@@ -196,6 +204,25 @@ abstract public class JType {
     String getType() {
       return name;
     }
+
+    /**
+     * The most bytes a value of this type takes in the binary format, or 0
+     * if that is not bounded. Runs of bounded fields are encoded with a
+     * single check of the output's capacity.
+     */
+    int getMaxBinarySize() {
+      return 0;
+    }
+
+    /** The serializer of this type in the binary format. */
+    String getBinaryType() {
+      return "::hadoop::BinaryType< "+name+" >";
+    }
+
+    /** The column that holds this type in a columnar batch. */
+    String getColumnType() {
+      return "::hadoop::SerializedColumn< "+name+" >";
+    }
   }
   
   class CType {
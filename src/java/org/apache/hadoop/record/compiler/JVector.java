@@ -137,7 +137,7 @@ public class JVector extends JCompType {
       cb.append("int "+getId("vi")+
                 " = org.apache.hadoop.record.Utils.readVInt("+b+", "+s+");\n");
       cb.append("int "+getId("vz")+
-                " = org.apache.hadoop.record.Utils.getVIntSize("+getId("vi")+");\n");
+                " = org.apache.hadoop.record.Utils.decodeVIntSize("+b+"["+s+"]);\n");
       cb.append(s+"+="+getId("vz")+"; "+l+"-="+getId("vz")+";\n");
       cb.append("for (int "+getId("vidx")+" = 0; "+getId("vidx")+
                 " < "+getId("vi")+"; "+getId("vidx")+"++)");
@@ -154,9 +154,9 @@ public class JVector extends JCompType {
       cb.append("int "+getId("vi2")+
                 " = org.apache.hadoop.record.Utils.readVInt(b2, s2);\n");
       cb.append("int "+getId("vz1")+
-                " = org.apache.hadoop.record.Utils.getVIntSize("+getId("vi1")+");\n");
+                " = org.apache.hadoop.record.Utils.decodeVIntSize(b1[s1]);\n");
       cb.append("int "+getId("vz2")+
-                " = org.apache.hadoop.record.Utils.getVIntSize("+getId("vi2")+");\n");
+                " = org.apache.hadoop.record.Utils.decodeVIntSize(b2[s2]);\n");
       cb.append("s1+="+getId("vz1")+"; s2+="+getId("vz2")+
                 "; l1-="+getId("vz1")+"; l2-="+getId("vz2")+";\n");
       cb.append("for (int "+getId("vidx")+" = 0; "+getId("vidx")+
@@ -43,10 +43,13 @@ import org.apache.hadoop.classification.InterfaceStability;
 @InterfaceStability.Evolving
 public class SaslInputStream extends InputStream {
   public static final Log LOG = LogFactory.getLog(SaslInputStream.class);
+  /** The largest token buffer kept between packets */
+  private static final int MAX_TOKEN_BUFFER = 64 * 1024;
 
   private final DataInputStream inStream;
   /*
-   * data read from the underlying input stream before being processed by SASL
+   * data read from the underlying input stream before being processed by
+   * SASL, reused for the following packets unless it is large
    */
   private byte[] saslToken;
   private final SaslClient saslClient;
@@ -84,21 +87,31 @@ public class SaslInputStream extends InputStream {
    * but could have more later), or -1 (absolutely no more data)
    */
   private int readMoreData() throws IOException {
+    int length;
     try {
       inStream.readFully(lengthBuf);
-      int length = unsignedBytesToInt(lengthBuf);
+      length = unsignedBytesToInt(lengthBuf);
       if (LOG.isDebugEnabled())
         LOG.debug("Actual length is " + length);
-      saslToken = new byte[length];
-      inStream.readFully(saslToken);
+      if (length < 0) {
+        throw new IOException("Invalid SASL token length " + length);
+      }
+      if (saslToken == null || saslToken.length < length) {
+        saslToken = new byte[length];
+      }
+      inStream.readFully(saslToken, 0, length);
     } catch (EOFException e) {
       return -1;
     }
+    byte[] token = saslToken;
+    if (token.length > MAX_TOKEN_BUFFER) {
+      saslToken = null;
+    }
     try {
       if (saslServer != null) { // using saslServer
-        obuffer = saslServer.unwrap(saslToken, 0, saslToken.length);
+        obuffer = saslServer.unwrap(token, 0, length);
       } else { // using saslClient
-        obuffer = saslClient.unwrap(saslToken, 0, saslToken.length);
+        obuffer = saslClient.unwrap(token, 0, length);
       }
     } catch (SaslException se) {
       try {
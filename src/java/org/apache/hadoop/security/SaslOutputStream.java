@@ -18,7 +18,6 @@
 
 package org.apache.hadoop.security;
 
-import java.io.DataOutputStream;
 import java.io.IOException;
 import java.io.OutputStream;
 
@@ -38,10 +37,17 @@ import org.apache.hadoop.classification.InterfaceStability;
 @InterfaceAudience.LimitedPrivate({"HDFS", "MapReduce"})
 @InterfaceStability.Evolving
 public class SaslOutputStream extends OutputStream {
+  /** The largest length and token that are copied to be written at once */
+  private static final int MAX_FRAME_SIZE = 64 * 1024;
 
-  private final DataOutputStream outStream;
+  private final OutputStream outStream;
   // processed data ready to be written out
   private byte[] saslToken;
+  /*
+   * the length and token of a packet, so that small packets are written
+   * to the underlying stream with a single write
+   */
+  private byte[] frame = new byte[4];
 
   private final SaslClient saslClient;
   private final SaslServer saslServer;
@@ -59,7 +65,7 @@ public class SaslOutputStream extends OutputStream {
    *          an initialized SaslServer object
    */
   public SaslOutputStream(OutputStream outStream, SaslServer saslServer) {
-    this.outStream = new DataOutputStream(outStream);
+    this.outStream = outStream;
     this.saslServer = saslServer;
     this.saslClient = null;
   }
@@ -75,7 +81,7 @@ public class SaslOutputStream extends OutputStream {
    *          an initialized SaslClient object
    */
   public SaslOutputStream(OutputStream outStream, SaslClient saslClient) {
-    this.outStream = new DataOutputStream(outStream);
+    this.outStream = outStream;
     this.saslServer = null;
     this.saslClient = saslClient;
   }
@@ -156,12 +162,38 @@ public class SaslOutputStream extends OutputStream {
       throw se;
     }
     if (saslToken != null) {
-      outStream.writeInt(saslToken.length);
-      outStream.write(saslToken, 0, saslToken.length);
+      writeFrame(saslToken);
       saslToken = null;
     }
   }
 
+  /** Write a token, preceded by its length. */
+  private void writeFrame(byte[] token) throws IOException {
+    int length = token.length;
+    int frameLength = length + 4;
+    if (frameLength > MAX_FRAME_SIZE) {
+      // too large for a copy to save anything
+      putLength(frame, length);
+      outStream.write(frame, 0, 4);
+      outStream.write(token, 0, length);
+      return;
+    }
+    if (frame.length < frameLength) {
+      frame = new byte[Math.min(MAX_FRAME_SIZE,
+                                Math.max(frameLength, 2 * frame.length))];
+    }
+    putLength(frame, length);
+    System.arraycopy(token, 0, frame, 4, length);
+    outStream.write(frame, 0, frameLength);
+  }
+
+  private static void putLength(byte[] buf, int length) {
+    buf[0] = (byte) (length >>> 24);
+    buf[1] = (byte) (length >>> 16);
+    buf[2] = (byte) (length >>> 8);
+    buf[3] = (byte) length;
+  }
+
   /**
    * Flushes this output stream
    * 
@@ -17,11 +17,11 @@
  */
 package org.apache.hadoop.util;
 
+import java.io.File;
 import java.io.IOException;
 import java.util.ArrayList;
 import java.util.HashMap;
 import java.util.List;
-import java.util.Map;
 import java.util.concurrent.LinkedBlockingQueue;
 import java.util.concurrent.ThreadFactory;
 import java.util.concurrent.ThreadPoolExecutor;
@@ -30,6 +30,7 @@ import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
 import org.apache.hadoop.classification.InterfaceAudience;
 import org.apache.hadoop.classification.InterfaceStability;
+import org.apache.hadoop.fs.ParallelFileTree;
 
 /*
  * This class is a container of multiple thread pools, each for a volume,
@@ -51,6 +52,8 @@ public class AsyncDiskService {
   private static final int MAXIMUM_THREADS_PER_VOLUME = 4;
   // ThreadPool keep-alive time for threads over core pool size
   private static final long THREADS_KEEP_ALIVE_SECONDS = 60; 
+  /** Default number of threads per volume walking trees for deleteTree */
+  public static final int DEFAULT_DELETE_THREADS_PER_VOLUME = 4;
   
   private final ThreadGroup threadGroup = new ThreadGroup("async disk service");
   
@@ -58,6 +61,13 @@ public class AsyncDiskService {
   
   private HashMap<String, ThreadPoolExecutor> executors
       = new HashMap<String, ThreadPoolExecutor>();
+
+  // the ThreadPools of deleteTree, apart so that execute() keeps its order
+  private HashMap<String, ThreadPoolExecutor> deleters
+      = new HashMap<String, ThreadPoolExecutor>();
+
+  private HashMap<String, ParallelFileTree> trees
+      = new HashMap<String, ParallelFileTree>();
   
   /**
    * Create a AsyncDiskServices with a set of volumes (specified by their
@@ -69,6 +79,27 @@ public class AsyncDiskService {
    * @param volumes The roots of the file system volumes.
    */
   public AsyncDiskService(String[] volumes) throws IOException {
+    this(volumes, DEFAULT_DELETE_THREADS_PER_VOLUME);
+  }
+
+  /**
+   * Create a AsyncDiskServices with a set of volumes (specified by their
+   * root directories).
+   * 
+   * Besides the ThreadPool per volume for {@link #execute(String, Runnable)},
+   * each volume has a ThreadPool of its own for
+   * {@link #deleteTree(String, File)}.
+   * 
+   * @param volumes The roots of the file system volumes.
+   * @param deleteThreadsPerVolume The number of threads per volume that
+   *        walk the trees being deleted.
+   */
+  public AsyncDiskService(String[] volumes, int deleteThreadsPerVolume)
+      throws IOException {
+    if (deleteThreadsPerVolume < 1) {
+      throw new IllegalArgumentException(
+          "deleteThreadsPerVolume: " + deleteThreadsPerVolume);
+    }
     
     threadFactory = new ThreadFactory() {
       public Thread newThread(Runnable r) {
@@ -86,6 +117,17 @@ public class AsyncDiskService {
       // This can reduce the number of running threads
       executor.allowCoreThreadTimeOut(true);
       executors.put(volumes[v], executor);
+
+      // With an unbounded queue a pool never grows past its core size, so
+      // all the delete threads are core threads, and time out when idle.
+      ThreadPoolExecutor deleter = new ThreadPoolExecutor(
+          deleteThreadsPerVolume, deleteThreadsPerVolume,
+          THREADS_KEEP_ALIVE_SECONDS, TimeUnit.SECONDS,
+          new LinkedBlockingQueue<Runnable>(), threadFactory);
+      deleter.allowCoreThreadTimeOut(true);
+      deleters.put(volumes[v], deleter);
+      trees.put(volumes[v],
+          new ParallelFileTree(deleter, deleteThreadsPerVolume));
     }
     
   }
@@ -103,6 +145,38 @@ public class AsyncDiskService {
     }
   }
   
+  /**
+   * Delete a directory tree sometime in the future. The tree is walked by
+   * up to all the threads of the volume's delete ThreadPool; trees on
+   * different volumes are deleted concurrently. Deletions do not hold up
+   * the tasks given to {@link #execute(String, Runnable)}.
+   *
+   * @param root the volume holding the tree
+   * @param dir the directory to delete
+   */
+  public synchronized void deleteTree(String root, final File dir) {
+    final ParallelFileTree tree = trees.get(root);
+    if (tree == null) {
+      throw new RuntimeException("Cannot find root " + root
+          + " for deletion of " + dir);
+    }
+    deleters.get(root).execute(new Runnable() {
+      public void run() {
+        try {
+          if (!tree.fullyDelete(dir)) {
+            LOG.warn("Failed to fully delete " + dir);
+          }
+        } catch (IOException e) {
+          LOG.warn("Failed to delete " + dir, e);
+        }
+      }
+
+      public String toString() {
+        return "deletion of " + dir;
+      }
+    });
+  }
+
   /**
    * Gracefully start the shut down of all ThreadPools.
    */
@@ -110,9 +184,8 @@ public class AsyncDiskService {
     
     LOG.info("Shutting down all AsyncDiskService threads...");
     
-    for (Map.Entry<String, ThreadPoolExecutor> e
-        : executors.entrySet()) {
-      e.getValue().shutdown();
+    for (ThreadPoolExecutor executor : getAllExecutors()) {
+      executor.shutdown();
     }
   }
 
@@ -127,9 +200,7 @@ public class AsyncDiskService {
       throws InterruptedException {
 
     long end = System.currentTimeMillis() + milliseconds;
-    for (Map.Entry<String, ThreadPoolExecutor> e:
-        executors.entrySet()) {
-      ThreadPoolExecutor executor = e.getValue();
+    for (ThreadPoolExecutor executor : getAllExecutors()) {
       if (!executor.awaitTermination(
           Math.max(end - System.currentTimeMillis(), 0),
           TimeUnit.MILLISECONDS)) {
@@ -149,11 +220,17 @@ public class AsyncDiskService {
     LOG.info("Shutting down all AsyncDiskService threads immediately...");
     
     List<Runnable> list = new ArrayList<Runnable>();
-    for (Map.Entry<String, ThreadPoolExecutor> e
-        : executors.entrySet()) {
-      list.addAll(e.getValue().shutdownNow());
+    for (ThreadPoolExecutor executor : getAllExecutors()) {
+      list.addAll(executor.shutdownNow());
     }
     return list;
   }
+
+  private List<ThreadPoolExecutor> getAllExecutors() {
+    List<ThreadPoolExecutor> all =
+      new ArrayList<ThreadPoolExecutor>(executors.values());
+    all.addAll(deleters.values());
+    return all;
+  }
   
 }
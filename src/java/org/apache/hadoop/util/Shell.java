@@ -31,6 +31,7 @@ import org.apache.commons.logging.LogFactory;
 import org.apache.hadoop.classification.InterfaceAudience;
 import org.apache.hadoop.classification.InterfaceStability;
 import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.io.nativeio.NativeProcess;
 
 /** 
  * A base class for running a Unix command.
@@ -137,6 +138,27 @@ abstract public class Shell {
   /** Set to true on Windows platforms */
   public static final boolean WINDOWS /* borrowed from Path.WINDOWS */
                 = System.getProperty("os.name").startsWith("Windows");
+
+  /** Whether commands are started by the native launcher */
+  private static volatile boolean useNativeLauncher =
+    !WINDOWS && NativeProcess.isNativeLoaded();
+
+  /**
+   * Set whether commands are started by {@link NativeProcess} rather than
+   * {@link ProcessBuilder}, which forks the whole JVM. The native launcher
+   * is used by default when libhadoop is loaded.
+   *
+   * @param use whether to use the native launcher; ignored if it is not
+   *        available
+   */
+  public static void setUseNativeLauncher(boolean use) {
+    useNativeLauncher = use && !WINDOWS && NativeProcess.isNativeLoaded();
+  }
+
+  /** @return whether commands are started by the native launcher */
+  public static boolean isUsingNativeLauncher() {
+    return useNativeLauncher;
+  }
   
   private long    interval;   // refresh interval in msec
   private long    lastTime;   // last time the command was performed
@@ -185,20 +207,23 @@ abstract public class Shell {
 
   /** Run a command */
   private void runCommand() throws IOException { 
-    ProcessBuilder builder = new ProcessBuilder(getExecString());
     Timer timeOutTimer = null;
     ShellTimeoutTimerTask timeoutTimerTask = null;
     timedOut = new AtomicBoolean(false);
     completed = new AtomicBoolean(false);
     
-    if (environment != null) {
-      builder.environment().putAll(this.environment);
-    }
-    if (dir != null) {
-      builder.directory(this.dir);
+    if (useNativeLauncher) {
+      process = NativeProcess.start(getExecString(), environment, dir);
+    } else {
+      ProcessBuilder builder = new ProcessBuilder(getExecString());
+      if (environment != null) {
+        builder.environment().putAll(this.environment);
+      }
+      if (dir != null) {
+        builder.directory(this.dir);
+      }
+      process = builder.start();
     }
-    
-    process = builder.start();
     if (timeOutInterval > 0) {
       timeOutTimer = new Timer();
       timeoutTimerTask = new ShellTimeoutTimerTask(
@@ -0,0 +1,82 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Helpers shared by the record I/O benchmarks.
+ */
+
+#ifndef BENCH_HH_
+#define BENCH_HH_
+
+#include <stdint.h>
+#include <time.h>
+#include <string>
+
+/** The generator of java.util.Random. */
+class JavaRandom {
+public:
+  explicit JavaRandom(int64_t seed) { setSeed(seed); }
+
+  void setSeed(int64_t seed) {
+    seed_ = (seed ^ MULTIPLIER) & MASK;
+  }
+
+  int32_t nextInt() { return next(32); }
+
+  int32_t nextInt(int32_t n) {
+    if ((n & -n) == n) {
+      return static_cast<int32_t>((n * static_cast<int64_t>(next(31))) >> 31);
+    }
+    int32_t bits, val;
+    do {
+      bits = next(31);
+      val = bits % n;
+    } while (static_cast<int32_t>(
+               static_cast<uint32_t>(bits) - val + (n - 1)) < 0);
+    return val;
+  }
+
+  void nextBytes(std::string& bytes, size_t len) {
+    bytes.resize(len);
+    for (size_t i = 0; i < len; ) {
+      int32_t rnd = nextInt();
+      for (size_t n = len - i < 4 ? len - i : 4; n > 0; n--, rnd >>= 8) {
+        bytes[i++] = static_cast<char>(rnd);
+      }
+    }
+  }
+
+private:
+  static const int64_t MULTIPLIER = 0x5DEECE66DLL;
+  static const int64_t MASK = (1LL << 48) - 1;
+  int64_t seed_;
+
+  int32_t next(int bits) {
+    seed_ = (seed_ * MULTIPLIER + 0xBLL) & MASK;
+    return static_cast<int32_t>(seed_ >> (48 - bits));
+  }
+};
+
+inline int64_t nanoTime()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+#endif // BENCH_HH_
@@ -0,0 +1,372 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "binarchive.hh"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace hadoop {
+
+OutputArena::OutputArena(size_t initialCapacity)
+  : buf_(NULL), size_(0), capacity_(0)
+{
+  if (initialCapacity > 0) {
+    grow(initialCapacity);
+  }
+}
+
+OutputArena::~OutputArena()
+{
+  free(buf_);
+}
+
+void OutputArena::grow(size_t n)
+{
+  size_t capacity = capacity_ == 0 ? 256 : capacity_;
+  while (capacity - size_ < n) {
+    capacity *= 2;
+  }
+  char* buf = static_cast<char*>(realloc(buf_, capacity));
+  if (buf == NULL) {
+    throw IOException("Out of memory growing output arena");
+  }
+  buf_ = buf;
+  capacity_ = capacity;
+}
+
+void OutputArena::append(const void* data, size_t n)
+{
+  memcpy(reserve(n), data, n);
+  size_ += n;
+}
+
+class IBinArchive::BinIndex : public Index {
+public:
+  size_t remaining;
+
+  BinIndex() : remaining(0) {}
+  virtual bool done() { return remaining == 0; }
+  virtual void incr() { remaining--; }
+};
+
+IBinArchive::IBinArchive(InStream& stream, size_t bufferSize)
+  : stream_(&stream), start_(NULL), pos_(NULL), end_(NULL), buf_(NULL),
+    bufCapacity_(bufferSize > 0 ? bufferSize : 1), consumed_(0)
+{
+  buf_ = static_cast<char*>(malloc(bufCapacity_));
+  if (buf_ == NULL) {
+    throw IOException("Out of memory allocating input buffer");
+  }
+  start_ = pos_ = end_ = buf_;
+}
+
+IBinArchive::IBinArchive(const void* data, size_t len)
+  : stream_(NULL), start_(NULL), pos_(NULL), end_(NULL), buf_(NULL),
+    bufCapacity_(0), consumed_(0)
+{
+  reset(data, len);
+}
+
+IBinArchive::~IBinArchive()
+{
+  for (size_t i = 0; i < freeIndices_.size(); i++) {
+    delete freeIndices_[i];
+  }
+  free(buf_);
+}
+
+void IBinArchive::reset(const void* data, size_t len)
+{
+  stream_ = NULL;
+  start_ = pos_ = static_cast<const char*>(data);
+  end_ = start_ + len;
+  consumed_ = 0;
+}
+
+void IBinArchive::fill(size_t n)
+{
+  if (stream_ == NULL) {
+    throw IOException("Unexpected end of input");
+  }
+  size_t remaining = end_ - pos_;
+  consumed_ += pos_ - start_;
+  if (n > bufCapacity_) {
+    size_t capacity = bufCapacity_ * 2 > n ? bufCapacity_ * 2 : n;
+    char* buf = static_cast<char*>(malloc(capacity));
+    if (buf == NULL) {
+      throw IOException("Out of memory growing input buffer");
+    }
+    memcpy(buf, pos_, remaining);
+    free(buf_);
+    buf_ = buf;
+    bufCapacity_ = capacity;
+  } else {
+    memmove(buf_, pos_, remaining);
+  }
+  start_ = pos_ = buf_;
+  end_ = buf_ + remaining;
+  while (remaining < n) {
+    ssize_t read = stream_->read(buf_ + remaining, bufCapacity_ - remaining);
+    if (read < 0) {
+      throw IOException("Error reading from stream");
+    }
+    if (read == 0) {
+      throw IOException("Unexpected end of input");
+    }
+    remaining += read;
+    end_ = buf_ + remaining;
+  }
+}
+
+void IBinArchive::skipSlow(size_t n)
+{
+  for (;;) {
+    size_t available = end_ - pos_;
+    if (n <= available) {
+      pos_ += n;
+      return;
+    }
+    pos_ = end_;
+    n -= available;
+    fill(n < bufCapacity_ ? n : bufCapacity_);
+  }
+}
+
+bool IBinArchive::atEnd()
+{
+  if (pos_ < end_) {
+    return false;
+  }
+  if (stream_ == NULL) {
+    return true;
+  }
+  consumed_ += pos_ - start_;
+  start_ = pos_ = end_ = buf_;
+  ssize_t read = stream_->read(buf_, bufCapacity_);
+  if (read < 0) {
+    throw IOException("Error reading from stream");
+  }
+  end_ = buf_ + read;
+  return read == 0;
+}
+
+Index* IBinArchive::newIndex(size_t count)
+{
+  BinIndex* idx;
+  if (freeIndices_.empty()) {
+    idx = new BinIndex();
+  } else {
+    idx = freeIndices_.back();
+    freeIndices_.pop_back();
+  }
+  idx->remaining = count;
+  return idx;
+}
+
+void IBinArchive::deserialize(int8_t& t, const char* tag)
+{
+  t = readByte();
+}
+
+void IBinArchive::deserialize(bool& t, const char* tag)
+{
+  t = readBool();
+}
+
+void IBinArchive::deserialize(int32_t& t, const char* tag)
+{
+  t = readVInt();
+}
+
+void IBinArchive::deserialize(int64_t& t, const char* tag)
+{
+  t = readVLong();
+}
+
+void IBinArchive::deserialize(float& t, const char* tag)
+{
+  t = readFloat();
+}
+
+void IBinArchive::deserialize(double& t, const char* tag)
+{
+  t = readDouble();
+}
+
+void IBinArchive::deserialize(std::string& t, const char* tag)
+{
+  readBytes(t);
+}
+
+void IBinArchive::deserialize(std::string& t, size_t& len, const char* tag)
+{
+  readBytes(t);
+  len = t.length();
+}
+
+void IBinArchive::startRecord(Record& s, const char* tag) {}
+
+void IBinArchive::endRecord(Record& s, const char* tag) {}
+
+Index* IBinArchive::startVector(const char* tag)
+{
+  return newIndex(readLength());
+}
+
+void IBinArchive::endVector(Index* idx, const char* tag)
+{
+  freeIndices_.push_back(static_cast<BinIndex*>(idx));
+}
+
+Index* IBinArchive::startMap(const char* tag)
+{
+  return newIndex(readLength());
+}
+
+void IBinArchive::endMap(Index* idx, const char* tag)
+{
+  freeIndices_.push_back(static_cast<BinIndex*>(idx));
+}
+
+OBinArchive::OBinArchive(OutStream& stream, size_t bufferSize)
+  : stream_(&stream), arena_(NULL), ownArena_(NULL),
+    flushThreshold_(bufferSize)
+{
+  ownArena_ = new OutputArena(bufferSize + VLONG_MAX_SIZE);
+  arena_ = ownArena_;
+}
+
+OBinArchive::OBinArchive(OutputArena& arena)
+  : stream_(NULL), arena_(&arena), ownArena_(NULL), flushThreshold_(0)
+{
+}
+
+OBinArchive::~OBinArchive()
+{
+  try {
+    flush();
+  } catch (const IOException&) {
+  }
+  delete ownArena_;
+}
+
+void OBinArchive::flush()
+{
+  if (stream_ == NULL) {
+    return;
+  }
+  const char* p = arena_->data();
+  size_t remaining = arena_->size();
+  arena_->clear();
+  while (remaining > 0) {
+    ssize_t written = stream_->write(p, remaining);
+    if (written <= 0) {
+      throw IOException("Error writing to stream");
+    }
+    p += written;
+    remaining -= written;
+  }
+}
+
+void OBinArchive::writeThrough(const char* data, size_t len)
+{
+  // Large values go straight to the stream rather than through the arena.
+  flush();
+  while (len > 0) {
+    ssize_t written = stream_->write(data, len);
+    if (written <= 0) {
+      throw IOException("Error writing to stream");
+    }
+    data += written;
+    len -= written;
+  }
+}
+
+void OBinArchive::serialize(int8_t t, const char* tag)
+{
+  writeByte(t);
+}
+
+void OBinArchive::serialize(bool t, const char* tag)
+{
+  writeBool(t);
+}
+
+void OBinArchive::serialize(int32_t t, const char* tag)
+{
+  writeVLong(t);
+}
+
+void OBinArchive::serialize(int64_t t, const char* tag)
+{
+  writeVLong(t);
+}
+
+void OBinArchive::serialize(float t, const char* tag)
+{
+  writeFloat(t);
+}
+
+void OBinArchive::serialize(double t, const char* tag)
+{
+  writeDouble(t);
+}
+
+void OBinArchive::serialize(const std::string& t, const char* tag)
+{
+  serializeBytes(t.data(), t.length(), tag);
+}
+
+void OBinArchive::serialize(const std::string& t, size_t len,
+                            const char* tag)
+{
+  if (len > t.length()) {
+    throw IOException("Buffer length exceeds its contents");
+  }
+  serializeBytes(t.data(), len, tag);
+}
+
+void OBinArchive::startRecord(const Record& s, const char* tag) {}
+
+void OBinArchive::endRecord(const Record& s, const char* tag)
+{
+  checkFlush();
+}
+
+void OBinArchive::startVector(size_t len, const char* tag)
+{
+  writeLength(len);
+}
+
+void OBinArchive::endVector(size_t len, const char* tag)
+{
+  checkFlush();
+}
+
+void OBinArchive::startMap(size_t len, const char* tag)
+{
+  writeLength(len);
+}
+
+void OBinArchive::endMap(size_t len, const char* tag)
+{
+  checkFlush();
+}
+
+} // namespace hadoop
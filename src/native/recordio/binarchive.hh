@@ -0,0 +1,454 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BINARCHIVE_HH_
+#define BINARCHIVE_HH_
+
+#include "recordio.hh"
+
+#include <string.h>
+
+namespace hadoop {
+
+/*
+ * Encoders and decoders of the binary format's scalars, on raw bytes.
+ * The encoders write at most VLONG_MAX_SIZE, 4 or 8 bytes and return the
+ * end of what they wrote. The decoders advance p, and throw IOException
+ * rather than read past end.
+ */
+
+static const size_t VLONG_MAX_SIZE = 9;
+
+/** Write a long as org.apache.hadoop.io.WritableUtils.writeVLong does. */
+inline char* encodeVLong(char* p, int64_t i)
+{
+  if (i >= -112 && i <= 127) {
+    *p++ = static_cast<char>(i);
+    return p;
+  }
+  uint64_t u = static_cast<uint64_t>(i);
+  int len = -112;
+  if (i < 0) {
+    u = ~u;
+    len = -120;
+  }
+  for (uint64_t tmp = u; tmp != 0; tmp >>= 8) {
+    len--;
+  }
+  *p++ = static_cast<char>(len);
+  for (int shift = ((len < -120 ? -(len + 120) : -(len + 112)) - 1) * 8;
+       shift >= 0; shift -= 8) {
+    *p++ = static_cast<char>(u >> shift);
+  }
+  return p;
+}
+
+inline char* encodeFloat(char* p, float t)
+{
+  uint32_t bits;
+  memcpy(&bits, &t, sizeof(bits));
+  p[0] = static_cast<char>(bits >> 24);
+  p[1] = static_cast<char>(bits >> 16);
+  p[2] = static_cast<char>(bits >> 8);
+  p[3] = static_cast<char>(bits);
+  return p + 4;
+}
+
+inline char* encodeDouble(char* p, double t)
+{
+  uint64_t bits;
+  memcpy(&bits, &t, sizeof(bits));
+  for (int i = 7; i >= 0; i--) {
+    p[i] = static_cast<char>(bits);
+    bits >>= 8;
+  }
+  return p + 8;
+}
+
+inline void checkAvailable(const char* p, const char* end, size_t n)
+{
+  if (static_cast<size_t>(end - p) < n) {
+    throw IOException("Unexpected end of input");
+  }
+}
+
+/** The total size of a varint, from its first byte. */
+inline size_t decodeVLongSize(int8_t first)
+{
+  if (first >= -112) {
+    return 1;
+  }
+  return first >= -120 ? -111 - first : -119 - first;
+}
+
+inline int64_t decodeVLong(const char*& p, const char* end)
+{
+  checkAvailable(p, end, 1);
+  int8_t first = static_cast<int8_t>(*p);
+  size_t len = decodeVLongSize(first);
+  if (len == 1) {
+    p++;
+    return first;
+  }
+  checkAvailable(p, end, len);
+  uint64_t i = 0;
+  for (size_t idx = 1; idx < len; idx++) {
+    i = (i << 8) | static_cast<uint8_t>(p[idx]);
+  }
+  p += len;
+  return static_cast<int64_t>(first < -120 ? ~i : i);
+}
+
+inline int32_t decodeVInt(const char*& p, const char* end)
+{
+  int64_t i = decodeVLong(p, end);
+  if (i > 0x7fffffffLL || i < -0x7fffffffLL - 1) {
+    throw IOException("Value too long to fit in integer");
+  }
+  return static_cast<int32_t>(i);
+}
+
+inline float decodeFloat(const char*& p, const char* end)
+{
+  checkAvailable(p, end, 4);
+  const uint8_t* b = reinterpret_cast<const uint8_t*>(p);
+  uint32_t bits = (static_cast<uint32_t>(b[0]) << 24) |
+    (static_cast<uint32_t>(b[1]) << 16) |
+    (static_cast<uint32_t>(b[2]) << 8) | b[3];
+  float t;
+  memcpy(&t, &bits, sizeof(t));
+  p += 4;
+  return t;
+}
+
+inline double decodeDouble(const char*& p, const char* end)
+{
+  checkAvailable(p, end, 8);
+  const uint8_t* b = reinterpret_cast<const uint8_t*>(p);
+  uint64_t bits = 0;
+  for (int i = 0; i < 8; i++) {
+    bits = (bits << 8) | b[i];
+  }
+  double t;
+  memcpy(&t, &bits, sizeof(t));
+  p += 8;
+  return t;
+}
+
+/** Decode the length of a ustring, buffer, vector or map. */
+inline size_t decodeLength(const char*& p, const char* end)
+{
+  int32_t len = decodeVInt(p, end);
+  if (len < 0) {
+    throw IOException("Negative length");
+  }
+  return static_cast<size_t>(len);
+}
+
+/**
+ * A growable byte buffer. clear() keeps the memory, so an arena reused
+ * across records stops allocating once it has grown to the largest one.
+ */
+class OutputArena {
+public:
+  explicit OutputArena(size_t initialCapacity = 4096);
+  ~OutputArena();
+
+  /** Get room for at least n more bytes; commit() what was written. */
+  char* reserve(size_t n) {
+    if (capacity_ - size_ < n) {
+      grow(n);
+    }
+    return buf_ + size_;
+  }
+  void commit(size_t n) { size_ += n; }
+  void append(const void* data, size_t n);
+
+  const char* data() const { return buf_; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  void clear() { size_ = 0; }
+
+private:
+  char* buf_;
+  size_t size_;
+  size_t capacity_;
+
+  void grow(size_t n);
+  OutputArena(const OutputArena&);
+  OutputArena& operator=(const OutputArena&);
+};
+
+/**
+ * Bytes of a ustring or buffer inside an archive's input.
+ */
+struct BufferView {
+  const char* data;
+  size_t length;
+
+  BufferView() : data(NULL), length(0) {}
+  std::string toString() const { return std::string(data, length); }
+};
+
+/**
+ * Reads the format of org.apache.hadoop.record.BinaryRecordInput: ints
+ * and longs as zero-compressed varints, floats and doubles as big-endian
+ * IEEE 754, and ustrings, buffers, vectors and maps prefixed with a varint
+ * length.
+ *
+ * The input is either an in-memory span, read in place, or an InStream
+ * read through an internal buffer. readView() returns a ustring or buffer
+ * without copying it: over a span the view stays valid as long as the span
+ * does; over a stream, only until the next read.
+ *
+ * The read methods are the non-virtual, inline form of deserialize(), for
+ * the serializers of binserializer.hh.
+ */
+class IBinArchive : public IArchive {
+public:
+  explicit IBinArchive(InStream& stream, size_t bufferSize = 65536);
+  IBinArchive(const void* data, size_t len);
+  virtual ~IBinArchive();
+
+  int8_t readByte() {
+    require(1);
+    return static_cast<int8_t>(*pos_++);
+  }
+  bool readBool() {
+    require(1);
+    return *pos_++ != 0;
+  }
+  int64_t readVLong() {
+    if (pos_ < end_ && static_cast<int8_t>(*pos_) >= -112) {
+      return static_cast<int8_t>(*pos_++);
+    }
+    require(decodeVLongSize(peek()));
+    return decodeVLong(pos_, end_);
+  }
+  int32_t readVInt() {
+    if (pos_ < end_ && static_cast<int8_t>(*pos_) >= -112) {
+      return static_cast<int8_t>(*pos_++);
+    }
+    require(decodeVLongSize(peek()));
+    return decodeVInt(pos_, end_);
+  }
+  float readFloat() {
+    require(4);
+    return decodeFloat(pos_, end_);
+  }
+  double readDouble() {
+    require(8);
+    return decodeDouble(pos_, end_);
+  }
+  /** Read the length of a ustring, buffer, vector or map. */
+  size_t readLength() {
+    int32_t len = readVInt();
+    if (len < 0) {
+      throw IOException("Negative length");
+    }
+    return static_cast<size_t>(len);
+  }
+  /** Read a ustring or buffer as a view over the input. */
+  void readView(BufferView& view) {
+    size_t len = readLength();
+    require(len);
+    view.data = pos_;
+    view.length = len;
+    pos_ += len;
+  }
+  void readBytes(std::string& t) {
+    BufferView view;
+    readView(view);
+    t.assign(view.data, view.length);
+  }
+  /** Skip n bytes of input. */
+  void skip(size_t n) {
+    if (static_cast<size_t>(end_ - pos_) >= n) {
+      pos_ += n;
+    } else {
+      skipSlow(n);
+    }
+  }
+
+  using IArchive::deserialize;
+  virtual void deserialize(int8_t& t, const char* tag);
+  virtual void deserialize(bool& t, const char* tag);
+  virtual void deserialize(int32_t& t, const char* tag);
+  virtual void deserialize(int64_t& t, const char* tag);
+  virtual void deserialize(float& t, const char* tag);
+  virtual void deserialize(double& t, const char* tag);
+  virtual void deserialize(std::string& t, const char* tag);
+  virtual void deserialize(std::string& t, size_t& len, const char* tag);
+  virtual void startRecord(Record& s, const char* tag);
+  virtual void endRecord(Record& s, const char* tag);
+  virtual Index* startVector(const char* tag);
+  virtual void endVector(Index* idx, const char* tag);
+  virtual Index* startMap(const char* tag);
+  virtual void endMap(Index* idx, const char* tag);
+
+  /** Read a ustring or buffer as a view over the input. */
+  void deserializeView(BufferView& view, const char* /* tag */) {
+    readView(view);
+  }
+
+  /** Read from a new in-memory span, from its start. */
+  void reset(const void* data, size_t len);
+
+  /** The number of bytes read so far. */
+  uint64_t position() const {
+    return consumed_ + static_cast<uint64_t>(pos_ - start_);
+  }
+
+  /** Whether all input has been read. May read ahead from the stream. */
+  bool atEnd();
+
+private:
+  class BinIndex;
+
+  InStream* stream_;
+  const char* start_;
+  const char* pos_;
+  const char* end_;
+  char* buf_;
+  size_t bufCapacity_;
+  uint64_t consumed_;
+  std::vector<BinIndex*> freeIndices_;
+
+  int8_t peek() {
+    require(1);
+    return static_cast<int8_t>(*pos_);
+  }
+  void require(size_t n) {
+    if (static_cast<size_t>(end_ - pos_) < n) {
+      fill(n);
+    }
+  }
+  void fill(size_t n);
+  void skipSlow(size_t n);
+  Index* newIndex(size_t count);
+
+  IBinArchive(const IBinArchive&);
+  IBinArchive& operator=(const IBinArchive&);
+};
+
+/**
+ * Writes the format of org.apache.hadoop.record.BinaryRecordOutput.
+ *
+ * Bytes are appended to an OutputArena: either the caller's, which is
+ * never flushed, or an internal one that is written to an OutStream as it
+ * fills and on flush(). Nothing is allocated once the arena is large
+ * enough.
+ *
+ * The write methods are the non-virtual, inline form of serialize(), for
+ * the serializers of binserializer.hh. reserve() and commit() let them
+ * encode a run of scalars with a single check of the arena's capacity.
+ */
+class OBinArchive : public OArchive {
+public:
+  explicit OBinArchive(OutStream& stream, size_t bufferSize = 65536);
+  explicit OBinArchive(OutputArena& arena);
+  /** Flushes to the stream; errors are lost, so flush() first. */
+  virtual ~OBinArchive();
+
+  /** Get room for n bytes to encode into; commit() the bytes used. */
+  char* reserve(size_t n) { return arena_->reserve(n); }
+  void commit(size_t n) { arena_->commit(n); }
+
+  void writeByte(int8_t t) {
+    *reserve(1) = static_cast<char>(t);
+    commit(1);
+  }
+  void writeBool(bool t) {
+    *reserve(1) = t ? 1 : 0;
+    commit(1);
+  }
+  void writeVLong(int64_t t) {
+    char* p = reserve(VLONG_MAX_SIZE);
+    commit(encodeVLong(p, t) - p);
+  }
+  void writeFloat(float t) {
+    encodeFloat(reserve(4), t);
+    commit(4);
+  }
+  void writeDouble(double t) {
+    encodeDouble(reserve(8), t);
+    commit(8);
+  }
+  /** Write the length of a vector or map. */
+  void writeLength(size_t len) {
+    if (len > 0x7fffffffU) {
+      throw IOException("Length too long to fit in integer");
+    }
+    writeVLong(static_cast<int64_t>(len));
+  }
+  /** Write len bytes as a ustring or buffer. */
+  void writeBytes(const char* data, size_t len) {
+    writeLength(len);
+    if (stream_ != NULL && len >= flushThreshold_) {
+      writeThrough(data, len);
+    } else {
+      arena_->append(data, len);
+    }
+  }
+  /** Flush to the stream if enough is buffered. */
+  void checkFlush() {
+    if (stream_ != NULL && arena_->size() >= flushThreshold_) {
+      flush();
+    }
+  }
+
+  using OArchive::serialize;
+  virtual void serialize(int8_t t, const char* tag);
+  virtual void serialize(bool t, const char* tag);
+  virtual void serialize(int32_t t, const char* tag);
+  virtual void serialize(int64_t t, const char* tag);
+  virtual void serialize(float t, const char* tag);
+  virtual void serialize(double t, const char* tag);
+  virtual void serialize(const std::string& t, const char* tag);
+  virtual void serialize(const std::string& t, size_t len, const char* tag);
+  virtual void startRecord(const Record& s, const char* tag);
+  virtual void endRecord(const Record& s, const char* tag);
+  virtual void startVector(size_t len, const char* tag);
+  virtual void endVector(size_t len, const char* tag);
+  virtual void startMap(size_t len, const char* tag);
+  virtual void endMap(size_t len, const char* tag);
+
+  /** Write len bytes as a ustring or buffer. */
+  void serializeBytes(const char* data, size_t len, const char* /* tag */) {
+    writeBytes(data, len);
+    checkFlush();
+  }
+
+  /** Write buffered bytes to the stream. A no-op over a caller's arena. */
+  void flush();
+
+private:
+  OutStream* stream_;
+  OutputArena* arena_;
+  OutputArena* ownArena_;
+  size_t flushThreshold_;
+
+  void writeThrough(const char* data, size_t len);
+
+  OBinArchive(const OBinArchive&);
+  OBinArchive& operator=(const OBinArchive&);
+};
+
+} // namespace hadoop
+
+#endif // BINARCHIVE_HH_
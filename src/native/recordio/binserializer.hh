@@ -0,0 +1,336 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BINSERIALIZER_HH_
+#define BINSERIALIZER_HH_
+
+#include "binarchive.hh"
+
+namespace hadoop {
+
+/**
+ * Serialization of one field type in the binary format, resolved at
+ * compile time. rcc generates serializeBinary(), deserializeBinary(),
+ * compareRaw() and skipRaw() for each record in terms of these, so a
+ * record is read, written and compared without virtual calls.
+ *
+ * For each type T:
+ *   write(a, t)  append t to an OBinArchive
+ *   read(a, t)   read t from an IBinArchive
+ *   compare(b1, e1, b2, e2)
+ *                compare two serialized values in place, advancing b1 and
+ *                b2 past them if they are equal; negative, zero or
+ *                positive as the first sorts before, with or after the
+ *                second
+ *   skip(b, e)   advance b past a serialized value
+ * Scalars also have MAX_SIZE and put(p, t), which encodes t at p without
+ * a capacity check, so that a run of scalar fields needs one reserve().
+ *
+ * The order is that of the Java raw comparators: numbers by value,
+ * ustrings and buffers by unsigned bytes then length, vectors by element
+ * then length, maps by key then size, records by field.
+ *
+ * The unspecialized template is for generated records.
+ */
+template <typename T>
+struct BinaryType {
+  static void write(OBinArchive& a, const T& t) {
+    t.serializeBinary(a);
+  }
+  static void read(IBinArchive& a, T& t) {
+    t.deserializeBinary(a);
+  }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    return T::compareRaw(b1, e1, b2, e2);
+  }
+  static void skip(const char*& b, const char* e) {
+    T::skipRaw(b, e);
+  }
+};
+
+template <>
+struct BinaryType<int8_t> {
+  static const size_t MAX_SIZE = 1;
+  static char* put(char* p, int8_t t) {
+    *p = static_cast<char>(t);
+    return p + 1;
+  }
+  static void write(OBinArchive& a, int8_t t) { a.writeByte(t); }
+  static void read(IBinArchive& a, int8_t& t) { t = a.readByte(); }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    checkAvailable(b1, e1, 1);
+    checkAvailable(b2, e2, 1);
+    int r = static_cast<int8_t>(*b1++) - static_cast<int8_t>(*b2++);
+    return r;
+  }
+  static void skip(const char*& b, const char* e) {
+    checkAvailable(b, e, 1);
+    b++;
+  }
+};
+
+template <>
+struct BinaryType<bool> {
+  static const size_t MAX_SIZE = 1;
+  static char* put(char* p, bool t) {
+    *p = t ? 1 : 0;
+    return p + 1;
+  }
+  static void write(OBinArchive& a, bool t) { a.writeBool(t); }
+  static void read(IBinArchive& a, bool& t) { t = a.readBool(); }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    return BinaryType<int8_t>::compare(b1, e1, b2, e2);
+  }
+  static void skip(const char*& b, const char* e) {
+    BinaryType<int8_t>::skip(b, e);
+  }
+};
+
+template <>
+struct BinaryType<int64_t> {
+  static const size_t MAX_SIZE = VLONG_MAX_SIZE;
+  static char* put(char* p, int64_t t) { return encodeVLong(p, t); }
+  static void write(OBinArchive& a, int64_t t) { a.writeVLong(t); }
+  static void read(IBinArchive& a, int64_t& t) { t = a.readVLong(); }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    // Values in a single byte, the common case, compare as bytes.
+    if (b1 < e1 && b2 < e2 && static_cast<int8_t>(*b1) >= -112 &&
+        static_cast<int8_t>(*b2) >= -112) {
+      return static_cast<int8_t>(*b1++) - static_cast<int8_t>(*b2++);
+    }
+    int64_t i1 = decodeVLong(b1, e1);
+    int64_t i2 = decodeVLong(b2, e2);
+    return i1 < i2 ? -1 : (i1 == i2 ? 0 : 1);
+  }
+  static void skip(const char*& b, const char* e) {
+    checkAvailable(b, e, 1);
+    size_t len = decodeVLongSize(static_cast<int8_t>(*b));
+    checkAvailable(b, e, len);
+    b += len;
+  }
+};
+
+template <>
+struct BinaryType<int32_t> {
+  static const size_t MAX_SIZE = 5;
+  static char* put(char* p, int32_t t) { return encodeVLong(p, t); }
+  static void write(OBinArchive& a, int32_t t) { a.writeVLong(t); }
+  static void read(IBinArchive& a, int32_t& t) { t = a.readVInt(); }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    return BinaryType<int64_t>::compare(b1, e1, b2, e2);
+  }
+  static void skip(const char*& b, const char* e) {
+    BinaryType<int64_t>::skip(b, e);
+  }
+};
+
+template <>
+struct BinaryType<float> {
+  static const size_t MAX_SIZE = 4;
+  static char* put(char* p, float t) { return encodeFloat(p, t); }
+  static void write(OBinArchive& a, float t) { a.writeFloat(t); }
+  static void read(IBinArchive& a, float& t) { t = a.readFloat(); }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    float f1 = decodeFloat(b1, e1);
+    float f2 = decodeFloat(b2, e2);
+    return f1 < f2 ? -1 : (f2 < f1 ? 1 : 0);
+  }
+  static void skip(const char*& b, const char* e) {
+    checkAvailable(b, e, 4);
+    b += 4;
+  }
+};
+
+template <>
+struct BinaryType<double> {
+  static const size_t MAX_SIZE = 8;
+  static char* put(char* p, double t) { return encodeDouble(p, t); }
+  static void write(OBinArchive& a, double t) { a.writeDouble(t); }
+  static void read(IBinArchive& a, double& t) { t = a.readDouble(); }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    double d1 = decodeDouble(b1, e1);
+    double d2 = decodeDouble(b2, e2);
+    return d1 < d2 ? -1 : (d2 < d1 ? 1 : 0);
+  }
+  static void skip(const char*& b, const char* e) {
+    checkAvailable(b, e, 8);
+    b += 8;
+  }
+};
+
+/** Both ustrings and buffers. */
+template <>
+struct BinaryType<std::string> {
+  static void write(OBinArchive& a, const std::string& t) {
+    a.writeBytes(t.data(), t.length());
+  }
+  static void read(IBinArchive& a, std::string& t) { a.readBytes(t); }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    size_t l1 = decodeLength(b1, e1);
+    size_t l2 = decodeLength(b2, e2);
+    checkAvailable(b1, e1, l1);
+    checkAvailable(b2, e2, l2);
+    int r = memcmp(b1, b2, l1 < l2 ? l1 : l2);
+    if (r == 0 && l1 != l2) {
+      r = l1 < l2 ? -1 : 1;
+    }
+    b1 += l1;
+    b2 += l2;
+    return r;
+  }
+  static void skip(const char*& b, const char* e) {
+    size_t len = decodeLength(b, e);
+    checkAvailable(b, e, len);
+    b += len;
+  }
+};
+
+template <typename T>
+struct BinaryType<std::vector<T> > {
+  static void write(OBinArchive& a, const std::vector<T>& t) {
+    a.writeLength(t.size());
+    for (typename std::vector<T>::const_iterator it = t.begin();
+         it != t.end(); ++it) {
+      BinaryType<T>::write(a, *it);
+    }
+  }
+  static void read(IBinArchive& a, std::vector<T>& t) {
+    // Read over the existing elements so that their memory is reused.
+    size_t len = a.readLength();
+    if (t.size() > len) {
+      t.resize(len);
+    }
+    for (size_t i = 0; i < len; i++) {
+      if (i == t.size()) {
+        t.resize(i + 1);
+      }
+      BinaryType<T>::read(a, t[i]);
+    }
+  }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    size_t l1 = decodeLength(b1, e1);
+    size_t l2 = decodeLength(b2, e2);
+    for (size_t i = 0; i < l1 && i < l2; i++) {
+      int r = BinaryType<T>::compare(b1, e1, b2, e2);
+      if (r != 0) {
+        return r;
+      }
+    }
+    if (l1 != l2) {
+      return l1 < l2 ? -1 : 1;
+    }
+    return 0;
+  }
+  static void skip(const char*& b, const char* e) {
+    for (size_t len = decodeLength(b, e); len > 0; len--) {
+      BinaryType<T>::skip(b, e);
+    }
+  }
+};
+
+template <>
+struct BinaryType<std::vector<bool> > {
+  static void write(OBinArchive& a, const std::vector<bool>& t) {
+    a.writeLength(t.size());
+    for (size_t i = 0; i < t.size(); i++) {
+      a.writeBool(t[i]);
+    }
+  }
+  static void read(IBinArchive& a, std::vector<bool>& t) {
+    size_t len = a.readLength();
+    t.resize(len);
+    for (size_t i = 0; i < len; i++) {
+      t[i] = a.readBool();
+    }
+  }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    return BinaryType<std::vector<int8_t> >::compare(b1, e1, b2, e2);
+  }
+  static void skip(const char*& b, const char* e) {
+    BinaryType<std::vector<int8_t> >::skip(b, e);
+  }
+};
+
+template <typename K, typename V>
+struct BinaryType<std::map<K, V> > {
+  static void write(OBinArchive& a, const std::map<K, V>& t) {
+    a.writeLength(t.size());
+    for (typename std::map<K, V>::const_iterator it = t.begin();
+         it != t.end(); ++it) {
+      BinaryType<K>::write(a, it->first);
+      BinaryType<V>::write(a, it->second);
+    }
+  }
+  static void read(IBinArchive& a, std::map<K, V>& t) {
+    t.clear();
+    K key;
+    for (size_t len = a.readLength(); len > 0; len--) {
+      BinaryType<K>::read(a, key);
+      BinaryType<V>::read(a, t[key]);
+    }
+  }
+  static int compare(const char*& b1, const char* e1,
+                     const char*& b2, const char* e2) {
+    size_t l1 = decodeLength(b1, e1);
+    size_t l2 = decodeLength(b2, e2);
+    for (size_t i = 0; i < l1 && i < l2; i++) {
+      int r = BinaryType<K>::compare(b1, e1, b2, e2);
+      if (r != 0) {
+        return r;
+      }
+      BinaryType<V>::skip(b1, e1);
+      BinaryType<V>::skip(b2, e2);
+    }
+    if (l1 != l2) {
+      return l1 < l2 ? -1 : 1;
+    }
+    return 0;
+  }
+  static void skip(const char*& b, const char* e) {
+    for (size_t len = decodeLength(b, e); len > 0; len--) {
+      BinaryType<K>::skip(b, e);
+      BinaryType<V>::skip(b, e);
+    }
+  }
+};
+
+/**
+ * Compare two serialized records of type T, such as keys in a sort
+ * buffer, without deserializing them.
+ */
+template <typename T>
+int compareRaw(const void* b1, size_t l1, const void* b2, size_t l2)
+{
+  const char* p1 = static_cast<const char*>(b1);
+  const char* p2 = static_cast<const char*>(b2);
+  return BinaryType<T>::compare(p1, p1 + l1, p2, p2 + l2);
+}
+
+} // namespace hadoop
+
+#endif // BINSERIALIZER_HH_
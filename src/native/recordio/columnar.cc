@@ -0,0 +1,227 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "columnar.hh"
+
+#include <algorithm>
+
+namespace hadoop {
+
+static const int8_t PLAIN = 0;
+static const int8_t DICTIONARY = 1;
+
+Column::Column()
+  : encoded_(256), out_(encoded_), pos_(NULL), end_(NULL), loaded_(false)
+{
+}
+
+Column::~Column()
+{
+}
+
+void Column::write(OBinArchive& out)
+{
+  finish();
+  out.writeBytes(encoded_.data(), encoded_.size());
+  encoded_.clear();
+}
+
+void Column::load(IBinArchive& in, size_t count)
+{
+  BufferView view;
+  in.readView(view);
+  data_.assign(view.data, view.length);
+  pos_ = data_.data();
+  end_ = pos_ + data_.length();
+  start(count);
+  loaded_ = true;
+}
+
+void Column::skip(IBinArchive& in)
+{
+  in.skip(in.readLength());
+}
+
+void Column::checkLength(size_t expected) const
+{
+  if (static_cast<size_t>(end_ - pos_) != expected) {
+    throw IOException("Column length does not match its number of values");
+  }
+}
+
+void BoolColumn::finish()
+{
+  if (nbits_ != 0) {
+    out_.writeByte(static_cast<int8_t>(bits_));
+    bits_ = nbits_ = 0;
+  }
+}
+
+void BoolColumn::start(size_t count)
+{
+  checkLength((count + 7) / 8);
+  nbits_ = 0;
+}
+
+void StringColumn::finish()
+{
+  if (entries_.size() * 2 <= values_.size()) {
+    out_.writeByte(DICTIONARY);
+    char* p = out_.reserve(UVLONG_MAX_SIZE);
+    out_.commit(encodeUVLong(p, entries_.size()) - p);
+    for (size_t i = 0; i < entries_.size(); i++) {
+      out_.writeBytes(entries_[i]->data(), entries_[i]->length());
+    }
+    for (size_t i = 0; i < values_.size(); i++) {
+      p = out_.reserve(UVLONG_MAX_SIZE);
+      out_.commit(encodeUVLong(p, values_[i]) - p);
+    }
+  } else {
+    out_.writeByte(PLAIN);
+    for (size_t i = 0; i < values_.size(); i++) {
+      const std::string& s = *entries_[values_[i]];
+      out_.writeBytes(s.data(), s.length());
+    }
+  }
+  codes_.clear();
+  entries_.clear();
+  values_.clear();
+}
+
+void StringColumn::start(size_t count)
+{
+  checkAvailable(pos_, end_, 1);
+  int8_t encoding = static_cast<int8_t>(*pos_++);
+  if (encoding == PLAIN) {
+    dictionaryEncoded_ = false;
+  } else if (encoding == DICTIONARY) {
+    uint64_t size = decodeUVLong(pos_, end_);
+    if (size > count) {
+      throw IOException("Dictionary larger than its column");
+    }
+    dictionary_.resize(size);
+    for (size_t i = 0; i < size; i++) {
+      size_t len = decodeLength(pos_, end_);
+      checkAvailable(pos_, end_, len);
+      dictionary_[i].assign(pos_, len);
+      pos_ += len;
+    }
+    dictionaryEncoded_ = true;
+  } else {
+    throw IOException("Unknown ustring column encoding");
+  }
+}
+
+const size_t ColumnarBatchWriter::DEFAULT_BATCH_SIZE;
+
+ColumnarBatchWriter::ColumnarBatchWriter(OutStream& stream, size_t batchSize)
+  : out_(stream), batchSize_(batchSize > 0 ? batchSize : 1), count_(0)
+{
+}
+
+ColumnarBatchWriter::ColumnarBatchWriter(OutputArena& arena, size_t batchSize)
+  : out_(arena), batchSize_(batchSize > 0 ? batchSize : 1), count_(0)
+{
+}
+
+ColumnarBatchWriter::~ColumnarBatchWriter()
+{
+}
+
+void ColumnarBatchWriter::flush()
+{
+  if (count_ == 0) {
+    return;
+  }
+  out_.writeLength(count_);
+  out_.writeLength(columns_.size());
+  for (size_t i = 0; i < columns_.size(); i++) {
+    columns_[i]->write(out_);
+    out_.checkFlush();
+  }
+  count_ = 0;
+}
+
+void ColumnarBatchWriter::close()
+{
+  flush();
+  out_.writeLength(0);
+  out_.flush();
+}
+
+ColumnarBatchReader::ColumnarBatchReader(InStream& stream,
+                                         const std::vector<std::string>& fields)
+  : in_(stream), fields_(fields), numProjected_(0), remaining_(0),
+    done_(false)
+{
+  std::sort(fields_.begin(), fields_.end());
+  fields_.erase(std::unique(fields_.begin(), fields_.end()), fields_.end());
+}
+
+ColumnarBatchReader::ColumnarBatchReader(const void* data, size_t len,
+                                         const std::vector<std::string>& fields)
+  : in_(data, len), fields_(fields), numProjected_(0), remaining_(0),
+    done_(false)
+{
+  std::sort(fields_.begin(), fields_.end());
+  fields_.erase(std::unique(fields_.begin(), fields_.end()), fields_.end());
+}
+
+ColumnarBatchReader::~ColumnarBatchReader()
+{
+}
+
+void ColumnarBatchReader::addColumn(const char* name, Column& column)
+{
+  bool projected = fields_.empty() ||
+    std::binary_search(fields_.begin(), fields_.end(), std::string(name));
+  columns_.push_back(&column);
+  projected_.push_back(projected);
+  if (projected) {
+    numProjected_++;
+  }
+}
+
+bool ColumnarBatchReader::readBatch()
+{
+  if (!fields_.empty() && numProjected_ != fields_.size()) {
+    throw IOException("Projection names a field that the record lacks");
+  }
+  if (done_) {
+    return false;
+  }
+  size_t count = in_.readLength();
+  if (count == 0) {
+    done_ = true;
+    return false;
+  }
+  if (in_.readLength() != columns_.size()) {
+    throw IOException("Number of columns does not match the record");
+  }
+  for (size_t i = 0; i < columns_.size(); i++) {
+    if (projected_[i]) {
+      columns_[i]->load(in_, count);
+    } else {
+      Column::skip(in_);
+    }
+  }
+  remaining_ = count;
+  return true;
+}
+
+} // namespace hadoop
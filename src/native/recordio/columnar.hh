@@ -0,0 +1,370 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COLUMNAR_HH_
+#define COLUMNAR_HH_
+
+#include "binarchive.hh"
+#include "binserializer.hh"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace hadoop {
+
+/*
+ * The columnar batch format of org.apache.hadoop.record.ColumnarBatchWriter.
+ * A batch is its number of records and number of columns, as varints,
+ * followed by each column, one per field, as a ustring of encoded values.
+ * The stream ends with a batch of zero records.
+ *
+ * Ints and longs are stored as the zigzag-encoded difference from the
+ * previous value, in unsigned base-128 varints. Booleans are packed eight
+ * to a byte from the lowest bit. Ustrings are a byte for the encoding and
+ * then either the values, or, when at most half of them are distinct, a
+ * dictionary of the distinct values and a varint index into it for each
+ * value. Bytes, floats, doubles and buffers are stored as in the binary
+ * format, as are vectors, maps and records, in a SerializedColumn.
+ */
+
+static const size_t UVLONG_MAX_SIZE = 10;
+
+/** Write an unsigned base-128 varint, lowest group first. */
+inline char* encodeUVLong(char* p, uint64_t u)
+{
+  while (u >= 0x80) {
+    *p++ = static_cast<char>(u | 0x80);
+    u >>= 7;
+  }
+  *p++ = static_cast<char>(u);
+  return p;
+}
+
+inline uint64_t decodeUVLong(const char*& p, const char* end)
+{
+  uint64_t u = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    checkAvailable(p, end, 1);
+    uint8_t b = static_cast<uint8_t>(*p++);
+    u |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if (b < 0x80) {
+      return u;
+    }
+  }
+  throw IOException("Malformed varint in column");
+}
+
+inline uint64_t zigzag(int64_t i)
+{
+  return (static_cast<uint64_t>(i) << 1) ^ static_cast<uint64_t>(i >> 63);
+}
+
+inline int64_t unzigzag(uint64_t u)
+{
+  return static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+}
+
+/**
+ * The values of one field in a batch of records. A column either collects
+ * values with add() and is then written, or is loaded and returns the
+ * values with next().
+ */
+class Column {
+public:
+  Column();
+  virtual ~Column();
+
+  /** Whether the column was loaded from the current batch. */
+  bool loaded() const { return loaded_; }
+
+  /** Write the values added since the last call, and clear them. */
+  void write(OBinArchive& out);
+  /** Read the column of a batch of count records. */
+  void load(IBinArchive& in, size_t count);
+  /** Skip the column of a batch. */
+  static void skip(IBinArchive& in);
+
+protected:
+  /** The encoded values of a column being written. */
+  OutputArena encoded_;
+  OBinArchive out_;
+  /** The encoded values of a loaded column, from pos_ up to end_. */
+  const char* pos_;
+  const char* end_;
+
+  /** Encode into out_ what add() left pending. */
+  virtual void finish() {}
+  /** Prepare to return count values from [pos_, end_). */
+  virtual void start(size_t count) = 0;
+  void checkLength(size_t expected) const;
+
+private:
+  std::string data_;
+  bool loaded_;
+
+  Column(const Column&);
+  Column& operator=(const Column&);
+};
+
+/** A column of ints, as deltas. */
+class IntColumn : public Column {
+public:
+  IntColumn() : prev_(0) {}
+  void add(int32_t t) {
+    char* p = out_.reserve(UVLONG_MAX_SIZE);
+    out_.commit(encodeUVLong(p, zigzag(static_cast<int64_t>(t) - prev_)) - p);
+    prev_ = t;
+  }
+  void next(int32_t& t) {
+    uint64_t delta = static_cast<uint64_t>(unzigzag(decodeUVLong(pos_, end_)));
+    prev_ = static_cast<int32_t>(static_cast<uint64_t>(prev_) + delta);
+    t = prev_;
+  }
+protected:
+  virtual void finish() { prev_ = 0; }
+  virtual void start(size_t) { prev_ = 0; }
+private:
+  int32_t prev_;
+};
+
+/** A column of longs, as deltas that may wrap. */
+class LongColumn : public Column {
+public:
+  LongColumn() : prev_(0) {}
+  void add(int64_t t) {
+    char* p = out_.reserve(UVLONG_MAX_SIZE);
+    uint64_t delta = static_cast<uint64_t>(t) - prev_;
+    out_.commit(encodeUVLong(p, zigzag(static_cast<int64_t>(delta))) - p);
+    prev_ = static_cast<uint64_t>(t);
+  }
+  void next(int64_t& t) {
+    prev_ += static_cast<uint64_t>(unzigzag(decodeUVLong(pos_, end_)));
+    t = static_cast<int64_t>(prev_);
+  }
+protected:
+  virtual void finish() { prev_ = 0; }
+  virtual void start(size_t) { prev_ = 0; }
+private:
+  uint64_t prev_;
+};
+
+/** A column of booleans, eight to a byte. */
+class BoolColumn : public Column {
+public:
+  BoolColumn() : bits_(0), nbits_(0) {}
+  void add(bool t) {
+    if (t) {
+      bits_ |= 1 << nbits_;
+    }
+    if (++nbits_ == 8) {
+      out_.writeByte(static_cast<int8_t>(bits_));
+      bits_ = nbits_ = 0;
+    }
+  }
+  void next(bool& t) {
+    t = (*pos_ >> nbits_) & 1;
+    if (++nbits_ == 8) {
+      pos_++;
+      nbits_ = 0;
+    }
+  }
+protected:
+  virtual void finish();
+  virtual void start(size_t count);
+private:
+  int bits_;
+  int nbits_;
+};
+
+class ByteColumn : public Column {
+public:
+  void add(int8_t t) { out_.writeByte(t); }
+  void next(int8_t& t) { t = static_cast<int8_t>(*pos_++); }
+protected:
+  virtual void start(size_t count) { checkLength(count); }
+};
+
+class FloatColumn : public Column {
+public:
+  void add(float t) { out_.writeFloat(t); }
+  void next(float& t) { t = decodeFloat(pos_, end_); }
+protected:
+  virtual void start(size_t count) { checkLength(count * 4); }
+};
+
+class DoubleColumn : public Column {
+public:
+  void add(double t) { out_.writeDouble(t); }
+  void next(double& t) { t = decodeDouble(pos_, end_); }
+protected:
+  virtual void start(size_t count) { checkLength(count * 8); }
+};
+
+/**
+ * A column of ustrings. A dictionary column holds each distinct value
+ * once, and only those are copied out when it is loaded.
+ */
+class StringColumn : public Column {
+public:
+  StringColumn() : dictionaryEncoded_(false) {}
+  void add(const std::string& t) {
+    std::pair<std::map<std::string, uint32_t>::iterator, bool> entry =
+      codes_.insert(std::make_pair(t, static_cast<uint32_t>(entries_.size())));
+    if (entry.second) {
+      entries_.push_back(&entry.first->first);
+    }
+    values_.push_back(entry.first->second);
+  }
+  void next(std::string& t) {
+    if (dictionaryEncoded_) {
+      uint64_t code = decodeUVLong(pos_, end_);
+      if (code >= dictionary_.size()) {
+        throw IOException("Dictionary code out of range");
+      }
+      t = dictionary_[code];
+    } else {
+      size_t len = decodeLength(pos_, end_);
+      checkAvailable(pos_, end_, len);
+      t.assign(pos_, len);
+      pos_ += len;
+    }
+  }
+protected:
+  virtual void finish();
+  virtual void start(size_t count);
+private:
+  std::map<std::string, uint32_t> codes_;
+  std::vector<const std::string*> entries_;
+  std::vector<uint32_t> values_;
+  bool dictionaryEncoded_;
+  std::vector<std::string> dictionary_;
+};
+
+class BufferColumn : public Column {
+public:
+  void add(const std::string& t) { out_.writeBytes(t.data(), t.length()); }
+  void next(std::string& t) {
+    size_t len = decodeLength(pos_, end_);
+    checkAvailable(pos_, end_, len);
+    t.assign(pos_, len);
+    pos_ += len;
+  }
+protected:
+  virtual void start(size_t) {}
+};
+
+/** A column of vectors, maps or records, in the binary format. */
+template <typename T>
+class SerializedColumn : public Column {
+public:
+  SerializedColumn() : in_(NULL, 0) {}
+  void add(const T& t) { BinaryType<T>::write(out_, t); }
+  void next(T& t) { BinaryType<T>::read(in_, t); }
+protected:
+  virtual void start(size_t) { in_.reset(pos_, end_ - pos_); }
+private:
+  IBinArchive in_;
+};
+
+/**
+ * Writes records in columnar batches. rcc generates a ColumnarWriter
+ * subclass in each record; close() must be called to end the stream.
+ */
+class ColumnarBatchWriter {
+public:
+  static const size_t DEFAULT_BATCH_SIZE = 1024;
+
+  virtual ~ColumnarBatchWriter();
+
+  /** Write the records appended since the last batch as a batch. */
+  void flush();
+  /** Write the remaining records and the end of the stream. */
+  void close();
+
+protected:
+  ColumnarBatchWriter(OutStream& stream, size_t batchSize);
+  ColumnarBatchWriter(OutputArena& arena, size_t batchSize);
+
+  /** Add the column of the next field. */
+  void addColumn(Column& column) { columns_.push_back(&column); }
+  /** Count a record whose fields have been added to the columns. */
+  void recordAdded() {
+    if (++count_ == batchSize_) {
+      flush();
+    }
+  }
+
+private:
+  OBinArchive out_;
+  std::vector<Column*> columns_;
+  size_t batchSize_;
+  size_t count_;
+
+  ColumnarBatchWriter(const ColumnarBatchWriter&);
+  ColumnarBatchWriter& operator=(const ColumnarBatchWriter&);
+};
+
+/**
+ * Reads records in columnar batches. Only the columns of the projected
+ * fields are loaded; the others are skipped, and those fields of the
+ * records keep their values. rcc generates a ColumnarReader subclass in
+ * each record.
+ */
+class ColumnarBatchReader {
+public:
+  virtual ~ColumnarBatchReader();
+
+protected:
+  /**
+   * fields names the fields to read; all of them if it is empty. A name
+   * that is not a field of the record is an error at the first read.
+   */
+  ColumnarBatchReader(InStream& stream, const std::vector<std::string>& fields);
+  ColumnarBatchReader(const void* data, size_t len,
+                      const std::vector<std::string>& fields);
+
+  /** Add the column of the next field. */
+  void addColumn(const char* name, Column& column);
+  /** Move to the next record; false at the end of the stream. */
+  bool nextRecord() {
+    if (remaining_ == 0 && !readBatch()) {
+      return false;
+    }
+    remaining_--;
+    return true;
+  }
+
+private:
+  IBinArchive in_;
+  std::vector<std::string> fields_;
+  std::vector<Column*> columns_;
+  std::vector<bool> projected_;
+  size_t numProjected_;
+  size_t remaining_;
+  bool done_;
+
+  bool readBatch();
+
+  ColumnarBatchReader(const ColumnarBatchReader&);
+  ColumnarBatchReader& operator=(const ColumnarBatchReader&);
+};
+
+} // namespace hadoop
+
+#endif // COLUMNAR_HH_
@@ -0,0 +1,59 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIELDTYPEINFO_HH_
+#define FIELDTYPEINFO_HH_
+
+#include "recordio.hh"
+#include "typeIDs.hh"
+
+namespace hadoop {
+
+/**
+ * The name and type of a field in a record.
+ */
+class FieldTypeInfo {
+public:
+  /** Takes ownership of the name and type. */
+  FieldTypeInfo(std::string* fieldID, TypeID* typeID)
+    : fieldID(fieldID), typeID(typeID) {}
+  FieldTypeInfo(const FieldTypeInfo& ti)
+    : fieldID(new std::string(*ti.fieldID)), typeID(ti.typeID->clone()) {}
+  ~FieldTypeInfo() { delete fieldID; delete typeID; }
+
+  FieldTypeInfo* clone() const { return new FieldTypeInfo(*this); }
+  const std::string* getFieldID() const { return fieldID; }
+  const TypeID* getTypeID() const { return typeID; }
+  bool operator==(const FieldTypeInfo& peer) const {
+    return *fieldID == *peer.fieldID && *typeID == *peer.typeID;
+  }
+  void write(OArchive& a, const char* tag) const {
+    a.serialize(*fieldID, tag);
+    typeID->write(a, tag);
+  }
+
+private:
+  std::string* fieldID;
+  TypeID* typeID;
+
+  FieldTypeInfo& operator=(const FieldTypeInfo&);
+};
+
+} // namespace hadoop
+
+#endif // FIELDTYPEINFO_HH_
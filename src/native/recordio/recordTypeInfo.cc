@@ -0,0 +1,107 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "recordTypeInfo.hh"
+
+namespace hadoop {
+
+RecordTypeInfo::RecordTypeInfo() : stid(new StructTypeID()) {}
+
+RecordTypeInfo::RecordTypeInfo(const char* name)
+  : name(name), stid(new StructTypeID())
+{
+}
+
+RecordTypeInfo::RecordTypeInfo(const std::string& name, StructTypeID* stid)
+  : name(name), stid(stid)
+{
+}
+
+RecordTypeInfo::RecordTypeInfo(const RecordTypeInfo& rti)
+  : Record(), name(rti.name), stid(new StructTypeID(*rti.stid))
+{
+}
+
+RecordTypeInfo::~RecordTypeInfo()
+{
+  clearNested();
+  delete stid;
+}
+
+void RecordTypeInfo::clearNested() const
+{
+  for (std::map<std::string, RecordTypeInfo*>::iterator it = nested.begin();
+       it != nested.end(); ++it) {
+    delete it->second;
+  }
+  nested.clear();
+}
+
+void RecordTypeInfo::addField(std::string* fieldName, TypeID* tid)
+{
+  stid->add(new FieldTypeInfo(fieldName, tid));
+}
+
+const RecordTypeInfo*
+RecordTypeInfo::getNestedStructTypeInfo(const char* fieldName) const
+{
+  std::map<std::string, RecordTypeInfo*>::const_iterator it =
+    nested.find(fieldName);
+  if (it != nested.end()) {
+    return it->second;
+  }
+  const StructTypeID* nestedStid = stid->findStruct(fieldName);
+  if (nestedStid == NULL) {
+    return NULL;
+  }
+  RecordTypeInfo* rti =
+    new RecordTypeInfo(fieldName, new StructTypeID(*nestedStid));
+  nested[fieldName] = rti;
+  return rti;
+}
+
+void RecordTypeInfo::serialize(OArchive& a, const char* tag) const
+{
+  a.startRecord(*this, tag);
+  a.serialize(name, tag);
+  stid->writeRest(a, tag);
+  a.endRecord(*this, tag);
+}
+
+void RecordTypeInfo::deserialize(IArchive& a, const char* tag)
+{
+  clearNested();
+  a.startRecord(*this, tag);
+  a.deserialize(name, tag);
+  stid->read(a, tag);
+  a.endRecord(*this, tag);
+}
+
+const std::string& RecordTypeInfo::type() const
+{
+  static const std::string type_("RecordTypeInfo");
+  return type_;
+}
+
+const std::string& RecordTypeInfo::signature() const
+{
+  static const std::string signature_("LRecordTypeInfo(s)");
+  return signature_;
+}
+
+} // namespace hadoop
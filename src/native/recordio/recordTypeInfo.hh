@@ -0,0 +1,74 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RECORDTYPEINFO_HH_
+#define RECORDTYPEINFO_HH_
+
+#include "recordio.hh"
+#include "fieldTypeInfo.hh"
+#include "typeIDs.hh"
+
+namespace hadoop {
+
+/**
+ * The type of a record: its name and the names and types of its fields,
+ * serialized as by org.apache.hadoop.record.meta.RecordTypeInfo. Generated
+ * records use it as a filter to read data written with another version of
+ * the record.
+ */
+class RecordTypeInfo : public Record {
+public:
+  RecordTypeInfo();
+  explicit RecordTypeInfo(const char* name);
+  /** Takes ownership of stid. */
+  RecordTypeInfo(const std::string& name, StructTypeID* stid);
+  RecordTypeInfo(const RecordTypeInfo& rti);
+  virtual ~RecordTypeInfo();
+
+  const std::string& getName() const { return name; }
+  void setName(const std::string& name) { this->name = name; }
+
+  /** Add a field, taking ownership of its name and type. */
+  void addField(std::string* fieldName, TypeID* tid);
+  const std::vector<FieldTypeInfo*>& getFieldTypeInfos() const {
+    return stid->getFieldTypeInfos();
+  }
+
+  /**
+   * Get the type of a field of struct type, or NULL if there is none. The
+   * result belongs to this RecordTypeInfo.
+   */
+  const RecordTypeInfo* getNestedStructTypeInfo(const char* fieldName) const;
+
+  virtual void serialize(OArchive& a, const char* tag) const;
+  virtual void deserialize(IArchive& a, const char* tag);
+  virtual const std::string& type() const;
+  virtual const std::string& signature() const;
+
+private:
+  std::string name;
+  StructTypeID* stid;
+  mutable std::map<std::string, RecordTypeInfo*> nested;
+
+  void clearNested() const;
+  RecordTypeInfo& operator=(const RecordTypeInfo&);
+};
+
+} // namespace hadoop
+
+#endif // RECORDTYPEINFO_HH_
@@ -0,0 +1,91 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "recordio.hh"
+#include "binarchive.hh"
+
+namespace hadoop {
+
+ssize_t FileInStream::read(void* buf, size_t buflen)
+{
+  size_t n = fread(buf, 1, buflen, file_);
+  if (n == 0 && ferror(file_)) {
+    return -1;
+  }
+  return n;
+}
+
+ssize_t FileOutStream::write(const void* buf, size_t len)
+{
+  size_t n = fwrite(buf, 1, len, file_);
+  if (n < len && ferror(file_)) {
+    return -1;
+  }
+  return n;
+}
+
+RecordReader::RecordReader(InStream& stream, RecFormat f)
+  : archive_(NULL)
+{
+  switch (f) {
+  case kBinary:
+    archive_ = new IBinArchive(stream);
+    break;
+  default:
+    throw IOException("Unsupported record format");
+  }
+}
+
+void RecordReader::read(Record& record)
+{
+  record.deserialize(*archive_, "");
+}
+
+RecordReader::~RecordReader()
+{
+  delete archive_;
+}
+
+RecordWriter::RecordWriter(OutStream& stream, RecFormat f)
+  : archive_(NULL)
+{
+  switch (f) {
+  case kBinary:
+    archive_ = new OBinArchive(stream);
+    break;
+  default:
+    throw IOException("Unsupported record format");
+  }
+}
+
+void RecordWriter::write(const Record& record)
+{
+  record.serialize(*archive_, "");
+}
+
+void RecordWriter::flush()
+{
+  static_cast<OBinArchive*>(archive_)->flush();
+}
+
+RecordWriter::~RecordWriter()
+{
+  delete archive_;
+}
+
+} // namespace hadoop
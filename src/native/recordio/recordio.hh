@@ -0,0 +1,286 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RECORDIO_HH_
+#define RECORDIO_HH_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <exception>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace hadoop {
+
+/**
+ * Thrown when an archive cannot read or write a record.
+ */
+class IOException : public std::exception {
+public:
+  explicit IOException(const std::string& msg) : msg_(msg) {}
+  virtual ~IOException() throw() {}
+  virtual const char* what() const throw() { return msg_.c_str(); }
+private:
+  std::string msg_;
+};
+
+/**
+ * A source of bytes for an input archive.
+ */
+class InStream {
+public:
+  /**
+   * Read up to buflen bytes into buf.
+   * @return the number of bytes read, 0 at end of input, or -1 on error
+   */
+  virtual ssize_t read(void* buf, size_t buflen) = 0;
+  virtual ~InStream() {}
+};
+
+/**
+ * A sink of bytes for an output archive.
+ */
+class OutStream {
+public:
+  /**
+   * Write len bytes from buf.
+   * @return the number of bytes written, or -1 on error
+   */
+  virtual ssize_t write(const void* buf, size_t len) = 0;
+  virtual ~OutStream() {}
+};
+
+/**
+ * An InStream over a stdio file. The file is not closed.
+ */
+class FileInStream : public InStream {
+public:
+  explicit FileInStream(FILE* file) : file_(file) {}
+  virtual ssize_t read(void* buf, size_t buflen);
+private:
+  FILE* file_;
+};
+
+/**
+ * An OutStream over a stdio file. The file is not closed.
+ */
+class FileOutStream : public OutStream {
+public:
+  explicit FileOutStream(FILE* file) : file_(file) {}
+  virtual ssize_t write(const void* buf, size_t len);
+private:
+  FILE* file_;
+};
+
+/**
+ * Iterates over the elements of a vector or map being deserialized.
+ */
+class Index {
+public:
+  virtual bool done() = 0;
+  virtual void incr() = 0;
+  virtual ~Index() {}
+};
+
+class IArchive;
+class OArchive;
+
+/**
+ * Base class of all generated records.
+ */
+class Record {
+public:
+  virtual void serialize(OArchive& archive, const char* tag) const = 0;
+  virtual void deserialize(IArchive& archive, const char* tag) = 0;
+  virtual const std::string& type() const = 0;
+  virtual const std::string& signature() const = 0;
+  virtual ~Record() {}
+};
+
+/**
+ * Reads records. Strings and buffers are std::string; deserializing into
+ * a record that was deserialized before reuses the memory of its strings
+ * and vectors.
+ */
+class IArchive {
+public:
+  virtual void deserialize(int8_t& t, const char* tag) = 0;
+  virtual void deserialize(bool& t, const char* tag) = 0;
+  virtual void deserialize(int32_t& t, const char* tag) = 0;
+  virtual void deserialize(int64_t& t, const char* tag) = 0;
+  virtual void deserialize(float& t, const char* tag) = 0;
+  virtual void deserialize(double& t, const char* tag) = 0;
+  /** Read a ustring. */
+  virtual void deserialize(std::string& t, const char* tag) = 0;
+  /** Read a buffer, and its length into len. */
+  virtual void deserialize(std::string& t, size_t& len, const char* tag) = 0;
+  virtual void startRecord(Record& s, const char* tag) = 0;
+  virtual void endRecord(Record& s, const char* tag) = 0;
+  /** The returned index belongs to the archive, and ends with endVector. */
+  virtual Index* startVector(const char* tag) = 0;
+  virtual void endVector(Index* idx, const char* tag) = 0;
+  /** The returned index belongs to the archive, and ends with endMap. */
+  virtual Index* startMap(const char* tag) = 0;
+  virtual void endMap(Index* idx, const char* tag) = 0;
+  virtual void deserialize(Record& s, const char* tag) {
+    s.deserialize(*this, tag);
+  }
+  template <typename T>
+  void deserialize(std::vector<T>& v, const char* tag);
+  void deserialize(std::vector<bool>& v, const char* tag);
+  template <typename K, typename V>
+  void deserialize(std::map<K, V>& v, const char* tag);
+  virtual ~IArchive() {}
+};
+
+/**
+ * Writes records.
+ */
+class OArchive {
+public:
+  virtual void serialize(int8_t t, const char* tag) = 0;
+  virtual void serialize(bool t, const char* tag) = 0;
+  virtual void serialize(int32_t t, const char* tag) = 0;
+  virtual void serialize(int64_t t, const char* tag) = 0;
+  virtual void serialize(float t, const char* tag) = 0;
+  virtual void serialize(double t, const char* tag) = 0;
+  /** Write a ustring. */
+  virtual void serialize(const std::string& t, const char* tag) = 0;
+  /** Write the first len bytes of a buffer. */
+  virtual void serialize(const std::string& t, size_t len,
+                         const char* tag) = 0;
+  virtual void startRecord(const Record& s, const char* tag) = 0;
+  virtual void endRecord(const Record& s, const char* tag) = 0;
+  virtual void startVector(size_t len, const char* tag) = 0;
+  virtual void endVector(size_t len, const char* tag) = 0;
+  virtual void startMap(size_t len, const char* tag) = 0;
+  virtual void endMap(size_t len, const char* tag) = 0;
+  virtual void serialize(const Record& s, const char* tag) {
+    s.serialize(*this, tag);
+  }
+  template <typename T>
+  void serialize(const std::vector<T>& v, const char* tag);
+  template <typename K, typename V>
+  void serialize(const std::map<K, V>& v, const char* tag);
+  virtual ~OArchive() {}
+};
+
+/** Serialization formats of RecordReader and RecordWriter. */
+enum RecFormat { kBinary };
+
+/**
+ * Reads records of one format from a stream.
+ */
+class RecordReader {
+public:
+  RecordReader(InStream& stream, RecFormat f);
+  virtual void read(Record& record);
+  virtual ~RecordReader();
+private:
+  IArchive* archive_;
+  RecordReader(const RecordReader&);
+  RecordReader& operator=(const RecordReader&);
+};
+
+/**
+ * Writes records of one format to a stream. Output is buffered until
+ * flush() or destruction.
+ */
+class RecordWriter {
+public:
+  RecordWriter(OutStream& stream, RecFormat f);
+  virtual void write(const Record& record);
+  virtual void flush();
+  virtual ~RecordWriter();
+private:
+  OArchive* archive_;
+  RecordWriter(const RecordWriter&);
+  RecordWriter& operator=(const RecordWriter&);
+};
+
+template <typename T>
+void IArchive::deserialize(std::vector<T>& v, const char* tag)
+{
+  // Deserialize over the existing elements so that their memory is reused.
+  size_t n = 0;
+  Index* idx = startVector(tag);
+  for (; !idx->done(); idx->incr(), n++) {
+    if (n == v.size()) {
+      v.resize(n + 1);
+    }
+    deserialize(v[n], tag);
+  }
+  endVector(idx, tag);
+  v.resize(n);
+}
+
+inline void IArchive::deserialize(std::vector<bool>& v, const char* tag)
+{
+  v.clear();
+  Index* idx = startVector(tag);
+  for (; !idx->done(); idx->incr()) {
+    bool t;
+    deserialize(t, tag);
+    v.push_back(t);
+  }
+  endVector(idx, tag);
+}
+
+template <typename K, typename V>
+void IArchive::deserialize(std::map<K, V>& v, const char* tag)
+{
+  v.clear();
+  K key;
+  V value;
+  Index* idx = startMap(tag);
+  for (; !idx->done(); idx->incr()) {
+    deserialize(key, tag);
+    deserialize(value, tag);
+    v[key] = value;
+  }
+  endMap(idx, tag);
+}
+
+template <typename T>
+void OArchive::serialize(const std::vector<T>& v, const char* tag)
+{
+  startVector(v.size(), tag);
+  for (typename std::vector<T>::const_iterator it = v.begin();
+       it != v.end(); ++it) {
+    serialize(*it, tag);
+  }
+  endVector(v.size(), tag);
+}
+
+template <typename K, typename V>
+void OArchive::serialize(const std::map<K, V>& v, const char* tag)
+{
+  startMap(v.size(), tag);
+  for (typename std::map<K, V>::const_iterator it = v.begin();
+       it != v.end(); ++it) {
+    serialize(it->first, tag);
+    serialize(it->second, tag);
+  }
+  endMap(v.size(), tag);
+}
+
+} // namespace hadoop
+
+#endif // RECORDIO_HH_
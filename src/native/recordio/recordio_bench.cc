@@ -0,0 +1,226 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The C++ counterpart of org.apache.hadoop.record.RecordBench, for the
+ * binary format:
+ *
+ *   recordio_bench {buffer|string|int} binary <numRecords>
+ *
+ * The records are those rcc generates from src/test/ddl, filled with the
+ * same pseudo-random data as RecordBench, and the output has the same
+ * form, so the per-record times of the two can be compared directly.
+ */
+
+#include "binarchive.hh"
+#include "bench.hh"
+#include "buffer.hh"
+#include "int.hh"
+#include "string.hh"
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+
+using namespace hadoop;
+using org::apache::hadoop::record::RecBuffer;
+using org::apache::hadoop::record::RecInt;
+using org::apache::hadoop::record::RecString;
+
+static const int64_t SEED = 0xDEADBEEFLL;
+static JavaRandom rand_(SEED);
+
+struct Times {
+  int64_t init;
+  int64_t serialize;
+  int64_t deserialize;
+  int64_t view;
+};
+
+static bool isValidCodePoint(int32_t cpt)
+{
+  return !((cpt > 0x10FFFF) ||
+           (cpt >= 0xD800 && cpt <= 0xDFFF) ||
+           (cpt >= 0xFFFE && cpt <= 0xFFFF));
+}
+
+static void appendUtf8(std::string& s, int32_t cpt)
+{
+  if (cpt < 0x80) {
+    s += static_cast<char>(cpt);
+  } else if (cpt < 0x800) {
+    s += static_cast<char>(0xC0 | (cpt >> 6));
+    s += static_cast<char>(0x80 | (cpt & 0x3F));
+  } else if (cpt < 0x10000) {
+    s += static_cast<char>(0xE0 | (cpt >> 12));
+    s += static_cast<char>(0x80 | ((cpt >> 6) & 0x3F));
+    s += static_cast<char>(0x80 | (cpt & 0x3F));
+  } else {
+    s += static_cast<char>(0xF0 | (cpt >> 18));
+    s += static_cast<char>(0x80 | ((cpt >> 12) & 0x3F));
+    s += static_cast<char>(0x80 | ((cpt >> 6) & 0x3F));
+    s += static_cast<char>(0x80 | (cpt & 0x3F));
+  }
+}
+
+static Record* makeBuffer()
+{
+  const int BUFLEN = 32;
+  RecBuffer* r = new RecBuffer();
+  rand_.nextBytes(r->getData(), rand_.nextInt(BUFLEN));
+  return r;
+}
+
+static Record* makeString()
+{
+  const int STRLEN = 32;
+  RecString* r = new RecString();
+  int strlen = rand_.nextInt(STRLEN);
+  for (int ich = 0; ich < strlen; ich++) {
+    int32_t cpt;
+    do {
+      cpt = rand_.nextInt(0x10FFFF + 1);
+    } while (!isValidCodePoint(cpt));
+    appendUtf8(r->getData(), cpt);
+  }
+  return r;
+}
+
+static Record* makeInt()
+{
+  RecInt* r = new RecInt();
+  r->setData(rand_.nextInt());
+  return r;
+}
+
+static void runBinaryBench(const std::string& type, int numRecords,
+                           Times& times)
+{
+  Record* (*make)() = type == "buffer" ? makeBuffer :
+    type == "string" ? makeString : makeInt;
+  std::vector<Record*> records(numRecords);
+  times.init = nanoTime();
+  for (int idx = 0; idx < numRecords; idx++) {
+    records[idx] = make();
+  }
+  times.init = nanoTime() - times.init;
+
+  OutputArena arena;
+  OBinArchive out(arena);
+  for (int idx = 0; idx < numRecords; idx++) {
+    records[idx]->serialize(out, "");
+  }
+  arena.clear();
+
+  times.serialize = nanoTime();
+  for (int idx = 0; idx < numRecords; idx++) {
+    records[idx]->serialize(out, "");
+  }
+  times.serialize = nanoTime() - times.serialize;
+
+  IBinArchive in(arena.data(), arena.size());
+  times.deserialize = nanoTime();
+  for (int idx = 0; idx < numRecords; idx++) {
+    records[idx]->deserialize(in, "");
+  }
+  times.deserialize = nanoTime() - times.deserialize;
+
+  // The single field of a buffer or string record read in place.
+  times.view = 0;
+  if (type != "int") {
+    in.reset(arena.data(), arena.size());
+    BufferView view;
+    size_t total = 0;
+    times.view = nanoTime();
+    for (int idx = 0; idx < numRecords; idx++) {
+      in.deserializeView(view, "data");
+      total += view.length;
+    }
+    times.view = nanoTime() - times.view;
+    if (total > arena.size()) {
+      abort();
+    }
+  }
+
+  for (int idx = 0; idx < numRecords; idx++) {
+    delete records[idx];
+  }
+}
+
+static void printTimes(const std::string& type, const std::string& format,
+                       int numRecords, const Times& times)
+{
+  std::cout << "Type: " << type << " Format: " << format
+            << " #Records: " << numRecords << std::endl;
+  if (times.init != 0) {
+    std::cout << "Initialization Time (Per record) : "
+              << times.init / numRecords << " Nanoseconds" << std::endl;
+  }
+  if (times.serialize != 0) {
+    std::cout << "Serialization Time (Per Record) : "
+              << times.serialize / numRecords << " Nanoseconds" << std::endl;
+  }
+  if (times.deserialize != 0) {
+    std::cout << "Deserialization Time (Per Record) : "
+              << times.deserialize / numRecords << " Nanoseconds"
+              << std::endl;
+  }
+  if (times.view != 0) {
+    std::cout << "View Deserialization Time (Per Record) : "
+              << times.view / numRecords << " Nanoseconds" << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+static void exitOnError()
+{
+  std::cerr << "Usage: recordio_bench {buffer|string|int} binary "
+            << "<numRecords>" << std::endl;
+  exit(1);
+}
+
+int main(int argc, char** argv)
+{
+  std::cout << "RecordBench (C++) v0.1" << std::endl << std::endl;
+  if (argc != 4) {
+    exitOnError();
+  }
+  std::string type = argv[1];
+  std::string format = argv[2];
+  int numRecords = atoi(argv[3]);
+  if ((type != "buffer" && type != "string" && type != "int") ||
+      format != "binary" || numRecords <= 0) {
+    exitOnError();
+  }
+
+  try {
+    // dry run
+    rand_.setSeed(SEED);
+    Times times;
+    runBinaryBench(type, numRecords, times);
+
+    // timed run
+    rand_.setSeed(SEED);
+    runBinaryBench(type, numRecords, times);
+    printTimes(type, format, numRecords, times);
+  } catch (const IOException& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
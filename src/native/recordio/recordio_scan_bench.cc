@@ -0,0 +1,140 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * The C++ counterpart of org.apache.hadoop.record.RecordScanBench:
+ *
+ *   recordio_scan_bench <numRecords>
+ *
+ * Scans RecSort records, from src/test/ddl/sort.jr, stored row by row in
+ * the binary record format and in columnar batches: whole records from
+ * both, and from the batches only the timestamp column.
+ */
+
+#include "binarchive.hh"
+#include "binserializer.hh"
+#include "columnar.hh"
+#include "bench.hh"
+#include "sort.hh"
+
+#include <stdlib.h>
+#include <iostream>
+
+using namespace hadoop;
+using org::apache::hadoop::record::RecSort;
+
+static const int64_t SEED = 0xDEADBEEFLL;
+static const char* const NAMES[] = {
+  "alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"
+};
+
+static void makeRecords(std::vector<RecSort>& records)
+{
+  JavaRandom rand(SEED);
+  int64_t timestamp = 1262304000000LL;
+  for (size_t idx = 0; idx < records.size(); idx++) {
+    RecSort& r = records[idx];
+    // Log-like data: increasing timestamps, a few distinct names.
+    r.setKey(rand.nextInt(1024) - 512);
+    r.getName() = NAMES[rand.nextInt(sizeof(NAMES) / sizeof(NAMES[0]))];
+    timestamp += rand.nextInt(1000);
+    r.setTimestamp(timestamp);
+    r.setScore(rand.nextInt(1000) / 10.0);
+  }
+}
+
+static int64_t scanRows(const OutputArena& rows)
+{
+  IBinArchive in(rows.data(), rows.size());
+  RecSort r;
+  int64_t sum = 0;
+  while (!in.atEnd()) {
+    r.deserializeBinary(in);
+    sum += r.getTimestamp();
+  }
+  return sum;
+}
+
+static int64_t scanColumns(const OutputArena& columns,
+                           const std::vector<std::string>& fields)
+{
+  RecSort::ColumnarReader reader(columns.data(), columns.size(), fields);
+  RecSort r;
+  int64_t sum = 0;
+  while (reader.next(r)) {
+    sum += r.getTimestamp();
+  }
+  return sum;
+}
+
+static void printScanTime(const char* name, int64_t nanos, int numRecords)
+{
+  std::cout << name << " Scan Time (Per Record) : " << nanos / numRecords
+            << " Nanoseconds" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::cout << "RecordScanBench (C++) v0.1" << std::endl << std::endl;
+  int numRecords = argc == 2 ? atoi(argv[1]) : 0;
+  if (numRecords <= 0) {
+    std::cerr << "Usage: recordio_scan_bench <numRecords>" << std::endl;
+    return 1;
+  }
+
+  try {
+    std::vector<RecSort> records(numRecords);
+    makeRecords(records);
+
+    OutputArena rows;
+    OBinArchive out(rows);
+    OutputArena columns;
+    RecSort::ColumnarWriter writer(columns);
+    for (int idx = 0; idx < numRecords; idx++) {
+      records[idx].serializeBinary(out);
+      writer.append(records[idx]);
+    }
+    writer.close();
+    std::cout << "Type: RecSort #Records: " << numRecords
+              << " Row Bytes: " << rows.size()
+              << " Columnar Bytes: " << columns.size() << std::endl;
+
+    std::vector<std::string> all;
+    std::vector<std::string> timestamp(1, "timestamp");
+    int64_t expected = scanRows(rows);
+
+    int64_t start = nanoTime();
+    int64_t sum = scanRows(rows);
+    printScanTime("Row", nanoTime() - start, numRecords);
+    start = nanoTime();
+    sum ^= scanColumns(columns, all);
+    printScanTime("Columnar", nanoTime() - start, numRecords);
+    start = nanoTime();
+    sum ^= scanColumns(columns, timestamp);
+    printScanTime("Projected Columnar", nanoTime() - start, numRecords);
+    std::cout << std::endl;
+
+    if (sum != expected) {
+      std::cerr << "Scans disagree" << std::endl;
+      return 1;
+    }
+  } catch (const IOException& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The C++ counterpart of org.apache.hadoop.record.RecordSortBench:
+ *
+ *   recordio_sort_bench <numRecords>
+ *
+ * Serializes RecSort records, from src/test/ddl/sort.jr, through the
+ * virtual OArchive interface and through the generated serializeBinary(),
+ * then sorts them by comparing the serialized bytes with compareRaw(), and
+ * by deserializing both records for each comparison.
+ */
+
+#include "binarchive.hh"
+#include "binserializer.hh"
+#include "bench.hh"
+#include "sort.hh"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace hadoop;
+using org::apache::hadoop::record::RecSort;
+
+static const int64_t SEED = 0xDEADBEEFLL;
+
+/** The field-by-field order of RecordSortBench. */
+static int compareRecords(const RecSort& r1, const RecSort& r2)
+{
+  if (r1.getKey() != r2.getKey()) {
+    return r1.getKey() < r2.getKey() ? -1 : 1;
+  }
+  int cmp = r1.getName().compare(r2.getName());
+  if (cmp != 0) {
+    return cmp;
+  }
+  if (r1.getTimestamp() != r2.getTimestamp()) {
+    return r1.getTimestamp() < r2.getTimestamp() ? -1 : 1;
+  }
+  if (r1.getScore() != r2.getScore()) {
+    return r1.getScore() < r2.getScore() ? -1 : 1;
+  }
+  return 0;
+}
+
+struct Serialized {
+  const char* data;
+  std::vector<size_t> offsets;
+  std::vector<size_t> lengths;
+};
+
+class RawLess {
+public:
+  RawLess(const Serialized& s, int64_t& compares)
+    : s_(s), compares_(compares) {}
+
+  bool operator()(size_t i, size_t j) const {
+    compares_++;
+    return compareRaw<RecSort>(s_.data + s_.offsets[i], s_.lengths[i],
+                               s_.data + s_.offsets[j], s_.lengths[j]) < 0;
+  }
+
+private:
+  const Serialized& s_;
+  int64_t& compares_;
+};
+
+class DeserializingLess {
+public:
+  DeserializingLess(const Serialized& s, int64_t& compares)
+    : s_(s), compares_(compares) {}
+
+  bool operator()(size_t i, size_t j) const {
+    compares_++;
+    RecSort r1, r2;
+    IBinArchive in1(s_.data + s_.offsets[i], s_.lengths[i]);
+    r1.deserialize(in1, "");
+    IBinArchive in2(s_.data + s_.offsets[j], s_.lengths[j]);
+    r2.deserialize(in2, "");
+    return compareRecords(r1, r2) < 0;
+  }
+
+private:
+  const Serialized& s_;
+  int64_t& compares_;
+};
+
+static void makeRecords(std::vector<RecSort>& records)
+{
+  JavaRandom rand(SEED);
+  for (size_t idx = 0; idx < records.size(); idx++) {
+    RecSort& r = records[idx];
+    // Few distinct keys, so that later fields are compared too.
+    r.setKey(rand.nextInt(1024) - 512);
+    std::string& name = r.getName();
+    name.clear();
+    for (int i = 4 + rand.nextInt(12); i > 0; i--) {
+      name += static_cast<char>('a' + rand.nextInt(4));
+    }
+    r.setTimestamp(1262304000000LL + rand.nextInt(1000000000));
+    r.setScore(rand.nextInt(1000) / 10.0);
+  }
+}
+
+template <typename Less>
+static int64_t sortRecords(const Serialized& s, std::vector<size_t>& order,
+                           int64_t& compares)
+{
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  compares = 0;
+  int64_t start = nanoTime();
+  std::sort(order.begin(), order.end(), Less(s, compares));
+  return nanoTime() - start;
+}
+
+static void printSortTime(const char* name, int64_t nanos, int64_t compares)
+{
+  std::cout << name << " Sort Time : " << nanos / 1000000
+            << " Milliseconds, " << nanos / std::max(compares, int64_t(1))
+            << " Nanoseconds per comparison" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::cout << "RecordSortBench (C++) v0.1" << std::endl << std::endl;
+  int numRecords = argc == 2 ? atoi(argv[1]) : 0;
+  if (numRecords <= 0) {
+    std::cerr << "Usage: recordio_sort_bench <numRecords>" << std::endl;
+    return 1;
+  }
+
+  try {
+    std::vector<RecSort> records(numRecords);
+    makeRecords(records);
+
+    OutputArena arena;
+    OBinArchive out(arena);
+    for (int idx = 0; idx < numRecords; idx++) {
+      records[idx].serialize(out, "");
+    }
+    arena.clear();
+    int64_t start = nanoTime();
+    for (int idx = 0; idx < numRecords; idx++) {
+      records[idx].serialize(out, "");
+    }
+    int64_t virtualTime = nanoTime() - start;
+
+    Serialized s;
+    s.offsets.resize(numRecords);
+    s.lengths.resize(numRecords);
+    arena.clear();
+    start = nanoTime();
+    for (int idx = 0; idx < numRecords; idx++) {
+      s.offsets[idx] = arena.size();
+      records[idx].serializeBinary(out);
+      s.lengths[idx] = arena.size() - s.offsets[idx];
+    }
+    int64_t binaryTime = nanoTime() - start;
+    s.data = arena.data();
+
+    std::cout << "Type: RecSort #Records: " << numRecords
+              << " Bytes: " << arena.size() << std::endl;
+    std::cout << "Serialization Time (Per Record) : "
+              << virtualTime / numRecords << " Nanoseconds" << std::endl;
+    std::cout << "Binary Serialization Time (Per Record) : "
+              << binaryTime / numRecords << " Nanoseconds" << std::endl;
+
+    std::vector<size_t> rawOrder(numRecords);
+    std::vector<size_t> order(numRecords);
+    int64_t compares;
+    int64_t nanos = sortRecords<RawLess>(s, rawOrder, compares);
+    printSortTime("Raw", nanos, compares);
+    nanos = sortRecords<DeserializingLess>(s, order, compares);
+    printSortTime("Deserializing", nanos, compares);
+    std::cout << std::endl;
+
+    for (int idx = 1; idx < numRecords; idx++) {
+      if (compareRecords(records[rawOrder[idx - 1]],
+                         records[rawOrder[idx]]) > 0) {
+        std::cerr << "Records out of order at " << idx << std::endl;
+        return 1;
+      }
+    }
+  } catch (const IOException& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
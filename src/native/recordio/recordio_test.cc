@@ -0,0 +1,797 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Unit test of the C++ record I/O runtime. The expected bytes are those
+ * written by org.apache.hadoop.record.BinaryRecordOutput.
+ */
+
+#include "binarchive.hh"
+#include "binserializer.hh"
+#include "columnar.hh"
+#include "recordTypeInfo.hh"
+#include "utils.hh"
+
+#include <string.h>
+#include <iostream>
+
+using namespace hadoop;
+
+static int failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " \
+                << #cond << std::endl; \
+      failures++; \
+    } \
+  } while (0)
+
+/** A record with a field of each kind, as rcc would generate it. */
+class Inner : public Record {
+public:
+  int32_t id;
+
+  Inner() : id(0) {}
+  virtual void serialize(OArchive& a, const char* tag) const {
+    a.startRecord(*this, tag);
+    a.serialize(id, "id");
+    a.endRecord(*this, tag);
+  }
+  virtual void deserialize(IArchive& a, const char* tag) {
+    a.startRecord(*this, tag);
+    a.deserialize(id, "id");
+    a.endRecord(*this, tag);
+  }
+  virtual const std::string& type() const {
+    static const std::string type_("Inner");
+    return type_;
+  }
+  virtual const std::string& signature() const {
+    static const std::string sig_("LInner(i)");
+    return sig_;
+  }
+  bool operator==(const Inner& peer) const { return id == peer.id; }
+
+  void serializeBinary(OBinArchive& a) const {
+    BinaryType<int32_t>::write(a, id);
+    a.checkFlush();
+  }
+  void deserializeBinary(IBinArchive& a) {
+    BinaryType<int32_t>::read(a, id);
+  }
+  static int compareRaw(const char*& b1, const char* e1,
+                        const char*& b2, const char* e2) {
+    return BinaryType<int32_t>::compare(b1, e1, b2, e2);
+  }
+  static void skipRaw(const char*& b, const char* e) {
+    BinaryType<int32_t>::skip(b, e);
+  }
+};
+
+class Outer : public Record {
+public:
+  int8_t b;
+  bool z;
+  int32_t i;
+  int64_t l;
+  float f;
+  double d;
+  std::string s;
+  std::string buf;
+  std::vector<std::string> vs;
+  std::map<std::string, int64_t> m;
+  Inner r;
+  std::vector<bool> vz;
+
+  Outer() : b(0), z(false), i(0), l(0), f(0), d(0) {}
+  virtual void serialize(OArchive& a, const char* tag) const {
+    a.startRecord(*this, tag);
+    a.serialize(b, "b");
+    a.serialize(z, "z");
+    a.serialize(i, "i");
+    a.serialize(l, "l");
+    a.serialize(f, "f");
+    a.serialize(d, "d");
+    a.serialize(s, "s");
+    a.serialize(buf, buf.length(), "buf");
+    a.serialize(vs, "vs");
+    a.serialize(m, "m");
+    a.serialize(r, "r");
+    a.serialize(vz, "vz");
+    a.endRecord(*this, tag);
+  }
+  virtual void deserialize(IArchive& a, const char* tag) {
+    a.startRecord(*this, tag);
+    a.deserialize(b, "b");
+    a.deserialize(z, "z");
+    a.deserialize(i, "i");
+    a.deserialize(l, "l");
+    a.deserialize(f, "f");
+    a.deserialize(d, "d");
+    a.deserialize(s, "s");
+    size_t len = 0;
+    a.deserialize(buf, len, "buf");
+    a.deserialize(vs, "vs");
+    a.deserialize(m, "m");
+    a.deserialize(r, "r");
+    a.deserialize(vz, "vz");
+    a.endRecord(*this, tag);
+  }
+  virtual const std::string& type() const {
+    static const std::string type_("Outer");
+    return type_;
+  }
+  virtual const std::string& signature() const {
+    static const std::string sig_("LOuter(bzilfdsB[s]{sl}LInner(i)[z])");
+    return sig_;
+  }
+  bool operator==(const Outer& p) const {
+    return b == p.b && z == p.z && i == p.i && l == p.l && f == p.f &&
+      d == p.d && s == p.s && buf == p.buf && vs == p.vs && m == p.m &&
+      r == p.r && vz == p.vz;
+  }
+};
+
+/** The columnar writer and reader of Outer, as rcc would generate them. */
+class OuterWriter : public ColumnarBatchWriter {
+public:
+  OuterWriter(OutStream& stream, size_t batchSize)
+    : ColumnarBatchWriter(stream, batchSize) { init(); }
+  OuterWriter(OutputArena& arena, size_t batchSize)
+    : ColumnarBatchWriter(arena, batchSize) { init(); }
+  void append(const Outer& o) {
+    b.add(o.b);
+    z.add(o.z);
+    i.add(o.i);
+    l.add(o.l);
+    f.add(o.f);
+    d.add(o.d);
+    s.add(o.s);
+    buf.add(o.buf);
+    vs.add(o.vs);
+    m.add(o.m);
+    r.add(o.r);
+    vz.add(o.vz);
+    recordAdded();
+  }
+private:
+  ByteColumn b;
+  BoolColumn z;
+  IntColumn i;
+  LongColumn l;
+  FloatColumn f;
+  DoubleColumn d;
+  StringColumn s;
+  BufferColumn buf;
+  SerializedColumn<std::vector<std::string> > vs;
+  SerializedColumn<std::map<std::string, int64_t> > m;
+  SerializedColumn<Inner> r;
+  SerializedColumn<std::vector<bool> > vz;
+  void init() {
+    addColumn(b);
+    addColumn(z);
+    addColumn(i);
+    addColumn(l);
+    addColumn(f);
+    addColumn(d);
+    addColumn(s);
+    addColumn(buf);
+    addColumn(vs);
+    addColumn(m);
+    addColumn(r);
+    addColumn(vz);
+  }
+};
+
+class OuterReader : public ColumnarBatchReader {
+public:
+  OuterReader(InStream& stream, const std::vector<std::string>& fields)
+    : ColumnarBatchReader(stream, fields) { init(); }
+  OuterReader(const void* data, size_t len,
+              const std::vector<std::string>& fields)
+    : ColumnarBatchReader(data, len, fields) { init(); }
+  bool next(Outer& o) {
+    if (!nextRecord()) {
+      return false;
+    }
+    if (b.loaded()) b.next(o.b);
+    if (z.loaded()) z.next(o.z);
+    if (i.loaded()) i.next(o.i);
+    if (l.loaded()) l.next(o.l);
+    if (f.loaded()) f.next(o.f);
+    if (d.loaded()) d.next(o.d);
+    if (s.loaded()) s.next(o.s);
+    if (buf.loaded()) buf.next(o.buf);
+    if (vs.loaded()) vs.next(o.vs);
+    if (m.loaded()) m.next(o.m);
+    if (r.loaded()) r.next(o.r);
+    if (vz.loaded()) vz.next(o.vz);
+    return true;
+  }
+private:
+  ByteColumn b;
+  BoolColumn z;
+  IntColumn i;
+  LongColumn l;
+  FloatColumn f;
+  DoubleColumn d;
+  StringColumn s;
+  BufferColumn buf;
+  SerializedColumn<std::vector<std::string> > vs;
+  SerializedColumn<std::map<std::string, int64_t> > m;
+  SerializedColumn<Inner> r;
+  SerializedColumn<std::vector<bool> > vz;
+  void init() {
+    addColumn("b", b);
+    addColumn("z", z);
+    addColumn("i", i);
+    addColumn("l", l);
+    addColumn("f", f);
+    addColumn("d", d);
+    addColumn("s", s);
+    addColumn("buf", buf);
+    addColumn("vs", vs);
+    addColumn("m", m);
+    addColumn("r", r);
+    addColumn("vz", vz);
+  }
+};
+
+/** Reads a byte array a few bytes at a time. */
+class TrickleInStream : public InStream {
+public:
+  TrickleInStream(const char* data, size_t len)
+    : data_(data), len_(len), pos_(0) {}
+  virtual ssize_t read(void* buf, size_t buflen) {
+    size_t n = len_ - pos_;
+    n = n < buflen ? n : buflen;
+    n = n < 3 ? n : 3;
+    memcpy(buf, data_ + pos_, n);
+    pos_ += n;
+    return n;
+  }
+private:
+  const char* data_;
+  size_t len_;
+  size_t pos_;
+};
+
+class StringOutStream : public OutStream {
+public:
+  std::string data;
+  virtual ssize_t write(const void* buf, size_t len) {
+    data.append(static_cast<const char*>(buf), len);
+    return len;
+  }
+};
+
+static Outer makeOuter()
+{
+  Outer o;
+  o.b = -7;
+  o.z = true;
+  o.i = -123456;
+  o.l = 9876543210LL;
+  o.f = 1.5f;
+  o.d = -2.25;
+  o.s = "h\xc3\xa9llo";
+  o.buf = std::string("\0\1\2\3", 4);
+  o.vs.push_back("a");
+  o.vs.push_back("");
+  o.vs.push_back("ccc");
+  o.m["one"] = 1;
+  o.m["two"] = -200;
+  o.r.id = 42;
+  o.vz.push_back(true);
+  o.vz.push_back(false);
+  return o;
+}
+
+static std::string bytes(const unsigned char* b, size_t len)
+{
+  return std::string(reinterpret_cast<const char*>(b), len);
+}
+
+static void testVarints()
+{
+  struct { int64_t value; unsigned char bytes[9]; size_t len; } cases[] = {
+    { 0, { 0x00 }, 1 },
+    { -1, { 0xff }, 1 },
+    { 127, { 0x7f }, 1 },
+    { -112, { 0x90 }, 1 },
+    { 128, { 0x8f, 0x80 }, 2 },
+    { -113, { 0x87, 0x70 }, 2 },
+    { -256, { 0x87, 0xff }, 2 },
+    { 300, { 0x8e, 0x01, 0x2c }, 3 },
+    { 65536, { 0x8d, 0x01, 0x00, 0x00 }, 4 },
+    { 2147483647LL, { 0x8c, 0x7f, 0xff, 0xff, 0xff }, 5 },
+    { -2147483647LL - 1, { 0x84, 0x7f, 0xff, 0xff, 0xff }, 5 },
+    { 9223372036854775807LL,
+      { 0x88, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff }, 9 },
+    { -9223372036854775807LL - 1,
+      { 0x80, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff }, 9 },
+  };
+  OutputArena arena;
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    arena.clear();
+    OBinArchive out(arena);
+    out.serialize(cases[c].value, "l");
+    CHECK(std::string(arena.data(), arena.size()) ==
+          bytes(cases[c].bytes, cases[c].len));
+
+    IBinArchive in(arena.data(), arena.size());
+    int64_t l;
+    in.deserialize(l, "l");
+    CHECK(l == cases[c].value);
+    CHECK(in.atEnd());
+  }
+
+  // An int is a long that must fit in 32 bits.
+  arena.clear();
+  OBinArchive out(arena);
+  out.serialize(static_cast<int64_t>(1) << 40, "l");
+  IBinArchive in(arena.data(), arena.size());
+  int32_t i;
+  bool thrown = false;
+  try {
+    in.deserialize(i, "i");
+  } catch (const IOException&) {
+    thrown = true;
+  }
+  CHECK(thrown);
+}
+
+static void testFixedWidth()
+{
+  OutputArena arena;
+  OBinArchive out(arena);
+  out.serialize(1.5f, "f");
+  out.serialize(-2.25, "d");
+  out.serialize(std::string("ab"), "s");
+  const unsigned char expected[] = {
+    0x3f, 0xc0, 0x00, 0x00,
+    0xc0, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 'a', 'b'
+  };
+  CHECK(std::string(arena.data(), arena.size()) ==
+        bytes(expected, sizeof(expected)));
+}
+
+static void testRoundTrip()
+{
+  Outer o = makeOuter();
+  OutputArena arena;
+  OBinArchive out(arena);
+  o.serialize(out, "");
+  o.serialize(out, "");
+
+  // In place, twice into the same record.
+  IBinArchive in(arena.data(), arena.size());
+  Outer copy;
+  copy.deserialize(in, "");
+  CHECK(copy == o);
+  copy.deserialize(in, "");
+  CHECK(copy == o);
+  CHECK(in.atEnd());
+  CHECK(in.position() == arena.size());
+
+  // Through a stream that returns a few bytes at a time, into a buffer
+  // smaller than a record.
+  TrickleInStream trickle(arena.data(), arena.size());
+  IBinArchive sin(trickle, 8);
+  Outer fromStream;
+  fromStream.deserialize(sin, "");
+  CHECK(fromStream == o);
+  fromStream.deserialize(sin, "");
+  CHECK(fromStream == o);
+  CHECK(sin.atEnd());
+
+  // Through a stream writer that flushes as it goes.
+  StringOutStream sout;
+  {
+    OBinArchive bout(sout, 16);
+    o.serialize(bout, "");
+    o.serialize(bout, "");
+  }
+  CHECK(sout.data == std::string(arena.data(), arena.size()));
+
+  // Truncated input.
+  IBinArchive truncated(arena.data(), 10);
+  bool thrown = false;
+  try {
+    copy.deserialize(truncated, "");
+  } catch (const IOException&) {
+    thrown = true;
+  }
+  CHECK(thrown);
+}
+
+static void testArenaReuse()
+{
+  Outer o = makeOuter();
+  OutputArena arena(16);
+  OBinArchive first(arena);
+  o.serialize(first, "");
+  size_t size = arena.size();
+  size_t capacity = arena.capacity();
+  const char* data = arena.data();
+  for (int i = 0; i < 100; i++) {
+    arena.clear();
+    OBinArchive out(arena);
+    o.serialize(out, "");
+    CHECK(arena.size() == size);
+  }
+  CHECK(arena.capacity() == capacity);
+  CHECK(arena.data() == data);
+}
+
+static void testViews()
+{
+  OutputArena arena;
+  OBinArchive out(arena);
+  out.serialize(std::string("view"), "s");
+  out.serialize(std::string("\0\1", 2), 2, "buf");
+
+  IBinArchive in(arena.data(), arena.size());
+  BufferView view;
+  in.deserializeView(view, "s");
+  CHECK(view.data == arena.data() + 1);
+  CHECK(view.toString() == "view");
+  in.deserializeView(view, "buf");
+  CHECK(view.length == 2 && view.data == arena.data() + 6);
+  CHECK(in.atEnd());
+}
+
+static void testTypeInfo()
+{
+  RecordTypeInfo inner("Inner");
+  inner.addField(new std::string("id"), new TypeID(RIOTYPE_INT));
+  RecordTypeInfo rti("Outer");
+  rti.addField(new std::string("s"), new TypeID(RIOTYPE_STRING));
+  rti.addField(new std::string("vs"),
+               new VectorTypeID(new TypeID(RIOTYPE_STRING)));
+  rti.addField(new std::string("m"),
+               new MapTypeID(new TypeID(RIOTYPE_STRING),
+                             new TypeID(RIOTYPE_LONG)));
+  rti.addField(new std::string("r"),
+               new StructTypeID(inner.getFieldTypeInfos()));
+
+  OutputArena arena;
+  OBinArchive out(arena);
+  rti.serialize(out, "");
+  const unsigned char expected[] = {
+    0x05, 'O', 'u', 't', 'e', 'r', 0x04,
+    0x01, 's', RIOTYPE_STRING,
+    0x02, 'v', 's', RIOTYPE_VECTOR, RIOTYPE_STRING,
+    0x01, 'm', RIOTYPE_MAP, RIOTYPE_STRING, RIOTYPE_LONG,
+    0x01, 'r', RIOTYPE_STRUCT, 0x01, 0x02, 'i', 'd', RIOTYPE_INT
+  };
+  CHECK(std::string(arena.data(), arena.size()) ==
+        bytes(expected, sizeof(expected)));
+
+  IBinArchive in(arena.data(), arena.size());
+  RecordTypeInfo copy;
+  copy.deserialize(in, "");
+  CHECK(copy.getName() == "Outer");
+  CHECK(copy.getFieldTypeInfos().size() == 4);
+  for (size_t i = 0; i < copy.getFieldTypeInfos().size(); i++) {
+    CHECK(*copy.getFieldTypeInfos()[i] == *rti.getFieldTypeInfos()[i]);
+  }
+  CHECK(!(*copy.getFieldTypeInfos()[0] == *copy.getFieldTypeInfos()[1]));
+  const RecordTypeInfo* nested = copy.getNestedStructTypeInfo("r");
+  CHECK(nested != NULL && nested->getFieldTypeInfos().size() == 1);
+  CHECK(nested == copy.getNestedStructTypeInfo("r"));
+  CHECK(copy.getNestedStructTypeInfo("s") == NULL);
+}
+
+static void testSkip()
+{
+  Outer o = makeOuter();
+  OutputArena arena;
+  OBinArchive out(arena);
+  o.serialize(out, "");
+  out.serialize(static_cast<int32_t>(77), "after");
+
+  StructTypeID inner;
+  inner.add(new FieldTypeInfo(new std::string("id"),
+                              new TypeID(RIOTYPE_INT)));
+  StructTypeID outer;
+  const RIOTYPE base[] = {
+    RIOTYPE_BYTE, RIOTYPE_BOOL, RIOTYPE_INT, RIOTYPE_LONG, RIOTYPE_FLOAT,
+    RIOTYPE_DOUBLE, RIOTYPE_STRING, RIOTYPE_BUFFER
+  };
+  for (size_t i = 0; i < sizeof(base) / sizeof(base[0]); i++) {
+    outer.add(new FieldTypeInfo(new std::string("f"), new TypeID(base[i])));
+  }
+  outer.add(new FieldTypeInfo(new std::string("vs"),
+      new VectorTypeID(new TypeID(RIOTYPE_STRING))));
+  outer.add(new FieldTypeInfo(new std::string("m"),
+      new MapTypeID(new TypeID(RIOTYPE_STRING), new TypeID(RIOTYPE_LONG))));
+  outer.add(new FieldTypeInfo(new std::string("r"), inner.clone()));
+  outer.add(new FieldTypeInfo(new std::string("vz"),
+      new VectorTypeID(new TypeID(RIOTYPE_BOOL))));
+
+  IBinArchive in(arena.data(), arena.size());
+  Utils::skip(in, "", outer);
+  int32_t after;
+  in.deserialize(after, "after");
+  CHECK(after == 77);
+  CHECK(in.atEnd());
+}
+
+/** Serialize a value with BinaryType and through the virtual interface. */
+template <typename T>
+static std::string writeBinary(const T& t, std::string& virtualBytes)
+{
+  OutputArena arena;
+  OBinArchive out(arena);
+  out.serialize(t, "");
+  virtualBytes.assign(arena.data(), arena.size());
+  arena.clear();
+  BinaryType<T>::write(out, t);
+  return std::string(arena.data(), arena.size());
+}
+
+/** Check that BinaryType orders and skips t1 and t2 like operator<. */
+template <typename T>
+static void checkBinaryType(const T& t1, const T& t2)
+{
+  std::string v1, v2;
+  std::string s1 = writeBinary(t1, v1);
+  std::string s2 = writeBinary(t2, v2);
+  CHECK(s1 == v1);
+  CHECK(s2 == v2);
+  int expected = t1 < t2 ? -1 : (t2 < t1 ? 1 : 0);
+  int cmp = compareRaw<T>(s1.data(), s1.size(), s2.data(), s2.size());
+  CHECK((cmp < 0 ? -1 : (cmp > 0 ? 1 : 0)) == expected);
+  cmp = compareRaw<T>(s2.data(), s2.size(), s1.data(), s1.size());
+  CHECK((cmp < 0 ? -1 : (cmp > 0 ? 1 : 0)) == -expected);
+
+  const char* p = s1.data();
+  BinaryType<T>::skip(p, s1.data() + s1.size());
+  CHECK(p == s1.data() + s1.size());
+
+  IBinArchive in(s2.data(), s2.size());
+  T copy = t1;
+  BinaryType<T>::read(in, copy);
+  CHECK(!(copy < t2) && !(t2 < copy));
+  CHECK(in.atEnd());
+}
+
+static void testBinaryType()
+{
+  const int64_t values[] = {
+    0, 1, -1, 127, 128, -112, -113, 255, 256, 65535, -65536,
+    2147483647LL, -2147483647LL - 1, 9223372036854775807LL,
+    -9223372036854775807LL - 1
+  };
+  const size_t n = sizeof(values) / sizeof(values[0]);
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < n; j++) {
+      checkBinaryType(values[i], values[j]);
+      checkBinaryType(static_cast<int32_t>(values[i]),
+                      static_cast<int32_t>(values[j]));
+      checkBinaryType(static_cast<int8_t>(values[i]),
+                      static_cast<int8_t>(values[j]));
+      checkBinaryType(values[i] / 3.0, values[j] / 3.0);
+      checkBinaryType(values[i] / 3.0f, values[j] / 3.0f);
+    }
+  }
+  checkBinaryType(true, false);
+  checkBinaryType(false, false);
+
+  const char* strings[] = { "", "a", "b", "ab", "abc", "abd", "\xc3\xa9" };
+  const size_t ns = sizeof(strings) / sizeof(strings[0]);
+  for (size_t i = 0; i < ns; i++) {
+    for (size_t j = 0; j < ns; j++) {
+      std::string s1(strings[i]);
+      std::string s2(strings[j]);
+      checkBinaryType(s1, s2);
+
+      std::vector<std::string> v1(1, s1);
+      std::vector<std::string> v2(1, s2);
+      v1.push_back("x");
+      checkBinaryType(v1, v2);
+
+      // Maps compare by their keys only, as in Java.
+      std::map<std::string, int64_t> m1;
+      std::map<std::string, int64_t> m2;
+      m1[s1] = 1;
+      m2[s2] = 1;
+      checkBinaryType(m1, m2);
+    }
+  }
+
+  std::vector<bool> vz1(3, true);
+  std::vector<bool> vz2(3, true);
+  vz2[1] = false;
+  checkBinaryType(vz1, vz2);
+
+  // A record is compared field by field, with no framing.
+  Inner r1, r2;
+  r1.id = 300;
+  r2.id = -5;
+  std::string v;
+  std::string s = writeBinary(r1, v);
+  CHECK(s == v);
+  std::string s2 = writeBinary(r2, v);
+  CHECK(compareRaw<Inner>(s.data(), s.size(), s2.data(), s2.size()) > 0);
+  CHECK(compareRaw<Inner>(s2.data(), s2.size(), s.data(), s.size()) < 0);
+  IBinArchive in(s.data(), s.size());
+  Inner copy;
+  BinaryType<Inner>::read(in, copy);
+  CHECK(copy == r1);
+
+  // Truncated input.
+  bool thrown = false;
+  try {
+    compareRaw<int64_t>(s.data(), 1, s.data(), 1);
+    const char* p = s.data();
+    BinaryType<std::string>::skip(p, p);
+  } catch (const IOException&) {
+    thrown = true;
+  }
+  CHECK(thrown);
+}
+
+static void testColumnEncodings()
+{
+  class Ints : public ColumnarBatchWriter {
+  public:
+    explicit Ints(OutputArena& arena) : ColumnarBatchWriter(arena, 8) {
+      addColumn(i);
+      addColumn(s);
+    }
+    void append(int32_t v, const std::string& t) {
+      i.add(v);
+      s.add(t);
+      recordAdded();
+    }
+  private:
+    IntColumn i;
+    StringColumn s;
+  };
+
+  OutputArena arena;
+  Ints w(arena);
+  w.append(100, "ab");
+  w.append(101, "ab");
+  w.append(99, "ab");
+  w.append(-2147483647 - 1, "c");
+  w.close();
+  const unsigned char expected[] = {
+    0x04, 0x02,
+    // deltas 100, 1, -2 and -2147483747, zigzagged
+    0x09, 0xc8, 0x01, 0x02, 0x03, 0xc5, 0x81, 0x80, 0x80, 0x10,
+    // a dictionary of two values, and their codes
+    0x0b, 0x01, 0x02, 0x02, 'a', 'b', 0x01, 'c', 0x00, 0x00, 0x00, 0x01,
+    0x00
+  };
+  CHECK(std::string(arena.data(), arena.size()) ==
+        bytes(expected, sizeof(expected)));
+}
+
+static void testColumnar()
+{
+  std::vector<Outer> records;
+  for (int n = 0; n < 100; n++) {
+    Outer o = makeOuter();
+    o.b = static_cast<int8_t>(n);
+    o.z = n % 3 == 0;
+    o.i = n * 1000 - 50000;
+    o.l = n % 2 == 0 ? -9223372036854775807LL - 1 : 9223372036854775807LL;
+    o.d = n / 7.0;
+    o.s = n % 10 == 0 ? "rare" : "common";
+    o.r.id = -n;
+    if (n % 4 == 0) {
+      o.vs.push_back("four");
+    }
+    records.push_back(o);
+  }
+  std::vector<std::string> all;
+
+  // Through an arena, in batches that do not divide the records evenly.
+  OutputArena arena;
+  OuterWriter w(arena, 30);
+  for (size_t n = 0; n < records.size(); n++) {
+    w.append(records[n]);
+  }
+  w.close();
+  OuterReader in(arena.data(), arena.size(), all);
+  Outer copy;
+  size_t count = 0;
+  while (in.next(copy)) {
+    CHECK(count < records.size() && copy == records[count]);
+    count++;
+  }
+  CHECK(count == records.size());
+  CHECK(!in.next(copy));
+
+  // Through streams, in one batch that is read a few bytes at a time.
+  StringOutStream sout;
+  OuterWriter sw(sout, 1000);
+  for (size_t n = 0; n < records.size(); n++) {
+    sw.append(records[n]);
+  }
+  sw.close();
+  TrickleInStream trickle(sout.data.data(), sout.data.size());
+  OuterReader sin(trickle, all);
+  count = 0;
+  while (sin.next(copy)) {
+    CHECK(count < records.size() && copy == records[count]);
+    count++;
+  }
+  CHECK(count == records.size());
+
+  // Projected, the other fields are left alone.
+  std::vector<std::string> fields;
+  fields.push_back("s");
+  fields.push_back("i");
+  OuterReader projected(arena.data(), arena.size(), fields);
+  count = 0;
+  Outer empty;
+  while (projected.next(empty)) {
+    CHECK(empty.i == records[count].i && empty.s == records[count].s);
+    CHECK(empty.l == 0 && empty.vs.empty() && empty.r.id == 0);
+    count++;
+  }
+  CHECK(count == records.size());
+
+  fields.push_back("nosuch");
+  OuterReader unknown(arena.data(), arena.size(), fields);
+  bool thrown = false;
+  try {
+    unknown.next(empty);
+  } catch (const IOException&) {
+    thrown = true;
+  }
+  CHECK(thrown);
+
+  // Truncated input.
+  OuterReader truncated(arena.data(), arena.size() / 2, all);
+  thrown = false;
+  try {
+    while (truncated.next(copy)) {
+    }
+  } catch (const IOException&) {
+    thrown = true;
+  }
+  CHECK(thrown);
+}
+
+int main(int argc, char** argv)
+{
+  testVarints();
+  testFixedWidth();
+  testRoundTrip();
+  testArenaReuse();
+  testViews();
+  testTypeInfo();
+  testSkip();
+  testBinaryType();
+  testColumnEncodings();
+  testColumnar();
+  if (failures != 0) {
+    std::cerr << failures << " checks failed" << std::endl;
+    return 1;
+  }
+  std::cout << "All tests passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,206 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "typeIDs.hh"
+#include "fieldTypeInfo.hh"
+
+namespace hadoop {
+
+void TypeID::write(OArchive& a, const char* tag) const
+{
+  a.serialize(static_cast<int8_t>(typeVal), tag);
+}
+
+bool TypeID::operator==(const TypeID& peer) const
+{
+  return typeVal == peer.typeVal;
+}
+
+static FieldTypeInfo* readFieldTypeInfo(IArchive& a, const char* tag)
+{
+  std::string* fieldID = new std::string();
+  try {
+    a.deserialize(*fieldID, tag);
+  } catch (...) {
+    delete fieldID;
+    throw;
+  }
+  TypeID* typeID;
+  try {
+    typeID = TypeID::read(a, tag);
+  } catch (...) {
+    delete fieldID;
+    throw;
+  }
+  return new FieldTypeInfo(fieldID, typeID);
+}
+
+TypeID* TypeID::read(IArchive& a, const char* tag)
+{
+  int8_t typeVal;
+  a.deserialize(typeVal, tag);
+  switch (typeVal) {
+  case RIOTYPE_BOOL:
+  case RIOTYPE_BUFFER:
+  case RIOTYPE_BYTE:
+  case RIOTYPE_DOUBLE:
+  case RIOTYPE_FLOAT:
+  case RIOTYPE_INT:
+  case RIOTYPE_LONG:
+  case RIOTYPE_STRING:
+    return new TypeID(static_cast<RIOTYPE>(typeVal));
+  case RIOTYPE_MAP:
+    {
+      TypeID* key = read(a, tag);
+      TypeID* value;
+      try {
+        value = read(a, tag);
+      } catch (...) {
+        delete key;
+        throw;
+      }
+      return new MapTypeID(key, value);
+    }
+  case RIOTYPE_STRUCT:
+    {
+      StructTypeID* stid = new StructTypeID();
+      try {
+        stid->read(a, tag);
+      } catch (...) {
+        delete stid;
+        throw;
+      }
+      return stid;
+    }
+  case RIOTYPE_VECTOR:
+    return new VectorTypeID(read(a, tag));
+  default:
+    throw IOException("Unknown type read");
+  }
+}
+
+StructTypeID::StructTypeID() : TypeID(RIOTYPE_STRUCT) {}
+
+StructTypeID::StructTypeID(const std::vector<FieldTypeInfo*>& vec)
+  : TypeID(RIOTYPE_STRUCT)
+{
+  for (size_t i = 0; i < vec.size(); i++) {
+    typeInfos.push_back(vec[i]->clone());
+  }
+}
+
+StructTypeID::StructTypeID(const StructTypeID& ti)
+  : TypeID(RIOTYPE_STRUCT)
+{
+  for (size_t i = 0; i < ti.typeInfos.size(); i++) {
+    typeInfos.push_back(ti.typeInfos[i]->clone());
+  }
+}
+
+StructTypeID::~StructTypeID()
+{
+  clear();
+}
+
+void StructTypeID::clear()
+{
+  for (size_t i = 0; i < typeInfos.size(); i++) {
+    delete typeInfos[i];
+  }
+  typeInfos.clear();
+}
+
+void StructTypeID::write(OArchive& a, const char* tag) const
+{
+  TypeID::write(a, tag);
+  writeRest(a, tag);
+}
+
+void StructTypeID::writeRest(OArchive& a, const char* tag) const
+{
+  a.serialize(static_cast<int32_t>(typeInfos.size()), tag);
+  for (size_t i = 0; i < typeInfos.size(); i++) {
+    typeInfos[i]->write(a, tag);
+  }
+}
+
+void StructTypeID::read(IArchive& a, const char* tag)
+{
+  clear();
+  int32_t numElems;
+  a.deserialize(numElems, tag);
+  for (int32_t i = 0; i < numElems; i++) {
+    typeInfos.push_back(readFieldTypeInfo(a, tag));
+  }
+}
+
+const StructTypeID* StructTypeID::findStruct(const char* name) const
+{
+  for (size_t i = 0; i < typeInfos.size(); i++) {
+    const FieldTypeInfo* ti = typeInfos[i];
+    if (*ti->getFieldID() == name &&
+        ti->getTypeID()->getTypeVal() == RIOTYPE_STRUCT) {
+      return static_cast<const StructTypeID*>(ti->getTypeID());
+    }
+  }
+  return NULL;
+}
+
+VectorTypeID::VectorTypeID(const VectorTypeID& ti)
+  : TypeID(RIOTYPE_VECTOR), typeIDElement(ti.typeIDElement->clone())
+{
+}
+
+void VectorTypeID::write(OArchive& a, const char* tag) const
+{
+  TypeID::write(a, tag);
+  typeIDElement->write(a, tag);
+}
+
+bool VectorTypeID::operator==(const TypeID& peer) const
+{
+  if (peer.getTypeVal() != RIOTYPE_VECTOR) {
+    return false;
+  }
+  const VectorTypeID& vpeer = static_cast<const VectorTypeID&>(peer);
+  return *typeIDElement == *vpeer.typeIDElement;
+}
+
+MapTypeID::MapTypeID(const MapTypeID& ti)
+  : TypeID(RIOTYPE_MAP), typeIDKey(ti.typeIDKey->clone()),
+    typeIDValue(ti.typeIDValue->clone())
+{
+}
+
+void MapTypeID::write(OArchive& a, const char* tag) const
+{
+  TypeID::write(a, tag);
+  typeIDKey->write(a, tag);
+  typeIDValue->write(a, tag);
+}
+
+bool MapTypeID::operator==(const TypeID& peer) const
+{
+  if (peer.getTypeVal() != RIOTYPE_MAP) {
+    return false;
+  }
+  const MapTypeID& mpeer = static_cast<const MapTypeID&>(peer);
+  return *typeIDKey == *mpeer.typeIDKey && *typeIDValue == *mpeer.typeIDValue;
+}
+
+} // namespace hadoop
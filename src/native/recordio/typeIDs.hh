@@ -0,0 +1,136 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TYPEIDS_HH_
+#define TYPEIDS_HH_
+
+#include "recordio.hh"
+
+namespace hadoop {
+
+class FieldTypeInfo;
+
+/** Type codes, as in org.apache.hadoop.record.meta.TypeID.RIOType. */
+enum RIOTYPE {
+  RIOTYPE_BOOL = 1,
+  RIOTYPE_BUFFER = 2,
+  RIOTYPE_BYTE = 3,
+  RIOTYPE_DOUBLE = 4,
+  RIOTYPE_FLOAT = 5,
+  RIOTYPE_INT = 6,
+  RIOTYPE_LONG = 7,
+  RIOTYPE_MAP = 8,
+  RIOTYPE_STRING = 9,
+  RIOTYPE_STRUCT = 10,
+  RIOTYPE_VECTOR = 11
+};
+
+/**
+ * The type of a field. Base types are plain TypeIDs; structs, vectors and
+ * maps use the subclasses below, which own the TypeIDs they are built
+ * from.
+ */
+class TypeID {
+public:
+  explicit TypeID(RIOTYPE t) : typeVal(t) {}
+  TypeID(const TypeID& t) : typeVal(t.typeVal) {}
+  virtual ~TypeID() {}
+
+  virtual TypeID* clone() const { return new TypeID(*this); }
+  virtual void write(OArchive& a, const char* tag) const;
+  virtual bool operator==(const TypeID& peer) const;
+  bool operator!=(const TypeID& peer) const { return !(*this == peer); }
+  RIOTYPE getTypeVal() const { return typeVal; }
+
+  /** Read a type written by write(). The caller owns the result. */
+  static TypeID* read(IArchive& a, const char* tag);
+
+protected:
+  RIOTYPE typeVal;
+
+private:
+  TypeID& operator=(const TypeID&);
+};
+
+class StructTypeID : public TypeID {
+public:
+  StructTypeID();
+  /** Copies the given fields. */
+  explicit StructTypeID(const std::vector<FieldTypeInfo*>& vec);
+  StructTypeID(const StructTypeID& ti);
+  virtual ~StructTypeID();
+
+  virtual TypeID* clone() const { return new StructTypeID(*this); }
+  virtual void write(OArchive& a, const char* tag) const;
+  /** Write the fields, without the type code. */
+  void writeRest(OArchive& a, const char* tag) const;
+  /** Read the fields written by writeRest(), replacing any present. */
+  void read(IArchive& a, const char* tag);
+
+  /** Add a field, taking ownership of it. */
+  void add(FieldTypeInfo* ti) { typeInfos.push_back(ti); }
+  const std::vector<FieldTypeInfo*>& getFieldTypeInfos() const {
+    return typeInfos;
+  }
+  /** Find a field of struct type by name, or NULL. */
+  const StructTypeID* findStruct(const char* name) const;
+
+private:
+  std::vector<FieldTypeInfo*> typeInfos;
+
+  void clear();
+};
+
+class VectorTypeID : public TypeID {
+public:
+  /** Takes ownership of the element type. */
+  explicit VectorTypeID(TypeID* t) : TypeID(RIOTYPE_VECTOR), typeIDElement(t) {}
+  VectorTypeID(const VectorTypeID& ti);
+  virtual ~VectorTypeID() { delete typeIDElement; }
+
+  virtual TypeID* clone() const { return new VectorTypeID(*this); }
+  virtual void write(OArchive& a, const char* tag) const;
+  virtual bool operator==(const TypeID& peer) const;
+  const TypeID* getElementTypeID() const { return typeIDElement; }
+
+private:
+  TypeID* typeIDElement;
+};
+
+class MapTypeID : public TypeID {
+public:
+  /** Takes ownership of the key and value types. */
+  MapTypeID(TypeID* k, TypeID* v)
+    : TypeID(RIOTYPE_MAP), typeIDKey(k), typeIDValue(v) {}
+  MapTypeID(const MapTypeID& ti);
+  virtual ~MapTypeID() { delete typeIDKey; delete typeIDValue; }
+
+  virtual TypeID* clone() const { return new MapTypeID(*this); }
+  virtual void write(OArchive& a, const char* tag) const;
+  virtual bool operator==(const TypeID& peer) const;
+  const TypeID* getKeyTypeID() const { return typeIDKey; }
+  const TypeID* getValueTypeID() const { return typeIDValue; }
+
+private:
+  TypeID* typeIDKey;
+  TypeID* typeIDValue;
+};
+
+} // namespace hadoop
+
+#endif // TYPEIDS_HH_
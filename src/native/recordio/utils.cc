@@ -0,0 +1,135 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils.hh"
+#include "binarchive.hh"
+#include "fieldTypeInfo.hh"
+
+namespace hadoop {
+
+namespace {
+
+/** Stands in for the record whose fields are skipped. */
+class SkippedRecord : public Record {
+public:
+  virtual void serialize(OArchive& a, const char* tag) const {}
+  virtual void deserialize(IArchive& a, const char* tag) {}
+  virtual const std::string& type() const {
+    static const std::string type_("SkippedRecord");
+    return type_;
+  }
+  virtual const std::string& signature() const {
+    static const std::string signature_("LSkippedRecord()");
+    return signature_;
+  }
+};
+
+}
+
+void Utils::skip(IArchive& a, const char* tag, const TypeID& typeID)
+{
+  switch (typeID.getTypeVal()) {
+  case RIOTYPE_BOOL:
+    {
+      bool b;
+      a.deserialize(b, tag);
+    }
+    break;
+  case RIOTYPE_BUFFER:
+  case RIOTYPE_STRING:
+    {
+      IBinArchive* bin = dynamic_cast<IBinArchive*>(&a);
+      if (bin != NULL) {
+        BufferView view;
+        bin->deserializeView(view, tag);
+      } else {
+        std::string s;
+        a.deserialize(s, tag);
+      }
+    }
+    break;
+  case RIOTYPE_BYTE:
+    {
+      int8_t b;
+      a.deserialize(b, tag);
+    }
+    break;
+  case RIOTYPE_DOUBLE:
+    {
+      double d;
+      a.deserialize(d, tag);
+    }
+    break;
+  case RIOTYPE_FLOAT:
+    {
+      float f;
+      a.deserialize(f, tag);
+    }
+    break;
+  case RIOTYPE_INT:
+    {
+      int32_t i;
+      a.deserialize(i, tag);
+    }
+    break;
+  case RIOTYPE_LONG:
+    {
+      int64_t l;
+      a.deserialize(l, tag);
+    }
+    break;
+  case RIOTYPE_MAP:
+    {
+      const MapTypeID& mtID = static_cast<const MapTypeID&>(typeID);
+      Index* idx = a.startMap(tag);
+      for (; !idx->done(); idx->incr()) {
+        skip(a, tag, *mtID.getKeyTypeID());
+        skip(a, tag, *mtID.getValueTypeID());
+      }
+      a.endMap(idx, tag);
+    }
+    break;
+  case RIOTYPE_STRUCT:
+    {
+      const StructTypeID& stID = static_cast<const StructTypeID&>(typeID);
+      const std::vector<FieldTypeInfo*>& typeInfos =
+        stID.getFieldTypeInfos();
+      SkippedRecord r;
+      a.startRecord(r, tag);
+      for (size_t i = 0; i < typeInfos.size(); i++) {
+        skip(a, tag, *typeInfos[i]->getTypeID());
+      }
+      a.endRecord(r, tag);
+    }
+    break;
+  case RIOTYPE_VECTOR:
+    {
+      const VectorTypeID& vtID = static_cast<const VectorTypeID&>(typeID);
+      Index* idx = a.startVector(tag);
+      for (; !idx->done(); idx->incr()) {
+        skip(a, tag, *vtID.getElementTypeID());
+      }
+      a.endVector(idx, tag);
+    }
+    break;
+  default:
+    throw IOException("Unknown typeID when skipping bytes");
+  }
+}
+
+} // namespace hadoop
@@ -0,0 +1,264 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDIO_H
+  #include <stdio.h>
+#else
+  #error 'stdio.h not found'
+#endif  
+
+#if defined HAVE_STDLIB_H
+  #include <stdlib.h>
+#else
+  #error 'stdlib.h not found'
+#endif  
+
+#if defined HAVE_STRING_H
+  #include <string.h>
+#else
+  #error 'string.h not found'
+#endif  
+
+#if defined HAVE_DLFCN_H
+  #include <dlfcn.h>
+#else
+  #error 'dlfcn.h not found'
+#endif  
+
+#include "org_apache_hadoop_io_compress_bzip2.h"
+#include "org_apache_hadoop_io_compress_bzip2_BZip2Compressor.h"
+
+#if defined HAVE_BZLIB_H
+
+static jfieldID BZip2Compressor_clazz;
+static jfieldID BZip2Compressor_stream;
+static jfieldID BZip2Compressor_uncompressedDirectBuf;
+static jfieldID BZip2Compressor_uncompressedDirectBufOff;
+static jfieldID BZip2Compressor_uncompressedDirectBufLen;
+static jfieldID BZip2Compressor_compressedDirectBuf;
+static jfieldID BZip2Compressor_directBufferSize;
+static jfieldID BZip2Compressor_finish;
+static jfieldID BZip2Compressor_finished;
+
+static int (*dlsym_BZ2_bzCompressInit)(bz_stream*, int, int, int);
+static int (*dlsym_BZ2_bzCompress)(bz_stream*, int);
+static int (*dlsym_BZ2_bzCompressEnd)(bz_stream*);
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_compress_bzip2_BZip2Compressor_initIDs(
+	JNIEnv *env, jclass class
+	) {
+	// Load libbz2.so
+	void *libbz2 = dlopen(HADOOP_BZIP2_LIBRARY, RTLD_LAZY | RTLD_GLOBAL);
+	if (!libbz2) {
+		THROW(env, "java/lang/UnsatisfiedLinkError", "Cannot load libbz2.so");
+		return;
+	}
+
+	// Locate the requisite symbols from libbz2.so
+	dlerror();                                 // Clear any existing error
+	LOAD_DYNAMIC_SYMBOL(dlsym_BZ2_bzCompressInit, env, libbz2, "BZ2_bzCompressInit");
+	LOAD_DYNAMIC_SYMBOL(dlsym_BZ2_bzCompress, env, libbz2, "BZ2_bzCompress");
+	LOAD_DYNAMIC_SYMBOL(dlsym_BZ2_bzCompressEnd, env, libbz2, "BZ2_bzCompressEnd");
+
+	// Initialize the requisite fieldIds
+	BZip2Compressor_clazz = (*env)->GetStaticFieldID(env, class, "clazz", 
+	                                                 "Ljava/lang/Class;");
+	BZip2Compressor_stream = (*env)->GetFieldID(env, class, "stream", "J");
+	BZip2Compressor_finish = (*env)->GetFieldID(env, class, "finish", "Z");
+	BZip2Compressor_finished = (*env)->GetFieldID(env, class, "finished", "Z");
+	BZip2Compressor_uncompressedDirectBuf = (*env)->GetFieldID(env, class, 
+										"uncompressedDirectBuf", 
+										"Ljava/nio/Buffer;");
+	BZip2Compressor_uncompressedDirectBufOff = (*env)->GetFieldID(env, class, 
+										"uncompressedDirectBufOff", "I");
+	BZip2Compressor_uncompressedDirectBufLen = (*env)->GetFieldID(env, class, 
+										"uncompressedDirectBufLen", "I");
+	BZip2Compressor_compressedDirectBuf = (*env)->GetFieldID(env, class, 
+										"compressedDirectBuf", 
+										"Ljava/nio/Buffer;");
+	BZip2Compressor_directBufferSize = (*env)->GetFieldID(env, class, 
+										"directBufferSize", "I");
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_apache_hadoop_io_compress_bzip2_BZip2Compressor_init(
+	JNIEnv *env, jclass class, jint blockSize, jint workFactor
+	) {
+	// Create a bz_stream
+	bz_stream *stream = hadoop_new_bzstream();
+	if (!stream) {
+		THROW(env, "java/lang/OutOfMemoryError", NULL);
+		return (jlong)0;
+	}
+
+	// Initialize stream
+	static const int verbosity = 0;
+	int rv = (*dlsym_BZ2_bzCompressInit)(stream, blockSize, verbosity,
+										workFactor);
+
+	if (rv != BZ_OK) {
+		// Contingency - Report error by throwing appropriate exceptions
+		hadoop_pool_free(stream);
+		stream = NULL;
+
+		switch (rv) {
+			case BZ_MEM_ERROR:
+				{
+					THROW(env, "java/lang/OutOfMemoryError", NULL);
+				}
+			break;
+			case BZ_PARAM_ERROR:
+				{
+					THROW(env, "java/lang/IllegalArgumentException", NULL);
+				}
+			break;
+			default:
+				{
+					THROW(env, "java/lang/InternalError", NULL);
+				}
+			break;
+		}
+	}
+
+	return JLONG(stream);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_compress_bzip2_BZip2Compressor_compressBytesDirect(
+	JNIEnv *env, jobject this
+	) {
+	// Get members of BZip2Compressor
+	bz_stream *stream = BZSTREAM(
+							(*env)->GetLongField(env, this, 
+										BZip2Compressor_stream)
+						);
+	if (!stream) {
+		THROW(env, "java/lang/NullPointerException", NULL);
+		return (jint)0;
+	} 
+
+	jobject clazz = (*env)->GetStaticObjectField(env, this, 
+	                                             BZip2Compressor_clazz);
+	jobject uncompressed_direct_buf = (*env)->GetObjectField(env, this, 
+									BZip2Compressor_uncompressedDirectBuf);
+	jint uncompressed_direct_buf_off = (*env)->GetIntField(env, this, 
+									BZip2Compressor_uncompressedDirectBufOff);
+	jint uncompressed_direct_buf_len = (*env)->GetIntField(env, this, 
+									BZip2Compressor_uncompressedDirectBufLen);
+
+	jobject compressed_direct_buf = (*env)->GetObjectField(env, this, 
+									BZip2Compressor_compressedDirectBuf);
+	jint compressed_direct_buf_len = (*env)->GetIntField(env, this, 
+									BZip2Compressor_directBufferSize);
+
+	jboolean finish = (*env)->GetBooleanField(env, this, BZip2Compressor_finish);
+
+	// Get the input direct buffer
+	LOCK_CLASS(env, clazz, "BZip2Compressor");
+	char* uncompressed_bytes = (*env)->GetDirectBufferAddress(env, 
+											uncompressed_direct_buf);
+	UNLOCK_CLASS(env, clazz, "BZip2Compressor");
+
+	if (uncompressed_bytes == 0) {
+		return (jint)0;
+	}
+
+	// Get the output direct buffer
+	LOCK_CLASS(env, clazz, "BZip2Compressor");
+	char* compressed_bytes = (*env)->GetDirectBufferAddress(env, 
+										compressed_direct_buf);
+	UNLOCK_CLASS(env, clazz, "BZip2Compressor");
+
+	if (compressed_bytes == 0) {
+		return (jint)0;
+	}
+
+	// Re-calibrate the bz_stream
+	stream->next_in = uncompressed_bytes + uncompressed_direct_buf_off;
+	stream->next_out = compressed_bytes;
+	stream->avail_in = uncompressed_direct_buf_len;
+	stream->avail_out = compressed_direct_buf_len;
+
+	// Compress
+	int rv = dlsym_BZ2_bzCompress(stream, finish ? BZ_FINISH : BZ_RUN);
+
+	jint no_compressed_bytes = 0;
+	switch (rv) {
+		// Contingency? - Report error by throwing appropriate exceptions
+		case BZ_STREAM_END:
+		{
+			(*env)->SetBooleanField(env, this, BZip2Compressor_finished, JNI_TRUE);
+		} // cascade
+		case BZ_RUN_OK:
+		case BZ_FINISH_OK:
+		{
+			uncompressed_direct_buf_off += uncompressed_direct_buf_len - stream->avail_in;
+			(*env)->SetIntField(env, this, 
+						BZip2Compressor_uncompressedDirectBufOff, uncompressed_direct_buf_off);
+			(*env)->SetIntField(env, this, 
+						BZip2Compressor_uncompressedDirectBufLen, stream->avail_in);
+			no_compressed_bytes = compressed_direct_buf_len - stream->avail_out;
+		}
+		break;
+		default:
+		{
+			THROW(env, "java/lang/InternalError", NULL);
+		}
+		break;
+	}
+
+	return no_compressed_bytes;
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_apache_hadoop_io_compress_bzip2_BZip2Compressor_getBytesRead(
+	JNIEnv *env, jclass class, jlong stream
+	) {
+	return BZ_TOTAL(BZSTREAM(stream)->total_in_lo32,
+	                BZSTREAM(stream)->total_in_hi32);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_apache_hadoop_io_compress_bzip2_BZip2Compressor_getBytesWritten(
+	JNIEnv *env, jclass class, jlong stream
+	) {
+	return BZ_TOTAL(BZSTREAM(stream)->total_out_lo32,
+	                BZSTREAM(stream)->total_out_hi32);
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_compress_bzip2_BZip2Compressor_end(
+	JNIEnv *env, jclass class, jlong stream
+	) {
+	if (dlsym_BZ2_bzCompressEnd(BZSTREAM(stream)) != BZ_OK) {
+		THROW(env, "java/lang/InternalError", NULL);
+	} else {
+		hadoop_pool_free(BZSTREAM(stream));
+	}
+}
+
+#endif //HAVE_BZLIB_H
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
@@ -0,0 +1,93 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined ORG_APACHE_HADOOP_IO_COMPRESS_BZIP2_BZIP2_H
+#define ORG_APACHE_HADOOP_IO_COMPRESS_BZIP2_BZIP2_H
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDDEF_H
+  #include <stddef.h>
+#else
+  #error 'stddef.h not found'
+#endif
+
+/*
+ * Native bzip2 support is optional; without bzlib.h the JNI entry points
+ * are not compiled and BZip2Compressor/BZip2Decompressor fall back to the
+ * pure-java implementation.
+ */
+#if defined HAVE_BZLIB_H
+  #include <bzlib.h>
+#endif
+
+#if defined HAVE_DLFCN_H
+  #include <dlfcn.h>
+#else
+  #error "dlfcn.h not found"
+#endif  
+
+#if defined HAVE_JNI_H    
+  #include <jni.h>
+#else
+  #error 'jni.h not found'
+#endif
+
+#include "org_apache_hadoop.h"
+#include "org/apache/hadoop/io/nativeio/org_apache_hadoop_io_nativeio.h"
+
+/* A helper macro to convert the java 'stream-handle' to a bz_stream pointer. */
+#define BZSTREAM(stream) ((bz_stream*)((ptrdiff_t)(stream)))
+
+/* A helper macro to convert the bz_stream pointer to the java 'stream-handle'. */
+#define JLONG(stream) ((jlong)((ptrdiff_t)(stream)))
+
+/* The total number of bytes counted by a bz_stream 64-bit counter. */
+#define BZ_TOTAL(lo32, hi32) \
+  ((jlong)(((unsigned long long)(hi32) << 32) | (unsigned int)(lo32)))
+
+#if defined HAVE_BZLIB_H
+
+/* bzip2 allocators that draw a stream's internal state from the buffer pool. */
+static void *hadoop_bzalloc(void *opaque, int n, int m) {
+  if (n < 0 || m < 0 || (m != 0 && (size_t)n > ((size_t)-1) / m)) {
+    return NULL;
+  }
+  return hadoop_pool_alloc((size_t)n * m);
+}
+
+static void hadoop_bzfree(void *opaque, void *address) {
+  hadoop_pool_free(address);
+}
+
+/* Allocate a bz_stream, set up to use the buffer pool, or NULL if out of memory. */
+static bz_stream *hadoop_new_bzstream() {
+  bz_stream *stream = hadoop_pool_alloc(sizeof(bz_stream));
+  if (stream) {
+    memset((void*)stream, 0, sizeof(bz_stream));
+    stream->bzalloc = hadoop_bzalloc;
+    stream->bzfree = hadoop_bzfree;
+  }
+  return stream;
+}
+
+#endif //HAVE_BZLIB_H
+
+#endif //ORG_APACHE_HADOOP_IO_COMPRESS_BZIP2_BZIP2_H
@@ -107,12 +107,11 @@ Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_init(
 	JNIEnv *env, jclass class, jint level, jint strategy, jint windowBits
 	) {
 	// Create a z_stream
-    z_stream *stream = malloc(sizeof(z_stream));
+    z_stream *stream = hadoop_new_zstream();
     if (!stream) {
 		THROW(env, "java/lang/OutOfMemoryError", NULL);
 		return (jlong)0;
     }
-    memset((void*)stream, 0, sizeof(z_stream));
 
 	// Initialize stream
 	static const int memLevel = 8; 							// See zconf.h
@@ -121,7 +120,7 @@ Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_init(
     			
     if (rv != Z_OK) {
 	    // Contingency - Report error by throwing appropriate exceptions
-	    free(stream);
+	    hadoop_pool_free(stream);
 	    stream = NULL;
 	
 		switch (rv) {
@@ -294,7 +293,7 @@ Java_org_apache_hadoop_io_compress_zlib_ZlibCompressor_end(
     if (dlsym_deflateEnd(ZSTREAM(stream)) == Z_STREAM_ERROR) {
 		THROW(env, "java/lang/InternalError", NULL);
     } else {
-		free(ZSTREAM(stream));
+		hadoop_pool_free(ZSTREAM(stream));
     }
 }
 
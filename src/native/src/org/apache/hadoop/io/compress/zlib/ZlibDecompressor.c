@@ -106,9 +106,7 @@ JNIEXPORT jlong JNICALL
 Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_init(
 	JNIEnv *env, jclass cls, jint windowBits
 	) {
-    z_stream *stream = malloc(sizeof(z_stream));
-    memset((void*)stream, 0, sizeof(z_stream));
-
+    z_stream *stream = hadoop_new_zstream();
     if (stream == 0) {
 		THROW(env, "java/lang/OutOfMemoryError", NULL);
 		return (jlong)0;
@@ -118,7 +116,7 @@ Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_init(
 
 	if (rv != Z_OK) {
 	    // Contingency - Report error by throwing appropriate exceptions
-		free(stream);
+		hadoop_pool_free(stream);
 		stream = NULL;
 		
 		switch (rv) {
@@ -307,7 +305,7 @@ Java_org_apache_hadoop_io_compress_zlib_ZlibDecompressor_end(
     if (dlsym_inflateEnd(ZSTREAM(stream)) == Z_STREAM_ERROR) {
 		THROW(env, "java/lang/InternalError", 0);
     } else {
-		free(ZSTREAM(stream));
+		hadoop_pool_free(ZSTREAM(stream));
     }
 }
 
@@ -54,6 +54,7 @@
 #endif
 
 #include "org_apache_hadoop.h"
+#include "org/apache/hadoop/io/nativeio/org_apache_hadoop_io_nativeio.h"
 
 /* A helper macro to convert the java 'stream-handle' to a z_stream pointer. */
 #define ZSTREAM(stream) ((z_stream*)((ptrdiff_t)(stream)))
@@ -61,4 +62,27 @@
 /* A helper macro to convert the z_stream pointer to the java 'stream-handle'. */
 #define JLONG(stream) ((jlong)((ptrdiff_t)(stream)))
 
+/* zlib allocators that draw a stream's internal state from the buffer pool. */
+static voidpf hadoop_zalloc(voidpf opaque, uInt items, uInt size) {
+  if (size != 0 && items > ((size_t)-1) / size) {
+    return Z_NULL;
+  }
+  return hadoop_pool_alloc((size_t)items * size);
+}
+
+static void hadoop_zfree(voidpf opaque, voidpf address) {
+  hadoop_pool_free(address);
+}
+
+/* Allocate a z_stream, set up to use the buffer pool, or NULL if out of memory. */
+static z_stream *hadoop_new_zstream() {
+  z_stream *stream = hadoop_pool_alloc(sizeof(z_stream));
+  if (stream) {
+    memset((void*)stream, 0, sizeof(z_stream));
+    stream->zalloc = hadoop_zalloc;
+    stream->zfree = hadoop_zfree;
+  }
+  return stream;
+}
+
 #endif //ORG_APACHE_HADOOP_IO_COMPRESS_ZLIB_ZLIB_H
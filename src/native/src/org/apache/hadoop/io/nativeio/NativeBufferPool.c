@@ -0,0 +1,349 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDIO_H
+  #include <stdio.h>
+#else
+  #error 'stdio.h not found'
+#endif
+
+#if defined HAVE_STDLIB_H
+  #include <stdlib.h>
+#else
+  #error 'stdlib.h not found'
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "org_apache_hadoop.h"
+#include "org_apache_hadoop_io_nativeio.h"
+#include "org_apache_hadoop_io_nativeio_NativeBufferPool.h"
+
+/* Blocks, and the header in front of each, are aligned to this. */
+#define POOL_ALIGN 64
+
+/* Size classes are the powers of two from 2^POOL_MIN_SHIFT to 2^POOL_MAX_SHIFT. */
+#define POOL_MIN_SHIFT 8
+#define POOL_MAX_SHIFT 22
+#define POOL_CLASSES (POOL_MAX_SHIFT - POOL_MIN_SHIFT + 1)
+#define POOL_UNPOOLED -1
+
+/* Default for the total size of cached blocks: 64 MB. */
+#define POOL_DEFAULT_CAPACITY (64L * 1024 * 1024)
+
+/* Initial number of slots in the table of live blocks. */
+#define LIVE_MIN_SLOTS 1024
+
+typedef struct pool_header {
+  struct pool_header *next;  /* next free block of the class, while cached */
+  size_t size;               /* usable size of the block */
+  int size_class;            /* POOL_UNPOOLED for oversized blocks */
+} pool_header;
+
+#define POOL_HEADER_SIZE POOL_ALIGN
+#define BLOCK(header) ((void *)((char *)(header) + POOL_HEADER_SIZE))
+#define HEADER(block) ((pool_header *)((char *)(block) - POOL_HEADER_SIZE))
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pool_header *free_lists[POOL_CLASSES];
+static size_t capacity = POOL_DEFAULT_CAPACITY;
+static size_t cached_bytes = 0;
+static size_t outstanding_bytes = 0;
+static jlong allocations = 0;
+static jlong hits = 0;
+
+/*
+ * The blocks held by callers, in an open addressing hash set with linear
+ * probing. A block is released only if its address is found here, so a
+ * foreign or already released address is rejected without touching the
+ * memory in front of it. Guarded by pool_lock.
+ */
+static void **live_slots = NULL;
+static size_t live_mask = 0;          /* number of slots - 1 */
+static size_t live_count = 0;
+
+static size_t live_hash(void *block) {
+  size_t h = (size_t)((uintptr_t)block / POOL_ALIGN) *
+    (size_t)0x9E3779B97F4A7C15ULL;
+  return h ^ (h >> 29);
+}
+
+static void live_insert(void **slots, size_t mask, void *block) {
+  size_t i = live_hash(block) & mask;
+  while (slots[i]) {
+    i = (i + 1) & mask;
+  }
+  slots[i] = block;
+}
+
+/* Add a block to the live set; returns -1 if the set cannot grow. */
+static int live_add(void *block) {
+  if (live_count + 1 > (live_mask + 1) / 2) {
+    size_t slots = live_slots ? (live_mask + 1) * 2 : LIVE_MIN_SLOTS;
+    void **grown = calloc(slots, sizeof(void *));
+    size_t i;
+    if (!grown) {
+      return -1;
+    }
+    for (i = 0; live_slots && i <= live_mask; i++) {
+      if (live_slots[i]) {
+        live_insert(grown, slots - 1, live_slots[i]);
+      }
+    }
+    free(live_slots);
+    live_slots = grown;
+    live_mask = slots - 1;
+  }
+  live_insert(live_slots, live_mask, block);
+  live_count++;
+  return 0;
+}
+
+/* Remove a block from the live set; returns -1 if it is not there. */
+static int live_remove(void *block) {
+  size_t i, j;
+  if (!live_slots) {
+    return -1;
+  }
+  for (i = live_hash(block) & live_mask; live_slots[i] != block;
+       i = (i + 1) & live_mask) {
+    if (!live_slots[i]) {
+      return -1;
+    }
+  }
+  // shift later entries of the probe sequence back into the hole
+  live_slots[i] = NULL;
+  for (j = (i + 1) & live_mask; live_slots[j]; j = (j + 1) & live_mask) {
+    size_t home = live_hash(live_slots[j]) & live_mask;
+    if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) {
+      continue;                         /* still reachable from its home */
+    }
+    live_slots[i] = live_slots[j];
+    live_slots[j] = NULL;
+    i = j;
+  }
+  live_count--;
+  return 0;
+}
+
+static int size_class(size_t size) {
+  int shift = POOL_MIN_SHIFT;
+  while (shift <= POOL_MAX_SHIFT && ((size_t)1 << shift) < size) {
+    shift++;
+  }
+  return shift > POOL_MAX_SHIFT ? POOL_UNPOOLED : shift - POOL_MIN_SHIFT;
+}
+
+void *hadoop_pool_alloc(size_t size) {
+  int cls = size_class(size);
+  size_t block_size = cls == POOL_UNPOOLED ?
+    size : (size_t)1 << (cls + POOL_MIN_SHIFT);
+  pool_header *header = NULL;
+  void *memory = NULL;
+  int added;
+
+  pthread_mutex_lock(&pool_lock);
+  allocations++;
+  if (cls != POOL_UNPOOLED && free_lists[cls] &&
+      live_add(BLOCK(free_lists[cls])) == 0) {
+    header = free_lists[cls];
+    free_lists[cls] = header->next;
+    cached_bytes -= block_size;
+    outstanding_bytes += block_size;
+    hits++;
+  }
+  pthread_mutex_unlock(&pool_lock);
+  if (header) {
+    header->next = NULL;
+    return BLOCK(header);
+  }
+
+  if (posix_memalign(&memory, POOL_ALIGN,
+                     POOL_HEADER_SIZE + block_size) != 0) {
+    return NULL;
+  }
+  header = (pool_header *)memory;
+  header->next = NULL;
+  header->size = block_size;
+  header->size_class = cls;
+
+  pthread_mutex_lock(&pool_lock);
+  added = live_add(BLOCK(header)) == 0;
+  if (added) {
+    outstanding_bytes += block_size;
+  }
+  pthread_mutex_unlock(&pool_lock);
+  if (!added) {
+    free(header);
+    return NULL;
+  }
+  return BLOCK(header);
+}
+
+int hadoop_pool_free(void *block) {
+  if (!block) {
+    return 0;
+  }
+  pool_header *header = HEADER(block);
+
+  pthread_mutex_lock(&pool_lock);
+  if (live_remove(block) != 0) {
+    pthread_mutex_unlock(&pool_lock);
+    return -1;
+  }
+  outstanding_bytes -= header->size;
+  if (header->size_class != POOL_UNPOOLED &&
+      cached_bytes + header->size <= capacity) {
+    header->next = free_lists[header->size_class];
+    free_lists[header->size_class] = header;
+    cached_bytes += header->size;
+    header = NULL;
+  }
+  pthread_mutex_unlock(&pool_lock);
+
+  if (header) {
+    free(header);
+  }
+  return 0;
+}
+
+/**
+ * Free cached blocks, largest first, until at most 'limit' bytes remain
+ * cached. Must be called with pool_lock held; returns the list of blocks
+ * to free once the lock is released.
+ */
+static pool_header *shrink(size_t limit) {
+  pool_header *released = NULL;
+  int cls;
+  for (cls = POOL_CLASSES - 1; cls >= 0 && cached_bytes > limit; cls--) {
+    while (free_lists[cls] && cached_bytes > limit) {
+      pool_header *header = free_lists[cls];
+      free_lists[cls] = header->next;
+      cached_bytes -= header->size;
+      header->next = released;
+      released = header;
+    }
+  }
+  return released;
+}
+
+static void free_all(pool_header *header) {
+  while (header) {
+    pool_header *next = header->next;
+    free(header);
+    header = next;
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeBufferPool_initIDs(
+  JNIEnv *env, jclass class
+  ) {
+  // Check that the JVM supports direct buffers created from JNI
+  void *block = hadoop_pool_alloc(1);
+  if (!block) {
+    THROW(env, "java/lang/OutOfMemoryError", NULL);
+    return;
+  }
+  jobject buf = (*env)->NewDirectByteBuffer(env, block, 1);
+  hadoop_pool_free(block);
+  if (!buf) {
+    if (!(*env)->ExceptionCheck(env)) {
+      THROW(env, "java/lang/UnsupportedOperationException",
+            "JNI access to direct buffers is not supported by this JVM");
+    }
+    return;
+  }
+  (*env)->DeleteLocalRef(env, buf);
+}
+
+JNIEXPORT jobject JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeBufferPool_allocateDirect(
+  JNIEnv *env, jclass class, jint size
+  ) {
+  if (size < 0) {
+    THROW(env, "java/lang/IllegalArgumentException", NULL);
+    return NULL;
+  }
+  void *block = hadoop_pool_alloc(size);
+  if (!block) {
+    THROW(env, "java/lang/OutOfMemoryError", "Native buffer pool");
+    return NULL;
+  }
+  jobject buf = (*env)->NewDirectByteBuffer(env, block, size);
+  if (!buf) {
+    hadoop_pool_free(block);
+  }
+  return buf;
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeBufferPool_release0(
+  JNIEnv *env, jclass class, jobject buf
+  ) {
+  void *block = (*env)->GetDirectBufferAddress(env, buf);
+  if (!block || hadoop_pool_free(block) != 0) {
+    THROW(env, "java/lang/IllegalArgumentException",
+          "Buffer was not allocated by the native buffer pool");
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeBufferPool_setCapacity0(
+  JNIEnv *env, jclass class, jlong bytes
+  ) {
+  pthread_mutex_lock(&pool_lock);
+  capacity = bytes < 0 ? 0 : (size_t)bytes;
+  pool_header *released = shrink(capacity);
+  pthread_mutex_unlock(&pool_lock);
+  free_all(released);
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeBufferPool_trim0(
+  JNIEnv *env, jclass class
+  ) {
+  pthread_mutex_lock(&pool_lock);
+  pool_header *released = shrink(0);
+  pthread_mutex_unlock(&pool_lock);
+  free_all(released);
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeBufferPool_getStats(
+  JNIEnv *env, jclass class, jlongArray stats
+  ) {
+  jlong values[5];
+  pthread_mutex_lock(&pool_lock);
+  values[0] = (jlong)capacity;
+  values[1] = (jlong)outstanding_bytes;
+  values[2] = (jlong)cached_bytes;
+  values[3] = allocations;
+  values[4] = hits;
+  pthread_mutex_unlock(&pool_lock);
+  (*env)->SetLongArrayRegion(env, stats, 0, 5, values);
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
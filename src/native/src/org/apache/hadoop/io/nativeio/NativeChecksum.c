@@ -0,0 +1,655 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDIO_H
+  #include <stdio.h>
+#else
+  #error 'stdio.h not found'
+#endif
+
+#if defined HAVE_STDLIB_H
+  #include <stdlib.h>
+#else
+  #error 'stdlib.h not found'
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "org_apache_hadoop.h"
+#include "org_apache_hadoop_io_nativeio_NativeChecksum.h"
+
+#ifndef O_CLOEXEC
+  #define O_CLOEXEC 0
+#endif
+
+/* The size of the reads of a file being checksummed. */
+#define READ_SIZE (1024 * 1024)
+
+/* Blocks are hashed four at a time while their CRCs take at most this. */
+#define MAX_LANE_BYTES (1024 * 1024)
+
+/* The most CRCs of one block that a file checksum will buffer. */
+#define MAX_BLOCK_CRCS (64 * 1024 * 1024)
+
+#define MD5_LEN 16
+
+/* ---------------------------------------------------------------------- */
+/* MD5, as in RFC 1321                                                    */
+
+#define MD5_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MD5_G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#define MD5_H(x, y, z) ((x) ^ (y) ^ (z))
+#define MD5_I(x, y, z) ((y) ^ ((x) | ~(z)))
+
+#define ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/*
+ * The 64 steps of the compression function, for STEP(f, a, b, c, d, x, t,
+ * s) and the message words X(i).
+ */
+#define MD5_ROUNDS(STEP, X) \
+  STEP(MD5_F, a, b, c, d, X( 0), 0xd76aa478,  7) \
+  STEP(MD5_F, d, a, b, c, X( 1), 0xe8c7b756, 12) \
+  STEP(MD5_F, c, d, a, b, X( 2), 0x242070db, 17) \
+  STEP(MD5_F, b, c, d, a, X( 3), 0xc1bdceee, 22) \
+  STEP(MD5_F, a, b, c, d, X( 4), 0xf57c0faf,  7) \
+  STEP(MD5_F, d, a, b, c, X( 5), 0x4787c62a, 12) \
+  STEP(MD5_F, c, d, a, b, X( 6), 0xa8304613, 17) \
+  STEP(MD5_F, b, c, d, a, X( 7), 0xfd469501, 22) \
+  STEP(MD5_F, a, b, c, d, X( 8), 0x698098d8,  7) \
+  STEP(MD5_F, d, a, b, c, X( 9), 0x8b44f7af, 12) \
+  STEP(MD5_F, c, d, a, b, X(10), 0xffff5bb1, 17) \
+  STEP(MD5_F, b, c, d, a, X(11), 0x895cd7be, 22) \
+  STEP(MD5_F, a, b, c, d, X(12), 0x6b901122,  7) \
+  STEP(MD5_F, d, a, b, c, X(13), 0xfd987193, 12) \
+  STEP(MD5_F, c, d, a, b, X(14), 0xa679438e, 17) \
+  STEP(MD5_F, b, c, d, a, X(15), 0x49b40821, 22) \
+  STEP(MD5_G, a, b, c, d, X( 1), 0xf61e2562,  5) \
+  STEP(MD5_G, d, a, b, c, X( 6), 0xc040b340,  9) \
+  STEP(MD5_G, c, d, a, b, X(11), 0x265e5a51, 14) \
+  STEP(MD5_G, b, c, d, a, X( 0), 0xe9b6c7aa, 20) \
+  STEP(MD5_G, a, b, c, d, X( 5), 0xd62f105d,  5) \
+  STEP(MD5_G, d, a, b, c, X(10), 0x02441453,  9) \
+  STEP(MD5_G, c, d, a, b, X(15), 0xd8a1e681, 14) \
+  STEP(MD5_G, b, c, d, a, X( 4), 0xe7d3fbc8, 20) \
+  STEP(MD5_G, a, b, c, d, X( 9), 0x21e1cde6,  5) \
+  STEP(MD5_G, d, a, b, c, X(14), 0xc33707d6,  9) \
+  STEP(MD5_G, c, d, a, b, X( 3), 0xf4d50d87, 14) \
+  STEP(MD5_G, b, c, d, a, X( 8), 0x455a14ed, 20) \
+  STEP(MD5_G, a, b, c, d, X(13), 0xa9e3e905,  5) \
+  STEP(MD5_G, d, a, b, c, X( 2), 0xfcefa3f8,  9) \
+  STEP(MD5_G, c, d, a, b, X( 7), 0x676f02d9, 14) \
+  STEP(MD5_G, b, c, d, a, X(12), 0x8d2a4c8a, 20) \
+  STEP(MD5_H, a, b, c, d, X( 5), 0xfffa3942,  4) \
+  STEP(MD5_H, d, a, b, c, X( 8), 0x8771f681, 11) \
+  STEP(MD5_H, c, d, a, b, X(11), 0x6d9d6122, 16) \
+  STEP(MD5_H, b, c, d, a, X(14), 0xfde5380c, 23) \
+  STEP(MD5_H, a, b, c, d, X( 1), 0xa4beea44,  4) \
+  STEP(MD5_H, d, a, b, c, X( 4), 0x4bdecfa9, 11) \
+  STEP(MD5_H, c, d, a, b, X( 7), 0xf6bb4b60, 16) \
+  STEP(MD5_H, b, c, d, a, X(10), 0xbebfbc70, 23) \
+  STEP(MD5_H, a, b, c, d, X(13), 0x289b7ec6,  4) \
+  STEP(MD5_H, d, a, b, c, X( 0), 0xeaa127fa, 11) \
+  STEP(MD5_H, c, d, a, b, X( 3), 0xd4ef3085, 16) \
+  STEP(MD5_H, b, c, d, a, X( 6), 0x04881d05, 23) \
+  STEP(MD5_H, a, b, c, d, X( 9), 0xd9d4d039,  4) \
+  STEP(MD5_H, d, a, b, c, X(12), 0xe6db99e5, 11) \
+  STEP(MD5_H, c, d, a, b, X(15), 0x1fa27cf8, 16) \
+  STEP(MD5_H, b, c, d, a, X( 2), 0xc4ac5665, 23) \
+  STEP(MD5_I, a, b, c, d, X( 0), 0xf4292244,  6) \
+  STEP(MD5_I, d, a, b, c, X( 7), 0x432aff97, 10) \
+  STEP(MD5_I, c, d, a, b, X(14), 0xab9423a7, 15) \
+  STEP(MD5_I, b, c, d, a, X( 5), 0xfc93a039, 21) \
+  STEP(MD5_I, a, b, c, d, X(12), 0x655b59c3,  6) \
+  STEP(MD5_I, d, a, b, c, X( 3), 0x8f0ccc92, 10) \
+  STEP(MD5_I, c, d, a, b, X(10), 0xffeff47d, 15) \
+  STEP(MD5_I, b, c, d, a, X( 1), 0x85845dd1, 21) \
+  STEP(MD5_I, a, b, c, d, X( 8), 0x6fa87e4f,  6) \
+  STEP(MD5_I, d, a, b, c, X(15), 0xfe2ce6e0, 10) \
+  STEP(MD5_I, c, d, a, b, X( 6), 0xa3014314, 15) \
+  STEP(MD5_I, b, c, d, a, X(13), 0x4e0811a1, 21) \
+  STEP(MD5_I, a, b, c, d, X( 4), 0xf7537e82,  6) \
+  STEP(MD5_I, d, a, b, c, X(11), 0xbd3af235, 10) \
+  STEP(MD5_I, c, d, a, b, X( 2), 0x2ad7d2bb, 15) \
+  STEP(MD5_I, b, c, d, a, X( 9), 0xeb86d391, 21)
+
+typedef struct md5_ctx {
+  uint32_t state[4];
+  uint64_t length;             /* bytes hashed so far */
+  unsigned char buf[64];       /* the partial block */
+} md5_ctx;
+
+static uint32_t load_le32(const unsigned char *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+         ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store_le32(unsigned char *p, uint32_t v) {
+  p[0] = (unsigned char)v;
+  p[1] = (unsigned char)(v >> 8);
+  p[2] = (unsigned char)(v >> 16);
+  p[3] = (unsigned char)(v >> 24);
+}
+
+static void store_be32(unsigned char *p, uint32_t v) {
+  p[0] = (unsigned char)(v >> 24);
+  p[1] = (unsigned char)(v >> 16);
+  p[2] = (unsigned char)(v >> 8);
+  p[3] = (unsigned char)v;
+}
+
+#define MD5_STEP(f, a, b, c, d, x, t, s) \
+  (a) += f((b), (c), (d)) + (x) + (uint32_t)(t); \
+  (a) = ROTL((a), (s)) + (b);
+
+static void md5_block(uint32_t *state, const unsigned char *p) {
+  uint32_t w[16];
+  int i;
+  for (i = 0; i < 16; i++) {
+    w[i] = load_le32(p + 4 * i);
+  }
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+#define MD5_WORD(i) w[i]
+  MD5_ROUNDS(MD5_STEP, MD5_WORD)
+#undef MD5_WORD
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+}
+
+static const uint32_t md5_initial_state[4] = {
+  0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476
+};
+
+static void md5_init(md5_ctx *ctx) {
+  memcpy(ctx->state, md5_initial_state, sizeof(ctx->state));
+  ctx->length = 0;
+}
+
+static void md5_update(md5_ctx *ctx, const unsigned char *p, size_t len) {
+  size_t used = ctx->length % 64;
+  ctx->length += len;
+  if (used) {
+    size_t n = 64 - used < len ? 64 - used : len;
+    memcpy(ctx->buf + used, p, n);
+    p += n;
+    len -= n;
+    if (used + n < 64) {
+      return;
+    }
+    md5_block(ctx->state, ctx->buf);
+  }
+  for (; len >= 64; p += 64, len -= 64) {
+    md5_block(ctx->state, p);
+  }
+  memcpy(ctx->buf, p, len);
+}
+
+/*
+ * Pad the tail of a message of 'length' bytes, whose last length % 64
+ * bytes are at tail, into one or two blocks.
+ *
+ * Returns the size of the padded tail, 64 or 128.
+ */
+static size_t md5_pad(unsigned char *out, const unsigned char *tail,
+                      uint64_t length) {
+  size_t used = length % 64;
+  size_t size = used < 56 ? 64 : 128;
+  memcpy(out, tail, used);
+  out[used] = 0x80;
+  memset(out + used + 1, 0, size - used - 9);
+  store_le32(out + size - 8, (uint32_t)(length << 3));
+  store_le32(out + size - 4, (uint32_t)(length >> 29));
+  return size;
+}
+
+static void md5_final(md5_ctx *ctx, unsigned char *digest) {
+  unsigned char tail[128];
+  size_t size = md5_pad(tail, ctx->buf, ctx->length);
+  size_t off;
+  int i;
+  for (off = 0; off < size; off += 64) {
+    md5_block(ctx->state, tail + off);
+  }
+  for (i = 0; i < 4; i++) {
+    store_le32(digest + 4 * i, ctx->state[i]);
+  }
+}
+
+static void md5(const unsigned char *p, size_t len, unsigned char *digest) {
+  md5_ctx ctx;
+  md5_init(&ctx);
+  md5_update(&ctx, p, len);
+  md5_final(&ctx, digest);
+}
+
+/*
+ * Four messages of the same length, hashed together: lane i of each vector
+ * holds the state of message i. Messages of one length are padded alike,
+ * so the lanes never diverge.
+ */
+#if defined __GNUC__
+
+typedef uint32_t v4u __attribute__((vector_size(16)));
+
+#define SPLAT(t) ((v4u){(t), (t), (t), (t)})
+
+#define MD5_STEP_X4(f, a, b, c, d, x, t, s) \
+  (a) += f((b), (c), (d)) + (x) + SPLAT((uint32_t)(t)); \
+  (a) = ROTL((a), (s)) + (b);
+
+static void md5_block_x4(v4u *state, const unsigned char *p[4]) {
+  v4u w[16];
+  int i;
+  for (i = 0; i < 16; i++) {
+    w[i] = (v4u){load_le32(p[0] + 4 * i), load_le32(p[1] + 4 * i),
+                 load_le32(p[2] + 4 * i), load_le32(p[3] + 4 * i)};
+  }
+  v4u a = state[0], b = state[1], c = state[2], d = state[3];
+#define MD5_WORD(i) w[i]
+  MD5_ROUNDS(MD5_STEP_X4, MD5_WORD)
+#undef MD5_WORD
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+}
+
+static void md5_x4(const unsigned char *msg[4], size_t len,
+                   unsigned char *digest[4]) {
+  v4u state[4];
+  const unsigned char *p[4];
+  unsigned char tails[4][128];
+  size_t off, size = 0;
+  int i, j;
+
+  for (j = 0; j < 4; j++) {
+    state[j] = SPLAT(md5_initial_state[j]);
+  }
+  for (off = 0; off + 64 <= len; off += 64) {
+    for (i = 0; i < 4; i++) {
+      p[i] = msg[i] + off;
+    }
+    md5_block_x4(state, p);
+  }
+  for (i = 0; i < 4; i++) {
+    size = md5_pad(tails[i], msg[i] + off, len);
+  }
+  for (off = 0; off < size; off += 64) {
+    for (i = 0; i < 4; i++) {
+      p[i] = tails[i] + off;
+    }
+    md5_block_x4(state, p);
+  }
+  for (i = 0; i < 4; i++) {
+    for (j = 0; j < 4; j++) {
+      store_le32(digest[i] + 4 * j, state[j][i]);
+    }
+  }
+}
+
+#else
+
+static void md5_x4(const unsigned char *msg[4], size_t len,
+                   unsigned char *digest[4]) {
+  int i;
+  for (i = 0; i < 4; i++) {
+    md5(msg[i], len, digest[i]);
+  }
+}
+
+#endif
+
+/* ---------------------------------------------------------------------- */
+/* CRC32 (the zlib polynomial), eight bytes at a time                     */
+
+static uint32_t crc_tables[8][256];
+static pthread_once_t crc_tables_once = PTHREAD_ONCE_INIT;
+
+static void make_crc_tables(void) {
+  uint32_t n, k;
+  for (n = 0; n < 256; n++) {
+    uint32_t c = n;
+    for (k = 0; k < 8; k++) {
+      c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+    }
+    crc_tables[0][n] = c;
+  }
+  for (n = 0; n < 256; n++) {
+    uint32_t c = crc_tables[0][n];
+    for (k = 1; k < 8; k++) {
+      c = crc_tables[0][c & 0xff] ^ (c >> 8);
+      crc_tables[k][n] = c;
+    }
+  }
+}
+
+/* Continue a CRC, without the initial and final inversion. */
+static uint32_t crc32_update(uint32_t crc, const unsigned char *p,
+                             size_t len) {
+  for (; len >= 8; p += 8, len -= 8) {
+    uint32_t lo = crc ^ load_le32(p);
+    uint32_t hi = load_le32(p + 4);
+    crc = crc_tables[7][lo & 0xff] ^ crc_tables[6][(lo >> 8) & 0xff] ^
+          crc_tables[5][(lo >> 16) & 0xff] ^ crc_tables[4][lo >> 24] ^
+          crc_tables[3][hi & 0xff] ^ crc_tables[2][(hi >> 8) & 0xff] ^
+          crc_tables[1][(hi >> 16) & 0xff] ^ crc_tables[0][hi >> 24];
+  }
+  for (; len; p++, len--) {
+    crc = crc_tables[0][(crc ^ *p) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+/* ---------------------------------------------------------------------- */
+/* MD5 of MD5 of CRC32 of a file                                          */
+
+/*
+ * The CRCs of each chunk of a block are hashed into an MD5 per block, and
+ * the MD5s of the blocks into the MD5 of the file, as HDFS does with the
+ * checksums kept beside each block. The CRCs of up to four complete blocks
+ * are buffered, so that blocks of one length are hashed side by side.
+ */
+typedef struct file_sum {
+  size_t bytes_per_crc;
+  uint64_t block_size;
+  size_t block_crc_bytes;      /* the CRC bytes of a whole block */
+  int lanes;                   /* blocks hashed together, 1 or 4 */
+  unsigned char *crcs;         /* lanes * block_crc_bytes */
+  size_t crc_len[4];           /* the CRC bytes of each buffered block */
+  int pending;                 /* complete blocks buffered */
+  uint32_t crc;                /* the CRC of the current chunk */
+  size_t chunk_len;            /* the bytes in the current chunk */
+  uint64_t block_len;          /* the bytes in the current block */
+  md5_ctx file_md5;
+} file_sum;
+
+static void flush_blocks(file_sum *sum) {
+  unsigned char digests[4][MD5_LEN];
+  int i;
+  if (sum->pending == 4 && sum->crc_len[0] == sum->crc_len[3]) {
+    const unsigned char *msg[4];
+    unsigned char *out[4];
+    for (i = 0; i < 4; i++) {
+      msg[i] = sum->crcs + i * sum->block_crc_bytes;
+      out[i] = digests[i];
+    }
+    md5_x4(msg, sum->crc_len[0], out);
+  } else {
+    for (i = 0; i < sum->pending; i++) {
+      md5(sum->crcs + i * sum->block_crc_bytes, sum->crc_len[i], digests[i]);
+    }
+  }
+  for (i = 0; i < sum->pending; i++) {
+    md5_update(&sum->file_md5, digests[i], MD5_LEN);
+    sum->crc_len[i] = 0;
+  }
+  sum->pending = 0;
+}
+
+static void end_chunk(file_sum *sum) {
+  unsigned char *p = sum->crcs + sum->pending * sum->block_crc_bytes;
+  store_be32(p + sum->crc_len[sum->pending], ~sum->crc);
+  sum->crc_len[sum->pending] += 4;
+  sum->crc = 0xffffffff;
+  sum->chunk_len = 0;
+}
+
+static void end_block(file_sum *sum) {
+  sum->block_len = 0;
+  if (++sum->pending == sum->lanes) {
+    flush_blocks(sum);
+  }
+}
+
+static void add_bytes(file_sum *sum, const unsigned char *p, size_t len) {
+  while (len) {
+    size_t n = sum->bytes_per_crc - sum->chunk_len;
+    if (n > len) {
+      n = len;
+    }
+    if (n > sum->block_size - sum->block_len) {
+      n = (size_t)(sum->block_size - sum->block_len);
+    }
+    sum->crc = crc32_update(sum->crc, p, n);
+    sum->chunk_len += n;
+    sum->block_len += n;
+    p += n;
+    len -= n;
+    if (sum->block_len == sum->block_size) {
+      end_chunk(sum);
+      end_block(sum);
+    } else if (sum->chunk_len == sum->bytes_per_crc) {
+      end_chunk(sum);
+    }
+  }
+}
+
+/*
+ * Compute the MD5 of MD5 of CRC32 of the file at path into digest.
+ *
+ * Returns 0, or an errno value with *what set to the call that failed.
+ */
+static int checksum_file(const char *path, size_t bytes_per_crc,
+                         uint64_t block_size, unsigned char *digest,
+                         const char **what) {
+  file_sum sum;
+  unsigned char *buf = NULL;
+  int fd = -1;
+  int err = 0;
+
+  memset(&sum, 0, sizeof(sum));
+  sum.bytes_per_crc = bytes_per_crc;
+  sum.block_size = block_size;
+  sum.block_crc_bytes =
+    (size_t)((block_size + bytes_per_crc - 1) / bytes_per_crc) * 4;
+  sum.lanes = sum.block_crc_bytes <= MAX_LANE_BYTES ? 4 : 1;
+  sum.crc = 0xffffffff;
+  md5_init(&sum.file_md5);
+
+  *what = "malloc";
+  sum.crcs = malloc(sum.lanes * sum.block_crc_bytes);
+  buf = malloc(READ_SIZE);
+  if (!sum.crcs || !buf) {
+    err = ENOMEM;
+    goto cleanup;
+  }
+  *what = "open";
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    err = errno;
+    goto cleanup;
+  }
+#if defined POSIX_FADV_SEQUENTIAL
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  *what = "read";
+  for (;;) {
+    ssize_t n = read(fd, buf, READ_SIZE);
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      err = errno;
+      goto cleanup;
+    }
+    if (n == 0) {
+      break;
+    }
+    add_bytes(&sum, buf, n);
+  }
+  if (sum.chunk_len > 0) {
+    end_chunk(&sum);
+  }
+  if (sum.block_len > 0) {
+    sum.pending++;
+  }
+  flush_blocks(&sum);
+  md5_final(&sum.file_md5, digest);
+
+cleanup:
+  if (fd != -1) {
+    close(fd);
+  }
+  free(buf);
+  free(sum.crcs);
+  return err;
+}
+
+static void throw_errno(JNIEnv *env, const char *what, const char *path,
+                        int err) {
+  char message[2 * PATH_MAX + 512];
+  snprintf(message, sizeof(message), "%s %s: %s", what, path, strerror(err));
+  THROW(env, err == ENOENT ? "java/io/FileNotFoundException"
+                           : "java/io/IOException", message);
+}
+
+/* ---------------------------------------------------------------------- */
+/* JNI                                                                    */
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeChecksum_init0(
+  JNIEnv *env, jclass clazz
+  ) {
+  pthread_once(&crc_tables_once, make_crc_tables);
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeChecksum_digest0(
+  JNIEnv *env, jclass clazz, jbyteArray data, jint off, jint len,
+  jbyteArray digest, jint digest_off
+  ) {
+  unsigned char out[MD5_LEN];
+  unsigned char *p = (*env)->GetPrimitiveArrayCritical(env, data, NULL);
+  if (!p) {
+    return;
+  }
+  md5(p + off, len, out);
+  (*env)->ReleasePrimitiveArrayCritical(env, data, p, JNI_ABORT);
+  (*env)->SetByteArrayRegion(env, digest, digest_off, MD5_LEN, (jbyte *)out);
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeChecksum_digestMulti0(
+  JNIEnv *env, jclass clazz, jobjectArray data, jint len, jbyteArray digests
+  ) {
+  jsize count = (*env)->GetArrayLength(env, data);
+  unsigned char *out;
+  jbyteArray arrays[4];
+  const unsigned char *msg[4];
+  unsigned char *dst[4];
+  jsize i, j;
+
+  for (i = 0; i < count; i += 4) {
+    int lanes = count - i < 4 ? count - i : 4;
+    // look the arrays up first: no other JNI calls are allowed in a
+    // critical region
+    for (j = 0; j < lanes; j++) {
+      arrays[j] = (*env)->GetObjectArrayElement(env, data, i + j);
+      if (!arrays[j]) {
+        for (; j > 0; j--) {
+          (*env)->DeleteLocalRef(env, arrays[j - 1]);
+        }
+        THROW(env, "java/lang/NullPointerException", "digestMulti");
+        return;
+      }
+    }
+    out = (*env)->GetPrimitiveArrayCritical(env, digests, NULL);
+    if (!out) {
+      return;
+    }
+    for (j = 0; j < lanes; j++) {
+      msg[j] = (*env)->GetPrimitiveArrayCritical(env, arrays[j], NULL);
+      dst[j] = out + (i + j) * MD5_LEN;
+      if (!msg[j]) {
+        break;
+      }
+    }
+    if (j < lanes) {
+      for (; j > 0; j--) {
+        (*env)->ReleasePrimitiveArrayCritical(env, arrays[j - 1],
+                                              (void *)msg[j - 1], JNI_ABORT);
+      }
+      (*env)->ReleasePrimitiveArrayCritical(env, digests, out, JNI_ABORT);
+      return;
+    }
+    if (lanes == 4) {
+      md5_x4(msg, len, dst);
+    } else {
+      for (j = 0; j < lanes; j++) {
+        md5(msg[j], len, dst[j]);
+      }
+    }
+    for (j = lanes - 1; j >= 0; j--) {
+      (*env)->ReleasePrimitiveArrayCritical(env, arrays[j], (void *)msg[j],
+                                            JNI_ABORT);
+    }
+    (*env)->ReleasePrimitiveArrayCritical(env, digests, out, 0);
+    for (j = 0; j < lanes; j++) {
+      (*env)->DeleteLocalRef(env, arrays[j]);
+    }
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeChecksum_fileChecksum0(
+  JNIEnv *env, jclass clazz, jbyteArray jpath, jint bytes_per_crc,
+  jlong block_size, jbyteArray digest
+  ) {
+  char path[PATH_MAX];
+  jsize path_len = (*env)->GetArrayLength(env, jpath);
+  unsigned char out[MD5_LEN];
+  const char *what;
+  int err;
+
+  if (path_len > PATH_MAX) {
+    THROW(env, "java/io/IOException", "Path too long");
+    return;
+  }
+  (*env)->GetByteArrayRegion(env, jpath, 0, path_len, (jbyte *)path);
+  path[path_len > 0 ? path_len - 1 : 0] = '\0';
+  if (((uint64_t)block_size + bytes_per_crc - 1) / bytes_per_crc
+      > MAX_BLOCK_CRCS) {
+    THROW(env, "java/lang/IllegalArgumentException",
+          "Too many CRCs per block");
+    return;
+  }
+  err = checksum_file(path, bytes_per_crc, block_size, out, &what);
+  if (err == ENOMEM) {
+    THROW(env, "java/lang/OutOfMemoryError", "fileChecksum");
+  } else if (err) {
+    throw_errno(env, what, path, err);
+  } else {
+    (*env)->SetByteArrayRegion(env, digest, 0, MD5_LEN, (jbyte *)out);
+  }
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
@@ -0,0 +1,312 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDIO_H
+  #include <stdio.h>
+#else
+  #error 'stdio.h not found'
+#endif
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "org_apache_hadoop.h"
+#include "org_apache_hadoop_io_nativeio_NativeIO.h"
+
+#ifndef O_DIRECTORY
+  #define O_DIRECTORY 0
+#endif
+
+#ifndef O_CLOEXEC
+  #define O_CLOEXEC 0
+#endif
+
+#ifndef O_NOFOLLOW
+  #define O_NOFOLLOW 0
+#endif
+
+/* Throw an IOException for errno err, or a FileNotFoundException if the
+ * file does not exist. */
+static void throw_errno(JNIEnv *env, const char *what, const char *path,
+                        int err) {
+  char message[2 * PATH_MAX + 512];
+  snprintf(message, sizeof(message), "%s %s: %s", what, path, strerror(err));
+  THROW(env, err == ENOENT ? "java/io/FileNotFoundException"
+                           : "java/io/IOException", message);
+}
+
+/*
+ * Copy a NUL-terminated Java byte array into buf, which holds PATH_MAX
+ * bytes.
+ *
+ * Returns 0, or -1 with an exception pending if the path is too long.
+ */
+static int get_path(JNIEnv *env, jbyteArray path, char *buf) {
+  jsize len = (*env)->GetArrayLength(env, path);
+  if (len > PATH_MAX) {
+    THROW(env, "java/io/IOException", "Path too long");
+    return -1;
+  }
+  (*env)->GetByteArrayRegion(env, path, 0, len, (jbyte *)buf);
+  buf[len > 0 ? len - 1 : 0] = '\0';
+  return 0;
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeIO_link0(
+  JNIEnv *env, jclass class, jbyteArray target, jbyteArray link_name
+  ) {
+  char from[PATH_MAX], to[PATH_MAX];
+  if (get_path(env, target, from) || get_path(env, link_name, to)) {
+    return;
+  }
+  if (link(from, to) == -1) {
+    throw_errno(env, "Failed to link", from, errno);
+  }
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeIO_symlink0(
+  JNIEnv *env, jclass class, jbyteArray target, jbyteArray link_name
+  ) {
+  char from[PATH_MAX], to[PATH_MAX];
+  if (get_path(env, target, from) || get_path(env, link_name, to)) {
+    return;
+  }
+  if (symlink(from, to) == -1) {
+    throw_errno(env, "Failed to create symlink", to, errno);
+  }
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeIO_readlink0(
+  JNIEnv *env, jclass class, jbyteArray link_name
+  ) {
+  char path[PATH_MAX], target[PATH_MAX];
+  if (get_path(env, link_name, path)) {
+    return NULL;
+  }
+  ssize_t len = readlink(path, target, sizeof(target));
+  if (len == -1) {
+    if (errno != EINVAL) {
+      throw_errno(env, "Failed to read link", path, errno);
+    }
+    return NULL;                        /* not a symlink */
+  }
+  if (len == sizeof(target)) {
+    THROW(env, "java/io/IOException", "Link target too long");
+    return NULL;
+  }
+  jbyteArray result = (*env)->NewByteArray(env, len);
+  if (result) {
+    (*env)->SetByteArrayRegion(env, result, 0, len, (jbyte *)target);
+  }
+  return result;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeIO_getLinkCount0(
+  JNIEnv *env, jclass class, jbyteArray file
+  ) {
+  char path[PATH_MAX];
+  struct stat st;
+  if (get_path(env, file, path)) {
+    return -1;
+  }
+  if (stat(path, &st) == -1) {
+    throw_errno(env, "Failed to get link count on", path, errno);
+    return -1;
+  }
+  return (jint)st.st_nlink;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeIO_linkAll0(
+  JNIEnv *env, jclass class, jbyteArray src_dir, jobjectArray names,
+  jbyteArray dst_dir
+  ) {
+  char src[PATH_MAX], dst[PATH_MAX], name[PATH_MAX];
+  int src_fd = -1, dst_fd = -1;
+  jint linked = 0;
+
+  if (get_path(env, src_dir, src) || get_path(env, dst_dir, dst)) {
+    return 0;
+  }
+  // each link is resolved relative to the open directories, so the two
+  // paths are looked up once rather than once per file
+  src_fd = open(src, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (src_fd == -1) {
+    throw_errno(env, "Failed to open", src, errno);
+    goto cleanup;
+  }
+  dst_fd = open(dst, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dst_fd == -1) {
+    throw_errno(env, "Failed to open", dst, errno);
+    goto cleanup;
+  }
+  jsize n = (*env)->GetArrayLength(env, names);
+  for (linked = 0; linked < n; linked++) {
+    jbyteArray b = (*env)->GetObjectArrayElement(env, names, linked);
+    int ret = get_path(env, b, name);
+    (*env)->DeleteLocalRef(env, b);
+    if (ret) {
+      goto cleanup;
+    }
+    if (linkat(src_fd, name, dst_fd, name, 0) == -1) {
+      char path[2 * PATH_MAX];
+      snprintf(path, sizeof(path), "%s/%s", src, name);
+      throw_errno(env, "Failed to link", path, errno);
+      goto cleanup;
+    }
+  }
+
+cleanup:
+  if (src_fd != -1) {
+    close(src_fd);
+  }
+  if (dst_fd != -1) {
+    close(dst_fd);
+  }
+  return linked;
+}
+
+/* A growing list of NUL-separated names. */
+struct name_list {
+  char *buf;
+  size_t len;
+  size_t cap;
+  jsize count;
+};
+
+static int add_name(struct name_list *list, const char *name) {
+  size_t n = strlen(name) + 1;
+  if (list->len + n > list->cap) {
+    size_t cap = list->cap ? list->cap * 2 : 4096;
+    while (cap < list->len + n) {
+      cap *= 2;
+    }
+    char *buf = realloc(list->buf, cap);
+    if (!buf) {
+      return -1;
+    }
+    list->buf = buf;
+    list->cap = cap;
+  }
+  memcpy(list->buf + list->len, name, n);
+  list->len += n;
+  list->count++;
+  return 0;
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeIO_deleteEntries0(
+  JNIEnv *env, jclass class, jbyteArray dir, jintArray failures
+  ) {
+  char path[PATH_MAX];
+  struct name_list subdirs = {NULL, 0, 0, 0};
+  jint failed = 0;
+  jobjectArray result = NULL;
+
+  if (get_path(env, dir, path)) {
+    return NULL;
+  }
+  // never follow a symlink that replaced the directory
+  int fd = open(path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd == -1) {
+    return NULL;
+  }
+  DIR *d = fdopendir(fd);
+  if (!d) {
+    close(fd);
+    return NULL;
+  }
+  struct dirent *entry;
+  while ((entry = readdir(d)) != NULL) {
+    const char *name = entry->d_name;
+    if (name[0] == '.' && (name[1] == '\0' ||
+                           (name[1] == '.' && name[2] == '\0'))) {
+      continue;
+    }
+    int is_dir;
+#if defined DT_DIR
+    if (entry->d_type != DT_UNKNOWN) {
+      is_dir = entry->d_type == DT_DIR;
+    } else
+#endif
+    {
+      struct stat st;
+      if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+        failed++;
+        continue;
+      }
+      is_dir = S_ISDIR(st.st_mode);
+    }
+    if (!is_dir) {
+      // files and symlinks, whatever they point to
+      if (unlinkat(fd, name, 0) == -1 && errno != ENOENT) {
+        failed++;
+      }
+    } else if (unlinkat(fd, name, AT_REMOVEDIR) == -1 && errno != ENOENT) {
+      // not empty; the caller walks it
+      if (add_name(&subdirs, name) == -1) {
+        THROW(env, "java/lang/OutOfMemoryError", "deleteEntries");
+        goto cleanup;
+      }
+    }
+  }
+
+  result = (*env)->NewObjectArray(env, subdirs.count,
+             (*env)->FindClass(env, "[B"), NULL);
+  if (result) {
+    const char *name = subdirs.buf;
+    jsize i;
+    for (i = 0; i < subdirs.count; i++) {
+      jsize n = strlen(name);
+      jbyteArray b = (*env)->NewByteArray(env, n);
+      if (!b) {
+        result = NULL;
+        goto cleanup;
+      }
+      (*env)->SetByteArrayRegion(env, b, 0, n, (const jbyte *)name);
+      (*env)->SetObjectArrayElement(env, result, i, b);
+      (*env)->DeleteLocalRef(env, b);
+      name += n + 1;
+    }
+  }
+  (*env)->SetIntArrayRegion(env, failures, 0, 1, &failed);
+
+cleanup:
+  closedir(d);
+  free(subdirs.buf);
+  return result;
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
@@ -0,0 +1,505 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDIO_H
+  #include <stdio.h>
+#else
+  #error 'stdio.h not found'
+#endif
+
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "org_apache_hadoop.h"
+#include "org_apache_hadoop_io_nativeio_NativeProcess.h"
+
+/* The status reported for a child that was reaped by someone else. */
+#define UNKNOWN_STATUS -1
+
+/* The status reported by reap0 for a child that is still running. */
+#define RUNNING -2
+
+extern char **environ;
+
+static jclass fd_class = NULL;
+static jmethodID fd_ctor = NULL;
+static jfieldID fd_field = NULL;
+
+/* Written to by wakeReaper0 to end a waitExitFds0 early. */
+static int wake_pipe[2] = {-1, -1};
+
+#if defined(__linux__) && !defined(SYS_pidfd_open)
+#define SYS_pidfd_open 434
+#endif
+
+/*
+ * Everything the child needs between vfork and exec. It is prepared by the
+ * parent, because the child shares the parent's memory and may only make
+ * system calls until it execs.
+ */
+struct spawn_args {
+  const char *path;
+  char **argv;
+  char **shargv;              /* /bin/sh, path, argv[1..]: for ENOEXEC */
+  char **envp;
+  const char *dir;
+  int fds[3];                 /* the child's ends of stdin, stdout, stderr */
+  int max_fd;                 /* close every descriptor from 3 to this */
+  volatile int err;           /* set by the child if it cannot exec */
+};
+
+static void throw_errno(JNIEnv *env, const char *what, int err) {
+  char message[512];
+  snprintf(message, sizeof(message), "%s: error=%d, %s", what, err,
+           strerror(err));
+  THROW(env, "java/io/IOException", message);
+}
+
+/* Close descriptors from 3 up; the JVM does not open its files with
+ * O_CLOEXEC, and the child must not keep the daemon's sockets open. */
+static void close_descriptors(int max_fd) {
+#if defined SYS_close_range
+  if (syscall(SYS_close_range, 3, ~0U, 0) == 0) {
+    return;
+  }
+#endif
+  int fd;
+  for (fd = 3; fd <= max_fd; fd++) {
+    close(fd);
+  }
+}
+
+/*
+ * Runs in the vforked child: set up the descriptors, the directory and the
+ * signals, and exec. Only async-signal-safe calls are allowed here, and no
+ * memory of the parent may be written except args->err.
+ */
+static void child_exec(struct spawn_args *args) {
+  int i;
+  for (i = 0; i < 3; i++) {
+    if (dup2(args->fds[i], i) == -1) {
+      args->err = errno;
+      _exit(127);
+    }
+  }
+  close_descriptors(args->max_fd);
+  if (args->dir && chdir(args->dir) == -1) {
+    args->err = errno;
+    _exit(127);
+  }
+  // the JVM's handlers must not run in the child; exec keeps ignored
+  // signals ignored and resets the rest
+  struct sigaction sa;
+  for (i = 1; i < NSIG; i++) {
+    if (sigaction(i, NULL, &sa) == 0 && sa.sa_handler != SIG_DFL &&
+        sa.sa_handler != SIG_IGN) {
+      sa.sa_handler = SIG_DFL;
+      sa.sa_flags = 0;
+      sigaction(i, &sa, NULL);
+    }
+  }
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigprocmask(SIG_SETMASK, &mask, NULL);
+
+  execve(args->path, args->argv, args->envp);
+  if (errno == ENOEXEC) {
+    // a script without #!, which execvp would also run with the shell
+    execve("/bin/sh", args->shargv, args->envp);
+  }
+  args->err = errno;
+  _exit(127);
+}
+
+/* Create a pipe whose ends are not stdin, stdout or stderr. */
+static int make_pipe(int p[2]) {
+  if (pipe(p) == -1) {
+    return -1;
+  }
+  int i;
+  for (i = 0; i < 2; i++) {
+    if (p[i] < 3) {
+      int fd = fcntl(p[i], F_DUPFD, 3);
+      if (fd == -1) {
+        int err = errno;
+        close(p[0]);
+        close(p[1]);
+        errno = err;
+        return -1;
+      }
+      close(p[i]);
+      p[i] = fd;
+    }
+  }
+  return 0;
+}
+
+/* The highest descriptor the child may have inherited, for kernels
+ * without close_range. Scanning the open descriptors keeps a daemon with a
+ * huge descriptor limit from making a million close calls per launch. */
+static int highest_fd() {
+  DIR *dir = opendir("/proc/self/fd");
+  if (dir) {
+    int max = 2;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+      int fd = atoi(entry->d_name);
+      if (fd > max) {
+        max = fd;
+      }
+    }
+    closedir(dir);
+    // allow for descriptors that other threads open meanwhile
+    return max + 64;
+  }
+  long max = sysconf(_SC_OPEN_MAX);
+  return max > 0 && max < 1024 * 1024 ? (int)max : 1024 * 1024;
+}
+
+/* Copy a NUL-terminated Java byte array into a new C string. */
+static char *to_string(JNIEnv *env, jbyteArray b) {
+  jsize len = (*env)->GetArrayLength(env, b);
+  char *s = malloc(len);
+  if (s) {
+    (*env)->GetByteArrayRegion(env, b, 0, len, (jbyte *)s);
+  }
+  return s;
+}
+
+static void free_strings(char **strings) {
+  if (strings) {
+    char **s;
+    for (s = strings; *s; s++) {
+      free(*s);
+    }
+    free(strings);
+  }
+}
+
+/* Copy a Java array of NUL-terminated byte arrays into a NULL-terminated
+ * array of C strings. */
+static char **to_strings(JNIEnv *env, jobjectArray array) {
+  jsize n = (*env)->GetArrayLength(env, array);
+  char **strings = calloc(n + 1, sizeof(char *));
+  jsize i;
+  for (i = 0; strings && i < n; i++) {
+    jbyteArray b = (*env)->GetObjectArrayElement(env, array, i);
+    strings[i] = to_string(env, b);
+    (*env)->DeleteLocalRef(env, b);
+    if (!strings[i]) {
+      free_strings(strings);
+      strings = NULL;
+    }
+  }
+  return strings;
+}
+
+static void close_all(int *fds, int n) {
+  int i;
+  for (i = 0; i < n; i++) {
+    if (fds[i] != -1) {
+      close(fds[i]);
+      fds[i] = -1;
+    }
+  }
+}
+
+static jobject new_fd(JNIEnv *env, int fd) {
+  jobject obj = (*env)->NewObject(env, fd_class, fd_ctor);
+  if (obj) {
+    (*env)->SetIntField(env, obj, fd_field, fd);
+  }
+  return obj;
+}
+
+/*
+ * Start the child described by args. The parent's ends of its stdin,
+ * stdout and stderr are stored in parent_fds.
+ *
+ * Returns the child's pid, or -1 with an exception pending.
+ */
+static pid_t start_child(JNIEnv *env, struct spawn_args *args,
+                         int parent_fds[3]) {
+  int pipes[3][2];
+  int i;
+  for (i = 0; i < 3; i++) {
+    if (make_pipe(pipes[i]) == -1) {
+      throw_errno(env, "pipe", errno);
+      for (i--; i >= 0; i--) {
+        close_all(pipes[i], 2);
+      }
+      return -1;
+    }
+  }
+  // the child reads stdin and writes stdout and stderr
+  args->fds[0] = pipes[0][0];
+  args->fds[1] = pipes[1][1];
+  args->fds[2] = pipes[2][1];
+  parent_fds[0] = pipes[0][1];
+  parent_fds[1] = pipes[1][0];
+  parent_fds[2] = pipes[2][0];
+  for (i = 0; i < 3; i++) {
+    fcntl(parent_fds[i], F_SETFD, FD_CLOEXEC);
+  }
+
+  // no JVM handler may run in the child before it resets them
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  pid_t pid = vfork();
+  if (pid == 0) {
+    child_exec(args);
+  }
+  int err = errno;
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  close_all(args->fds, 3);
+  if (pid == -1) {
+    close_all(parent_fds, 3);
+    throw_errno(env, "vfork", err);
+    return -1;
+  }
+  if (args->err) {
+    // the child could not exec, and has already exited
+    while (waitpid(pid, NULL, 0) == -1 && errno == EINTR);
+    close_all(parent_fds, 3);
+    throw_errno(env, args->path, args->err);
+    return -1;
+  }
+  return pid;
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeProcess_initIDs(
+  JNIEnv *env, jclass class
+  ) {
+  jclass cls = (*env)->FindClass(env, "java/io/FileDescriptor");
+  if (!cls) {
+    return;
+  }
+  fd_ctor = (*env)->GetMethodID(env, cls, "<init>", "()V");
+  fd_field = (*env)->GetFieldID(env, cls, "fd", "I");
+  if (!fd_ctor || !fd_field) {
+    return;                             /* the pending exception says why */
+  }
+  fd_class = (*env)->NewGlobalRef(env, cls);
+
+  if (make_pipe(wake_pipe) == -1) {
+    throw_errno(env, "pipe", errno);
+    return;
+  }
+  int i;
+  for (i = 0; i < 2; i++) {
+    fcntl(wake_pipe[i], F_SETFD, FD_CLOEXEC);
+    fcntl(wake_pipe[i], F_SETFL, fcntl(wake_pipe[i], F_GETFL) | O_NONBLOCK);
+  }
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeProcess_spawn(
+  JNIEnv *env, jclass class, jbyteArray path, jobjectArray argv,
+  jobjectArray envp, jbyteArray dir, jobjectArray fds
+  ) {
+  struct spawn_args args;
+  int parent_fds[3] = {-1, -1, -1};
+  pid_t pid = -1;
+  int i;
+
+  memset(&args, 0, sizeof(args));
+  char *path_str = to_string(env, path);
+  char *dir_str = dir ? to_string(env, dir) : NULL;
+  args.argv = to_strings(env, argv);
+  args.envp = envp ? to_strings(env, envp) : environ;
+  jsize argc = (*env)->GetArrayLength(env, argv);
+  args.shargv = calloc(argc + 2, sizeof(char *));
+  if (!path_str || (dir && !dir_str) || !args.argv || !args.envp ||
+      !args.shargv) {
+    THROW(env, "java/lang/OutOfMemoryError", "spawn");
+    goto cleanup;
+  }
+  args.path = path_str;
+  args.dir = dir_str;
+  args.shargv[0] = "/bin/sh";
+  args.shargv[1] = path_str;
+  for (i = 1; i < argc; i++) {
+    args.shargv[i + 1] = args.argv[i];
+  }
+  args.max_fd = highest_fd();
+
+  pid = start_child(env, &args, parent_fds);
+  if (pid == -1) {
+    goto cleanup;
+  }
+  for (i = 0; i < 3; i++) {
+    jobject fd = new_fd(env, parent_fds[i]);
+    if (!fd) {
+      // out of memory: the Java side kills the child
+      close_all(parent_fds + i, 3 - i);
+      break;
+    }
+    (*env)->SetObjectArrayElement(env, fds, i, fd);
+    (*env)->DeleteLocalRef(env, fd);
+  }
+
+cleanup:
+  free(path_str);
+  free(dir_str);
+  free_strings(args.argv);
+  if (args.envp != environ) {
+    free_strings(args.envp);
+  }
+  free(args.shargv);                  /* its strings belong to argv */
+  return pid;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeProcess_reap0(
+  JNIEnv *env, jclass class, jint pid
+  ) {
+  int status;
+  pid_t ret;
+  while ((ret = waitpid(pid, &status, WNOHANG)) == -1 && errno == EINTR);
+  if (ret == 0) {
+    return RUNNING;
+  }
+  if (ret == -1) {
+    return UNKNOWN_STATUS;
+  }
+  if (WIFEXITED(status)) {
+    return WEXITSTATUS(status);
+  }
+  // as the shell reports it
+  return WIFSIGNALED(status) ? 0x80 + WTERMSIG(status) : UNKNOWN_STATUS;
+}
+
+/*
+ * A descriptor that becomes readable when the child exits, without
+ * reaping it, or -1 if the kernel has none (Linux before 5.3).
+ */
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeProcess_openExitFd0(
+  JNIEnv *env, jclass class, jint pid
+  ) {
+#ifdef SYS_pidfd_open
+  return syscall(SYS_pidfd_open, pid, 0);
+#else
+  return -1;
+#endif
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeProcess_closeExitFd0(
+  JNIEnv *env, jclass class, jint fd
+  ) {
+  close(fd);
+}
+
+/*
+ * Block until one of the exit descriptors is readable, or until
+ * wakeReaper0 is called. Returns the readable descriptors.
+ */
+JNIEXPORT jintArray JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeProcess_waitExitFds0(
+  JNIEnv *env, jclass class, jintArray fds
+  ) {
+  jsize n = (*env)->GetArrayLength(env, fds);
+  struct pollfd *pfds = calloc(n + 1, sizeof(struct pollfd));
+  jint *ready = malloc((n + 1) * sizeof(jint));
+  jintArray result = NULL;
+  if (!pfds || !ready) {
+    THROW(env, "java/lang/OutOfMemoryError", "waitExitFds");
+    goto cleanup;
+  }
+  jsize i;
+  for (i = 0; i < n; i++) {
+    (*env)->GetIntArrayRegion(env, fds, i, 1, &pfds[i].fd);
+    pfds[i].events = POLLIN;
+  }
+  pfds[n].fd = wake_pipe[0];
+  pfds[n].events = POLLIN;
+
+  while (poll(pfds, n + 1, -1) == -1) {
+    if (errno != EINTR) {
+      throw_errno(env, "poll", errno);
+      goto cleanup;
+    }
+  }
+  if (pfds[n].revents) {
+    char buf[64];
+    while (read(wake_pipe[0], buf, sizeof(buf)) > 0);
+  }
+  jsize count = 0;
+  for (i = 0; i < n; i++) {
+    if (pfds[i].revents) {
+      ready[count++] = pfds[i].fd;
+    }
+  }
+  result = (*env)->NewIntArray(env, count);
+  if (result) {
+    (*env)->SetIntArrayRegion(env, result, 0, count, ready);
+  }
+
+cleanup:
+  free(pfds);
+  free(ready);
+  return result;
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeProcess_wakeReaper0(
+  JNIEnv *env, jclass class
+  ) {
+  if (write(wake_pipe[1], "", 1) == -1) {
+    // the pipe is full, so the reaper is woken anyway
+  }
+}
+
+/* Block until the child exits, without reaping it. */
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeProcess_waitExit0(
+  JNIEnv *env, jclass class, jint pid
+  ) {
+  siginfo_t info;
+  while (waitid(P_PID, pid, &info, WEXITED | WNOWAIT) == -1 &&
+         errno == EINTR);
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeProcess_kill0(
+  JNIEnv *env, jclass class, jint pid
+  ) {
+  kill(pid, SIGTERM);
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
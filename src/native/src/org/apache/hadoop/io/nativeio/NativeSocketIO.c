@@ -0,0 +1,322 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDIO_H
+  #include <stdio.h>
+#else
+  #error 'stdio.h not found'
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "org_apache_hadoop.h"
+#include "org_apache_hadoop_io_nativeio.h"
+#include "org_apache_hadoop_io_nativeio_NativeSocketIO.h"
+
+/* Heap arrays are copied through a pooled native buffer of at most this size. */
+#define STAGING_MAX (64 * 1024)
+
+/* Result of timed_io when the socket did not become ready in time. */
+#define IO_TIMEOUT -2
+
+/* Result when the descriptor no longer refers to the socket. */
+#define IO_CLOSED -3
+
+/* The operations of NativeSocketIO.poll, as in java.nio.channels.SelectionKey. */
+#define OP_READ 1
+#define OP_WRITE 4
+
+#ifndef MSG_NOSIGNAL
+  #define MSG_NOSIGNAL 0
+#endif
+
+static jclass channel_class = NULL;
+static jfieldID fd_field = NULL;
+
+static long long now_millis() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * Wait until fd is ready for the given poll events, or until the deadline.
+ * Errors and hangups count as ready; the I/O that follows reports them.
+ *
+ * Returns 1 if ready, 0 on timeout, -1 with errno set on failure.
+ */
+static int wait_ready(int fd, short events, long long deadline) {
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = events;
+  for (;;) {
+    long long remaining = deadline - now_millis();
+    if (remaining <= 0) {
+      return 0;
+    }
+    pfd.revents = 0;
+    int ret = poll(&pfd, 1, (int)remaining);
+    if (ret >= 0) {
+      return ret > 0 ? 1 : 0;
+    }
+    if (errno != EINTR) {
+      return -1;
+    }
+  }
+}
+
+/*
+ * Do one read or write on the non-blocking socket fd. The I/O is tried
+ * first, and fd is only polled when it would block.
+ *
+ * Returns the number of bytes transferred, 0 at the end of stream,
+ * IO_TIMEOUT if fd did not become ready within timeout milliseconds, or
+ * -1 with errno set on failure.
+ */
+static ssize_t timed_io(int fd, char *buf, size_t len, int writing,
+                        int timeout) {
+  long long deadline = now_millis() + timeout;
+  for (;;) {
+    ssize_t n = writing ? send(fd, buf, len, MSG_NOSIGNAL)
+                        : recv(fd, buf, len, 0);
+    if (n >= 0) {
+      return n;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      return -1;
+    }
+    int ready = wait_ready(fd, writing ? POLLOUT : POLLIN, deadline);
+    if (ready <= 0) {
+      return ready == 0 ? IO_TIMEOUT : -1;
+    }
+  }
+}
+
+/*
+ * Duplicate fd if it still refers to the socket whose inode number is id.
+ * The I/O is done on the duplicate, which keeps the socket open, and its
+ * own number taken, even if another thread closes fd meanwhile; fd itself
+ * may then be reused by another file, which the inode check detects.
+ *
+ * Returns the duplicate, or -1 with errno set. errno is EBADF if fd was
+ * closed or refers to another file.
+ */
+static int acquire(int fd, jlong id) {
+  struct stat st;
+#ifdef F_DUPFD_CLOEXEC
+  int dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+#else
+  int dup_fd = fcntl(fd, F_DUPFD, 0);
+#endif
+  if (dup_fd == -1) {
+    return -1;
+  }
+  if (fstat(dup_fd, &st) != 0 || !S_ISSOCK(st.st_mode) ||
+      (jlong)st.st_ino != id) {
+    close(dup_fd);
+    errno = EBADF;
+    return -1;
+  }
+  return dup_fd;
+}
+
+static void release(int dup_fd) {
+  int err = errno;
+  close(dup_fd);
+  errno = err;
+}
+
+static void throw_errno(JNIEnv *env, int err) {
+  char message[256];
+  snprintf(message, sizeof(message), "%s", strerror(err));
+  THROW(env, "java/io/IOException", message);
+}
+
+/* Map a timed_io result to the Java convention of NativeSocketIO. */
+static jint result(JNIEnv *env, ssize_t n, int writing) {
+  if (n == -1 && errno == EBADF) {
+    return IO_CLOSED;
+  }
+  if (n == -1) {
+    throw_errno(env, errno);
+    return -1;
+  }
+  if (n == 0 && !writing) {
+    return -1;                          /* end of stream */
+  }
+  return (jint)n;
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeSocketIO_initIDs(
+  JNIEnv *env, jclass class
+  ) {
+  jclass cls = (*env)->FindClass(env, "sun/nio/ch/SocketChannelImpl");
+  if (cls) {
+    fd_field = (*env)->GetFieldID(env, cls, "fdVal", "I");
+  }
+  if (!cls || !fd_field) {
+    // Another JVM's channels; getFD0 reports that no descriptor is known.
+    (*env)->ExceptionClear(env);
+    fd_field = NULL;
+    return;
+  }
+  channel_class = (*env)->NewGlobalRef(env, cls);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeSocketIO_getFD0(
+  JNIEnv *env, jclass class, jobject channel
+  ) {
+  if (!channel_class || !(*env)->IsInstanceOf(env, channel, channel_class)) {
+    return -1;
+  }
+  return (*env)->GetIntField(env, channel, fd_field);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeSocketIO_getSocketId0(
+  JNIEnv *env, jclass class, jint fd
+  ) {
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISSOCK(st.st_mode)) {
+    return -1;
+  }
+  return (jlong)st.st_ino;
+}
+
+static jint direct_io(JNIEnv *env, jint fd, jlong id, jobject buf, jint off,
+                      jint len, int writing, jint timeout) {
+  char *addr = (*env)->GetDirectBufferAddress(env, buf);
+  if (!addr) {
+    THROW(env, "java/lang/IllegalArgumentException",
+          "Not a direct buffer");
+    return -1;
+  }
+  int dup_fd = acquire(fd, id);
+  if (dup_fd == -1) {
+    return result(env, -1, writing);
+  }
+  ssize_t n = timed_io(dup_fd, addr + off, len, writing, timeout);
+  release(dup_fd);
+  return result(env, n, writing);
+}
+
+static jint array_io(JNIEnv *env, jint fd, jlong id, jbyteArray b, jint off,
+                     jint len, int writing, jint timeout) {
+  size_t size = len < STAGING_MAX ? len : STAGING_MAX;
+  char *staging = hadoop_pool_alloc(size);
+  if (!staging) {
+    THROW(env, "java/lang/OutOfMemoryError", "Native buffer pool");
+    return -1;
+  }
+  if (writing) {
+    (*env)->GetByteArrayRegion(env, b, off, size, (jbyte *)staging);
+  }
+  ssize_t n = -1;
+  int dup_fd = acquire(fd, id);
+  if (dup_fd != -1) {
+    n = timed_io(dup_fd, staging, size, writing, timeout);
+    release(dup_fd);
+  }
+  if (!writing && n > 0) {
+    (*env)->SetByteArrayRegion(env, b, off, n, (jbyte *)staging);
+  }
+  int err = errno;
+  hadoop_pool_free(staging);
+  errno = err;
+  return result(env, n, writing);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeSocketIO_readDirect(
+  JNIEnv *env, jclass class, jint fd, jlong id, jobject buf, jint off,
+  jint len, jint timeout
+  ) {
+  return direct_io(env, fd, id, buf, off, len, 0, timeout);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeSocketIO_readArray(
+  JNIEnv *env, jclass class, jint fd, jlong id, jbyteArray b, jint off,
+  jint len, jint timeout
+  ) {
+  return array_io(env, fd, id, b, off, len, 0, timeout);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeSocketIO_writeDirect(
+  JNIEnv *env, jclass class, jint fd, jlong id, jobject buf, jint off,
+  jint len, jint timeout
+  ) {
+  return direct_io(env, fd, id, buf, off, len, 1, timeout);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeSocketIO_writeArray(
+  JNIEnv *env, jclass class, jint fd, jlong id, jbyteArray b, jint off,
+  jint len, jint timeout
+  ) {
+  return array_io(env, fd, id, b, off, len, 1, timeout);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_hadoop_io_nativeio_NativeSocketIO_poll0(
+  JNIEnv *env, jclass class, jint fd, jlong id, jint ops, jint timeout
+  ) {
+  short events = 0;
+  if (ops & OP_READ) {
+    events |= POLLIN;
+  }
+  if (ops & OP_WRITE) {
+    events |= POLLOUT;
+  }
+  int ready = -1;
+  int dup_fd = acquire(fd, id);
+  if (dup_fd != -1) {
+    ready = wait_ready(dup_fd, events, now_millis() + timeout);
+    release(dup_fd);
+  }
+  if (ready < 0) {
+    if (errno == EBADF) {
+      return IO_CLOSED;
+    }
+    throw_errno(env, errno);
+    return 0;
+  }
+  return ready;
+}
+
+/**
+ * vim: sw=2: ts=2: et:
+ */
@@ -0,0 +1,59 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined ORG_APACHE_HADOOP_IO_NATIVEIO_NATIVEIO_H
+#define ORG_APACHE_HADOOP_IO_NATIVEIO_NATIVEIO_H
+
+#if defined HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#if defined HAVE_STDDEF_H
+  #include <stddef.h>
+#else
+  #error 'stddef.h not found'
+#endif
+
+/**
+ * The native buffer pool.
+ *
+ * Blocks are handed out from size-classed free lists (powers of two from
+ * 256 bytes to 4 MB) and are aligned to 64 bytes. Released blocks are
+ * kept for reuse as long as the total cached size stays below the pool's
+ * capacity; larger blocks, and blocks beyond the capacity, go straight
+ * back to the system. All functions are threadsafe.
+ */
+
+/**
+ * Allocate a block of at least 'size' bytes.
+ *
+ * @return the block, or <code>NULL</code> if out of memory.
+ */
+void *hadoop_pool_alloc(size_t size);
+
+/**
+ * Return a block allocated by hadoop_pool_alloc to the pool.
+ *
+ * @return 0 on success, -1 if the block is not an outstanding block of the
+ *         pool, in which case it is left untouched.
+ */
+int hadoop_pool_free(void *block);
+
+#endif //ORG_APACHE_HADOOP_IO_NATIVEIO_NATIVEIO_H
+
+//vim: sw=2: ts=2: et
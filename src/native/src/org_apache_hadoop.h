@@ -59,7 +59,7 @@
  * @return returns the address where the symbol is loaded in memory, 
  *         <code>NULL</code> on error.
  */
-static void *do_dlsym(JNIEnv *env, void *handle, const char *symbol) {
+static inline void *do_dlsym(JNIEnv *env, void *handle, const char *symbol) {
   if (!env || !handle || !symbol) {
   	THROW(env, "java/lang/InternalError", NULL);
   	return NULL;
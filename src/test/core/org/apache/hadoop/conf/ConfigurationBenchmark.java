@@ -0,0 +1,167 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.conf;
+
+import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.io.IOException;
+import java.io.InputStream;
+import java.net.URL;
+import java.util.ArrayList;
+import java.util.List;
+
+import javax.xml.parsers.DocumentBuilderFactory;
+
+import org.apache.hadoop.fs.FileUtil;
+import org.apache.hadoop.io.IOUtils;
+import org.w3c.dom.Document;
+
+/**
+ * ConfigurationBenchmark measures the cost of loading configuration
+ * resources.
+ *
+ * <p>In this JVM, it times <code>new Configuration().get(...)</code> with
+ * the default resources parsed into a DOM (as before resources were
+ * compiled), parsed with StAX, mapped from the binary cache, and compiled
+ * once per JVM.</p>
+ *
+ * <p>It then times whole JVMs running <code>FsShell -ls</code> on the local
+ * file system, without and with <code>hadoop.conf.cache.dir</code>. Files
+ * modified within {@link CompiledResource#RACY_MILLIS} are never cached,
+ * so run it at least that long after building.</p>
+ *
+ * <pre>
+ * ConfigurationBenchmark [&lt;iterations&gt; [&lt;jvms&gt;]]
+ * </pre>
+ */
+public class ConfigurationBenchmark {
+  private static final String KEY = "fs.default.name";
+
+  /** Do not allow to create a new instance of the benchmark */
+  private ConfigurationBenchmark() {}
+
+  private static void report(String name, int n, long nanos) {
+    System.out.println(name + "\t" + n + "\t"
+        + String.format("%.3f", nanos / 1e6 / n));
+  }
+
+  private static List<URL> getDefaultResources() {
+    List<URL> urls = new ArrayList<URL>();
+    Configuration conf = new Configuration();
+    for (String name : new String[] {"core-default.xml", "core-site.xml"}) {
+      URL url = conf.getResource(name);
+      if (url != null) {
+        urls.add(url);
+      }
+    }
+    return urls;
+  }
+
+  private static void timeDom(int iterations) throws Exception {
+    List<URL> urls = getDefaultResources();
+    long start = System.nanoTime();
+    for (int i = 0; i < iterations; i++) {
+      Configuration conf = new Configuration(false);
+      for (URL url : urls) {
+        DocumentBuilderFactory factory = DocumentBuilderFactory.newInstance();
+        factory.setIgnoringComments(true);
+        factory.setNamespaceAware(true);
+        factory.setXIncludeAware(true);
+        Document doc = factory.newDocumentBuilder().parse(url.toString());
+        conf.addResource(doc.getDocumentElement());
+      }
+      conf.get(KEY);
+    }
+    report("dom", iterations, System.nanoTime() - start);
+  }
+
+  private static void timeConfiguration(String name, int iterations,
+      String cacheDir, boolean keepCompiled) {
+    if (cacheDir == null) {
+      System.clearProperty(CompiledResource.CACHE_DIR_PROPERTY);
+    } else {
+      System.setProperty(CompiledResource.CACHE_DIR_PROPERTY, cacheDir);
+    }
+    CompiledResource.clearCache();
+    new Configuration().get(KEY);
+    long start = System.nanoTime();
+    for (int i = 0; i < iterations; i++) {
+      if (!keepCompiled) {
+        CompiledResource.clearCache();
+      }
+      new Configuration().get(KEY);
+    }
+    report(name, iterations, System.nanoTime() - start);
+  }
+
+  private static void timeJvms(String name, int jvms, String cacheDir)
+      throws IOException, InterruptedException {
+    List<String> cmd = new ArrayList<String>();
+    cmd.add(new File(new File(System.getProperty("java.home"), "bin"), "java")
+            .getPath());
+    cmd.add("-cp");
+    cmd.add(System.getProperty("java.class.path"));
+    if (cacheDir != null) {
+      cmd.add("-D" + CompiledResource.CACHE_DIR_PROPERTY + "=" + cacheDir);
+    }
+    cmd.add("org.apache.hadoop.fs.FsShell");
+    cmd.add("-ls");
+    cmd.add(System.getProperty("java.io.tmpdir"));
+    long total = 0;
+    // the first run fills the cache
+    for (int i = 0; i <= jvms; i++) {
+      long start = System.nanoTime();
+      Process p = new ProcessBuilder(cmd).redirectErrorStream(true).start();
+      InputStream in = p.getInputStream();
+      try {
+        IOUtils.copyBytes(in, new ByteArrayOutputStream(), 4096,
+                          false);
+      } finally {
+        in.close();
+      }
+      if (p.waitFor() != 0) {
+        throw new IOException("FsShell exited with " + p.exitValue());
+      }
+      if (i > 0) {
+        total += System.nanoTime() - start;
+      }
+    }
+    report(name, jvms, total);
+  }
+
+  public static void main(String[] args) throws Exception {
+    int iterations = args.length > 0 ? Integer.parseInt(args[0]) : 1000;
+    int jvms = args.length > 1 ? Integer.parseInt(args[1]) : 10;
+    File cacheDir = new File(System.getProperty("java.io.tmpdir"),
+                             "ConfigurationBenchmark");
+    FileUtil.fullyDelete(cacheDir);
+    try {
+      System.out.println("method\tn\tms per Configuration");
+      timeDom(iterations);
+      timeConfiguration("stax", iterations, null, false);
+      timeConfiguration("mapped", iterations, cacheDir.getPath(), false);
+      timeConfiguration("compiled", iterations, null, true);
+
+      System.out.println("method\tn\tms per FsShell JVM");
+      timeJvms("jvm parse", jvms, null);
+      timeJvms("jvm cache", jvms, cacheDir.getPath());
+    } finally {
+      FileUtil.fullyDelete(cacheDir);
+    }
+  }
+}
@@ -0,0 +1,104 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.conf;
+
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * ConfigurationCloneBenchmark measures what a configuration costs once
+ * its resources are loaded: cloning it, cloning and setting a property,
+ * and the throughput of <code>get</code> from several threads at once,
+ * for plain and <code>${var}</code> values.
+ *
+ * <pre>
+ * ConfigurationCloneBenchmark [&lt;clones&gt; [&lt;threads&gt; [&lt;gets&gt;]]]
+ * </pre>
+ */
+public class ConfigurationCloneBenchmark {
+  private static final String PLAIN_KEY = "io.file.buffer.size";
+  private static final String EXPANDED_KEY = "fs.checkpoint.dir";
+
+  /** Do not allow to create a new instance of the benchmark */
+  private ConfigurationCloneBenchmark() {}
+
+  private static void timeClones(Configuration conf, int clones,
+                                 boolean set) {
+    long start = System.nanoTime();
+    for (int i = 0; i < clones; i++) {
+      Configuration clone = new Configuration(conf);
+      if (set) {
+        clone.set("benchmark.key", "value");
+      }
+      clone.get(PLAIN_KEY);
+    }
+    long nanos = System.nanoTime() - start;
+    System.out.println((set ? "clone+set" : "clone") + "\t" + clones + "\t"
+        + String.format("%.3f", nanos / 1e3 / clones) + " us");
+  }
+
+  private static void timeGets(final Configuration conf, final String key,
+      int threads, final int gets) throws InterruptedException {
+    final AtomicLong nanos = new AtomicLong();
+    Thread[] readers = new Thread[threads];
+    for (int t = 0; t < threads; t++) {
+      readers[t] = new Thread() {
+        public void run() {
+          long start = System.nanoTime();
+          for (int i = 0; i < gets; i++) {
+            conf.get(key);
+          }
+          nanos.addAndGet(System.nanoTime() - start);
+        }
+      };
+    }
+    long start = System.nanoTime();
+    for (Thread t : readers) {
+      t.start();
+    }
+    for (Thread t : readers) {
+      t.join();
+    }
+    long elapsed = System.nanoTime() - start;
+    long total = (long) threads * gets;
+    System.out.println("get " + key + "\t" + threads + " threads\t"
+        + String.format("%.0f", total * 1e9 / elapsed) + " gets/s\t"
+        + String.format("%.1f", nanos.get() / (double) total) + " ns/get");
+  }
+
+  public static void main(String[] args) throws Exception {
+    int clones = args.length > 0 ? Integer.parseInt(args[0]) : 100000;
+    int threads = args.length > 1 ? Integer.parseInt(args[1]) : 8;
+    int gets = args.length > 2 ? Integer.parseInt(args[2]) : 1000000;
+
+    Configuration conf = new Configuration();
+    conf.set("benchmark.overlay", "value");
+    conf.get(PLAIN_KEY);
+    System.out.println(conf.size() + " properties");
+
+    // warm up
+    timeClones(conf, clones / 10, true);
+    timeGets(conf, PLAIN_KEY, 1, gets / 10);
+
+    timeClones(conf, clones, false);
+    timeClones(conf, clones, true);
+    for (int t = 1; t <= threads; t *= 2) {
+      timeGets(conf, PLAIN_KEY, t, gets);
+      timeGets(conf, EXPANDED_KEY, t, gets);
+    }
+  }
+}
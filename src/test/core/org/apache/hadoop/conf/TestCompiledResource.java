@@ -0,0 +1,247 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.conf;
+
+import java.io.ByteArrayInputStream;
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.FileWriter;
+import java.io.IOException;
+import java.io.RandomAccessFile;
+import java.io.Writer;
+import java.net.URL;
+
+import javax.xml.parsers.DocumentBuilderFactory;
+
+import junit.framework.TestCase;
+
+import org.apache.hadoop.fs.FileUtil;
+import org.w3c.dom.Document;
+
+public class TestCompiledResource extends TestCase {
+  final static private File TEST_DIR = new File(System.getProperty(
+      "test.build.data", "/tmp"), "TestCompiledResource");
+  final static private File CACHE_DIR = new File(TEST_DIR, "cache");
+
+  static {
+    Configuration.addDeprecation("test.compiled.old",
+        new String[] {"test.compiled.new1", "test.compiled.new2"});
+  }
+
+  private static final String DOC =
+    "<?xml version=\"1.0\"?>\n" +
+    "<!-- a comment -->\n" +
+    "<configuration>\n" +
+    "  <property><name>a</name><value>1</value></property>\n" +
+    "  <property><name> spaced \n</name><value> 2 </value>" +
+    "<final>true</final></property>\n" +
+    "  <property><name>comment</name>" +
+    "<value>x <!-- c --> y</value></property>\n" +
+    "  <property><name>cdata</name><value><![CDATA[<&>]]></value>" +
+    "</property>\n" +
+    "  <property><name>empty</name><value></value>" +
+    "<final>true</final></property>\n" +
+    "  <property><name>entity</name><value>&lt;&amp;&gt;</value>" +
+    "</property>\n" +
+    "  <configuration>\n" +
+    "    <property><name>nested</name><value>n</value></property>\n" +
+    "  </configuration>\n" +
+    "  <property><name>test.compiled.old</name><value>o</value></property>\n" +
+    "  <property><value>no name</value></property>\n" +
+    "</configuration>\n";
+
+  @Override
+  protected void setUp() throws Exception {
+    FileUtil.fullyDelete(TEST_DIR);
+    assertTrue(TEST_DIR.mkdirs());
+    CompiledResource.clearCache();
+  }
+
+  @Override
+  protected void tearDown() throws Exception {
+    System.clearProperty(CompiledResource.CACHE_DIR_PROPERTY);
+    CompiledResource.clearCache();
+    FileUtil.fullyDelete(TEST_DIR);
+  }
+
+  private static void assertSameContents(CompiledResource expected,
+                                         CompiledResource actual) {
+    assertEquals(expected.size(), actual.size());
+    for (int i = 0; i < expected.size(); i++) {
+      assertEquals(expected.getName(i), actual.getName(i));
+      assertEquals(expected.getName(i), expected.getValue(i),
+                   actual.getValue(i));
+      assertEquals(expected.getName(i), expected.isFinal(i), actual.isFinal(i));
+      String[] newKeys = expected.getNewKeys(i);
+      if (newKeys == null) {
+        assertNull(actual.getNewKeys(i));
+      } else {
+        assertEquals(newKeys.length, actual.getNewKeys(i).length);
+      }
+    }
+  }
+
+  /** The streaming parser reads documents as the DOM parser does. */
+  public void testStaxMatchesDom() throws Exception {
+    CompiledResource stax =
+      CompiledResource.parse(new ByteArrayInputStream(DOC.getBytes("UTF-8")));
+    // as Configuration has always parsed resources
+    DocumentBuilderFactory factory = DocumentBuilderFactory.newInstance();
+    factory.setIgnoringComments(true);
+    factory.setNamespaceAware(true);
+    Document doc = factory.newDocumentBuilder()
+      .parse(new ByteArrayInputStream(DOC.getBytes("UTF-8")));
+    CompiledResource dom =
+      CompiledResource.fromElement(doc.getDocumentElement());
+    assertSameContents(dom, stax);
+
+    assertEquals(8, stax.size());
+    assertEquals("spaced", stax.getName(1));
+    assertEquals(" 2 ", stax.getValue(1));
+    assertTrue(stax.isFinal(1));
+    assertEquals("x  y", stax.getValue(2));
+    assertEquals("<&>", stax.getValue(3));
+    assertNull(stax.getValue(4));
+    assertEquals("nested", stax.getName(6));
+    assertEquals(2, stax.getNewKeys(7).length);
+  }
+
+  private File writeConf(String name, String value, long age)
+      throws IOException {
+    return writeConf(new File(TEST_DIR, "conf.xml"), name, value, age);
+  }
+
+  private File writeConf(File file, String name, String value, long age)
+      throws IOException {
+    Writer out = new FileWriter(file);
+    out.write("<?xml version=\"1.0\"?>\n<configuration>\n" +
+        "<property><name>" + name + "</name><value>" + value +
+        "</value><final>true</final></property>\n" +
+        "<property><name>test.compiled.old</name><value>o</value>" +
+        "</property>\n</configuration>\n");
+    out.close();
+    assertTrue(file.setLastModified(System.currentTimeMillis() - age));
+    return file;
+  }
+
+  public void testCache() throws Exception {
+    System.setProperty(CompiledResource.CACHE_DIR_PROPERTY,
+                       CACHE_DIR.getPath());
+    File file = writeConf("k", "v1", 10000);
+    URL url = file.toURI().toURL();
+    File cacheFile = CompiledResource.getCacheFile(url.toString());
+
+    CompiledResource parsed = CompiledResource.load(url);
+    assertEquals("v1", parsed.getValue(0));
+    assertTrue(cacheFile.exists());
+    // the same JVM reuses it
+    assertTrue(parsed == CompiledResource.load(url));
+
+    // another JVM reads the binary form
+    CompiledResource.clearCache();
+    CompiledResource read = CompiledResource.load(url);
+    assertTrue(parsed != read);
+    assertSameContents(parsed, read);
+
+    // a changed file is parsed again
+    file = writeConf("k", "v22", 5000);
+    CompiledResource changed = CompiledResource.load(url);
+    assertEquals("v22", changed.getValue(0));
+    CompiledResource.clearCache();
+    assertEquals("v22", CompiledResource.load(url).getValue(0));
+
+    // a huge property count is rejected before anything is allocated
+    RandomAccessFile raf = new RandomAccessFile(cacheFile, "rw");
+    raf.seek(3 * 4 + url.toString().getBytes("UTF-8").length + 3 * 8);
+    raf.writeInt(Integer.MAX_VALUE - 8);
+    raf.close();
+    CompiledResource.clearCache();
+    assertEquals("v22", CompiledResource.load(url).getValue(0));
+
+    // a corrupt cache file is ignored
+    FileOutputStream out = new FileOutputStream(cacheFile);
+    out.write(new byte[] {'H', 'C', 'N', 'F', 0, 0});
+    out.close();
+    CompiledResource.clearCache();
+    assertEquals("v22", CompiledResource.load(url).getValue(0));
+
+    Configuration conf = new Configuration(false);
+    conf.addResource(url);
+    assertEquals("v22", conf.get("k"));
+    assertEquals("o", conf.get("test.compiled.new2"));
+  }
+
+  /** A file that was just written may change within its timestamp. */
+  public void testRecentFileNotCached() throws Exception {
+    System.setProperty(CompiledResource.CACHE_DIR_PROPERTY,
+                       CACHE_DIR.getPath());
+    File file = writeConf("k", "v1", 0);
+    URL url = file.toURI().toURL();
+    CompiledResource first = CompiledResource.load(url);
+    assertEquals("v1", first.getValue(0));
+    assertFalse(CompiledResource.getCacheFile(url.toString()).exists());
+    assertTrue(first != CompiledResource.load(url));
+
+    writeConf("k", "v2", 0);
+    assertEquals("v2", CompiledResource.load(url).getValue(0));
+  }
+
+  /** Only the resources loaded most recently stay compiled in memory. */
+  public void testMemoryCacheBounded() throws Exception {
+    URL[] urls = new URL[CompiledResource.MAX_CACHED + 1];
+    for (int i = 0; i < urls.length; i++) {
+      urls[i] = writeConf(new File(TEST_DIR, "conf" + i + ".xml"),
+                          "k", "v" + i, 10000).toURI().toURL();
+    }
+    CompiledResource first = CompiledResource.load(urls[0]);
+    CompiledResource second = CompiledResource.load(urls[1]);
+    // using the first keeps it; the second is then the eldest
+    for (int i = 2; i < urls.length; i++) {
+      assertTrue(first == CompiledResource.load(urls[0]));
+      CompiledResource.load(urls[i]);
+    }
+    assertTrue(first == CompiledResource.load(urls[0]));
+    CompiledResource reloaded = CompiledResource.load(urls[1]);
+    assertTrue(second != reloaded);
+    assertSameContents(second, reloaded);
+  }
+
+  /** The cache directory keeps the files used most recently. */
+  public void testCacheDirBounded() throws Exception {
+    System.setProperty(CompiledResource.CACHE_DIR_PROPERTY,
+                       CACHE_DIR.getPath());
+    assertTrue(CACHE_DIR.mkdirs());
+    long old = System.currentTimeMillis() - 100000;
+    for (int i = 0; i < CompiledResource.MAX_CACHE_FILES; i++) {
+      File f = new File(CACHE_DIR, "old" + i + ".conf");
+      new FileOutputStream(f).close();
+      assertTrue(f.setLastModified(old + i));
+    }
+    File staleTmp = new File(CACHE_DIR, "dead.conf.tmp");
+    new FileOutputStream(staleTmp).close();
+    assertTrue(staleTmp.setLastModified(old - 24 * 60 * 60 * 1000L));
+
+    URL url = writeConf("k", "v", 10000).toURI().toURL();
+    CompiledResource.load(url);
+    assertTrue(CompiledResource.getCacheFile(url.toString()).exists());
+    assertFalse(new File(CACHE_DIR, "old0.conf").exists());
+    assertTrue(new File(CACHE_DIR, "old1.conf").exists());
+    assertFalse(staleTmp.exists());
+    assertEquals(CompiledResource.MAX_CACHE_FILES, CACHE_DIR.list().length);
+  }
+}
@@ -24,7 +24,9 @@ import java.io.IOException;
 import java.io.StringWriter;
 import java.util.ArrayList;
 import java.util.HashMap;
+import java.util.Properties;
 import java.util.Random;
+import java.util.concurrent.atomic.AtomicReference;
 import java.util.regex.Pattern;
 
 import junit.framework.TestCase;
@@ -449,6 +451,138 @@ public class TestConfiguration extends TestCase {
     assertFalse(conf.iterator().hasNext());
   }
 
+  public void testCloneIsolation() throws IOException {
+    out=new BufferedWriter(new FileWriter(CONFIG));
+    startConfig();
+    appendProperty("test.key1", "value1");
+    appendProperty("test.key2", "value2", true);
+    endConfig();
+    conf.addResource(new Path(CONFIG));
+    conf.set("test.key3", "value3");
+    assertEquals("value1", conf.get("test.key1"));
+
+    Configuration clone = new Configuration(conf);
+    assertEquals("value1", clone.get("test.key1"));
+    assertEquals("value3", clone.get("test.key3"));
+    assertEquals(conf.size(), clone.size());
+
+    clone.set("test.key1", "clone1");
+    clone.set("test.key3", "clone3");
+    assertEquals("value1", conf.get("test.key1"));
+    assertEquals("value3", conf.get("test.key3"));
+    conf.set("test.key4", "value4");
+    assertNull(clone.get("test.key4"));
+    assertEquals("clone1", clone.get("test.key1"));
+
+    // the final flags and overlay survive a reload of the clone
+    clone.reloadConfiguration();
+    assertEquals("clone1", clone.get("test.key1"));
+    assertEquals("value2", clone.get("test.key2"));
+    clone.clear();
+    assertEquals(0, clone.size());
+    assertEquals("value2", conf.get("test.key2"));
+  }
+
+  public void testGetPropsWriteThrough() {
+    Configuration conf = new Configuration(false);
+    conf.set("a", "A");
+    Properties props = conf.getProps();
+    assertEquals("A", props.getProperty("a"));
+    conf.set("b", "B");
+    assertEquals("B", props.getProperty("b"));
+    props.setProperty("c", "C");
+    assertEquals("C", conf.get("c"));
+    props.remove("a");
+    assertNull(conf.get("a"));
+    assertEquals(2, conf.size());
+    props.clear();
+    assertEquals(0, conf.size());
+  }
+
+  /** Bulk changes to the properties race with sets without deadlock. */
+  public void testGetPropsConcurrentSet() throws Exception {
+    final Configuration conf = new Configuration(false);
+    final Properties props = conf.getProps();
+    final HashMap<String, String> batch = new HashMap<String, String>();
+    for (int i = 0; i < 100; i++) {
+      batch.put("bulk" + i, "v" + i);
+    }
+    final AtomicReference<Throwable> failure = new AtomicReference<Throwable>();
+    Thread bulk = new Thread() {
+      public void run() {
+        try {
+          for (int n = 0; n < 1000; n++) {
+            props.putAll(batch);
+          }
+        } catch (Throwable e) {
+          failure.compareAndSet(null, e);
+        }
+      }
+    };
+    bulk.setDaemon(true);
+    bulk.start();
+    for (int n = 0; n < 100 || (n < 100000 && bulk.isAlive()); n++) {
+      conf.set("single" + (n % 100), "v");
+    }
+    bulk.join(60000);
+    assertFalse("Deadlocked", bulk.isAlive());
+    assertNull(failure.get());
+    assertEquals("v7", conf.get("bulk7"));
+    assertEquals("v", props.getProperty("single7"));
+  }
+
+  public void testExpansionFollowsSystemProperties() {
+    Configuration conf = new Configuration(false);
+    conf.set("test.var", "conf");
+    conf.set("test.expr", "${test.var}/x");
+    assertEquals("conf/x", conf.get("test.expr"));
+    System.setProperty("test.var", "system");
+    try {
+      assertEquals("system/x", conf.get("test.expr"));
+    } finally {
+      System.clearProperty("test.var");
+    }
+    assertEquals("conf/x", conf.get("test.expr"));
+    conf.set("test.var", "changed");
+    assertEquals("changed/x", conf.get("test.expr"));
+  }
+
+  public void testConcurrentGet() throws Exception {
+    final Configuration conf = new Configuration(false);
+    for (int i = 0; i < 100; i++) {
+      conf.set("key" + i, "${base}" + i);
+    }
+    conf.set("base", "v");
+    final AtomicReference<Throwable> failure = new AtomicReference<Throwable>();
+    Thread[] readers = new Thread[4];
+    for (int t = 0; t < readers.length; t++) {
+      readers[t] = new Thread() {
+        public void run() {
+          try {
+            for (int n = 0; n < 10000; n++) {
+              int i = n % 100;
+              String value = conf.get("key" + i);
+              if (!value.equals("v" + i) && !value.equals("w" + i)) {
+                throw new AssertionError(value);
+              }
+            }
+          } catch (Throwable e) {
+            failure.compareAndSet(null, e);
+          }
+        }
+      };
+      readers[t].start();
+    }
+    for (int i = 0; i < 1000; i++) {
+      conf.set("base", i % 2 == 0 ? "w" : "v");
+      new Configuration(conf).set("base", "x");
+    }
+    for (Thread t : readers) {
+      t.join();
+    }
+    assertNull(failure.get());
+  }
+
   public static class Fake_ClassLoader extends ClassLoader {
   }
 
@@ -0,0 +1,118 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.fs;
+
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.security.MessageDigest;
+import java.util.Random;
+
+import org.apache.hadoop.io.MD5Hash;
+import org.apache.hadoop.io.nativeio.NativeChecksum;
+
+/**
+ * FileChecksumBenchmark measures the GB/s of MD5 over a buffer, of MD5 over
+ * four buffers at once, and of the MD5 of MD5 of CRC32 checksum of a local
+ * file, natively and in Java. The file is read once before timing, so it is
+ * likely to be in the page cache.
+ *
+ * <pre>
+ * FileChecksumBenchmark [&lt;fileMB&gt; [&lt;dir&gt;]]
+ * </pre>
+ */
+public class FileChecksumBenchmark {
+  private static final int BYTES_PER_CRC = 512;
+  private static final long BLOCK_SIZE = 64L << 20;
+  private static final int REPEATS = 5;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private FileChecksumBenchmark() {}
+
+  private static void report(String name, long bytes, long nanos) {
+    System.out.println(name + "\t" + bytes + "\t" + nanos / 1000000 + "\t"
+        + String.format("%.2f", (double) bytes / Math.max(nanos, 1)));
+  }
+
+  public static void main(String[] args) throws Exception {
+    int fileMB = args.length > 0 ? Integer.parseInt(args[0]) : 256;
+    File dir = new File(args.length > 1 ? args[1]
+        : System.getProperty("java.io.tmpdir"));
+    File file = new File(dir, "FileChecksumBenchmark.dat");
+    byte[] buf = new byte[1 << 20];
+    new Random(0).nextBytes(buf);
+    OutputStream out = new FileOutputStream(file);
+    try {
+      for (int i = 0; i < fileMB; i++) {
+        out.write(buf);
+      }
+    } finally {
+      out.close();
+    }
+    long fileBytes = file.length();
+    boolean nativeLoaded = NativeChecksum.isNativeLoaded();
+    System.out.println("method\tbytes\tms\tGB/s");
+
+    try {
+      MessageDigest digester = MessageDigest.getInstance("MD5");
+      byte[] digest = new byte[NativeChecksum.MD5_LEN];
+      byte[][] bufs = new byte[4][];
+      for (int i = 0; i < bufs.length; i++) {
+        bufs[i] = buf.clone();
+      }
+      for (int r = 0; r < REPEATS; r++) {
+        long start = System.nanoTime();
+        for (int i = 0; i < 64; i++) {
+          digester.update(buf);
+          digester.digest();
+        }
+        report("md5-java", 64L * buf.length, System.nanoTime() - start);
+        if (nativeLoaded) {
+          start = System.nanoTime();
+          for (int i = 0; i < 64; i++) {
+            NativeChecksum.digest(buf, 0, buf.length, digest, 0);
+          }
+          report("md5-native", 64L * buf.length, System.nanoTime() - start);
+          start = System.nanoTime();
+          for (int i = 0; i < 16; i++) {
+            MD5Hash.digest(bufs, buf.length);
+          }
+          report("md5x4-native", 64L * buf.length, System.nanoTime() - start);
+        }
+
+        start = System.nanoTime();
+        MD5MD5CRC32FileChecksum.computeFileChecksum(file, BYTES_PER_CRC,
+                                                    BLOCK_SIZE);
+        report("file-java", fileBytes, System.nanoTime() - start);
+        if (nativeLoaded) {
+          start = System.nanoTime();
+          NativeChecksum.fileChecksum(file, BYTES_PER_CRC, BLOCK_SIZE);
+          report("file-native", fileBytes, System.nanoTime() - start);
+        }
+      }
+      if (!nativeLoaded) {
+        System.out.println("native\tnot loaded");
+      }
+    } finally {
+      if (!file.delete()) {
+        throw new IOException("Cannot delete " + file);
+      }
+    }
+  }
+}
@@ -0,0 +1,121 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.fs;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+
+import org.apache.hadoop.io.nativeio.NativeIO;
+
+/**
+ * FileTreeDeleteBenchmark measures the files per second deleted from a
+ * tree of directories of 1,000 files each: by the serial walk of
+ * {@link FileUtil#fullyDelete(File)} over <code>java.io.File</code>, and by
+ * {@link ParallelFileTree} with 1 to <code>maxThreads</code> threads.
+ * Every run deletes a freshly created tree.
+ *
+ * <pre>
+ * FileTreeDeleteBenchmark [&lt;numFiles&gt; [&lt;maxThreads&gt; [&lt;dir&gt;]]]
+ * </pre>
+ */
+public class FileTreeDeleteBenchmark {
+  private static final int FILES_PER_DIR = 1000;
+  private static final int DIRS_PER_DIR = 10;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private FileTreeDeleteBenchmark() {}
+
+  /** A File that FileUtil deletes with its serial walk. */
+  private static class SerialFile extends File {
+    private static final long serialVersionUID = 1L;
+
+    SerialFile(File f) {
+      super(f.getPath());
+    }
+
+    @Override
+    public File[] listFiles() {
+      File[] files = super.listFiles();
+      if (files != null) {
+        for (int i = 0; i < files.length; i++) {
+          files[i] = new SerialFile(files[i]);
+        }
+      }
+      return files;
+    }
+  }
+
+  /* Fill numbered directories, DIRS_PER_DIR per level, breadth first. */
+  private static void createTree(File root, int numFiles) throws IOException {
+    int numDirs = (numFiles + FILES_PER_DIR - 1) / FILES_PER_DIR;
+    File[] dirs = new File[numDirs];
+    for (int d = 0; d < numDirs; d++) {
+      File parent = d == 0 ? root : dirs[(d - 1) / DIRS_PER_DIR];
+      dirs[d] = d == 0 ? root : new File(parent, "subdir" + d);
+      if (!dirs[d].mkdirs()) {
+        throw new IOException("Cannot create " + dirs[d]);
+      }
+      int files = Math.min(FILES_PER_DIR, numFiles - d * FILES_PER_DIR);
+      for (int i = 0; i < files; i++) {
+        new File(dirs[d], "blk_" + i).createNewFile();
+      }
+    }
+  }
+
+  private static void report(String name, int files, long nanos) {
+    System.out.println(name + "\t" + files + "\t" + nanos / 1000000 + "\t"
+        + files * 1000000000L / Math.max(nanos, 1));
+  }
+
+  public static void main(String[] args) throws IOException {
+    int numFiles = args.length > 0 ? Integer.parseInt(args[0]) : 1000000;
+    int maxThreads = args.length > 1 ? Integer.parseInt(args[1])
+        : ParallelFileTree.DEFAULT_THREADS;
+    File root = new File(args.length > 2 ? args[2]
+        : System.getProperty("java.io.tmpdir"), "FileTreeDeleteBenchmark");
+    FileUtil.fullyDelete(root);
+    System.out.println("native " + (NativeIO.isNativeLoaded() ? "loaded"
+        : "not loaded"));
+    System.out.println("method\tfiles\tms\tfiles/s");
+
+    createTree(root, numFiles);
+    long start = System.nanoTime();
+    if (!FileUtil.fullyDelete(new SerialFile(root))) {
+      throw new IOException("Failed to delete " + root);
+    }
+    report("serial", numFiles, System.nanoTime() - start);
+
+    ExecutorService pool = Executors.newFixedThreadPool(maxThreads);
+    try {
+      for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        ParallelFileTree tree = new ParallelFileTree(pool, threads);
+        createTree(root, numFiles);
+        start = System.nanoTime();
+        if (!tree.fullyDelete(root)) {
+          throw new IOException("Failed to delete " + root);
+        }
+        report("threads=" + threads, numFiles, System.nanoTime() - start);
+      }
+    } finally {
+      pool.shutdownNow();
+      FileUtil.fullyDelete(root);
+    }
+  }
+}
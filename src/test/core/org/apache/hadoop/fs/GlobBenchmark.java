@@ -0,0 +1,91 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.fs;
+
+import java.io.File;
+import java.io.IOException;
+import java.net.URI;
+
+import org.apache.hadoop.conf.Configuration;
+
+/**
+ * GlobBenchmark measures {@link FileSystem#globStatus(Path)} over a
+ * synthetic local tree of <code>&lt;logs&gt;/h&lt;i&gt;/2026-&lt;j&gt;</code>
+ * directories, each holding a <code>part-0</code> file. The pattern
+ * <code>&lt;logs&gt;/*&#47;2026-*&#47;part-*</code> is globbed with
+ * <code>fs.glob.threads</code> set to 1, the serial listing, and to each
+ * of the given thread counts. The tree is left in place for the next run.
+ *
+ * <pre>
+ * GlobBenchmark [&lt;dirs&gt; [&lt;dir&gt; [&lt;threads&gt;...]]]
+ * </pre>
+ */
+public class GlobBenchmark {
+  private static final int DIRS_PER_HOST = 1000;
+  private static final int REPEATS = 3;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private GlobBenchmark() {}
+
+  private static void createTree(File logs, int dirs) throws IOException {
+    for (int i = 0; i * DIRS_PER_HOST < dirs; i++) {
+      File host = new File(logs, "h" + i);
+      for (int j = 0; j < DIRS_PER_HOST && i * DIRS_PER_HOST + j < dirs; j++) {
+        File dir = new File(host, "2026-" + j);
+        if (!dir.isDirectory()) {
+          if (!dir.mkdirs() || !new File(dir, "part-0").createNewFile()) {
+            throw new IOException("Cannot create " + dir);
+          }
+        }
+      }
+    }
+  }
+
+  public static void main(String[] args) throws IOException {
+    int dirs = args.length > 0 ? Integer.parseInt(args[0]) : 100000;
+    File logs = new File(args.length > 1 ? args[1]
+        : System.getProperty("java.io.tmpdir"), "GlobBenchmark-" + dirs);
+    int[] threads;
+    if (args.length > 2) {
+      threads = new int[args.length - 1];
+      threads[0] = 1;
+      for (int i = 2; i < args.length; i++) {
+        threads[i - 1] = Integer.parseInt(args[i]);
+      }
+    } else {
+      threads = new int[] {1, 4, 8, 16};
+    }
+    createTree(logs, dirs);
+    Path pattern = new Path(logs.getAbsolutePath() + "/*/2026-*/part-*");
+    System.out.println("threads\tmatches\tms");
+
+    for (int r = 0; r < REPEATS; r++) {
+      for (int t : threads) {
+        Configuration conf = new Configuration();
+        conf.setInt(CommonConfigurationKeys.FS_GLOB_THREADS_KEY, t);
+        FileSystem fs = new RawLocalFileSystem();
+        fs.initialize(URI.create("file:///"), conf);
+        long start = System.nanoTime();
+        FileStatus[] matches = fs.globStatus(pattern);
+        long nanos = System.nanoTime() - start;
+        System.out.println(t + "\t" + matches.length + "\t"
+            + nanos / 1000000);
+      }
+    }
+  }
+}
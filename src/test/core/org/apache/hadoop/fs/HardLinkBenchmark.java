@@ -0,0 +1,108 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.fs;
+
+import java.io.File;
+import java.io.IOException;
+
+import org.apache.hadoop.io.nativeio.NativeIO;
+
+/**
+ * HardLinkBenchmark measures the hard links per second made by
+ * {@link FileUtil.HardLink}: one <code>ln</code> per file, one
+ * <code>link(2)</code> per file, and
+ * {@link FileUtil.HardLink#createHardLinkMult(File, String[], File)}.
+ * The <code>ln</code> variant links at most 2,000 of the files, as it takes
+ * milliseconds per file.
+ *
+ * <pre>
+ * HardLinkBenchmark [&lt;numFiles&gt; [&lt;dir&gt;]]
+ * </pre>
+ */
+public class HardLinkBenchmark {
+  private static final int MAX_SHELL_FILES = 2000;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private HardLinkBenchmark() {}
+
+  private static void report(String name, int files, long nanos) {
+    System.out.println(name + "\t" + files + "\t" + nanos / 1000000 + "\t"
+        + files * 1000000000L / Math.max(nanos, 1));
+  }
+
+  public static void main(String[] args) throws IOException {
+    int numFiles = args.length > 0 ? Integer.parseInt(args[0]) : 100000;
+    File root = new File(args.length > 1 ? args[1]
+        : System.getProperty("java.io.tmpdir"), "HardLinkBenchmark");
+    FileUtil.fullyDelete(root);
+    File src = new File(root, "src");
+    if (!src.mkdirs()) {
+      throw new IOException("Cannot create " + src);
+    }
+    String[] names = new String[numFiles];
+    for (int i = 0; i < numFiles; i++) {
+      names[i] = "blk_" + i;
+      new File(src, names[i]).createNewFile();
+    }
+    System.out.println("method\tfiles\tms\tlinks/s");
+
+    try {
+      if (NativeIO.isNativeLoaded()) {
+        File dst = new File(root, "link");
+        dst.mkdirs();
+        long start = System.nanoTime();
+        for (String name : names) {
+          NativeIO.link(new File(src, name).getPath(),
+                        new File(dst, name).getPath());
+        }
+        report("link", numFiles, System.nanoTime() - start);
+
+        dst = new File(root, "linkAll");
+        dst.mkdirs();
+        start = System.nanoTime();
+        FileUtil.HardLink.createHardLinkMult(src, names, dst);
+        report("linkAll", numFiles, System.nanoTime() - start);
+      } else {
+        System.out.println("native\tnot loaded");
+      }
+
+      // the shell: ln per file, on a sample of the files
+      File dst = new File(root, "ln");
+      dst.mkdirs();
+      int files = Math.min(numFiles, MAX_SHELL_FILES);
+      long start = System.nanoTime();
+      for (int i = 0; i < files; i++) {
+        String[] cmd = {"ln", new File(src, names[i]).getPath(),
+                        new File(dst, names[i]).getPath()};
+        Process p = Runtime.getRuntime().exec(cmd);
+        try {
+          if (p.waitFor() != 0) {
+            throw new IOException("ln failed for " + names[i]);
+          }
+        } catch (InterruptedException e) {
+          throw new IOException(e.toString());
+        } finally {
+          p.destroy();
+        }
+      }
+      report("ln", files, System.nanoTime() - start);
+    } finally {
+      FileUtil.fullyDelete(root);
+    }
+  }
+}
@@ -0,0 +1,236 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.fs;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.Iterator;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+
+import org.apache.hadoop.conf.Configuration;
+
+/**
+ * LocalDirAllocatorBenchmark has two parts.
+ *
+ * <p><code>alloc</code> measures the allocations per second of
+ * {@link LocalDirAllocator#getLocalPathForWrite(String, long, Configuration)}
+ * from 1 to <code>maxThreads</code> concurrent threads.</p>
+ *
+ * <p><code>sim</code> simulates writers spilling to disks of unequal speed,
+ * where the last disk is slower than the others. Every tick a write arrives
+ * with some probability, and every disk shares its bandwidth among the
+ * writes on it. The writes are placed once ignoring load (the disks are
+ * equally loaded to the allocator, as the files are not tracked), and once
+ * with {@link LocalDirAllocator#allocateForWrite(String, long,
+ * Configuration)}, closing each allocation when its write completes. It
+ * prints the mean and the largest number of writes on each disk, and the
+ * mean ticks a write takes.</p>
+ *
+ * <pre>
+ * LocalDirAllocatorBenchmark alloc [&lt;maxThreads&gt; [&lt;allocations&gt; [&lt;dir&gt;]]]
+ * LocalDirAllocatorBenchmark sim [&lt;ticks&gt; [&lt;dir&gt;]]
+ * </pre>
+ */
+public class LocalDirAllocatorBenchmark {
+  private static final String CONTEXT = "benchmark.local.dir";
+  private static final int NUM_DIRS = 4;
+  /* the size of a simulated write, and the bandwidths of the disks */
+  private static final long WRITE_SIZE = 100;
+  private static final long[] BANDWIDTH = {10, 10, 10, 4};
+  private static final double ARRIVAL_RATE = 0.28;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private LocalDirAllocatorBenchmark() {}
+
+  private static String[] createDirs(File root) throws IOException {
+    String[] dirs = new String[NUM_DIRS];
+    for (int i = 0; i < NUM_DIRS; i++) {
+      File dir = new File(root, "dir" + i);
+      if (!dir.mkdirs()) {
+        throw new IOException("Cannot create " + dir);
+      }
+      dirs[i] = dir.getPath();
+    }
+    return dirs;
+  }
+
+  private static void alloc(int maxThreads, final int allocations,
+                            final Configuration conf) throws Exception {
+    final LocalDirAllocator allocator = new LocalDirAllocator(CONTEXT);
+    allocator.getLocalPathForWrite("bench/warmup", 1, conf);
+    System.out.println("threads\tallocations\tms\tallocations/s");
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+      Thread[] workers = new Thread[threads];
+      final int perThread = allocations / threads;
+      final IOException[] error = new IOException[1];
+      for (int t = 0; t < threads; t++) {
+        workers[t] = new Thread() {
+          public void run() {
+            try {
+              for (int i = 0; i < perThread; i++) {
+                allocator.getLocalPathForWrite("bench/file", 1024, conf);
+              }
+            } catch (IOException e) {
+              error[0] = e;
+            }
+          }
+        };
+      }
+      long start = System.nanoTime();
+      for (Thread w : workers) {
+        w.start();
+      }
+      for (Thread w : workers) {
+        w.join();
+      }
+      long nanos = System.nanoTime() - start;
+      if (error[0] != null) {
+        throw error[0];
+      }
+      int total = perThread * threads;
+      System.out.println(threads + "\t" + total + "\t" + nanos / 1000000
+          + "\t" + total * 1000000000L / Math.max(nanos, 1));
+    }
+  }
+
+  private static class Write {
+    final int disk;
+    final LocalDirAllocator.Allocation allocation;
+    final long started;
+    long remaining = WRITE_SIZE;
+
+    Write(int disk, LocalDirAllocator.Allocation allocation, long started) {
+      this.disk = disk;
+      this.allocation = allocation;
+      this.started = started;
+    }
+  }
+
+  private static void simulate(String name, boolean track, int ticks,
+      String[] dirs, Configuration conf) throws IOException {
+    LocalDirAllocator allocator = new LocalDirAllocator(CONTEXT);
+    Map<String, Integer> diskOf = new HashMap<String, Integer>();
+    for (int i = 0; i < dirs.length; i++) {
+      diskOf.put(new Path(dirs[i]).toString(), i);
+    }
+    List<List<Write>> active = new ArrayList<List<Write>>();
+    for (int i = 0; i < dirs.length; i++) {
+      active.add(new ArrayList<Write>());
+    }
+    long[] depthSum = new long[dirs.length];
+    int[] maxDepth = new int[dirs.length];
+    long completed = 0;
+    long latencySum = 0;
+    Random rand = new Random(0);
+
+    for (int tick = 0; tick < ticks; tick++) {
+      if (rand.nextDouble() < ARRIVAL_RATE) {
+        LocalDirAllocator.Allocation allocation = null;
+        Path path;
+        if (track) {
+          allocation = allocator.allocateForWrite("sim/write", WRITE_SIZE,
+                                                  conf);
+          path = allocation.getPath();
+        } else {
+          path = allocator.getLocalPathForWrite("sim/write", WRITE_SIZE,
+                                                conf);
+        }
+        int disk = diskOf.get(path.getParent().getParent().toString());
+        active.get(disk).add(new Write(disk, allocation, tick));
+      }
+      for (int d = 0; d < dirs.length; d++) {
+        List<Write> writes = active.get(d);
+        depthSum[d] += writes.size();
+        maxDepth[d] = Math.max(maxDepth[d], writes.size());
+        if (writes.isEmpty()) {
+          continue;
+        }
+        long share = Math.max(1, BANDWIDTH[d] / writes.size());
+        for (Iterator<Write> it = writes.iterator(); it.hasNext();) {
+          Write w = it.next();
+          w.remaining -= share;
+          if (w.remaining <= 0) {
+            it.remove();
+            if (w.allocation != null) {
+              w.allocation.close();
+            }
+            completed++;
+            latencySum += tick + 1 - w.started;
+          }
+        }
+      }
+    }
+    for (List<Write> writes : active) {
+      for (Write w : writes) {
+        if (w.allocation != null) {
+          w.allocation.close();
+        }
+      }
+    }
+
+    StringBuilder mean = new StringBuilder();
+    StringBuilder max = new StringBuilder();
+    for (int d = 0; d < dirs.length; d++) {
+      mean.append(String.format("%.1f ", (double) depthSum[d] / ticks));
+      max.append(maxDepth[d]).append(' ');
+    }
+    System.out.println(name + "\t" + mean + "\t" + max + "\t"
+        + String.format("%.1f", (double) latencySum / Math.max(completed, 1)));
+  }
+
+  public static void main(String[] args) throws Exception {
+    String mode = args.length > 0 ? args[0] : "sim";
+    File root = new File(System.getProperty("java.io.tmpdir"),
+                         "LocalDirAllocatorBenchmark");
+    Configuration conf = new Configuration();
+    try {
+      if ("alloc".equals(mode)) {
+        int maxThreads = args.length > 1 ? Integer.parseInt(args[1]) : 8;
+        int allocations = args.length > 2 ? Integer.parseInt(args[2]) : 1000000;
+        if (args.length > 3) {
+          root = new File(args[3], "LocalDirAllocatorBenchmark");
+        }
+        FileUtil.fullyDelete(root);
+        conf.setStrings(CONTEXT, createDirs(root));
+        alloc(maxThreads, allocations, conf);
+      } else if ("sim".equals(mode)) {
+        int ticks = args.length > 1 ? Integer.parseInt(args[1]) : 100000;
+        if (args.length > 2) {
+          root = new File(args[2], "LocalDirAllocatorBenchmark");
+        }
+        FileUtil.fullyDelete(root);
+        String[] dirs = createDirs(root);
+        conf.setStrings(CONTEXT, dirs);
+        System.out.println("placement\tmean writes per disk\t"
+            + "max writes per disk\tmean ticks per write");
+        simulate("ignoring load", false, ticks, dirs, conf);
+        simulate("load-aware", true, ticks, dirs, conf);
+      } else {
+        System.err.println("Usage: LocalDirAllocatorBenchmark alloc "
+            + "[<maxThreads> [<allocations> [<dir>]]] | sim [<ticks> [<dir>]]");
+        System.exit(-1);
+      }
+    } finally {
+      FileUtil.fullyDelete(root);
+    }
+  }
+}
@@ -18,6 +18,7 @@
 package org.apache.hadoop.fs;
 
 import java.io.File;
+import java.io.FileNotFoundException;
 import java.io.IOException;
 import java.util.Arrays;
 import java.util.Collections;
@@ -249,4 +250,67 @@ public class TestFileUtil {
     boolean ret = FileUtil.fullyDeleteContents(new MyFile(del));
     validateAndSetWritablePermissions(ret);
   }
+
+  @Test
+  public void testHardLinks() throws IOException {
+    del.mkdirs();
+    File file = new File(del, FILE);
+    file.createNewFile();
+    Assert.assertEquals(1, FileUtil.HardLink.getLinkCount(file));
+
+    File link = new File(del, LINK);
+    FileUtil.HardLink.createHardLink(file, link);
+    Assert.assertEquals(2, FileUtil.HardLink.getLinkCount(file));
+    Assert.assertEquals(2, FileUtil.HardLink.getLinkCount(link));
+    try {
+      FileUtil.HardLink.createHardLink(file, link);
+      Assert.fail("Linked onto an existing file");
+    } catch (IOException e) {
+      // expected
+    }
+    try {
+      FileUtil.HardLink.getLinkCount(new File(del, "missing"));
+      Assert.fail("Got the link count of a missing file");
+    } catch (FileNotFoundException e) {
+      // expected
+    }
+  }
+
+  @Test
+  public void testCreateHardLinkMult() throws IOException {
+    File src = new File(del, DIR + "1");
+    File dst = new File(del, DIR + "2");
+    src.mkdirs();
+    dst.mkdirs();
+    String[] names = new String[10];
+    for (int i = 0; i < names.length; i++) {
+      names[i] = "file" + i;
+      new File(src, names[i]).createNewFile();
+    }
+    FileUtil.HardLink.createHardLinkMult(src, names, dst);
+    for (String name : names) {
+      Assert.assertTrue(new File(dst, name).exists());
+      Assert.assertEquals(2,
+          FileUtil.HardLink.getLinkCount(new File(src, name)));
+    }
+    try {
+      FileUtil.HardLink.createHardLinkMult(src, new String[] {"missing"}, dst);
+      Assert.fail("Linked a missing file");
+    } catch (IOException e) {
+      // expected
+    }
+  }
+
+  @Test
+  public void testSymLink() throws IOException {
+    del.mkdirs();
+    File file = new File(del, FILE);
+    file.createNewFile();
+    File link = new File(del, LINK);
+    Assert.assertEquals(0,
+        FileUtil.symLink(file.getAbsolutePath(), link.getAbsolutePath()));
+    Assert.assertEquals(file.getCanonicalPath(), link.getCanonicalPath());
+    Assert.assertTrue(0 !=
+        FileUtil.symLink(file.getAbsolutePath(), link.getAbsolutePath()));
+  }
 }
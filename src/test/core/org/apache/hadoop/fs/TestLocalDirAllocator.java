@@ -207,5 +207,56 @@ public class TestLocalDirAllocator extends TestCase {
       rmBufferDirs();
     }
   }
-  
+
+  private static int dirOf(Path path, int... dirs) {
+    for (int i : dirs) {
+      if (path.getParent().equals(BUFFER_PATH[i])) {
+        return i;
+      }
+    }
+    fail(path + " is in none of the buffer dirs");
+    return -1;
+  }
+
+  /** Two buffer dirs, on read-write disk.
+   * Files that are still being written steer allocations to the other dir.
+   * @throws Exception
+   */
+  public void testAllocateForWrite() throws Exception {
+    if (isWindows) return;
+    try {
+      conf.set(CONTEXT, BUFFER_DIR[0]+","+BUFFER_DIR[6]);
+      assertTrue(localFs.mkdirs(BUFFER_PATH[0]));
+      assertTrue(localFs.mkdirs(BUFFER_PATH[6]));
+
+      LocalDirAllocator.Allocation a1 =
+        dirAllocator.allocateForWrite(FILENAME, SMALL_FILE_SIZE, conf);
+      int first = dirOf(a1.getPath(), 0, 6);
+      int second = first == 0 ? 6 : 0;
+
+      // the other dir has no active stream
+      LocalDirAllocator.Allocation a2 =
+        dirAllocator.allocateForWrite(FILENAME, SMALL_FILE_SIZE, conf);
+      assertEquals(second, dirOf(a2.getPath(), 0, 6));
+
+      // a3 gives its dir a second stream; once a2 is closed the other dir
+      // has fewer streams, so a4 goes there
+      LocalDirAllocator.Allocation a3 =
+        dirAllocator.allocateForWrite(FILENAME, SMALL_FILE_SIZE, conf);
+      a2.close();
+      LocalDirAllocator.Allocation a4 =
+        dirAllocator.allocateForWrite(FILENAME, 10 * SMALL_FILE_SIZE, conf);
+      int third = dirOf(a3.getPath(), 0, 6);
+      assertEquals(third == 0 ? 6 : 0, dirOf(a4.getPath(), 0, 6));
+
+      // closing twice counts once
+      a1.close();
+      a1.close();
+      a3.close();
+      a4.close();
+      validateTempDirCreation(first == 0 ? 0 : 6);
+    } finally {
+      rmBufferDirs();
+    }
+  }
 }
@@ -0,0 +1,119 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.fs;
+
+import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.security.MessageDigest;
+import java.util.Random;
+import java.util.zip.CRC32;
+
+import junit.framework.TestCase;
+
+import org.apache.hadoop.io.MD5Hash;
+
+/** Test {@link MD5MD5CRC32FileChecksum#getLocalFileChecksum}. */
+public class TestLocalFileChecksum extends TestCase {
+  private static final File TEST_DIR = new File(
+      System.getProperty("test.build.data", "/tmp"), "localfilechecksum");
+  private static final Random RANDOM = new Random();
+
+  protected void setUp() {
+    TEST_DIR.mkdirs();
+  }
+
+  protected void tearDown() {
+    FileUtil.fullyDelete(TEST_DIR);
+  }
+
+  /** Compute the checksum from its definition, with the file in memory. */
+  private static byte[] expected(byte[] data, int bytesPerCRC,
+                                 long blockSize) throws Exception {
+    MessageDigest digest = MessageDigest.getInstance("MD5");
+    ByteArrayOutputStream blockMd5s = new ByteArrayOutputStream();
+    for (int block = 0; block < data.length; block += blockSize) {
+      int blockEnd = (int) Math.min(data.length, block + blockSize);
+      for (int chunk = block; chunk < blockEnd; chunk += bytesPerCRC) {
+        CRC32 crc = new CRC32();
+        crc.update(data, chunk, Math.min(bytesPerCRC, blockEnd - chunk));
+        int value = (int) crc.getValue();
+        digest.update(new byte[] {(byte) (value >>> 24),
+            (byte) (value >>> 16), (byte) (value >>> 8), (byte) value});
+      }
+      blockMd5s.write(digest.digest());
+    }
+    return digest.digest(blockMd5s.toByteArray());
+  }
+
+  private static File write(String name, byte[] data) throws IOException {
+    File file = new File(TEST_DIR, name);
+    OutputStream out = new FileOutputStream(file);
+    try {
+      out.write(data);
+    } finally {
+      out.close();
+    }
+    return file;
+  }
+
+  public void testChecksum() throws Exception {
+    int[][] shapes = {
+      // length, bytesPerCRC, blockSize
+      {0, 512, 4096}, {1, 512, 4096}, {511, 512, 4096}, {4096, 512, 4096},
+      {4097, 512, 4096}, {10000, 512, 4096}, {10000, 512, 1000},
+      {10000, 7, 1024}, {200000, 512, 65536}, {200000, 4096, 100}
+    };
+    for (int[] shape : shapes) {
+      byte[] data = new byte[shape[0]];
+      RANDOM.nextBytes(data);
+      File file = write("f" + shape[0], data);
+      String what = "length=" + shape[0] + " bytesPerCRC=" + shape[1]
+        + " blockSize=" + shape[2];
+      byte[] md5 = expected(data, shape[1], shape[2]);
+      assertEquals(what, new MD5Hash(md5), new MD5Hash(
+          MD5MD5CRC32FileChecksum.computeFileChecksum(file, shape[1],
+                                                      shape[2])));
+
+      MD5MD5CRC32FileChecksum checksum =
+        MD5MD5CRC32FileChecksum.getLocalFileChecksum(file, shape[1], shape[2]);
+      long crcPerBlock = shape[0] > shape[2]
+        ? (shape[2] + shape[1] - 1) / shape[1] : 0;
+      assertEquals(what, new MD5MD5CRC32FileChecksum(shape[1], crcPerBlock,
+                                                     new MD5Hash(md5)),
+                   checksum);
+    }
+  }
+
+  public void testBadArguments() throws Exception {
+    File file = write("bad", new byte[10]);
+    try {
+      MD5MD5CRC32FileChecksum.getLocalFileChecksum(file, 0, 4096);
+      fail("bytesPerCRC of 0 was accepted");
+    } catch (IllegalArgumentException e) {
+    }
+    try {
+      MD5MD5CRC32FileChecksum.getLocalFileChecksum(
+          new File(TEST_DIR, "missing"), 512, 4096);
+      fail("missing file was checksummed");
+    } catch (IOException e) {
+    }
+  }
+}
@@ -0,0 +1,254 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.fs;
+
+import java.io.File;
+import java.io.FileNotFoundException;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.net.URI;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+
+import org.apache.hadoop.conf.Configuration;
+import org.junit.After;
+import org.junit.Assert;
+import org.junit.Before;
+import org.junit.Test;
+
+public class TestParallelFileTree {
+  final static private File TEST_DIR = new File(System.getProperty(
+      "test.build.data", "/tmp"), "pft");
+  private final File src = new File(TEST_DIR, "src");
+  private final File outside = new File(TEST_DIR, "outside");
+  private ExecutorService pool;
+  private ParallelFileTree tree;
+
+  @Before
+  public void setUp() throws IOException {
+    FileUtil.fullyDelete(TEST_DIR);
+    pool = Executors.newFixedThreadPool(4);
+    tree = new ParallelFileTree(pool, 4);
+  }
+
+  @After
+  public void tearDown() throws IOException {
+    pool.shutdownNow();
+    FileUtil.fullyDelete(TEST_DIR);
+  }
+
+  /** Create files named after their path, in a tree of depth levels. */
+  private static int createTree(File dir, int depth, int width)
+      throws IOException {
+    Assert.assertTrue(dir.mkdirs());
+    int files = 0;
+    for (int i = 0; i < width; i++) {
+      File f = new File(dir, "f" + i);
+      FileOutputStream out = new FileOutputStream(f);
+      out.write(f.getPath().getBytes("UTF-8"));
+      out.close();
+      files++;
+      if (depth > 0) {
+        files += createTree(new File(dir, "d" + i), depth - 1, width);
+      }
+    }
+    return files;
+  }
+
+  @Test
+  public void testFullyDelete() throws IOException {
+    createTree(src, 3, 6);
+    // links are deleted, never followed
+    createTree(outside, 1, 2);
+    FileUtil.symLink(outside.toString(), new File(src, "dirlink").toString());
+    FileUtil.symLink(new File(outside, "f0").toString(),
+                     new File(src, "d1/filelink").toString());
+    new File(src, "d2/empty").mkdir();
+
+    Assert.assertTrue(tree.fullyDelete(src));
+    Assert.assertFalse(src.exists());
+    Assert.assertTrue(new File(outside, "f0").exists());
+    Assert.assertTrue(new File(outside, "d1/f1").exists());
+  }
+
+  @Test
+  public void testFullyDeleteContents() throws IOException {
+    createTree(src, 2, 5);
+    Assert.assertTrue(tree.fullyDeleteContents(src));
+    Assert.assertTrue(src.isDirectory());
+    Assert.assertEquals(0, src.list().length);
+  }
+
+  @Test
+  public void testFullyDeleteFile() throws IOException {
+    Assert.assertTrue(TEST_DIR.mkdirs());
+    File f = new File(TEST_DIR, "file");
+    Assert.assertTrue(f.createNewFile());
+    Assert.assertTrue(tree.fullyDelete(f));
+    Assert.assertFalse(f.exists());
+    Assert.assertFalse(tree.fullyDelete(f));
+  }
+
+  /** A walk started from the only thread of its pool must still finish. */
+  @Test
+  public void testWalkFromPoolThread() throws Exception {
+    createTree(src, 3, 4);
+    ExecutorService single = Executors.newSingleThreadExecutor();
+    try {
+      final ParallelFileTree singleTree = new ParallelFileTree(single, 4);
+      boolean deleted = single.submit(new Callable<Boolean>() {
+        public Boolean call() throws IOException {
+          return singleTree.fullyDelete(src);
+        }
+      }).get(60, TimeUnit.SECONDS);
+      Assert.assertTrue(deleted);
+      Assert.assertFalse(src.exists());
+    } finally {
+      single.shutdownNow();
+    }
+  }
+
+  private static void assertSameTree(File expected, File actual)
+      throws IOException {
+    Assert.assertEquals(expected.isDirectory(), actual.isDirectory());
+    if (expected.isDirectory()) {
+      String[] names = expected.list();
+      Assert.assertEquals(names.length, actual.list().length);
+      for (String name : names) {
+        assertSameTree(new File(expected, name), new File(actual, name));
+      }
+    } else {
+      Assert.assertEquals(expected.length(), actual.length());
+    }
+  }
+
+  @Test
+  public void testCopy() throws IOException {
+    createTree(src, 2, 5);
+    Configuration conf = new Configuration();
+    FileSystem fs = FileSystem.getLocal(conf).getRaw();
+    File dst = new File(TEST_DIR, "dst");
+
+    Assert.assertTrue(tree.copy(src, fs, new Path(dst.toString()), false,
+                                conf));
+    assertSameTree(src, dst);
+
+    File moved = new File(TEST_DIR, "moved");
+    Assert.assertTrue(tree.copy(src, fs, new Path(moved.toString()), true,
+                                conf));
+    Assert.assertFalse(src.exists());
+    assertSameTree(dst, moved);
+  }
+
+  @Test
+  public void testCopyMissingSource() throws IOException {
+    Configuration conf = new Configuration();
+    FileSystem fs = FileSystem.getLocal(conf).getRaw();
+    try {
+      tree.copy(new File(TEST_DIR, "missing"), fs,
+                new Path(new File(TEST_DIR, "dst").toString()), false, conf);
+      Assert.fail("copied a missing file");
+    } catch (IOException e) {
+      // expected
+    }
+  }
+
+  private static void assertSamePaths(FileStatus[] expected,
+                                      FileStatus[] actual) {
+    Assert.assertEquals(expected.length, actual.length);
+    for (int i = 0; i < expected.length; i++) {
+      Assert.assertEquals(expected[i].getPath(), actual[i].getPath());
+    }
+  }
+
+  @Test
+  public void testListStatus() throws IOException {
+    createTree(src, 1, 12);
+    FileSystem fs = FileSystem.getLocal(new Configuration()).getRaw();
+    PathFilter filter = new PathFilter() {
+      public boolean accept(Path path) {
+        return !path.getName().equals("f3");
+      }
+    };
+    Path[] paths = new Path[12];
+    for (int i = 0; i < paths.length; i++) {
+      // not in name order, and a file is listed as itself
+      paths[i] = new Path(new File(src, i == 5 ? "f5" : "d" + (11 - i))
+                          .toString());
+    }
+    assertSamePaths(fs.listStatus(paths, filter),
+                    tree.listStatus(fs, paths, filter));
+    assertSamePaths(new FileStatus[0], tree.listStatus(fs, new Path[0],
+                                                       filter));
+
+    paths[7] = new Path(new File(src, "missing").toString());
+    try {
+      tree.listStatus(fs, paths, filter);
+      Assert.fail("listed a missing directory");
+    } catch (FileNotFoundException e) {
+      // expected
+    }
+    // missing paths are left out
+    FileStatus[] statuses = tree.getFileStatus(fs, paths);
+    Assert.assertEquals(11, statuses.length);
+    Assert.assertEquals(paths[6], statuses[6].getPath());
+    Assert.assertEquals(paths[8], statuses[7].getPath());
+  }
+
+  @Test
+  public void testGlobStatus() throws IOException {
+    createTree(src, 2, 5);
+    String root = src.getAbsolutePath() + "/";
+    String[] patterns = {
+      "d*/d[1-3]/f*", "{d0,d2}/d1/f1", "d*/f0", "d?/missing/f0",
+      "d*/d*", "d1/d2/f4", "d1/missing", "{d1/d2,d3}/f?", "*"
+    };
+    FileSystem serial = new RawLocalFileSystem();
+    Configuration conf = new Configuration();
+    conf.setInt(CommonConfigurationKeys.FS_GLOB_THREADS_KEY, 1);
+    serial.initialize(URI.create("file:///"), conf);
+    FileSystem parallel = new RawLocalFileSystem();
+    conf = new Configuration();
+    conf.setInt(CommonConfigurationKeys.FS_GLOB_THREADS_KEY, 6);
+    parallel.initialize(URI.create("file:///"), conf);
+    for (String pattern : patterns) {
+      Path path = new Path(root + pattern);
+      FileStatus[] expected = serial.globStatus(path);
+      FileStatus[] actual = parallel.globStatus(path);
+      if (expected == null) {
+        Assert.assertNull(pattern, actual);
+      } else {
+        assertSamePaths(expected, actual);
+      }
+    }
+    Assert.assertEquals(3 * 5 * 5,
+        parallel.globStatus(new Path(root + "d*/d[1-3]/f*")).length);
+
+    PathFilter filter = new PathFilter() {
+      public boolean accept(Path path) {
+        return !path.getName().equals("f1");
+      }
+    };
+    Path path = new Path(root + "d*/d[1-3]/f*");
+    FileStatus[] filtered = parallel.globStatus(path, filter);
+    assertSamePaths(serial.globStatus(path, filter), filtered);
+    Assert.assertEquals(3 * 5 * 4, filtered.length);
+  }
+}
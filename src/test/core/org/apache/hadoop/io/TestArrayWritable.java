@@ -61,4 +61,49 @@ public class TestArrayWritable extends TestCase {
       assertEquals(destElements[i],elements[i]);
     }
   }
+
+  /**
+   * Arrays of VIntWritable and VLongWritable are written in bulk, in the
+   * same format as one by one.
+   */
+  public void testVLongArrays() throws IOException {
+    Writable[] ints = {new VIntWritable(0), new VIntWritable(-1000),
+                       new VIntWritable(Integer.MAX_VALUE)};
+    Writable[] longs = {new VLongWritable(Long.MIN_VALUE),
+                        new VLongWritable(127)};
+    for (Writable[] elements : new Writable[][] {ints, longs}) {
+      Class<? extends Writable> c = elements[0].getClass();
+      DataOutputBuffer out = new DataOutputBuffer();
+      new ArrayWritable(c, elements).write(out);
+      DataOutputBuffer expected = new DataOutputBuffer();
+      expected.writeInt(elements.length);
+      for (Writable w : elements) {
+        w.write(expected);
+      }
+      assertEquals(expected.getLength(), out.getLength());
+      for (int i = 0; i < out.getLength(); i++) {
+        assertEquals(expected.getData()[i], out.getData()[i]);
+      }
+
+      DataInputBuffer in = new DataInputBuffer();
+      in.reset(out.getData(), out.getLength());
+      ArrayWritable read = new ArrayWritable(c);
+      read.readFields(in);
+      assertEquals(elements.length, read.get().length);
+      for (int i = 0; i < elements.length; i++) {
+        assertEquals(elements[i], read.get()[i]);
+      }
+
+      TwoDArrayWritable matrix = new TwoDArrayWritable(c,
+          new Writable[][] {elements, new Writable[0], elements});
+      out.reset();
+      matrix.write(out);
+      in.reset(out.getData(), out.getLength());
+      TwoDArrayWritable readMatrix = new TwoDArrayWritable(c);
+      readMatrix.readFields(in);
+      assertEquals(3, readMatrix.get().length);
+      assertEquals(0, readMatrix.get()[1].length);
+      assertEquals(elements[1], readMatrix.get()[2][1]);
+    }
+  }
 }
@@ -111,5 +111,45 @@ public class TestMD5Hash extends TestCase {
     t2.join();
     
   }
+
+  /** Large inputs may be hashed natively; they must still match MD5. */
+  public void testDigestLarge() throws Exception {
+    boolean wasNative = MD5Hash.getUseNative();
+    try {
+      for (boolean useNative : new boolean[] {false, true}) {
+        MD5Hash.setUseNative(useNative);
+        MessageDigest digest = MessageDigest.getInstance("MD5");
+        byte[] data = new byte[100000];
+        RANDOM.nextBytes(data);
+        for (int len : new int[] {0, 55, 56, 64, 4095, 4096, 4097, 99999}) {
+          digest.update(data, 1, len);
+          assertEquals("native=" + useNative + " len=" + len,
+                       new MD5Hash(digest.digest()),
+                       MD5Hash.digest(data, 1, len));
+        }
+      }
+    } finally {
+      MD5Hash.setUseNative(wasNative);
+    }
+  }
+
+  public void testDigestMulti() throws Exception {
+    MessageDigest digest = MessageDigest.getInstance("MD5");
+    for (int n : new int[] {1, 3, 4, 9}) {
+      for (int len : new int[] {0, 63, 64, 1000, 70000}) {
+        byte[][] data = new byte[n][len + n];
+        for (byte[] d : data) {
+          RANDOM.nextBytes(d);
+        }
+        MD5Hash[] hashes = MD5Hash.digest(data, len);
+        assertEquals(n, hashes.length);
+        for (int i = 0; i < n; i++) {
+          digest.update(data[i], 0, len);
+          assertEquals("n=" + n + " len=" + len + " i=" + i,
+                       new MD5Hash(digest.digest()), hashes[i]);
+        }
+      }
+    }
+  }
 	
 }
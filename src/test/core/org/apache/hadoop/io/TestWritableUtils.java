@@ -18,7 +18,13 @@
 
 package org.apache.hadoop.io;
 
+import java.io.ByteArrayInputStream;
+import java.io.DataInputStream;
+import java.io.EOFException;
 import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.Random;
 
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
@@ -62,4 +68,123 @@ public class TestWritableUtils extends TestCase {
     testValue(65536, 4);
     testValue(-65537, 4);
   }
+
+  private static long[] randomLongs(Random r, int n) {
+    long[] values = new long[n];
+    for (int i = 0; i < n; i++) {
+      // spread the values over all encoded sizes
+      values[i] = r.nextLong() >> r.nextInt(64);
+    }
+    return values;
+  }
+
+  public void testBulkVLongs() throws Exception {
+    Random r = new Random(0x5EED);
+    long[] values = randomLongs(r, 2000);
+    values[0] = Long.MIN_VALUE;
+    values[1] = Long.MAX_VALUE;
+    values[2] = -112;
+    values[3] = -113;
+
+    DataOutputBuffer single = new DataOutputBuffer();
+    for (long v : values) {
+      WritableUtils.writeVLong(single, v);
+    }
+    DataOutputBuffer bulk = new DataOutputBuffer();
+    WritableUtils.writeVLongs(bulk, values, 0, values.length);
+    assertEquals(single.getLength(), bulk.getLength());
+    assertEquals(single.getLength(),
+                 WritableUtils.getVLongsSize(values, 0, values.length));
+    byte[] bytes = Arrays.copyOf(single.getData(), single.getLength());
+    assertTrue(Arrays.equals(bytes,
+        Arrays.copyOf(bulk.getData(), bulk.getLength())));
+
+    byte[] array = new byte[bytes.length + 3];
+    assertEquals(array.length,
+        WritableUtils.writeVLongs(array, 3, values, 0, values.length));
+
+    long[] decoded = new long[values.length + 1];
+    assertEquals(bytes.length, WritableUtils.readVLongs(bytes, 0,
+        bytes.length, decoded, 1, values.length));
+    assertTrue(Arrays.equals(values, Arrays.copyOfRange(decoded, 1,
+        decoded.length)));
+
+    // from a DataInputBuffer, followed by another value
+    DataInputBuffer in = new DataInputBuffer();
+    WritableUtils.writeVInt(single, 77);
+    in.reset(single.getData(), single.getLength());
+    decoded = new long[values.length];
+    WritableUtils.readVLongs(in, decoded, 0, values.length);
+    assertTrue(Arrays.equals(values, decoded));
+    assertEquals(77, WritableUtils.readVInt(in));
+
+    // from any other DataInput
+    decoded = new long[values.length];
+    WritableUtils.readVLongs(new DataInputStream(
+        new ByteArrayInputStream(bytes)), decoded, 0, values.length);
+    assertTrue(Arrays.equals(values, decoded));
+
+    // through heap and direct buffers
+    for (ByteBuffer buf : new ByteBuffer[] {
+          ByteBuffer.allocate(bytes.length + 1),
+          ByteBuffer.allocateDirect(bytes.length + 1)}) {
+      buf.put((byte) 0);
+      WritableUtils.writeVLongs(buf, values, 0, values.length);
+      assertFalse(buf.hasRemaining());
+      buf.flip();
+      buf.get();
+      decoded = new long[values.length];
+      WritableUtils.readVLongs(buf, decoded, 0, values.length);
+      assertTrue(Arrays.equals(values, decoded));
+      assertFalse(buf.hasRemaining());
+    }
+  }
+
+  public void testBulkVInts() throws Exception {
+    Random r = new Random(0xC0DE);
+    int[] values = new int[1000];
+    for (int i = 0; i < values.length; i++) {
+      values[i] = r.nextInt() >> r.nextInt(32);
+    }
+    DataOutputBuffer single = new DataOutputBuffer();
+    for (int v : values) {
+      WritableUtils.writeVInt(single, v);
+    }
+    DataOutputBuffer bulk = new DataOutputBuffer();
+    WritableUtils.writeVInts(bulk, values, 0, values.length);
+    assertEquals(WritableUtils.getVIntsSize(values, 0, values.length),
+                 bulk.getLength());
+    assertTrue(Arrays.equals(
+        Arrays.copyOf(single.getData(), single.getLength()),
+        Arrays.copyOf(bulk.getData(), bulk.getLength())));
+
+    int[] decoded = new int[values.length];
+    DataInputBuffer in = new DataInputBuffer();
+    in.reset(bulk.getData(), bulk.getLength());
+    WritableUtils.readVInts(in, decoded, 0, values.length);
+    assertTrue(Arrays.equals(values, decoded));
+  }
+
+  public void testBulkTruncated() throws Exception {
+    long[] values = {1, 1000, 1L << 40};
+    byte[] bytes = new byte[WritableUtils.getVLongsSize(values, 0, 3)];
+    WritableUtils.writeVLongs(bytes, 0, values, 0, 3);
+    long[] decoded = new long[3];
+    for (int end = 0; end < bytes.length; end++) {
+      try {
+        WritableUtils.readVLongs(bytes, 0, end, decoded, 0, 3);
+        fail("decoded " + end + " of " + bytes.length + " bytes");
+      } catch (EOFException e) {
+        // expected
+      }
+    }
+    ByteBuffer buf = ByteBuffer.allocateDirect(bytes.length - 1);
+    buf.put(bytes, 0, bytes.length - 1).flip();
+    try {
+      WritableUtils.readVLongs(buf, decoded, 0, 3);
+      fail("decoded a truncated buffer");
+    } catch (EOFException e) {
+      assertEquals(0, buf.position());
+    }
+  }
 }
@@ -0,0 +1,136 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io;
+
+import java.io.IOException;
+import java.util.Random;
+
+/**
+ * VIntBenchmark measures the throughput of encoding and decoding vlongs
+ * one at a time through {@link DataOutputBuffer} and
+ * {@link DataInputBuffer}, and in bulk through the same buffers and
+ * through plain arrays, for each encoded size.
+ *
+ * <pre>
+ * VIntBenchmark [&lt;values&gt; [&lt;rounds&gt;]]
+ * </pre>
+ */
+public class VIntBenchmark {
+
+  /** Do not allow to create a new instance of the benchmark */
+  private VIntBenchmark() {}
+
+  /** @return values that each encode to size bytes */
+  private static long[] values(int size, int n) {
+    Random r = new Random(size);
+    long[] values = new long[n];
+    for (int i = 0; i < n; i++) {
+      long v;
+      if (size == 1) {
+        v = r.nextInt(240) - 112;
+      } else {
+        int bits = 8 * (size - 1);
+        long top = bits == 64 ? Long.MAX_VALUE : (1L << bits) - 1;
+        v = Math.max(128, top - (r.nextLong() & (top >>> 1)));
+        v = r.nextBoolean() ? v : ~v;
+      }
+      if (WritableUtils.getVIntSize(v) != size) {
+        throw new IllegalStateException(v + " is not " + size + " bytes");
+      }
+      values[i] = v;
+    }
+    return values;
+  }
+
+  private static void report(String name, int size, long values, long nanos) {
+    System.out.println(name + "\t" + size + "\t"
+        + String.format("%.1f", values * 1e3 / nanos) + "\t"
+        + String.format("%.1f", values * size * 1e3 / nanos));
+  }
+
+  private static void run(int size, int n, int rounds) throws IOException {
+    long[] values = values(size, n);
+    long[] decoded = new long[n];
+    DataOutputBuffer out = new DataOutputBuffer(n * size);
+    DataInputBuffer in = new DataInputBuffer();
+    byte[] array = new byte[n * size];
+    long total = (long) n * rounds;
+
+    long start = System.nanoTime();
+    for (int r = 0; r < rounds; r++) {
+      out.reset();
+      for (int i = 0; i < n; i++) {
+        WritableUtils.writeVLong(out, values[i]);
+      }
+    }
+    report("write one", size, total, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int r = 0; r < rounds; r++) {
+      out.reset();
+      WritableUtils.writeVLongs(out, values, 0, n);
+    }
+    report("write bulk", size, total, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int r = 0; r < rounds; r++) {
+      WritableUtils.writeVLongs(array, 0, values, 0, n);
+    }
+    report("write array", size, total, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int r = 0; r < rounds; r++) {
+      in.reset(out.getData(), out.getLength());
+      for (int i = 0; i < n; i++) {
+        decoded[i] = WritableUtils.readVLong(in);
+      }
+    }
+    report("read one", size, total, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int r = 0; r < rounds; r++) {
+      in.reset(out.getData(), out.getLength());
+      WritableUtils.readVLongs(in, decoded, 0, n);
+    }
+    report("read bulk", size, total, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int r = 0; r < rounds; r++) {
+      WritableUtils.readVLongs(array, 0, array.length, decoded, 0, n);
+    }
+    report("read array", size, total, System.nanoTime() - start);
+
+    for (int i = 0; i < n; i++) {
+      if (decoded[i] != values[i]) {
+        throw new IllegalStateException("decoded " + decoded[i] + " for "
+            + values[i]);
+      }
+    }
+  }
+
+  public static void main(String[] args) throws IOException {
+    int n = args.length > 0 ? Integer.parseInt(args[0]) : 100000;
+    int rounds = args.length > 1 ? Integer.parseInt(args[1]) : 200;
+    // warm up
+    run(3, n, rounds / 10);
+    System.out.println("method\tbytes\tMvalues/s\tMB/s");
+    for (int size : new int[] {1, 2, 3, 5, 9}) {
+      run(size, n, rounds);
+    }
+  }
+}
@@ -0,0 +1,127 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.compress;
+
+import java.io.IOException;
+import java.util.Random;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.io.DataInputBuffer;
+import org.apache.hadoop.io.DataOutputBuffer;
+import org.apache.hadoop.io.compress.bzip2.BZip2Factory;
+import org.apache.hadoop.util.ReflectionUtils;
+
+/**
+ * Benchmark comparing the native and pure-Java bzip2 implementations
+ * behind {@link BZip2Codec}.
+ *
+ * <pre>
+ * BZip2CodecBenchmark &lt;sizeInMB&gt; [numIterations]
+ * </pre>
+ */
+public class BZip2CodecBenchmark {
+
+  private static final String WORDS[] = {
+    "hadoop", "block", "record", "datanode", "namenode", "split", "map",
+    "reduce", "shuffle", "spill", "codec", "stream", "buffer", "inflate"
+  };
+
+  /** Do not allow to create a new instance of the benchmark */
+  private BZip2CodecBenchmark() {}
+
+  private static byte[] generate(int size) throws IOException {
+    Random rand = new Random(0xDEADBEEFL);
+    DataOutputBuffer out = new DataOutputBuffer(size + 64);
+    while (out.getLength() < size) {
+      out.write(WORDS[rand.nextInt(WORDS.length)].getBytes("UTF-8"));
+      out.write(rand.nextInt(10) == 0 ? '\n' : ' ');
+    }
+    byte[] data = new byte[size];
+    System.arraycopy(out.getData(), 0, data, 0, size);
+    return data;
+  }
+
+  private static DataOutputBuffer compress(CompressionCodec codec,
+      byte[] data) throws IOException {
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    CompressionOutputStream out = codec.createOutputStream(compressed);
+    out.write(data, 0, data.length);
+    out.finish();
+    out.close();
+    return compressed;
+  }
+
+  private static void decompress(CompressionCodec codec,
+      DataOutputBuffer compressed, byte[] buf) throws IOException {
+    DataInputBuffer in = new DataInputBuffer();
+    in.reset(compressed.getData(), 0, compressed.getLength());
+    CompressionInputStream cin = codec.createInputStream(in);
+    while (cin.read(buf, 0, buf.length) >= 0) {
+    }
+    cin.close();
+  }
+
+  private static void run(String label, Configuration conf, byte[] data,
+      int iterations) throws IOException {
+    CompressionCodec codec = ReflectionUtils.newInstance(BZip2Codec.class, conf);
+    byte[] buf = new byte[64 * 1024];
+
+    // warm up before timing
+    DataOutputBuffer compressed = compress(codec, data);
+    decompress(codec, compressed, buf);
+
+    long compressNanos = 0;
+    long decompressNanos = 0;
+    for (int i = 0; i < iterations; i++) {
+      long start = System.nanoTime();
+      compressed = compress(codec, data);
+      compressNanos += System.nanoTime() - start;
+      start = System.nanoTime();
+      decompress(codec, compressed, buf);
+      decompressNanos += System.nanoTime() - start;
+    }
+    double mb = (double)data.length * iterations / (1024 * 1024);
+    System.out.printf("%-6s compress: %8.2f MB/s  decompress: %8.2f MB/s"
+        + "  ratio: %.3f%n", label,
+        mb * 1e9 / Math.max(compressNanos, 1),
+        mb * 1e9 / Math.max(decompressNanos, 1),
+        (double)compressed.getLength() / data.length);
+  }
+
+  public static void main(String[] args) throws IOException {
+    if (args.length < 1) {
+      System.out.println("BZip2CodecBenchmark <sizeInMB> [numIterations]");
+      System.exit(1);
+    }
+    int size = Integer.parseInt(args[0]) * 1024 * 1024;
+    int iterations = args.length > 1 ? Integer.parseInt(args[1]) : 3;
+    byte[] data = generate(size);
+
+    Configuration javaConf = new Configuration();
+    javaConf.setBoolean("hadoop.native.lib", false);
+    run("java", javaConf, data, iterations);
+
+    Configuration nativeConf = new Configuration();
+    nativeConf.setBoolean("hadoop.native.lib", true);
+    if (BZip2Factory.isNativeBZip2Loaded(nativeConf)) {
+      run("native", nativeConf, data, iterations);
+    } else {
+      System.out.println("native bzip2 not loaded; skipping native run");
+    }
+  }
+}
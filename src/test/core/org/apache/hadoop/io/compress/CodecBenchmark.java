@@ -0,0 +1,527 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.compress;
+
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.io.PrintStream;
+import java.lang.management.ManagementFactory;
+import java.lang.management.ThreadMXBean;
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
+import org.apache.hadoop.fs.FileSystem;
+import org.apache.hadoop.fs.Path;
+import org.apache.hadoop.io.DataInputBuffer;
+import org.apache.hadoop.io.DataOutputBuffer;
+import org.apache.hadoop.io.IOUtils;
+import org.apache.hadoop.io.LongWritable;
+import org.apache.hadoop.io.SequenceFile;
+import org.apache.hadoop.io.Text;
+import org.apache.hadoop.io.compress.bzip2.BZip2DummyCompressor;
+import org.apache.hadoop.io.compress.bzip2.BZip2DummyDecompressor;
+import org.apache.hadoop.io.compress.bzip2.BZip2Factory;
+import org.apache.hadoop.io.compress.zlib.ZlibCompressor.CompressionLevel;
+import org.apache.hadoop.io.compress.zlib.ZlibFactory;
+import org.apache.hadoop.util.NativeCodeLoader;
+import org.apache.hadoop.util.ReflectionUtils;
+import org.apache.hadoop.util.StringUtils;
+
+/**
+ * Measures the compression codecs against each other.
+ *
+ * <p>Each of DefaultCodec, GzipCodec and BZip2Codec is run with and without
+ * the native library, over a set of generated corpora, at each compression
+ * level and stream buffer size. For every combination the benchmark reports
+ * compress and decompress throughput, the compression ratio, the bytes
+ * allocated on the Java heap per MB of input (where the JVM can report it),
+ * and the cost of compressing and decompressing 64 bytes through the
+ * codec interfaces, which for the native implementations is dominated by
+ * JNI overhead. The reset() between those calls is timed separately, as
+ * for native bzip2 it ends and reinitializes the stream.</p>
+ *
+ * <pre>
+ * CodecBenchmark [-size MB] [-iterations N]
+ *     [-codecs default,gzip,bzip2] [-native true,false]
+ *     [-corpora text,seq,random,repetitive] [-levels fast,default,best]
+ *     [-buffers 4096,65536] [-file path]... [-csv file]
+ * </pre>
+ *
+ * <p>With <code>-csv</code> one line per combination is also written to the
+ * given file, for tracking results across builds.</p>
+ */
+public class CodecBenchmark {
+
+  private static final String CSV_HEADER = "codec,native,corpus,level,"
+    + "bufferSize,inputBytes,compressedBytes,ratio,compressMBps,"
+    + "decompressMBps,compressAllocPerMB,decompressAllocPerMB,"
+    + "compress64BNanos,decompress64BNanos,"
+    + "compressorResetNanos,decompressorResetNanos";
+
+  private static final String WORDS[] = {
+    "INFO", "WARN", "DEBUG", "datanode", "namenode", "block", "blk_",
+    "received", "from", "replica", "heartbeat", "split", "map", "reduce",
+    "shuffle", "spill", "org.apache.hadoop", "Server", "Responder"
+  };
+
+  private static final Map<String, Class<? extends CompressionCodec>> CODECS =
+    new LinkedHashMap<String, Class<? extends CompressionCodec>>();
+  static {
+    CODECS.put("default", DefaultCodec.class);
+    CODECS.put("gzip", GzipCodec.class);
+    CODECS.put("bzip2", BZip2Codec.class);
+  }
+
+  private static final ThreadMXBean THREADS =
+    ManagementFactory.getThreadMXBean();
+  private static Method allocatedBytes = null;
+  static {
+    // com.sun.management.ThreadMXBean is not available on every JVM
+    try {
+      Class<?> c = Class.forName("com.sun.management.ThreadMXBean");
+      if (c.isInstance(THREADS)) {
+        allocatedBytes = c.getMethod("getThreadAllocatedBytes", long.class);
+      }
+    } catch (Exception e) {
+      allocatedBytes = null;
+    }
+  }
+
+  private int size = 4;
+  private int iterations = 3;
+  private String[] codecs = { "default", "gzip", "bzip2" };
+  private String[] natives = { "false", "true" };
+  private String[] corpora = { "text", "seq", "random", "repetitive" };
+  private String[] levels = { "fast", "default", "best" };
+  private String[] buffers = { "4096", "65536" };
+  private List<String> files = new ArrayList<String>();
+  private PrintStream csv = null;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private CodecBenchmark() {}
+
+  /** Bytes allocated by this thread so far, or -1 if not supported. */
+  private static long allocated() {
+    if (allocatedBytes == null) {
+      return -1;
+    }
+    try {
+      return (Long) allocatedBytes.invoke(THREADS,
+          Thread.currentThread().getId());
+    } catch (Exception e) {
+      return -1;
+    }
+  }
+
+  private static byte[] textCorpus(Random rand, int len) throws IOException {
+    DataOutputBuffer out = new DataOutputBuffer(len + 256);
+    StringBuilder sb = new StringBuilder();
+    long time = 1262304000000L;
+    while (out.getLength() < len) {
+      sb.setLength(0);
+      time += rand.nextInt(1000);
+      sb.append(time).append(' ').append(WORDS[rand.nextInt(3)]);
+      for (int i = 3 + rand.nextInt(10); i > 0; i--) {
+        sb.append(' ').append(WORDS[rand.nextInt(WORDS.length)]);
+        if (rand.nextInt(4) == 0) {
+          sb.append(rand.nextInt(100000));
+        }
+      }
+      sb.append('\n');
+      out.write(sb.toString().getBytes("UTF-8"));
+    }
+    byte[] data = new byte[len];
+    System.arraycopy(out.getData(), 0, data, 0, len);
+    return data;
+  }
+
+  private static byte[] sequenceFileCorpus(Random rand, int len)
+    throws IOException {
+    Configuration conf = new Configuration();
+    FileSystem fs = FileSystem.getLocal(conf);
+    Path file = new Path(System.getProperty("test.build.data", "/tmp"),
+        "codec-bench.seq");
+    SequenceFile.Writer writer = SequenceFile.createWriter(fs, conf, file,
+        Text.class, LongWritable.class, SequenceFile.CompressionType.NONE);
+    Text key = new Text();
+    LongWritable value = new LongWritable();
+    try {
+      while (writer.getLength() < len) {
+        key.set(WORDS[rand.nextInt(WORDS.length)] + rand.nextInt(1000000));
+        value.set(rand.nextLong() >>> rand.nextInt(64));
+        writer.append(key, value);
+      }
+    } finally {
+      writer.close();
+    }
+    byte[] data = new byte[len];
+    InputStream in = fs.open(file);
+    try {
+      IOUtils.readFully(in, data, 0, len);
+    } finally {
+      in.close();
+    }
+    fs.delete(file, false);
+    return data;
+  }
+
+  private static byte[] randomCorpus(Random rand, int len) {
+    byte[] data = new byte[len];
+    rand.nextBytes(data);
+    return data;
+  }
+
+  private static byte[] repetitiveCorpus(Random rand, int len) {
+    byte[] pattern = new byte[256];
+    for (int i = 0; i < pattern.length; i++) {
+      pattern[i] = (byte) ('a' + rand.nextInt(4));
+    }
+    byte[] data = new byte[len];
+    for (int i = 0; i < len; i++) {
+      data[i] = pattern[i % pattern.length];
+    }
+    return data;
+  }
+
+  private Map<String, byte[]> loadCorpora() throws IOException {
+    Map<String, byte[]> result = new LinkedHashMap<String, byte[]>();
+    int len = size * 1024 * 1024;
+    for (String name : corpora) {
+      Random rand = new Random(0xDEADBEEFL);
+      if ("text".equals(name)) {
+        result.put(name, textCorpus(rand, len));
+      } else if ("seq".equals(name)) {
+        result.put(name, sequenceFileCorpus(rand, len));
+      } else if ("random".equals(name)) {
+        result.put(name, randomCorpus(rand, len));
+      } else if ("repetitive".equals(name)) {
+        result.put(name, repetitiveCorpus(rand, len));
+      } else {
+        throw new IllegalArgumentException("Unknown corpus " + name);
+      }
+    }
+    FileSystem fs = FileSystem.getLocal(new Configuration());
+    for (String name : files) {
+      Path file = new Path(name);
+      long flen = fs.getFileStatus(file).getLen();
+      byte[] data = new byte[(int) Math.min(flen, Integer.MAX_VALUE)];
+      InputStream in = fs.open(file);
+      try {
+        IOUtils.readFully(in, data, 0, data.length);
+      } finally {
+        in.close();
+      }
+      result.put(file.getName(), data);
+    }
+    return result;
+  }
+
+  private static void setLevel(Configuration conf, String level) {
+    if ("fast".equals(level)) {
+      ZlibFactory.setCompressionLevel(conf, CompressionLevel.BEST_SPEED);
+      BZip2Factory.setBlockSize(conf, 1);
+    } else if ("default".equals(level)) {
+      ZlibFactory.setCompressionLevel(conf,
+          CompressionLevel.DEFAULT_COMPRESSION);
+      BZip2Factory.setBlockSize(conf, 9);
+    } else if ("best".equals(level)) {
+      ZlibFactory.setCompressionLevel(conf, CompressionLevel.BEST_COMPRESSION);
+      BZip2Factory.setBlockSize(conf, 9);
+    } else {
+      throw new IllegalArgumentException("Unknown level " + level);
+    }
+  }
+
+  /** A compressor configured for the level, or null if the codec has none. */
+  private static Compressor getCompressor(CompressionCodec codec,
+      Configuration conf) {
+    Compressor compressor = codec.createCompressor();
+    if (compressor != null) {
+      compressor.reinit(conf);
+    }
+    return compressor;
+  }
+
+  private static DataOutputBuffer compress(CompressionCodec codec,
+      Compressor compressor, byte[] data) throws IOException {
+    DataOutputBuffer compressed = new DataOutputBuffer(data.length / 2 + 64);
+    if (compressor != null) {
+      compressor.reset();
+    }
+    CompressionOutputStream out =
+      codec.createOutputStream(compressed, compressor);
+    out.write(data, 0, data.length);
+    out.finish();
+    out.close();
+    return compressed;
+  }
+
+  private static void decompress(CompressionCodec codec,
+      Decompressor decompressor, DataOutputBuffer compressed, byte[] buf)
+    throws IOException {
+    DataInputBuffer in = new DataInputBuffer();
+    in.reset(compressed.getData(), 0, compressed.getLength());
+    if (decompressor != null) {
+      decompressor.reset();
+    }
+    CompressionInputStream cin = codec.createInputStream(in, decompressor);
+    while (cin.read(buf, 0, buf.length) >= 0) {
+    }
+    cin.close();
+  }
+
+  /**
+   * Average nanoseconds to compress 64 bytes through the Compressor
+   * interface directly, and to reset the compressor before doing so, or
+   * -1 for both if the codec does not implement it.
+   */
+  private static long[] compressCallNanos(Compressor compressor)
+    throws IOException {
+    if (compressor == null || compressor instanceof BZip2DummyCompressor) {
+      return new long[] { -1, -1 };
+    }
+    byte[] input = repetitiveCorpus(new Random(0), 64);
+    byte[] output = new byte[1024];
+    int calls = 20000;
+    long callNanos = 0, resetNanos = 0;
+    for (int i = -calls / 10; i < calls; i++) {
+      long start = System.nanoTime();
+      compressor.reset();
+      long reset = System.nanoTime();
+      compressor.setInput(input, 0, input.length);
+      compressor.finish();
+      while (!compressor.finished()) {
+        compressor.compress(output, 0, output.length);
+      }
+      if (i >= 0) {
+        resetNanos += reset - start;
+        callNanos += System.nanoTime() - reset;
+      }
+    }
+    return new long[] { callNanos / calls, resetNanos / calls };
+  }
+
+  /**
+   * Average nanoseconds to decompress 64 bytes through the Decompressor
+   * interface directly, and to reset the decompressor before doing so, or
+   * -1 for both if the codec does not implement it.
+   */
+  private static long[] decompressCallNanos(Compressor compressor,
+      Decompressor decompressor) throws IOException {
+    if (compressor == null || decompressor == null
+        || compressor instanceof BZip2DummyCompressor
+        || decompressor instanceof BZip2DummyDecompressor) {
+      return new long[] { -1, -1 };
+    }
+    byte[] input = repetitiveCorpus(new Random(0), 64);
+    byte[] output = new byte[1024];
+    compressor.reset();
+    compressor.setInput(input, 0, input.length);
+    compressor.finish();
+    int clen = 0;
+    while (!compressor.finished()) {
+      clen += compressor.compress(output, clen, output.length - clen);
+    }
+    byte[] compressed = new byte[clen];
+    System.arraycopy(output, 0, compressed, 0, clen);
+    int calls = 20000;
+    long callNanos = 0, resetNanos = 0;
+    for (int i = -calls / 10; i < calls; i++) {
+      long start = System.nanoTime();
+      decompressor.reset();
+      long reset = System.nanoTime();
+      decompressor.setInput(compressed, 0, compressed.length);
+      while (!decompressor.finished()) {
+        if (decompressor.decompress(output, 0, output.length) == 0
+            && decompressor.needsInput()) {
+          break;
+        }
+      }
+      if (i >= 0) {
+        resetNanos += reset - start;
+        callNanos += System.nanoTime() - reset;
+      }
+    }
+    return new long[] { callNanos / calls, resetNanos / calls };
+  }
+
+  private void run(String codecName, boolean useNative, String corpus,
+      byte[] data, String level, int bufferSize) throws IOException {
+    Configuration conf = new Configuration();
+    conf.setBoolean(CommonConfigurationKeys.IO_NATIVE_LIB_AVAILABLE_KEY,
+        useNative);
+    conf.setInt("io.file.buffer.size", bufferSize);
+    setLevel(conf, level);
+    CompressionCodec codec =
+      ReflectionUtils.newInstance(CODECS.get(codecName), conf);
+    Compressor compressor = getCompressor(codec, conf);
+    Decompressor decompressor = codec.createDecompressor();
+    byte[] buf = new byte[bufferSize];
+
+    // warm up before timing
+    DataOutputBuffer compressed = compress(codec, compressor, data);
+    decompress(codec, decompressor, compressed, buf);
+
+    long compressNanos = 0, decompressNanos = 0;
+    long compressAlloc = 0, decompressAlloc = 0;
+    for (int i = 0; i < iterations; i++) {
+      long alloc = allocated();
+      long start = System.nanoTime();
+      compressed = compress(codec, compressor, data);
+      compressNanos += System.nanoTime() - start;
+      compressAlloc += allocated() - alloc;
+
+      alloc = allocated();
+      start = System.nanoTime();
+      decompress(codec, decompressor, compressed, buf);
+      decompressNanos += System.nanoTime() - start;
+      decompressAlloc += allocated() - alloc;
+    }
+    long[] compressCall = compressCallNanos(compressor);
+    long[] decompressCall = decompressCallNanos(compressor, decompressor);
+    if (compressor != null && !(compressor instanceof BZip2DummyCompressor)) {
+      compressor.end();
+    }
+    if (decompressor != null
+        && !(decompressor instanceof BZip2DummyDecompressor)) {
+      decompressor.end();
+    }
+
+    double mb = (double) data.length * iterations / (1024 * 1024);
+    double compressMBps = mb * 1e9 / Math.max(compressNanos, 1);
+    double decompressMBps = mb * 1e9 / Math.max(decompressNanos, 1);
+    double ratio = (double) compressed.getLength() / Math.max(data.length, 1);
+    long compressAllocPerMB = allocatedBytes == null ? -1
+        : (long) (compressAlloc / mb);
+    long decompressAllocPerMB = allocatedBytes == null ? -1
+        : (long) (decompressAlloc / mb);
+
+    System.out.printf("%-8s %-6s %-12s %-8s %7d %6.3f %9.2f %9.2f %12d %12d"
+        + " %7d %7d %7d %7d%n", codecName, useNative ? "native" : "java",
+        corpus, level, bufferSize, ratio, compressMBps, decompressMBps,
+        compressAllocPerMB, decompressAllocPerMB, compressCall[0],
+        decompressCall[0], compressCall[1], decompressCall[1]);
+    if (csv != null) {
+      csv.println(codecName + "," + useNative + "," + corpus + "," + level
+          + "," + bufferSize + "," + data.length + ","
+          + compressed.getLength() + "," + ratio + "," + compressMBps + ","
+          + decompressMBps + "," + compressAllocPerMB + ","
+          + decompressAllocPerMB + "," + compressCall[0] + ","
+          + decompressCall[0] + "," + compressCall[1] + ","
+          + decompressCall[1]);
+    }
+  }
+
+  private static boolean nativeAvailable(String codecName) {
+    Configuration conf = new Configuration();
+    conf.setBoolean(CommonConfigurationKeys.IO_NATIVE_LIB_AVAILABLE_KEY, true);
+    if ("bzip2".equals(codecName)) {
+      return BZip2Factory.isNativeBZip2Loaded(conf);
+    }
+    return ZlibFactory.isNativeZlibLoaded(conf);
+  }
+
+  private void runAll() throws IOException {
+    Map<String, byte[]> data = loadCorpora();
+    System.out.println("native-hadoop loaded: "
+        + NativeCodeLoader.isNativeCodeLoaded() + ", corpus size: " + size
+        + " MB, iterations: " + iterations);
+    System.out.printf("%-8s %-6s %-12s %-8s %7s %6s %9s %9s %12s %12s"
+        + " %7s %7s %7s %7s%n", "codec", "impl", "corpus", "level", "buffer",
+        "ratio", "comp MB/s", "dcmp MB/s", "comp B/MB", "dcmp B/MB",
+        "comp ns", "dcmp ns", "c rst ns", "d rst ns");
+    for (String codecName : codecs) {
+      if (!CODECS.containsKey(codecName)) {
+        throw new IllegalArgumentException("Unknown codec " + codecName);
+      }
+      for (String nativeFlag : natives) {
+        boolean useNative = Boolean.parseBoolean(nativeFlag);
+        if (useNative && !nativeAvailable(codecName)) {
+          System.out.println(codecName + ": native library not loaded,"
+              + " skipping native runs");
+          continue;
+        }
+        for (Map.Entry<String, byte[]> corpus : data.entrySet()) {
+          for (String level : levels) {
+            for (String buffer : buffers) {
+              run(codecName, useNative, corpus.getKey(), corpus.getValue(),
+                  level, Integer.parseInt(buffer));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  private static void exitOnError() {
+    System.err.println("CodecBenchmark [-size MB] [-iterations N]"
+        + " [-codecs default,gzip,bzip2] [-native true,false]"
+        + " [-corpora text,seq,random,repetitive]"
+        + " [-levels fast,default,best] [-buffers 4096,65536]"
+        + " [-file path]... [-csv file]");
+    System.exit(-1);
+  }
+
+  public static void main(String[] args) throws IOException {
+    CodecBenchmark bench = new CodecBenchmark();
+    OutputStream csvOut = null;
+    try {
+      for (int i = 0; i < args.length; i++) {
+        if (i == args.length - 1) {
+          exitOnError();
+        }
+        String arg = args[i];
+        String value = args[++i];
+        if ("-size".equals(arg)) {
+          bench.size = Integer.parseInt(value);
+        } else if ("-iterations".equals(arg)) {
+          bench.iterations = Integer.parseInt(value);
+        } else if ("-codecs".equals(arg)) {
+          bench.codecs = StringUtils.getStrings(value);
+        } else if ("-native".equals(arg)) {
+          bench.natives = StringUtils.getStrings(value);
+        } else if ("-corpora".equals(arg)) {
+          bench.corpora = StringUtils.getStrings(value);
+        } else if ("-levels".equals(arg)) {
+          bench.levels = StringUtils.getStrings(value);
+        } else if ("-buffers".equals(arg)) {
+          bench.buffers = StringUtils.getStrings(value);
+        } else if ("-file".equals(arg)) {
+          bench.files.add(value);
+        } else if ("-csv".equals(arg)) {
+          csvOut = new FileOutputStream(value);
+          bench.csv = new PrintStream(csvOut, true);
+          bench.csv.println(CSV_HEADER);
+        } else {
+          exitOnError();
+        }
+      }
+      bench.runAll();
+    } finally {
+      IOUtils.closeStream(csvOut);
+    }
+  }
+}
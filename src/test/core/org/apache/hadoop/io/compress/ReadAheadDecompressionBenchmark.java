@@ -0,0 +1,158 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.compress;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.Random;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.FileSystem;
+import org.apache.hadoop.fs.Path;
+import org.apache.hadoop.io.Text;
+import org.apache.hadoop.util.LineReader;
+import org.apache.hadoop.util.ReflectionUtils;
+
+/**
+ * Benchmark comparing a plain decompression stream with a
+ * {@link ReadAheadCompressionInputStream} when the consumer spends CPU
+ * on every record.
+ *
+ * <pre>
+ * ReadAheadDecompressionBenchmark {gzip|bzip2} &lt;numRecords&gt;
+ *     &lt;microsPerRecord&gt; [numBuffers [bufferSize]]
+ * </pre>
+ */
+public class ReadAheadDecompressionBenchmark {
+
+  private static final long SEED = 0xDEADBEEFL;
+  private static final String WORDS[] = {
+    "hadoop", "block", "record", "datanode", "namenode", "split", "map",
+    "reduce", "shuffle", "spill", "codec", "stream", "buffer", "inflate"
+  };
+
+  /** Do not allow to create a new instance of the benchmark */
+  private ReadAheadDecompressionBenchmark() {}
+
+  private static void writeInput(FileSystem fs, Path file,
+      CompressionCodec codec, int numRecords) throws IOException {
+    Random rand = new Random(SEED);
+    OutputStream out = codec.createOutputStream(fs.create(file, true));
+    StringBuilder sb = new StringBuilder();
+    try {
+      for (int i = 0; i < numRecords; i++) {
+        sb.setLength(0);
+        sb.append(i);
+        int n = 4 + rand.nextInt(16);
+        for (int j = 0; j < n; j++) {
+          sb.append(' ').append(WORDS[rand.nextInt(WORDS.length)]);
+        }
+        sb.append('\n');
+        out.write(sb.toString().getBytes("UTF-8"));
+      }
+    } finally {
+      out.close();
+    }
+  }
+
+  /** Spin for the given number of microseconds to simulate record work. */
+  private static long burn(long micros, long seed) {
+    long deadline = System.nanoTime() + micros * 1000;
+    long x = seed;
+    while (System.nanoTime() < deadline) {
+      x = x * 6364136223846793005L + 1442695040888963407L;
+    }
+    return x;
+  }
+
+  private static long consume(CompressionInputStream in, long micros)
+    throws IOException {
+    LineReader reader = new LineReader(in);
+    Text line = new Text();
+    long sink = 0;
+    try {
+      while (reader.readLine(line) > 0) {
+        sink += burn(micros, line.getLength());
+      }
+    } finally {
+      reader.close();
+    }
+    return sink;
+  }
+
+  private static long run(FileSystem fs, Path file, CompressionCodec codec,
+      long micros, int numBuffers, int bufferSize) throws IOException {
+    CompressionInputStream in = codec.createInputStream(fs.open(file));
+    if (numBuffers > 0) {
+      in = new ReadAheadCompressionInputStream(in, numBuffers, bufferSize);
+    }
+    long start = System.nanoTime();
+    consume(in, micros);
+    return System.nanoTime() - start;
+  }
+
+  private static void exitOnError() {
+    System.out.println("ReadAheadDecompressionBenchmark {gzip|bzip2}"
+        + " <numRecords> <microsPerRecord> [numBuffers [bufferSize]]");
+    System.exit(1);
+  }
+
+  public static void main(String[] args) throws IOException {
+    if (args.length < 3) {
+      exitOnError();
+    }
+    Class<? extends CompressionCodec> codecClass = null;
+    if ("gzip".equals(args[0])) {
+      codecClass = GzipCodec.class;
+    } else if ("bzip2".equals(args[0])) {
+      codecClass = BZip2Codec.class;
+    } else {
+      exitOnError();
+    }
+    int numRecords = Integer.parseInt(args[1]);
+    long micros = Long.parseLong(args[2]);
+    int numBuffers = args.length > 3 ? Integer.parseInt(args[3]) : 4;
+    int bufferSize = args.length > 4 ? Integer.parseInt(args[4]) : 64 * 1024;
+
+    Configuration conf = new Configuration();
+    FileSystem fs = FileSystem.getLocal(conf);
+    CompressionCodec codec = ReflectionUtils.newInstance(codecClass, conf);
+    Path file = new Path(System.getProperty("test.build.data", "/tmp"),
+        "readahead-bench" + codec.getDefaultExtension());
+    writeInput(fs, file, codec, numRecords);
+    long length = fs.getFileStatus(file).getLen();
+
+    // warm up both paths before timing them
+    run(fs, file, codec, micros, 0, bufferSize);
+    run(fs, file, codec, micros, numBuffers, bufferSize);
+
+    long plain = run(fs, file, codec, micros, 0, bufferSize);
+    long ahead = run(fs, file, codec, micros, numBuffers, bufferSize);
+    fs.delete(file, false);
+
+    System.out.println("Codec: " + args[0] + " #Records: " + numRecords
+        + " Compressed bytes: " + length
+        + " Work per record: " + micros + " us");
+    System.out.println("Inline decompression : " + plain / 1000000 + " ms, "
+        + (length * 1000000000L / Math.max(plain, 1)) + " compressed B/s");
+    System.out.println("Read-ahead (" + numBuffers + " x " + bufferSize
+        + ") : " + ahead / 1000000 + " ms, "
+        + (length * 1000000000L / Math.max(ahead, 1)) + " compressed B/s");
+    System.out.printf("Speedup: %.2fx%n", (double)plain / Math.max(ahead, 1));
+  }
+}
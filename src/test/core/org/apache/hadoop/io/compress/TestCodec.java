@@ -41,6 +41,7 @@ import java.util.zip.GZIPOutputStream;
 import org.apache.hadoop.conf.Configuration;
 import org.apache.hadoop.fs.FSDataOutputStream;
 import org.apache.hadoop.fs.FileStatus;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
 import org.apache.hadoop.fs.FileSystem;
 import org.apache.hadoop.fs.Path;
 import org.apache.hadoop.io.DataInputBuffer;
@@ -53,6 +54,9 @@ import org.apache.hadoop.io.Writable;
 import org.apache.hadoop.io.SequenceFile.CompressionType;
 import org.apache.hadoop.io.compress.CompressionOutputStream;
 import org.apache.hadoop.io.compress.CompressorStream;
+import org.apache.hadoop.io.compress.bzip2.BZip2Compressor;
+import org.apache.hadoop.io.compress.bzip2.BZip2Decompressor;
+import org.apache.hadoop.io.compress.bzip2.BZip2Factory;
 import org.apache.hadoop.io.compress.zlib.BuiltInZlibDeflater;
 import org.apache.hadoop.io.compress.zlib.BuiltInZlibInflater;
 import org.apache.hadoop.io.compress.zlib.ZlibCompressor.CompressionLevel;
@@ -305,6 +309,49 @@ public class TestCodec {
     assertTrue("Got mismatched ZlibCompressor", c2 != CodecPool.getCompressor(gzc));
   }
 
+  @Test
+  public void testStreamEndsOwnCodec() throws IOException {
+    Configuration conf = new Configuration();
+    conf.setBoolean("hadoop.native.lib", true);
+    conf.setInt(CommonConfigurationKeys.IO_COMPRESSION_READAHEAD_BUFFERS_KEY, 0);
+    if (!ZlibFactory.isNativeZlibLoaded(conf)) {
+      LOG.warn("testStreamEndsOwnCodec skipped: native libs not loaded");
+      return;
+    }
+    DefaultCodec codec = ReflectionUtils.newInstance(DefaultCodec.class, conf);
+    ByteArrayOutputStream bos = new ByteArrayOutputStream();
+    CompressorStream out = (CompressorStream) codec.createOutputStream(bos);
+    out.write(new byte[100]);
+    out.close();
+    try {
+      out.compressor.reset();
+      fail("Compressor created for the stream was not ended");
+    } catch (NullPointerException e) {
+      // expected
+    }
+    DecompressorStream in = (DecompressorStream)
+      codec.createInputStream(new ByteArrayInputStream(bos.toByteArray()));
+    byte[] buf = new byte[200];
+    int total = 0;
+    for (int n; (n = in.read(buf, total, buf.length - total)) > 0; ) {
+      total += n;
+    }
+    assertEquals(100, total);
+    in.close();
+    try {
+      in.decompressor.reset();
+      fail("Decompressor created for the stream was not ended");
+    } catch (NullPointerException e) {
+      // expected
+    }
+
+    // codecs passed in belong to the caller
+    Compressor compressor = codec.createCompressor();
+    codec.createOutputStream(new ByteArrayOutputStream(), compressor).close();
+    compressor.reset();
+    compressor.end();
+  }
+
   private static void gzipReinitTest(Configuration conf, CompressionCodec codec)
       throws IOException {
     // Add codec to cache
@@ -353,6 +400,94 @@ public class TestCodec {
     gzipReinitTest(conf, dfc);
   }
 
+  private static byte[] bzip2RoundTrip(Configuration compressConf,
+      Configuration decompressConf, byte[] data) throws IOException {
+    BZip2Codec compressCodec =
+      ReflectionUtils.newInstance(BZip2Codec.class, compressConf);
+    BZip2Codec decompressCodec =
+      ReflectionUtils.newInstance(BZip2Codec.class, decompressConf);
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    CompressionOutputStream out = compressCodec.createOutputStream(compressed);
+    out.write(data, 0, data.length);
+    out.finish();
+    out.close();
+
+    DataInputBuffer deflated = new DataInputBuffer();
+    deflated.reset(compressed.getData(), 0, compressed.getLength());
+    CompressionInputStream in = decompressCodec.createInputStream(deflated);
+    DataOutputBuffer result = new DataOutputBuffer();
+    IOUtils.copyBytes(in, result, 4096, true);
+    return Arrays.copyOf(result.getData(), result.getLength());
+  }
+
+  @Test
+  public void testBZip2NativeCompatibility() throws Exception {
+    Configuration nativeConf = new Configuration();
+    nativeConf.setBoolean("hadoop.native.lib", true);
+    if (!BZip2Factory.isNativeBZip2Loaded(nativeConf)) {
+      LOG.warn("testBZip2NativeCompatibility skipped: native libs not loaded");
+      return;
+    }
+    Configuration javaConf = new Configuration();
+    javaConf.setBoolean("hadoop.native.lib", false);
+    BZip2Codec codec = ReflectionUtils.newInstance(BZip2Codec.class, nativeConf);
+    assertEquals(BZip2Compressor.class, codec.getCompressorType());
+    assertEquals(BZip2Decompressor.class, codec.getDecompressorType());
+
+    Random r = new Random(seed);
+    for (int len : new int[] { 0, 1, 1000, 2 * 1024 * 1024 }) {
+      byte[] data = new byte[len];
+      for (int i = 0; i < len; i++) {
+        data[i] = (byte)('a' + r.nextInt(10));
+      }
+      assertTrue("native -> java",
+          Arrays.equals(data, bzip2RoundTrip(nativeConf, javaConf, data)));
+      assertTrue("java -> native",
+          Arrays.equals(data, bzip2RoundTrip(javaConf, nativeConf, data)));
+      assertTrue("native -> native",
+          Arrays.equals(data, bzip2RoundTrip(nativeConf, nativeConf, data)));
+    }
+  }
+
+  @Test
+  public void testCodecPoolBZip2Reuse() throws Exception {
+    Configuration conf = new Configuration();
+    conf.setBoolean("hadoop.native.lib", true);
+    if (!BZip2Factory.isNativeBZip2Loaded(conf)) {
+      LOG.warn("testCodecPoolBZip2Reuse skipped: native libs not loaded");
+      return;
+    }
+    BZip2Codec codec = ReflectionUtils.newInstance(BZip2Codec.class, conf);
+    Compressor c1 = CodecPool.getCompressor(codec);
+    Decompressor d1 = CodecPool.getDecompressor(codec);
+    CodecPool.returnCompressor(c1);
+    CodecPool.returnDecompressor(d1);
+    Compressor c2 = CodecPool.getCompressor(codec, conf);
+    Decompressor d2 = CodecPool.getDecompressor(codec);
+    assertTrue("Compressor was not reused", c1 == c2);
+    assertTrue("Decompressor was not reused", d1 == d2);
+
+    byte[] data = new byte[64 * 1024];
+    Arrays.fill(data, (byte) 'x');
+    for (int i = 0; i < 2; i++) {
+      DataOutputBuffer compressed = new DataOutputBuffer();
+      CompressionOutputStream out = codec.createOutputStream(compressed, c2);
+      out.write(data);
+      out.finish();
+      DataInputBuffer deflated = new DataInputBuffer();
+      deflated.reset(compressed.getData(), 0, compressed.getLength());
+      CompressionInputStream in = codec.createInputStream(deflated, d2);
+      byte[] result = new byte[data.length];
+      IOUtils.readFully(in, result, 0, result.length);
+      assertEquals(-1, in.read());
+      assertTrue(Arrays.equals(data, result));
+      c2.reset();
+      d2.reset();
+    }
+    CodecPool.returnCompressor(c2);
+    CodecPool.returnDecompressor(d2);
+  }
+
   @Test
   public void testSequenceFileDefaultCodec() throws IOException, ClassNotFoundException,
       InstantiationException, IllegalAccessException {
@@ -0,0 +1,251 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.compress;
+
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.Random;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
+import org.apache.hadoop.fs.FileSystem;
+import org.apache.hadoop.fs.Path;
+import org.apache.hadoop.io.DataInputBuffer;
+import org.apache.hadoop.io.DataOutputBuffer;
+import org.apache.hadoop.io.IntWritable;
+import org.apache.hadoop.io.SequenceFile;
+import org.apache.hadoop.io.Text;
+import org.apache.hadoop.util.ReflectionUtils;
+
+import org.junit.Test;
+import static org.junit.Assert.*;
+
+public class TestReadAheadCompressionInputStream {
+
+  private final Configuration conf = new Configuration();
+  private final Random r = new Random();
+
+  private static byte[] generate(Random r, int len) {
+    // compressible data: random words from a small alphabet
+    byte[] data = new byte[len];
+    for (int i = 0; i < len; i++) {
+      data[i] = (byte)('a' + r.nextInt(8));
+    }
+    return data;
+  }
+
+  private static DataOutputBuffer compress(CompressionCodec codec,
+      byte[] data) throws IOException {
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    CompressionOutputStream out = codec.createOutputStream(compressed);
+    out.write(data, 0, data.length);
+    out.finish();
+    out.close();
+    return compressed;
+  }
+
+  private void checkRoundTrip(Class<? extends CompressionCodec> codecClass,
+      int numBuffers, int bufferSize) throws IOException {
+    CompressionCodec codec = ReflectionUtils.newInstance(codecClass, conf);
+    byte[] data = generate(r, 1024 * 1024 + r.nextInt(4096));
+    DataOutputBuffer compressed = compress(codec, data);
+
+    DataInputBuffer in = new DataInputBuffer();
+    in.reset(compressed.getData(), 0, compressed.getLength());
+    CompressionInputStream cin = new ReadAheadCompressionInputStream(
+        codec.createInputStream(in), numBuffers, bufferSize);
+    byte[] result = new byte[data.length];
+    int off = 0;
+    // mix single byte and bulk reads of varying sizes
+    while (off < result.length) {
+      if (r.nextInt(16) == 0) {
+        int b = cin.read();
+        assertTrue("Premature end of stream", b >= 0);
+        result[off++] = (byte)b;
+      } else {
+        int n = cin.read(result, off,
+            Math.min(result.length - off, 1 + r.nextInt(3 * bufferSize)));
+        assertTrue("Premature end of stream", n > 0);
+        off += n;
+      }
+    }
+    assertEquals(-1, cin.read());
+    assertEquals(-1, cin.read(new byte[16], 0, 16));
+    cin.close();
+    assertTrue("Decompressed data differs", Arrays.equals(data, result));
+  }
+
+  @Test
+  public void testGzipRoundTrip() throws IOException {
+    checkRoundTrip(GzipCodec.class, 4, 64 * 1024);
+    checkRoundTrip(GzipCodec.class, 1, 1000);
+  }
+
+  @Test
+  public void testBZip2RoundTrip() throws IOException {
+    checkRoundTrip(BZip2Codec.class, 4, 64 * 1024);
+    checkRoundTrip(BZip2Codec.class, 2, 777);
+  }
+
+  @Test
+  public void testCloseBeforeEnd() throws IOException {
+    CompressionCodec codec = ReflectionUtils.newInstance(GzipCodec.class, conf);
+    byte[] data = generate(r, 4 * 1024 * 1024);
+    DataOutputBuffer compressed = compress(codec, data);
+    DataInputBuffer in = new DataInputBuffer();
+    in.reset(compressed.getData(), 0, compressed.getLength());
+    CompressionInputStream cin =
+      new ReadAheadCompressionInputStream(codec.createInputStream(in), 2, 4096);
+    byte[] buf = new byte[100];
+    assertTrue(cin.read(buf, 0, buf.length) > 0);
+    // the reader is blocked on a full ring; close must not hang
+    cin.close();
+    try {
+      cin.read();
+      fail("Read from a closed stream");
+    } catch (IOException e) {
+      // expected
+    }
+  }
+
+  @Test
+  public void testCorruptInput() throws IOException {
+    CompressionCodec codec = ReflectionUtils.newInstance(GzipCodec.class, conf);
+    byte[] data = generate(r, 256 * 1024);
+    DataOutputBuffer compressed = compress(codec, data);
+    DataInputBuffer in = new DataInputBuffer();
+    // truncate the compressed stream
+    in.reset(compressed.getData(), 0, compressed.getLength() / 2);
+    CompressionInputStream cin =
+      new ReadAheadCompressionInputStream(codec.createInputStream(in), 2, 4096);
+    byte[] buf = new byte[4096];
+    try {
+      while (cin.read(buf, 0, buf.length) >= 0) {
+      }
+      fail("Truncated stream was not detected");
+    } catch (IOException e) {
+      // expected; the reader's failure is rethrown to the consumer
+    } finally {
+      cin.close();
+    }
+  }
+
+  @Test
+  public void testWrap() throws IOException {
+    Configuration conf = new Configuration(this.conf);
+    CompressionCodec codec = ReflectionUtils.newInstance(GzipCodec.class, conf);
+    DataOutputBuffer compressed = compress(codec, generate(r, 1024));
+    DataInputBuffer in = new DataInputBuffer();
+    in.reset(compressed.getData(), 0, compressed.getLength());
+    CompressionInputStream cin = codec.createInputStream(in);
+
+    assertSame(cin, ReadAheadCompressionInputStream.wrap(cin, conf));
+    conf.setInt(CommonConfigurationKeys.IO_COMPRESSION_READAHEAD_BUFFERS_KEY, 3);
+    CompressionInputStream wrapped =
+      ReadAheadCompressionInputStream.wrap(cin, conf);
+    assertTrue(wrapped instanceof ReadAheadCompressionInputStream);
+    assertSame(wrapped, ReadAheadCompressionInputStream.wrap(wrapped, conf));
+    wrapped.close();
+  }
+
+  private void checkCodecReadAhead(Class<? extends CompressionCodec> codecClass)
+      throws IOException {
+    Configuration conf = new Configuration(this.conf);
+    conf.setInt(CommonConfigurationKeys.IO_COMPRESSION_READAHEAD_BUFFERS_KEY, 3);
+    conf.setInt(
+        CommonConfigurationKeys.IO_COMPRESSION_READAHEAD_BUFFER_SIZE_KEY, 4096);
+    CompressionCodec codec = ReflectionUtils.newInstance(codecClass, conf);
+    byte[] data = generate(r, 256 * 1024 + r.nextInt(4096));
+    DataOutputBuffer compressed = compress(codec, data);
+
+    for (int i = 0; i < 2; i++) {
+      DataInputBuffer in = new DataInputBuffer();
+      in.reset(compressed.getData(), 0, compressed.getLength());
+      Decompressor decompressor = CodecPool.getDecompressor(codec);
+      CompressionInputStream cin = (i == 0)
+        ? codec.createInputStream(in)
+        : codec.createInputStream(in, decompressor);
+      try {
+        assertTrue(codecClass.getSimpleName() + " did not read ahead",
+            cin instanceof ReadAheadCompressionInputStream);
+        byte[] result = new byte[data.length];
+        int off = 0;
+        while (off < result.length) {
+          int n = cin.read(result, off, result.length - off);
+          assertTrue("Premature end of stream", n > 0);
+          off += n;
+        }
+        assertEquals(-1, cin.read());
+        assertTrue("Decompressed data differs", Arrays.equals(data, result));
+      } finally {
+        cin.close();
+        CodecPool.returnDecompressor(decompressor);
+      }
+    }
+  }
+
+  @Test
+  public void testCodecReadAhead() throws IOException {
+    checkCodecReadAhead(DefaultCodec.class);
+    checkCodecReadAhead(GzipCodec.class);
+    checkCodecReadAhead(BZip2Codec.class);
+  }
+
+  @Test
+  public void testSequenceFileReadAhead() throws IOException {
+    Configuration conf = new Configuration(this.conf);
+    conf.setInt(CommonConfigurationKeys.IO_COMPRESSION_READAHEAD_BUFFERS_KEY, 3);
+    FileSystem fs = FileSystem.getLocal(conf);
+    Path file = new Path(System.getProperty("test.build.data", "/tmp"),
+        "readahead.seq");
+    CompressionCodec codec = ReflectionUtils.newInstance(DefaultCodec.class, conf);
+    try {
+      for (SequenceFile.CompressionType type :
+          SequenceFile.CompressionType.values()) {
+        SequenceFile.Writer writer = SequenceFile.createWriter(fs, conf, file,
+            IntWritable.class, Text.class, type, codec);
+        try {
+          for (int i = 0; i < 10000; i++) {
+            writer.append(new IntWritable(i), new Text("value " + i));
+          }
+        } finally {
+          writer.close();
+        }
+
+        // the record streams are reset between records and must not
+        // decompress ahead of the reader
+        SequenceFile.Reader reader = new SequenceFile.Reader(fs, file, conf);
+        try {
+          IntWritable key = new IntWritable();
+          Text value = new Text();
+          for (int i = 0; i < 10000; i++) {
+            assertTrue(type + ": premature end of file",
+                reader.next(key, value));
+            assertEquals(i, key.get());
+            assertEquals("value " + i, value.toString());
+          }
+          assertFalse(reader.next(key, value));
+        } finally {
+          reader.close();
+        }
+      }
+    } finally {
+      fs.delete(file, false);
+    }
+  }
+}
@@ -0,0 +1,136 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.compress.bzip2;
+
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.util.Random;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.FileSystem;
+import org.apache.hadoop.fs.Path;
+import org.apache.hadoop.io.compress.BZip2Codec;
+import org.apache.hadoop.util.ReflectionUtils;
+
+/**
+ * Measures how {@link ParallelBZip2InputStream} scales with the number of
+ * decoding threads, against the serial {@link CBZip2InputStream}.
+ *
+ * <pre>
+ * ParallelBZip2Benchmark &lt;file.bz2 | sizeInMB&gt; [maxThreads]
+ * </pre>
+ *
+ * Given a size, a file of that many MB of text is generated first. Thread
+ * counts double from 1 up to maxThreads (default 16).
+ */
+public class ParallelBZip2Benchmark {
+
+  private static final String WORDS[] = {
+    "hadoop", "block", "record", "datanode", "namenode", "split", "map",
+    "reduce", "shuffle", "spill", "codec", "stream", "buffer", "inflate"
+  };
+
+  /** Do not allow to create a new instance of the benchmark */
+  private ParallelBZip2Benchmark() {}
+
+  private static Path generate(FileSystem fs, long size) throws IOException {
+    Path file = new Path(System.getProperty("test.build.data", "/tmp"),
+        "parallel-bzip2-bench.bz2");
+    Configuration conf = new Configuration();
+    conf.setBoolean("hadoop.native.lib", false);
+    BZip2Codec codec = ReflectionUtils.newInstance(BZip2Codec.class, conf);
+    OutputStream out = codec.createOutputStream(fs.create(file, true));
+    Random rand = new Random(0xDEADBEEFL);
+    StringBuilder sb = new StringBuilder();
+    try {
+      for (long written = 0; written < size; ) {
+        sb.setLength(0);
+        sb.append(written);
+        for (int i = 4 + rand.nextInt(16); i > 0; i--) {
+          sb.append(' ').append(WORDS[rand.nextInt(WORDS.length)]);
+        }
+        sb.append('\n');
+        byte[] line = sb.toString().getBytes("UTF-8");
+        out.write(line);
+        written += line.length;
+      }
+    } finally {
+      out.close();
+    }
+    return file;
+  }
+
+  private static long drain(InputStream in) throws IOException {
+    byte[] buf = new byte[64 * 1024];
+    long total = 0;
+    try {
+      for (int n; (n = in.read(buf, 0, buf.length)) >= 0; ) {
+        total += n;
+      }
+    } finally {
+      in.close();
+    }
+    return total;
+  }
+
+  public static void main(String[] args) throws IOException {
+    if (args.length < 1) {
+      System.out.println(
+          "ParallelBZip2Benchmark <file.bz2 | sizeInMB> [maxThreads]");
+      System.exit(1);
+    }
+    int maxThreads = args.length > 1 ? Integer.parseInt(args[1]) : 16;
+    Configuration conf = new Configuration();
+    FileSystem fs = FileSystem.getLocal(conf);
+    Path file;
+    boolean generated = false;
+    try {
+      file = generate(fs, Long.parseLong(args[0]) * 1024 * 1024);
+      generated = true;
+    } catch (NumberFormatException e) {
+      file = new Path(args[0]);
+    }
+    long length = fs.getFileStatus(file).getLen();
+
+    InputStream raw = fs.open(file);
+    if (raw.read() != 'B' || raw.read() != 'Z') {
+      throw new IOException(file + " is not a bzip2 file");
+    }
+    long start = System.nanoTime();
+    long uncompressed = drain(new CBZip2InputStream(raw));
+    long serial = System.nanoTime() - start;
+    System.out.println("File: " + file + " compressed: " + length
+        + " uncompressed: " + uncompressed);
+    System.out.printf("serial    : %8d ms %8.2f MB/s%n", serial / 1000000,
+        uncompressed * 1e9 / (1024 * 1024) / Math.max(serial, 1));
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+      start = System.nanoTime();
+      drain(new ParallelBZip2InputStream(fs.open(file), threads));
+      long elapsed = System.nanoTime() - start;
+      System.out.printf("%2d threads: %8d ms %8.2f MB/s  speedup %.2fx%n",
+          threads, elapsed / 1000000,
+          uncompressed * 1e9 / (1024 * 1024) / Math.max(elapsed, 1),
+          (double) serial / Math.max(elapsed, 1));
+    }
+    if (generated) {
+      fs.delete(file, false);
+    }
+  }
+}
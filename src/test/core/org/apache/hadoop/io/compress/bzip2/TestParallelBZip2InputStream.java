@@ -0,0 +1,319 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.compress.bzip2;
+
+import java.io.ByteArrayInputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.Arrays;
+import java.util.BitSet;
+import java.util.Random;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
+import org.apache.hadoop.fs.FSDataInputStream;
+import org.apache.hadoop.fs.FileSystem;
+import org.apache.hadoop.fs.Path;
+import org.apache.hadoop.io.DataOutputBuffer;
+import org.apache.hadoop.io.Text;
+import org.apache.hadoop.io.compress.BZip2Codec;
+import org.apache.hadoop.io.compress.CompressionInputStream;
+import org.apache.hadoop.io.compress.SplitCompressionInputStream;
+import org.apache.hadoop.io.compress.SplittableCompressionCodec.READ_MODE;
+import org.apache.hadoop.util.LineReader;
+import org.apache.hadoop.util.ReflectionUtils;
+
+import org.junit.Test;
+import static org.junit.Assert.*;
+
+public class TestParallelBZip2InputStream {
+
+  private final Random r = new Random();
+
+  private static byte[] generate(Random r, int len) {
+    byte[] data = new byte[len];
+    for (int i = 0; i < len; i++) {
+      // mix compressible text with runs, to exercise the RLE stages
+      data[i] = (byte) (r.nextInt(32) == 0 ? r.nextInt(256) : 'a' + r.nextInt(6));
+    }
+    return data;
+  }
+
+  /** Compress with 100k blocks so that small inputs span many blocks. */
+  private static void compress(OutputStream out, byte[] data)
+    throws IOException {
+    out.write('B');
+    out.write('Z');
+    CBZip2OutputStream bz = new CBZip2OutputStream(out, 1);
+    bz.write(data, 0, data.length);
+    bz.finish();
+  }
+
+  private static byte[] readAll(CompressionInputStream in, Random r)
+    throws IOException {
+    DataOutputBuffer out = new DataOutputBuffer();
+    byte[] buf = new byte[64 * 1024];
+    while (true) {
+      if (r.nextInt(16) == 0) {
+        int b = in.read();
+        if (b < 0) {
+          break;
+        }
+        out.write(b);
+      } else {
+        int n = in.read(buf, 0, 1 + r.nextInt(buf.length));
+        if (n < 0) {
+          break;
+        }
+        out.write(buf, 0, n);
+      }
+    }
+    in.close();
+    return Arrays.copyOf(out.getData(), out.getLength());
+  }
+
+  private void checkRoundTrip(byte[] data, int threads) throws IOException {
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    compress(compressed, data);
+    CompressionInputStream in = new ParallelBZip2InputStream(
+        new ByteArrayInputStream(compressed.getData(), 0,
+            compressed.getLength()), threads);
+    assertTrue("Decompressed data differs with " + threads + " threads",
+        Arrays.equals(data, readAll(in, r)));
+  }
+
+  @Test
+  public void testRoundTrip() throws IOException {
+    byte[] data = generate(r, 1024 * 1024 + r.nextInt(4096));
+    for (int threads : new int[] { 1, 2, 4, 7 }) {
+      checkRoundTrip(data, threads);
+    }
+    checkRoundTrip(new byte[0], 2);
+    checkRoundTrip(new byte[] { 'x' }, 2);
+  }
+
+  /** Streams that are never closed share the decoder threads. */
+  @Test
+  public void testUnclosedStreamsShareThreads() throws IOException {
+    byte[] data = generate(r, 400 * 1024);
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    compress(compressed, data);
+    for (int i = 0; i < 20; i++) {
+      CompressionInputStream in = new ParallelBZip2InputStream(
+          new ByteArrayInputStream(compressed.getData(), 0,
+              compressed.getLength()), 4);
+      assertEquals(data[0] & 0xff, in.read());
+      // dropped without close
+    }
+    int decoders = 0;
+    for (Thread t : Thread.getAllStackTraces().keySet()) {
+      if (t.getName().startsWith("bzip2 decoder")) {
+        assertTrue(t.isDaemon());
+        decoders++;
+      }
+    }
+    // no test here asks for more than 7 threads
+    assertTrue("Too many decoder threads: " + decoders, decoders <= 7);
+  }
+
+  /**
+   * A split stream decodes ahead only up to the first block past the end
+   * of the split, not a full set of blocks per thread beyond it.
+   */
+  @Test
+  public void testReadAheadStopsAtSplitEnd() throws IOException {
+    byte[] data = generate(r, 4 * 1024 * 1024);
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    compress(compressed, data);
+    ByteArrayInputStream raw = new ByteArrayInputStream(
+        compressed.getData(), 0, compressed.getLength());
+    CompressionInputStream in = new ParallelBZip2InputStream(
+        raw, 0, 1, READ_MODE.BYBLOCK, 7);
+    assertEquals(data[0] & 0xff, in.read());
+    long consumed = compressed.getLength() - raw.available();
+    // about 40 blocks; 7 threads would otherwise decode 14 ahead
+    assertTrue("Read " + consumed + " of " + compressed.getLength()
+        + " bytes for a split of one byte",
+        consumed < compressed.getLength() / 5);
+    // reading on past the end still returns the rest of the stream
+    byte[] rest = readAll(in, r);
+    assertEquals(data.length - 1, rest.length);
+    assertTrue(Arrays.equals(Arrays.copyOfRange(data, 1, data.length), rest));
+  }
+
+  @Test
+  public void testConcatenatedStreams() throws IOException {
+    byte[] a = generate(r, 300 * 1024);
+    byte[] b = generate(r, 150 * 1024);
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    compress(compressed, a);
+    compress(compressed, b);
+    CompressionInputStream in = new ParallelBZip2InputStream(
+        new ByteArrayInputStream(compressed.getData(), 0,
+            compressed.getLength()), 3);
+    byte[] expected = new byte[a.length + b.length];
+    System.arraycopy(a, 0, expected, 0, a.length);
+    System.arraycopy(b, 0, expected, a.length, b.length);
+    assertTrue(Arrays.equals(expected, readAll(in, r)));
+  }
+
+  @Test
+  public void testJoinSegments() throws IOException {
+    // Cut a block at an arbitrary bit, as a false marker would, and check
+    // that joining the halves restores it.
+    byte[] data = generate(r, 50 * 1024);
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    compress(compressed, data);
+    BZip2BlockScanner scanner = new BZip2BlockScanner(new ByteArrayInputStream(
+        compressed.getData(), 0, compressed.getLength()));
+    BZip2BlockScanner.Segment block = scanner.next();
+    assertNull(scanner.next());
+    byte[] bits = block.toStream();
+    assertTrue(Arrays.equals(data, ParallelBZip2InputStream.decode(block)));
+
+    // the stream starts with "h9", then the block's bits
+    long total = block.getBitLength();
+    long cut = 100 + r.nextInt((int) (total / 2));
+    BZip2BlockScanner.BitWriter w = new BZip2BlockScanner.BitWriter(16);
+    w.write(bits, 16, cut);
+    BZip2BlockScanner.Segment first =
+      new BZip2BlockScanner.Segment(w.toByteArray(), 0, cut, 0);
+    byte[] rest = Arrays.copyOfRange(bits, (int) ((16 + cut) >>> 3),
+        bits.length);
+    BZip2BlockScanner.Segment second = new BZip2BlockScanner.Segment(rest,
+        (int) ((16 + cut) & 7), total - cut, 0);
+    try {
+      ParallelBZip2InputStream.decode(first);
+      fail("Decoded a truncated block");
+    } catch (IOException e) {
+      // expected
+    }
+    BZip2BlockScanner.Segment joined =
+      BZip2BlockScanner.Segment.join(first, second);
+    byte[] result = ParallelBZip2InputStream.decode(joined);
+    assertTrue(Arrays.equals(data, result));
+  }
+
+  @Test
+  public void testTruncatedInput() throws IOException {
+    byte[] data = generate(r, 400 * 1024);
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    compress(compressed, data);
+    CompressionInputStream in = new ParallelBZip2InputStream(
+        new ByteArrayInputStream(compressed.getData(), 0,
+            compressed.getLength() * 2 / 3), 2);
+    try {
+      readAll(in, r);
+      fail("Truncated stream was not detected");
+    } catch (IOException e) {
+      // expected
+    }
+  }
+
+  @Test
+  public void testNotBZip2() throws IOException {
+    byte[] garbage = new byte[4096];
+    r.nextBytes(garbage);
+    try {
+      new ParallelBZip2InputStream(new ByteArrayInputStream(garbage), 2);
+      fail("Accepted a stream that is not bzip2");
+    } catch (IOException e) {
+      // expected
+    }
+  }
+
+  @Test
+  public void testCodec() throws IOException {
+    Configuration conf = new Configuration();
+    conf.setInt(
+        CommonConfigurationKeys.IO_COMPRESSION_CODEC_BZIP2_DECOMPRESS_THREADS_KEY,
+        4);
+    BZip2Codec codec = ReflectionUtils.newInstance(BZip2Codec.class, conf);
+    byte[] data = generate(r, 2 * 1024 * 1024);
+    DataOutputBuffer compressed = new DataOutputBuffer();
+    OutputStream out = codec.createOutputStream(compressed);
+    out.write(data);
+    out.close();
+    CompressionInputStream in = codec.createInputStream(
+        new ByteArrayInputStream(compressed.getData(), 0,
+            compressed.getLength()));
+    assertTrue(in instanceof ParallelBZip2InputStream);
+    assertTrue(Arrays.equals(data, readAll(in, r)));
+  }
+
+  /**
+   * Read every split of the file the way LineRecordReader does, checking
+   * that each line is read by exactly one split.
+   */
+  private static void checkSplits(BZip2Codec codec, FileSystem fs, Path file,
+      int numLines, long splitSize) throws IOException {
+    long length = fs.getFileStatus(file).getLen();
+    BitSet seen = new BitSet(numLines);
+    Text line = new Text();
+    for (long start = 0; start < length; start += splitSize) {
+      long end = Math.min(start + splitSize, length);
+      FSDataInputStream fileIn = fs.open(file);
+      SplitCompressionInputStream in = codec.createInputStream(fileIn, null,
+          start, end, READ_MODE.BYBLOCK);
+      LineReader reader = new LineReader(in);
+      if (in.getAdjustedStart() != 0) {
+        reader.readLine(line);
+      }
+      while (in.getPos() <= in.getAdjustedEnd()) {
+        if (reader.readLine(line) == 0) {
+          break;
+        }
+        int seq = Integer.parseInt(line.toString().split(" ")[0]);
+        assertFalse("Line " + seq + " read twice", seen.get(seq));
+        seen.set(seq);
+      }
+      reader.close();
+    }
+    assertEquals("Lines missing", numLines, seen.cardinality());
+  }
+
+  @Test
+  public void testSplits() throws IOException {
+    Configuration conf = new Configuration();
+    FileSystem fs = FileSystem.getLocal(conf);
+    Path file = new Path(new Path(
+        System.getProperty("test.build.data", "/tmp")).makeQualified(fs),
+        "TestParallelBZip2InputStream/splits.bz2");
+    int numLines = 60000;
+    OutputStream out = fs.create(file, true);
+    DataOutputBuffer text = new DataOutputBuffer();
+    for (int i = 0; i < numLines; i++) {
+      text.write((i + " " + r.nextLong() + " " + r.nextInt() + "\n")
+          .getBytes("UTF-8"));
+    }
+    compress(out, Arrays.copyOf(text.getData(), text.getLength()));
+    out.close();
+
+    long length = fs.getFileStatus(file).getLen();
+    for (int threads : new int[] { 1, 3 }) {
+      conf.setInt(
+          CommonConfigurationKeys.IO_COMPRESSION_CODEC_BZIP2_DECOMPRESS_THREADS_KEY,
+          threads);
+      BZip2Codec codec = ReflectionUtils.newInstance(BZip2Codec.class, conf);
+      for (int i = 0; i < 3; i++) {
+        checkSplits(codec, fs, file, numLines, 1 + r.nextInt((int) length / 3));
+      }
+    }
+    fs.delete(file.getParent(), true);
+  }
+}
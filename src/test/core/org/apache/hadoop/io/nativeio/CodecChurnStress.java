@@ -0,0 +1,153 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.nativeio;
+
+import java.io.BufferedReader;
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.FileReader;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.io.compress.CodecPool;
+import org.apache.hadoop.io.compress.CompressionCodec;
+import org.apache.hadoop.io.compress.Compressor;
+import org.apache.hadoop.io.compress.Decompressor;
+import org.apache.hadoop.io.compress.DefaultCodec;
+import org.apache.hadoop.util.ReflectionUtils;
+
+/**
+ * Creates and discards a large number of codecs, as short tasks do, and
+ * reports the resident size of the process and the usage of the
+ * {@link NativeBufferPool} as it goes.
+ *
+ * <pre>
+ * CodecChurnStress [numCodecs] [end|pool|drop|stream]
+ * </pre>
+ *
+ * <ul>
+ * <li><code>end</code> (the default) ends each codec explicitly, returning
+ * its memory to the pool;</li>
+ * <li><code>pool</code> returns each codec to the {@link CodecPool} every
+ * other time and ends the rest;</li>
+ * <li><code>drop</code> leaves each codec to the garbage collector, as
+ * callers that never end their codecs do;</li>
+ * <li><code>stream</code> only opens and closes streams through the
+ * codec, which create their own codecs and end them on close.</li>
+ * </ul>
+ */
+public class CodecChurnStress {
+
+  /** Do not allow to create a new instance */
+  private CodecChurnStress() {}
+
+  /** The resident set size of this process, from /proc, or "n/a". */
+  private static String getRss() {
+    try {
+      BufferedReader in =
+        new BufferedReader(new FileReader("/proc/self/status"));
+      try {
+        for (String line; (line = in.readLine()) != null; ) {
+          if (line.startsWith("VmRSS:")) {
+            return line.substring("VmRSS:".length()).trim();
+          }
+        }
+      } finally {
+        in.close();
+      }
+    } catch (IOException e) {
+      // not Linux
+    }
+    return "n/a";
+  }
+
+  private static void compress(Compressor compressor, byte[] data,
+      byte[] out) throws IOException {
+    compressor.setInput(data, 0, data.length);
+    compressor.finish();
+    while (!compressor.finished()) {
+      compressor.compress(out, 0, out.length);
+    }
+  }
+
+  public static void main(String[] args) throws IOException {
+    int numCodecs = args.length > 0 ? Integer.parseInt(args[0]) : 1000000;
+    String mode = args.length > 1 ? args[1] : "end";
+    if (!"end".equals(mode) && !"pool".equals(mode) && !"drop".equals(mode)
+        && !"stream".equals(mode)) {
+      System.err.println(
+          "CodecChurnStress [numCodecs] [end|pool|drop|stream]");
+      System.exit(-1);
+    }
+    Configuration conf = new Configuration();
+    CompressionCodec codec =
+      ReflectionUtils.newInstance(DefaultCodec.class, conf);
+    byte[] data = new byte[4096];
+    for (int i = 0; i < data.length; i++) {
+      data[i] = (byte) ('a' + i % 7);
+    }
+    byte[] out = new byte[8192];
+
+    System.out.println("native pool: " + NativeBufferPool.isNativeLoaded()
+        + ", compressor: " + codec.getCompressorType().getName()
+        + ", mode: " + mode);
+    System.out.println("start: rss " + getRss() + ", "
+        + NativeBufferPool.getStats());
+    long start = System.nanoTime();
+    int report = Math.max(numCodecs / 10, 1);
+    for (int i = 1; i <= numCodecs; i++) {
+      if ("stream".equals(mode)) {
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        OutputStream compressed = codec.createOutputStream(bytes);
+        compressed.write(data);
+        compressed.close();
+        InputStream uncompressed = codec.createInputStream(
+            new ByteArrayInputStream(bytes.toByteArray()));
+        while (uncompressed.read(out) > 0) {
+        }
+        uncompressed.close();
+        printProgress(i, report, start);
+        continue;
+      }
+      boolean pooled = "pool".equals(mode) && (i & 1) == 0;
+      Compressor compressor = pooled ? CodecPool.getCompressor(codec)
+                                     : codec.createCompressor();
+      Decompressor decompressor = pooled ? CodecPool.getDecompressor(codec)
+                                         : codec.createDecompressor();
+      compress(compressor, data, out);
+      if (pooled) {
+        CodecPool.returnCompressor(compressor);
+        CodecPool.returnDecompressor(decompressor);
+      } else if ("end".equals(mode) || "pool".equals(mode)) {
+        compressor.end();
+        decompressor.end();
+      }
+      printProgress(i, report, start);
+    }
+  }
+
+  private static void printProgress(int i, int report, long start) {
+    if (i % report == 0) {
+      System.out.printf("%8d codecs: %6d ms, rss %s, %s%n", i,
+          (System.nanoTime() - start) / 1000000, getRss(),
+          NativeBufferPool.getStats());
+    }
+  }
+}
@@ -0,0 +1,205 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.io.nativeio;
+
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.Random;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
+import org.apache.hadoop.io.DataInputBuffer;
+import org.apache.hadoop.io.DataOutputBuffer;
+import org.apache.hadoop.io.compress.CompressionInputStream;
+import org.apache.hadoop.io.compress.CompressionOutputStream;
+import org.apache.hadoop.io.compress.Compressor;
+import org.apache.hadoop.io.compress.Decompressor;
+import org.apache.hadoop.io.compress.DefaultCodec;
+import org.apache.hadoop.io.compress.zlib.ZlibFactory;
+import org.apache.hadoop.util.ReflectionUtils;
+
+import org.junit.Test;
+import static org.junit.Assert.*;
+
+public class TestNativeBufferPool {
+  private static final Log LOG = LogFactory.getLog(TestNativeBufferPool.class);
+
+  @Test
+  public void testAllocateAndRelease() {
+    if (!NativeBufferPool.isNativeLoaded()) {
+      LOG.warn("testAllocateAndRelease skipped: native libs not loaded");
+      return;
+    }
+    NativeBufferPool.setCapacity(1024 * 1024);
+    NativeBufferPool.trim();
+    NativeBufferPool.Stats before = NativeBufferPool.getStats();
+    assertEquals(0, before.getCachedBytes());
+
+    ByteBuffer buf = NativeBufferPool.allocate(3000);
+    assertTrue(buf.isDirect());
+    assertEquals(3000, buf.capacity());
+    for (int i = 0; i < buf.capacity(); i++) {
+      buf.put((byte) i);
+    }
+    // rounded up to the 4k size class
+    assertEquals(before.getOutstandingBytes() + 4096,
+        NativeBufferPool.getStats().getOutstandingBytes());
+
+    NativeBufferPool.release(buf);
+    NativeBufferPool.Stats after = NativeBufferPool.getStats();
+    assertEquals(before.getOutstandingBytes(), after.getOutstandingBytes());
+    assertEquals(4096, after.getCachedBytes());
+
+    // the next allocation in the same size class reuses the block
+    ByteBuffer again = NativeBufferPool.allocate(4000);
+    NativeBufferPool.Stats reused = NativeBufferPool.getStats();
+    assertEquals(after.getHits() + 1, reused.getHits());
+    assertEquals(0, reused.getCachedBytes());
+    NativeBufferPool.release(again);
+    NativeBufferPool.setCapacity(
+        CommonConfigurationKeys.IO_NATIVE_BUFFER_POOL_CAPACITY_DEFAULT);
+  }
+
+  @Test
+  public void testDoubleRelease() {
+    if (!NativeBufferPool.isNativeLoaded()) {
+      LOG.warn("testDoubleRelease skipped: native libs not loaded");
+      return;
+    }
+    ByteBuffer buf = NativeBufferPool.allocate(100);
+    NativeBufferPool.release(buf);
+    try {
+      NativeBufferPool.release(buf);
+      fail("Released a buffer twice");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+    try {
+      NativeBufferPool.release(ByteBuffer.allocate(100));
+      fail("Released a heap buffer");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+  }
+
+  @Test
+  public void testCapacity() {
+    if (!NativeBufferPool.isNativeLoaded()) {
+      LOG.warn("testCapacity skipped: native libs not loaded");
+      return;
+    }
+    NativeBufferPool.setCapacity(64 * 1024);
+    ByteBuffer[] bufs = new ByteBuffer[8];
+    for (int i = 0; i < bufs.length; i++) {
+      bufs[i] = NativeBufferPool.allocate(32 * 1024);
+    }
+    for (ByteBuffer buf : bufs) {
+      NativeBufferPool.release(buf);
+    }
+    assertTrue(NativeBufferPool.getStats().getCachedBytes() <= 64 * 1024);
+    NativeBufferPool.setCapacity(0);
+    assertEquals(0, NativeBufferPool.getStats().getCachedBytes());
+    NativeBufferPool.setCapacity(
+        CommonConfigurationKeys.IO_NATIVE_BUFFER_POOL_CAPACITY_DEFAULT);
+  }
+
+  @Test
+  public void testCodecsReleaseMemory() throws Exception {
+    Configuration conf = new Configuration();
+    conf.setBoolean("hadoop.native.lib", true);
+    if (!NativeBufferPool.isNativeLoaded()
+        || !ZlibFactory.isNativeZlibLoaded(conf)) {
+      LOG.warn("testCodecsReleaseMemory skipped: native libs not loaded");
+      return;
+    }
+    DefaultCodec codec = ReflectionUtils.newInstance(DefaultCodec.class, conf);
+    byte[] data = new byte[200 * 1024];
+    new Random().nextBytes(data);
+    long outstanding = NativeBufferPool.getStats().getOutstandingBytes();
+    for (int i = 0; i < 100; i++) {
+      Compressor compressor = codec.createCompressor();
+      Decompressor decompressor = codec.createDecompressor();
+      DataOutputBuffer compressed = new DataOutputBuffer();
+      CompressionOutputStream out =
+        codec.createOutputStream(compressed, compressor);
+      out.write(data, i, data.length - i);
+      out.close();
+      DataInputBuffer in = new DataInputBuffer();
+      in.reset(compressed.getData(), 0, compressed.getLength());
+      CompressionInputStream cin = codec.createInputStream(in, decompressor);
+      byte[] result = new byte[data.length - i];
+      int off = 0;
+      for (int n; (n = cin.read(result, off, result.length - off)) > 0; ) {
+        off += n;
+      }
+      assertEquals(result.length, off);
+      assertTrue(Arrays.equals(Arrays.copyOfRange(data, i, data.length),
+          result));
+      compressor.end();
+      decompressor.end();
+      // ending twice is harmless
+      compressor.end();
+    }
+    assertEquals(outstanding,
+        NativeBufferPool.getStats().getOutstandingBytes());
+    assertTrue(NativeBufferPool.getStats().getHits() > 0);
+  }
+
+  @Test
+  public void testUseAfterEnd() throws Exception {
+    Configuration conf = new Configuration();
+    conf.setBoolean("hadoop.native.lib", true);
+    if (!NativeBufferPool.isNativeLoaded()
+        || !ZlibFactory.isNativeZlibLoaded(conf)) {
+      LOG.warn("testUseAfterEnd skipped: native libs not loaded");
+      return;
+    }
+    DefaultCodec codec = ReflectionUtils.newInstance(DefaultCodec.class, conf);
+    Compressor compressor = codec.createCompressor();
+    compressor.end();
+    try {
+      compressor.setInput(new byte[10], 0, 10);
+      fail("Used an ended compressor");
+    } catch (NullPointerException e) {
+      assertEquals("The compressor has been ended", e.getMessage());
+    }
+    try {
+      compressor.compress(new byte[10], 0, 10);
+      fail("Used an ended compressor");
+    } catch (NullPointerException e) {
+      // expected
+    }
+
+    Decompressor decompressor = codec.createDecompressor();
+    decompressor.end();
+    try {
+      decompressor.setInput(new byte[10], 0, 10);
+      fail("Used an ended decompressor");
+    } catch (NullPointerException e) {
+      assertEquals("The decompressor has been ended", e.getMessage());
+    }
+    try {
+      decompressor.decompress(new byte[10], 0, 10);
+      fail("Used an ended decompressor");
+    } catch (NullPointerException e) {
+      // expected
+    }
+  }
+}
@@ -0,0 +1,149 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.ipc;
+
+import java.io.IOException;
+import java.net.InetSocketAddress;
+import java.util.concurrent.Semaphore;
+import java.util.concurrent.atomic.AtomicReference;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.io.BytesWritable;
+import org.apache.hadoop.io.Writable;
+import org.apache.hadoop.net.NetUtils;
+
+/**
+ * AsyncRPCBenchmark measures the throughput of a single {@link Client}
+ * against a local echo server with 1, 16 and 256 calls outstanding at a
+ * time. Each level is run twice: with that many threads making synchronous
+ * calls over the shared connection, and with one thread keeping that many
+ * asynchronous calls in flight.
+ *
+ * <pre>
+ * AsyncRPCBenchmark &lt;callsPerRun&gt; [&lt;payloadBytes&gt; [&lt;numHandlers&gt;]]
+ * </pre>
+ */
+public class AsyncRPCBenchmark {
+  private static final int[] CONCURRENCY = {1, 16, 256};
+
+  /** Do not allow to create a new instance of the benchmark */
+  private AsyncRPCBenchmark() {}
+
+  /** Make the calls from <code>callers</code> threads, one at a time each. */
+  static void runSync(final Client client, final InetSocketAddress address,
+                      int callers, final int numCalls, int payloadBytes)
+      throws Exception {
+    final BytesWritable param = new BytesWritable(new byte[payloadBytes]);
+    final AtomicReference<Exception> error = new AtomicReference<Exception>();
+    Thread[] threads = new Thread[callers];
+    for (int i = 0; i < callers; i++) {
+      final int calls = numCalls / callers + (i < numCalls % callers ? 1 : 0);
+      threads[i] = new Thread() {
+        public void run() {
+          try {
+            for (int j = 0; j < calls; j++) {
+              client.call(param, address, null, null);
+            }
+          } catch (Exception e) {
+            error.compareAndSet(null, e);
+          }
+        }
+      };
+      threads[i].start();
+    }
+    for (Thread thread : threads) {
+      thread.join();
+    }
+    if (error.get() != null) {
+      throw error.get();
+    }
+  }
+
+  /** Make the calls from this thread with up to <code>window</code> in
+   * flight. */
+  static void runAsync(Client client, InetSocketAddress address, int window,
+                       int numCalls, int payloadBytes) throws Exception {
+    BytesWritable param = new BytesWritable(new byte[payloadBytes]);
+    final Semaphore inFlight = new Semaphore(window);
+    final AtomicReference<IOException> error =
+      new AtomicReference<IOException>();
+    Client.Callback callback = new Client.Callback() {
+      public void callComplete(Writable value) {
+        inFlight.release();
+      }
+      public void callFailed(IOException e) {
+        error.compareAndSet(null, e);
+        inFlight.release();
+      }
+    };
+    for (int i = 0; i < numCalls && error.get() == null; i++) {
+      inFlight.acquire();
+      client.call(param, address, null, null, callback);
+    }
+    inFlight.acquire(window);
+    if (error.get() != null) {
+      throw error.get();
+    }
+  }
+
+  static void printUsage() {
+    System.err.println("Usage: AsyncRPCBenchmark <callsPerRun> " +
+        "[<payloadBytes> [<numHandlers>]]");
+    System.exit(-1);
+  }
+
+  private static void report(String mode, int concurrency, int numCalls,
+                             long elapsed) {
+    System.out.println(mode + " concurrency " + concurrency
+        + ": calls per second " + (long) (numCalls / (elapsed / 1e9)));
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.out.println("Benchmark: RPC throughput of one client.");
+    if (args.length < 1)
+      printUsage();
+    int numCalls = Integer.parseInt(args[0]);
+    int payloadBytes = args.length > 1 ? Integer.parseInt(args[1]) : 100;
+    int numHandlers = args.length > 2 ? Integer.parseInt(args[2]) : 10;
+
+    Configuration conf = new Configuration();
+    Server server = new RPCLoadBenchmark.EchoServer(numHandlers, conf);
+    server.start();
+    Client client = new Client(BytesWritable.class, conf);
+    try {
+      InetSocketAddress address = NetUtils.getConnectAddress(server);
+      // warm up
+      runAsync(client, address, 16, Math.max(numCalls / 10, 1), payloadBytes);
+
+      System.out.println("Calls: " + numCalls + " Payload: " + payloadBytes
+          + " bytes Handlers: " + numHandlers);
+      for (int concurrency : CONCURRENCY) {
+        long start = System.nanoTime();
+        runSync(client, address, concurrency, numCalls, payloadBytes);
+        report("sync ", concurrency, numCalls, System.nanoTime() - start);
+
+        start = System.nanoTime();
+        runAsync(client, address, concurrency, numCalls, payloadBytes);
+        report("async", concurrency, numCalls, System.nanoTime() - start);
+      }
+    } finally {
+      client.stop();
+      server.stop();
+    }
+  }
+}
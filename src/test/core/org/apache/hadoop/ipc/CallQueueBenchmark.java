@@ -0,0 +1,88 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.ipc;
+
+import java.net.InetSocketAddress;
+import java.util.Arrays;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.CommonConfigurationKeys;
+import org.apache.hadoop.net.NetUtils;
+
+/**
+ * CallQueueBenchmark measures how the server's call queue holds up as
+ * handlers are added: for each queue type and each number of handlers, from
+ * 1 to 200, it loads a loopback echo server with as many clients as
+ * handlers and reports the calls per second and the 99th percentile
+ * latency.
+ *
+ * <pre>
+ * CallQueueBenchmark &lt;callsPerClient&gt; [&lt;queueType&gt; ...]
+ * </pre>
+ *
+ * The queue types are the values of <tt>ipc.server.callqueue</tt>; both
+ * "fifo" and "sharded" are run by default.
+ */
+public class CallQueueBenchmark {
+  private static final int[] HANDLERS = {1, 2, 5, 10, 20, 50, 100, 200};
+  private static final int PAYLOAD_BYTES = 32;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private CallQueueBenchmark() {}
+
+  public static void main(String[] args) throws Exception {
+    System.out.println("Benchmark: IPC call queue contention.");
+    if (args.length < 1) {
+      System.err.println(
+          "Usage: CallQueueBenchmark <callsPerClient> [<queueType> ...]");
+      System.exit(-1);
+    }
+    int callsPerClient = Integer.parseInt(args[0]);
+    String[] types = args.length > 1
+      ? Arrays.copyOfRange(args, 1, args.length)
+      : new String[] {"fifo", "sharded"};
+
+    for (String type : types) {
+      for (int handlers : HANDLERS) {
+        Configuration conf = new Configuration();
+        conf.set(CommonConfigurationKeys.IPC_SERVER_CALLQUEUE_KEY, type);
+        Server server = new RPCLoadBenchmark.EchoServer(handlers, conf);
+        server.start();
+        try {
+          InetSocketAddress address = NetUtils.getConnectAddress(server);
+          RPCLoadBenchmark.run(conf, address, handlers,
+              Math.max(callsPerClient / 10, 1), PAYLOAD_BYTES);
+          long start = System.nanoTime();
+          long[] latencies = RPCLoadBenchmark.run(conf, address, handlers,
+              callsPerClient, PAYLOAD_BYTES);
+          long elapsed = System.nanoTime() - start;
+          Arrays.sort(latencies);
+          System.out.println("Queue: " + type + " Handlers: " + handlers
+              + " Calls per second: "
+              + (long) (latencies.length / (elapsed / 1e9))
+              + " p99 latency: "
+              + latencies[(int) (latencies.length * 0.99)] / 1000
+              + " microseconds");
+        } finally {
+          server.stop();
+        }
+      }
+    }
+  }
+}
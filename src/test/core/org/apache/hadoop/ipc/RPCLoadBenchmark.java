@@ -0,0 +1,177 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.ipc;
+
+import java.io.IOException;
+import java.lang.management.GarbageCollectorMXBean;
+import java.lang.management.ManagementFactory;
+import java.net.InetSocketAddress;
+import java.util.Arrays;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.io.BytesWritable;
+import org.apache.hadoop.io.Writable;
+import org.apache.hadoop.net.NetUtils;
+
+/**
+ * RPCLoadBenchmark loads a local echo server with many clients and reports
+ * the calls per second, the latency of the calls and the time the JVM spent
+ * in garbage collection. Each client has its own connection and makes its
+ * calls one after another.
+ *
+ * <pre>
+ * RPCLoadBenchmark &lt;numClients&gt; &lt;callsPerClient&gt; [&lt;payloadBytes&gt; [&lt;numHandlers&gt;]]
+ * </pre>
+ *
+ * The server's buffer pool is configured as usual, through
+ * <tt>ipc.server.buffer.pool.*</tt> in <tt>core-site.xml</tt>; setting its
+ * capacity to 0 turns the pooling off for comparison.
+ */
+public class RPCLoadBenchmark {
+  private static final String ADDRESS = "0.0.0.0";
+
+  /** Do not allow to create a new instance of the benchmark */
+  private RPCLoadBenchmark() {}
+
+  static class EchoServer extends Server {
+    EchoServer(int handlerCount, Configuration conf) throws IOException {
+      super(ADDRESS, 0, BytesWritable.class, handlerCount, conf);
+    }
+
+    @Override
+    public Writable call(Class<?> protocol, Writable param, long receiveTime)
+        throws IOException {
+      return param;
+    }
+  }
+
+  private static class Caller extends Thread {
+    private final Client client;
+    private final InetSocketAddress address;
+    private final BytesWritable param;
+    private final long[] latencies;
+    private IOException error;
+
+    Caller(Configuration conf, InetSocketAddress address, int numCalls,
+           int payloadBytes) {
+      this.client = new Client(BytesWritable.class, conf);
+      this.address = address;
+      this.param = new BytesWritable(new byte[payloadBytes]);
+      this.latencies = new long[numCalls];
+    }
+
+    @Override
+    public void run() {
+      try {
+        for (int i = 0; i < latencies.length; i++) {
+          long start = System.nanoTime();
+          client.call(param, address);
+          latencies[i] = System.nanoTime() - start;
+        }
+      } catch (IOException e) {
+        error = e;
+      } finally {
+        client.stop();
+      }
+    }
+  }
+
+  private static long gcMillis() {
+    long total = 0;
+    for (GarbageCollectorMXBean gc :
+           ManagementFactory.getGarbageCollectorMXBeans()) {
+      total += Math.max(gc.getCollectionTime(), 0);
+    }
+    return total;
+  }
+
+  static long[] run(Configuration conf, InetSocketAddress address,
+                    int numClients, int callsPerClient,
+                    int payloadBytes) throws Exception {
+    Caller[] callers = new Caller[numClients];
+    for (int i = 0; i < numClients; i++) {
+      callers[i] = new Caller(conf, address, callsPerClient, payloadBytes);
+    }
+    for (Caller caller : callers) {
+      caller.start();
+    }
+    long[] latencies = new long[numClients * callsPerClient];
+    for (int i = 0; i < numClients; i++) {
+      callers[i].join();
+      if (callers[i].error != null) {
+        throw callers[i].error;
+      }
+      System.arraycopy(callers[i].latencies, 0, latencies,
+                       i * callsPerClient, callsPerClient);
+    }
+    return latencies;
+  }
+
+  static void printUsage() {
+    System.err.println("Usage: RPCLoadBenchmark <numClients> " +
+        "<callsPerClient> [<payloadBytes> [<numHandlers>]]");
+    System.exit(-1);
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.out.println("Benchmark: RPC calls under load.");
+    if (args.length < 2)
+      printUsage();
+    int numClients = Integer.parseInt(args[0]);
+    int callsPerClient = Integer.parseInt(args[1]);
+    int payloadBytes = args.length > 2 ? Integer.parseInt(args[2]) : 100;
+    int numHandlers = args.length > 3 ? Integer.parseInt(args[3]) : 10;
+
+    Configuration conf = new Configuration();
+    Server server = new EchoServer(numHandlers, conf);
+    server.start();
+    try {
+      InetSocketAddress address = NetUtils.getConnectAddress(server);
+      // warm up
+      run(conf, address, numClients, Math.max(callsPerClient / 10, 1),
+          payloadBytes);
+
+      long gcStart = gcMillis();
+      long start = System.nanoTime();
+      long[] latencies =
+        run(conf, address, numClients, callsPerClient, payloadBytes);
+      long elapsed = System.nanoTime() - start;
+      long gc = gcMillis() - gcStart;
+
+      Arrays.sort(latencies);
+      int numCalls = latencies.length;
+      BufferPool pool = server.getBufferPool();
+      System.out.println("Clients: " + numClients + " Calls: " + numCalls
+          + " Payload: " + payloadBytes + " bytes Handlers: " + numHandlers);
+      System.out.println("Calls per second: "
+          + (long) (numCalls / (elapsed / 1e9)));
+      System.out.println("Latency (microseconds): p50 "
+          + latencies[numCalls / 2] / 1000 + " p99 "
+          + latencies[(int) (numCalls * 0.99)] / 1000 + " max "
+          + latencies[numCalls - 1] / 1000);
+      System.out.println("GC time: " + gc + " Milliseconds ("
+          + 100 * gc / Math.max(elapsed / 1000000, 1) + "% of the run)");
+      System.out.println("Buffer pool: hits " + pool.getHits() + " misses "
+          + pool.getMisses() + " cached " + pool.getCachedBytes()
+          + " bytes" + (pool.isDirect() ? " (direct)" : ""));
+    } finally {
+      server.stop();
+    }
+  }
+}
@@ -0,0 +1,99 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.ipc;
+
+import java.nio.ByteBuffer;
+
+import junit.framework.TestCase;
+
+/** Unit tests for {@link BufferPool}. */
+public class TestBufferPool extends TestCase {
+
+  public void testSizeClasses() {
+    BufferPool pool = new BufferPool(1000, 1 << 20, false);
+    assertEquals(1024, pool.getMaxBufferSize());
+    int[] sizes = {0, 1, 64, 65, 128, 129, 1000, 1024};
+    int[] capacities = {64, 64, 64, 128, 128, 256, 1024, 1024};
+    for (int i = 0; i < sizes.length; i++) {
+      ByteBuffer buf = pool.get(sizes[i]);
+      assertEquals(capacities[i], buf.capacity());
+      assertEquals(0, buf.position());
+      assertEquals(sizes[i], buf.limit());
+      assertFalse(buf.isDirect());
+    }
+    // larger than the pool's largest buffer
+    ByteBuffer buf = pool.get(1025);
+    assertEquals(1025, buf.capacity());
+    pool.release(buf);
+    assertEquals(0, pool.getCachedBytes());
+    try {
+      pool.get(-1);
+      fail("Expected IllegalArgumentException");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+  }
+
+  public void testReuse() {
+    BufferPool pool = new BufferPool(4096, 1 << 20, true);
+    ByteBuffer buf = pool.get(100);
+    assertTrue(buf.isDirect());
+    buf.put((byte) 1);
+    pool.release(buf);
+    assertEquals(128, pool.getCachedBytes());
+    assertEquals(0, pool.getHits());
+    assertEquals(1, pool.getMisses());
+
+    ByteBuffer again = pool.get(70);
+    assertSame(buf, again);
+    assertEquals(0, again.position());
+    assertEquals(70, again.limit());
+    assertEquals(0, pool.getCachedBytes());
+    assertEquals(1, pool.getHits());
+
+    // a different size class is not shared
+    assertNotSame(buf, pool.get(200));
+    // nor are buffers of the wrong kind, or not from a pool
+    pool.release(ByteBuffer.allocate(128));
+    pool.release(null);
+    assertEquals(0, pool.getCachedBytes());
+  }
+
+  public void testCapacity() {
+    BufferPool pool = new BufferPool(4096, 256, false);
+    ByteBuffer b1 = pool.get(128);
+    ByteBuffer b2 = pool.get(128);
+    ByteBuffer b3 = pool.get(128);
+    pool.release(b1);
+    pool.release(b2);
+    pool.release(b3);
+    assertEquals(256, pool.getCachedBytes());
+    pool.get(128);
+    pool.get(128);
+    assertEquals(0, pool.getCachedBytes());
+    assertEquals(2, pool.getHits());
+
+    BufferPool none = new BufferPool(4096, 0, false);
+    none.release(none.get(10));
+    assertEquals(0, none.getCachedBytes());
+    none.get(10);
+    assertEquals(0, none.getHits());
+    assertEquals(2, none.getMisses());
+  }
+}
@@ -25,7 +25,14 @@ import org.apache.hadoop.io.LongWritable;
 import org.apache.hadoop.util.StringUtils;
 import org.apache.hadoop.net.NetUtils;
 
+import java.util.ArrayList;
+import java.util.List;
 import java.util.Random;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
 import java.io.DataInput;
 import java.io.IOException;
 import java.net.InetSocketAddress;
@@ -234,6 +241,68 @@ public class TestIPC extends TestCase {
     }
   }
 
+  public void testAsyncCalls() throws Exception {
+    Server server = new TestServer(3, false);
+    InetSocketAddress addr = NetUtils.getConnectAddress(server);
+    server.start();
+    Client client = new Client(LongWritable.class, conf);
+    try {
+      final int count = 500;
+      final AtomicInteger completed = new AtomicInteger();
+      final CountDownLatch latch = new CountDownLatch(count);
+      Client.Callback callback = new Client.Callback() {
+        public void callComplete(Writable value) {
+          completed.incrementAndGet();
+          latch.countDown();
+        }
+        public void callFailed(IOException error) {
+          LOG.fatal("Caught: " + StringUtils.stringifyException(error));
+          latch.countDown();
+        }
+      };
+
+      // keep all calls in flight from this one thread
+      LongWritable[] params = new LongWritable[count];
+      List<Future<Writable>> futures = new ArrayList<Future<Writable>>();
+      for (int i = 0; i < count; i++) {
+        params[i] = new LongWritable(RANDOM.nextLong());
+        futures.add(client.call(params[i], addr, null, null, callback));
+      }
+      for (int i = 0; i < count; i++) {
+        assertEquals(params[i], futures.get(i).get(10, TimeUnit.SECONDS));
+        assertTrue(futures.get(i).isDone());
+      }
+      assertTrue(latch.await(10, TimeUnit.SECONDS));
+      assertEquals(count, completed.get());
+
+      // callers in several threads share the connection
+      testSerial(3, false, 1, 16, 50);
+    } finally {
+      client.stop();
+      server.stop();
+    }
+  }
+
+  public void testAsyncErrorClient() throws Exception {
+    Server server = new TestServer(1, false);
+    InetSocketAddress addr = NetUtils.getConnectAddress(server);
+    server.start();
+    Client client = new Client(LongErrorWritable.class, conf);
+    try {
+      Future<Writable> future = client.call(
+          new LongErrorWritable(RANDOM.nextLong()), addr, null, null, null);
+      future.get();
+      fail("Expected an exception to have been thrown");
+    } catch (ExecutionException e) {
+      Throwable cause = e.getCause();
+      assertTrue(cause instanceof IOException);
+      assertEquals(LongErrorWritable.ERR_MSG, cause.getCause().getMessage());
+    } finally {
+      client.stop();
+      server.stop();
+    }
+  }
+
   private static class LongErrorWritable extends LongWritable {
     private final static String ERR_MSG = 
       "Come across an exception while reading";
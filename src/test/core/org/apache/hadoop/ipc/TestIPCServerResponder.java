@@ -124,14 +124,22 @@ public class TestIPCServerResponder extends TestCase {
   }
 
   public void testServerResponder() throws Exception {
+    Server server = testServerResponder(10, true, 1, 10, 200);
+    // requests and responses reuse the server's pooled buffers
+    assertTrue(server.getBufferPool().getHits() > 0);
+  }
+
+  public void testShardedCallQueue() throws Exception {
+    conf.set(CommonConfigurationKeys.IPC_SERVER_CALLQUEUE_KEY, "sharded");
     testServerResponder(10, true, 1, 10, 200);
+    conf = new Configuration(); // reset configuration
   }
 
-  public void testServerResponder(final int handlerCount, 
-                                  final boolean handlerSleep, 
-                                  final int clientCount,
-                                  final int callerCount,
-                                  final int callCount) throws Exception {
+  public Server testServerResponder(final int handlerCount, 
+                                    final boolean handlerSleep, 
+                                    final int clientCount,
+                                    final int callerCount,
+                                    final int callCount) throws Exception {
     Server server = new TestServer(handlerCount, handlerSleep);
     server.start();
 
@@ -154,6 +162,7 @@ public class TestIPCServerResponder extends TestCase {
       clients[i].stop();
     }
     server.stop();
+    return server;
   }
 
 }
@@ -36,6 +36,7 @@ import org.apache.hadoop.io.Writable;
 
 import org.apache.hadoop.metrics.MetricsRecord;
 import org.apache.hadoop.metrics.spi.NullContext;
+import org.apache.hadoop.metrics.util.MetricsHistogram;
 import org.apache.hadoop.metrics.util.MetricsTimeVaryingRate;
 import org.apache.hadoop.net.NetUtils;
 import org.apache.hadoop.security.authorize.AuthorizationException;
@@ -260,6 +261,7 @@ public class TestRPC extends TestCase {
     
     // Number 4 includes getProtocolVersion()
     assertEquals(4, server.rpcMetrics.rpcProcessingTime.getPreviousIntervalNumOps());
+    assertEquals(4, server.rpcMetrics.rpcQueueWaitTime.getPreviousIntervalNumOps());
     assertTrue(server.rpcMetrics.sentBytes.getPreviousIntervalValue() > 0);
     assertTrue(server.rpcMetrics.receivedBytes.getPreviousIntervalValue() > 0);
     
@@ -273,6 +275,9 @@ public class TestRPC extends TestCase {
     metrics = 
       (MetricsTimeVaryingRate)server.rpcDetailedMetrics.registry.get("ping");
     assertEquals(1, metrics.getPreviousIntervalNumOps());
+    MetricsHistogram latency =
+      (MetricsHistogram)server.rpcDetailedMetrics.registry.get("echoLatency");
+    assertEquals(2, latency.getPreviousIntervalNumOps());
     
     String[] stringResults = proxy.echo(new String[]{"foo","bar"});
     assertTrue(Arrays.equals(stringResults, new String[]{"foo","bar"}));
@@ -0,0 +1,126 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.ipc;
+
+import java.util.ArrayList;
+import java.util.BitSet;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import junit.framework.TestCase;
+
+/** Unit tests for {@link ShardedCallQueue}. */
+public class TestShardedCallQueue extends TestCase {
+
+  public void testBound() throws Exception {
+    ShardedCallQueue<Integer> queue = new ShardedCallQueue<Integer>(3, 2);
+    assertTrue(queue.offer(1));
+    assertTrue(queue.offer(2));
+    queue.put(3);
+    assertEquals(3, queue.size());
+    assertEquals(0, queue.remainingCapacity());
+    assertFalse(queue.offer(4));
+    assertFalse(queue.offer(4, 10, TimeUnit.MILLISECONDS));
+
+    BitSet seen = new BitSet();
+    seen.set(queue.take());
+    seen.set(queue.poll());
+    assertEquals(1, queue.remainingCapacity());
+    ArrayList<Integer> rest = new ArrayList<Integer>();
+    assertEquals(1, queue.drainTo(rest));
+    seen.set(rest.get(0));
+    assertEquals(3, seen.cardinality());
+    assertTrue(seen.get(1) && seen.get(2) && seen.get(3));
+    assertNull(queue.poll());
+    assertNull(queue.poll(10, TimeUnit.MILLISECONDS));
+    assertTrue(queue.isEmpty());
+  }
+
+  public void testBlockingPut() throws Exception {
+    final ShardedCallQueue<Integer> queue = new ShardedCallQueue<Integer>(1, 4);
+    queue.put(1);
+    Thread producer = new Thread() {
+      public void run() {
+        try {
+          queue.put(2);
+        } catch (InterruptedException e) {
+        }
+      }
+    };
+    producer.start();
+    producer.join(100);
+    assertTrue("put should block on a full queue", producer.isAlive());
+    assertEquals(Integer.valueOf(1), queue.take());
+    producer.join();
+    assertEquals(Integer.valueOf(2), queue.take());
+  }
+
+  public void testManyThreads() throws Exception {
+    final int numProducers = 4;
+    final int numConsumers = 16;
+    final int perProducer = 20000;
+    final ShardedCallQueue<Integer> queue =
+      new ShardedCallQueue<Integer>(100, 4);
+    final BitSet seen = new BitSet();
+    final AtomicInteger duplicates = new AtomicInteger();
+    Thread[] threads = new Thread[numProducers + numConsumers];
+    for (int p = 0; p < numProducers; p++) {
+      final int base = p * perProducer;
+      threads[p] = new Thread() {
+        public void run() {
+          try {
+            for (int i = 0; i < perProducer; i++) {
+              queue.put(base + i);
+            }
+          } catch (InterruptedException e) {
+          }
+        }
+      };
+    }
+    final int perConsumer = numProducers * perProducer / numConsumers;
+    for (int c = 0; c < numConsumers; c++) {
+      threads[numProducers + c] = new Thread() {
+        public void run() {
+          try {
+            for (int i = 0; i < perConsumer; i++) {
+              int v = queue.take();
+              synchronized (seen) {
+                if (seen.get(v)) {
+                  duplicates.incrementAndGet();
+                }
+                seen.set(v);
+              }
+            }
+          } catch (InterruptedException e) {
+          }
+        }
+      };
+    }
+    for (Thread t : threads) {
+      t.start();
+    }
+    for (Thread t : threads) {
+      t.join();
+    }
+    assertEquals(0, duplicates.get());
+    assertEquals(numProducers * perProducer, seen.cardinality());
+    assertTrue(queue.isEmpty());
+    assertEquals(100, queue.remainingCapacity());
+  }
+}
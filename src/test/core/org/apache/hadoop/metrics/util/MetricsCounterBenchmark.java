@@ -0,0 +1,124 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.metrics.util;
+
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.atomic.AtomicBoolean;
+
+/**
+ * MetricsCounterBenchmark measures the increments per second of the
+ * synchronized {@link MetricsTimeVaryingLong} and
+ * {@link MetricsTimeVaryingRate} against their striped versions, with 1 to
+ * 64 threads incrementing the same metric.
+ *
+ * <pre>
+ * MetricsCounterBenchmark [&lt;millisPerRun&gt;]
+ * </pre>
+ */
+public class MetricsCounterBenchmark {
+  private static final int[] THREADS = {1, 2, 4, 8, 16, 32, 64};
+
+  /** Do not allow to create a new instance of the benchmark */
+  private MetricsCounterBenchmark() {}
+
+  private interface Increment {
+    void inc();
+  }
+
+  /** @return increments per second */
+  static long run(final Increment increment, int numThreads, long millis)
+      throws InterruptedException {
+    final CountDownLatch start = new CountDownLatch(1);
+    final long[] counts = new long[numThreads];
+    final AtomicBoolean stop = new AtomicBoolean();
+    Thread[] threads = new Thread[numThreads];
+    for (int t = 0; t < numThreads; t++) {
+      final int index = t;
+      threads[t] = new Thread() {
+        public void run() {
+          try {
+            start.await();
+          } catch (InterruptedException e) {
+            return;
+          }
+          long n = 0;
+          while (true) {
+            for (int i = 0; i < 1000; i++) {
+              increment.inc();
+            }
+            n += 1000;
+            if (stop.get()) {
+              break;
+            }
+          }
+          counts[index] = n;
+        }
+      };
+      threads[t].start();
+    }
+    long begin = System.nanoTime();
+    start.countDown();
+    Thread.sleep(millis);
+    stop.set(true);
+    long total = 0;
+    for (int t = 0; t < numThreads; t++) {
+      threads[t].join();
+      total += counts[t];
+    }
+    return (long) (total / ((System.nanoTime() - begin) / 1e9));
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.out.println("Benchmark: contended metric increments.");
+    long millis = args.length > 0 ? Long.parseLong(args[0]) : 2000;
+    MetricsRegistry registry = new MetricsRegistry();
+    final MetricsTimeVaryingLong plainLong =
+      new MetricsTimeVaryingLong("plainLong", registry);
+    final MetricsTimeVaryingLong stripedLong =
+      new MetricsStripedTimeVaryingLong("stripedLong", registry);
+    final MetricsTimeVaryingRate plainRate =
+      new MetricsTimeVaryingRate("plainRate", registry);
+    final MetricsTimeVaryingRate stripedRate =
+      new MetricsStripedTimeVaryingRate("stripedRate", registry);
+    Increment[] increments = {
+      new Increment() { public void inc() { plainLong.inc(); } },
+      new Increment() { public void inc() { stripedLong.inc(); } },
+      new Increment() { public void inc() { plainRate.inc(42); } },
+      new Increment() { public void inc() { stripedRate.inc(42); } },
+    };
+    String[] names = {"long", "striped long", "rate", "striped rate"};
+
+    // warm up
+    for (Increment increment : increments) {
+      run(increment, 4, millis / 4);
+    }
+    System.out.println("Increments per second:");
+    System.out.printf("%8s", "threads");
+    for (String name : names) {
+      System.out.printf("%16s", name);
+    }
+    System.out.println();
+    for (int numThreads : THREADS) {
+      System.out.printf("%8d", numThreads);
+      for (Increment increment : increments) {
+        System.out.printf("%16d", run(increment, numThreads, millis));
+      }
+      System.out.println();
+    }
+  }
+}
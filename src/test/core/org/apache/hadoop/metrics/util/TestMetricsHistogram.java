@@ -0,0 +1,145 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.metrics.util;
+
+import java.io.IOException;
+import java.util.Collection;
+import java.util.Map;
+
+import junit.framework.TestCase;
+
+import org.apache.hadoop.metrics.ContextFactory;
+import org.apache.hadoop.metrics.MetricsContext;
+import org.apache.hadoop.metrics.MetricsRecord;
+import org.apache.hadoop.metrics.spi.NoEmitMetricsContext;
+import org.apache.hadoop.metrics.spi.OutputRecord;
+import org.apache.hadoop.metrics.spi.NullContext;
+
+public class TestMetricsHistogram extends TestCase {
+  private MetricsRegistry registry;
+  private MetricsHistogram histogram;
+
+  public void setUp() {
+    registry = new MetricsRegistry();
+    histogram = new MetricsHistogram("latency", registry);
+  }
+
+  private void endInterval() throws IOException {
+    MetricsContext context = new NullContext();
+    histogram.pushMetric(context.createRecord("test"));
+  }
+
+  public void testBuckets() throws IOException {
+    // small values are exact
+    for (int i = 0; i < 8; i++) {
+      assertEquals(i, MetricsHistogram.bucketUpperBound(i));
+    }
+    // every bucket starts just above the one before it
+    for (int i = 1; i < 61 * 8; i++) {
+      long upper = MetricsHistogram.bucketUpperBound(i);
+      long lower = MetricsHistogram.bucketUpperBound(i - 1) + 1;
+      assertTrue(upper >= lower);
+      assertTrue(upper - lower <= lower / 8);
+    }
+    assertEquals(Long.MAX_VALUE, MetricsHistogram.bucketUpperBound(61 * 8 - 1));
+  }
+
+  public void testPercentiles() throws IOException {
+    for (int i = 1; i <= 1000; i++) {
+      histogram.inc(i);
+    }
+    histogram.inc(-5);
+    histogram.inc(Long.MAX_VALUE);
+    endInterval();
+    assertEquals(1002, histogram.getPreviousIntervalNumOps());
+    long p50 = histogram.getPreviousIntervalPercentile(50);
+    assertTrue("p50 " + p50, p50 >= 500 && p50 <= 500 * 9 / 8);
+    long p99 = histogram.getPreviousIntervalPercentile(99);
+    assertTrue("p99 " + p99, p99 >= 990 && p99 <= 990 * 9 / 8);
+    assertEquals(0, histogram.getPreviousIntervalPercentile(0));
+    assertEquals(Long.MAX_VALUE, histogram.getPreviousIntervalPercentile(100));
+
+    // the next interval starts empty
+    endInterval();
+    assertEquals(0, histogram.getPreviousIntervalNumOps());
+    assertEquals(0, histogram.getPreviousIntervalPercentile(99));
+  }
+
+  public void testThreadsAreMerged() throws Exception {
+    final int perThread = 10000;
+    Thread[] threads = new Thread[8];
+    for (int t = 0; t < threads.length; t++) {
+      final long value = 100 * (t + 1);
+      threads[t] = new Thread() {
+        public void run() {
+          for (int i = 0; i < perThread; i++) {
+            histogram.inc(value);
+          }
+        }
+      };
+      threads[t].start();
+    }
+    for (Thread t : threads) {
+      t.join();
+    }
+    histogram.inc(1);
+    endInterval();
+    assertEquals(threads.length * perThread + 1,
+                 histogram.getPreviousIntervalNumOps());
+    long max = histogram.getPreviousIntervalPercentile(100);
+    assertTrue("max " + max, max >= 800 && max <= 900);
+
+    // counts of the exited threads are not counted again
+    histogram.inc(1);
+    endInterval();
+    assertEquals(1, histogram.getPreviousIntervalNumOps());
+  }
+
+  public void testMetricsRecord() throws IOException {
+    MetricsContext context = new NoEmitMetricsContext();
+    context.init("histogramTest", ContextFactory.getFactory());
+    MetricsRecord record = context.createRecord("record");
+    histogram.inc(10);
+    histogram.pushMetric(record);
+    record.update();
+
+    Map<String, Collection<OutputRecord>> records = context.getAllRecords();
+    OutputRecord out = records.get("record").iterator().next();
+    assertEquals(1, out.getMetric("latency_num_ops").intValue());
+    assertEquals(10, out.getMetric("latency_p99").longValue());
+    assertNotNull(out.getMetric("latency_p999"));
+    assertNotNull(out.getMetric("latency_max"));
+  }
+
+  public void testMBeanAttributes() throws Exception {
+    MetricsDynamicMBeanBase mbean =
+      new MetricsDynamicMBeanBase(registry, "test") {};
+    for (int i = 0; i < 100; i++) {
+      histogram.inc(i);
+    }
+    endInterval();
+    assertEquals(100L, mbean.getAttribute("latencyNumOps"));
+    assertEquals(histogram.getPreviousIntervalPercentile(50),
+                 mbean.getAttribute("latencyP50"));
+    assertEquals(histogram.getPreviousIntervalPercentile(99.9),
+                 mbean.getAttribute("latencyP999"));
+    assertEquals(histogram.getPreviousIntervalPercentile(100),
+                 mbean.getAttribute("latencyMaxTime"));
+    assertEquals(6, mbean.getMBeanInfo().getAttributes().length);
+  }
+}
@@ -0,0 +1,142 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.metrics.util;
+
+import java.io.IOException;
+
+import junit.framework.TestCase;
+
+import org.apache.hadoop.metrics.MetricsContext;
+import org.apache.hadoop.metrics.spi.NullContext;
+
+public class TestStripedMetrics extends TestCase {
+  private static final int THREADS = 16;
+  private static final int INCREMENTS = 100000;
+
+  private final MetricsRegistry registry = new MetricsRegistry();
+
+  private void push(MetricsBase m) throws IOException {
+    MetricsContext context = new NullContext();
+    m.pushMetric(context.createRecord("test"));
+  }
+
+  /** Run the task in THREADS threads at once. */
+  private static void runThreads(final Runnable task) throws Exception {
+    Thread[] threads = new Thread[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+      threads[i] = new Thread(task);
+      threads[i].start();
+    }
+    for (Thread t : threads) {
+      t.join();
+    }
+  }
+
+  public void testLong() throws Exception {
+    final MetricsTimeVaryingLong m =
+      new MetricsStripedTimeVaryingLong("long", registry);
+    assertSame(m, registry.get("long"));
+    runThreads(new Runnable() {
+      public void run() {
+        for (int i = 0; i < INCREMENTS; i++) {
+          m.inc();
+          m.inc(2);
+        }
+      }
+    });
+    assertEquals(3L * THREADS * INCREMENTS, m.getCurrentIntervalValue());
+    assertEquals(0, m.getPreviousIntervalValue());
+    push(m);
+    assertEquals(3L * THREADS * INCREMENTS, m.getPreviousIntervalValue());
+    assertEquals(0, m.getCurrentIntervalValue());
+    m.inc(5);
+    push(m);
+    assertEquals(5, m.getPreviousIntervalValue());
+  }
+
+  public void testInt() throws Exception {
+    final MetricsTimeVaryingInt m =
+      new MetricsStripedTimeVaryingInt("int", registry);
+    runThreads(new Runnable() {
+      public void run() {
+        for (int i = 0; i < INCREMENTS; i++) {
+          m.inc();
+        }
+      }
+    });
+    push(m);
+    assertEquals(THREADS * INCREMENTS, m.getPreviousIntervalValue());
+    push(m);
+    assertEquals(0, m.getPreviousIntervalValue());
+  }
+
+  public void testRate() throws Exception {
+    final MetricsTimeVaryingRate m =
+      new MetricsStripedTimeVaryingRate("rate", registry);
+    assertEquals(-1, m.getMinTime());
+    assertEquals(0, m.getMaxTime());
+    runThreads(new Runnable() {
+      public void run() {
+        for (int i = 0; i < INCREMENTS; i++) {
+          m.inc(10 + i % 3);          // 10, 11, 12: averages 11
+        }
+      }
+    });
+    m.inc(4, 400);
+    push(m);
+    assertEquals(THREADS * INCREMENTS + 4, m.getPreviousIntervalNumOps());
+    assertEquals(11, m.getPreviousIntervalAverageTime());
+    assertEquals(10, m.getMinTime());
+    assertEquals(100, m.getMaxTime());
+
+    m.resetMinMax();
+    assertEquals(-1, m.getMinTime());
+    assertEquals(0, m.getMaxTime());
+    m.inc(7);
+    push(m);
+    assertEquals(1, m.getPreviousIntervalNumOps());
+    assertEquals(7, m.getPreviousIntervalAverageTime());
+    assertEquals(7, m.getMinTime());
+    assertEquals(7, m.getMaxTime());
+    push(m);
+    assertEquals(0, m.getPreviousIntervalNumOps());
+    assertEquals(0, m.getPreviousIntervalAverageTime());
+  }
+
+  public void testMBean() throws Exception {
+    MetricsTimeVaryingRate rate =
+      new MetricsStripedTimeVaryingRate("rate", registry);
+    MetricsTimeVaryingLong counter =
+      new MetricsStripedTimeVaryingLong("counter", registry);
+    MetricsDynamicMBeanBase mbean =
+      new MetricsDynamicMBeanBase(registry, "test") {};
+    rate.inc(5);
+    counter.inc(3);
+    push(rate);
+    push(counter);
+    assertEquals(1, mbean.getAttribute("rateNumOps"));
+    assertEquals(5L, mbean.getAttribute("rateMaxTime"));
+    assertEquals(3L, mbean.getAttribute("counter"));
+    try {
+      registry.add("counter", counter);
+      fail("Expected a duplicate name to be rejected");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+  }
+}
@@ -0,0 +1,126 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.net;
+
+import java.util.Random;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.atomic.AtomicBoolean;
+
+/**
+ * NetworkTopologyBenchmark measures the placement-style queries per second
+ * that a {@link NetworkTopology} answers: for a random reader, the distance
+ * to three random replicas, whether they share its rack, and
+ * {@link NetworkTopology#pseudoSortByDistance(Node, Node[])} over them.
+ * The topology has 10,000 nodes in 2 data centers of 250 racks each by
+ * default, and is queried by 1 to 32 threads.
+ *
+ * <pre>
+ * NetworkTopologyBenchmark [&lt;numNodes&gt; [&lt;millisPerRun&gt;]]
+ * </pre>
+ */
+public class NetworkTopologyBenchmark {
+  private static final int[] THREADS = {1, 2, 4, 8, 16, 32};
+  private static final int NODES_PER_RACK = 20;
+  private static final int RACKS_PER_DC = 250;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private NetworkTopologyBenchmark() {}
+
+  static Node[] buildTopology(NetworkTopology cluster, int numNodes) {
+    Node[] nodes = new Node[numNodes];
+    for (int i = 0; i < numNodes; i++) {
+      int rack = i / NODES_PER_RACK;
+      nodes[i] = new NodeBase("host" + i,
+          "/dc" + (rack / RACKS_PER_DC) + "/rack" + rack);
+      cluster.add(nodes[i]);
+    }
+    return nodes;
+  }
+
+  /** @return queries per second */
+  static long run(final NetworkTopology cluster, final Node[] nodes,
+                  int numThreads, long millis) throws InterruptedException {
+    final CountDownLatch start = new CountDownLatch(1);
+    final long[] counts = new long[numThreads];
+    final AtomicBoolean stop = new AtomicBoolean();
+    Thread[] threads = new Thread[numThreads];
+    for (int t = 0; t < numThreads; t++) {
+      final int index = t;
+      threads[t] = new Thread() {
+        public void run() {
+          Random rand = new Random(index);
+          Node[] replicas = new Node[3];
+          long n = 0;
+          long sink = 0;
+          try {
+            start.await();
+          } catch (InterruptedException e) {
+            return;
+          }
+          while (!stop.get()) {
+            for (int i = 0; i < 100; i++) {
+              Node reader = nodes[rand.nextInt(nodes.length)];
+              for (int r = 0; r < replicas.length; r++) {
+                replicas[r] = nodes[rand.nextInt(nodes.length)];
+                sink += cluster.getDistance(reader, replicas[r]);
+                if (cluster.isOnSameRack(reader, replicas[r])) {
+                  sink++;
+                }
+              }
+              cluster.pseudoSortByDistance(reader, replicas);
+            }
+            n += 100;
+          }
+          counts[index] = n + (sink & 0);
+        }
+      };
+      threads[t].start();
+    }
+    long begin = System.nanoTime();
+    start.countDown();
+    Thread.sleep(millis);
+    stop.set(true);
+    long total = 0;
+    for (int t = 0; t < numThreads; t++) {
+      threads[t].join();
+      total += counts[t];
+    }
+    long elapsed = System.nanoTime() - begin;
+    return total * 1000000000L / elapsed;
+  }
+
+  public static void main(String[] args) throws Exception {
+    int numNodes = args.length > 0 ? Integer.parseInt(args[0]) : 10000;
+    long millis = args.length > 1 ? Long.parseLong(args[1]) : 2000;
+
+    NetworkTopology cluster = new NetworkTopology();
+    long begin = System.nanoTime();
+    Node[] nodes = buildTopology(cluster, numNodes);
+    System.out.println("Built a topology of " + cluster.getNumOfLeaves()
+        + " nodes in " + cluster.getNumOfRacks() + " racks in "
+        + (System.nanoTime() - begin) / 1000000 + " ms");
+
+    // warm up
+    run(cluster, nodes, 1, millis);
+    System.out.println("threads\tqueries/s");
+    for (int numThreads : THREADS) {
+      System.out.println(numThreads + "\t"
+          + run(cluster, nodes, numThreads, millis));
+    }
+  }
+}
@@ -0,0 +1,198 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.net;
+
+import java.io.IOException;
+import java.net.InetSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+
+import org.apache.hadoop.io.nativeio.NativeSocketIO;
+
+/**
+ * SocketIOBenchmark compares waiting with native poll(2) to waiting with a
+ * selector in {@link SocketInputStream} and {@link SocketOutputStream}, over
+ * a loopback connection. It times small-message round trips, where every
+ * read has to wait for the peer, and bulk streaming in one direction.
+ *
+ * <pre>
+ * SocketIOBenchmark [&lt;roundTrips&gt; [&lt;messageBytes&gt; [&lt;streamMB&gt; [&lt;chunkKB&gt;]]]]
+ * </pre>
+ */
+public class SocketIOBenchmark {
+  private static final int TIMEOUT = 60 * 1000;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private SocketIOBenchmark() {}
+
+  /** Both ends of a loopback connection, with streams. */
+  private static class Connection {
+    final SocketChannel client;
+    final SocketChannel server;
+    final SocketInputStream clientIn;
+    final SocketOutputStream clientOut;
+    final SocketInputStream serverIn;
+    final SocketOutputStream serverOut;
+
+    Connection() throws IOException {
+      ServerSocketChannel listener = ServerSocketChannel.open();
+      try {
+        listener.socket().bind(new InetSocketAddress("127.0.0.1", 0));
+        client = SocketChannel.open(listener.socket().getLocalSocketAddress());
+        server = listener.accept();
+      } finally {
+        listener.close();
+      }
+      client.socket().setTcpNoDelay(true);
+      server.socket().setTcpNoDelay(true);
+      clientIn = new SocketInputStream(client, TIMEOUT);
+      clientOut = new SocketOutputStream(client, TIMEOUT);
+      serverIn = new SocketInputStream(server, TIMEOUT);
+      serverOut = new SocketOutputStream(server, TIMEOUT);
+    }
+
+    void close() throws IOException {
+      client.close();
+      server.close();
+    }
+  }
+
+  private static void readFully(SocketInputStream in, ByteBuffer buf)
+      throws IOException {
+    buf.clear();
+    while (buf.hasRemaining()) {
+      if (in.read(buf) < 0) {
+        throw new IOException("Premature end of stream");
+      }
+    }
+  }
+
+  private static void writeFully(SocketOutputStream out, ByteBuffer buf)
+      throws IOException {
+    buf.clear();
+    while (buf.hasRemaining()) {
+      out.write(buf);
+    }
+  }
+
+  /** @return round trips per second */
+  static long roundTrips(final int count, final int messageBytes)
+      throws Exception {
+    final Connection conn = new Connection();
+    final IOException[] error = new IOException[1];
+    Thread echo = new Thread() {
+      public void run() {
+        ByteBuffer buf = ByteBuffer.allocateDirect(messageBytes);
+        try {
+          for (int i = 0; i < count; i++) {
+            readFully(conn.serverIn, buf);
+            writeFully(conn.serverOut, buf);
+          }
+        } catch (IOException e) {
+          error[0] = e;
+        }
+      }
+    };
+    echo.start();
+    ByteBuffer buf = ByteBuffer.allocateDirect(messageBytes);
+    long start = System.nanoTime();
+    try {
+      for (int i = 0; i < count; i++) {
+        writeFully(conn.clientOut, buf);
+        readFully(conn.clientIn, buf);
+      }
+      echo.join();
+    } finally {
+      conn.close();
+    }
+    if (error[0] != null) {
+      throw error[0];
+    }
+    return (long) (count / ((System.nanoTime() - start) / 1e9));
+  }
+
+  /** @return megabytes per second */
+  static long stream(final long totalBytes, final int chunkBytes)
+      throws Exception {
+    final Connection conn = new Connection();
+    final IOException[] error = new IOException[1];
+    Thread reader = new Thread() {
+      public void run() {
+        byte[] buf = new byte[chunkBytes];
+        try {
+          long remaining = totalBytes;
+          while (remaining > 0) {
+            int n = conn.serverIn.read(buf, 0,
+                                       (int) Math.min(buf.length, remaining));
+            if (n < 0) {
+              throw new IOException("Premature end of stream");
+            }
+            remaining -= n;
+          }
+        } catch (IOException e) {
+          error[0] = e;
+        }
+      }
+    };
+    reader.start();
+    byte[] buf = new byte[chunkBytes];
+    long start = System.nanoTime();
+    try {
+      for (long sent = 0; sent < totalBytes; sent += buf.length) {
+        conn.clientOut.write(buf, 0, (int) Math.min(buf.length,
+                                                    totalBytes - sent));
+      }
+      reader.join();
+    } finally {
+      conn.close();
+    }
+    if (error[0] != null) {
+      throw error[0];
+    }
+    return (long) (totalBytes / 1048576.0
+                   / ((System.nanoTime() - start) / 1e9));
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.out.println("Benchmark: socket I/O with timeouts.");
+    int count = args.length > 0 ? Integer.parseInt(args[0]) : 100000;
+    int messageBytes = args.length > 1 ? Integer.parseInt(args[1]) : 64;
+    long streamBytes =
+      (args.length > 2 ? Long.parseLong(args[2]) : 2048) * 1024 * 1024;
+    int chunkBytes = (args.length > 3 ? Integer.parseInt(args[3]) : 64) * 1024;
+
+    System.out.println("Native socket I/O loaded: "
+        + NativeSocketIO.isNativeLoaded());
+    boolean wasNative = SocketIOWithTimeout.getUseNative();
+    for (boolean useNative : new boolean[] {false, true}) {
+      if (useNative && !NativeSocketIO.isNativeLoaded()) {
+        continue;
+      }
+      SocketIOWithTimeout.setUseNative(useNative);
+      String mode = useNative ? "poll    " : "selector";
+      // warm up
+      roundTrips(Math.max(count / 10, 1), messageBytes);
+      System.out.println(mode + " round trips of " + messageBytes
+          + " bytes per second: " + roundTrips(count, messageBytes));
+      System.out.println(mode + " streaming in " + chunkBytes / 1024
+          + " KB writes: " + stream(streamBytes, chunkBytes) + " MB/s");
+    }
+    SocketIOWithTimeout.setUseNative(wasNative);
+  }
+}
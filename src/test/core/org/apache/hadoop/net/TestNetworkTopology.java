@@ -0,0 +1,161 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.net;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import junit.framework.TestCase;
+
+public class TestNetworkTopology extends TestCase {
+  private NetworkTopology cluster;
+  private NodeBase[] nodes;
+
+  protected void setUp() {
+    cluster = new NetworkTopology();
+    nodes = new NodeBase[] {
+      new NodeBase("h1", "/d1/r1"),
+      new NodeBase("h2", "/d1/r1"),
+      new NodeBase("h3", "/d1/r2"),
+      new NodeBase("h4", "/d2/r3"),
+      new NodeBase("h5", "/d2/r3"),
+      new NodeBase("h6", "/d2/r4")
+    };
+    for (NodeBase node : nodes) {
+      cluster.add(node);
+    }
+  }
+
+  public void testContains() {
+    for (NodeBase node : nodes) {
+      assertTrue(cluster.contains(node));
+    }
+    assertFalse(cluster.contains(new NodeBase("h1", "/d1/r1")));
+    assertTrue(cluster.contains(cluster.getNode("/d1/r1")));
+    assertEquals(6, cluster.getNumOfLeaves());
+    assertEquals(4, cluster.getNumOfRacks());
+  }
+
+  public void testGetDistance() {
+    assertEquals(0, cluster.getDistance(nodes[0], nodes[0]));
+    assertEquals(2, cluster.getDistance(nodes[0], nodes[1]));
+    assertEquals(4, cluster.getDistance(nodes[0], nodes[2]));
+    assertEquals(6, cluster.getDistance(nodes[0], nodes[3]));
+    assertEquals(6, cluster.getDistance(nodes[5], nodes[2]));
+    assertEquals(4, cluster.getDistance(nodes[5], nodes[4]));
+    // a node of another depth
+    NodeBase shallow = new NodeBase("h7", "/r5");
+    cluster.add(shallow);
+    assertEquals(5, cluster.getDistance(nodes[0], shallow));
+    assertEquals(5, cluster.getDistance(shallow, nodes[0]));
+  }
+
+  public void testIsOnSameRack() {
+    assertTrue(cluster.isOnSameRack(nodes[0], nodes[1]));
+    assertFalse(cluster.isOnSameRack(nodes[1], nodes[2]));
+    assertFalse(cluster.isOnSameRack(nodes[2], nodes[5]));
+    assertTrue(cluster.isOnSameRack(nodes[3], nodes[4]));
+    assertFalse(cluster.isOnSameRack(nodes[0], null));
+  }
+
+  public void testRemove() {
+    cluster.remove(nodes[2]);
+    assertFalse(cluster.contains(nodes[2]));
+    assertEquals(3, cluster.getNumOfRacks());
+    assertEquals(Integer.MAX_VALUE,
+                 cluster.getDistance(nodes[0], nodes[2]));
+    assertTrue(cluster.isOnSameRack(nodes[0], nodes[1]));
+
+    // add it back to a new rack
+    NodeBase moved = new NodeBase("h3", "/d2/r4");
+    cluster.add(moved);
+    assertEquals(2, cluster.getDistance(moved, nodes[5]));
+    assertTrue(cluster.isOnSameRack(moved, nodes[5]));
+    assertEquals(6, cluster.getDistance(moved, nodes[0]));
+  }
+
+  public void testReplace() {
+    NodeBase replacement = new NodeBase("h2", "/d1/r1");
+    cluster.add(replacement);
+    assertEquals(6, cluster.getNumOfLeaves());
+    assertTrue(cluster.contains(replacement));
+    assertEquals(2, cluster.getDistance(nodes[0], replacement));
+    assertTrue(cluster.isOnSameRack(nodes[0], replacement));
+  }
+
+  public void testPseudoSortByDistance() {
+    Node[] sorted = new Node[] {nodes[3], nodes[2], nodes[1], nodes[0]};
+    cluster.pseudoSortByDistance(nodes[0], sorted);
+    assertSame(nodes[0], sorted[0]);
+    assertSame(nodes[1], sorted[1]);
+
+    sorted = new Node[] {nodes[5], nodes[3], nodes[4]};
+    cluster.pseudoSortByDistance(nodes[4], sorted);
+    assertSame(nodes[4], sorted[0]);
+    assertSame(nodes[3], sorted[1]);
+
+    sorted = new Node[] {nodes[5], nodes[2], nodes[3]};
+    cluster.pseudoSortByDistance(nodes[4], sorted);
+    assertSame(nodes[3], sorted[0]);
+  }
+
+  /** A mapping that counts its calls and the names it is asked for */
+  private static class CountingMapping implements DNSToSwitchMapping {
+    int calls = 0;
+    List<String> asked = new ArrayList<String>();
+
+    public List<String> resolve(List<String> names) {
+      calls++;
+      asked.addAll(names);
+      List<String> result = new ArrayList<String>(names.size());
+      for (String name : names) {
+        result.add("/rack" + name.charAt(name.length() - 1));
+      }
+      return result;
+    }
+  }
+
+  public void testCachedBatchResolve() {
+    CountingMapping raw = new CountingMapping();
+    CachedDNSToSwitchMapping mapping = new CachedDNSToSwitchMapping(raw);
+
+    List<String> names = new ArrayList<String>();
+    names.add("10.0.0.1");
+    names.add("10.0.0.2");
+    names.add("10.0.0.1");
+    List<String> racks = mapping.resolve(names);
+    assertEquals(3, racks.size());
+    assertEquals("/rack1", racks.get(0));
+    assertEquals("/rack2", racks.get(1));
+    assertEquals("/rack1", racks.get(2));
+    // one call, with each missing name once
+    assertEquals(1, raw.calls);
+    assertEquals(2, raw.asked.size());
+
+    // all cached: the raw mapping is not called
+    racks = mapping.resolve(names);
+    assertEquals("/rack2", racks.get(1));
+    assertEquals(1, raw.calls);
+
+    names.add("10.0.0.3");
+    racks = mapping.resolve(names);
+    assertEquals("/rack3", racks.get(3));
+    assertEquals(2, raw.calls);
+    assertEquals(3, raw.asked.size());
+  }
+}
@@ -17,15 +17,24 @@
  */
 package org.apache.hadoop.net;
 
+import java.io.File;
+import java.io.FileOutputStream;
 import java.io.IOException;
 import java.io.InputStream;
 import java.io.OutputStream;
+import java.net.InetSocketAddress;
 import java.net.SocketTimeoutException;
+import java.nio.ByteBuffer;
 import java.nio.channels.Pipe;
+import java.nio.channels.ReadableByteChannel;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+import java.nio.channels.WritableByteChannel;
 import java.util.Arrays;
 
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.io.nativeio.NativeSocketIO;
 
 import junit.framework.TestCase;
 
@@ -96,57 +105,209 @@ public class TestSocketIOWithTimeout extends TestCase {
     Pipe.SinkChannel sink = pipe.sink();
     
     try {
-      InputStream in = new SocketInputStream(source, TIMEOUT);
-      OutputStream out = new SocketOutputStream(sink, TIMEOUT);
-      
-      byte[] writeBytes = TEST_STRING.getBytes();
-      byte[] readBytes = new byte[writeBytes.length];
-      
-      out.write(writeBytes);
-      doIO(null, out);
-      
-      in.read(readBytes);
-      assertTrue(Arrays.equals(writeBytes, readBytes));
-      doIO(in, null);
-      
-      /*
-       * Verify that it handles interrupted threads properly.
-       * Use a large timeout and expect the thread to return quickly.
-       */
-      in = new SocketInputStream(source, 0);
-      Thread thread = new Thread(new ReadRunnable(in));
-      thread.start();
-      
-      try {
-        Thread.sleep(1000);
-      } catch (InterruptedException ignored) {}
-      
-      thread.interrupt();
-      
+      doIOWithTimeout(source, sink);
+    } finally {
+      if (source != null) {
+        source.close();
+      }
+      if (sink != null) {
+        sink.close();
+      }
+    }
+  }
+  
+  /**
+   * Same as {@link #testSocketIOWithTimeout()}, over a loopback TCP
+   * connection. This waits with native poll(2) when libhadoop is loaded,
+   * and is repeated with the selector.
+   */
+  public void testSocketChannelIOWithTimeout() throws IOException {
+    LOG.info("Native socket I/O loaded: " + NativeSocketIO.isNativeLoaded());
+    boolean wasNative = SocketIOWithTimeout.getUseNative();
+    for (boolean useNative : new boolean[] {true, false}) {
+      SocketIOWithTimeout.setUseNative(useNative);
+      ServerSocketChannel server = ServerSocketChannel.open();
+      SocketChannel source = null;
+      SocketChannel sink = null;
       try {
-        thread.join();
-      } catch (InterruptedException e) {
-        throw new IOException("Unexpected InterruptedException : " + e);
+        server.socket().bind(new InetSocketAddress("127.0.0.1", 0));
+        sink = SocketChannel.open(server.socket().getLocalSocketAddress());
+        source = server.accept();
+        
+        // direct buffers take a different native path from arrays
+        ByteBuffer direct = ByteBuffer.allocateDirect(TEST_STRING.length());
+        direct.put(TEST_STRING.getBytes()).flip();
+        new SocketOutputStream(sink, TIMEOUT).write(direct);
+        direct.clear();
+        SocketInputStream in = new SocketInputStream(source, TIMEOUT);
+        while (direct.hasRemaining()) {
+          assertTrue(in.read(direct) > 0);
+        }
+        direct.flip();
+        assertEquals(ByteBuffer.wrap(TEST_STRING.getBytes()), direct);
+        
+        doIOWithTimeout(source, sink);
+      } finally {
+        SocketIOWithTimeout.setUseNative(wasNative);
+        server.close();
+        if (source != null) {
+          source.close();
+        }
+        if (sink != null) {
+          sink.close();
+        }
       }
-      
-      //make sure the channels are still open
-      assertTrue(source.isOpen());
-      assertTrue(sink.isOpen());
+    }
+  }
+  
+  private void doIOWithTimeout(ReadableByteChannel source,
+                               WritableByteChannel sink) throws IOException {
+    InputStream in = new SocketInputStream(source, TIMEOUT);
+    OutputStream out = new SocketOutputStream(sink, TIMEOUT);
+    
+    byte[] writeBytes = TEST_STRING.getBytes();
+    byte[] readBytes = new byte[writeBytes.length];
+    
+    out.write(writeBytes);
+    doIO(null, out);
+    
+    in.read(readBytes);
+    assertTrue(Arrays.equals(writeBytes, readBytes));
+    doIO(in, null);
+    
+    /*
+     * Verify that it handles interrupted threads properly.
+     * Use a large timeout and expect the thread to return quickly.
+     */
+    in = new SocketInputStream(source, 0);
+    Thread thread = new Thread(new ReadRunnable(in));
+    thread.start();
+    
+    try {
+      Thread.sleep(1000);
+    } catch (InterruptedException ignored) {}
+    
+    thread.interrupt();
+    
+    try {
+      thread.join();
+    } catch (InterruptedException e) {
+      throw new IOException("Unexpected InterruptedException : " + e);
+    }
+    
+    //make sure the channels are still open
+    assertTrue(source.isOpen());
+    assertTrue(sink.isOpen());
 
-      out.close();
-      assertFalse(sink.isOpen());
-      
-      // close sink and expect -1 from source.read()
-      assertEquals(-1, in.read());
-      
-      // make sure close() closes the underlying channel.
+    out.close();
+    assertFalse(sink.isOpen());
+    
+    // close sink and expect -1 from source.read()
+    assertEquals(-1, in.read());
+    
+    // make sure close() closes the underlying channel.
+    in.close();
+    assertFalse(source.isOpen());
+  }
+
+  /**
+   * Closing a stream while another thread waits natively in a read waits
+   * for the read's current slice, then ends the read.
+   */
+  public void testCloseDuringNativeRead() throws Exception {
+    if (!NativeSocketIO.isNativeLoaded()) {
+      return;
+    }
+    boolean wasNative = SocketIOWithTimeout.getUseNative();
+    SocketIOWithTimeout.setUseNative(true);
+    ServerSocketChannel server = ServerSocketChannel.open();
+    SocketChannel sink = null;
+    try {
+      server.socket().bind(new InetSocketAddress("127.0.0.1", 0));
+      sink = SocketChannel.open(server.socket().getLocalSocketAddress());
+      SocketChannel source = server.accept();
+      final SocketInputStream in = new SocketInputStream(source, 0);
+      final int[] result = {0};
+      Thread reader = new Thread() {
+        public void run() {
+          try {
+            result[0] = in.read();
+          } catch (IOException e) {
+            result[0] = -2;
+          }
+        }
+      };
+      reader.start();
+      Thread.sleep(200);
+      long start = System.currentTimeMillis();
       in.close();
+      reader.join(5000);
+      assertFalse(reader.isAlive());
+      assertTrue(result[0] < 0);
       assertFalse(source.isOpen());
-      
+      assertTrue(System.currentTimeMillis() - start < 2000);
     } finally {
-      if (source != null) {
-        source.close();
+      SocketIOWithTimeout.setUseNative(wasNative);
+      server.close();
+      if (sink != null) {
+        sink.close();
+      }
+    }
+  }
+
+  /**
+   * Closing the input stream of a socket while another thread is blocked
+   * natively writing to it through its output stream ends the write, and
+   * the write never touches a file that reuses the descriptor number.
+   */
+  public void testCloseDuringNativeWrite() throws Exception {
+    if (!NativeSocketIO.isNativeLoaded()) {
+      return;
+    }
+    boolean wasNative = SocketIOWithTimeout.getUseNative();
+    SocketIOWithTimeout.setUseNative(true);
+    ServerSocketChannel server = ServerSocketChannel.open();
+    SocketChannel sink = null;
+    File file = File.createTempFile("TestSocketIOWithTimeout", ".tmp");
+    FileOutputStream reused = null;
+    try {
+      server.socket().bind(new InetSocketAddress("127.0.0.1", 0));
+      sink = SocketChannel.open(server.socket().getLocalSocketAddress());
+      SocketChannel source = server.accept();
+      final SocketOutputStream out = new SocketOutputStream(source, 0);
+      final IOException[] failure = {null};
+      Thread writer = new Thread() {
+        public void run() {
+          byte[] b = new byte[64 * 1024];
+          try {
+            // the sink never reads, so this blocks once the buffers fill
+            while (true) {
+              out.write(b);
+            }
+          } catch (IOException e) {
+            failure[0] = e;
+          }
+        }
+      };
+      writer.start();
+      Thread.sleep(200);
+      long start = System.currentTimeMillis();
+      new SocketInputStream(source, 0).close();
+      // likely to be given the descriptor number the socket had
+      reused = new FileOutputStream(file);
+      writer.join(5000);
+      assertFalse(writer.isAlive());
+      assertNotNull(failure[0]);
+      assertFalse(source.isOpen());
+      assertEquals(0, file.length());
+      assertTrue(System.currentTimeMillis() - start < 2000);
+    } finally {
+      SocketIOWithTimeout.setUseNative(wasNative);
+      if (reused != null) {
+        reused.close();
       }
+      file.delete();
+      server.close();
       if (sink != null) {
         sink.close();
       }
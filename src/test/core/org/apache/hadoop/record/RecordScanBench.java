@@ -0,0 +1,138 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.record;
+
+import java.io.IOException;
+import java.util.Random;
+
+import org.apache.hadoop.io.DataInputBuffer;
+import org.apache.hadoop.io.DataOutputBuffer;
+
+/**
+ * Scans {@link RecSort} records stored row by row, in the binary record
+ * format, and in columnar batches: whole records from both, and from the
+ * batches only the timestamp column.
+ *
+ * <pre>
+ * RecordScanBench &lt;numRecords&gt;
+ * </pre>
+ *
+ * The records and output match those of the C++ recordio_scan_bench in
+ * src/native/recordio.
+ */
+public class RecordScanBench {
+
+  private static final long SEED = 0xDEADBEEFL;
+  private static final String[] NAMES = {
+    "alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"
+  };
+
+  /** Do not allow to create a new instance of the benchmark */
+  private RecordScanBench() {}
+
+  private static RecSort[] makeRecords(int numRecords) {
+    Random rand = new Random(SEED);
+    RecSort[] records = new RecSort[numRecords];
+    long timestamp = 1262304000000L;
+    for (int idx = 0; idx < numRecords; idx++) {
+      RecSort r = new RecSort();
+      // Log-like data: increasing timestamps, a few distinct names.
+      r.setKey(rand.nextInt(1024) - 512);
+      r.setName(NAMES[rand.nextInt(NAMES.length)]);
+      timestamp += rand.nextInt(1000);
+      r.setTimestamp(timestamp);
+      r.setScore(rand.nextInt(1000) / 10.0);
+      records[idx] = r;
+    }
+    return records;
+  }
+
+  private static long scanRows(DataInputBuffer in, byte[] bytes, int length)
+    throws IOException {
+    in.reset(bytes, length);
+    RecSort r = new RecSort();
+    long sum = 0;
+    while (in.getPosition() < length) {
+      r.readFields(in);
+      sum += r.getTimestamp();
+    }
+    return sum;
+  }
+
+  private static long scanColumns(DataInputBuffer in, byte[] bytes,
+                                  int length, String... fields)
+    throws IOException {
+    in.reset(bytes, length);
+    RecSort.ColumnarReader reader = new RecSort.ColumnarReader(in, fields);
+    RecSort r = new RecSort();
+    long sum = 0;
+    while (reader.next(r)) {
+      sum += r.getTimestamp();
+    }
+    return sum;
+  }
+
+  private static void printTime(String name, long nanos, int numRecords) {
+    System.out.println(name + " Scan Time (Per Record) : "
+        + nanos / numRecords + " Nanoseconds");
+  }
+
+  public static void main(String[] args) throws IOException {
+    if (args.length != 1) {
+      System.err.println("Usage: RecordScanBench <numRecords>");
+      System.exit(1);
+    }
+    int numRecords = Integer.parseInt(args[0]);
+    System.out.println("RecordScanBench v0.1\n");
+
+    RecSort[] records = makeRecords(numRecords);
+    DataOutputBuffer rows = new DataOutputBuffer();
+    DataOutputBuffer columns = new DataOutputBuffer();
+    RecSort.ColumnarWriter writer = new RecSort.ColumnarWriter(columns);
+    for (int idx = 0; idx < numRecords; idx++) {
+      records[idx].write(rows);
+      writer.append(records[idx]);
+    }
+    writer.close();
+    System.out.println("Type: RecSort #Records: " + numRecords
+        + " Row Bytes: " + rows.getLength()
+        + " Columnar Bytes: " + columns.getLength());
+
+    DataInputBuffer in = new DataInputBuffer();
+    byte[] rowBytes = rows.getData();
+    byte[] columnBytes = columns.getData();
+    // dry runs
+    long expected = scanRows(in, rowBytes, rows.getLength());
+    scanColumns(in, columnBytes, columns.getLength());
+    scanColumns(in, columnBytes, columns.getLength(), "timestamp");
+
+    long start = System.nanoTime();
+    long sum = scanRows(in, rowBytes, rows.getLength());
+    printTime("Row", System.nanoTime() - start, numRecords);
+    start = System.nanoTime();
+    sum ^= scanColumns(in, columnBytes, columns.getLength());
+    printTime("Columnar", System.nanoTime() - start, numRecords);
+    start = System.nanoTime();
+    sum ^= scanColumns(in, columnBytes, columns.getLength(), "timestamp");
+    printTime("Projected Columnar", System.nanoTime() - start, numRecords);
+    System.out.println();
+    if (sum != expected) {
+      throw new IOException("Scans disagree");
+    }
+  }
+}
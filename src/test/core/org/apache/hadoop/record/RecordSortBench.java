@@ -0,0 +1,162 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.record;
+
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.Random;
+
+import org.apache.hadoop.io.DataOutputBuffer;
+import org.apache.hadoop.io.WritableComparator;
+import org.apache.hadoop.util.IndexedSortable;
+import org.apache.hadoop.util.QuickSort;
+
+/**
+ * Sorts serialized {@link RecSort} records three ways: with the generated
+ * raw comparator, with a comparator that deserializes both records for
+ * each comparison, and, for reference, already deserialized records with
+ * {@link RecSort#compareTo(Object)}.
+ *
+ * <pre>
+ * RecordSortBench &lt;numRecords&gt;
+ * </pre>
+ *
+ * The records and output match those of the C++ recordio_sort_bench in
+ * src/native/recordio.
+ */
+public class RecordSortBench {
+
+  private static final long SEED = 0xDEADBEEFL;
+
+  /** Do not allow to create a new instance of the benchmark */
+  private RecordSortBench() {}
+
+  private static class Buffers implements IndexedSortable {
+    private final byte[] bytes;
+    private final int[] offsets;
+    private final int[] lengths;
+    private final int[] order;
+    private final WritableComparator comparator;
+    long compares;
+
+    Buffers(byte[] bytes, int[] offsets, int[] lengths,
+            WritableComparator comparator) {
+      this.bytes = bytes;
+      this.offsets = offsets;
+      this.lengths = lengths;
+      this.comparator = comparator;
+      order = new int[offsets.length];
+      for (int i = 0; i < order.length; i++) {
+        order[i] = i;
+      }
+    }
+
+    public int compare(int i, int j) {
+      compares++;
+      int oi = order[i];
+      int oj = order[j];
+      return comparator.compare(bytes, offsets[oi], lengths[oi],
+                                bytes, offsets[oj], lengths[oj]);
+    }
+
+    public void swap(int i, int j) {
+      int tmp = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+  }
+
+  private static RecSort[] makeRecords(int numRecords) {
+    Random rand = new Random(SEED);
+    RecSort[] records = new RecSort[numRecords];
+    for (int idx = 0; idx < numRecords; idx++) {
+      RecSort r = new RecSort();
+      // Few distinct keys, so that later fields are compared too.
+      r.setKey(rand.nextInt(1024) - 512);
+      StringBuilder sb = new StringBuilder();
+      for (int i = 4 + rand.nextInt(12); i > 0; i--) {
+        sb.append((char) ('a' + rand.nextInt(4)));
+      }
+      r.setName(sb.toString());
+      r.setTimestamp(1262304000000L + rand.nextInt(1000000000));
+      r.setScore(rand.nextInt(1000) / 10.0);
+      records[idx] = r;
+    }
+    return records;
+  }
+
+  private static void printTimes(String name, long nanos, long compares) {
+    System.out.println(name + " Sort Time : " + nanos / 1000000
+        + " Milliseconds, " + nanos / Math.max(compares, 1)
+        + " Nanoseconds per comparison");
+  }
+
+  private static long sort(Buffers buffers, int numRecords) {
+    long start = System.nanoTime();
+    new QuickSort().sort(buffers, 0, numRecords);
+    return System.nanoTime() - start;
+  }
+
+  public static void main(String[] args) throws IOException {
+    if (args.length != 1) {
+      System.err.println("Usage: RecordSortBench <numRecords>");
+      System.exit(1);
+    }
+    int numRecords = Integer.parseInt(args[0]);
+    System.out.println("RecordSortBench v0.1\n");
+
+    RecSort[] records = makeRecords(numRecords);
+    DataOutputBuffer out = new DataOutputBuffer();
+    int[] offsets = new int[numRecords];
+    int[] lengths = new int[numRecords];
+    for (int idx = 0; idx < numRecords; idx++) {
+      offsets[idx] = out.getLength();
+      records[idx].write(out);
+      lengths[idx] = out.getLength() - offsets[idx];
+    }
+    byte[] bytes = out.getData();
+    System.out.println("Type: RecSort #Records: " + numRecords
+        + " Bytes: " + out.getLength());
+
+    WritableComparator raw = WritableComparator.get(RecSort.class);
+    WritableComparator deserializing =
+      new WritableComparator(RecSort.class, true) {};
+
+    // dry runs
+    sort(new Buffers(bytes, offsets, lengths, raw), numRecords);
+    sort(new Buffers(bytes, offsets, lengths, deserializing), numRecords);
+
+    Buffers buffers = new Buffers(bytes, offsets, lengths, raw);
+    long nanos = sort(buffers, numRecords);
+    printTimes("Raw", nanos, buffers.compares);
+
+    buffers = new Buffers(bytes, offsets, lengths, deserializing);
+    nanos = sort(buffers, numRecords);
+    printTimes("Deserializing", nanos, buffers.compares);
+
+    RecSort[] copy = records.clone();
+    Arrays.sort(copy);
+    copy = records.clone();
+    long start = System.nanoTime();
+    Arrays.sort(copy);
+    nanos = System.nanoTime() - start;
+    System.out.println("Object Sort Time : " + nanos / 1000000
+        + " Milliseconds");
+    System.out.println();
+  }
+}
@@ -0,0 +1,119 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.record;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.TreeMap;
+
+import junit.framework.TestCase;
+
+import org.apache.hadoop.io.DataInputBuffer;
+import org.apache.hadoop.io.DataOutputBuffer;
+
+/**
+ * Round-trips records through the columnar writers and readers generated
+ * by the record compiler.
+ */
+public class TestColumnarBatch extends TestCase {
+
+  private final DataOutputBuffer out = new DataOutputBuffer();
+  private final DataInputBuffer in = new DataInputBuffer();
+
+  private static RecRecord1 makeRecord(int i) {
+    RecRecord1 r = new RecRecord1();
+    r.setBoolVal(i % 3 == 0);
+    r.setByteVal((byte) i);
+    r.setIntVal(i * 1000 - 50000);
+    r.setLongVal(i % 2 == 0 ? Long.MIN_VALUE : Long.MAX_VALUE - i);
+    r.setFloatVal(i / 3.0F);
+    r.setDoubleVal(-i / 7.0);
+    r.setStringVal(i % 10 == 0 ? "rare" : "common");
+    r.setBufferVal(new Buffer(new byte[i % 5]));
+    ArrayList<String> vector = new ArrayList<String>();
+    for (int j = 0; j < i % 4; j++) {
+      vector.add("v" + j);
+    }
+    r.setVectorVal(vector);
+    TreeMap<String,String> map = new TreeMap<String,String>();
+    map.put("key", "value" + i);
+    r.setMapVal(map);
+    RecRecord0 r0 = new RecRecord0();
+    r0.setStringVal("inner " + i);
+    r.setRecordVal(r0);
+    return r;
+  }
+
+  private void write(int numRecords, int batchSize) throws IOException {
+    out.reset();
+    RecRecord1.ColumnarWriter writer =
+      new RecRecord1.ColumnarWriter(out, batchSize);
+    for (int i = 0; i < numRecords; i++) {
+      writer.append(makeRecord(i));
+    }
+    writer.close();
+    in.reset(out.getData(), out.getLength());
+  }
+
+  public void testRoundTrip() throws IOException {
+    // several batches, the last one partial
+    write(100, 30);
+    RecRecord1.ColumnarReader reader = new RecRecord1.ColumnarReader(in);
+    RecRecord1 r = new RecRecord1();
+    for (int i = 0; i < 100; i++) {
+      assertTrue(reader.next(r));
+      assertEquals(makeRecord(i), r);
+    }
+    assertFalse(reader.next(r));
+    assertFalse(reader.next(r));
+  }
+
+  public void testProjection() throws IOException {
+    write(100, 30);
+    RecRecord1.ColumnarReader reader =
+      new RecRecord1.ColumnarReader(in, "stringVal", "intVal");
+    for (int i = 0; i < 100; i++) {
+      RecRecord1 r = new RecRecord1();
+      assertTrue(reader.next(r));
+      RecRecord1 expected = makeRecord(i);
+      assertEquals(expected.getIntVal(), r.getIntVal());
+      assertEquals(expected.getStringVal(), r.getStringVal());
+      assertEquals(0L, r.getLongVal());
+      assertEquals(new RecRecord1().getVectorVal(), r.getVectorVal());
+    }
+    assertFalse(reader.next(new RecRecord1()));
+  }
+
+  public void testUnknownField() throws IOException {
+    write(1, 30);
+    try {
+      new RecRecord1.ColumnarReader(in, "intVal", "noSuchVal");
+      fail("Expected IllegalArgumentException");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+  }
+
+  public void testEmpty() throws IOException {
+    write(0, 30);
+    assertEquals(1, out.getLength());
+    RecRecord1.ColumnarReader reader = new RecRecord1.ColumnarReader(in);
+    assertFalse(reader.next(new RecRecord1()));
+  }
+}
@@ -0,0 +1,151 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.hadoop.record;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.TreeMap;
+
+import junit.framework.TestCase;
+
+import org.apache.hadoop.io.DataOutputBuffer;
+import org.apache.hadoop.io.WritableComparator;
+
+/**
+ * Checks that the raw comparators generated by the record compiler order
+ * serialized records the same way as the records' compareTo.
+ */
+public class TestRecordComparator extends TestCase {
+
+  private static final long[] VALUES = {
+    0, 1, -1, 127, 128, -112, -113, 255, 256, 65535, -65536,
+    Integer.MAX_VALUE, Integer.MIN_VALUE, Long.MAX_VALUE, Long.MIN_VALUE
+  };
+
+  private static final String[] STRINGS = {
+    "", "a", "b", "ab", "abc", "abd", "b", "random text"
+  };
+
+  private final DataOutputBuffer out = new DataOutputBuffer();
+
+  private static RecRecord1 makeRecord() {
+    RecRecord1 r = new RecRecord1();
+    r.setBoolVal(true);
+    r.setByteVal((byte)0x66);
+    r.setIntVal(-4567);
+    r.setLongVal(-2367L);
+    r.setFloatVal(3.145F);
+    r.setDoubleVal(1.5234);
+    r.setStringVal("random text");
+    r.setBufferVal(new Buffer());
+    r.setVectorVal(new ArrayList<String>());
+    r.setMapVal(new TreeMap<String,String>());
+    RecRecord0 r0 = new RecRecord0();
+    r0.setStringVal("other random text");
+    r.setRecordVal(r0);
+    return r;
+  }
+
+  private static int sign(int i) {
+    return i < 0 ? -1 : (i > 0 ? 1 : 0);
+  }
+
+  private void checkCompare(RecRecord1 r1, RecRecord1 r2) throws IOException {
+    out.reset();
+    r1.write(out);
+    int l1 = out.getLength();
+    r2.write(out);
+    int l2 = out.getLength() - l1;
+    byte[] b = out.getData();
+    WritableComparator comparator = WritableComparator.get(RecRecord1.class);
+    assertEquals(r1 + " vs " + r2, sign(r1.compareTo(r2)),
+                 sign(comparator.compare(b, 0, l1, b, l1, l2)));
+    assertEquals(r2 + " vs " + r1, sign(r2.compareTo(r1)),
+                 sign(comparator.compare(b, l1, l2, b, 0, l1)));
+  }
+
+  public void testIntegers() throws IOException {
+    for (long v1 : VALUES) {
+      for (long v2 : VALUES) {
+        RecRecord1 r1 = makeRecord();
+        RecRecord1 r2 = makeRecord();
+        r1.setIntVal((int) v1);
+        r2.setIntVal((int) v2);
+        checkCompare(r1, r2);
+        r1 = makeRecord();
+        r2 = makeRecord();
+        r1.setLongVal(v1);
+        r2.setLongVal(v2);
+        checkCompare(r1, r2);
+        r1 = makeRecord();
+        r2 = makeRecord();
+        r1.setByteVal((byte) v1);
+        r2.setByteVal((byte) v2);
+        checkCompare(r1, r2);
+      }
+    }
+  }
+
+  public void testFloatingPoint() throws IOException {
+    for (long v1 : VALUES) {
+      for (long v2 : VALUES) {
+        RecRecord1 r1 = makeRecord();
+        RecRecord1 r2 = makeRecord();
+        r1.setFloatVal(v1 / 3.0F);
+        r2.setFloatVal(v2 / 3.0F);
+        checkCompare(r1, r2);
+        r1 = makeRecord();
+        r2 = makeRecord();
+        r1.setDoubleVal(v1 / 3.0);
+        r2.setDoubleVal(v2 / 3.0);
+        checkCompare(r1, r2);
+      }
+    }
+  }
+
+  public void testStringsAndBuffers() throws IOException {
+    for (String s1 : STRINGS) {
+      for (String s2 : STRINGS) {
+        RecRecord1 r1 = makeRecord();
+        RecRecord1 r2 = makeRecord();
+        r1.setStringVal(s1);
+        r2.setStringVal(s2);
+        checkCompare(r1, r2);
+        r1 = makeRecord();
+        r2 = makeRecord();
+        r1.setBufferVal(new Buffer(s1.getBytes("UTF-8")));
+        r2.setBufferVal(new Buffer(s2.getBytes("UTF-8")));
+        checkCompare(r1, r2);
+        r1 = makeRecord();
+        r2 = makeRecord();
+        r1.getRecordVal().setStringVal(s1);
+        r2.getRecordVal().setStringVal(s2);
+        checkCompare(r1, r2);
+      }
+    }
+  }
+
+  public void testBoolean() throws IOException {
+    RecRecord1 r1 = makeRecord();
+    RecRecord1 r2 = makeRecord();
+    r2.setBoolVal(false);
+    checkCompare(r1, r2);
+    checkCompare(r2, r2);
+  }
+}
@@ -0,0 +1,197 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.security;
+
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.lang.management.ManagementFactory;
+import java.lang.management.ThreadMXBean;
+import java.lang.reflect.Method;
+import java.util.Random;
+
+import org.apache.hadoop.io.DataOutputBuffer;
+
+/**
+ * SaslStreamBenchmark measures the MB/s and the bytes allocated per MB of
+ * data sent through {@link SaslOutputStream} and read back through
+ * {@link SaslInputStream}, with DIGEST-MD5 at the auth-int and auth-conf
+ * qualities of protection, which need no KDC. For comparison, the
+ * "unpooled" rows frame the same packets with a new token array per packet
+ * and a separate write for the length.
+ *
+ * <p>Allocation is measured with the JVM's per-thread allocation counter
+ * where it has one; otherwise it is reported as -1.</p>
+ *
+ * <pre>
+ * SaslStreamBenchmark [&lt;packetBytes&gt; [&lt;totalMB&gt;]]
+ * </pre>
+ */
+public class SaslStreamBenchmark {
+  private static final ThreadMXBean THREADS =
+    ManagementFactory.getThreadMXBean();
+  private static final Method ALLOCATED_BYTES;
+
+  static {
+    Method m = null;
+    try {
+      m = THREADS.getClass().getMethod("getThreadAllocatedBytes", long.class);
+      m.setAccessible(true);
+    } catch (Exception e) {
+      // not a JVM that counts allocation
+    }
+    ALLOCATED_BYTES = m;
+  }
+
+  /** Do not allow to create a new instance of the benchmark */
+  private SaslStreamBenchmark() {}
+
+  private static long allocatedBytes() {
+    if (ALLOCATED_BYTES == null) {
+      return -1;
+    }
+    try {
+      return (Long) ALLOCATED_BYTES.invoke(THREADS,
+                                           Thread.currentThread().getId());
+    } catch (Exception e) {
+      return -1;
+    }
+  }
+
+  /** A pipe in memory: what is written can be read from {@link #in}. */
+  private static class Wire extends OutputStream {
+    private final DataOutputBuffer buf = new DataOutputBuffer();
+    private int pos = 0;
+
+    @Override
+    public void write(int b) {
+      buf.write(b);
+    }
+
+    @Override
+    public void write(byte[] b, int off, int len) {
+      buf.write(b, off, len);
+    }
+
+    final InputStream in = new InputStream() {
+      private final byte[] one = new byte[1];
+
+      @Override
+      public int read() {
+        return read(one, 0, 1) < 0 ? -1 : one[0] & 0xff;
+      }
+
+      @Override
+      public int read(byte[] b, int off, int len) {
+        int n = Math.min(len, buf.getLength() - pos);
+        if (n <= 0) {
+          return -1;
+        }
+        System.arraycopy(buf.getData(), pos, b, off, n);
+        pos += n;
+        if (pos == buf.getLength()) {
+          buf.reset();
+          pos = 0;
+        }
+        return n;
+      }
+    };
+  }
+
+  private static void report(String name, long bytes, long nanos,
+                             long allocated) {
+    double mb = bytes / (double) (1 << 20);
+    System.out.println(name + "\t" + bytes + "\t" + nanos / 1000000 + "\t"
+        + String.format("%.1f", mb * 1e9 / Math.max(nanos, 1)) + "\t"
+        + (allocated < 0 ? -1 : (long) (allocated / mb)));
+  }
+
+  /** Send and receive packets in batches through the SASL streams. */
+  private static void runStreams(TestSaslStreams.DigestPair pair,
+      byte[] packet, int packets) throws IOException {
+    Wire wire = new Wire();
+    SaslOutputStream out = new SaslOutputStream(wire, pair.client);
+    DataInputStream in =
+      new DataInputStream(new SaslInputStream(wire.in, pair.server));
+    byte[] read = new byte[packet.length];
+    for (int sent = 0; sent < packets; ) {
+      int batch = Math.min(16, packets - sent);
+      for (int i = 0; i < batch; i++) {
+        out.write(packet);
+      }
+      for (int i = 0; i < batch; i++) {
+        in.readFully(read);
+      }
+      sent += batch;
+    }
+  }
+
+  /** The same, framing each packet with new arrays. */
+  private static void runUnpooled(TestSaslStreams.DigestPair pair,
+      byte[] packet, int packets) throws IOException {
+    Wire wire = new Wire();
+    DataOutputStream out = new DataOutputStream(wire);
+    DataInputStream in = new DataInputStream(wire.in);
+    for (int sent = 0; sent < packets; ) {
+      int batch = Math.min(16, packets - sent);
+      for (int i = 0; i < batch; i++) {
+        byte[] token = pair.client.wrap(packet, 0, packet.length);
+        out.writeInt(token.length);
+        out.write(token);
+      }
+      for (int i = 0; i < batch; i++) {
+        byte[] token = new byte[in.readInt()];
+        in.readFully(token);
+        pair.server.unwrap(token, 0, token.length);
+      }
+      sent += batch;
+    }
+  }
+
+  public static void main(String[] args) throws IOException {
+    int packetBytes = args.length > 0 ? Integer.parseInt(args[0]) : 8192;
+    int totalMB = args.length > 1 ? Integer.parseInt(args[1]) : 64;
+    byte[] packet = new byte[packetBytes];
+    new Random(0).nextBytes(packet);
+    int packets = (int) (((long) totalMB << 20) / packetBytes);
+    long bytes = (long) packets * packetBytes;
+    System.out.println("method\tbytes\tms\tMB/s\tallocated/MB");
+
+    for (String qop : new String[] {"auth-int", "auth-conf"}) {
+      for (int r = 0; r < 3; r++) {
+        TestSaslStreams.DigestPair pair = new TestSaslStreams.DigestPair(qop);
+        long allocated = allocatedBytes();
+        long start = System.nanoTime();
+        runStreams(pair, packet, packets);
+        long nanos = System.nanoTime() - start;
+        report(qop + "-streams", bytes, nanos,
+               allocated < 0 ? -1 : allocatedBytes() - allocated);
+
+        pair = new TestSaslStreams.DigestPair(qop);
+        allocated = allocatedBytes();
+        start = System.nanoTime();
+        runUnpooled(pair, packet, packets);
+        nanos = System.nanoTime() - start;
+        report(qop + "-unpooled", bytes, nanos,
+               allocated < 0 ? -1 : allocatedBytes() - allocated);
+      }
+    }
+  }
+}
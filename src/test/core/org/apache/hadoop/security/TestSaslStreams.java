@@ -0,0 +1,155 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.security;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.Random;
+
+import javax.security.auth.callback.Callback;
+import javax.security.auth.callback.CallbackHandler;
+import javax.security.auth.callback.NameCallback;
+import javax.security.auth.callback.PasswordCallback;
+import javax.security.auth.callback.UnsupportedCallbackException;
+import javax.security.sasl.AuthorizeCallback;
+import javax.security.sasl.RealmCallback;
+import javax.security.sasl.Sasl;
+import javax.security.sasl.SaslClient;
+import javax.security.sasl.SaslServer;
+
+import org.junit.Test;
+import static org.junit.Assert.*;
+
+/** Test {@link SaslInputStream} and {@link SaslOutputStream}. */
+public class TestSaslStreams {
+  private static final Random RANDOM = new Random();
+
+  /** A client and server that have completed a DIGEST-MD5 handshake. */
+  static class DigestPair {
+    final SaslClient client;
+    final SaslServer server;
+
+    /**
+     * @param qop the quality of protection: auth-int or auth-conf
+     */
+    DigestPair(String qop) throws IOException {
+      Map<String, String> props = new HashMap<String, String>();
+      props.put(Sasl.QOP, qop);
+      props.put(Sasl.MAX_BUFFER, Integer.toString(1 << 20));
+      CallbackHandler handler = new CallbackHandler() {
+        public void handle(Callback[] callbacks)
+            throws UnsupportedCallbackException {
+          for (Callback callback : callbacks) {
+            if (callback instanceof NameCallback) {
+              ((NameCallback) callback).setName("user");
+            } else if (callback instanceof PasswordCallback) {
+              ((PasswordCallback) callback).setPassword(
+                  "password".toCharArray());
+            } else if (callback instanceof RealmCallback) {
+              RealmCallback rc = (RealmCallback) callback;
+              rc.setText(rc.getDefaultText());
+            } else if (callback instanceof AuthorizeCallback) {
+              ((AuthorizeCallback) callback).setAuthorized(true);
+            } else {
+              throw new UnsupportedCallbackException(callback);
+            }
+          }
+        }
+      };
+      server = Sasl.createSaslServer("DIGEST-MD5", "hadoop", "localhost",
+                                     props, handler);
+      client = Sasl.createSaslClient(new String[] {"DIGEST-MD5"}, null,
+                                     "hadoop", "localhost", props, handler);
+      byte[] challenge = server.evaluateResponse(new byte[0]);
+      while (!client.isComplete() || !server.isComplete()) {
+        byte[] response = client.evaluateChallenge(challenge);
+        if (!server.isComplete()) {
+          challenge = server.evaluateResponse(response);
+        }
+      }
+      assertEquals(qop, server.getNegotiatedProperty(Sasl.QOP));
+    }
+  }
+
+  /** Write packets of the given sizes, and read them back. */
+  private static void checkRoundTrip(DigestPair pair, boolean toServer,
+                                     int[] sizes) throws IOException {
+    ByteArrayOutputStream wire = new ByteArrayOutputStream();
+    SaslOutputStream out = toServer
+      ? new SaslOutputStream(wire, pair.client)
+      : new SaslOutputStream(wire, pair.server);
+    byte[][] packets = new byte[sizes.length][];
+    for (int i = 0; i < sizes.length; i++) {
+      packets[i] = new byte[sizes[i]];
+      RANDOM.nextBytes(packets[i]);
+      out.write(packets[i]);
+    }
+    out.flush();
+
+    ByteArrayInputStream in = new ByteArrayInputStream(wire.toByteArray());
+    DataInputStream sasl = new DataInputStream(toServer
+      ? new SaslInputStream(in, pair.server)
+      : new SaslInputStream(in, pair.client));
+    for (int i = 0; i < sizes.length; i++) {
+      byte[] packet = new byte[sizes[i]];
+      sasl.readFully(packet);
+      assertTrue("packet " + i + " of " + sizes[i] + " bytes",
+                 Arrays.equals(packets[i], packet));
+    }
+    assertEquals(-1, sasl.read());
+  }
+
+  private static void checkQop(String qop) throws IOException {
+    DigestPair pair = new DigestPair(qop);
+    // small packets, growing and shrinking around the reused buffers,
+    // and packets too large to be copied into a frame
+    int[] sizes = {1, 10, 1000, 8192, 100, 70000, 5, 200000, 64 * 1024, 3};
+    checkRoundTrip(pair, true, sizes);
+    checkRoundTrip(pair, false, sizes);
+    checkRoundTrip(pair, true, sizes);
+  }
+
+  @Test
+  public void testIntegrity() throws IOException {
+    checkQop("auth-int");
+  }
+
+  @Test
+  public void testConfidentiality() throws IOException {
+    checkQop("auth-conf");
+  }
+
+  @Test
+  public void testBadLength() throws IOException {
+    DigestPair pair = new DigestPair("auth-int");
+    byte[] wire = {(byte) 0x80, 0, 0, 0, 1, 2, 3};
+    SaslInputStream in = new SaslInputStream(new ByteArrayInputStream(wire),
+                                             pair.server);
+    try {
+      in.read();
+      fail("negative token length was accepted");
+    } catch (IOException e) {
+      // expected
+    }
+  }
+}
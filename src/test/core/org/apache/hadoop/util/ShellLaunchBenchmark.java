@@ -0,0 +1,109 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.hadoop.util;
+
+import java.io.IOException;
+import java.util.Arrays;
+
+import org.apache.hadoop.io.nativeio.NativeProcess;
+
+/**
+ * ShellLaunchBenchmark measures the launches per second and the launch
+ * latency of {@link Shell} commands started by {@link ProcessBuilder}
+ * and by {@link NativeProcess}.
+ *
+ * <p>The cost of forking grows with the memory the JVM has touched, so the
+ * benchmark first fills a ballast of the given size. Compare a small and a
+ * large heap, e.g.</p>
+ *
+ * <pre>
+ * java -Xmx1g  ShellLaunchBenchmark 2000 512
+ * java -Xmx32g ShellLaunchBenchmark 2000 30000
+ * </pre>
+ *
+ * <pre>
+ * ShellLaunchBenchmark [&lt;launches&gt; [&lt;ballastMB&gt; [&lt;command&gt; ...]]]
+ * </pre>
+ */
+public class ShellLaunchBenchmark {
+  /** Do not allow to create a new instance of the benchmark */
+  private ShellLaunchBenchmark() {}
+
+  /* keeps the ballast reachable */
+  private static byte[][] ballast;
+
+  private static void fillBallast(int mb) {
+    ballast = new byte[mb][];
+    for (int i = 0; i < mb; i++) {
+      ballast[i] = new byte[1024 * 1024];
+      for (int j = 0; j < ballast[i].length; j += 4096) {
+        ballast[i][j] = 1;
+      }
+    }
+  }
+
+  /** @return the launch latencies in microseconds */
+  static long[] run(String[] command, int launches) throws IOException {
+    long[] micros = new long[launches];
+    for (int i = 0; i < launches; i++) {
+      long start = System.nanoTime();
+      Shell.execCommand(command);
+      micros[i] = (System.nanoTime() - start) / 1000;
+    }
+    return micros;
+  }
+
+  private static void report(String name, long[] micros) {
+    long total = 0;
+    for (long m : micros) {
+      total += m;
+    }
+    long[] sorted = micros.clone();
+    Arrays.sort(sorted);
+    System.out.println(name + "\t"
+        + micros.length * 1000000L / Math.max(total, 1) + "\t"
+        + sorted[sorted.length / 2] + "\t"
+        + sorted[Math.min(sorted.length - 1, sorted.length * 99 / 100)] + "\t"
+        + sorted[sorted.length - 1]);
+  }
+
+  public static void main(String[] args) throws Exception {
+    int launches = args.length > 0 ? Integer.parseInt(args[0]) : 1000;
+    int ballastMB = args.length > 1 ? Integer.parseInt(args[1]) : 0;
+    String[] command = args.length > 2
+      ? Arrays.copyOfRange(args, 2, args.length) : new String[] {"true"};
+
+    fillBallast(ballastMB);
+    System.out.println("max heap " + Runtime.getRuntime().maxMemory() / 1048576
+        + " MB, ballast " + ballastMB + " MB, command "
+        + Arrays.toString(command));
+    System.out.println("launcher\tlaunches/s\tp50(us)\tp99(us)\tmax(us)");
+
+    Shell.setUseNativeLauncher(false);
+    run(command, Math.min(launches, 100));
+    report("ProcessBuilder", run(command, launches));
+
+    if (!NativeProcess.isNativeLoaded()) {
+      System.out.println("NativeProcess\tnot loaded");
+      return;
+    }
+    Shell.setUseNativeLauncher(true);
+    run(command, Math.min(launches, 100));
+    report("NativeProcess", run(command, launches));
+  }
+}
@@ -17,10 +17,19 @@
  */
 package org.apache.hadoop.util;
 
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.concurrent.atomic.AtomicInteger;
+
 import junit.framework.TestCase;
 
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.fs.FileUtil;
 import org.apache.hadoop.util.AsyncDiskService;
 import org.junit.Test;
 
@@ -81,4 +90,88 @@ public class TestAsyncDiskService extends TestCase {
     
     assertEquals(total, count);
   }
+
+  /**
+   * Tasks on one volume run one at a time, in order, while a tree is
+   * being deleted on the same volume.
+   */
+  @Test
+  public void testTasksOfVolumeRunInOrder() throws Throwable {
+    File base = new File(System.getProperty("test.build.data", "/tmp"),
+                         "TestAsyncDiskService-order");
+    FileUtil.fullyDelete(base);
+    File tree = new File(base, "tree");
+    createTree(tree, 3);
+    String[] vols = new String[]{"/0"};
+    AsyncDiskService service = new AsyncDiskService(vols);
+    final List<Integer> order =
+      Collections.synchronizedList(new ArrayList<Integer>());
+    final AtomicInteger running = new AtomicInteger();
+    final AtomicInteger maxRunning = new AtomicInteger();
+    service.deleteTree(vols[0], tree);
+    int total = 50;
+    for (int i = 0; i < total; i++) {
+      final int seq = i;
+      service.execute(vols[0], new Runnable() {
+        public void run() {
+          int now = running.incrementAndGet();
+          synchronized (maxRunning) {
+            maxRunning.set(Math.max(maxRunning.get(), now));
+          }
+          order.add(seq);
+          Thread.yield();
+          running.decrementAndGet();
+        }
+      });
+    }
+    service.shutdown();
+    if (!service.awaitTermination(30000)) {
+      fail("AsyncDiskService didn't shutdown in 30 seconds.");
+    }
+    assertEquals(1, maxRunning.get());
+    assertEquals(total, order.size());
+    for (int i = 0; i < total; i++) {
+      assertEquals(i, order.get(i).intValue());
+    }
+    assertFalse(tree.exists());
+    base.delete();
+  }
+
+  private static void createTree(File dir, int depth) throws IOException {
+    assertTrue(dir.mkdirs());
+    for (int i = 0; i < 5; i++) {
+      new FileOutputStream(new File(dir, "f" + i)).close();
+      if (depth > 0) {
+        createTree(new File(dir, "d" + i), depth - 1);
+      }
+    }
+  }
+
+  /**
+   * Deletes trees on two volumes.
+   */
+  @Test
+  public void testDeleteTree() throws Throwable {
+    File base = new File(System.getProperty("test.build.data", "/tmp"),
+                         "TestAsyncDiskService");
+    String[] vols = new String[]{"/0", "/1"};
+    File[] trees = new File[]{new File(base, "0"), new File(base, "1")};
+    for (File tree : trees) {
+      createTree(tree, 3);
+    }
+
+    AsyncDiskService service = new AsyncDiskService(vols);
+    for (int i = 0; i < vols.length; i++) {
+      service.deleteTree(vols[i], trees[i]);
+    }
+    service.shutdown();
+    if (!service.awaitTermination(30000)) {
+      fail("AsyncDiskService didn't shutdown in 30 seconds.");
+    }
+
+    for (File tree : trees) {
+      assertFalse(tree + " still exists", tree.exists());
+    }
+    base.delete();
+  }
 }
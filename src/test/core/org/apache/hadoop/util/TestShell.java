@@ -24,6 +24,10 @@ import java.io.File;
 import java.io.FileOutputStream;
 import java.io.IOException;
 import java.io.PrintWriter;
+import java.util.HashMap;
+import java.util.Map;
+
+import org.apache.hadoop.io.nativeio.NativeProcess;
 
 public class TestShell extends TestCase {
 
@@ -96,6 +100,79 @@ public class TestShell extends TestCase {
     assertTrue("Script didnt not timeout" , shexc.isTimedOut());
   }
 
+  public void testNativeLauncher() throws Throwable {
+    if (!NativeProcess.isNativeLoaded()) {
+      return;
+    }
+    boolean wasNative = Shell.isUsingNativeLauncher();
+    Shell.setUseNativeLauncher(true);
+    try {
+      assertTrue(Shell.isUsingNativeLauncher());
+      Map<String, String> env = new HashMap<String, String>();
+      env.put("TEST_SHELL_VAR", "value");
+      File dir = new File(System.getProperty("test.build.data", "/tmp"))
+        .getAbsoluteFile();
+      Shell.ShellCommandExecutor shexc = new Shell.ShellCommandExecutor(
+          new String[] {"bash", "-c", "echo $TEST_SHELL_VAR; pwd"}, dir, env);
+      shexc.execute();
+      assertTrue(shexc.getProcess() instanceof NativeProcess);
+      assertEquals("value\n" + dir.getCanonicalPath() + "\n",
+                   shexc.getOutput());
+
+      shexc = new Shell.ShellCommandExecutor(
+          new String[] {"bash", "-c", "echo failed >&2; exit 3"});
+      try {
+        shexc.execute();
+        fail("Expected an ExitCodeException");
+      } catch (Shell.ExitCodeException e) {
+        assertEquals(3, e.getExitCode());
+        assertInString(e.getMessage(), "failed");
+      }
+      assertEquals(3, shexc.getExitCode());
+
+      try {
+        Shell.execCommand("no-such-command-for-TestShell");
+        fail("Expected an IOException");
+      } catch (IOException e) {
+        assertInString(e.getMessage(), "no-such-command-for-TestShell");
+      }
+
+      testShellCommandTimeout();
+    } finally {
+      Shell.setUseNativeLauncher(wasNative);
+    }
+  }
+
+  public void testNativeWaitForInterrupt() throws Throwable {
+    if (!NativeProcess.isNativeLoaded()) {
+      return;
+    }
+    final NativeProcess p = NativeProcess.start(
+        new String[] {"sleep", "60"}, null, null);
+    final Throwable[] thrown = new Throwable[1];
+    Thread waiter = new Thread() {
+      public void run() {
+        try {
+          p.waitFor();
+        } catch (Throwable t) {
+          thrown[0] = t;
+        }
+      }
+    };
+    try {
+      waiter.start();
+      Thread.sleep(200);
+      waiter.interrupt();
+      waiter.join(10000);
+      assertFalse("waitFor was not interrupted", waiter.isAlive());
+      assertTrue("Unexpected " + thrown[0],
+                 thrown[0] instanceof InterruptedException);
+    } finally {
+      p.destroy();
+    }
+    assertEquals(0x80 + 15, p.waitFor());
+  }
+
   private void testInterval(long interval) throws IOException {
     Command command = new Command(interval);
 